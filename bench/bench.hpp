@@ -0,0 +1,66 @@
+#ifndef _BENCH_H
+#define _BENCH_H
+
+// Utilitários compartilhados pelos benchmarks headless (make bench)
+
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+    #include <vmm/ray.h>
+}
+
+// Mesmos limites usados pelo main.cpp (a subdivisão da octree depende deles)
+#define BENCH_WORLD_SIZE 1024
+static const IVector3 BENCH_WORLD_MIN = {{-BENCH_WORLD_SIZE + 1, -BENCH_WORLD_SIZE + 1, -BENCH_WORLD_SIZE + 1}};
+static const IVector3 BENCH_WORLD_MAX = {{BENCH_WORLD_SIZE, BENCH_WORLD_SIZE, BENCH_WORLD_SIZE}};
+
+static inline double bench_now_ms(void) {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+// xorshift64*: determinístico para que as execuções sejam comparáveis
+typedef struct {
+    uint64_t state;
+} Bench_Rng;
+
+static inline uint64_t bench_rand(Bench_Rng *rng) {
+    rng->state ^= rng->state >> 12;
+    rng->state ^= rng->state << 25;
+    rng->state ^= rng->state >> 27;
+    return rng->state * 2685821657736338717ull;
+}
+
+static inline int bench_rand_range(Bench_Rng *rng, int lo, int hi) {
+    return lo + (int)(bench_rand(rng) % (uint64_t)(hi - lo));
+}
+
+static inline float bench_rand_float(Bench_Rng *rng) {
+    return (float)(bench_rand(rng) >> 40) / (float)(1ull << 24);
+}
+
+// Raio saindo de um ponto aleatório numa esfera em volta de 'center' e mirando um ponto
+// aleatório dentro de 'radius' (garante que a maioria dos raios atravessa a cena)
+static inline Ray bench_random_ray(Bench_Rng *rng, Vector3 center, float radius) {
+    Vector3 from, to;
+    do {
+        from = vec3_float(bench_rand_float(rng) * 2.0f - 1.0f, bench_rand_float(rng) * 2.0f - 1.0f, bench_rand_float(rng) * 2.0f - 1.0f);
+    } while (vec3_len(from) < 0.1f || vec3_len(from) > 1.0f);
+    from = vec3_add(center, vec3_scalar_mul(vec3_normalize(from), radius * 2.0f));
+    to = vec3_add(center, vec3_float((bench_rand_float(rng) - 0.5f) * radius, (bench_rand_float(rng) - 0.5f) * radius, (bench_rand_float(rng) - 0.5f) * radius));
+
+    Ray ray;
+    ray.origin = from;
+    ray.direction = vec3_normalize(vec3_sub(to, from));
+    return ray;
+}
+
+static inline void bench_header(const char *title) {
+    printf("\n=== %s ===\n", title);
+}
+
+#endif
@@ -0,0 +1,259 @@
+// Luz indireta assada por face (faceBake.hpp) numa cidade sintética: chão com prédios
+// maciços de alturas variadas e postes de luz nas ruas. Mede
+//  - assado inteiro: faces por segundo com uma thread e com todas, blocos, memória, bytes
+//    por face e tamanho do buffer da GPU;
+//  - convergência: erro RMS relativo de faces sorteadas com poucos caminhos contra uma
+//    referência com muitos, e o erro do RGB9E5;
+//  - edições: faces mandadas de volta ao assador e o tempo para assá-las, em prédios
+//    sorteados (bloco no telhado e tirá-lo, cubo 4³ na rua e tirá-lo), e quanto as faces
+//    fora do raio de invalidação ficam longe de um assado do zero;
+//  - arquivo: gravar, ler e conferir face por face.
+//
+// Uso: bench_bake [prédios por lado] [caminhos por face]   (padrão: 4 e 16)
+
+#include "bench.hpp"
+#include <world.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+static const int TOWER = 12;       //lado do prédio
+static const int STREET = 20;      //entre dois prédios
+static const int GROUND = 4;       //espessura do chão (y de -GROUND a -1)
+static const int EDITS = 8;        //prédios sorteados para cada edição
+static const int PROBES = 128;     //faces sorteadas para a convergência
+static const int REFERENCE_SAMPLES = 4096;
+static const char *BAKE_PATH = "/tmp/bench_bake.bake";
+
+typedef struct _city {
+    int side;
+    IVector3 min, max;
+    std::vector<int> heights;
+} City;
+
+static IVector3 _tower_min(const City *city, int i, int j) {
+    return {{city->min.x + STREET + i * (TOWER + STREET), 0, city->min.z + STREET + j * (TOWER + STREET)}};
+}
+
+static Voxel_Object _stone(IVector3 at) {
+    return VoxelObjCreate(voxels[VOX_STONE], make_color_rgba(130, 130, 135, 255), at);
+}
+
+static void _build(World *world, City *city) {
+    int extent = city->side * (TOWER + STREET) + STREET;
+    city->min = {{-extent / 2, -GROUND, -extent / 2}};
+    city->max = {{city->min.x + extent - 1, 64, city->min.z + extent - 1}};
+    world_fill(world, city->min, {{city->max.x, -1, city->max.z}},
+               VoxelObjCreate(voxels[VOX_DIRT], make_color_rgba(100, 80, 60, 255), city->min));
+
+    Bench_Rng rng = {0x5EEDull};
+    for (int i = 0; i < city->side; i++)
+    for (int j = 0; j < city->side; j++) {
+        int height = bench_rand_range(&rng, 8, 48);
+        city->heights.push_back(height);
+        IVector3 min = _tower_min(city, i, j);
+        world_fill(world, min, {{min.x + TOWER - 1, height - 1, min.z + TOWER - 1}}, _stone(min));
+
+        // Poste na esquina: haste de pedra e uma fonte em cima
+        IVector3 post = {{min.x - STREET / 2, 0, min.z - STREET / 2}};
+        world_fill(world, post, {{post.x, 5, post.z}}, _stone(post));
+        IVector3 lamp = {{post.x, 6, post.z}};
+        world_insert(world, VoxelObjCreate(voxels[VOX_LIGHT], make_color_rgba(255, 220, 160, 255), lamp));
+    }
+}
+
+typedef struct _face_ref {
+    IVector3 coord;
+    int face;
+} Face_Ref;
+
+// Todas as faces guardadas
+static std::vector<Face_Ref> _faces(const Face_Bake *bake) {
+    std::vector<Face_Ref> faces;
+    for (size_t i = 0; i < bake->capacity; i++) {
+        const Bake_Brick *brick = bake->table[i];
+        if (!brick) continue;
+        for (int bit = 0; bit < BAKE_BRICK_CELLS * 6; bit++) {
+            if (!((brick->exposed[bit >> 6] >> (bit & 63)) & 1ull)) continue;
+            int cell = bit / 6;
+            IVector3 at = {{cell % BAKE_BRICK_DIM, (cell / BAKE_BRICK_DIM) % BAKE_BRICK_DIM, cell / (BAKE_BRICK_DIM * BAKE_BRICK_DIM)}};
+            faces.push_back({ivec3_add(brick->origin, at), bit % 6});
+        }
+    }
+    return faces;
+}
+
+static float _luminance(Vector3 c) {
+    return 0.2126f * c.x + 0.7152f * c.y + 0.0722f * c.z;
+}
+
+static double _full_bake(World *world, int samples, int threads) {
+    world->threads = threads;
+    world_bake(world, samples);
+    double t0 = bench_now_ms();
+    world_update_bake(world, 0.0);
+    return bench_now_ms() - t0;
+}
+
+typedef struct _edit_stats {
+    double total_ms, max_ms;
+    double invalidated;
+    int count;
+} Edit_Stats;
+
+static void _rebake(World *world, Edit_Stats *stats) {
+    stats->invalidated += (double)world->bake->dirty;
+    double t0 = bench_now_ms();
+    world_update_bake(world, 0.0);
+    double ms = bench_now_ms() - t0;
+    stats->total_ms += ms;
+    if (ms > stats->max_ms) stats->max_ms = ms;
+    stats->count++;
+}
+
+static void _report(const char *label, const Edit_Stats *stats) {
+    printf("  %-28s %10.0f %8.1f %8.1f\n", label, stats->invalidated / stats->count, stats->total_ms / stats->count, stats->max_ms);
+}
+
+int main(int argc, char **argv) {
+    City city = {argc > 1 ? atoi(argv[1]) : 4, ivec3_zero(), ivec3_zero(), {}};
+    if (city.side < 1) city.side = 4;
+    int samples = argc > 2 ? atoi(argv[2]) : 16;
+    if (samples < 1) samples = 16;
+
+    World *world = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    double t0 = bench_now_ms();
+    _build(world, &city);
+    octree_compact(world->octree, 0);
+    world_set_sun(world, vec3_float(0.3481553f, 0.870388f, 0.3481553f));
+    printf("cidade %dx%d voxels, %d prédios com postes (montada em %.0f ms)\n",
+           city.max.x - city.min.x + 1, city.max.z - city.min.z + 1, city.side * city.side, bench_now_ms() - t0);
+
+    // --- Assado inteiro ---
+    double one_ms = _full_bake(world, samples, 1);
+    double all_ms = _full_bake(world, samples, 0);
+    size_t faces = world->bake->faces;
+    size_t buffer_size = 0;
+    int32_t *buffer = world_bake_buffer(world, &buffer_size);
+    free(buffer);
+    printf("  %zu faces, %d caminhos cada: %.0f ms com 1 thread (%.0f faces/s), %.0f ms com todas (%.0f faces/s)\n",
+           faces, samples, one_ms, faces * 1000.0 / one_ms, all_ms, faces * 1000.0 / all_ms);
+    printf("  %zu blocos de %d³, %.1f MB (%.1f bytes por face), buffer da GPU %.1f MB\n",
+           world->bake->count, BAKE_BRICK_DIM, face_bake_memory_usage(world->bake) / 1048576.0,
+           (double)face_bake_memory_usage(world->bake) / faces, buffer_size / 1048576.0);
+
+    // --- Convergência ---
+    std::vector<Face_Ref> all = _faces(world->bake);
+    Bench_Rng rng = {0xC0FFEEull};
+    std::vector<Face_Ref> probes(PROBES);
+    for (Face_Ref &p : probes) p = all[bench_rand(&rng) % all.size()];
+    Face_Bake *bake = world->bake;
+    std::vector<float> reference(PROBES);
+    double mean = 0.0;
+    for (int p = 0; p < PROBES; p++) {
+        reference[p] = _luminance(bake->trace(world, probes[p].coord, probes[p].face, bake->sun, REFERENCE_SAMPLES, 0xABCDull + p));
+        mean += reference[p] / PROBES;
+    }
+    printf("\nconvergência (%d faces, referência com %d caminhos, luminância média %.3f):\n", PROBES, REFERENCE_SAMPLES, mean);
+    printf("  caminhos   erro RMS   ms por face\n");
+    const int counts[5] = {1, 4, 16, 64, 256};
+    for (int count : counts) {
+        double error = 0.0;
+        t0 = bench_now_ms();
+        for (int p = 0; p < PROBES; p++) {
+            float value = _luminance(bake->trace(world, probes[p].coord, probes[p].face, bake->sun, count, 0x1234ull + p));
+            error += (double)(value - reference[p]) * (value - reference[p]);
+        }
+        double ms = (bench_now_ms() - t0) / PROBES;
+        printf("  %8d %9.1f%% %11.3f\n", count, 100.0 * sqrt(error / PROBES) / mean, ms);
+    }
+    double quantized = 0.0;
+    for (int p = 0; p < PROBES; p++) {
+        Vector3 value = bake->trace(world, probes[p].coord, probes[p].face, bake->sun, 16, 0x1234ull + p);
+        Vector3 packed = face_bake_unpack(face_bake_pack(value));
+        float l = _luminance(value);
+        if (l > 0.0f) quantized = fmax(quantized, fabs(_luminance(packed) - l) / l);
+    }
+    printf("  RGB9E5: erro máximo %.2f%%\n", 100.0 * quantized);
+
+    // --- Edições ---
+    printf("\nedições (%d prédios sorteados):   re-assadas ms médio   ms máx\n", EDITS);
+    Edit_Stats stats[4] = {};
+    for (int e = 0; e < EDITS; e++) {
+        int i = bench_rand_range(&rng, 0, city.side), j = bench_rand_range(&rng, 0, city.side);
+        IVector3 tower = _tower_min(&city, i, j);
+        int height = city.heights[i * city.side + j];
+
+        IVector3 roof = {{tower.x + TOWER / 2, height, tower.z + TOWER / 2}};
+        world_insert(world, _stone(roof));
+        _rebake(world, &stats[0]);
+        world_remove(world, roof);
+        _rebake(world, &stats[1]);
+
+        IVector3 cube = {{tower.x + TOWER + STREET / 2 - 2, 10, tower.z}};
+        world_fill(world, cube, ivec3_scalar_add(cube, 3), _stone(cube));
+        _rebake(world, &stats[2]);
+        world_clear_region(world, cube, ivec3_scalar_add(cube, 3));
+        _rebake(world, &stats[3]);
+    }
+    const char *labels[4] = {"bloco no telhado", "tirar o bloco", "cubo 4³ na rua", "tirar o cubo"};
+    for (int k = 0; k < 4; k++) _report(labels[k], &stats[k]);
+
+    // Um prédio novo de 8x16x8 que fica: com as mesmas sementes por face, só as faces fora do
+    // raio de invalidação podem diferir de um assado do zero (comparadas com o ruído do
+    // próprio assado: o erro RMS com os mesmos caminhos)
+    IVector3 block = {{_tower_min(&city, 0, 0).x + TOWER + 6, 0, _tower_min(&city, 0, 0).z}};
+    world_fill(world, block, {{block.x + 7, 15, block.z + 7}}, _stone(block));
+    world_update_bake(world, 0.0);
+    Face_Bake *edited = world->bake;
+    world->bake = NULL;
+    _full_bake(world, samples, 0);
+    size_t missing = 0, differ = 0;
+    double squared = 0.0, luminance = 0.0;
+    std::vector<Face_Ref> fresh = _faces(world->bake);
+    for (const Face_Ref &f : fresh) {
+        Vector3 a, b;
+        face_bake_lookup(world->bake, f.coord, f.face, &b);
+        if (!face_bake_lookup(edited, f.coord, f.face, &a)) {
+            missing++;
+            continue;
+        }
+        float la = _luminance(a), lb = _luminance(b);
+        luminance += lb / fresh.size();
+        if (la != lb) {
+            differ++;
+            squared += (double)(la - lb) * (la - lb);
+        }
+    }
+    printf("  editado contra assado do zero: %zu de %zu faces faltando (%zu no editado), %zu diferentes\n"
+           "  (RMS da diferença nelas %.1f%% da luminância média)\n",
+           missing, fresh.size(), edited->faces, differ, differ ? 100.0 * sqrt(squared / differ) / luminance : 0.0);
+    face_bake_delete(edited);
+
+    // --- Arquivo ---
+    t0 = bench_now_ms();
+    bool saved = world_save_bake(world, BAKE_PATH);
+    double save_ms = bench_now_ms() - t0;
+    Face_Bake *original = world->bake;
+    world->bake = NULL;
+    t0 = bench_now_ms();
+    bool loaded = world_load_bake(world, BAKE_PATH);
+    double load_ms = bench_now_ms() - t0;
+    size_t mismatched = 0;
+    for (const Face_Ref &f : fresh) {
+        Vector3 a = vec3_zero(), b = vec3_zero();
+        bool ha = face_bake_lookup(original, f.coord, f.face, &a), hb = loaded && face_bake_lookup(world->bake, f.coord, f.face, &b);
+        mismatched += ha != hb || a.x != b.x || a.y != b.y || a.z != b.z;
+    }
+    size_t file_size = 0;
+    uint8_t *image = face_bake_encode(original, &file_size);
+    free(image);
+    printf("\narquivo: %s (%.1f MB, %.1f bytes por face), gravado em %.0f ms, lido em %.0f ms, %zu faces diferentes\n",
+           saved && loaded ? "ok" : "FALHOU", file_size / 1048576.0, (double)file_size / faces, save_ms, load_ms, mismatched);
+    face_bake_delete(original);
+    remove(BAKE_PATH);
+
+    world_delete(world);
+    return 0;
+}
@@ -0,0 +1,141 @@
+// Cache de montagem do loader: reiniciar o servidor com os mesmos mapas. Para cada .vox,
+// a carga sem cache, a primeira com cache (monta e grava a entrada) e a seguinte (lê a
+// entrada), numa octree (load_vox_file) e num World (load_vox_world). O resultado do
+// acerto é conferido voxel a voxel contra a carga sem cache. No fim, um limite pequeno
+// mostra a remoção das entradas usadas há mais tempo.
+//
+// Uso: bench_cache [arquivo.vox ...]   (padrão: maps/*.vox)
+
+#include "bench.hpp"
+#include <world.hpp>
+#include <voxReader.hpp>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <string.h>
+
+static const char *CACHE_DIR = "bench_cache_dir";
+
+static bool _same(Voxel_Object a, Voxel_Object b) {
+    bool a_empty = a.coord.y == _invalid_voxel().coord.y, b_empty = b.coord.y == _invalid_voxel().coord.y;
+    if (a_empty || b_empty) return a_empty == b_empty;
+    return a.color == b.color && a.voxel.k == b.voxel.k;
+}
+
+typedef struct {
+    Octree *other;
+    World *world;
+    size_t count, errors;
+} Check_State;
+
+static void _check_tree(void *user, Voxel_Object voxel) {
+    Check_State *state = (Check_State*)user;
+    state->count++;
+    state->errors += !_same(voxel, octree_find(state->other, voxel.coord));
+}
+
+static void _check_world(void *user, Voxel_Object voxel) {
+    Check_State *state = (Check_State*)user;
+    state->count++;
+    state->errors += !_same(voxel, world_find(state->world, voxel.coord));
+}
+
+static size_t _entries(uintmax_t *bytes) {
+    size_t count = 0;
+    *bytes = 0;
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(CACHE_DIR, ec)) {
+        if (entry.path().extension() != ".svo") continue;
+        count++;
+        *bytes += entry.file_size();
+    }
+    return count;
+}
+
+static void _octree_case(const char *file) {
+    Octree *plain = octree_create(NULL, BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    double t0 = bench_now_ms();
+    load_vox_file(file, plain, 0, 0, 0, NULL);
+    double plain_ms = bench_now_ms() - t0;
+
+    Vox_Load_Options options = {};
+    options.cache_dir = CACHE_DIR;
+    Octree *miss = octree_create(NULL, BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    t0 = bench_now_ms();
+    load_vox_file(file, miss, 0, 0, 0, &options);
+    double miss_ms = bench_now_ms() - t0;
+
+    Octree *hit = octree_create(NULL, BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    t0 = bench_now_ms();
+    load_vox_file(file, hit, 0, 0, 0, &options);
+    double hit_ms = bench_now_ms() - t0;
+
+    Check_State a = {hit, NULL, 0, 0}, b = {plain, NULL, 0, 0};
+    octree_for_each(plain, _check_tree, &a);
+    octree_for_each(hit, _check_tree, &b);
+    printf("%-16s %-7s | %9.2f | %9.2f %9.2f %7.1fx | %8zu %6zu\n", file, "octree", plain_ms, miss_ms,
+           hit_ms, plain_ms / hit_ms, a.count, a.errors + b.errors + (a.count != b.count));
+    octree_delete(plain);
+    octree_delete(miss);
+    octree_delete(hit);
+}
+
+static void _world_case(const char *file) {
+    World *plain = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    double t0 = bench_now_ms();
+    load_vox_world(file, plain, 0, 0, 0, NULL);
+    double plain_ms = bench_now_ms() - t0;
+
+    Vox_Load_Options options = {};
+    options.cache_dir = CACHE_DIR;
+    World *miss = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    t0 = bench_now_ms();
+    load_vox_world(file, miss, 0, 0, 0, &options);
+    double miss_ms = bench_now_ms() - t0;
+
+    World *hit = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    t0 = bench_now_ms();
+    load_vox_world(file, hit, 0, 0, 0, &options);
+    double hit_ms = bench_now_ms() - t0;
+
+    // O acerto é o .svo mapeado: confere nos dois sentidos através da octree dele
+    Octree *cached = hit->backend == WORLD_BACKEND_SVO ? svo_map_to_octree(hit->svo) : NULL;
+    Check_State a = {NULL, hit, 0, 0}, b = {NULL, plain, 0, 0};
+    load_vox_for_each(file, _check_world, &a, 0, 0, 0);
+    if (cached) octree_for_each(cached, _check_world, &b);
+    printf("%-16s %-7s | %9.2f | %9.2f %9.2f %7.1fx | %8zu %6zu\n", file, world_backend_name(hit->backend),
+           plain_ms, miss_ms, hit_ms, plain_ms / hit_ms, a.count, a.errors + b.errors + !cached);
+    octree_delete(cached);
+    world_delete(plain);
+    world_delete(miss);
+    world_delete(hit);
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) files.push_back(argv[i]);
+    if (files.empty()) files = {"maps/dragon.vox", "maps/monu9.vox", "maps/nature.vox"};
+    std::error_code ec;
+    std::filesystem::remove_all(CACHE_DIR, ec);
+
+    printf("%-24s | %9s | %9s %9s %8s | %8s %6s\n", "mapa", "sem cache", "falta", "acerto", "ganho", "voxels", "erros");
+    for (const std::string &file : files) {
+        _octree_case(file.c_str());
+        _world_case(file.c_str());
+    }
+
+    // LRU: limite de ~1.5 entrada; cada carga nova apaga a mais antiga
+    uintmax_t bytes = 0;
+    size_t before = _entries(&bytes);
+    Vox_Load_Options options = {};
+    options.cache_dir = CACHE_DIR;
+    options.cache_max_bytes = before ? (size_t)(bytes / before * 3 / 2) : 1;
+    Octree *tree = octree_create(NULL, BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    load_vox_file(files[0].c_str(), tree, 1, 0, 0, &options);
+    size_t after = _entries(&bytes);
+    printf("\nLRU: %zu entradas antes, %zu depois de uma carga nova com limite de ~1.5 entrada (%.2f MB)\n",
+           before, after, bytes / 1048576.0);
+    octree_delete(tree);
+    std::filesystem::remove_all(CACHE_DIR, ec);
+    return 0;
+}
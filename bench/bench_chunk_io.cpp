@@ -0,0 +1,201 @@
+// E/S do chunk_store (chunkStore.hpp) com o cache de páginas frio: o mesmo arquivo lido
+// pela fila de cada Async_File (asyncFile.hpp) — uma leitura por vez como antes, o pool
+// de threads com pread e o io_uring (o padrão, quando o sistema deixa). Duas cargas:
+//  - rajada: todos os chunks pedidos de uma vez, em ordem aleatória (chunks/s e MB/s);
+//  - quadros: a cada 16,7 ms mais FRAME_REQUESTS chunks entram na fila, como a leitura
+//    adiantada de um voo rápido; latência de cada chunk do pedido até a imagem conferida.
+// Antes de cada rodada as páginas do arquivo são descartadas do cache (posix_fadvise).
+//
+// Uso: bench_chunk_io [arquivo.chunks]   (padrão: grava um mundo sintético e apaga no fim)
+
+#include "bench.hpp"
+#include <chunkGrid.hpp>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <math.h>
+#include <stdio.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char *STORE_PATH = "bench_chunk_io.chunks";
+static const int STORE_SIDE = 128;          //chunks por lado (uma camada só)
+static const int VARIANTS = 64;             //imagens diferentes, repetidas pelo arquivo
+static const size_t BURST_CHUNKS = 8192;
+static const size_t FRAME_CHUNKS = 6144;
+static const size_t FRAME_REQUESTS = 160;
+static const double FRAME_MS = 1000.0 / 60.0;
+
+static void _drop_cache(const char *path) {
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+#else
+    (void)path;
+#endif
+}
+
+// Chunk de terreno com minério espalhado: imagens de poucos KB a ~100 KB
+static Octree *_variant(Bench_Rng *rng, int n) {
+    Octree *tree = octree_create(NULL, {{0, 0, 0}}, {{CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE}});
+    Voxel_Object stone = VoxelObjCreate(voxels[VOX_STONE], make_color_rgba(120, 120, 125, 255), {{0, 0, 0}});
+    int height = 8 + n % 48;
+    octree_fill(tree, {{0, 0, 0}}, {{CHUNK_SIZE - 1, height, CHUNK_SIZE - 1}}, stone);
+    int ores = (n % 8) * 40;
+    for (int i = 0; i < ores; i++) {
+        IVector3 c = {{bench_rand_range(rng, 0, CHUNK_SIZE), bench_rand_range(rng, 0, height + 1), bench_rand_range(rng, 0, CHUNK_SIZE)}};
+        uint8_t shade = (uint8_t)bench_rand_range(rng, 40, 250);
+        octree_insert(tree, VoxelObjCreate(voxels[VOX_STONE], make_color_rgba(shade, shade / 2, 30, 255), c));
+    }
+    return tree;
+}
+
+static size_t _generate(size_t *bytes) {
+    Chunk_Store *store = chunk_store_create(STORE_PATH, {{-STORE_SIDE * CHUNK_SIZE / 2, 0, -STORE_SIDE * CHUNK_SIZE / 2}},
+                                            {{STORE_SIDE * CHUNK_SIZE / 2, CHUNK_SIZE, STORE_SIDE * CHUNK_SIZE / 2}}, CHUNK_LOG2, NULL);
+    if (!store) return 0;
+    Bench_Rng rng = {42};
+    std::vector<uint8_t*> images(VARIANTS);
+    std::vector<size_t> sizes(VARIANTS);
+    for (int i = 0; i < VARIANTS; i++) {
+        Octree *tree = _variant(&rng, i);
+        octree_compact(tree, 0);
+        images[i] = svo_file_encode(tree, &sizes[i]);
+        octree_delete(tree);
+    }
+    size_t chunks = 0;
+    for (int z = -STORE_SIDE / 2; z < STORE_SIDE / 2; z++)
+    for (int x = -STORE_SIDE / 2; x < STORE_SIDE / 2; x++) {
+        int v = (int)(bench_rand(&rng) % VARIANTS);
+        chunks += images[v] && chunk_store_write(store, {{x, 0, z}}, images[v], sizes[v]);
+    }
+    for (uint8_t *image : images) free(image);
+    chunk_store_flush(store);
+    *bytes = chunk_store_stats(store).write_bytes;
+    chunk_store_close(store);
+    return chunks;
+}
+
+static void _collect(void *user, const Chunk_Store_Entry *entry) {
+    ((std::vector<Chunk_Store_Entry>*)user)->push_back(*entry);
+}
+
+static double _percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, (size_t)(p * (values.size() - 1) + 0.5))];
+}
+
+typedef struct {
+    double ms;
+    size_t bytes, failed;
+    std::vector<double> latency;
+    Chunk_Store_Stats stats;
+} Run;
+
+// Pede 'entries' (rajada: tudo de uma vez; senão FRAME_REQUESTS por quadro) e espera
+// todas as leituras voltarem
+static bool _run(const char *path, Async_File_Backend backend, const std::vector<Chunk_Store_Entry> &entries,
+                 bool burst, Run *run, Async_File_Backend *used) {
+    _drop_cache(path);
+    Chunk_Store_Options options = {backend, 0};
+    Chunk_Store *store = chunk_store_open(path, &options);
+    if (!store) return false;
+    *used = chunk_store_io(store);
+    *run = Run();
+
+    std::vector<Chunk_Store_Load> loads(1024);
+    std::vector<Chunk_Store_Entry> queue;
+    size_t next = 0, received = 0;
+    double t0 = bench_now_ms(), frame = t0;
+    while (received < entries.size()) {
+        if (next < entries.size() && (burst || bench_now_ms() >= frame)) {
+            // A fila é trocada inteira: o que ainda não foi lido continua na frente
+            size_t add = burst ? entries.size() : std::min(FRAME_REQUESTS, entries.size() - next);
+            queue.insert(queue.end(), entries.begin() + next, entries.begin() + next + add);
+            next += add;
+            chunk_store_request(store, queue.data(), queue.size());
+            frame += FRAME_MS;
+        }
+        size_t count = chunk_store_poll(store, loads.data(), loads.size());
+        for (size_t i = 0; i < count; i++) {
+            run->failed += loads[i].map == NULL;
+            if (loads[i].map) run->bytes += loads[i].map->size;
+            run->latency.push_back(loads[i].ms);
+            svo_map_delete(loads[i].map);
+            if (burst) continue;
+            IVector3 c = loads[i].coord;
+            queue.erase(std::remove_if(queue.begin(), queue.end(), [c](const Chunk_Store_Entry &e) {
+                return e.coord[0] == c.x && e.coord[1] == c.y && e.coord[2] == c.z;
+            }), queue.end());
+        }
+        received += count;
+        if (count == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    run->ms = bench_now_ms() - t0;
+    run->stats = chunk_store_stats(store);
+    chunk_store_close(store);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const char *path = argc > 1 ? argv[1] : STORE_PATH;
+    if (argc <= 1) {
+        double t0 = bench_now_ms();
+        size_t bytes = 0;
+        size_t chunks = _generate(&bytes);
+        if (chunks == 0) {
+            printf("não deu para gravar %s\n", STORE_PATH);
+            return 1;
+        }
+        printf("%zu chunks, %.1f MB no disco, gravados em %.1f s\n", chunks, bytes / 1048576.0,
+               (bench_now_ms() - t0) / 1000.0);
+    }
+
+    std::vector<Chunk_Store_Entry> entries;
+    Chunk_Store_Options blocking = {ASYNC_FILE_BLOCKING, 0};
+    Chunk_Store *store = chunk_store_open(path, &blocking);
+    if (!store) {
+        printf("não deu para abrir %s\n", path);
+        return 1;
+    }
+    chunk_store_for_each(store, _collect, &entries);
+    chunk_store_close(store);
+    // Ordem sorteada a partir da do arquivo: a mesma para todas as filas
+    std::sort(entries.begin(), entries.end(), [](const Chunk_Store_Entry &a, const Chunk_Store_Entry &b) {
+        return a.offset < b.offset;
+    });
+    Bench_Rng rng = {7};
+    for (size_t i = entries.size(); i > 1; i--) std::swap(entries[i - 1], entries[bench_rand(&rng) % i]);
+
+    const Async_File_Backend backends[] = {ASYNC_FILE_BLOCKING, ASYNC_FILE_THREADS, ASYNC_FILE_URING};
+    for (int burst = 1; burst >= 0; burst--) {
+        size_t count = std::min(entries.size(), burst ? BURST_CHUNKS : FRAME_CHUNKS);
+        std::vector<Chunk_Store_Entry> sample(entries.begin(), entries.begin() + count);
+        if (burst) bench_header("rajada: todos os pedidos de uma vez");
+        else bench_header("quadros: mais pedidos a cada 16,7 ms");
+        if (burst) printf("%zu chunks\n", count);
+        else printf("%zu chunks, %zu por quadro\n", count, FRAME_REQUESTS);
+        printf("%-12s | %9s | %8s | %8s | %8s | %9s | %8s | %s\n", "", "chunks/s", "MB/s", "p50 ms", "p99 ms",
+               "pior ms", "em voo", "falhas");
+        for (Async_File_Backend backend : backends) {
+            Run run;
+            Async_File_Backend used;
+            if (!_run(path, backend, sample, burst, &run, &used)) {
+                printf("não deu para abrir %s\n", path);
+                return 1;
+            }
+            printf("%-12s | %9.0f | %8.1f | %8.2f | %8.2f | %9.2f | %8zu | %zu\n", async_file_backend_name(used),
+                   count * 1000.0 / run.ms, run.bytes / 1048576.0 * 1000.0 / run.ms, _percentile(run.latency, 0.5),
+                   _percentile(run.latency, 0.99), _percentile(run.latency, 1.0), run.stats.in_flight_max,
+                   run.failed);
+        }
+    }
+    if (argc <= 1) remove(STORE_PATH);
+    return 0;
+}
@@ -0,0 +1,225 @@
+// Mundo em chunks (chunkGrid.hpp) contra uma octree só, num terreno de 1024² colunas:
+// memória, tamanho do upload, custo de uma edição (a textura inteira contra só o chunk
+// tocado) e o custo de paginar andando pelo mapa. A memória e o upload são medidos para
+// alguns raios residentes. Depois das edições, células e raios aleatórios dos dois mundos
+// são comparados.
+//
+// Uso: bench_chunks
+
+#include "bench.hpp"
+#include <world.hpp>
+#include <math.h>
+#include <string.h>
+
+static const int TERRAIN_SIDE = 1024;
+static const int EDITS = 2000;
+static const int FULL_EDITS = 20;
+static const int CHECKS = 1000000;
+static const int RAYS = 200000;
+
+static int _height(int x, int z) {
+    return (int)(12.0f * sinf(x * 0.021f) + 9.0f * cosf(z * 0.017f) + 5.0f * sinf((x + z) * 0.05f));
+}
+
+// Colunas preenchidas de uma vez (ver world_fill): pedra por baixo, grama em cima
+static World *_terrain(void) {
+    World *world = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    Voxel_Object stone = VoxelObjCreate(voxels[VOX_STONE], make_color_rgba(120, 120, 125, 255), {{0, 0, 0}});
+    Voxel_Object grass = VoxelObjCreate(voxels[VOX_GRASS], make_color_rgba(70, 150, 60, 255), {{0, 0, 0}});
+    for (int z = -TERRAIN_SIDE / 2; z < TERRAIN_SIDE / 2; z++)
+    for (int x = -TERRAIN_SIDE / 2; x < TERRAIN_SIDE / 2; x++) {
+        int height = _height(x, z);
+        world_fill(world, {{x, -32, z}}, {{x, height - 1, z}}, stone);
+        grass.coord = {{x, height, z}};
+        world_insert(world, grass);
+    }
+    world_compact(world, 0);
+    return world;
+}
+
+static bool _same(Voxel_Object a, Voxel_Object b) {
+    bool a_empty = a.coord.y == _invalid_voxel().coord.y, b_empty = b.coord.y == _invalid_voxel().coord.y;
+    if (a_empty || b_empty) return a_empty == b_empty;
+    return a.color == b.color && a.voxel.k == b.voxel.k;
+}
+
+static IVector3 _near(Bench_Rng *rng, IVector3 center, int radius) {
+    int x = center.x + bench_rand_range(rng, -radius, radius), z = center.z + bench_rand_range(rng, -radius, radius);
+    return {{x, _height(x, z) + bench_rand_range(rng, -3, 4), z}};
+}
+
+static void _count_chunks(World *world, size_t *resident, size_t *packed) {
+    *resident = *packed = 0;
+    Chunk_Grid *grid = world->chunks;
+    for (size_t i = 0; i < grid->table_capacity; i++) {
+        Chunk *chunk = grid->table[i].chunk;
+        if (!chunk) continue;
+        if (chunk->tree) (*resident)++;
+        else if (chunk->packed) (*packed)++;
+    }
+}
+
+static size_t _uploaded;
+
+static void _count_upload(void *user, size_t first, size_t count) {
+    (void)user;
+    (void)first;
+    _uploaded += count;
+}
+
+int main(void) {
+    double t0 = bench_now_ms();
+    World *single = _terrain();
+    double build_ms = bench_now_ms() - t0;
+    // O mesmo caminho de world_set_backend: a octree colada chunk a chunk
+    World *chunked = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    world_set_backend(chunked, WORLD_BACKEND_CHUNKED, chunked->left_bot_back, chunked->left_bot_back);
+    t0 = bench_now_ms();
+    world_paste(chunked, single->octree, voxel_transform_translation({{0, 0, 0}}));
+    double split_ms = bench_now_ms() - t0;
+    printf("terreno %d² (%.0f ms), dividido em %zu chunks de %d³ em %.0f ms\n\n", TERRAIN_SIDE, build_ms,
+           chunked->chunks->count, CHUNK_SIZE, split_ms);
+
+    IVector3 camera = {{0, _height(0, 0) + 2, 0}};
+    size_t single_size = 0, chunked_size = 0, dir_size = 0, resident, packed;
+    t0 = bench_now_ms();
+    uint8_t *single_texture = world_texture(single, &single_size, 0);
+    double single_texture_ms = bench_now_ms() - t0;
+
+    printf("%-16s | %10s | %10s | %10s | %s\n", "", "memória MB", "upload MB", "textura ms", "residentes/guardados");
+    printf("%-16s | %10.1f | %10.1f | %10.1f |\n", "uma octree", world_memory_usage(single) / 1048576.0,
+           single_size / 1048576.0, single_texture_ms);
+    // Do maior raio para o menor; o último é o do jogo
+    const int radii[] = {6, 2, CHUNK_RESIDENT_RADIUS};
+    uint8_t *chunked_texture = NULL;
+    for (int radius : radii) {
+        t0 = bench_now_ms();
+        world_page_chunks(chunked, camera, radius);
+        double page_ms = bench_now_ms() - t0;
+        free(chunked_texture);
+        t0 = bench_now_ms();
+        chunked_texture = world_texture(chunked, &chunked_size, 0);
+        double chunked_texture_ms = bench_now_ms() - t0;
+        free(world_chunk_buffer(chunked, &dir_size));
+        _count_chunks(chunked, &resident, &packed);
+        char name[32];
+        snprintf(name, sizeof(name), "chunks, raio %d", radius);
+        printf("%-16s | %10.1f | %10.1f | %10.1f | %zu/%zu (paginação %.0f ms)\n", name, world_memory_usage(chunked) / 1048576.0,
+               (chunked_size + dir_size) / 1048576.0, chunked_texture_ms, resident, packed, page_ms);
+    }
+    printf("\n");
+
+    // Edições perto da câmera: a octree só reenvia a textura inteira, os chunks só a vaga do chunk
+    Bench_Rng rng = {23};
+    t0 = bench_now_ms();
+    for (int i = 0; i < FULL_EDITS; i++) {
+        world_insert(single, VoxelObjCreate(voxels[VOX_WOOD], make_color_rgba(200, 100, 50, 255), _near(&rng, camera, 200)));
+        size_t size = 0;
+        free(world_texture(single, &size, 0));
+    }
+    double single_edit_ms = (bench_now_ms() - t0) / FULL_EDITS;
+
+    rng = {23};
+    for (int i = 0; i < FULL_EDITS; i++) {
+        world_insert(chunked, VoxelObjCreate(voxels[VOX_WOOD], make_color_rgba(200, 100, 50, 255), _near(&rng, camera, 200)));
+    }
+    size_t capacity = chunked_size / 4;
+    world_sync_chunks(chunked, chunked_texture, capacity, NULL, NULL);
+    _uploaded = 0;
+    bool fits = true;
+    Bench_Rng edit_rng = {29};
+    t0 = bench_now_ms();
+    for (int i = 0; i < EDITS; i++) {
+        Voxel_Object voxel = VoxelObjCreate(voxels[bench_rand(&edit_rng) % 11], make_color_rgba(bench_rand(&edit_rng) % 256, 90, 40, 255),
+                                            _near(&edit_rng, camera, 300));
+        bool remove = bench_rand(&edit_rng) % 3 == 0;
+        if (remove) world_remove(chunked, voxel.coord);
+        else world_insert(chunked, voxel);
+        fits = world_sync_chunks(chunked, chunked_texture, capacity, _count_upload, NULL) && fits;
+    }
+    double chunked_edit_ms = (bench_now_ms() - t0) / EDITS;
+    size_t chunk_upload = _uploaded / EDITS;
+
+    edit_rng = {29};
+    for (int i = 0; i < EDITS; i++) {
+        Voxel_Object voxel = VoxelObjCreate(voxels[bench_rand(&edit_rng) % 11], make_color_rgba(bench_rand(&edit_rng) % 256, 90, 40, 255),
+                                            _near(&edit_rng, camera, 300));
+        bool remove = bench_rand(&edit_rng) % 3 == 0;
+        if (remove) world_remove(single, voxel.coord);
+        else world_insert(single, voxel);
+    }
+    printf("edição + upload: octree só %.2f ms (%.1f MB), chunks %.3f ms (%.1f KB em média)%s\n\n",
+           single_edit_ms, single_size / 1048576.0, chunked_edit_ms, chunk_upload * 4 / 1024.0,
+           fits ? "" : ", arena cheia");
+
+    // Andando pelo mapa: um passo de meio chunk por quadro, de uma ponta à outra (o salto
+    // até a ponta fica fora da conta)
+    IVector3 start = {{-TERRAIN_SIDE / 2, _height(-TERRAIN_SIDE / 2, -TERRAIN_SIDE / 4) + 2, -TERRAIN_SIDE / 4}};
+    world_page_chunks(chunked, start, CHUNK_RESIDENT_RADIUS);
+    if (!world_sync_chunks(chunked, chunked_texture, capacity, NULL, NULL)) {
+        free(chunked_texture);
+        chunked_texture = world_texture(chunked, &chunked_size, 0);
+        capacity = chunked_size / 4;
+    }
+    _uploaded = 0;
+    int frames = 0, rebuilds = 0;
+    double worst_ms = 0.0;
+    t0 = bench_now_ms();
+    for (int x = -TERRAIN_SIDE / 2; x < TERRAIN_SIDE / 2; x += CHUNK_SIZE / 2, frames++) {
+        double f0 = bench_now_ms();
+        IVector3 eye = {{x, _height(x, x / 2) + 2, x / 2}};
+        world_page_chunks(chunked, eye, CHUNK_RESIDENT_RADIUS);
+        if (!world_sync_chunks(chunked, chunked_texture, capacity, _count_upload, NULL)) {
+            free(chunked_texture);
+            chunked_texture = world_texture(chunked, &chunked_size, 0);
+            capacity = chunked_size / 4;
+            _uploaded += capacity;
+            rebuilds++;
+        }
+        size_t size = 0;
+        if (world_update_chunks(chunked)) free(world_chunk_buffer(chunked, &size));
+        double frame_ms = bench_now_ms() - f0;
+        if (frame_ms > worst_ms) worst_ms = frame_ms;
+    }
+    double walk_ms = bench_now_ms() - t0;
+    _count_chunks(chunked, &resident, &packed);
+    printf("andando %d quadros: %.2f ms por quadro (pior %.1f ms), %.1f MB enviados por quadro, %d texturas inteiras\n",
+           frames, walk_ms / frames, worst_ms, _uploaded * 4 / 1048576.0 / frames, rebuilds);
+    printf("no fim: %zu chunks residentes, %zu guardados, %.1f MB\n\n", resident, packed,
+           world_memory_usage(chunked) / 1048576.0);
+
+    // Conferência: o mundo em chunks (com chunks residentes e guardados) contra a octree só
+    Bench_Rng check_rng = {31};
+    size_t errors = 0;
+    t0 = bench_now_ms();
+    for (int i = 0; i < CHECKS; i++) {
+        IVector3 c = _near(&check_rng, {{0, 0, 0}}, TERRAIN_SIDE / 2);
+        errors += !_same(world_find(single, c), world_find(chunked, c));
+    }
+    double find_ms = bench_now_ms() - t0;
+
+    size_t ray_errors = 0, hits = 0;
+    double single_ray_ms = 0.0, chunked_ray_ms = 0.0;
+    for (int i = 0; i < RAYS; i++) {
+        Ray ray = bench_random_ray(&check_rng, vec3_float(0.0f, 0.0f, 0.0f), TERRAIN_SIDE * 0.4f);
+        Voxel_Object a, b;
+        double r0 = bench_now_ms();
+        bool hit_a = world_ray_cast(single, ray, &a);
+        double r1 = bench_now_ms();
+        bool hit_b = world_ray_cast(chunked, ray, &b);
+        double r2 = bench_now_ms();
+        single_ray_ms += r1 - r0;
+        chunked_ray_ms += r2 - r1;
+        hits += hit_a;
+        ray_errors += hit_a != hit_b || (hit_a && !ivec3_equal_vec(a.coord, b.coord));
+    }
+    printf("%d células: %zu erros (%.0f ns por par de consultas)\n", CHECKS, errors, find_ms * 1e6 / CHECKS);
+    printf("%d raios (%zu acertos): %zu diferentes, octree só %.2f us, chunks %.2f us por raio\n", RAYS, hits,
+           ray_errors, single_ray_ms * 1e3 / RAYS, chunked_ray_ms * 1e3 / RAYS);
+
+    free(single_texture);
+    free(chunked_texture);
+    world_delete(single);
+    world_delete(chunked);
+    return 0;
+}
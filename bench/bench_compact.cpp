@@ -0,0 +1,188 @@
+// Mede a compactação adiada da octree: uma rajada de edições (remoções e trocas de
+// material) seguida do desfazer de todas elas, comparando
+//   ansiosa = octree_compact logo após cada edição (o custo do merge a cada insert),
+//   adiada  = octree_compact uma vez por "frame" de 64 edições, com orçamento de 1 ms.
+// Ao final as duas árvores precisam ser idênticas (nó a nó) à reconstrução da cena.
+//
+// Uso: bench_compact [arquivo.vox ...]   (padrão: maps/nature.vox)
+
+#include <bench.hpp>
+#include <octree.hpp>
+#include <voxReader.hpp>
+#include <vector>
+#include <math.h>
+#include <string.h>
+
+static const int EDITS = 20000;
+static const int EDITS_PER_FRAME = 64;
+static const double FRAME_BUDGET_MS = 1.0;
+
+static void _terrain_scene(int n, std::vector<Voxel_Object> *out) {
+    for (int z = 0; z < n; z++)
+    for (int x = 0; x < n; x++) {
+        int h = (int)(24.0f + 12.0f * sinf(x * 0.05f) * cosf(z * 0.07f) + 6.0f * sinf((x + z) * 0.13f));
+        for (int y = 0; y <= h; y++) {
+            Voxel_Type type = y == h ? VOX_GRASS : (y > h - 4 ? VOX_DIRT : VOX_STONE);
+            out->push_back(VoxelObjCreate(voxels[type], voxelColors[type], {{x - n / 2, y, z - n / 2}}));
+        }
+    }
+}
+
+// Mesma forma e mesmo conteúdo em cada nó
+static bool _same_tree(Octree *a, Octree *b) {
+    if ((a->children != NULL) != (b->children != NULL)) return false;
+    if (a->children) {
+        for (int i = 0; i < 8; i++) {
+            if (!_same_tree(a->children[i], b->children[i])) return false;
+        }
+        return true;
+    }
+    if (a->has_voxel != b->has_voxel) return false;
+    if (!a->has_voxel) return true;
+    return a->is_point == b->is_point && a->voxel.color == b->voxel.color
+        && ivec3_equal_vec(a->voxel.coord, b->voxel.coord);
+}
+
+typedef struct {
+    IVector3 coord;
+    Voxel_Object original;
+    bool recolor; // troca de material em vez de remover
+} Edit;
+
+static void _apply(Octree *tree, const Edit &e, bool undo) {
+    if (undo) octree_insert(tree, e.original);
+    else if (e.recolor) octree_insert(tree, VoxelObjCreate(voxels[VOX_WOOD], voxelColors[VOX_WOOD], e.coord));
+    else octree_remove(tree, e.coord);
+}
+
+static Octree *_build(const std::vector<Voxel_Object> &scene) {
+    Octree *tree = octree_create(NULL, BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    for (const Voxel_Object &v : scene) octree_insert(tree, v);
+    octree_compact(tree, 0);
+    return tree;
+}
+
+static void _run_scene(const char *name, const std::vector<Voxel_Object> &scene) {
+    Bench_Rng rng = {555};
+    std::vector<Edit> edits(EDITS);
+    for (Edit &e : edits) {
+        e.original = scene[bench_rand(&rng) % scene.size()];
+        e.coord = e.original.coord;
+        e.recolor = bench_rand(&rng) % 2;
+    }
+
+    double t0 = bench_now_ms();
+    Octree *reference = _build(scene);
+    double rebuild_ms = bench_now_ms() - t0;
+    size_t reference_memory = octree_memory_usage(reference);
+
+    // Carga inteira sem fusões, compactada aos poucos (1 ms por frame)
+    Octree *bulk = octree_create(NULL, BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    for (const Voxel_Object &v : scene) octree_insert(bulk, v);
+    int bulk_frames = 1;
+    while (!octree_compact(bulk, FRAME_BUDGET_MS)) bulk_frames++;
+    bool bulk_ok = _same_tree(bulk, reference);
+    octree_delete(bulk);
+
+    // --- Ansiosa: fecha o caminho editado a cada edição ---
+    Octree *eager = _build(scene);
+    t0 = bench_now_ms();
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < EDITS; i++) {
+            _apply(eager, edits[pass ? EDITS - 1 - i : i], pass == 1);
+            octree_compact(eager, 0);
+        }
+    }
+    double eager_ms = bench_now_ms() - t0;
+
+    // --- Adiada: compacta uma vez por frame, dentro do orçamento ---
+    Octree *deferred = _build(scene);
+    double edit_ms = 0.0, compact_ms = 0.0, worst_frame_ms = 0.0;
+    size_t peak_memory = 0;
+    int frames = 0, unfinished_frames = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < EDITS; i += EDITS_PER_FRAME) {
+            t0 = bench_now_ms();
+            for (int k = i; k < i + EDITS_PER_FRAME && k < EDITS; k++) {
+                _apply(deferred, edits[pass ? EDITS - 1 - k : k], pass == 1);
+            }
+            edit_ms += bench_now_ms() - t0;
+            if (pass == 0 && i + EDITS_PER_FRAME >= EDITS) peak_memory = octree_memory_usage(deferred);
+
+            t0 = bench_now_ms();
+            bool done = octree_compact(deferred, FRAME_BUDGET_MS);
+            double frame_ms = bench_now_ms() - t0;
+            compact_ms += frame_ms;
+            if (frame_ms > worst_frame_ms) worst_frame_ms = frame_ms;
+            unfinished_frames += !done;
+            frames++;
+        }
+    }
+    // Termina o que o último frame não coube no orçamento
+    t0 = bench_now_ms();
+    while (!octree_compact(deferred, FRAME_BUDGET_MS)) frames++;
+    compact_ms += bench_now_ms() - t0;
+
+    // Sem compactação nenhuma (a deriva que a árvore acumulava antes)
+    Octree *never = _build(scene);
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < EDITS; i++) _apply(never, edits[pass ? EDITS - 1 - i : i], pass == 1);
+    }
+    size_t drift_memory = octree_memory_usage(never);
+
+    bool eager_ok = _same_tree(eager, reference);
+    bool deferred_ok = _same_tree(deferred, reference);
+
+    printf("%-12s %8zu | %8.1f %6d %8.1f | %8.1f %8.1f %7.2f %6d/%-5d | %9.1f %9.1f %9.1f | %s %s %s\n",
+           name, scene.size(), rebuild_ms, bulk_frames, eager_ms,
+           edit_ms, compact_ms, worst_frame_ms, unfinished_frames, frames,
+           reference_memory / 1024.0, peak_memory / 1024.0, drift_memory / 1024.0,
+           bulk_ok ? "ok" : "DIFERE", eager_ok ? "ok" : "DIFERE", deferred_ok ? "ok" : "DIFERE");
+
+    octree_delete(reference);
+    octree_delete(eager);
+    octree_delete(deferred);
+    octree_delete(never);
+}
+
+static void _collect(void *user, Voxel_Object voxel) {
+    ((std::vector<Voxel_Object>*)user)->push_back(voxel);
+}
+
+int main(int argc, char **argv) {
+    bench_header("octree: compactação adiada vs a cada edição");
+    printf("%-12s %8s | %8s %6s %8s | %8s %8s %7s %12s | %9s %9s %9s | %s\n",
+           "cena", "voxels", "rebuild", "frames", "ansiosa",
+           "edições", "compact", "pior fr", "frames parc",
+           "KB final", "KB pico", "KB deriva",
+           "canônica (carga/ans/adi)");
+
+    std::vector<Voxel_Object> scene;
+    _terrain_scene(256, &scene);
+    _run_scene("terrain256", scene);
+
+    const char *default_maps[] = {"maps/nature.vox"};
+    int count = argc > 1 ? argc - 1 : 1;
+    for (int i = 0; i < count; i++) {
+        const char *path = argc > 1 ? argv[i + 1] : default_maps[i];
+        Octree *tmp = octree_create(NULL, BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+        if (!load_vox_file(path, tmp, 0, 0, 0, NULL)) {
+            octree_delete(tmp);
+            continue;
+        }
+        scene.clear();
+        octree_for_each(tmp, _collect, &scene);
+        octree_delete(tmp);
+        if (scene.empty()) continue;
+
+        const char *name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+        _run_scene(name, scene);
+    }
+
+    printf("\nframes = frames de %.0f ms para compactar a cena carregada sem fusões;\n"
+           "tempos em ms para %d edições + %d desfazer; pior fr = maior compactação num frame;\n"
+           "frames parc = frames em que o orçamento de %.0f ms acabou antes do fim;\n"
+           "KB pico = logo após a rajada, antes de compactar; KB deriva = desfazendo tudo sem nunca compactar\n",
+           FRAME_BUDGET_MS, EDITS, EDITS, FRAME_BUDGET_MS);
+    return 0;
+}
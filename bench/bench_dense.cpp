@@ -0,0 +1,176 @@
+// Compara a octree com a grade densa (bits de ocupação + paleta) em cenas sintéticas
+// de tamanho e densidade crescentes, para achar o ponto de cruzamento entre os backends.
+//
+// Uso: bench_dense [arquivo.vox ...]   (padrão: maps/dragon.vox)
+
+#include <bench.hpp>
+#include <octree.hpp>
+#include <denseGrid.hpp>
+#include <world.hpp>
+#include <voxReader.hpp>
+#include <vector>
+#include <math.h>
+
+typedef struct {
+    const char *name;
+    int size;
+    float density;
+} Scene_Desc;
+
+static void _generate_scene(const Scene_Desc *desc, std::vector<Voxel_Object> *out) {
+    Bench_Rng rng = {0x9E3779B97F4A7C15ull ^ (uint64_t)desc->size};
+    int n = desc->size;
+    int base = -n / 2;
+
+    for (int z = 0; z < n; z++)
+    for (int y = 0; y < n; y++)
+    for (int x = 0; x < n; x++) {
+        bool solid;
+        if (desc->density > 0.0f) {
+            // Ocupação aleatória uniforme (pior caso para a octree)
+            solid = bench_rand_float(&rng) < desc->density;
+        } else {
+            // Casca de esfera (cena de superfície, densidade ~3/n)
+            float dx = x - n * 0.5f + 0.5f, dy = y - n * 0.5f + 0.5f, dz = z - n * 0.5f + 0.5f;
+            float r = sqrtf(dx * dx + dy * dy + dz * dz);
+            solid = fabsf(r - n * 0.45f) < 0.75f;
+        }
+        if (!solid) continue;
+
+        int c = (x / 4 + y / 4 + z / 4) % 4;
+        out->push_back(VoxelObjCreate(voxels[VOX_STONE], voxelColors[c], {{base + x, base + y, base + z}}));
+    }
+}
+
+typedef struct {
+    size_t memory;
+    double build_ms, find_ns, ray_ns;
+    int hits;
+} Backend_Result;
+
+static void _print_row(const char *scene, int size, double density, const Backend_Result *oct, const Backend_Result *den, World_Backend picked) {
+    const char *mem_winner = den->memory < oct->memory ? "dense" : "octree";
+    const char *ray_winner = den->ray_ns < oct->ray_ns ? "dense" : "octree";
+    printf("%-8s %5d %8.4f | %10.1f %8.1f %8.1f | %10.1f %8.1f %8.1f | %-6s %-6s | %s\n",
+           scene, size, density,
+           oct->memory / 1024.0, oct->find_ns, oct->ray_ns,
+           den->memory / 1024.0, den->find_ns, den->ray_ns,
+           mem_winner, ray_winner, world_backend_name(picked));
+}
+
+static void _run_scene(const char *name, const std::vector<Voxel_Object> &scene, double density, int size) {
+    const int FIND_QUERIES = 200000;
+    const int RAYS = 20000;
+
+    IVector3 vmin = scene[0].coord, vmax = scene[0].coord;
+    for (const Voxel_Object &v : scene) {
+        vmin = ivec3_min(vmin, v.coord);
+        vmax = ivec3_max(vmax, v.coord);
+    }
+    Vector3 center = vec3_scalar_mul(vec3_ivec3(ivec3_add(vmin, vmax)), 0.5f);
+    float radius = (float)(vmax.x - vmin.x + 1);
+
+    // Mesmas consultas para os dois backends
+    Bench_Rng rng = {1234};
+    std::vector<IVector3> queries(FIND_QUERIES);
+    for (IVector3 &q : queries) {
+        q = {{bench_rand_range(&rng, vmin.x, vmax.x + 1), bench_rand_range(&rng, vmin.y, vmax.y + 1), bench_rand_range(&rng, vmin.z, vmax.z + 1)}};
+    }
+    std::vector<Ray> rays(RAYS);
+    for (Ray &r : rays) r = bench_random_ray(&rng, center, radius);
+
+    Backend_Result oct = {0}, den = {0};
+    volatile int sink = 0;
+
+    // --- Octree ---
+    double t0 = bench_now_ms();
+    Octree *tree = octree_create(NULL, BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    for (const Voxel_Object &v : scene) octree_insert(tree, v);
+    octree_compact(tree, 0);
+    oct.build_ms = bench_now_ms() - t0;
+    oct.memory = octree_memory_usage(tree);
+
+    t0 = bench_now_ms();
+    for (const IVector3 &q : queries) sink += octree_find(tree, q).coord.y;
+    oct.find_ns = (bench_now_ms() - t0) * 1e6 / FIND_QUERIES;
+
+    t0 = bench_now_ms();
+    for (const Ray &r : rays) {
+        Octree *hit = octree_ray_cast(tree, r, vec3_ivec3(BENCH_WORLD_MIN), vec3_ivec3(BENCH_WORLD_MAX));
+        if (hit) oct.hits++;
+    }
+    oct.ray_ns = (bench_now_ms() - t0) * 1e6 / RAYS;
+    octree_delete(tree);
+
+    // --- Grade densa ---
+    t0 = bench_now_ms();
+    Dense_Grid *grid = dense_grid_create(vmin, ivec3_scalar_add(vmax, 1));
+    for (const Voxel_Object &v : scene) dense_grid_insert(grid, v);
+    den.build_ms = bench_now_ms() - t0;
+    den.memory = dense_grid_memory_usage(grid);
+
+    t0 = bench_now_ms();
+    for (const IVector3 &q : queries) sink += dense_grid_find(grid, q).coord.y;
+    den.find_ns = (bench_now_ms() - t0) * 1e6 / FIND_QUERIES;
+
+    t0 = bench_now_ms();
+    for (const Ray &r : rays) {
+        if (dense_grid_ray_cast(grid, r, NULL, NULL)) den.hits++;
+    }
+    den.ray_ns = (bench_now_ms() - t0) * 1e6 / RAYS;
+    dense_grid_delete(grid);
+
+    (void)sink;
+    _print_row(name, size, density, &oct, &den, world_pick_backend(vmin, vmax, scene.size()));
+}
+
+static void _collect(void *user, Voxel_Object voxel) {
+    ((std::vector<Voxel_Object>*)user)->push_back(voxel);
+}
+
+int main(int argc, char **argv) {
+    bench_header("octree vs grade densa");
+    printf("%-8s %5s %8s | %10s %8s %8s | %10s %8s %8s | %-6s %-6s | %s\n",
+           "cena", "lado", "densid.", "oct KB", "find ns", "ray ns", "dense KB", "find ns", "ray ns", "mem", "ray", "auto");
+
+    const int sizes[] = {16, 32, 64, 128, 256};
+    const float densities[] = {0.0f, 0.0002f, 0.001f, 0.01f, 0.05f, 0.25f};
+
+    for (int s : sizes) {
+        for (float d : densities) {
+            Scene_Desc desc = {d > 0.0f ? "random" : "shell", s, d};
+            std::vector<Voxel_Object> scene;
+            _generate_scene(&desc, &scene);
+            if (scene.empty()) continue;
+            double real_density = (double)scene.size() / ((double)s * s * s);
+            _run_scene(desc.name, scene, real_density, s);
+        }
+    }
+
+    // Mapas reais
+    const char *default_map = "maps/dragon.vox";
+    int first = argc > 1 ? 1 : 0;
+    for (int i = first; i < (argc > 1 ? argc : 1); i++) {
+        const char *path = argc > 1 ? argv[i] : default_map;
+        Octree *tree = octree_create(NULL, BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+        if (!load_vox_file(path, tree, 0, 0, 0, NULL)) {
+            octree_delete(tree);
+            continue;
+        }
+        std::vector<Voxel_Object> scene;
+        octree_for_each(tree, _collect, &scene);
+        octree_delete(tree);
+        if (scene.empty()) continue;
+
+        IVector3 vmin = scene[0].coord, vmax = scene[0].coord;
+        for (const Voxel_Object &v : scene) {
+            vmin = ivec3_min(vmin, v.coord);
+            vmax = ivec3_max(vmax, v.coord);
+        }
+        IVector3 ext = ivec3_scalar_add(ivec3_sub(vmax, vmin), 1);
+        double density = (double)scene.size() / ((double)ext.x * ext.y * ext.z);
+        _run_scene("vox", scene, density, ext.x > ext.y ? (ext.x > ext.z ? ext.x : ext.z) : (ext.y > ext.z ? ext.y : ext.z));
+        printf("         (%s: %zu voxels, extensão %dx%dx%d)\n", path, scene.size(), ext.x, ext.y, ext.z);
+    }
+    return 0;
+}
@@ -0,0 +1,324 @@
+// Campo de distância (distanceField.hpp): maps/nature.vox renderizado sem GPU pela mesma
+// descida do shader (svo_map_ray_cast_cone), com e sem os atalhos do campo.
+// Mede
+//  - montagem: o campo inteiro a partir do World carregado (com 1 thread e com todas) e a
+//    partir da octree do arquivo;
+//  - edições: inserir/apagar um voxel e preencher/apagar uma caixa no ar, refazendo só a
+//    vizinhança, conferido contra o campo refeito do zero;
+//  - raios da câmera (de um canto alto e rente ao chão, com cone de 0 e de 1 pixel) e
+//    aleatórios em volta da cena: passos e leituras por raio, e quantos acertos mudam com o campo;
+//  - sombras: dos acertos da câmera até um sol baixo; passos por raio e a fração que
+//    termina dentro do limite de 64 passos de notInShadow.
+//
+// Uso: bench_distance [arquivo.vox]
+
+#include "bench.hpp"
+#include <svoFile.hpp>
+#include <voxReader.hpp>
+#include <world.hpp>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const int WIDTH = 320, HEIGHT = 180;
+static const float FOV_DEGREES = 45.0f;
+static const int RANDOM_RAYS = 20000;
+static const int SHADOW_STEP_LIMIT = 64; //o de notInShadow no shader
+static const Vector3 SUN = vec3_normalize(vec3_float(0.7f, 0.3f, 0.2f));
+
+typedef struct _view {
+    Vector3 eye, forward, right, up;
+    float pixel_angle;
+} View;
+
+typedef struct _cast_result {
+    std::vector<bool> hits;
+    std::vector<IVector3> cells;
+    std::vector<Vector3> points; //fora do voxel atingido, para as sombras
+    double steps, fetches, ms;
+} Cast_Result;
+
+static Ray _pixel_ray(const View *view, int px, int py) {
+    float half = tanf(FOV_DEGREES * 0.5f * (float)M_PI / 180.0f);
+    float u = ((px + 0.5f) / WIDTH * 2.0f - 1.0f) * half * WIDTH / HEIGHT;
+    float v = (1.0f - (py + 0.5f) / HEIGHT * 2.0f) * half;
+    Vector3 dir = vec3_add(view->forward, vec3_add(vec3_scalar_mul(view->right, u), vec3_scalar_mul(view->up, v)));
+    return ray_create(view->eye, vec3_normalize(dir));
+}
+
+// Ponto logo antes da célula atingida (entrada do raio nela)
+static Vector3 _entry_point(Ray ray, IVector3 cell) {
+    float o[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+    float d[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+    int c[3] = {cell.x, cell.y, cell.z};
+    float t = 0.0f;
+    for (int a = 0; a < 3; a++) {
+        if (fabsf(d[a]) < 1e-8f) continue;
+        float t0 = ((float)c[a] - o[a]) / d[a], t1 = ((float)(c[a] + 1) - o[a]) / d[a];
+        t = fmaxf(t, fminf(t0, t1));
+    }
+    return vec3_add(ray.origin, vec3_scalar_mul(ray.direction, fmaxf(t - 0.01f, 0.0f)));
+}
+
+static void _cast(Svo_Map *map, const std::vector<Ray> &rays, const std::vector<float> &widths, float spread, Cast_Result *out) {
+    out->hits.assign(rays.size(), false);
+    out->cells.assign(rays.size(), ivec3_zero());
+    out->points.assign(rays.size(), vec3_float(0, 0, 0));
+    Ray_Stats stats = {0, 0};
+    double t0 = bench_now_ms();
+    for (size_t i = 0; i < rays.size(); i++) {
+        Voxel_Object hit;
+        float width = widths.empty() ? 0.0f : widths[i];
+        if (!svo_map_ray_cast_cone(map, rays[i], width, spread, &hit, &stats)) continue;
+        out->hits[i] = true;
+        out->cells[i] = hit.coord;
+    }
+    out->ms = bench_now_ms() - t0;
+    out->steps = rays.empty() ? 0 : (double)stats.steps / rays.size();
+    out->fetches = rays.empty() ? 0 : (double)stats.fetches / rays.size();
+    for (size_t i = 0; i < rays.size(); i++) {
+        if (out->hits[i]) out->points[i] = _entry_point(rays[i], out->cells[i]);
+    }
+}
+
+static size_t _mismatches(const Cast_Result &a, const Cast_Result &b) {
+    size_t count = 0;
+    for (size_t i = 0; i < a.hits.size(); i++) {
+        if (a.hits[i] != b.hits[i] || (a.hits[i] && !ivec3_equal_vec(a.cells[i], b.cells[i]))) count++;
+    }
+    return count;
+}
+
+static void _compare(const char *label, Svo_Map *map, const Distance_Field *field, const std::vector<Ray> &rays,
+                     const std::vector<float> &widths, float spread, Cast_Result *plain_out) {
+    Cast_Result plain, skipped;
+    map->distance = NULL;
+    _cast(map, rays, widths, spread, &plain);
+    map->distance = field;
+    _cast(map, rays, widths, spread, &skipped);
+    map->distance = NULL;
+    printf("  %-22s %8.1f %8.1f %8.1f %8.1f %7.2fx %9.3f %9.3f %9zu\n", label,
+           plain.steps, skipped.steps, plain.fetches, skipped.fetches,
+           skipped.steps > 0 ? plain.steps / skipped.steps : 0.0,
+           plain.ms * 1000.0 / rays.size(), skipped.ms * 1000.0 / rays.size(), _mismatches(plain, skipped));
+    if (plain_out) *plain_out = plain;
+}
+
+// Sombras dos acertos até o sol, uma a uma para contar quantas cabem no limite do shader
+static void _shadows(Svo_Map *map, const Distance_Field *field, const Cast_Result &base) {
+    size_t rays = 0, within[2] = {0, 0}, differ = 0;
+    double steps[2] = {0, 0};
+    for (size_t i = 0; i < base.hits.size(); i++) {
+        if (!base.hits[i]) continue;
+        Ray ray = ray_create(base.points[i], SUN);
+        bool shadow[2];
+        for (int use = 0; use < 2; use++) {
+            Ray_Stats stats = {0, 0};
+            map->distance = use ? field : NULL;
+            shadow[use] = svo_map_ray_cast_cone(map, ray, 0.0f, 0.0f, NULL, &stats);
+            steps[use] += stats.steps;
+            within[use] += stats.steps <= SHADOW_STEP_LIMIT;
+        }
+        differ += shadow[0] != shadow[1];
+        rays++;
+    }
+    map->distance = NULL;
+    if (!rays) return;
+    printf("  %-22s %8.1f %8.1f %17s %7.2fx   dentro de %d passos: %.1f%% -> %.1f%%   diferentes: %zu\n", "sombras",
+           steps[0] / rays, steps[1] / rays, "", steps[1] > 0 ? steps[0] / steps[1] : 0.0, SHADOW_STEP_LIMIT,
+           100.0 * within[0] / rays, 100.0 * within[1] / rays, differ);
+}
+
+static void _mark_box(void *user, IVector3 vox_min, IVector3 vox_max) {
+    distance_field_mark((Distance_Field*)user, vox_min, vox_max);
+}
+
+static size_t _cell_count(const Distance_Field *field) {
+    return (size_t)field->cells.x * (size_t)field->cells.y * (size_t)field->cells.z;
+}
+
+// O campo do mundo depois das edições tem que ser igual ao refeito do zero
+static bool _world_occupied(void *user, IVector3 vox_min, IVector3 vox_max) {
+    World *world = (World*)user;
+    for (int z = vox_min.z; z <= vox_max.z; z++)
+    for (int y = vox_min.y; y <= vox_max.y; y++)
+    for (int x = vox_min.x; x <= vox_max.x; x++) {
+        if (world_find_static(world, {{x, y, z}}).coord.y != _invalid_voxel().coord.y) return true;
+    }
+    return false;
+}
+
+// Refaz do zero, voxel a voxel, um campo com as mesmas células do editado (o refeito pelo
+// World mudaria de caixa ao crescer a cena) e compara as distâncias
+static bool _matches_rebuild(World *world) {
+    const Distance_Field *edited = world->distance;
+    Distance_Field *fresh = distance_field_create(edited->left_bot_back, ivec3_scalar_add(edited->left_bot_back, 1),
+                                                  BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    fresh->left_bot_back = edited->left_bot_back;
+    fresh->right_top_front = edited->right_top_front;
+    fresh->cells = edited->cells;
+    fresh->cell_log2 = edited->cell_log2;
+    size_t count = _cell_count(edited);
+    fresh->occupied = (uint8_t*)realloc(fresh->occupied, count);
+    fresh->distance = (uint8_t*)realloc(fresh->distance, count);
+    memset(fresh->occupied, 2, count); //tudo pendente
+    fresh->dirty_min = ivec3_zero();
+    fresh->dirty_max = ivec3_scalar_add(fresh->cells, -1);
+    distance_field_update(fresh, _world_occupied, world, 0);
+    bool same = memcmp(edited->distance, fresh->distance, count) == 0;
+    distance_field_delete(fresh);
+    return same;
+}
+
+static void _edit(const char *label, World *world, void (*fn)(World *world, IVector3 at), IVector3 at) {
+    double t0 = bench_now_ms();
+    fn(world, at);
+    double edit_ms = bench_now_ms() - t0;
+    t0 = bench_now_ms();
+    world_update_distance(world);
+    double update_ms = bench_now_ms() - t0;
+    printf("  %-28s edição %7.3f ms   update %7.3f ms   igual ao refeito: %s\n", label, edit_ms, update_ms,
+           _matches_rebuild(world) ? "sim" : "NAO");
+}
+
+static const int EDIT_BOX = 24;
+
+static void _insert_one(World *world, IVector3 at) {
+    world_insert(world, VoxelObjCreate(voxels[VOX_STONE], make_color_rgba(120, 120, 125, 255), at));
+}
+
+static void _remove_one(World *world, IVector3 at) {
+    world_remove(world, at);
+}
+
+static void _fill_box(World *world, IVector3 at) {
+    world_fill(world, at, ivec3_scalar_add(at, EDIT_BOX - 1), VoxelObjCreate(voxels[VOX_STONE], make_color_rgba(120, 120, 125, 255), at));
+}
+
+static void _clear_box(World *world, IVector3 at) {
+    world_clear_region(world, at, ivec3_scalar_add(at, EDIT_BOX - 1));
+}
+
+static View _look(Vector3 eye, Vector3 target) {
+    View view;
+    view.eye = eye;
+    view.forward = vec3_normalize(vec3_sub(target, eye));
+    view.right = vec3_normalize(vec3_cross(view.forward, vec3_float(0, 1, 0)));
+    view.up = vec3_cross(view.right, view.forward);
+    view.pixel_angle = 2.0f * tanf(FOV_DEGREES * 0.5f * (float)M_PI / 180.0f) / HEIGHT;
+    return view;
+}
+
+static void _camera(const char *label, Svo_Map *map, const Distance_Field *field, const View *view) {
+    std::vector<Ray> rays;
+    for (int y = 0; y < HEIGHT; y++)
+    for (int x = 0; x < WIDTH; x++) rays.push_back(_pixel_ray(view, x, y));
+
+    char name[64];
+    Cast_Result primary;
+    snprintf(name, sizeof(name), "%s, cone 0", label);
+    _compare(name, map, field, rays, std::vector<float>(), 0.0f, &primary);
+    snprintf(name, sizeof(name), "%s, cone 1 px", label);
+    _compare(name, map, field, rays, std::vector<float>(), view->pixel_angle, NULL);
+    _shadows(map, field, primary);
+}
+
+int main(int argc, char **argv) {
+    const char *path = argc > 1 ? argv[1] : "maps/nature.vox";
+
+    // --- Montagem ---
+    World *world = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    if (!world || !load_vox_world(path, world, 0, 0, 0, NULL)) {
+        fprintf(stderr, "falha ao carregar %s\n", path);
+        return 1;
+    }
+    int cores = (int)std::thread::hardware_concurrency();
+    double build_ms[2];
+    for (int pass = 0; pass < 2; pass++) {
+        world->threads = pass == 0 ? 1 : 0;
+        world->distance_stale = true;
+        double t0 = bench_now_ms();
+        world_update_distance(world);
+        build_ms[pass] = bench_now_ms() - t0;
+    }
+    world->threads = 0;
+    const Distance_Field *built = world->distance;
+    printf("%s: backend %s, campo %dx%dx%d células de %d³ (%.1f MB)\n", path, world_backend_name(world->backend),
+           built->cells.x, built->cells.y, built->cells.z, 1 << built->cell_log2,
+           distance_field_memory_usage(built) / 1048576.0);
+    printf("  campo inteiro do World:      1 thread %8.1f ms   %d threads %8.1f ms\n", build_ms[0], cores, build_ms[1]);
+
+    Octree *tree = octree_create(NULL, BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    load_vox_file(path, tree, 0, 0, 0, NULL);
+    octree_compact(tree, 0);
+    IVector3 lo, hi;
+    if (!octree_bounds(tree, &lo, &hi)) {
+        fprintf(stderr, "%s vazio\n", path);
+        return 1;
+    }
+    Distance_Field *field = distance_field_create(lo, hi, BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    double t0 = bench_now_ms();
+    octree_for_each_box(tree, _mark_box, field);
+    double mark_ms = bench_now_ms() - t0;
+    t0 = bench_now_ms();
+    distance_field_update(field, NULL, NULL, 0);
+    printf("  campo inteiro da octree:     ocupação %6.1f ms   distâncias %8.1f ms\n", mark_ms, bench_now_ms() - t0);
+
+    size_t distances[DISTANCE_MAX + 1] = {0};
+    size_t cells = _cell_count(field);
+    for (size_t i = 0; i < cells; i++) distances[field->distance[i]]++;
+    printf("  células ocupadas %.1f%%, com distância >= 4: %.1f%%, no teto (%d): %.1f%%\n",
+           100.0 * distances[0] / cells, 100.0 * (cells - distances[0] - distances[1] - distances[2] - distances[3]) / cells,
+           DISTANCE_MAX, 100.0 * distances[DISTANCE_MAX] / cells);
+
+    // --- Edições ---
+    int cell = 1 << world->distance->cell_log2;
+    IVector3 above = {{(lo.x + hi.x) / 2, hi.y + 4 * cell, (lo.z + hi.z) / 2}};
+    IVector3 outside = {{above.x, std::min(world->distance->right_top_front.y + cell, BENCH_WORLD_SIZE - EDIT_BOX - 1), above.z}};
+    printf("\nedições no ar acima da cena (%d, %d, %d):\n", above.x, above.y, above.z);
+    _edit("inserir 1 voxel", world, _insert_one, above);
+    _edit("apagar 1 voxel", world, _remove_one, above);
+    _edit("preencher caixa 24³", world, _fill_box, above);
+    _edit("apagar caixa 24³", world, _clear_box, above);
+    _edit("inserir fora do campo", world, _insert_one, outside);
+
+    // --- Raios ---
+    size_t size = 0;
+    uint8_t *image = svo_file_encode(tree, &size);
+    Svo_Map *map = svo_map_from_memory(image, size, false);
+    if (!map) {
+        fprintf(stderr, "falha ao codificar a octree\n");
+        return 1;
+    }
+
+    Vector3 center = vec3_float((lo.x + hi.x + 1) * 0.5f, (lo.y + hi.y + 1) * 0.5f, (lo.z + hi.z + 1) * 0.5f);
+    Vector3 extent = vec3_float((float)(hi.x - lo.x + 1), (float)(hi.y - lo.y + 1), (float)(hi.z - lo.z + 1));
+    float radius = 0.5f * fmaxf(extent.x, fmaxf(extent.y, extent.z));
+
+    printf("\nraios (cena %dx%dx%d, %dx%d pixels, %d aleatórios):\n", (int)extent.x, (int)extent.y, (int)extent.z,
+           WIDTH, HEIGHT, RANDOM_RAYS);
+    printf("  %-22s %8s %8s %8s %8s %8s %9s %9s %9s\n", "", "passos", "+campo", "leituras", "+campo", "ganho",
+           "us/raio", "+campo", "mudaram");
+
+    // De um canto alto olhando o centro, e de dentro da cena, rente ao chão, olhando o
+    // canto oposto (raios quase paralelos ao terreno, o caso dos nós vazios pequenos)
+    View outer = _look(vec3_float((float)hi.x + 0.1f * extent.x, (float)hi.y + 0.25f * extent.y, (float)hi.z + 0.1f * extent.z), center);
+    View inner = _look(vec3_float((float)lo.x + 0.05f * extent.x, (float)lo.y + 0.8f * extent.y, (float)lo.z + 0.05f * extent.z),
+                       vec3_float((float)hi.x, (float)lo.y + 0.5f * extent.y, (float)hi.z));
+    _camera("de fora", map, field, &outer);
+    _camera("rente ao chão", map, field, &inner);
+
+    std::vector<Ray> random;
+    Bench_Rng rng = {0x9E3779B97F4A7C15ull};
+    for (int i = 0; i < RANDOM_RAYS; i++) random.push_back(bench_random_ray(&rng, center, radius));
+    _compare("aleatórios", map, field, random, std::vector<float>(), 0.0f, NULL);
+
+    svo_map_delete(map);
+    distance_field_delete(field);
+    octree_delete(tree);
+    world_delete(world);
+    return 0;
+}
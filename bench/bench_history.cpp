@@ -0,0 +1,163 @@
+// Desfazer/refazer (history.hpp): para um preenchimento de ~1M voxels, uma colagem
+// rotacionada e edições de voxel aleatórias, o custo da operação contra o de desfazer e
+// refazer, e a memória que o histórico guarda. Depois de desfazer o mundo é conferido
+// célula a célula contra o de antes, e depois de refazer contra o de depois. Tudo passa
+// pelo diário; no fim o mundo recuperado (snapshot + diário) é conferido contra o editado.
+// Um limite pequeno mostra as ações mais antigas saindo.
+//
+// Uso: bench_history
+
+#include "bench.hpp"
+#include <world.hpp>
+#include <journal.hpp>
+#include <history.hpp>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+static const char *DIR = "bench_history_dir";
+static const int TERRAIN_SIDE = 256;
+static const int EDITS = 100000;
+static const IVector3 CHECK_MIN = {{-TERRAIN_SIDE / 2, -12, -TERRAIN_SIDE / 2}};
+static const IVector3 CHECK_MAX = {{TERRAIN_SIDE / 2, 72, TERRAIN_SIDE / 2}};
+
+static World *_terrain(void) {
+    World *world = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    for (int z = -TERRAIN_SIDE / 2; z < TERRAIN_SIDE / 2; z++)
+    for (int x = -TERRAIN_SIDE / 2; x < TERRAIN_SIDE / 2; x++) {
+        int height = 4 + ((x * 7 + z * 13) & 7);
+        for (int y = -8; y < height; y++) {
+            ColorRGBA color = y == height - 1 ? make_color_rgba(70, 150, 60, 255) : make_color_rgba(120, 120, 125, 255);
+            world_insert(world, VoxelObjCreate(voxels[y == height - 1 ? VOX_GRASS : VOX_STONE], color, {{x, y, z}}));
+        }
+    }
+    world_compact(world, 0);
+    return world;
+}
+
+static bool _same(Voxel_Object a, Voxel_Object b) {
+    bool a_empty = a.coord.y == _invalid_voxel().coord.y, b_empty = b.coord.y == _invalid_voxel().coord.y;
+    if (a_empty || b_empty) return a_empty == b_empty;
+    return a.color == b.color && a.voxel.refraction == b.voxel.refraction
+        && a.voxel.illumination == b.voxel.illumination && a.voxel.k == b.voxel.k;
+}
+
+// Células da área conferida, na ordem de _errors
+static std::vector<Voxel_Object> _snapshot(World *world) {
+    std::vector<Voxel_Object> cells;
+    for (int z = CHECK_MIN.z; z < CHECK_MAX.z; z++)
+    for (int y = CHECK_MIN.y; y < CHECK_MAX.y; y++)
+    for (int x = CHECK_MIN.x; x < CHECK_MAX.x; x++) cells.push_back(world_find(world, {{x, y, z}}));
+    return cells;
+}
+
+static size_t _errors(World *world, const std::vector<Voxel_Object> &cells) {
+    size_t errors = 0, i = 0;
+    for (int z = CHECK_MIN.z; z < CHECK_MAX.z; z++)
+    for (int y = CHECK_MIN.y; y < CHECK_MAX.y; y++)
+    for (int x = CHECK_MIN.x; x < CHECK_MAX.x; x++) errors += !_same(world_find(world, {{x, y, z}}), cells[i++]);
+    return errors;
+}
+
+typedef struct _case_result {
+    double op_ms, undo_ms, redo_ms;
+    size_t bytes, errors;
+} Case_Result;
+
+// 'op' faz as ações pelo histórico; mede desfazer e refazer só as dela em seguida
+static Case_Result _run(History *history, World *world, bool (*op)(History*, World*, void*), void *user) {
+    Case_Result result = {};
+    std::vector<Voxel_Object> before = _snapshot(world);
+    size_t bytes = history->bytes, first = history->applied;
+    double t0 = bench_now_ms();
+    op(history, world, user);
+    result.op_ms = bench_now_ms() - t0;
+    result.bytes = history->bytes - bytes;
+    std::vector<Voxel_Object> after = _snapshot(world);
+
+    t0 = bench_now_ms();
+    while (history->applied > first) history_undo(history, world);
+    result.undo_ms = bench_now_ms() - t0;
+    result.errors += _errors(world, before);
+
+    t0 = bench_now_ms();
+    while (history_redo(history, world)) {}
+    result.redo_ms = bench_now_ms() - t0;
+    result.errors += _errors(world, after);
+    return result;
+}
+
+static void _print(const char *name, Case_Result r) {
+    printf("%-26s | %9.2f | %9.2f %5.2fx | %9.2f %5.2fx | %9.2f | %zu\n", name, r.op_ms, r.undo_ms,
+           r.undo_ms / r.op_ms, r.redo_ms, r.redo_ms / r.op_ms, r.bytes / 1024.0, r.errors);
+}
+
+static bool _fill(History *history, World *world, void *user) {
+    (void)user;
+    // 128 x 64 x 128 ≈ 1M voxels, atravessando a superfície do terreno
+    return history_fill(history, world, {{-64, -4, -64}}, {{63, 59, 63}},
+                        VoxelObjCreate(voxels[VOX_WOOD], make_color_rgba(200, 100, 50, 255), {{0, 0, 0}}));
+}
+
+static bool _paste(History *history, World *world, void *user) {
+    Octree *clip = (Octree*)user;
+    Voxel_Transform transform = voxel_transform_place(5, {{96, 16, 96}}, {{-40, 20, -40}});
+    return history_paste(history, world, clip, transform);
+}
+
+static bool _edits(History *history, World *world, void *user) {
+    (void)user;
+    Bench_Rng rng = {17};
+    for (int i = 0; i < EDITS; i++) {
+        IVector3 c = {{bench_rand_range(&rng, -TERRAIN_SIDE / 2, TERRAIN_SIDE / 2), bench_rand_range(&rng, -8, 24),
+                       bench_rand_range(&rng, -TERRAIN_SIDE / 2, TERRAIN_SIDE / 2)}};
+        if (bench_rand(&rng) % 4 == 0) history_remove(history, world, c);
+        else history_insert(history, world, VoxelObjCreate(voxels[bench_rand(&rng) % 11],
+                                                           make_color_rgba(bench_rand(&rng) % 256, 90, 40, 255), c));
+    }
+    return true;
+}
+
+int main(void) {
+    std::error_code ec;
+    std::filesystem::remove_all(DIR, ec);
+    std::string journal_path = std::string(DIR) + "/world.journal", snapshot_path = std::string(DIR) + "/world.svo";
+
+    World *world = _terrain();
+    Journal *journal = journal_open(world, journal_path.c_str(), snapshot_path.c_str(),
+                                    JOURNAL_SYNC_MS, JOURNAL_SYNC_BYTES, JOURNAL_CHECKPOINT_BYTES);
+    History *history = history_create(1u << 30, journal);
+
+    printf("%-26s | %9s | %9s %6s | %9s %6s | %9s | %s\n", "ação", "op ms", "desfazer", "", "refazer", "",
+           "hist KB", "erros");
+    _print("preencher 128x64x128", _run(history, world, _fill, NULL));
+    Octree *clip = world_copy_region(world, {{-100, -8, -100}}, {{-5, 7, -5}});
+    _print("colar 96x16x96 girado", _run(history, world, _paste, clip));
+    octree_delete(clip);
+    char name[64];
+    snprintf(name, sizeof(name), "%d edições de voxel", EDITS);
+    _print(name, _run(history, world, _edits, NULL));
+
+    // Recuperação: tudo acima (ações, desfazer e refazer) passou pelo diário
+    journal_close(journal);
+    World *recovered = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    double t0 = bench_now_ms();
+    world_load_svo(recovered, snapshot_path.c_str());
+    size_t replayed = journal_replay(recovered, journal_path.c_str());
+    double recover_ms = bench_now_ms() - t0;
+    printf("\nrecuperado: %zu registros em %.1f ms, %zu erros\n", replayed, recover_ms, _errors(recovered, _snapshot(world)));
+    world_delete(recovered);
+    history_delete(history);
+
+    // Limite pequeno: a memória para no limite e só as últimas ações podem ser desfeitas
+    history = history_create(256u << 10, NULL);
+    _edits(history, world, NULL);
+    size_t undone = 0;
+    while (history_undo(history, world)) undone++;
+    printf("limite de 256 KB: %.1f KB nas ações (%.1f KB com o anel), %zu de %d edições podiam ser desfeitas\n",
+           history->bytes / 1024.0, history_memory_usage(history) / 1024.0, undone, EDITS);
+    history_delete(history);
+    world_delete(world);
+    std::filesystem::remove_all(DIR, ec);
+    return 0;
+}
@@ -0,0 +1,289 @@
+// Cenas com o mesmo modelo repetido em muitos nSHP: carga por cópia (cada instância vira
+// voxels na octree) contra carga instanciada (uma octree por modelo e rotação; instâncias
+// alinhadas viram subárvores compartilhadas, as outras referências no nível de cima).
+// Mede tempo de carga, memória na CPU e tamanho da textura, e confere se os dois mundos
+// têm os mesmos voxels e continuam iguais depois de editados; os raios dos dois são
+// conferidos contra o DDA exato do grid esparso.
+//
+// Uso: bench_instancing [arquivo.vox ...]   (padrão: cenas sintéticas)
+
+#include <bench.hpp>
+#include <octree.hpp>
+#include <world.hpp>
+#include <voxReader.hpp>
+#include <sparseGrid.hpp>
+#include <vector>
+#include <string>
+#include <string.h>
+
+static const char *SYNTH_PATH = "bench_instancing.vox";
+
+static void _put_i32(std::vector<uint8_t> *out, int32_t v) {
+    uint8_t b[4];
+    memcpy(b, &v, 4);
+    out->insert(out->end(), b, b + 4);
+}
+
+static void _put_string(std::vector<uint8_t> *out, const std::string &s) {
+    _put_i32(out, (int32_t)s.size());
+    out->insert(out->end(), s.begin(), s.end());
+}
+
+static void _put_dict(std::vector<uint8_t> *out, const std::vector<std::pair<std::string, std::string>> &dict) {
+    _put_i32(out, (int32_t)dict.size());
+    for (const auto &kv : dict) {
+        _put_string(out, kv.first);
+        _put_string(out, kv.second);
+    }
+}
+
+static void _put_chunk(std::vector<uint8_t> *out, const char *id, const std::vector<uint8_t> &content) {
+    out->insert(out->end(), id, id + 4);
+    _put_i32(out, (int32_t)content.size());
+    _put_i32(out, 0);
+    out->insert(out->end(), content.begin(), content.end());
+}
+
+// Árvore de 'dim'³: tronco no meio e copa esférica (cores variam por modelo)
+static void _tree_model(int m, int dim, std::vector<uint8_t> *xyzi) {
+    int c = dim / 2;
+    for (int z = 0; z < dim; z++)
+    for (int y = 0; y < dim; y++)
+    for (int x = 0; x < dim; x++) {
+        int dx = x - c, dy = y - c, dz = z - dim * 2 / 3;
+        bool trunk = abs(dx) <= 1 && abs(dy) <= 1 && z < dim * 2 / 3;
+        bool crown = dx * dx + dy * dy + dz * dz <= (dim / 3) * (dim / 3);
+        if (!trunk && !crown) continue;
+        uint8_t v[4] = {(uint8_t)x, (uint8_t)y, (uint8_t)z, (uint8_t)(trunk ? 10 + m : 100 + (x + y + z + m) % 16)};
+        xyzi->insert(xyzi->end(), v, v + 4);
+    }
+}
+
+// 'count' instâncias de 'models' modelos sob um nGRP. Em grade: passo fixo e rotação
+// identidade (o caso comum de cópias espalhadas num mapa). Espalhadas: posição e
+// rotação (entre as 48) aleatórias.
+static bool _write_instanced(const char *path, int models, int count, int dim, bool scatter) {
+    std::vector<uint8_t> body, chunk;
+    Bench_Rng rng = {2024};
+
+    for (int m = 0; m < models; m++) {
+        chunk.clear();
+        _put_i32(&chunk, dim); _put_i32(&chunk, dim); _put_i32(&chunk, dim);
+        _put_chunk(&body, "SIZE", chunk);
+
+        std::vector<uint8_t> xyzi;
+        _tree_model(m, dim, &xyzi);
+        chunk.clear();
+        _put_i32(&chunk, (int32_t)(xyzi.size() / 4));
+        chunk.insert(chunk.end(), xyzi.begin(), xyzi.end());
+        _put_chunk(&body, "XYZI", chunk);
+    }
+
+    chunk.clear();
+    _put_i32(&chunk, 0); _put_dict(&chunk, {}); _put_i32(&chunk, 1);
+    _put_i32(&chunk, -1); _put_i32(&chunk, 0); _put_i32(&chunk, 1); _put_dict(&chunk, {});
+    _put_chunk(&body, "nTRN", chunk);
+
+    chunk.clear();
+    _put_i32(&chunk, 1); _put_dict(&chunk, {}); _put_i32(&chunk, count);
+    for (int i = 0; i < count; i++) _put_i32(&chunk, 2 + 2 * i);
+    _put_chunk(&body, "nGRP", chunk);
+
+    int side = 1;
+    while (side * side < count) side++;
+    for (int i = 0; i < count; i++) {
+        int tx, ty, tz = dim / 2, rot = 4;
+        if (scatter) {
+            tx = bench_rand_range(&rng, -900, 900);
+            ty = bench_rand_range(&rng, -900, 900);
+            tz = bench_rand_range(&rng, 0, 64);
+            int r0 = bench_rand(&rng) % 3, r1 = (r0 + 1 + bench_rand(&rng) % 2) % 3;
+            rot = r0 | (r1 << 2) | ((bench_rand(&rng) % 8) << 4);
+        } else {
+            tx = (i % side - side / 2) * (dim * 2);
+            ty = (i / side - side / 2) * (dim * 2);
+        }
+
+        chunk.clear();
+        _put_i32(&chunk, 2 + 2 * i); _put_dict(&chunk, {}); _put_i32(&chunk, 3 + 2 * i);
+        _put_i32(&chunk, -1); _put_i32(&chunk, 0); _put_i32(&chunk, 1);
+        _put_dict(&chunk, {{"_r", std::to_string(rot)},
+                           {"_t", std::to_string(tx) + " " + std::to_string(ty) + " " + std::to_string(tz)}});
+        _put_chunk(&body, "nTRN", chunk);
+
+        chunk.clear();
+        _put_i32(&chunk, 3 + 2 * i); _put_dict(&chunk, {}); _put_i32(&chunk, 1);
+        _put_i32(&chunk, i % models); _put_dict(&chunk, {});
+        _put_chunk(&body, "nSHP", chunk);
+    }
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp) return false;
+    std::vector<uint8_t> header;
+    header.insert(header.end(), {'V', 'O', 'X', ' '});
+    _put_i32(&header, 150);
+    header.insert(header.end(), {'M', 'A', 'I', 'N'});
+    _put_i32(&header, 0);
+    _put_i32(&header, (int32_t)body.size());
+    bool ok = fwrite(header.data(), 1, header.size(), fp) == header.size()
+           && fwrite(body.data(), 1, body.size(), fp) == body.size();
+    fclose(fp);
+    return ok;
+}
+
+typedef struct {
+    World *world;
+    double load_ms;
+    size_t memory, texture;
+} Load_Result;
+
+static Load_Result _load(const char *path, bool instancing) {
+    Load_Result r;
+    Vox_Load_Options options = {0, !instancing};
+    double t0 = bench_now_ms();
+    r.world = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    load_vox_world(path, r.world, 0, 0, 0, &options);
+    r.load_ms = bench_now_ms() - t0;
+    r.memory = world_memory_usage(r.world);
+    uint8_t *tex = world_texture(r.world, &r.texture, 0);
+    free(tex);
+    return r;
+}
+
+typedef struct {
+    World *other;
+    size_t errors;
+} Compare_State;
+
+static void _compare_voxel(void *user, Voxel_Object voxel) {
+    Compare_State *state = (Compare_State*)user;
+    Voxel_Object found = world_find(state->other, voxel.coord);
+    if (!ivec3_equal_vec(found.coord, voxel.coord) || found.color != voxel.color) state->errors++;
+}
+
+static void _count_voxel(void *user, Voxel_Object voxel) {
+    (void)voxel;
+    (*(size_t*)user)++;
+}
+
+static void _insert_sparse(void *user, Voxel_Object voxel) {
+    sparse_grid_insert((Sparse_Grid*)user, voxel);
+}
+
+static size_t _voxel_count(World *world) {
+    if (world->backend == WORLD_BACKEND_DENSE) return world->dense->voxel_count;
+    if (world->backend == WORLD_BACKEND_TREE64) return world->tree64->voxel_count;
+    if (world->backend == WORLD_BACKEND_SPARSE) return world->sparse->voxel_count;
+    size_t count = 0;
+    octree_for_each(world->octree, _count_voxel, &count);
+    instance_set_for_each(world->instances, _count_voxel, &count);
+    return count;
+}
+
+// Raios que erram o voxel do DDA exato do grid esparso (a marcha da octree é aproximada:
+// empurrões de 0.001 nas faces, então a cópia também erra alguns)
+static int _ray_errors(World *world, Sparse_Grid *exact, const std::vector<Ray> &rays) {
+    int errors = 0;
+    for (const Ray &ray : rays) {
+        Voxel_Object a, b;
+        bool ha = world_ray_cast(world, ray, &a), hb = sparse_grid_ray_cast(exact, ray, &b, NULL);
+        if (ha != hb || (ha && !ivec3_equal_vec(a.coord, b.coord))) errors++;
+    }
+    return errors;
+}
+
+// Mesmos voxels nos dois sentidos e mesmas respostas depois de remover e pôr voxels
+// dentro das instâncias
+static size_t _compare_worlds(World *copy, World *inst, const std::vector<Ray> &rays) {
+    Compare_State state = {inst, 0};
+    octree_for_each(copy->octree, _compare_voxel, &state);
+    size_t copy_count = _voxel_count(copy), inst_count = _voxel_count(inst);
+    if (copy_count > inst_count) state.errors += copy_count - inst_count;
+
+    // Cada raio que acerta remove o voxel atingido e põe outro acima dele
+    for (size_t i = 0; i < rays.size() && i < 300; i++) {
+        Voxel_Object hit;
+        if (!world_ray_cast(copy, rays[i], &hit)) continue;
+        world_remove(copy, hit.coord);
+        world_remove(inst, hit.coord);
+        Voxel_Object above = hit;
+        above.coord.y += 1 + (i % 3);
+        world_insert(copy, above);
+        world_insert(inst, above);
+    }
+    world_compact(copy, 0);
+    world_compact(inst, 0);
+
+    Bench_Rng rng = {55};
+    for (int i = 0; i < 200000; i++) {
+        IVector3 q = {{bench_rand_range(&rng, -1023, 1024), bench_rand_range(&rng, -64, 160), bench_rand_range(&rng, -1023, 1024)}};
+        Voxel_Object a = world_find(copy, q), b = world_find(inst, q);
+        if (a.coord.y != b.coord.y || a.color != b.color) state.errors++;
+    }
+    octree_for_each(copy->octree, _compare_voxel, &state);
+    return state.errors;
+}
+
+static void _run_file(const char *name, const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return;
+    fclose(fp);
+
+    Load_Result copy = _load(path, false);
+    Load_Result inst = _load(path, true);
+    size_t references = inst.world->instances ? inst.world->instances->count : 0;
+
+    printf("%-14s %9zu | %8.1f %9.1f %9.1f | %8.1f %9.1f %9.1f | %6zu",
+           name, _voxel_count(copy.world),
+           copy.load_ms, copy.memory / 1048576.0, copy.texture / 1048576.0,
+           inst.load_ms, inst.memory / 1048576.0, inst.texture / 1048576.0,
+           references);
+
+    // Só a octree é instanciada; nos outros backends as duas cargas são a mesma cópia
+    if (copy.world->backend == WORLD_BACKEND_OCTREE && inst.world->backend == WORLD_BACKEND_OCTREE) {
+        Bench_Rng rng = {77};
+        std::vector<Ray> rays(4000);
+        for (Ray &r : rays) r = bench_random_ray(&rng, {{0.0f, 48.0f, 0.0f}}, 900.0f);
+
+        Sparse_Grid *exact = sparse_grid_create();
+        octree_for_each(copy.world->octree, _insert_sparse, exact);
+        int copy_rays = _ray_errors(copy.world, exact, rays);
+        int inst_rays = _ray_errors(inst.world, exact, rays);
+        sparse_grid_delete(exact);
+
+        size_t errors = _compare_worlds(copy.world, inst.world, rays);
+        printf(" | %5d %5d | %s\n", copy_rays, inst_rays, errors ? "ERRO" : "ok");
+        if (errors) printf("  %zu diferenças\n", errors);
+    } else {
+        printf(" | %5s %5s | %s\n", "-", "-", world_backend_name(copy.world->backend));
+    }
+
+    world_delete(copy.world);
+    world_delete(inst.world);
+}
+
+int main(int argc, char **argv) {
+    bench_header("instanciamento: cópia vs referência");
+    printf("%-14s %9s | %8s %9s %9s | %8s %9s %9s | %6s | %5s %5s | %s\n",
+           "cena", "voxels",
+           "cópia ms", "CPU MB", "tex MB",
+           "inst ms", "CPU MB", "tex MB",
+           "refs", "raio", "raio", "iguais");
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) _run_file(strrchr(argv[i], '/') ? strrchr(argv[i], '/') + 1 : argv[i], argv[i]);
+        return 0;
+    }
+
+    if (_write_instanced(SYNTH_PATH, 1, 1024, 16, false)) _run_file("grade 1x1024", SYNTH_PATH);
+    if (_write_instanced(SYNTH_PATH, 4, 900, 24, false)) _run_file("grade 4x225", SYNTH_PATH);
+    if (_write_instanced(SYNTH_PATH, 3, 600, 20, true)) _run_file("espalh 3x200", SYNTH_PATH);
+    remove(SYNTH_PATH);
+
+    printf("\ncópia = cada instância vira voxels na octree; inst = uma octree por modelo e rotação\n"
+           "(refs = instâncias que não caíram alinhadas num nó e ficaram no nível de cima).\n"
+           "tex MB da cena instanciada tem cada modelo uma vez (as refs chegam nele pela BVH).\n"
+           "raio = raios que erram o voxel do DDA exato (cópia, inst); iguais = mesmos voxels\n"
+           "antes e depois de 300 edições dentro das instâncias\n");
+    return 0;
+}
@@ -0,0 +1,117 @@
+// Persistência das edições: salvar o mundo inteiro (world_save_svo) contra o diário
+// (journal.hpp). Mede o custo na thread do jogo por edição, os grupos/fsyncs feitos pela
+// thread de escrita e o tempo de recuperação (snapshot + diário) para alguns intervalos
+// de checkpoint. O mundo recuperado é conferido célula a célula contra o editado.
+//
+// Uso: bench_journal
+
+#include "bench.hpp"
+#include <world.hpp>
+#include <journal.hpp>
+#include <filesystem>
+#include <string>
+
+static const char *DIR = "bench_journal_dir";
+static const int TERRAIN_SIDE = 256;
+static const int EDITS = 200000;
+
+static World *_terrain(void) {
+    World *world = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    for (int z = -TERRAIN_SIDE / 2; z < TERRAIN_SIDE / 2; z++)
+    for (int x = -TERRAIN_SIDE / 2; x < TERRAIN_SIDE / 2; x++)
+    for (int y = -8; y < 0; y++) {
+        world_insert(world, VoxelObjCreate(voxels[VOX_STONE], make_color_rgba(120, 120, 125, 255), {{x, y, z}}));
+    }
+    world_compact(world, 0);
+    return world;
+}
+
+static bool _same(Voxel_Object a, Voxel_Object b) {
+    bool a_empty = a.coord.y == _invalid_voxel().coord.y, b_empty = b.coord.y == _invalid_voxel().coord.y;
+    if (a_empty || b_empty) return a_empty == b_empty;
+    return a.color == b.color && a.voxel.k == b.voxel.k;
+}
+
+// Construção/escavação aleatória perto da superfície
+static Voxel_Object _edit(Bench_Rng *rng, bool *remove) {
+    IVector3 c = {{bench_rand_range(rng, -TERRAIN_SIDE / 2, TERRAIN_SIDE / 2), bench_rand_range(rng, -8, 24),
+                   bench_rand_range(rng, -TERRAIN_SIDE / 2, TERRAIN_SIDE / 2)}};
+    *remove = bench_rand(rng) % 4 == 0;
+    return VoxelObjCreate(voxels[bench_rand(rng) % 11], make_color_rgba(bench_rand(rng) % 256, 90, 40, 255), c);
+}
+
+static void _journal_case(size_t checkpoint_bytes) {
+    std::error_code ec;
+    std::filesystem::remove_all(DIR, ec);
+    std::string journal_path = std::string(DIR) + "/world.journal", snapshot_path = std::string(DIR) + "/world.svo";
+
+    World *world = _terrain();
+    double t0 = bench_now_ms();
+    Journal *journal = journal_open(world, journal_path.c_str(), snapshot_path.c_str(),
+                                    JOURNAL_SYNC_MS, JOURNAL_SYNC_BYTES, checkpoint_bytes);
+    double open_ms = bench_now_ms() - t0;
+
+    // Só o custo da thread do jogo: editar o mundo e enfileirar o registro
+    Bench_Rng rng = {17};
+    double edit_ms = 0.0, log_ms = 0.0;
+    for (int i = 0; i < EDITS; i++) {
+        bool remove;
+        Voxel_Object voxel = _edit(&rng, &remove);
+        t0 = bench_now_ms();
+        if (remove) world_remove(world, voxel.coord);
+        else world_insert(world, voxel);
+        double t1 = bench_now_ms();
+        if (remove) journal_remove(journal, voxel.coord);
+        else journal_insert(journal, voxel);
+        log_ms += bench_now_ms() - t1;
+        edit_ms += t1 - t0;
+    }
+    t0 = bench_now_ms();
+    journal_flush(journal);
+    double flush_ms = bench_now_ms() - t0;
+    Journal_Stats stats = journal_stats(journal);
+    journal_close(journal);
+
+    World *recovered = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    t0 = bench_now_ms();
+    world_load_svo(recovered, snapshot_path.c_str());
+    size_t replayed = journal_replay(recovered, journal_path.c_str());
+    double recover_ms = bench_now_ms() - t0;
+
+    int errors = 0;
+    for (int z = -TERRAIN_SIDE / 2; z < TERRAIN_SIDE / 2; z++)
+    for (int y = -8; y < 24; y++)
+    for (int x = -TERRAIN_SIDE / 2; x < TERRAIN_SIDE / 2; x++) {
+        errors += !_same(world_find(world, {{x, y, z}}), world_find(recovered, {{x, y, z}}));
+    }
+
+    printf("%8zu KB | %7.1f | %7.3f %7.3f | %6zu %6zu %3zu %7.1f | %7.1f %8.1f %7zu | %d\n",
+           checkpoint_bytes >> 10, open_ms, edit_ms * 1e3 / EDITS, log_ms * 1e3 / EDITS, stats.groups,
+           stats.syncs, stats.checkpoints, stats.checkpoint_ms, flush_ms, recover_ms, replayed, errors);
+    world_delete(world);
+    world_delete(recovered);
+    std::filesystem::remove_all(DIR, ec);
+}
+
+int main(void) {
+    // Salvar tudo a cada edição: o que o diário evita
+    World *world = _terrain();
+    std::error_code ec;
+    std::filesystem::create_directories(DIR, ec);
+    std::string full = std::string(DIR) + "/full.svo";
+    double t0 = bench_now_ms();
+    for (int i = 0; i < 10; i++) {
+        world_insert(world, VoxelObjCreate(voxels[VOX_WOOD], make_color_rgba(200, 100, 50, 255), {{i, 0, 0}}));
+        world_save_svo(world, full.c_str());
+    }
+    printf("salvar o mundo inteiro: %.1f ms por edição\n\n", (bench_now_ms() - t0) / 10);
+    world_delete(world);
+
+    printf("%d edições (insere/remove aleatórios num terreno de %d²)\n", EDITS, TERRAIN_SIDE);
+    printf("%11s | %7s | %7s %7s | %6s %6s %3s %7s | %7s %8s %7s | %s\n", "checkpoint", "abrir",
+           "edit us", "diário", "grupos", "fsync", "ckp", "ckp ms", "flush", "recuperar", "reaplic", "erros");
+    _journal_case(256u << 10);
+    _journal_case(JOURNAL_CHECKPOINT_BYTES);
+    _journal_case(64u << 20);
+    return 0;
+}
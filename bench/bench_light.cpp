@@ -0,0 +1,203 @@
+// Luz das fontes (lightVolume.hpp) numa cidade grande sintética: um chão de 576² com
+// salas fechadas de pedra (porta numa parede, lâmpada no teto) e postes nas esquinas,
+// com cores variadas. Mede
+//  - montagem: espalhar a luz de todas as fontes do zero, blocos e memória, tamanho do
+//    buffer da GPU;
+//  - edições: o tempo de world_update_light depois de cada uma (só a região que a luz
+//    alcançava) e as células visitadas, em salas sorteadas: acender e apagar um poste,
+//    pôr e tirar um bloco colado na lâmpada do teto, fechar e abrir a porta, apagar e
+//    acender a lâmpada do teto;
+//  - no fim, a luz editada conferida célula por célula contra a luz refeita do zero.
+//
+// Uso: bench_light [salas por lado]   (padrão: 16)
+
+#include "bench.hpp"
+#include <world.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static const int ROOM = 20;        //lado externo
+static const int ROOM_HEIGHT = 12;
+static const int STREET = 16;      //entre duas salas
+static const int GROUND = 4;       //espessura do chão (y de -GROUND a -1)
+static const int EDITS = 64;       //salas sorteadas para cada edição
+
+static const ColorRGBA LAMP_COLORS[] = {
+    make_color_rgba(255, 210, 160, 255), make_color_rgba(180, 200, 255, 255),
+    make_color_rgba(255, 90, 60, 255), make_color_rgba(90, 255, 120, 255),
+};
+
+typedef struct _town {
+    int side;
+    IVector3 min, max;
+} Town;
+
+static IVector3 _room_min(const Town *town, int i, int j) {
+    return {{town->min.x + STREET + i * (ROOM + STREET), 0, town->min.z + STREET + j * (ROOM + STREET)}};
+}
+
+static IVector3 _ceiling_lamp(const Town *town, int i, int j) {
+    IVector3 min = _room_min(town, i, j);
+    return {{min.x + ROOM / 2, ROOM_HEIGHT - 2, min.z + ROOM / 2}};
+}
+
+static void _door(const Town *town, int i, int j, IVector3 *min, IVector3 *max) {
+    IVector3 room = _room_min(town, i, j);
+    *min = {{room.x + ROOM / 2 - 1, 1, room.z + ROOM - 1}};
+    *max = {{room.x + ROOM / 2 + 1, 5, room.z + ROOM - 1}};
+}
+
+static Voxel_Object _lamp(int n, IVector3 at) {
+    return VoxelObjCreate(voxels[VOX_LIGHT], LAMP_COLORS[n % 4], at);
+}
+
+static Voxel_Object _stone(IVector3 at) {
+    return VoxelObjCreate(voxels[VOX_STONE], make_color_rgba(130, 130, 135, 255), at);
+}
+
+static void _build(World *world, Town *town) {
+    int extent = town->side * (ROOM + STREET) + STREET;
+    town->min = {{-extent / 2, -GROUND, -extent / 2}};
+    town->max = {{town->min.x + extent - 1, ROOM_HEIGHT, town->min.z + extent - 1}};
+    world_fill(world, town->min, {{town->max.x, -1, town->max.z}},
+               VoxelObjCreate(voxels[VOX_DIRT], make_color_rgba(100, 80, 60, 255), town->min));
+
+    for (int i = 0; i < town->side; i++)
+    for (int j = 0; j < town->side; j++) {
+        IVector3 min = _room_min(town, i, j);
+        IVector3 max = {{min.x + ROOM - 1, ROOM_HEIGHT - 1, min.z + ROOM - 1}};
+        world_fill(world, min, max, _stone(min));
+        world_clear_region(world, ivec3_scalar_add(min, 1), ivec3_scalar_add(max, -1));
+        IVector3 door_min, door_max;
+        _door(town, i, j, &door_min, &door_max);
+        world_clear_region(world, door_min, door_max);
+        world_insert(world, _lamp(i + j, _ceiling_lamp(town, i, j)));
+    }
+
+    // Postes nas esquinas
+    for (int i = 0; i <= town->side; i++)
+    for (int j = 0; j <= town->side; j++) {
+        IVector3 base = {{town->min.x + STREET / 2 + i * (ROOM + STREET), 0, town->min.z + STREET / 2 + j * (ROOM + STREET)}};
+        world_fill(world, base, {{base.x, 5, base.z}}, VoxelObjCreate(voxels[VOX_WOOD], make_color_rgba(90, 60, 30, 255), base));
+        world_insert(world, _lamp(i * 3 + j, {{base.x, 6, base.z}}));
+    }
+}
+
+// Células acesas (coordenada e nível) de todos os blocos
+static std::vector<std::pair<IVector3, uint16_t>> _lit_cells(const Light_Volume *volume) {
+    std::vector<std::pair<IVector3, uint16_t>> cells;
+    for (size_t i = 0; i < volume->capacity; i++) {
+        const Light_Brick *brick = volume->table[i];
+        if (!brick) continue;
+        for (int c = 0; c < LIGHT_BRICK_CELLS; c++) {
+            if (!brick->light[c]) continue;
+            IVector3 at = {{c % LIGHT_BRICK_DIM, (c / LIGHT_BRICK_DIM) % LIGHT_BRICK_DIM, c / (LIGHT_BRICK_DIM * LIGHT_BRICK_DIM)}};
+            cells.push_back({ivec3_add(brick->origin, at), brick->light[c]});
+        }
+    }
+    return cells;
+}
+
+// Refaz a luz do zero e conta as células com nível diferente do editado
+static size_t _differences_from_rebuild(World *world) {
+    std::vector<std::pair<IVector3, uint16_t>> edited = _lit_cells(world->light);
+    world->light_stale = true;
+    world_update_light(world);
+    size_t differences = 0;
+    for (auto &cell : edited) differences += light_volume_at(world->light, cell.first) != cell.second;
+    size_t lit = _lit_cells(world->light).size();
+    if (lit > edited.size()) differences += lit - edited.size();
+    return differences;
+}
+
+typedef struct _edit_stats {
+    double total_ms, max_ms;
+    double visited;
+    int count;
+} Edit_Stats;
+
+static void _relight(World *world, Edit_Stats *stats) {
+    double t0 = bench_now_ms();
+    world_update_light(world);
+    double ms = bench_now_ms() - t0;
+    stats->total_ms += ms;
+    if (ms > stats->max_ms) stats->max_ms = ms;
+    stats->visited += (double)world->light->visited;
+    stats->count++;
+}
+
+static void _report(const char *label, const Edit_Stats *stats) {
+    printf("  %-34s %8.3f %8.3f %10.0f\n", label, stats->total_ms / stats->count, stats->max_ms, stats->visited / stats->count);
+}
+
+int main(int argc, char **argv) {
+    Town town = {argc > 1 ? atoi(argv[1]) : 16, ivec3_zero(), ivec3_zero()};
+    if (town.side < 1) town.side = 16;
+
+    World *world = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    double t0 = bench_now_ms();
+    _build(world, &town);
+    octree_compact(world->octree, 0);
+    int lamps = town.side * town.side + (town.side + 1) * (town.side + 1);
+    printf("cidade %dx%d voxels, %d salas, %d lâmpadas (montada em %.0f ms, octree %.1f MB)\n",
+           town.max.x - town.min.x + 1, town.max.z - town.min.z + 1, town.side * town.side, lamps,
+           bench_now_ms() - t0, world_memory_usage(world) / 1048576.0);
+
+    // --- Montagem ---
+    t0 = bench_now_ms();
+    world_update_light(world);
+    double build_ms = bench_now_ms() - t0;
+    size_t buffer_size = 0;
+    int32_t *buffer = world_light_buffer(world, &buffer_size);
+    free(buffer);
+    printf("  luz inteira: %.0f ms, %zu blocos de %d³, %zu células acesas, %.1f MB (buffer da GPU %.1f MB)\n",
+           build_ms, world->light->count, LIGHT_BRICK_DIM, _lit_cells(world->light).size(),
+           light_volume_memory_usage(world->light) / 1048576.0, buffer_size / 1048576.0);
+
+    // --- Edições ---
+    printf("\nedições (%d salas sorteadas):      ms médio  ms máx    células\n", EDITS);
+    Edit_Stats stats[8] = {};
+    Bench_Rng rng = {0xC0FFEEull};
+    for (int e = 0; e < EDITS; e++) {
+        int i = bench_rand_range(&rng, 0, town.side), j = bench_rand_range(&rng, 0, town.side);
+        IVector3 room = _room_min(&town, i, j);
+        IVector3 lamp = _ceiling_lamp(&town, i, j);
+
+        // Poste novo no meio da rua em frente à porta
+        IVector3 street = {{room.x + ROOM / 2, 3, room.z + ROOM + STREET / 2}};
+        world_insert(world, _lamp(e, street));
+        _relight(world, &stats[0]);
+        world_remove(world, street);
+        _relight(world, &stats[1]);
+
+        IVector3 below = {{lamp.x, lamp.y - 1, lamp.z}};
+        world_insert(world, _stone(below));
+        _relight(world, &stats[2]);
+        world_remove(world, below);
+        _relight(world, &stats[3]);
+
+        IVector3 door_min, door_max;
+        _door(&town, i, j, &door_min, &door_max);
+        world_fill(world, door_min, door_max, _stone(door_min));
+        _relight(world, &stats[4]);
+        world_clear_region(world, door_min, door_max);
+        _relight(world, &stats[5]);
+
+        world_remove(world, lamp);
+        _relight(world, &stats[6]);
+        world_insert(world, _lamp(i + j, lamp));
+        _relight(world, &stats[7]);
+    }
+    const char *labels[8] = {"acender poste na rua", "apagar o poste", "bloco colado na lâmpada do teto",
+                             "tirar o bloco", "fechar a porta (3x5)", "abrir a porta", "apagar a lâmpada do teto",
+                             "acender de novo"};
+    for (int k = 0; k < 8; k++) _report(labels[k], &stats[k]);
+
+    t0 = bench_now_ms();
+    size_t differences = _differences_from_rebuild(world);
+    printf("\nluz editada contra refeita do zero (%.0f ms): %zu células diferentes\n", bench_now_ms() - t0, differences);
+
+    world_delete(world);
+    return 0;
+}
@@ -0,0 +1,200 @@
+// Árvore de luzes (lightTree.hpp) num salão fechado: chão, paredes e teto de pedra, pilares
+// e centenas de fontes de cores e intensidades sorteadas no chão, nas paredes e nos
+// pilares. Mede
+//  - convergência: erro RMS relativo de faces sorteadas do chão e do teto (várias sementes
+//    por face) com o traçador da CPU sem estimativa de próximo evento, com fontes sorteadas
+//    uniformes e pela árvore, contra uma referência com muitos caminhos; o tempo por face,
+//    a eficiência (1 / (erro² * tempo)) relativa a só rebater e a média de cada estratégia
+//    (as três convergem para a mesma luz);
+//  - atualização: pôr e tirar fontes (reconstrução) e trocar a cor delas (reajuste);
+//  - sorteio: ns por fonte sorteada pela árvore e uniforme.
+//
+// Uso: bench_light_tree [fontes] [caminhos de referência]   (padrão: 512 e 4096)
+
+#include "bench.hpp"
+#include <world.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+static const int HALL = 96;      //lado do salão (por dentro)
+static const int HEIGHT = 24;    //altura do salão (por dentro)
+static const int PILLAR = 4;     //lado dos pilares
+static const int SPACING = 24;   //entre dois pilares
+static const int PROBES = 64;    //faces sorteadas para a convergência
+static const int TRIALS = 8;     //sementes por face (o erro vem de poucos caminhos muito fortes)
+static const int EDITS = 64;     //fontes postas, recoloridas e tiradas
+static const int SAMPLES = 1000000;
+
+static Voxel_Object _stone(IVector3 at) {
+    return VoxelObjCreate(voxels[VOX_STONE], make_color_rgba(150, 145, 140, 255), at);
+}
+
+// Fonte com cor e intensidade sorteadas (a maioria fraca, algumas fortes)
+static Voxel_Object _lamp(Bench_Rng *rng, IVector3 at) {
+    Voxel voxel = voxels[VOX_LIGHT];
+    float u = bench_rand_float(rng);
+    voxel.illumination = 0.05f + 0.95f * u * u * u;
+    ColorRGBA color = make_color_rgba((uint8_t)bench_rand_range(rng, 64, 256), (uint8_t)bench_rand_range(rng, 64, 256),
+                                      (uint8_t)bench_rand_range(rng, 64, 256), 255);
+    return VoxelObjCreate(voxel, color, at);
+}
+
+// Uma célula vazia colada no chão, numa parede ou num pilar
+static IVector3 _lamp_spot(World *world, Bench_Rng *rng) {
+    for (;;) {
+        IVector3 at = {{bench_rand_range(rng, 0, HALL), bench_rand_range(rng, 0, HEIGHT), bench_rand_range(rng, 0, HALL)}};
+        if (at.y > 0 && at.x > 0 && at.x < HALL - 1 && at.z > 0 && at.z < HALL - 1) {
+            // Longe do chão e das paredes: só vale encostada num pilar
+            bool pillar = false;
+            for (int face = 0; face < 4 && !pillar; face++) {
+                IVector3 n = {{face == 0 ? 1 : face == 1 ? -1 : 0, 0, face == 2 ? 1 : face == 3 ? -1 : 0}};
+                Voxel_Object v = world_find(world, ivec3_add(at, n));
+                pillar = v.coord.y != _invalid_voxel().coord.y;
+            }
+            if (!pillar) continue;
+        }
+        Voxel_Object here = world_find(world, at);
+        if (here.coord.y == _invalid_voxel().coord.y) return at;
+    }
+}
+
+static void _build(World *world, int lamps, Bench_Rng *rng) {
+    Voxel_Object stone = _stone(ivec3_zero());
+    world_fill(world, {{-1, -1, -1}}, {{HALL, -1, HALL}}, stone);
+    world_fill(world, {{-1, HEIGHT, -1}}, {{HALL, HEIGHT, HALL}}, stone);
+    world_fill(world, {{-1, 0, -1}}, {{HALL, HEIGHT - 1, -1}}, stone);
+    world_fill(world, {{-1, 0, HALL}}, {{HALL, HEIGHT - 1, HALL}}, stone);
+    world_fill(world, {{-1, 0, 0}}, {{-1, HEIGHT - 1, HALL - 1}}, stone);
+    world_fill(world, {{HALL, 0, 0}}, {{HALL, HEIGHT - 1, HALL - 1}}, stone);
+    for (int x = SPACING - PILLAR / 2; x + PILLAR <= HALL - SPACING / 2; x += SPACING)
+    for (int z = SPACING - PILLAR / 2; z + PILLAR <= HALL - SPACING / 2; z += SPACING) {
+        world_fill(world, {{x, 0, z}}, {{x + PILLAR - 1, HEIGHT - 1, z + PILLAR - 1}}, stone);
+    }
+    for (int i = 0; i < lamps; i++) world_insert(world, _lamp(rng, _lamp_spot(world, rng)));
+}
+
+typedef struct _probe {
+    IVector3 coord;
+    int face;
+} Probe;
+
+static float _luminance(Vector3 c) {
+    return 0.2126f * c.x + 0.7152f * c.y + 0.0722f * c.z;
+}
+
+int main(int argc, char **argv) {
+    int lamps = argc > 1 ? atoi(argv[1]) : 512;
+    if (lamps < 1) lamps = 512;
+    int reference_samples = argc > 2 ? atoi(argv[2]) : 4096;
+    if (reference_samples < 1) reference_samples = 4096;
+
+    World *world = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    Bench_Rng rng = {0x1A4Bull};
+    double t0 = bench_now_ms();
+    _build(world, lamps, &rng);
+    octree_compact(world->octree, 0);
+    world_set_sun(world, vec3_float(0.3481553f, 0.870388f, 0.3481553f));
+    world_update_emitters(world);
+    double build_ms = bench_now_ms() - t0;
+    printf("salão %dx%dx%d fechado com %zu fontes (montado em %.0f ms), árvore com %zu nós, %.1f KB\n",
+           HALL, HEIGHT, HALL, world->emitters->count, build_ms, world->emitters->node_count,
+           light_tree_memory_usage(world->emitters) / 1024.0);
+
+    // --- Convergência ---
+    std::vector<Probe> probes(PROBES);
+    for (Probe &p : probes) {
+        for (;;) {
+            bool floor = bench_rand(&rng) & 1;
+            IVector3 at = {{bench_rand_range(&rng, 0, HALL), floor ? -1 : HEIGHT, bench_rand_range(&rng, 0, HALL)}};
+            Voxel_Object front = world_find(world, {{at.x, floor ? 0 : HEIGHT - 1, at.z}});
+            if (front.coord.y != _invalid_voxel().coord.y) continue;
+            p = {at, floor ? 2 : 3};
+            break;
+        }
+    }
+    world_set_light_sampling(world, LIGHT_SAMPLING_TREE);
+    std::vector<float> reference(PROBES);
+    double mean = 0.0;
+    t0 = bench_now_ms();
+    for (int p = 0; p < PROBES; p++) {
+        reference[p] = _luminance(world_trace_face(world, probes[p].coord, probes[p].face, reference_samples, 0xABCDull + p));
+        mean += reference[p] / PROBES;
+    }
+    printf("\nconvergência (%d faces do chão e do teto, %d sementes cada, referência pela árvore com %d caminhos\n"
+           "em %.0f ms, luminância média %.3f):\n", PROBES, TRIALS, reference_samples, bench_now_ms() - t0, mean);
+    printf("  estratégia   caminhos   erro RMS   ms por face   eficiência   média\n");
+    const Light_Sampling modes[3] = {LIGHT_SAMPLING_NONE, LIGHT_SAMPLING_UNIFORM, LIGHT_SAMPLING_TREE};
+    const char *names[3] = {"só rebote", "uniforme", "árvore"};
+    const int counts[3] = {4, 16, 64};
+    for (int c = 0; c < 3; c++) {
+        double baseline = 0.0;
+        for (int m = 0; m < 3; m++) {
+            world_set_light_sampling(world, modes[m]);
+            double error = 0.0, average = 0.0;
+            t0 = bench_now_ms();
+            for (int trial = 0; trial < TRIALS; trial++)
+            for (int p = 0; p < PROBES; p++) {
+                uint64_t seed = 0x1234ull + (uint64_t)trial * PROBES + p;
+                float value = _luminance(world_trace_face(world, probes[p].coord, probes[p].face, counts[c], seed));
+                error += (double)(value - reference[p]) * (value - reference[p]);
+                average += value / (PROBES * TRIALS);
+            }
+            double ms = (bench_now_ms() - t0) / (PROBES * TRIALS);
+            double rms = sqrt(error / (PROBES * TRIALS)) / mean;
+            double efficiency = 1.0 / (rms * rms * ms);
+            if (m == 0) baseline = efficiency;
+            printf("  %-12s %8d %9.1f%% %13.3f %11.1fx %7.3f\n", names[m], counts[c], 100.0 * rms, ms, efficiency / baseline, average);
+        }
+    }
+
+    // --- Atualização ---
+    world_set_light_sampling(world, LIGHT_SAMPLING_TREE);
+    std::vector<IVector3> placed(EDITS);
+    double place_ms = 0.0, recolor_ms = 0.0, remove_ms = 0.0;
+    for (int e = 0; e < EDITS; e++) {
+        placed[e] = _lamp_spot(world, &rng);
+        t0 = bench_now_ms();
+        world_insert(world, _lamp(&rng, placed[e]));
+        world_update_emitters(world);
+        place_ms += bench_now_ms() - t0;
+    }
+    for (int e = 0; e < EDITS; e++) {
+        t0 = bench_now_ms();
+        world_insert(world, _lamp(&rng, placed[e]));
+        world_update_emitters(world);
+        recolor_ms += bench_now_ms() - t0;
+    }
+    for (int e = 0; e < EDITS; e++) {
+        t0 = bench_now_ms();
+        world_remove(world, placed[e]);
+        world_update_emitters(world);
+        remove_ms += bench_now_ms() - t0;
+    }
+    printf("\natualização (%d fontes, edição + world_update_emitters, ms médio):\n", EDITS);
+    printf("  pôr (reconstrói) %.3f, trocar a cor (reajusta) %.3f, tirar (reconstrói) %.3f\n",
+           place_ms / EDITS, recolor_ms / EDITS, remove_ms / EDITS);
+
+    // --- Sorteio ---
+    const Light_Tree *tree = world->emitters;
+    float pmf, sink = 0.0f;
+    t0 = bench_now_ms();
+    for (int s = 0; s < SAMPLES; s++) {
+        Vector3 p = vec3_float(bench_rand_float(&rng) * HALL, 0.0f, bench_rand_float(&rng) * HALL);
+        const Tree_Light *light = light_tree_sample(tree, p, vec3_float(0.0f, 1.0f, 0.0f), bench_rand_float(&rng), &pmf);
+        sink += light ? pmf : 0.0f;
+    }
+    double tree_ns = (bench_now_ms() - t0) * 1e6 / SAMPLES;
+    t0 = bench_now_ms();
+    for (int s = 0; s < SAMPLES; s++) {
+        Vector3 p = vec3_float(bench_rand_float(&rng) * HALL, 0.0f, bench_rand_float(&rng) * HALL);
+        const Tree_Light *light = light_tree_sample_uniform(tree, bench_rand_float(&rng), &pmf);
+        sink += light ? pmf + p.x * 0.0f : 0.0f;
+    }
+    double uniform_ns = (bench_now_ms() - t0) * 1e6 / SAMPLES;
+    printf("\nsorteio: %.0f ns pela árvore, %.0f ns uniforme (%.0f)\n", tree_ns, uniform_ns, sink * 0.0f);
+
+    world_delete(world);
+    return 0;
+}
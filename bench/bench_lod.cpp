@@ -0,0 +1,245 @@
+// Pirâmide de LOD dos chunks (chunk_grid_set_lod): um terreno do tamanho da janela com
+// LOD, a câmera no meio, guardado num chunk_store com o orçamento padrão (como no jogo).
+// Mede
+//  - montagem: o tempo das reduções de todos os chunks além do raio residente;
+//  - memória e textura: a grade sem e com LOD (as imagens cheias dos chunks reduzidos
+//    voltam para o disco), os chunks que couberam na textura e os texels de cada nível
+//    contra os dos mesmos chunks em resolução cheia;
+//  - passos por raio: raios da câmera atravessando os chunks longe, na octree cheia e na
+//    redução do nível que a grade escolheu (octree_ray_cast_stats);
+//  - edição: refazer só a caixa editada (octree_downsample_region) contra a pirâmide
+//    inteira, conferindo que as duas dão o mesmo resultado.
+
+#include "bench.hpp"
+#include <chunkGrid.hpp>
+#include <algorithm>
+#include <vector>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const int SIDE = 2 * CHUNK_LOD_RADIUS + 1;  //chunks por lado (uma camada só)
+static const int VARIANTS = 16;
+static const float PIXELS_PER_RADIAN = 869.0f;      //720 px de altura, fov vertical de 45°
+static const int RAYS_PER_CHUNK = 16;
+static const int EDITS = 64;
+static const char *STORE_PATH = "bench_lod.chunks";
+
+// Colinas em camadas (pedra, terra, grama), a grama com manchas de tom de 8 em 8 células:
+// a média das reduções tem o que misturar
+static Octree *_variant(int n) {
+    Octree *tree = octree_create(NULL, {{0, 0, 0}}, {{CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE}});
+    float fx = 0.05f + 0.01f * (n % 4), fz = 0.04f + 0.01f * (n / 4), phase = (float)n;
+    for (int x = 0; x < CHUNK_SIZE; x++)
+    for (int z = 0; z < CHUNK_SIZE; z++) {
+        int height = 20 + (int)(12.0f * sinf(x * fx + phase) * cosf(z * fz - phase));
+        int dirt = height - 3 - (x / 4 + z / 4 + n) % 2;
+        uint8_t shade = (uint8_t)(((x / 8) * 7 + (z / 8) * 13 + n) % 4 * 10);
+        octree_fill(tree, {{x, 0, z}}, {{x, dirt, z}},
+                    VoxelObjCreate(voxels[VOX_STONE], make_color_rgba(110, 110, 115, 255), {{0, 0, 0}}));
+        octree_fill(tree, {{x, dirt + 1, z}}, {{x, height - 1, z}},
+                    VoxelObjCreate(voxels[VOX_DIRT], make_color_rgba(120, 80, 40, 255), {{0, 0, 0}}));
+        octree_insert(tree, VoxelObjCreate(voxels[VOX_GRASS], make_color_rgba(50, 140 + shade * 2, 40, 255), {{x, height, z}}));
+    }
+    octree_compact(tree, 0);
+    return tree;
+}
+
+static Octree *_lod_octree(Chunk *chunk, int level) {
+    Chunk_Lod *lod = &chunk->lod[level - 1];
+    IVector3 min = ivec3_scalar_mul(chunk->coord, CHUNK_SIZE);
+    return octree_from_texture(lod->texels, lod->count, lod->root, min, ivec3_scalar_add(min, CHUNK_SIZE), NULL, NULL);
+}
+
+// Imagens cheias na memória
+static size_t _packed_count(Chunk_Grid *grid) {
+    size_t count = 0;
+    for (size_t i = 0; i < grid->table_capacity; i++) count += grid->table[i].chunk && grid->table[i].chunk->packed;
+    return count;
+}
+
+// Ainda falta montar as reduções de algum chunk reduzido com conteúdo
+static bool _lod_pending(Chunk_Grid *grid) {
+    for (size_t i = 0; i < grid->table_capacity; i++) {
+        Chunk *chunk = grid->table[i].chunk;
+        if (chunk && chunk->level >= 1 && !chunk->lod_ready && (chunk->packed || chunk->stored)) return true;
+    }
+    return false;
+}
+
+static bool _same_cells(Octree *a, Octree *b) {
+    IVector3 min = a->left_bot_back;
+    for (int x = 0; x < CHUNK_SIZE; x++)
+    for (int y = 0; y < CHUNK_SIZE; y++)
+    for (int z = 0; z < CHUNK_SIZE; z++) {
+        IVector3 c = ivec3_add(min, {{x, y, z}});
+        Voxel_Object va = octree_find(a, c), vb = octree_find(b, c);
+        if ((va.coord.y == _invalid_voxel().coord.y) != (vb.coord.y == _invalid_voxel().coord.y)) return false;
+        if (va.coord.y != _invalid_voxel().coord.y && va.color != vb.color) return false;
+    }
+    return true;
+}
+
+typedef struct {
+    size_t chunks, full_texels, lod_texels, rays;
+    double full_steps, lod_steps, full_fetches, lod_fetches;
+    int full_worst, lod_worst;
+} Level_Stats;
+
+int main(void) {
+    IVector3 world_min = {{-(SIDE / 2) * CHUNK_SIZE, 0, -(SIDE / 2) * CHUNK_SIZE}};
+    IVector3 world_max = {{(SIDE / 2 + 1) * CHUNK_SIZE, CHUNK_SIZE, (SIDE / 2 + 1) * CHUNK_SIZE}};
+    Chunk_Grid *grid = chunk_grid_create(world_min, world_max);
+    Chunk_Store *store = chunk_store_create(STORE_PATH, world_min, world_max, CHUNK_LOG2, NULL);
+    if (!grid || !store || !chunk_grid_attach_store(grid, store, 0, false)) {
+        printf("não deu para criar %s\n", STORE_PATH);
+        return 1;
+    }
+    Bench_Rng rng = {42};
+    std::vector<Octree*> variants(VARIANTS);
+    for (int i = 0; i < VARIANTS; i++) variants[i] = _variant(i);
+
+    // Paginação ligada antes de colar: os chunks longe são guardados fileira a fileira
+    double t0 = bench_now_ms();
+    chunk_grid_page(grid, {{0, 0, 0}}, CHUNK_RESIDENT_RADIUS);
+    for (int z = -(SIDE / 2); z <= SIDE / 2; z++) {
+        for (int x = -(SIDE / 2); x <= SIDE / 2; x++) {
+            Voxel_Transform transform = voxel_transform_translation({{x * CHUNK_SIZE, 0, z * CHUNK_SIZE}});
+            Octree *variant = variants[bench_rand(&rng) % VARIANTS];
+            chunk_grid_paste(grid, variant, &transform, {{0, 0, 0}}, {{CHUNK_SIZE - 1, CHUNK_SIZE - 1, CHUNK_SIZE - 1}});
+        }
+        chunk_grid_page(grid, {{0, 0, 0}}, CHUNK_RESIDENT_RADIUS);
+    }
+    while (grid->leaving_count > 0) chunk_grid_page(grid, {{0, 0, 0}}, CHUNK_RESIDENT_RADIUS);
+    printf("%d chunks de terreno, montados e guardados em %.1f s; %.1f MB sem LOD (%zu imagens cheias na memória)\n",
+           SIDE * SIDE, (bench_now_ms() - t0) / 1000.0, chunk_grid_memory_usage(grid) / 1048576.0, _packed_count(grid));
+
+    // Reduções: uma página e um pedido ao disco por "quadro" até todas ficarem prontas
+    // (CHUNK_SETTLE_BUDGET_MS cada), com a câmera parada
+    chunk_grid_set_lod(grid, CHUNK_LOD_RADIUS, PIXELS_PER_RADIAN);
+    Vector3 camera = vec3_float(CHUNK_SIZE / 2.0f, CHUNK_SIZE / 2.0f, CHUNK_SIZE / 2.0f);
+    t0 = bench_now_ms();
+    int frames = 0;
+    do {
+        chunk_grid_page(grid, {{0, 0, 0}}, CHUNK_RESIDENT_RADIUS);
+        chunk_grid_prefetch(grid, camera, vec3_float(0.0f, 0.0f, 0.0f));
+        frames++;
+    } while (grid->lod_count > 0 || _lod_pending(grid));
+    double build_ms = bench_now_ms() - t0;
+    size_t built = 0;
+    for (size_t i = 0; i < grid->table_capacity; i++) built += grid->table[i].chunk && grid->table[i].chunk->lod_ready;
+    bench_header("montagem das reduções");
+    printf("%zu chunks em %d quadros, %.1f ms (%.2f ms por chunk)\n", built, frames, build_ms, built ? build_ms / built : 0.0);
+
+    size_t texture_bytes = 0;
+    uint8_t *texture = chunk_grid_texture(grid, &texture_bytes);
+    size_t dir_bytes = 0;
+    int32_t *directory = chunk_grid_gpu_buffer(grid, &dir_bytes);
+    size_t on_gpu = 0;
+    for (size_t i = 8; i + 1 < dir_bytes / sizeof(int32_t); i += 2) on_gpu += directory[i] >= 0;
+    printf("textura: %.1f MB (%zu chunks no diretório de %.0f KB, células até %.1f pixels)\n", texture_bytes / 1048576.0,
+           on_gpu, dir_bytes / 1024.0, grid->lod_pixels);
+    free(texture);
+    free(directory);
+    // Depois da textura: as reduções que não couberam nela já foram trocadas pelas mais grossas
+    printf("memória com LOD: %.1f MB (%zu imagens cheias na memória)\n", chunk_grid_memory_usage(grid) / 1048576.0,
+           _packed_count(grid));
+
+    // Raios da câmera (acima do chunk do meio) para pontos sorteados de cada chunk longe,
+    // contados só dentro do chunk: na octree cheia e na redução do nível dele
+    Level_Stats levels[CHUNK_LOD_LEVELS + 1];
+    memset(levels, 0, sizeof(levels));
+    Vector3 eye = vec3_float(CHUNK_SIZE / 2.0f, CHUNK_SIZE - 4.0f, CHUNK_SIZE / 2.0f);
+    for (size_t i = 0; i < grid->table_capacity; i++) {
+        Chunk *chunk = grid->table[i].chunk;
+        if (!chunk || chunk->level < 1 || !chunk->lod_ready) continue;
+        // A imagem cheia dos reduzidos está no disco
+        Svo_Map *packed = chunk->packed ? chunk->packed : chunk_store_read(grid->store, chunk->coord);
+        if (!packed) continue;
+        Level_Stats *stats = &levels[chunk->level];
+        Octree *full = svo_map_to_octree(packed);
+        Octree *lod = _lod_octree(chunk, chunk->level);
+        stats->chunks++;
+        stats->full_texels += packed->texel_count;
+        if (packed != chunk->packed) svo_map_delete(packed);
+        stats->lod_texels += chunk->lod[chunk->level - 1].count;
+
+        IVector3 lo = ivec3_scalar_mul(chunk->coord, CHUNK_SIZE);
+        Vector3 min = vec3_ivec3(lo), max = vec3_ivec3(ivec3_scalar_add(lo, CHUNK_SIZE));
+        for (int r = 0; r < RAYS_PER_CHUNK; r++) {
+            Vector3 target = vec3_float(lo.x + bench_rand_float(&rng) * CHUNK_SIZE, 8.0f + bench_rand_float(&rng) * 24.0f,
+                                        lo.z + bench_rand_float(&rng) * CHUNK_SIZE);
+            Ray ray = ray_create(eye, vec3_normalize(vec3_sub(target, eye)));
+            float t_min, t_max;
+            if (!ray_hits_box(ray, min, max, &t_min, &t_max)) continue;
+            ray.origin = vec3_add(eye, vec3_scalar_mul(ray.direction, t_min + 1e-3f));
+            Ray_Stats full_stats = {0, 0}, lod_stats = {0, 0};
+            octree_ray_cast_stats(full, ray, min, max, &full_stats);
+            octree_ray_cast_stats(lod, ray, min, max, &lod_stats);
+            stats->rays++;
+            stats->full_steps += full_stats.steps;
+            stats->lod_steps += lod_stats.steps;
+            stats->full_fetches += full_stats.fetches;
+            stats->lod_fetches += lod_stats.fetches;
+            stats->full_worst = std::max(stats->full_worst, full_stats.steps);
+            stats->lod_worst = std::max(stats->lod_worst, lod_stats.steps);
+        }
+        octree_delete(full);
+        octree_delete(lod);
+    }
+    bench_header("por nível: texels e passos por raio dentro do chunk (cheia -> redução)");
+    printf("%-6s | %7s | %12s | %12s | %15s | %17s | %13s\n", "nível", "chunks", "texels cheia", "texels LOD",
+           "passos médios", "leituras médias", "pior passos");
+    for (int level = 1; level <= CHUNK_LOD_LEVELS; level++) {
+        Level_Stats *s = &levels[level];
+        if (s->chunks == 0 || s->rays == 0) continue;
+        printf("%d (%d³) | %7zu | %12zu | %12zu | %6.1f -> %5.1f | %7.1f -> %6.1f | %5d -> %4d\n", level, 1 << level,
+               s->chunks, s->full_texels, s->lod_texels, s->full_steps / s->rays, s->lod_steps / s->rays,
+               s->full_fetches / s->rays, s->lod_fetches / s->rays, s->full_worst, s->lod_worst);
+    }
+
+    // Edição pequena num chunk longe: só as células da caixa contra a pirâmide inteira
+    bench_header("edição de 4³: caixa contra pirâmide inteira");
+    double partial_ms = 0.0, full_ms = 0.0;
+    int mismatches = 0;
+    Voxel_Object glass = VoxelObjCreate(voxels[VOX_GLASS], make_color_rgba(200, 220, 255, 128), {{0, 0, 0}});
+    for (int e = 0; e < EDITS; e++) {
+        Octree *tree = octree_clone(variants[e % VARIANTS]);
+        Octree *pyramid[CHUNK_LOD_LEVELS];
+        Octree *finer = tree;
+        for (int level = 0; level < CHUNK_LOD_LEVELS; level++) finer = pyramid[level] = octree_downsample(finer, 2 << level);
+
+        IVector3 min = {{bench_rand_range(&rng, 0, CHUNK_SIZE - 4), bench_rand_range(&rng, 8, 32), bench_rand_range(&rng, 0, CHUNK_SIZE - 4)}};
+        IVector3 max = ivec3_scalar_add(min, 3);
+        if (e % 2) octree_fill(tree, min, max, glass);
+        else octree_clear(tree, min, max);
+
+        double t = bench_now_ms();
+        finer = tree;
+        for (int level = 0; level < CHUNK_LOD_LEVELS; level++) {
+            octree_downsample_region(pyramid[level], finer, 2 << level, min, max);
+            finer = pyramid[level];
+        }
+        partial_ms += bench_now_ms() - t;
+
+        t = bench_now_ms();
+        Octree *rebuilt[CHUNK_LOD_LEVELS];
+        finer = tree;
+        for (int level = 0; level < CHUNK_LOD_LEVELS; level++) finer = rebuilt[level] = octree_downsample(finer, 2 << level);
+        full_ms += bench_now_ms() - t;
+
+        for (int level = 0; level < CHUNK_LOD_LEVELS; level++) {
+            mismatches += !_same_cells(pyramid[level], rebuilt[level])
+                       || _octree_texel_size(pyramid[level]) != _octree_texel_size(rebuilt[level]);
+            octree_delete(pyramid[level]);
+            octree_delete(rebuilt[level]);
+        }
+        octree_delete(tree);
+    }
+    printf("caixa: %.3f ms por edição | inteira: %.3f ms | diferenças: %d\n", partial_ms / EDITS, full_ms / EDITS, mismatches);
+
+    for (Octree *variant : variants) octree_delete(variant);
+    chunk_grid_delete(grid);
+    remove(STORE_PATH);
+    return mismatches != 0;
+}
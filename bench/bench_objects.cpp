@@ -0,0 +1,242 @@
+// Centenas de objetos dinâmicos andando sobre um terreno estático. Cada quadro todos se
+// movem e alguns trocam de modelo (um quadro novo de animação, como o Bad Apple do
+// main.cpp). Camada de objetos: refit da BVH, regravar só os modelos novos na cópia da
+// textura e gerar o buffer da BVH. Contra o jeito antigo: refazer a octree do mundo com
+// tudo dentro e reenviar a textura inteira. Confere os raios da composição (mundo +
+// objetos) contra o DDA exato da cena copiada.
+//
+// Uso: bench_objects
+
+#include "bench.hpp"
+#include <world.hpp>
+#include <objects.hpp>
+#include <sparseGrid.hpp>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+static const int TERRAIN_SIDE = 384;
+static const int FRAME_COUNT = 60;
+static const int ANIMATED_PER_FRAME = 8;
+static const int RAY_COUNT = 20000;
+// O jeito antigo é lento demais para todos os quadros
+static const int REBUILD_FRAMES = 2;
+
+static const int Y_ROTATIONS[4][3][3] = {
+    {{ 1, 0, 0}, {0, 1, 0}, { 0, 0,  1}},
+    {{ 0, 0, 1}, {0, 1, 0}, {-1, 0,  0}},
+    {{-1, 0, 0}, {0, 1, 0}, { 0, 0, -1}},
+    {{ 0, 0,-1}, {0, 1, 0}, { 1, 0,  0}},
+};
+
+static const ColorRGBA COLORS[4] = {
+    make_color_rgba(200, 60, 40, 255), make_color_rgba(60, 160, 60, 255),
+    make_color_rgba(50, 70, 190, 255), make_color_rgba(230, 230, 230, 255)
+};
+
+// Terreno de altura suave, 3 camadas de espessura
+static void _terrain(World *world, Sparse_Grid *exact) {
+    for (int z = -TERRAIN_SIDE / 2; z < TERRAIN_SIDE / 2; z++)
+    for (int x = -TERRAIN_SIDE / 2; x < TERRAIN_SIDE / 2; x++) {
+        int h = (int)(8.0f * sinf(x * 0.05f) + 6.0f * cosf(z * 0.07f));
+        for (int y = h - 2; y <= h; y++) {
+            Voxel_Object voxel = VoxelObjCreate(voxels[VOX_STONE], COLORS[1], {{x, y, z}});
+            if (world) world_insert(world, voxel);
+            if (exact) sparse_grid_insert(exact, voxel);
+        }
+    }
+    if (world) world_compact(world, 0);
+}
+
+// Modelos dos objetos: esfera oca, caixa, torre
+static Octree *_shape(int kind) {
+    Octree *model = octree_create(NULL, {{0, 0, 0}}, {{16, 16, 16}});
+    for (int z = 0; z < 16; z++)
+    for (int y = 0; y < 16; y++)
+    for (int x = 0; x < 16; x++) {
+        float dx = x - 7.5f, dy = y - 7.5f, dz = z - 7.5f;
+        bool in = false;
+        if (kind == 0) in = fabsf(sqrtf(dx * dx + dy * dy + dz * dz) - 6.5f) < 1.0f;
+        if (kind == 1) in = x >= 2 && x < 14 && y < 12 && z >= 2 && z < 14;
+        if (kind == 2) in = x >= 5 && x < 11 && z >= 5 && z < 11;
+        if (in) octree_insert(model, VoxelObjCreate(voxels[VOX_STONE], COLORS[(x / 4 + y / 4 + kind) % 4], {{x, y, z}}));
+    }
+    octree_compact(model, 0);
+    return model;
+}
+
+// Quadro de animação: imagem 48x36 preto e branco que muda a cada quadro (em pé, em XY)
+static Octree *_animation_frame(int frame, int seed) {
+    Octree *model = octree_create(NULL, {{0, 0, 0}}, {{64, 64, 64}});
+    float cx = 24.0f + 14.0f * sinf((frame + seed) * 0.2f), cy = 18.0f + 10.0f * cosf((frame + seed) * 0.15f);
+    for (int y = 0; y < 36; y++)
+    for (int x = 0; x < 48; x++) {
+        float dx = x - cx, dy = y - cy;
+        ColorRGBA color = (dx * dx + dy * dy < 100.0f) ? COLORS[3] : make_color_rgba(0, 0, 0, 255);
+        octree_insert(model, VoxelObjCreate(voxels[VOX_STONE], color, {{x, y, 0}}));
+    }
+    octree_compact(model, 0);
+    return model;
+}
+
+// Órbita em volta do centro, acima do terreno; gira 90° a cada 16 quadros
+static Voxel_Transform _pose(int index, int count, int frame) {
+    float angle = (float)index / count * 6.2831853f + frame * 0.01f;
+    float radius = 40.0f + (index % 7) * 20.0f;
+    Voxel_Transform t;
+    memcpy(t.rot, Y_ROTATIONS[(index + frame / 16) % 4], sizeof(t.rot));
+    t.translation = {{(int)(radius * cosf(angle)), 24 + (index % 5) * 20 + (int)(4.0f * sinf(frame * 0.3f + index)), (int)(radius * sinf(angle))}};
+    return t;
+}
+
+typedef struct {
+    World *world;
+    Sparse_Grid *exact;
+    const Voxel_Transform *transform;
+} Bake_State;
+
+static void _bake_voxel(void *user, Voxel_Object voxel) {
+    Bake_State *state = (Bake_State*)user;
+    voxel.coord = voxel_transform_cell(state->transform, voxel.coord);
+    if (state->world) world_insert(state->world, voxel);
+    if (state->exact) sparse_grid_insert(state->exact, voxel);
+}
+
+// Cena copiada: terreno e cada objeto transformado em voxels (na ordem da camada, então
+// onde dois se sobrepõem vence o mesmo)
+static void _bake(Object_Layer *layer, World *world, Sparse_Grid *exact) {
+    for (size_t i = 0; i < layer->set->count; i++) {
+        Bake_State state = {world, exact, &layer->set->items[i].transform};
+        octree_for_each(layer->set->items[i].model, _bake_voxel, &state);
+    }
+    _terrain(world, exact);
+}
+
+static void _count_texels(void *user, size_t first, size_t count) {
+    (void)first;
+    *(size_t*)user += count;
+}
+
+static void _run(int count) {
+    Bench_Rng rng = {99 + (uint64_t)count};
+
+    World *world = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    _terrain(world, NULL);
+
+    Octree *shapes[3] = {_shape(0), _shape(1), _shape(2)};
+    std::vector<long> ids;
+    for (int i = 0; i < count; i++) {
+        Octree *model = (i % 10 == 0) ? _animation_frame(0, i) : shapes[i % 3];
+        ids.push_back(world_add_object(world, model, _pose(i, count, 0)));
+        if (i % 10 == 0) octree_delete(model);
+    }
+
+    size_t arr_size = 0;
+    uint8_t *texture = world_texture(world, &arr_size, 0);
+    size_t tex_dim = (size_t)ceil(cbrt((double)(arr_size / 4)));
+    size_t capacity = tex_dim * tex_dim * tex_dim;
+    uint8_t *mirror = (uint8_t*)calloc(capacity, 4);
+    memcpy(mirror, texture, arr_size);
+    free(texture);
+
+    double move_ms = 0, animate_ms = 0, refit_ms = 0, sync_ms = 0, buffer_ms = 0;
+    size_t uploaded = 0, buffer_size = 0;
+    int full_uploads = 0;
+    for (int frame = 1; frame <= FRAME_COUNT; frame++) {
+        double t0 = bench_now_ms();
+        for (int i = 0; i < count; i++) world_move_object(world, ids[i], _pose(i, count, frame));
+        move_ms += bench_now_ms() - t0;
+
+        // Os quadros de animação são montados fora (é custo de quem anima, não da camada)
+        std::vector<Octree*> frames;
+        for (int k = 0; k < ANIMATED_PER_FRAME; k++) frames.push_back(_animation_frame(frame, k * 10));
+        t0 = bench_now_ms();
+        for (int k = 0; k < ANIMATED_PER_FRAME; k++) {
+            world_set_object_model(world, ids[(k * 10) % count], frames[k]);
+            octree_delete(frames[k]);
+        }
+        animate_ms += bench_now_ms() - t0;
+
+        t0 = bench_now_ms();
+        if (!world_sync_objects(world, mirror, capacity, _count_texels, &uploaded)) {
+            full_uploads++;
+            texture = world_texture(world, &arr_size, 0);
+            tex_dim = (size_t)ceil(cbrt((double)(arr_size / 4)));
+            capacity = tex_dim * tex_dim * tex_dim;
+            free(mirror);
+            mirror = (uint8_t*)calloc(capacity, 4);
+            memcpy(mirror, texture, arr_size);
+            free(texture);
+            uploaded += arr_size / 4;
+        }
+        sync_ms += bench_now_ms() - t0;
+
+        t0 = bench_now_ms();
+        world_update_instances(world);
+        refit_ms += bench_now_ms() - t0;
+
+        t0 = bench_now_ms();
+        free(world_instance_buffer(world, &buffer_size));
+        buffer_ms += bench_now_ms() - t0;
+    }
+    double layer_ms = (move_ms + animate_ms + refit_ms + sync_ms + buffer_ms) / FRAME_COUNT;
+
+    // Jeito antigo: mundo refeito do zero com os objetos copiados, textura inteira
+    double rebuild_ms = 0;
+    size_t rebuild_texture = 0;
+    for (int frame = 0; frame < REBUILD_FRAMES; frame++) {
+        double t0 = bench_now_ms();
+        World *baked = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+        _bake(world->objects, baked, NULL);
+        free(world_texture(baked, &rebuild_texture, 0));
+        rebuild_ms += bench_now_ms() - t0;
+        world_delete(baked);
+    }
+    rebuild_ms /= REBUILD_FRAMES;
+
+    // Composição (CPU) contra o DDA exato da cena copiada
+    Sparse_Grid *exact = sparse_grid_create();
+    _bake(world->objects, NULL, exact);
+    int errors = 0;
+    double t0 = bench_now_ms();
+    for (int i = 0; i < RAY_COUNT; i++) {
+        Ray ray = bench_random_ray(&rng, {{0.0f, 40.0f, 0.0f}}, 200.0f);
+        Voxel_Object hit, expected;
+        bool found = world_ray_cast(world, ray, &hit);
+        bool expected_hit = sparse_grid_ray_cast(exact, ray, &expected, NULL);
+        errors += found != expected_hit || (found && !ivec3_equal_vec(hit.coord, expected.coord));
+    }
+    double rays_ms = bench_now_ms() - t0;
+
+    printf("%5d | %6.3f %6.3f %6.3f %6.3f %6.3f | %7.3f %8.1f %7.1f %4d | %8.1f %8.1f | %5d (%.1f us/raio)\n",
+           count, move_ms / FRAME_COUNT, animate_ms / FRAME_COUNT, sync_ms / FRAME_COUNT,
+           refit_ms / FRAME_COUNT, buffer_ms / FRAME_COUNT, layer_ms,
+           uploaded * 4.0 / 1024.0 / FRAME_COUNT, buffer_size / 1024.0, full_uploads,
+           rebuild_ms, rebuild_texture / 1048576.0, errors, rays_ms * 1000.0 / RAY_COUNT);
+
+    sparse_grid_delete(exact);
+    free(mirror);
+    for (Octree *shape : shapes) octree_delete(shape);
+    world_delete(world);
+}
+
+int main(void) {
+    bench_header("Objetos dinâmicos: camada de objetos vs refazer o mundo");
+    printf("terreno %dx%d, %d quadros, %d objetos trocam de modelo por quadro\n",
+           TERRAIN_SIDE, TERRAIN_SIDE, FRAME_COUNT, ANIMATED_PER_FRAME);
+    printf("%5s | %6s %6s %6s %6s %6s | %7s %8s %7s %4s | %8s %8s | %5s\n",
+           "obj", "mover", "animar", "tex", "refit", "buffer", "total", "tex KB", "bvh KB", "cheia",
+           "refazer", "tex MB", "erro");
+
+    _run(200);
+    _run(500);
+    _run(1000);
+
+    printf("\nmover/animar/tex/refit/buffer/total = ms por quadro na camada de objetos (tex =\n"
+           "regravar os modelos novos na cópia da textura); tex KB = texels enviados por quadro;\n"
+           "bvh KB = buffer das BVHs; cheia = quadros que pediram a textura inteira.\n"
+           "refazer = ms por quadro refazendo o mundo com os objetos copiados + textura (tex MB).\n"
+           "erro = raios (mundo + objetos) que erram o voxel do DDA exato da cena copiada (os\n"
+           "poucos que sobram passam rentes a uma aresta e param na célula vizinha).\n");
+    return 0;
+}
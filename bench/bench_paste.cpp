@@ -0,0 +1,165 @@
+// Copiar e colar uma estrutura de 128³ (paredes, pisos e pilares sólidos, com detalhes
+// soltos) num mundo com terreno. Copiar a região e colar enxertando subárvores, contra um
+// world_find/world_insert por voxel. A colagem é medida alinhada aos nós da octree, fora
+// do alinhamento e girada; o resultado é conferido célula a célula contra o por voxel.
+//
+// Uso: bench_paste
+
+#include "bench.hpp"
+#include <world.hpp>
+#include <instances.hpp>
+
+static const int STRUCTURE_SIDE = 128;
+static const int TERRAIN_SIDE = 512;
+
+static const ColorRGBA COLORS[4] = {
+    make_color_rgba(200, 60, 40, 255), make_color_rgba(60, 160, 60, 255),
+    make_color_rgba(50, 70, 190, 255), make_color_rgba(230, 230, 230, 255)
+};
+
+static void _terrain(World *world) {
+    for (int z = -TERRAIN_SIDE / 2; z < TERRAIN_SIDE / 2; z++)
+    for (int x = -TERRAIN_SIDE / 2; x < TERRAIN_SIDE / 2; x++)
+    for (int y = -4; y < 0; y++) {
+        world_insert(world, VoxelObjCreate(voxels[VOX_STONE], COLORS[1], {{x, y, z}}));
+    }
+}
+
+// Torre oca com 4 pisos, pilares e blocos soltos, ocupando [origin, origin + 128)
+static void _structure(World *world, IVector3 origin) {
+    Bench_Rng rng = {99};
+    int n = STRUCTURE_SIDE;
+    for (int z = 0; z < n; z++)
+    for (int y = 0; y < n; y++)
+    for (int x = 0; x < n; x++) {
+        bool wall = x < 4 || x >= n - 4 || z < 4 || z >= n - 4;
+        bool floor = y % 32 < 2;
+        bool pillar = (x % 32 >= 14 && x % 32 < 18) && (z % 32 >= 14 && z % 32 < 18);
+        bool window = wall && y % 32 >= 12 && y % 32 < 20 && ((x + z) % 24 < 8);
+        if ((wall && !window) || floor || pillar) {
+            int color = wall ? 0 : (floor ? 3 : 2);
+            world_insert(world, VoxelObjCreate(voxels[VOX_STONE], COLORS[color], {{origin.x + x, origin.y + y, origin.z + z}}));
+        }
+    }
+    for (int i = 0; i < 4000; i++) {
+        IVector3 c = {{bench_rand_range(&rng, 4, n - 4), bench_rand_range(&rng, 2, n), bench_rand_range(&rng, 4, n - 4)}};
+        world_insert(world, VoxelObjCreate(voxels[VOX_WOOD], COLORS[bench_rand(&rng) % 4], ivec3_add(origin, c)));
+    }
+}
+
+static World *_scene(void) {
+    World *world = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    _terrain(world);
+    _structure(world, {{0, 0, 0}});
+    world_compact(world, 0);
+    return world;
+}
+
+typedef struct {
+    World *world;
+    const Voxel_Transform *transform;
+    size_t count;
+} Stamp_State;
+
+static void _stamp_voxel(void *user, Voxel_Object voxel) {
+    Stamp_State *state = (Stamp_State*)user;
+    voxel.coord = voxel_transform_cell(state->transform, voxel.coord);
+    world_insert(state->world, voxel);
+    state->count++;
+}
+
+static bool _same(Voxel_Object a, Voxel_Object b) {
+    bool a_empty = a.coord.y == _invalid_voxel().coord.y, b_empty = b.coord.y == _invalid_voxel().coord.y;
+    if (a_empty || b_empty) return a_empty == b_empty;
+    return a.color == b.color;
+}
+
+// Células diferentes numa margem de 1 em volta da caixa colada
+static int _mismatches(World *a, World *b, const Voxel_Transform *transform, IVector3 extent) {
+    IVector3 p = voxel_transform_cell(transform, {{0, 0, 0}});
+    IVector3 q = voxel_transform_cell(transform, ivec3_scalar_add(extent, -1));
+    IVector3 min = ivec3_scalar_add(ivec3_min(p, q), -1), max = ivec3_scalar_add(ivec3_max(p, q), 1);
+    int errors = 0;
+    for (int z = min.z; z <= max.z; z++)
+    for (int y = min.y; y <= max.y; y++)
+    for (int x = min.x; x <= max.x; x++) {
+        errors += !_same(world_find(a, {{x, y, z}}), world_find(b, {{x, y, z}}));
+    }
+    return errors;
+}
+
+static void _paste_case(const char *name, Octree *clip, int rotation, IVector3 offset) {
+    IVector3 extent = {{STRUCTURE_SIDE, STRUCTURE_SIDE, STRUCTURE_SIDE}};
+    Voxel_Transform transform = voxel_transform_place(rotation, extent, offset);
+
+    World *grafted = _scene();
+    double t0 = bench_now_ms();
+    world_paste(grafted, clip, transform);
+    double graft_ms = bench_now_ms() - t0;
+    t0 = bench_now_ms();
+    world_compact(grafted, 0);
+    double compact_ms = bench_now_ms() - t0;
+
+    World *stamped = _scene();
+    Stamp_State state = {stamped, &transform, 0};
+    t0 = bench_now_ms();
+    octree_for_each(clip, _stamp_voxel, &state);
+    world_compact(stamped, 0);
+    double voxel_ms = bench_now_ms() - t0;
+
+    int errors = _mismatches(grafted, stamped, &transform, extent);
+    printf("%-22s | %8.2f %8.2f | %9.1f %7.1fx | %6.1f %6.1f | %6d\n",
+           name, graft_ms, compact_ms, voxel_ms, voxel_ms / (graft_ms + compact_ms),
+           world_memory_usage(grafted) / 1048576.0, world_memory_usage(stamped) / 1048576.0, errors);
+    world_delete(grafted);
+    world_delete(stamped);
+}
+
+int main(void) {
+    World *world = _scene();
+    IVector3 min = {{0, 0, 0}}, max = {{STRUCTURE_SIDE - 1, STRUCTURE_SIDE - 1, STRUCTURE_SIDE - 1}};
+
+    double t0 = bench_now_ms();
+    Octree *clip = world_copy_region(world, min, max);
+    double copy_ms = bench_now_ms() - t0;
+
+    // Cópia por voxel: um world_find por célula da região
+    t0 = bench_now_ms();
+    Octree *slow = octree_create(NULL, {{0, 0, 0}}, {{STRUCTURE_SIDE, STRUCTURE_SIDE, STRUCTURE_SIDE}});
+    size_t voxel_count = 0;
+    for (int z = min.z; z <= max.z; z++)
+    for (int y = min.y; y <= max.y; y++)
+    for (int x = min.x; x <= max.x; x++) {
+        Voxel_Object voxel = world_find(world, {{x, y, z}});
+        if (voxel.coord.y == _invalid_voxel().coord.y) continue;
+        voxel.coord = {{x, y, z}};
+        octree_insert(slow, voxel);
+        voxel_count++;
+    }
+    octree_compact(slow, 0);
+    double slow_copy_ms = bench_now_ms() - t0;
+
+    int copy_errors = 0;
+    for (int z = min.z; z <= max.z; z++)
+    for (int y = min.y; y <= max.y; y++)
+    for (int x = min.x; x <= max.x; x++) {
+        copy_errors += !_same(octree_find(clip, {{x, y, z}}), octree_find(slow, {{x, y, z}}));
+    }
+
+    printf("estrutura %d³, %zu voxels\n", STRUCTURE_SIDE, voxel_count);
+    printf("copiar: enxerto %.2f ms (%.2f MB), por voxel %.1f ms (%.2f MB), %d diferenças\n\n",
+           copy_ms, octree_memory_usage(clip) / 1048576.0, slow_copy_ms, octree_memory_usage(slow) / 1048576.0, copy_errors);
+
+    printf("%-22s | %8s %8s | %9s %8s | %6s %6s | %6s\n",
+           "colar", "enxerto", "compact", "por voxel", "ganho", "MB", "MB vox", "erros");
+    _paste_case("alinhado", clip, 0, {{256, 0, 256}});
+    _paste_case("alinhado (negativo)", clip, 0, {{-384, 0, -256}});
+    _paste_case("desalinhado", clip, 0, {{261, 3, 250}});
+    _paste_case("girado alinhado", clip, 9, {{256, 0, 256}});
+    _paste_case("girado desalinhado", clip, 17, {{-301, 7, 190}});
+
+    octree_delete(slow);
+    octree_delete(clip);
+    world_delete(world);
+    return 0;
+}
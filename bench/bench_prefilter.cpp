@@ -0,0 +1,299 @@
+// Médias nos nós internos (octree_texture_write): um terreno de 512² visto de um canto,
+// renderizado sem GPU pela mesma descida do shader (svo_map_ray_cast_cone).
+// Mede
+//  - textura: texels e quantos deles são médias;
+//  - raios da câmera: passos e leituras por raio descendo até 1³ contra parando no nó que
+//    cabe no cone (de 1, 4 e 16 pixels), e a diferença entre as imagens; todas também são
+//    comparadas com uma referência supersampleada (4x4 raios por pixel em resolução cheia);
+//  - sombras: dos pontos atingidos com o cone de 1 pixel, raios até o sol em resolução
+//    cheia e com os cones abrindo 1, 4 (SECONDARY_CONE_SCALE do shader) e 16 pixels.
+//
+// Uso: bench_prefilter [pasta]   (com uma pasta, grava as imagens nela em .ppm)
+
+#include "bench.hpp"
+#include <svoFile.hpp>
+#include <string>
+#include <vector>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const int SIDE = 512;
+static const int WIDTH = 320, HEIGHT = 180;
+static const float FOV_DEGREES = 45.0f;
+static const int SUPERSAMPLE = 4;
+static const float SECONDARY_CONE_SCALE = 4.0f; //o mesmo do shader
+// Sol baixo: as sombras atravessam o terreno em vez de sair logo para o céu
+static const Vector3 SUN = vec3_normalize(vec3_float(0.7f, 0.3f, 0.2f));
+
+typedef struct _view {
+    Vector3 eye, forward, right, up;
+    float pixel_angle;  //radianos por pixel, no centro da imagem
+} View;
+
+typedef struct _render {
+    std::vector<float> rgb;           //WIDTH * HEIGHT * 3, 0-255
+    std::vector<Vector3> points;      //ponto atingido (fora do voxel) por pixel
+    std::vector<float> distances;     //distância da câmera ao acerto
+    std::vector<bool> hits;
+    double steps, fetches, ms;
+} Render;
+
+// Colinas com camadas, grama com manchas e ruído por voxel: o que um pixel longe mistura
+static Octree *_terrain(void) {
+    Octree *tree = octree_create(NULL, {{0, 0, 0}}, {{SIDE, SIDE, SIDE}});
+    for (int x = 0; x < SIDE; x++)
+    for (int z = 0; z < SIDE; z++) {
+        int height = (int)(48.0 + 20.0 * sin(x * 0.021) * cos(z * 0.017) + 8.0 * sin((x + z) * 0.07));
+        uint32_t noise = (uint32_t)x * 73856093u ^ (uint32_t)z * 19349663u;
+        noise = (noise ^ (noise >> 13)) * 0x5bd1e995u;
+        uint8_t shade = (uint8_t)(((x / 8 + z / 8) % 3) * 20 + (noise >> 27));
+        octree_fill(tree, {{x, 0, z}}, {{x, height - 4, z}},
+                    VoxelObjCreate(voxels[VOX_STONE], make_color_rgba(120, 120, 125, 255), {{0, 0, 0}}));
+        octree_fill(tree, {{x, height - 3, z}}, {{x, height - 1, z}},
+                    VoxelObjCreate(voxels[VOX_DIRT], make_color_rgba(110, 80, 50, 255), {{0, 0, 0}}));
+        octree_insert(tree, VoxelObjCreate(voxels[VOX_GRASS], make_color_rgba(40 + shade, 120 + shade, 40, 255), {{x, height, z}}));
+    }
+    octree_compact(tree, 0);
+    return tree;
+}
+
+// Nós internos: cada um leva a média da subárvore (FILTER_SIZE = 2 texels em octree.cpp)
+static size_t _interior_nodes(Octree *node) {
+    if (!node || !node->children) return 0;
+    size_t count = 1;
+    for (int i = 0; i < 8; i++) count += _interior_nodes(node->children[i]);
+    return count;
+}
+
+static Svo_Map *_encode(Octree *tree, size_t *texels, double *ms) {
+    size_t size = 0;
+    double t0 = bench_now_ms();
+    uint8_t *image = svo_file_encode(tree, &size);
+    *ms = bench_now_ms() - t0;
+    Svo_Map *map = svo_map_from_memory(image, size, false);
+    *texels = map ? map->texel_count : 0;
+    return map;
+}
+
+static Ray _pixel_ray(const View *view, float px, float py) {
+    float half = tanf(FOV_DEGREES * 0.5f * (float)M_PI / 180.0f);
+    float u = (px / WIDTH * 2.0f - 1.0f) * half * WIDTH / HEIGHT;
+    float v = (1.0f - py / HEIGHT * 2.0f) * half;
+    Vector3 dir = vec3_add(view->forward, vec3_add(vec3_scalar_mul(view->right, u), vec3_scalar_mul(view->up, v)));
+    return ray_create(view->eye, vec3_normalize(dir));
+}
+
+// Entrada do raio na célula atingida: a distância e a normal da face (pelo eixo do último
+// plano cruzado)
+static float _cell_entry(Ray ray, IVector3 cell, Vector3 *normal) {
+    float t_near[3], dir[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+    float origin[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+    int lo[3] = {cell.x, cell.y, cell.z};
+    for (int i = 0; i < 3; i++) {
+        if (fabsf(dir[i]) < 1e-8f) {
+            t_near[i] = -1e30f;
+            continue;
+        }
+        float t0 = (lo[i] - origin[i]) / dir[i], t1 = (lo[i] + 1 - origin[i]) / dir[i];
+        t_near[i] = fminf(t0, t1);
+    }
+    int axis = t_near[0] > t_near[1] ? (t_near[0] > t_near[2] ? 0 : 2) : (t_near[1] > t_near[2] ? 1 : 2);
+    float n[3] = {0, 0, 0};
+    n[axis] = dir[axis] > 0 ? -1.0f : 1.0f;
+    *normal = vec3_float(n[0], n[1], n[2]);
+    return fmaxf(t_near[axis], 0.0f);
+}
+
+static void _shade(Voxel_Object voxel, Vector3 normal, float *rgb) {
+    float light = 0.35f + 0.65f * fmaxf(vec3_dot(normal, SUN), 0.0f);
+    rgb[0] = get_red_rgba(voxel.color) * light;
+    rgb[1] = get_green_rgba(voxel.color) * light;
+    rgb[2] = get_blue_rgba(voxel.color) * light;
+}
+
+static const float SKY[3] = {128.0f, 178.0f, 255.0f};
+
+static void _render(Svo_Map *map, const View *view, float spread, Render *out) {
+    out->rgb.assign(WIDTH * HEIGHT * 3, 0.0f);
+    out->points.assign(WIDTH * HEIGHT, vec3_float(0, 0, 0));
+    out->distances.assign(WIDTH * HEIGHT, 0.0f);
+    out->hits.assign(WIDTH * HEIGHT, false);
+    Ray_Stats stats = {0, 0};
+    double t0 = bench_now_ms();
+    for (int y = 0; y < HEIGHT; y++)
+    for (int x = 0; x < WIDTH; x++) {
+        int pixel = y * WIDTH + x;
+        Ray ray = _pixel_ray(view, x + 0.5f, y + 0.5f);
+        Voxel_Object hit;
+        float *rgb = &out->rgb[pixel * 3];
+        if (!svo_map_ray_cast_cone(map, ray, 0.0f, spread, &hit, &stats)) {
+            memcpy(rgb, SKY, sizeof(SKY));
+            continue;
+        }
+        Vector3 normal;
+        float t = _cell_entry(ray, hit.coord, &normal);
+        _shade(hit, normal, rgb);
+        out->hits[pixel] = true;
+        out->points[pixel] = vec3_add(vec3_add(ray.origin, vec3_scalar_mul(ray.direction, t)), vec3_scalar_mul(normal, 0.01f));
+        out->distances[pixel] = t;
+    }
+    out->ms = bench_now_ms() - t0;
+    out->steps = (double)stats.steps / (WIDTH * HEIGHT);
+    out->fetches = (double)stats.fetches / (WIDTH * HEIGHT);
+}
+
+// Média de SUPERSAMPLE² raios por pixel em resolução cheia
+static void _reference(Svo_Map *map, const View *view, std::vector<float> *rgb) {
+    rgb->assign(WIDTH * HEIGHT * 3, 0.0f);
+    for (int y = 0; y < HEIGHT; y++)
+    for (int x = 0; x < WIDTH; x++) {
+        float *sum = &(*rgb)[(y * WIDTH + x) * 3];
+        for (int sy = 0; sy < SUPERSAMPLE; sy++)
+        for (int sx = 0; sx < SUPERSAMPLE; sx++) {
+            Ray ray = _pixel_ray(view, x + (sx + 0.5f) / SUPERSAMPLE, y + (sy + 0.5f) / SUPERSAMPLE);
+            Voxel_Object hit;
+            float sample[3];
+            if (svo_map_ray_cast(map, ray, &hit)) {
+                Vector3 normal;
+                _cell_entry(ray, hit.coord, &normal);
+                _shade(hit, normal, sample);
+            } else {
+                memcpy(sample, SKY, sizeof(SKY));
+            }
+            for (int c = 0; c < 3; c++) sum[c] += sample[c] / (SUPERSAMPLE * SUPERSAMPLE);
+        }
+    }
+}
+
+// Erro médio absoluto (0-255 por canal) e a fração de pixels com algum canal a mais de 16
+static void _difference(const std::vector<float> &a, const std::vector<float> &b, double *mean, double *changed) {
+    double sum = 0;
+    size_t count = 0;
+    for (size_t pixel = 0; pixel < a.size() / 3; pixel++) {
+        float worst = 0;
+        for (int c = 0; c < 3; c++) {
+            float d = fabsf(a[pixel * 3 + c] - b[pixel * 3 + c]);
+            sum += d;
+            worst = fmaxf(worst, d);
+        }
+        count += worst > 16.0f;
+    }
+    *mean = sum / a.size();
+    *changed = 100.0 * count / (a.size() / 3);
+}
+
+static void _write_ppm(const std::string &path, const std::vector<float> &rgb) {
+    FILE *fp = fopen(path.c_str(), "wb");
+    if (!fp) return;
+    fprintf(fp, "P6\n%d %d\n255\n", WIDTH, HEIGHT);
+    for (float value : rgb) fputc((int)fminf(fmaxf(value + 0.5f, 0.0f), 255.0f), fp);
+    fclose(fp);
+}
+
+// Sombras a partir dos acertos de 'base', com o cone do pixel no acerto abrindo 'spread'
+// dali em diante: fração na sombra e passos/leituras por raio
+static void _shadows(Svo_Map *map, const Render *base, float pixel_angle, float spread, std::vector<bool> *shadow, double *steps, double *fetches) {
+    shadow->assign(WIDTH * HEIGHT, false);
+    Ray_Stats stats = {0, 0};
+    size_t rays = 0;
+    for (int pixel = 0; pixel < WIDTH * HEIGHT; pixel++) {
+        if (!base->hits[pixel]) continue;
+        float width = pixel_angle * base->distances[pixel];
+        (*shadow)[pixel] = svo_map_ray_cast_cone(map, ray_create(base->points[pixel], SUN), width, spread, NULL, &stats);
+        rays++;
+    }
+    *steps = rays ? (double)stats.steps / rays : 0;
+    *fetches = rays ? (double)stats.fetches / rays : 0;
+}
+
+int main(int argc, char **argv) {
+    const char *out_dir = argc > 1 ? argv[1] : NULL;
+
+    double t0 = bench_now_ms();
+    Octree *tree = _terrain();
+    printf("terreno %dx%d montado em %.0f ms\n", SIDE, SIDE, bench_now_ms() - t0);
+
+    size_t filtered_texels = 0;
+    double filtered_ms;
+    Svo_Map *filtered = _encode(tree, &filtered_texels, &filtered_ms);
+    size_t filter_texels = _interior_nodes(tree) * 2;
+    octree_delete(tree);
+    if (!filtered) {
+        printf("falhou ao serializar a textura\n");
+        return 1;
+    }
+
+    bench_header("textura");
+    size_t plain_texels = filtered_texels - filter_texels;
+    printf("%zu texels (%.1f MB), %.0f ms | médias: %zu texels, +%.1f%% sobre a árvore sem elas\n",
+           filtered_texels, filtered_texels * 4 / 1048576.0, filtered_ms, filter_texels,
+           100.0 * ((double)filtered_texels / plain_texels - 1.0));
+
+    View view;
+    // De um canto, na diagonal: os acertos vão até uns 700 voxels
+    view.eye = vec3_float(4.0f, 110.0f, 4.0f);
+    view.forward = vec3_normalize(vec3_float(1.0f, -0.2f, 1.0f));
+    view.right = vec3_normalize(vec3_cross(view.forward, vec3_float(0, 1, 0)));
+    view.up = vec3_cross(view.right, view.forward);
+    view.pixel_angle = 2.0f * tanf(FOV_DEGREES * 0.5f * (float)M_PI / 180.0f) / HEIGHT;
+
+    // Sem cone a descida ignora as médias e vai até 1³
+    Render full;
+    _render(filtered, &view, 0.0f, &full);
+    std::vector<float> reference;
+    _reference(filtered, &view, &reference);
+
+    // Cones mais largos que o pixel: o mesmo corte de uma resolução menor ou de um raio
+    // secundário
+    static const float SCALES[] = {1.0f, SECONDARY_CONE_SCALE, 16.0f};
+    double mean, changed;
+    bench_header("raios da câmera (por raio; erro médio 0-255 contra a referência)");
+    printf("%-24s | %8s | %8s | %9s | %18s | %s\n", "descida", "passos", "leituras", "ms", "contra referência", "contra 1³");
+    _difference(full.rgb, reference, &mean, &changed);
+    printf("%-24s | %8.1f | %8.1f | %9.1f | %6.2f (%5.1f%% px) |\n", "até 1³", full.steps, full.fetches, full.ms, mean, changed);
+    Render pixel_cone;
+    for (float scale : SCALES) {
+        Render cone;
+        _render(filtered, &view, view.pixel_angle * scale, &cone);
+        if (scale == 1.0f) pixel_cone = cone;
+        char name[32];
+        snprintf(name, sizeof(name), "cone de %g pixel(s)", scale);
+        _difference(cone.rgb, reference, &mean, &changed);
+        printf("%-24s | %8.1f | %8.1f | %9.1f | %6.2f (%5.1f%% px) |", name, cone.steps, cone.fetches, cone.ms, mean, changed);
+        _difference(cone.rgb, full.rgb, &mean, &changed);
+        printf(" %6.2f (%5.1f%% px)\n", mean, changed);
+        if (out_dir) _write_ppm(std::string(out_dir) + "/prefilter_cone" + std::to_string((int)scale) + ".ppm", cone.rgb);
+    }
+
+    // Os raios de sombra saem dos acertos do cone de 1 pixel, com a largura dele ali, e
+    // abrem 'scale' pixels por voxel dali em diante (como no shader)
+    bench_header("sombras (a partir dos acertos do cone de 1 pixel)");
+    std::vector<bool> exact;
+    double steps, fetches;
+    _shadows(filtered, &pixel_cone, 0.0f, 0.0f, &exact, &steps, &fetches);
+    printf("%-24s | %8s | %8s | %s\n", "descida", "passos", "leituras", "sombras diferentes");
+    printf("%-24s | %8.1f | %8.1f |\n", "até 1³", steps, fetches);
+    for (float scale : SCALES) {
+        std::vector<bool> shadow;
+        _shadows(filtered, &pixel_cone, view.pixel_angle, view.pixel_angle * scale, &shadow, &steps, &fetches);
+        size_t differ = 0, lit = 0;
+        for (int pixel = 0; pixel < WIDTH * HEIGHT; pixel++) {
+            if (!pixel_cone.hits[pixel]) continue;
+            lit++;
+            differ += shadow[pixel] != exact[pixel];
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "cone de %g pixel(s)", scale);
+        printf("%-24s | %8.1f | %8.1f | %.2f%%\n", name, steps, fetches, lit ? 100.0 * differ / lit : 0.0);
+    }
+
+    if (out_dir) {
+        _write_ppm(std::string(out_dir) + "/prefilter_full.ppm", full.rgb);
+        _write_ppm(std::string(out_dir) + "/prefilter_reference.ppm", reference);
+        printf("\nimagens em %s/prefilter_*.ppm\n", out_dir);
+    }
+
+    svo_map_delete(filtered);
+    return 0;
+}
@@ -0,0 +1,217 @@
+// Compara a octree com o grid esparso estilo VDB (raiz hash + nós 32³/16³ + folhas 8³):
+// acesso aleatório, acesso coerente (varredura em ordem, com e sem accessor), construção,
+// memória e raios. A cena "ilhas" espalha modelos muito além dos limites da octree.
+//
+// Uso: bench_sparse [arquivo.vox ...]   (padrão: maps/dragon.vox e maps/nature.vox)
+
+#include <bench.hpp>
+#include <octree.hpp>
+#include <sparseGrid.hpp>
+#include <voxReader.hpp>
+#include <vector>
+#include <math.h>
+#include <string.h>
+
+static void _shell_scene(int n, IVector3 offset, std::vector<Voxel_Object> *out) {
+    for (int z = 0; z < n; z++)
+    for (int y = 0; y < n; y++)
+    for (int x = 0; x < n; x++) {
+        float dx = x - n * 0.5f + 0.5f, dy = y - n * 0.5f + 0.5f, dz = z - n * 0.5f + 0.5f;
+        if (fabsf(sqrtf(dx * dx + dy * dy + dz * dz) - n * 0.45f) >= 0.75f) continue;
+        IVector3 c = {{offset.x + x - n / 2, offset.y + y - n / 2, offset.z + z - n / 2}};
+        out->push_back(VoxelObjCreate(voxels[VOX_STONE], voxelColors[(x / 4 + y / 4 + z / 4) % 4], c));
+    }
+}
+
+static void _terrain_scene(int n, std::vector<Voxel_Object> *out) {
+    for (int z = 0; z < n; z++)
+    for (int x = 0; x < n; x++) {
+        int h = (int)(24.0f + 12.0f * sinf(x * 0.05f) * cosf(z * 0.07f) + 6.0f * sinf((x + z) * 0.13f));
+        for (int y = h - 3; y <= h; y++) {
+            Voxel_Type type = y == h ? VOX_GRASS : VOX_DIRT;
+            out->push_back(VoxelObjCreate(voxels[type], voxelColors[type], {{x - n / 2, y, z - n / 2}}));
+        }
+    }
+}
+
+// Ilhas de 64³ a até 1 milhão de voxels da origem (fora de qualquer octree de limites fixos)
+static void _islands_scene(std::vector<Voxel_Object> *out) {
+    Bench_Rng rng = {77};
+    for (int i = 0; i < 16; i++) {
+        IVector3 at = {{bench_rand_range(&rng, -1000000, 1000000), bench_rand_range(&rng, -2000, 2000), bench_rand_range(&rng, -1000000, 1000000)}};
+        _shell_scene(64, at, out);
+    }
+}
+
+typedef struct {
+    size_t memory;
+    double build_ms, random_ns, coherent_ns, accessor_ns, ray_ns;
+    int found;
+} Grid_Result;
+
+static void _print_row(const char *name, size_t voxel_count, const Grid_Result *oct, const Grid_Result *sp) {
+    if (oct) {
+        printf("%-10s %8zu | %9.1f %8.1f %8.1f %8.1f %8.0f |",
+               name, voxel_count, oct->memory / 1024.0, oct->build_ms, oct->random_ns, oct->coherent_ns, oct->ray_ns);
+    } else {
+        printf("%-10s %8zu | %9s %8s %8s %8s %8s |", name, voxel_count, "-", "-", "-", "-", "-");
+    }
+    printf(" %9.1f %8.1f %8.1f %8.1f %8.1f %8.0f\n",
+           sp->memory / 1024.0, sp->build_ms, sp->random_ns, sp->coherent_ns, sp->accessor_ns, sp->ray_ns);
+}
+
+static void _run_scene(const char *name, const std::vector<Voxel_Object> &scene) {
+    const int RANDOM_QUERIES = 200000;
+    const int RAYS = 20000;
+    const int SWEEP_MAX = 128; // lado máximo da varredura coerente
+
+    IVector3 vmin = scene[0].coord, vmax = scene[0].coord;
+    for (const Voxel_Object &v : scene) {
+        vmin = ivec3_min(vmin, v.coord);
+        vmax = ivec3_max(vmax, v.coord);
+    }
+    bool octree_fits = vmin.x >= BENCH_WORLD_MIN.x && vmin.y >= BENCH_WORLD_MIN.y && vmin.z >= BENCH_WORLD_MIN.z
+                    && vmax.x < BENCH_WORLD_MAX.x && vmax.y < BENCH_WORLD_MAX.y && vmax.z < BENCH_WORLD_MAX.z;
+
+    // Aleatório: metade em voxels existentes, metade em qualquer lugar da caixa
+    Bench_Rng rng = {99};
+    std::vector<IVector3> queries(RANDOM_QUERIES);
+    for (int i = 0; i < RANDOM_QUERIES; i++) {
+        queries[i] = i % 2 ? scene[bench_rand(&rng) % scene.size()].coord
+                           : IVector3{{bench_rand_range(&rng, vmin.x, vmax.x + 1), bench_rand_range(&rng, vmin.y, vmax.y + 1), bench_rand_range(&rng, vmin.z, vmax.z + 1)}};
+    }
+
+    // Coerente: varredura x-mais-rápido de um cubo em volta do primeiro voxel
+    IVector3 sweep_min = ivec3_scalar_sub(scene[scene.size() / 2].coord, SWEEP_MAX / 2);
+    const size_t sweep_cells = (size_t)SWEEP_MAX * SWEEP_MAX * SWEEP_MAX;
+
+    Vector3 center = vec3_scalar_mul(vec3_ivec3(ivec3_add(scene[0].coord, scene[0].coord)), 0.5f);
+    std::vector<Ray> rays(RAYS);
+    for (Ray &r : rays) {
+        const Voxel_Object &target = scene[bench_rand(&rng) % scene.size()];
+        center = vec3_ivec3(target.coord);
+        r = bench_random_ray(&rng, center, 96.0f);
+    }
+
+    Grid_Result oct = {0}, sp = {0};
+    volatile int sink = 0;
+
+    // --- Octree ---
+    if (octree_fits) {
+        double t0 = bench_now_ms();
+        Octree *tree = octree_create(NULL, BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+        for (const Voxel_Object &v : scene) octree_insert(tree, v);
+        octree_compact(tree, 0);
+        oct.build_ms = bench_now_ms() - t0;
+        oct.memory = octree_memory_usage(tree);
+
+        t0 = bench_now_ms();
+        for (const IVector3 &q : queries) sink += octree_find(tree, q).coord.y;
+        oct.random_ns = (bench_now_ms() - t0) * 1e6 / RANDOM_QUERIES;
+
+        t0 = bench_now_ms();
+        for (int z = 0; z < SWEEP_MAX; z++)
+        for (int y = 0; y < SWEEP_MAX; y++)
+        for (int x = 0; x < SWEEP_MAX; x++) {
+            sink += octree_find(tree, {{sweep_min.x + x, sweep_min.y + y, sweep_min.z + z}}).coord.y;
+        }
+        oct.coherent_ns = (bench_now_ms() - t0) * 1e6 / sweep_cells;
+
+        Vector3 wmin = vec3_ivec3(BENCH_WORLD_MIN), wmax = vec3_ivec3(BENCH_WORLD_MAX);
+        t0 = bench_now_ms();
+        for (const Ray &r : rays) sink += octree_ray_cast(tree, r, wmin, wmax) != NULL;
+        oct.ray_ns = (bench_now_ms() - t0) * 1e6 / RAYS;
+        octree_delete(tree);
+    }
+
+    // --- Grid esparso ---
+    double t0 = bench_now_ms();
+    Sparse_Grid *grid = sparse_grid_create();
+    Sparse_Accessor acc = sparse_grid_accessor(grid);
+    for (const Voxel_Object &v : scene) sparse_accessor_insert(&acc, v);
+    sp.build_ms = bench_now_ms() - t0;
+    sp.memory = sparse_grid_memory_usage(grid);
+
+    t0 = bench_now_ms();
+    for (const IVector3 &q : queries) sink += sparse_grid_find(grid, q).coord.y;
+    sp.random_ns = (bench_now_ms() - t0) * 1e6 / RANDOM_QUERIES;
+
+    t0 = bench_now_ms();
+    for (int z = 0; z < SWEEP_MAX; z++)
+    for (int y = 0; y < SWEEP_MAX; y++)
+    for (int x = 0; x < SWEEP_MAX; x++) {
+        sink += sparse_grid_find(grid, {{sweep_min.x + x, sweep_min.y + y, sweep_min.z + z}}).coord.y;
+    }
+    sp.coherent_ns = (bench_now_ms() - t0) * 1e6 / sweep_cells;
+
+    acc = sparse_grid_accessor(grid);
+    t0 = bench_now_ms();
+    for (int z = 0; z < SWEEP_MAX; z++)
+    for (int y = 0; y < SWEEP_MAX; y++)
+    for (int x = 0; x < SWEEP_MAX; x++) {
+        sink += sparse_accessor_find(&acc, {{sweep_min.x + x, sweep_min.y + y, sweep_min.z + z}}).coord.y;
+    }
+    sp.accessor_ns = (bench_now_ms() - t0) * 1e6 / sweep_cells;
+
+    t0 = bench_now_ms();
+    for (const Ray &r : rays) sink += sparse_grid_ray_cast(grid, r, NULL, NULL);
+    sp.ray_ns = (bench_now_ms() - t0) * 1e6 / RAYS;
+
+    // Todos os voxels precisam voltar do grid
+    size_t missing = 0;
+    for (const Voxel_Object &v : scene) {
+        Voxel_Object found = sparse_grid_find(grid, v.coord);
+        if (!ivec3_equal_vec(found.coord, v.coord) || found.color != v.color) missing++;
+    }
+    if (missing) printf("ERRO: %zu voxels não encontrados no grid esparso\n", missing);
+
+    sparse_grid_delete(grid);
+    (void)sink;
+    _print_row(name, scene.size(), octree_fits ? &oct : NULL, &sp);
+}
+
+static void _collect(void *user, Voxel_Object voxel) {
+    ((std::vector<Voxel_Object>*)user)->push_back(voxel);
+}
+
+int main(int argc, char **argv) {
+    bench_header("octree vs grid esparso (VDB 5-4-3)");
+    printf("%-10s %8s | %9s %8s %8s %8s %8s | %9s %8s %8s %8s %8s %8s\n",
+           "cena", "voxels",
+           "oct KB", "build ms", "aleat ns", "coer ns", "raio ns",
+           "vdb KB", "build ms", "aleat ns", "coer ns", "acess ns", "raio ns");
+
+    std::vector<Voxel_Object> scene;
+    _shell_scene(256, {{0, 0, 0}}, &scene);
+    _run_scene("shell256", scene);
+
+    scene.clear();
+    _terrain_scene(512, &scene);
+    _run_scene("terrain512", scene);
+
+    scene.clear();
+    _islands_scene(&scene);
+    _run_scene("ilhas", scene);
+
+    const char *default_maps[] = {"maps/dragon.vox", "maps/nature.vox"};
+    int count = argc > 1 ? argc - 1 : 2;
+    for (int i = 0; i < count; i++) {
+        const char *path = argc > 1 ? argv[i + 1] : default_maps[i];
+        Sparse_Grid *tmp = sparse_grid_create();
+        if (!load_vox_file(path, tmp, 0, 0, 0)) {
+            sparse_grid_delete(tmp);
+            continue;
+        }
+        scene.clear();
+        sparse_grid_for_each(tmp, _collect, &scene);
+        sparse_grid_delete(tmp);
+        if (scene.empty()) continue;
+
+        const char *name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+        _run_scene(name, scene);
+    }
+
+    printf("\naleat = busca em coordenadas aleatórias; coer = varredura 128³ em ordem;\n"
+           "acess = a mesma varredura reaproveitando um Sparse_Accessor\n");
+    return 0;
+}
@@ -0,0 +1,244 @@
+// Mundo maior que a memória: um terreno sintético de 16k³ células gravado direto num
+// chunk_store (chunkStore.hpp) e aberto com world_open_chunks sob um orçamento pequeno.
+// A câmera voa um caminho fixo a ~600 células/s em quadros de 16,7 ms; cada quadro pagina,
+// pede as leituras e regrava a textura. Compara a leitura adiantada pela velocidade da
+// câmera (world_stream_chunks) com pedir só a janela residente: tempo de quadro, chunks da
+// janela que ainda estavam no disco (aparecem vazios) e memória. Antes de cada voo as
+// páginas do arquivo são descartadas do cache (posix_fadvise).
+//
+// Uso: bench_stream
+
+#include "bench.hpp"
+#include <world.hpp>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <math.h>
+#include <stdio.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char *STORE_PATH = "bench_stream_world.chunks";
+static const int WORLD_HALF = 8192;
+static const IVector3 WORLD_MIN = {{-WORLD_HALF, -WORLD_HALF, -WORLD_HALF}};
+static const IVector3 WORLD_MAX = {{WORLD_HALF, WORLD_HALF, WORLD_HALF}};
+static const size_t BUDGET = 64u << 20;
+static const float SPEED = 600.0f;         //células por segundo
+static const double FRAME_MS = 1000.0 / 60.0;
+static const int BLOCK = 16;               //lado dos platôs do terreno
+
+static void _drop_cache(const char *path) {
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+#else
+    (void)path;
+#endif
+}
+
+static uint32_t _hash(int x, int z) {
+    uint32_t h = (uint32_t)x * 73856093u ^ (uint32_t)z * 19349663u;
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    return h ^ (h >> 15);
+}
+
+// Altura de um platô de BLOCK² colunas: ondulações suaves mais ruído, entre 2 e 63
+static int _height(int bx, int bz) {
+    float wave = 28.0f + 14.0f * sinf(bx * 0.045f) + 10.0f * cosf(bz * 0.038f);
+    return std::min(63, std::max(2, (int)wave + (int)(_hash(bx, bz) % 12)));
+}
+
+// Torres raras que sobem até a camada de chunks de cima
+static bool _tower(int bx, int bz) {
+    return _hash(bz, bx) % 97 == 0;
+}
+
+static bool _write_chunk(Chunk_Store *store, Octree *tree, IVector3 coord) {
+    octree_compact(tree, 0);
+    size_t size = 0;
+    uint8_t *image = svo_file_encode(tree, &size);
+    bool ok = image && chunk_store_write(store, coord, image, size);
+    free(image);
+    octree_delete(tree);
+    return ok;
+}
+
+// Cada coluna de chunks: pedra maciça em y = -1, platôs em y = 0 e as torres em y = 1
+static size_t _generate(size_t *bytes) {
+    Chunk_Store *store = chunk_store_create(STORE_PATH, WORLD_MIN, WORLD_MAX, CHUNK_LOG2, NULL);
+    if (!store) return 0;
+    Voxel_Object stone = VoxelObjCreate(voxels[VOX_STONE], make_color_rgba(120, 120, 125, 255), {{0, 0, 0}});
+    Voxel_Object grass = VoxelObjCreate(voxels[VOX_GRASS], make_color_rgba(70, 150, 60, 255), {{0, 0, 0}});
+    Voxel_Object wood = VoxelObjCreate(voxels[VOX_WOOD], make_color_rgba(140, 90, 50, 255), {{0, 0, 0}});
+    size_t chunks = 0;
+    int side = 2 * WORLD_HALF / CHUNK_SIZE, blocks = CHUNK_SIZE / BLOCK;
+    for (int cz = -side / 2; cz < side / 2; cz++)
+    for (int cx = -side / 2; cx < side / 2; cx++) {
+        IVector3 base = {{cx * CHUNK_SIZE, 0, cz * CHUNK_SIZE}};
+        Octree *rock = octree_create(NULL, {{base.x, -CHUNK_SIZE, base.z}}, {{base.x + CHUNK_SIZE, 0, base.z + CHUNK_SIZE}});
+        octree_fill(rock, {{base.x, -CHUNK_SIZE, base.z}}, {{base.x + CHUNK_SIZE - 1, -1, base.z + CHUNK_SIZE - 1}}, stone);
+        chunks += _write_chunk(store, rock, {{cx, -1, cz}});
+
+        Octree *ground = octree_create(NULL, base, ivec3_scalar_add(base, CHUNK_SIZE));
+        Octree *sky = NULL;
+        for (int bz = 0; bz < blocks; bz++)
+        for (int bx = 0; bx < blocks; bx++) {
+            int gx = cx * blocks + bx, gz = cz * blocks + bz;
+            IVector3 lo = {{base.x + bx * BLOCK, 0, base.z + bz * BLOCK}};
+            IVector3 hi = {{lo.x + BLOCK - 1, _height(gx, gz) - 1, lo.z + BLOCK - 1}};
+            octree_fill(ground, lo, {{hi.x, hi.y - 1, hi.z}}, stone);
+            octree_fill(ground, {{lo.x, hi.y, lo.z}}, hi, grass);
+            if (!_tower(gx, gz)) continue;
+            IVector3 t_lo = {{lo.x + 4, hi.y + 1, lo.z + 4}}, t_hi = {{lo.x + 11, CHUNK_SIZE - 1, lo.z + 11}};
+            if (t_lo.y <= t_hi.y) octree_fill(ground, t_lo, t_hi, wood);
+            if (!sky) sky = octree_create(NULL, {{base.x, CHUNK_SIZE, base.z}}, {{base.x + CHUNK_SIZE, 2 * CHUNK_SIZE, base.z + CHUNK_SIZE}});
+            octree_fill(sky, {{t_lo.x, CHUNK_SIZE, t_lo.z}}, {{t_hi.x, CHUNK_SIZE + 40, t_hi.z}}, wood);
+        }
+        chunks += _write_chunk(store, ground, {{cx, 0, cz}});
+        if (sky) chunks += _write_chunk(store, sky, {{cx, 1, cz}});
+    }
+    chunk_store_flush(store);
+    *bytes = chunk_store_stats(store).write_bytes;
+    chunk_store_close(store);
+    return chunks;
+}
+
+// Chunks da janela residente ainda sem octree (no disco ou esperando a vez de montar):
+// a GPU os desenha vazios
+static int _missing(World *world, IVector3 eye) {
+    Chunk_Grid *grid = world->chunks;
+    IVector3 center = {{eye.x >> CHUNK_LOG2, eye.y >> CHUNK_LOG2, eye.z >> CHUNK_LOG2}};
+    int missing = 0;
+    for (int z = center.z - CHUNK_RESIDENT_RADIUS; z <= center.z + CHUNK_RESIDENT_RADIUS; z++)
+    for (int y = center.y - CHUNK_RESIDENT_RADIUS; y <= center.y + CHUNK_RESIDENT_RADIUS; y++)
+    for (int x = center.x - CHUNK_RESIDENT_RADIUS; x <= center.x + CHUNK_RESIDENT_RADIUS; x++) {
+        Chunk *chunk = chunk_grid_get(grid, {{x, y, z}});
+        missing += chunk && !chunk->tree && (chunk->packed || chunk->stored);
+    }
+    return missing;
+}
+
+// Caminho fixo: uma diagonal longa, uma volta e uma reta de volta, a 40 células do chão
+static const Vector3 PATH[] = {
+    {{-6000.0f, 40.0f, -6000.0f}}, {{2000.0f, 40.0f, 2000.0f}}, {{2000.0f, 40.0f, 5000.0f}},
+    {{-3000.0f, 40.0f, 5000.0f}}, {{-3000.0f, 40.0f, -1000.0f}},
+};
+static const int PATH_POINTS = sizeof(PATH) / sizeof(PATH[0]);
+
+typedef struct {
+    std::vector<double> frame_ms;
+    size_t missing_frames, missing_chunks;
+    size_t peak_bytes;
+    int rebuilds;
+    Chunk_Store_Stats store;
+} Flight;
+
+static bool _fly(bool prefetch, Flight *flight) {
+    _drop_cache(STORE_PATH);
+    World *world = world_create(WORLD_MIN, WORLD_MAX);
+    if (!world || !world_open_chunks(world, STORE_PATH, BUDGET)) {
+        world_delete(world);
+        return false;
+    }
+    // Partida: a janela do primeiro ponto é lida inteira antes de começar a contar
+    Vector3 position = PATH[0];
+    IVector3 eye = {{(int)floorf(position.x), (int)floorf(position.y), (int)floorf(position.z)}};
+    world_page_chunks(world, eye, CHUNK_RESIDENT_RADIUS);
+    while (_missing(world, eye) > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        world_page_chunks(world, eye, CHUNK_RESIDENT_RADIUS);
+    }
+    size_t size = 0;
+    uint8_t *texture = world_texture(world, &size, 0);
+    size_t capacity = size / 4;
+
+    *flight = Flight();
+    double step = SPEED * FRAME_MS / 1000.0;
+    double next = bench_now_ms();
+    for (int leg = 0; leg + 1 < PATH_POINTS; leg++) {
+        Vector3 from = PATH[leg], to = PATH[leg + 1];
+        Vector3 delta = vec3_sub(to, from);
+        float length = vec3_len(delta);
+        Vector3 velocity = vec3_scalar_mul(delta, SPEED / length);
+        for (double s = 0.0; s < length; s += step) {
+            position = vec3_add(from, vec3_scalar_mul(delta, (float)(s / length)));
+            eye = {{(int)floorf(position.x), (int)floorf(position.y), (int)floorf(position.z)}};
+
+            double f0 = bench_now_ms();
+            world_page_chunks(world, eye, CHUNK_RESIDENT_RADIUS);
+            if (prefetch) world_stream_chunks(world, position, velocity);
+            if (!world_sync_chunks(world, texture, capacity, NULL, NULL)) {
+                free(texture);
+                texture = world_texture(world, &size, 0);
+                capacity = size / 4;
+                flight->rebuilds++;
+            }
+            if (world_update_chunks(world)) free(world_chunk_buffer(world, &size));
+            flight->frame_ms.push_back(bench_now_ms() - f0);
+
+            int missing = _missing(world, eye);
+            flight->missing_frames += missing > 0;
+            flight->missing_chunks += missing;
+            if (flight->frame_ms.size() % 30 == 0) flight->peak_bytes = std::max(flight->peak_bytes, world_memory_usage(world));
+
+            // Quadros de 16,7 ms: a thread de carga trabalha no resto do quadro
+            next += FRAME_MS;
+            double wait = next - bench_now_ms();
+            if (wait > 0.0) std::this_thread::sleep_for(std::chrono::microseconds((long)(wait * 1000.0)));
+        }
+    }
+    flight->peak_bytes = std::max(flight->peak_bytes, world_memory_usage(world));
+    flight->store = chunk_store_stats(world->chunks->store);
+    free(texture);
+    world_delete(world);
+    return true;
+}
+
+static double _percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, (size_t)(p * (values.size() - 1) + 0.5))];
+}
+
+int main(void) {
+    double t0 = bench_now_ms();
+    size_t bytes = 0;
+    size_t chunks = _generate(&bytes);
+    if (chunks == 0) {
+        printf("não deu para gravar %s\n", STORE_PATH);
+        return 1;
+    }
+    printf("mundo de %d³ células: %zu chunks, %.1f MB no disco, gerado em %.1f s\n", 2 * WORLD_HALF, chunks,
+           bytes / 1048576.0, (bench_now_ms() - t0) / 1000.0);
+    printf("voo a %.0f células/s, quadros de %.1f ms, orçamento de %zu MB\n\n", SPEED, FRAME_MS, BUDGET >> 20);
+
+    printf("%-16s | %8s | %8s | %8s | %14s | %10s | %s\n", "", "p50 ms", "p99 ms", "pior ms", "quadros c/ falta",
+           "pico MB", "leituras (média / pior ms)");
+    const bool modes[] = {true, false};
+    Flight flight;
+    for (bool prefetch : modes) {
+        if (!_fly(prefetch, &flight)) {
+            printf("não deu para abrir %s\n", STORE_PATH);
+            remove(STORE_PATH);
+            return 1;
+        }
+        char missing[32];
+        snprintf(missing, sizeof(missing), "%zu (%zu chunks)", flight.missing_frames, flight.missing_chunks);
+        printf("%-16s | %8.2f | %8.2f | %8.2f | %14s | %10.1f | %zu (%.2f / %.1f)%s\n",
+               prefetch ? "pela velocidade" : "só a janela", _percentile(flight.frame_ms, 0.5),
+               _percentile(flight.frame_ms, 0.99), _percentile(flight.frame_ms, 1.0), missing,
+               flight.peak_bytes / 1048576.0, flight.store.reads,
+               flight.store.reads ? flight.store.read_ms / flight.store.reads : 0.0, flight.store.read_ms_max,
+               flight.rebuilds ? ", textura refeita" : "");
+    }
+    printf("\n%zu quadros por voo; quadros c/ falta = com algum chunk da janela ainda sem octree (desenhado vazio)\n",
+           flight.frame_ms.size());
+    remove(STORE_PATH);
+    return 0;
+}
@@ -0,0 +1,254 @@
+// Cache do sol por face (sunCache.hpp) numa cidade sintética: um chão de 400² com prédios
+// maciços de alturas variadas fazendo sombra na rua e uns nos outros. Mede
+//  - montagem: todas as faces do zero com uma thread e com todas, blocos, memória e
+//    tamanho do buffer da GPU;
+//  - edições: voxels invalidados (a caixa com folga mais a sombra dela) e o tempo para
+//    recalculá-los, em prédios sorteados: bloco no telhado e tirá-lo, cubo 4³ flutuando na
+//    rua e tirá-lo, buraco no telhado e tampá-lo;
+//  - sol girando: quadros até o cache inteiro valer de novo com 2 ms por quadro;
+//  - consulta contra raio de sombra: ns por face no cache e µs por raio na CPU, e as faces
+//    de cima conferidas contra raios diretos;
+//  - depois das edições e depois do sol girar, o cache conferido face por face contra o
+//    refeito do zero.
+//
+// Uso: bench_sun [prédios por lado]   (padrão: 12)
+
+#include "bench.hpp"
+#include <world.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+static const int TOWER = 12;       //lado do prédio
+static const int STREET = 20;      //entre dois prédios
+static const int GROUND = 4;       //espessura do chão (y de -GROUND a -1)
+static const int EDITS = 32;       //prédios sorteados para cada edição
+static const double FRAME_BUDGET_MS = 2.0;
+static const int RAY_SAMPLES = 1 << 14;
+
+typedef struct _city {
+    int side;
+    IVector3 min, max;
+    std::vector<int> heights;
+} City;
+
+static IVector3 _tower_min(const City *city, int i, int j) {
+    return {{city->min.x + STREET + i * (TOWER + STREET), 0, city->min.z + STREET + j * (TOWER + STREET)}};
+}
+
+static Voxel_Object _stone(IVector3 at) {
+    return VoxelObjCreate(voxels[VOX_STONE], make_color_rgba(130, 130, 135, 255), at);
+}
+
+static void _build(World *world, City *city) {
+    int extent = city->side * (TOWER + STREET) + STREET;
+    city->min = {{-extent / 2, -GROUND, -extent / 2}};
+    city->max = {{city->min.x + extent - 1, 64, city->min.z + extent - 1}};
+    world_fill(world, city->min, {{city->max.x, -1, city->max.z}},
+               VoxelObjCreate(voxels[VOX_DIRT], make_color_rgba(100, 80, 60, 255), city->min));
+
+    Bench_Rng rng = {0x5EEDull};
+    for (int i = 0; i < city->side; i++)
+    for (int j = 0; j < city->side; j++) {
+        int height = bench_rand_range(&rng, 8, 48);
+        city->heights.push_back(height);
+        IVector3 min = _tower_min(city, i, j);
+        world_fill(world, min, {{min.x + TOWER - 1, height - 1, min.z + TOWER - 1}}, _stone(min));
+    }
+}
+
+typedef struct _face_bits {
+    IVector3 coord;
+    uint16_t bits;
+} Face_Bits;
+
+// Voxels calculados de todos os blocos
+static std::vector<Face_Bits> _computed(const Sun_Cache *cache) {
+    std::vector<Face_Bits> cells;
+    for (size_t i = 0; i < cache->capacity; i++) {
+        const Sun_Brick *brick = cache->table[i];
+        if (!brick) continue;
+        for (int c = 0; c < SUN_BRICK_CELLS; c++) {
+            if (!brick->faces[c]) continue;
+            IVector3 at = {{c % SUN_BRICK_DIM, (c / SUN_BRICK_DIM) % SUN_BRICK_DIM, c / (SUN_BRICK_DIM * SUN_BRICK_DIM)}};
+            cells.push_back({ivec3_add(brick->origin, at), brick->faces[c]});
+        }
+    }
+    return cells;
+}
+
+// Faces de 'from' que 'to' responde diferente; só contam as faces à mostra (as cobertas por
+// um vizinho opaco tanto faz: o shader nunca chega nelas)
+static size_t _face_differences(World *world, const Sun_Cache *from, const Sun_Cache *to) {
+    size_t differences = 0;
+    for (const Face_Bits &cell : _computed(from)) {
+        for (int face = 0; face < 6; face++) {
+            IVector3 n = {{face == 0 ? 1 : face == 1 ? -1 : 0, face == 2 ? 1 : face == 3 ? -1 : 0, face == 4 ? 1 : face == 5 ? -1 : 0}};
+            Voxel_Object neighbor = world_find(world, ivec3_add(cell.coord, n));
+            if (neighbor.coord.y != _invalid_voxel().coord.y && get_alpha_rgba(neighbor.color) == 255) continue;
+            differences += sun_cache_lookup(from, cell.coord, face) != sun_cache_lookup(to, cell.coord, face);
+        }
+    }
+    return differences;
+}
+
+// Refaz o cache do zero e conta as faces com resposta diferente da editada
+static size_t _differences_from_rebuild(World *world) {
+    Sun_Cache *edited = world->sun;
+    world->sun = NULL;
+    world->sun_stale = true;
+    world_update_sun(world, 0.0);
+    size_t differences = _face_differences(world, edited, world->sun) + _face_differences(world, world->sun, edited);
+    sun_cache_delete(edited);
+    return differences;
+}
+
+typedef struct _edit_stats {
+    double total_ms, max_ms;
+    double invalidated;
+    int count;
+} Edit_Stats;
+
+static void _recompute(World *world, Edit_Stats *stats) {
+    stats->invalidated += (double)world->sun->dirty;
+    double t0 = bench_now_ms();
+    world_update_sun(world, 0.0);
+    double ms = bench_now_ms() - t0;
+    stats->total_ms += ms;
+    if (ms > stats->max_ms) stats->max_ms = ms;
+    stats->count++;
+}
+
+static void _report(const char *label, const Edit_Stats *stats) {
+    printf("  %-28s %10.0f %8.3f %8.3f\n", label, stats->invalidated / stats->count, stats->total_ms / stats->count, stats->max_ms);
+}
+
+static double _full_build(World *world, int threads) {
+    world->threads = threads;
+    world->sun_stale = true;
+    double t0 = bench_now_ms();
+    world_update_sun(world, 0.0);
+    return bench_now_ms() - t0;
+}
+
+int main(int argc, char **argv) {
+    City city = {argc > 1 ? atoi(argv[1]) : 12, ivec3_zero(), ivec3_zero(), {}};
+    if (city.side < 1) city.side = 12;
+
+    World *world = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    double t0 = bench_now_ms();
+    _build(world, &city);
+    octree_compact(world->octree, 0);
+    Vector3 sun = vec3_normalize(vec3_float(0.3481553f, 0.870388f, 0.3481553f));
+    world_set_sun(world, sun);
+    printf("cidade %dx%d voxels, %d prédios (montada em %.0f ms, octree %.1f MB)\n",
+           city.max.x - city.min.x + 1, city.max.z - city.min.z + 1, city.side * city.side,
+           bench_now_ms() - t0, world_memory_usage(world) / 1048576.0);
+
+    // --- Montagem ---
+    double one_ms = _full_build(world, 1);
+    double all_ms = _full_build(world, 0);
+    size_t buffer_size = 0;
+    int32_t *buffer = world_sun_buffer(world, &buffer_size);
+    free(buffer);
+    std::vector<Face_Bits> cells = _computed(world->sun);
+    printf("  cache inteiro: %.0f ms com 1 thread, %.0f ms com todas; %zu voxels em %zu blocos de %d³,\n"
+           "  %.1f MB (buffer da GPU %.1f MB)\n",
+           one_ms, all_ms, cells.size(), world->sun->count, SUN_BRICK_DIM,
+           sun_cache_memory_usage(world->sun) / 1048576.0, buffer_size / 1048576.0);
+
+    // --- Consulta contra raio de sombra, nas faces de cima que podem ver o sol ---
+    std::vector<IVector3> tops;
+    for (const Face_Bits &cell : cells) {
+        if (world_find(world, ivec3_add(cell.coord, {{0, 1, 0}})).coord.y == _invalid_voxel().coord.y) {
+            tops.push_back(cell.coord);
+        }
+    }
+    Bench_Rng rng = {0xC0FFEEull};
+    std::vector<IVector3> samples(RAY_SAMPLES);
+    for (IVector3 &s : samples) s = tops[bench_rand(&rng) % tops.size()];
+
+    t0 = bench_now_ms();
+    int lit = 0;
+    for (int r = 0; r < 64; r++)
+        for (const IVector3 &s : samples) lit += sun_cache_lookup(world->sun, s, 2);
+    double lookup_ns = (bench_now_ms() - t0) * 1e6 / (64.0 * RAY_SAMPLES);
+
+    t0 = bench_now_ms();
+    size_t disagree = 0, in_shadow = 0;
+    for (const IVector3 &s : samples) {
+        Ray ray = ray_create(vec3_float(s.x + 0.5f, s.y + 1.001f, s.z + 0.5f), sun);
+        bool blocked = world_ray_cast(world, ray, NULL);
+        in_shadow += blocked;
+        disagree += (sun_cache_lookup(world->sun, s, 2) == 1) == blocked;
+    }
+    double ray_us = (bench_now_ms() - t0) * 1e3 / RAY_SAMPLES;
+    printf("  consulta: %.1f ns por face, raio de sombra na CPU: %.2f us (%zu de %d faces de cima na sombra,\n"
+           "  %zu diferentes do raio direto)\n", lookup_ns, ray_us, in_shadow, RAY_SAMPLES, disagree);
+    (void)lit;
+
+    // --- Edições ---
+    printf("\nedições (%d prédios sorteados):  invalidados ms médio  ms máx\n", EDITS);
+    Edit_Stats stats[6] = {};
+    for (int e = 0; e < EDITS; e++) {
+        int i = bench_rand_range(&rng, 0, city.side), j = bench_rand_range(&rng, 0, city.side);
+        IVector3 tower = _tower_min(&city, i, j);
+        int height = city.heights[i * city.side + j];
+
+        IVector3 roof = {{tower.x + TOWER / 2, height, tower.z + TOWER / 2}};
+        world_insert(world, _stone(roof));
+        _recompute(world, &stats[0]);
+        world_remove(world, roof);
+        _recompute(world, &stats[1]);
+
+        IVector3 cube = {{tower.x + TOWER + STREET / 2 - 2, 10, tower.z}};
+        world_fill(world, cube, ivec3_scalar_add(cube, 3), _stone(cube));
+        _recompute(world, &stats[2]);
+        world_clear_region(world, cube, ivec3_scalar_add(cube, 3));
+        _recompute(world, &stats[3]);
+
+        IVector3 hole = {{roof.x, height - 1, roof.z}};
+        world_remove(world, hole);
+        _recompute(world, &stats[4]);
+        world_insert(world, _stone(hole));
+        _recompute(world, &stats[5]);
+    }
+    const char *labels[6] = {"bloco no telhado", "tirar o bloco", "cubo 4³ na rua", "tirar o cubo",
+                             "buraco no telhado", "tampar o buraco"};
+    for (int k = 0; k < 6; k++) _report(labels[k], &stats[k]);
+    t0 = bench_now_ms();
+    size_t differences = _differences_from_rebuild(world);
+    printf("  cache editado contra refeito do zero (%.0f ms): %zu faces diferentes\n", bench_now_ms() - t0, differences);
+
+    // --- Sol girando ---
+    printf("\nsol girando (%.0f ms por quadro):\n", FRAME_BUDGET_MS);
+    const float turns[3] = {0.01f, 0.2f, 1.0f};
+    for (float angle : turns) {
+        Vector3 turned = vec3_float(sun.x * cosf(angle) + sun.z * sinf(angle), sun.y, sun.z * cosf(angle) - sun.x * sinf(angle));
+        t0 = bench_now_ms();
+        world_set_sun(world, turned);
+        double invalidate_ms = bench_now_ms() - t0;
+        size_t pending = world->sun->dirty;
+        int frames = 0;
+        double worst = 0.0;
+        t0 = bench_now_ms();
+        while (world->sun->dirty) {
+            double f0 = bench_now_ms();
+            world_update_sun(world, FRAME_BUDGET_MS);
+            double ms = bench_now_ms() - f0;
+            if (ms > worst) worst = ms;
+            frames++;
+        }
+        printf("  %.2f rad: %zu voxels de volta ao raio de sombra em %.1f ms, %d quadros (%.0f ms no total,\n"
+               "  o mais longo %.2f ms)\n", angle, pending, invalidate_ms, frames, bench_now_ms() - t0, worst);
+        sun = turned;
+    }
+
+    t0 = bench_now_ms();
+    differences = _differences_from_rebuild(world);
+    printf("  cache girado contra refeito do zero (%.0f ms): %zu faces diferentes\n", bench_now_ms() - t0, differences);
+
+    world_delete(world);
+    return 0;
+}
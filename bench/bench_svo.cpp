@@ -0,0 +1,191 @@
+// Partida a frio: carregar o .vox (parse + montagem da árvore) e serializar a textura,
+// contra mapear o .svo nativo e entregar os texels direto para o upload. Os dois mundos
+// são conferidos com world_find em células sorteadas e com raios (o .svo é percorrido
+// mapeado, sem octree). Mede também a primeira edição, que monta a octree do arquivo.
+// Antes de cada abertura as páginas do .svo são descartadas do cache (posix_fadvise),
+// então "a frio" inclui a leitura do disco quando o sistema permite.
+//
+// Uso: bench_svo [arquivo.vox ...]   (padrão: maps/*.vox e um terreno sintético)
+
+#include "bench.hpp"
+#include <world.hpp>
+#include <voxReader.hpp>
+#include <svoFile.hpp>
+#include <string>
+#include <vector>
+#include <string.h>
+#include <math.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char *SVO_PATH = "bench_svo_world.svo";
+static const int TERRAIN_SIDE = 512;
+
+static void _drop_cache(const char *path) {
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+#else
+    (void)path;
+#endif
+}
+
+static bool _same(Voxel_Object a, Voxel_Object b) {
+    bool a_empty = a.coord.y == _invalid_voxel().coord.y, b_empty = b.coord.y == _invalid_voxel().coord.y;
+    if (a_empty || b_empty) return a_empty == b_empty;
+    return a.color == b.color && a.voxel.refraction == b.voxel.refraction
+        && a.voxel.illumination == b.voxel.illumination && a.voxel.k == b.voxel.k;
+}
+
+static void _box(void *user, Voxel_Object voxel) {
+    IVector3 *box = (IVector3*)user;
+    box[0] = ivec3_min(box[0], voxel.coord);
+    box[1] = ivec3_max(box[1], voxel.coord);
+}
+
+// Colinas com camadas de pedra e terra, e cavernas esparsas
+static World *_terrain(void) {
+    World *world = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    ColorRGBA stone = make_color_rgba(120, 120, 125, 255), dirt = make_color_rgba(110, 80, 50, 255);
+    ColorRGBA grass = make_color_rgba(70, 150, 60, 255);
+    for (int z = -TERRAIN_SIDE / 2; z < TERRAIN_SIDE / 2; z++)
+    for (int x = -TERRAIN_SIDE / 2; x < TERRAIN_SIDE / 2; x++) {
+        int height = (int)(24.0 + 14.0 * sin(x * 0.021) * cos(z * 0.017) + 6.0 * sin((x + z) * 0.07));
+        for (int y = 0; y < height; y++) {
+            if (y > 4 && y < height - 4 && ((x * 7 + y * 13 + z * 3) % 97) < 3) continue;
+            ColorRGBA color = y == height - 1 ? grass : (y > height - 5 ? dirt : stone);
+            world_insert(world, VoxelObjCreate(voxels[y == height - 1 ? VOX_GRASS : VOX_STONE], color, {{x, y, z}}));
+        }
+    }
+    world_compact(world, 0);
+    return world;
+}
+
+static void _run(const char *name, World *(*build)(const char*), const char *path) {
+    // Hoje: parse + árvore + serialização
+    double t0 = bench_now_ms();
+    World *world = build(path);
+    double build_ms = bench_now_ms() - t0;
+    if (!world) {
+        printf("%-22s | falhou ao carregar\n", name);
+        return;
+    }
+    t0 = bench_now_ms();
+    size_t bytes = 0;
+    uint8_t *texture = world_texture(world, &bytes, 0);
+    double serialize_ms = bench_now_ms() - t0;
+    free(texture);
+
+    t0 = bench_now_ms();
+    bool saved = world_save_svo(world, SVO_PATH);
+    double save_ms = bench_now_ms() - t0;
+    if (!saved) {
+        printf("%-22s | falhou ao gravar\n", name);
+        world_delete(world);
+        return;
+    }
+
+    // Nativo: mapear (com checksum) e entregar os texels; a cópia simula o upload
+    _drop_cache(SVO_PATH);
+    World *mapped = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    t0 = bench_now_ms();
+    bool loaded = world_load_svo(mapped, SVO_PATH);
+    size_t view_bytes = 0;
+    const uint8_t *view = world_texture_view(mapped, &view_bytes);
+    std::vector<uint8_t> upload(view_bytes);
+    if (view) memcpy(upload.data(), view, view_bytes);
+    double load_ms = bench_now_ms() - t0;
+
+    _drop_cache(SVO_PATH);
+    t0 = bench_now_ms();
+    Svo_Map *unverified = svo_map_open(SVO_PATH, false);
+    double open_ms = bench_now_ms() - t0;
+    svo_map_delete(unverified);
+
+    if (!loaded || !view) {
+        printf("%-22s | falhou ao mapear\n", name);
+        world_delete(world);
+        world_delete(mapped);
+        return;
+    }
+
+    // Conferência: células sorteadas na caixa dos voxels e raios através dela
+    IVector3 box[2] = {world->right_top_front, world->left_bot_back};
+    if (world->backend == WORLD_BACKEND_OCTREE) octree_for_each(world->octree, _box, box);
+    else if (world->backend == WORLD_BACKEND_DENSE) dense_grid_for_each(world->dense, _box, box);
+    else box[0] = world->left_bot_back, box[1] = ivec3_scalar_add(world->right_top_front, -1);
+    if (world->instances) {
+        box[0] = ivec3_min(box[0], world->left_bot_back);
+        box[1] = ivec3_max(box[1], ivec3_scalar_add(world->right_top_front, -1));
+    }
+    Bench_Rng rng = {7};
+    int errors = 0;
+    for (int i = 0; i < 200000; i++) {
+        IVector3 c = {{bench_rand_range(&rng, box[0].x, box[1].x + 1), bench_rand_range(&rng, box[0].y, box[1].y + 1),
+                       bench_rand_range(&rng, box[0].z, box[1].z + 1)}};
+        errors += !_same(world_find(world, c), world_find(mapped, c));
+    }
+    Vector3 center = vec3_scalar_mul(vec3_ivec3(ivec3_add(box[0], box[1])), 0.5f);
+    IVector3 extent = ivec3_sub(box[1], box[0]);
+    float radius = (float)(extent.x > extent.y ? (extent.x > extent.z ? extent.x : extent.z) : (extent.y > extent.z ? extent.y : extent.z)) * 0.5f + 1.0f;
+    double ray_world_ms = 0.0, ray_svo_ms = 0.0;
+    for (int i = 0; i < 20000; i++) {
+        Ray ray = bench_random_ray(&rng, center, radius);
+        Voxel_Object a, b;
+        t0 = bench_now_ms();
+        bool hit_a = world_ray_cast(world, ray, &a);
+        ray_world_ms += bench_now_ms() - t0;
+        t0 = bench_now_ms();
+        bool hit_b = world_ray_cast(mapped, ray, &b);
+        ray_svo_ms += bench_now_ms() - t0;
+        errors += hit_a != hit_b || (hit_a && (!ivec3_equal_vec(a.coord, b.coord) || !_same(a, b)));
+    }
+
+    // Primeira edição: a octree é montada a partir dos texels mapeados
+    t0 = bench_now_ms();
+    world_insert(mapped, VoxelObjCreate(voxels[VOX_STONE], make_color_rgba(255, 0, 0, 255), box[0]));
+    double edit_ms = bench_now_ms() - t0;
+
+    printf("%-22s | %8s %9.1f %8.2f | %8.2f %7.2f %7.1fx | %7.1f %6.2f | %6.2f %6.2f | %7.1f | %d\n",
+           name, world_backend_name(world->backend), build_ms, serialize_ms, load_ms, open_ms,
+           (build_ms + serialize_ms) / load_ms, save_ms, view_bytes / 1048576.0,
+           ray_world_ms, ray_svo_ms, edit_ms, errors);
+    world_delete(world);
+    world_delete(mapped);
+    remove(SVO_PATH);
+}
+
+static World *_load_vox(const char *path) {
+    World *world = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    if (!load_vox_world(path, world, 0, 0, 0, NULL)) {
+        world_delete(world);
+        return NULL;
+    }
+    return world;
+}
+
+static World *_build_terrain(const char *path) {
+    (void)path;
+    return _terrain();
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) files.push_back(argv[i]);
+    if (files.empty()) files = {"maps/dragon.vox", "maps/monu9.vox", "maps/nature.vox"};
+
+    printf("%-22s | %8s %9s %8s | %8s %7s %8s | %7s %6s | %6s %6s | %7s | %s\n",
+           "mundo", "backend", "montar", "textura", "svo", "s/ sum", "ganho", "gravar", "MB",
+           "raios", "svo", "edição", "erros");
+    for (const std::string &file : files) {
+        const char *base = strrchr(file.c_str(), '/');
+        _run(base ? base + 1 : file.c_str(), _load_vox, file.c_str());
+    }
+    _run("terreno sintético", _build_terrain, NULL);
+    return 0;
+}
@@ -0,0 +1,274 @@
+// Muitas cópias de um modelo com rotação e translação: cena copiada (cada cópia vira
+// voxels na octree do mundo) contra BVH de instâncias sobre uma única octree do modelo.
+// Mede montagem, memória, textura, raios (e confere os dois contra o DDA exato do grid
+// esparso) e o custo por quadro de mover todas as instâncias: refit da BVH, reconstrução
+// e geração do buffer que vai para a GPU, contra recopiar a cena inteira.
+//
+// Uso: bench_tlas [modelo.vox]   (padrão: maps/dragon.vox; sem o arquivo, um modelo sintético)
+
+#include "bench.hpp"
+#include <world.hpp>
+#include <voxReader.hpp>
+#include <instances.hpp>
+#include <sparseGrid.hpp>
+#include <string.h>
+#include <vector>
+
+static const int RAY_COUNT = 20000;
+static const int FRAME_COUNT = 60;
+
+// Rotações de 90° em torno de Y (o "pra cima" da engine)
+static const int Y_ROTATIONS[4][3][3] = {
+    {{ 1, 0, 0}, {0, 1, 0}, { 0, 0,  1}},
+    {{ 0, 0, 1}, {0, 1, 0}, {-1, 0,  0}},
+    {{-1, 0, 0}, {0, 1, 0}, { 0, 0, -1}},
+    {{ 0, 0,-1}, {0, 1, 0}, { 1, 0,  0}},
+};
+
+typedef struct {
+    std::vector<Voxel_Object> voxels;
+    IVector3 min, max;
+} Model_Voxels;
+
+static void _collect(void *user, Voxel_Object voxel) {
+    ((std::vector<Voxel_Object>*)user)->push_back(voxel);
+}
+
+// Carrega o .vox num mundo temporário e tira os voxels dele (qualquer backend)
+static bool _load_model(const char *path, Model_Voxels *model) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return false;
+    fclose(fp);
+
+    World *world = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    load_vox_world(path, world, 0, 0, 0, NULL);
+    if (world->dense) dense_grid_for_each(world->dense, _collect, &model->voxels);
+    if (world->tree64) tree64_for_each(world->tree64, _collect, &model->voxels);
+    if (world->sparse) sparse_grid_for_each(world->sparse, _collect, &model->voxels);
+    if (world->backend == WORLD_BACKEND_OCTREE) octree_for_each(world->octree, _collect, &model->voxels);
+    instance_set_for_each(world->instances, _collect, &model->voxels);
+    world_delete(world);
+    return !model->voxels.empty();
+}
+
+// Elipsoide com faixas de cor, do tamanho aproximado do dragão
+static void _synthetic_model(Model_Voxels *model) {
+    ColorRGBA colors[3] = {make_color_rgba(200, 60, 40, 255), make_color_rgba(60, 160, 60, 255), make_color_rgba(50, 70, 190, 255)};
+    for (int z = 0; z < 48; z++)
+    for (int y = 0; y < 64; y++)
+    for (int x = 0; x < 96; x++) {
+        float dx = (x - 48) / 48.0f, dy = (y - 32) / 32.0f, dz = (z - 24) / 24.0f;
+        float r = dx * dx + dy * dy + dz * dz;
+        if (r < 1.0f && r > 0.8f) {
+            model->voxels.push_back(VoxelObjCreate(voxels[VOX_STONE], colors[(y / 8) % 3], {{x, y, z}}));
+        }
+    }
+}
+
+// Octree do modelo com caixa [0, potência de 2) e os voxels começando em 0
+static Octree *_model_tree(Model_Voxels *model) {
+    model->min = model->max = model->voxels[0].coord;
+    for (const Voxel_Object &v : model->voxels) {
+        model->min = ivec3_min(model->min, v.coord);
+        model->max = ivec3_max(model->max, v.coord);
+    }
+    IVector3 extent = ivec3_scalar_add(ivec3_sub(model->max, model->min), 1);
+    int size = 1;
+    while (size < extent.x || size < extent.y || size < extent.z) size *= 2;
+
+    Octree *tree = octree_create(NULL, {{0, 0, 0}}, {{size, size, size}});
+    for (Voxel_Object v : model->voxels) {
+        v.coord = ivec3_sub(v.coord, model->min);
+        octree_insert(tree, v);
+    }
+    octree_compact(tree, 0);
+    return tree;
+}
+
+// Grade de lado x lado x camadas, rotação aleatória em torno de Y
+static std::vector<Voxel_Transform> _layout(int count, IVector3 extent, Bench_Rng *rng) {
+    int side = 1;
+    while (side * side * side < count && side * side * 10 < count) side++;
+    int layers = (count + side * side - 1) / (side * side);
+    int step = (extent.x > extent.z ? extent.x : extent.z) + 8;
+
+    std::vector<Voxel_Transform> transforms;
+    for (int i = 0; i < count; i++) {
+        int gx = i % side, gz = (i / side) % side, gy = i / (side * side);
+        Voxel_Transform t;
+        memcpy(t.rot, Y_ROTATIONS[bench_rand(rng) % 4], sizeof(t.rot));
+        t.translation = {{(gx - side / 2) * step + step / 2, (gy - layers / 2) * (extent.y + 8), (gz - side / 2) * step + step / 2}};
+        transforms.push_back(t);
+    }
+    return transforms;
+}
+
+typedef struct {
+    World *world;
+    Sparse_Grid *exact;
+    const Voxel_Transform *transform;
+} Bake_State;
+
+static void _bake_voxel(void *user, Voxel_Object voxel) {
+    Bake_State *state = (Bake_State*)user;
+    voxel.coord = voxel_transform_cell(state->transform, voxel.coord);
+    if (state->world) world_insert(state->world, voxel);
+    if (state->exact) sparse_grid_insert(state->exact, voxel);
+}
+
+static void _bake(Octree *model, const std::vector<Voxel_Transform> &transforms, World *world, Sparse_Grid *exact) {
+    for (const Voxel_Transform &t : transforms) {
+        Bake_State state = {world, exact, &t};
+        octree_for_each(model, _bake_voxel, &state);
+    }
+    if (world) world_compact(world, 0);
+}
+
+static std::vector<Ray> _rays(IVector3 extent, int side, Bench_Rng *rng) {
+    std::vector<Ray> rays(RAY_COUNT);
+    float radius = (float)(side * (extent.x > extent.z ? extent.x : extent.z)) * 0.5f;
+    for (Ray &r : rays) r = bench_random_ray(rng, {{0.0f, 0.0f, 0.0f}}, radius);
+    return rays;
+}
+
+static int _errors_vs_exact(bool hit, Voxel_Object voxel, Sparse_Grid *exact, Ray ray) {
+    Voxel_Object expected;
+    bool expected_hit = sparse_grid_ray_cast(exact, ray, &expected, NULL);
+    return hit != expected_hit || (hit && !ivec3_equal_vec(voxel.coord, expected.coord));
+}
+
+static void _run(Octree *model, IVector3 extent, int count, bool bake) {
+    Bench_Rng rng = {1234 + (uint64_t)count};
+    std::vector<Voxel_Transform> transforms = _layout(count, extent, &rng);
+    int side = 1;
+    while (side * side * side < count && side * side * 10 < count) side++;
+    std::vector<Ray> rays = _rays(extent, side, &rng);
+
+    Sparse_Grid *exact = bake ? sparse_grid_create() : NULL;
+    if (exact) _bake(model, transforms, NULL, exact);
+
+    // Cena copiada (só para poucas instâncias: 40k voxels x 1000 não cabe)
+    double copy_ms = 0, copy_rays_us = 0;
+    size_t copy_memory = 0, copy_texture = 0;
+    int copy_errors = 0;
+    if (bake) {
+        double t0 = bench_now_ms();
+        World *world = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+        _bake(model, transforms, world, NULL);
+        copy_ms = bench_now_ms() - t0;
+        copy_memory = world_memory_usage(world);
+        free(world_texture(world, &copy_texture, 0));
+
+        t0 = bench_now_ms();
+        std::vector<Voxel_Object> hits(rays.size());
+        std::vector<bool> found(rays.size());
+        for (size_t i = 0; i < rays.size(); i++) found[i] = world_ray_cast(world, rays[i], &hits[i]);
+        copy_rays_us = (bench_now_ms() - t0) * 1000.0 / rays.size();
+        for (size_t i = 0; i < rays.size(); i++) copy_errors += _errors_vs_exact(found[i], hits[i], exact, rays[i]);
+        world_delete(world);
+    }
+
+    // BVH de instâncias
+    double t0 = bench_now_ms();
+    Instance_Set *set = instance_set_create();
+    for (const Voxel_Transform &t : transforms) instance_set_add(set, model, t);
+    instance_set_update(set);
+    double tlas_ms = bench_now_ms() - t0;
+    size_t tlas_memory = instance_set_memory_usage(set);
+    uint8_t *texture = NULL;
+    size_t tlas_texture = 0, buffer_size = 0;
+    instance_set_append_texture(set, &texture, &tlas_texture);
+    free(texture);
+    free(instance_set_gpu_buffer(set, &buffer_size));
+
+    t0 = bench_now_ms();
+    std::vector<Voxel_Object> hits(rays.size());
+    std::vector<bool> found(rays.size());
+    for (size_t i = 0; i < rays.size(); i++) found[i] = instance_set_ray_cast(set, rays[i], &hits[i], NULL);
+    double tlas_rays_us = (bench_now_ms() - t0) * 1000.0 / rays.size();
+    int tlas_errors = 0;
+    if (exact) for (size_t i = 0; i < rays.size(); i++) tlas_errors += _errors_vs_exact(found[i], hits[i], exact, rays[i]);
+
+    if (bake) {
+        printf("%6d | %8.1f %8.1f %8.1f %8.2f | %8.2f %8.2f %8.2f %8.1f %8.2f | %5d %5d\n",
+               count, copy_ms, copy_memory / 1048576.0, copy_texture / 1048576.0, copy_rays_us,
+               tlas_ms, tlas_memory / 1048576.0, tlas_texture / 1048576.0, buffer_size / 1024.0, tlas_rays_us,
+               copy_errors, tlas_errors);
+    } else {
+        printf("%6d | %8s %8s %8s %8s | %8.2f %8.2f %8.2f %8.1f %8.2f | %5s %5s\n",
+               count, "-", "-", "-", "-",
+               tlas_ms, tlas_memory / 1048576.0, tlas_texture / 1048576.0, buffer_size / 1024.0, tlas_rays_us,
+               "-", "-");
+    }
+
+    // Todas as instâncias andam um pouco a cada quadro
+    double refit_ms = 0, rebuild_ms = 0, buffer_ms = 0;
+    for (int frame = 0; frame < FRAME_COUNT; frame++) {
+        for (size_t i = 0; i < set->count; i++) {
+            Voxel_Transform t = set->items[i].transform;
+            t.translation = ivec3_add(t.translation, {{bench_rand_range(&rng, -2, 2), bench_rand_range(&rng, -1, 1), bench_rand_range(&rng, -2, 2)}});
+            instance_set_move(set, i, t);
+        }
+        t0 = bench_now_ms();
+        instance_set_update(set);
+        refit_ms += bench_now_ms() - t0;
+
+        t0 = bench_now_ms();
+        free(instance_set_gpu_buffer(set, &buffer_size));
+        buffer_ms += bench_now_ms() - t0;
+    }
+    t0 = bench_now_ms();
+    for (const Ray &ray : rays) instance_set_ray_cast(set, ray, NULL, NULL);
+    double refit_rays_us = (bench_now_ms() - t0) * 1000.0 / rays.size();
+
+    // Reconstrução forçada, para comparar com o refit
+    for (int frame = 0; frame < FRAME_COUNT; frame++) {
+        set->needs_build = true;
+        t0 = bench_now_ms();
+        instance_set_update(set);
+        rebuild_ms += bench_now_ms() - t0;
+    }
+    t0 = bench_now_ms();
+    for (const Ray &ray : rays) instance_set_ray_cast(set, ray, NULL, NULL);
+    double rebuilt_rays_us = (bench_now_ms() - t0) * 1000.0 / rays.size();
+
+    printf("       | quadro: refit %.3f ms, rebuild %.3f ms, buffer %.3f ms (%.1f KB); raio depois do refit %.2f us, "
+           "depois do rebuild %.2f us\n",
+           refit_ms / FRAME_COUNT, rebuild_ms / FRAME_COUNT, buffer_ms / FRAME_COUNT, buffer_size / 1024.0,
+           refit_rays_us, rebuilt_rays_us);
+    if (bake) printf("       | mover na cena copiada = recopiar tudo: %.1f ms por quadro\n", copy_ms);
+
+    instance_set_delete(set);
+    sparse_grid_delete(exact);
+}
+
+int main(int argc, char **argv) {
+    const char *path = argc > 1 ? argv[1] : "maps/dragon.vox";
+    Model_Voxels voxels_of_model;
+    const char *name = path;
+    if (!_load_model(path, &voxels_of_model)) {
+        voxels_of_model.voxels.clear();
+        _synthetic_model(&voxels_of_model);
+        name = "sintético";
+    }
+    Octree *model = _model_tree(&voxels_of_model);
+    IVector3 extent = ivec3_scalar_add(ivec3_sub(voxels_of_model.max, voxels_of_model.min), 1);
+
+    bench_header("BVH de instâncias: cena copiada vs modelo compartilhado");
+    printf("modelo: %s (%zu voxels, %dx%dx%d)\n", name, voxels_of_model.voxels.size(), extent.x, extent.y, extent.z);
+    printf("%6s | %8s %8s %8s %8s | %8s %8s %8s %8s %8s | %5s %5s\n",
+           "inst", "cópia ms", "CPU MB", "tex MB", "raio us",
+           "BVH ms", "CPU MB", "tex MB", "bvh KB", "raio us",
+           "erro", "erro");
+
+    _run(model, extent, 100, true);
+    _run(model, extent, 1000, false);
+    octree_delete(model);
+
+    printf("\ncópia = cada instância vira voxels no mundo; BVH = uma octree do modelo + BVH de\n"
+           "instâncias (tex MB = o modelo uma vez; bvh KB = buffer dos nós e transformações).\n"
+           "erro = raios que erram o voxel do DDA exato (cópia, BVH).\n"
+           "quadro = todas as instâncias se movem; refit ajusta as caixas (e reconstrói se a BVH\n"
+           "piorar demais), buffer = gerar o que vai para a GPU\n");
+    return 0;
+}
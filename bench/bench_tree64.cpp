@@ -0,0 +1,195 @@
+// Compara a octree (8 filhos por nível) com a tree64 (4³ filhos e máscara de 64 bits):
+// passos e nós visitados por raio, tempo por raio, memória na CPU e tamanho serializado.
+// Também confere se as duas estruturas acertam o mesmo voxel e se o fluxo serializado
+// da tree64 devolve os mesmos voxels que a árvore.
+//
+// Uso: bench_tree64 [arquivo.vox ...]   (padrão: maps/dragon.vox e maps/nature.vox)
+
+#include <bench.hpp>
+#include <octree.hpp>
+#include <tree64.hpp>
+#include <voxReader.hpp>
+#include <vector>
+#include <math.h>
+#include <string.h>
+
+static void _shell_scene(int n, std::vector<Voxel_Object> *out) {
+    for (int z = 0; z < n; z++)
+    for (int y = 0; y < n; y++)
+    for (int x = 0; x < n; x++) {
+        float dx = x - n * 0.5f + 0.5f, dy = y - n * 0.5f + 0.5f, dz = z - n * 0.5f + 0.5f;
+        if (fabsf(sqrtf(dx * dx + dy * dy + dz * dz) - n * 0.45f) >= 0.75f) continue;
+        out->push_back(VoxelObjCreate(voxels[VOX_STONE], voxelColors[(x / 4 + y / 4 + z / 4) % 4], {{x - n / 2, y - n / 2, z - n / 2}}));
+    }
+}
+
+// Terreno de altura suave: caso típico do jogo (muito espaço vazio acima da superfície)
+static void _terrain_scene(int n, std::vector<Voxel_Object> *out) {
+    for (int z = 0; z < n; z++)
+    for (int x = 0; x < n; x++) {
+        int h = (int)(24.0f + 12.0f * sinf(x * 0.05f) * cosf(z * 0.07f) + 6.0f * sinf((x + z) * 0.13f));
+        for (int y = h - 3; y <= h; y++) {
+            Voxel_Type type = y == h ? VOX_GRASS : VOX_DIRT;
+            out->push_back(VoxelObjCreate(voxels[type], voxelColors[type], {{x - n / 2, y, z - n / 2}}));
+        }
+    }
+}
+
+static void _scatter_scene(int n, float density, std::vector<Voxel_Object> *out) {
+    Bench_Rng rng = {0xC0FFEEull};
+    for (int z = 0; z < n; z++)
+    for (int y = 0; y < n; y++)
+    for (int x = 0; x < n; x++) {
+        if (bench_rand_float(&rng) >= density) continue;
+        out->push_back(VoxelObjCreate(voxels[VOX_STONE], voxelColors[VOX_STONE], {{x - n / 2, y - n / 2, z - n / 2}}));
+    }
+}
+
+typedef struct {
+    size_t memory, serialized;
+    double build_ms, ray_ns, steps, fetches;
+    int hits;
+} Tree_Result;
+
+static void _run_scene(const char *name, const std::vector<Voxel_Object> &scene) {
+    const int RAYS = 20000;
+    const int STREAM_QUERIES = 100000;
+
+    IVector3 vmin = scene[0].coord, vmax = scene[0].coord;
+    for (const Voxel_Object &v : scene) {
+        vmin = ivec3_min(vmin, v.coord);
+        vmax = ivec3_max(vmax, v.coord);
+    }
+    Vector3 center = vec3_scalar_mul(vec3_ivec3(ivec3_add(vmin, vmax)), 0.5f);
+    IVector3 ext = ivec3_scalar_add(ivec3_sub(vmax, vmin), 1);
+    float radius = (float)(ext.x > ext.z ? ext.x : ext.z);
+
+    Bench_Rng rng = {4321};
+    std::vector<Ray> rays(RAYS);
+    for (Ray &r : rays) r = bench_random_ray(&rng, center, radius);
+
+    Tree_Result oct = {0}, t64 = {0};
+    Vector3 world_min = vec3_ivec3(BENCH_WORLD_MIN), world_max = vec3_ivec3(BENCH_WORLD_MAX);
+
+    // --- Octree ---
+    double t0 = bench_now_ms();
+    Octree *octree = octree_create(NULL, BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    for (const Voxel_Object &v : scene) octree_insert(octree, v);
+    octree_compact(octree, 0);
+    oct.build_ms = bench_now_ms() - t0;
+    oct.memory = octree_memory_usage(octree);
+    oct.serialized = _octree_texel_size(octree) * 4;
+
+    std::vector<IVector3> oct_hits(RAYS);
+    t0 = bench_now_ms();
+    for (int i = 0; i < RAYS; i++) {
+        Octree *hit = octree_ray_cast(octree, rays[i], world_min, world_max);
+        oct_hits[i] = (hit && hit->has_voxel) ? hit->voxel.coord : _invalid_voxel().coord;
+    }
+    oct.ray_ns = (bench_now_ms() - t0) * 1e6 / RAYS;
+
+    Ray_Stats stats = {0, 0};
+    for (const Ray &r : rays) octree_ray_cast_stats(octree, r, world_min, world_max, &stats);
+    oct.steps = (double)stats.steps / RAYS;
+    oct.fetches = (double)stats.fetches / RAYS;
+
+    // --- Tree64 ---
+    t0 = bench_now_ms();
+    Tree64 *tree = tree64_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    for (const Voxel_Object &v : scene) tree64_insert(tree, v);
+    t64.build_ms = bench_now_ms() - t0;
+    t64.memory = tree64_memory_usage(tree);
+
+    std::vector<IVector3> t64_hits(RAYS);
+    t0 = bench_now_ms();
+    for (int i = 0; i < RAYS; i++) {
+        Voxel_Object hit;
+        t64_hits[i] = tree64_ray_cast(tree, rays[i], &hit, NULL) ? hit.coord : _invalid_voxel().coord;
+    }
+    t64.ray_ns = (bench_now_ms() - t0) * 1e6 / RAYS;
+
+    stats.steps = stats.fetches = 0;
+    for (const Ray &r : rays) tree64_ray_cast(tree, r, NULL, &stats);
+    t64.steps = (double)stats.steps / RAYS;
+    t64.fetches = (double)stats.fetches / RAYS;
+
+    // Compara só acerto/erro: num volume fundido a octree devolve a coordenada base do
+    // bloco, não a célula atingida, então as coordenadas podem diferir legitimamente.
+    // As diferenças que sobram são da octree (a tree64 bate com o DDA da grade densa).
+    int mismatches = 0;
+    for (int i = 0; i < RAYS; i++) {
+        bool oct_hit = oct_hits[i].y != _invalid_voxel().coord.y;
+        bool t64_hit = t64_hits[i].y != _invalid_voxel().coord.y;
+        if (oct_hit != t64_hit) mismatches++;
+        oct.hits += oct_hit;
+        t64.hits += t64_hit;
+    }
+
+    // Confere o serializador contra a árvore
+    uint8_t *stream = tree64_serialize(tree, &t64.serialized);
+    int stream_errors = 0;
+    for (int i = 0; i < STREAM_QUERIES; i++) {
+        IVector3 q = i % 2 ? scene[bench_rand(&rng) % scene.size()].coord
+                           : IVector3{{bench_rand_range(&rng, vmin.x, vmax.x + 1), bench_rand_range(&rng, vmin.y, vmax.y + 1), bench_rand_range(&rng, vmin.z, vmax.z + 1)}};
+        Voxel_Object a = tree64_find(tree, q);
+        Voxel_Object b = tree64_stream_find(stream, t64.serialized, tree->left_bot_back, tree->levels, q);
+        if (a.coord.y != b.coord.y || (a.coord.y != _invalid_voxel().coord.y && a.color != b.color)) stream_errors++;
+    }
+    free(stream);
+
+    printf("%-10s %8zu | %9.1f %9.1f %6.1f %7.1f %7.0f | %9.1f %9.1f %6.1f %7.1f %7.0f | %5d %5d\n",
+           name, scene.size(),
+           oct.memory / 1024.0, oct.serialized / 1024.0, oct.steps, oct.fetches, oct.ray_ns,
+           t64.memory / 1024.0, t64.serialized / 1024.0, t64.steps, t64.fetches, t64.ray_ns,
+           mismatches, stream_errors);
+
+    octree_delete(octree);
+    tree64_delete(tree);
+}
+
+static void _collect(void *user, Voxel_Object voxel) {
+    ((std::vector<Voxel_Object>*)user)->push_back(voxel);
+}
+
+int main(int argc, char **argv) {
+    bench_header("octree vs tree64");
+    printf("%-10s %8s | %9s %9s %6s %7s %7s | %9s %9s %6s %7s %7s | %5s %5s\n",
+           "cena", "voxels",
+           "oct KB", "tex KB", "passos", "nós", "ns/raio",
+           "t64 KB", "tex KB", "passos", "nós", "ns/raio",
+           "difer", "serial");
+
+    std::vector<Voxel_Object> scene;
+    _shell_scene(256, &scene);
+    _run_scene("shell256", scene);
+
+    scene.clear();
+    _terrain_scene(512, &scene);
+    _run_scene("terrain512", scene);
+
+    scene.clear();
+    _scatter_scene(256, 0.001f, &scene);
+    _run_scene("scatter256", scene);
+
+    const char *default_maps[] = {"maps/dragon.vox", "maps/nature.vox"};
+    int count = argc > 1 ? argc - 1 : 2;
+    for (int i = 0; i < count; i++) {
+        const char *path = argc > 1 ? argv[i + 1] : default_maps[i];
+        Octree *tmp = octree_create(NULL, BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+        if (!load_vox_file(path, tmp, 0, 0, 0, NULL)) {
+            octree_delete(tmp);
+            continue;
+        }
+        scene.clear();
+        octree_for_each(tmp, _collect, &scene);
+        octree_delete(tmp);
+        if (scene.empty()) continue;
+
+        const char *name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+        _run_scene(name, scene);
+    }
+
+    printf("\npassos = avanços do raio; nós = nós internos visitados (cada um custa 2 leituras\n"
+           "de textura na octree: cabeçalho + ponteiro; na tree64 o nó inteiro fica em 3 texels)\n");
+    return 0;
+}
@@ -0,0 +1,513 @@
+// Compara um leitor .vox de referência (stdio: fread por voxel, std::map por dicionário,
+// grafo percorrido com matrizes), mantido só aqui, com o leitor da biblioteca (mapeado em
+// memória, views com checagem de limites, XYZI lido direto do arquivo).
+// Mede só o parse (sink que apenas conta) e a carga completa numa octree, e confere se os
+// dois entregam exatamente a mesma sequência de voxels.
+// A cena "export" é gerada aqui: um export com muitos modelos e grafo de cena completo.
+// A segunda tabela compara a instanciação com 1 thread e com várias (octree por thread
+// enxertada no destino), num arquivo e num manifesto com cópias sobrepostas do export.
+//
+// Uso: bench_vox [arquivo.vox ...]   (padrão: export sintético + maps/*.vox)
+
+#include <bench.hpp>
+#include <octree.hpp>
+#include <voxReader.hpp>
+#include <vector>
+#include <string>
+#include <map>
+#include <sstream>
+#include <iostream>
+#include <string.h>
+#include <thread>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+static const char *SYNTH_PATH = "bench_vox_export.vox";
+static const char *SMALL_PATH = "bench_vox_small.vox";
+static const char *MANIFEST_PATH = "bench_vox_manifest.txt";
+
+static void _put_i32(std::vector<uint8_t> *out, int32_t v) {
+    uint8_t b[4];
+    memcpy(b, &v, 4);
+    out->insert(out->end(), b, b + 4);
+}
+
+static void _put_string(std::vector<uint8_t> *out, const std::string &s) {
+    _put_i32(out, (int32_t)s.size());
+    out->insert(out->end(), s.begin(), s.end());
+}
+
+static void _put_dict(std::vector<uint8_t> *out, const std::vector<std::pair<std::string, std::string>> &dict) {
+    _put_i32(out, (int32_t)dict.size());
+    for (const auto &kv : dict) {
+        _put_string(out, kv.first);
+        _put_string(out, kv.second);
+    }
+}
+
+static void _put_chunk(std::vector<uint8_t> *out, const char *id, const std::vector<uint8_t> &content) {
+    out->insert(out->end(), id, id + 4);
+    _put_i32(out, (int32_t)content.size());
+    _put_i32(out, 0);
+    out->insert(out->end(), content.begin(), content.end());
+}
+
+// Grade de side x side modelos (cascas esféricas de 'dim'³), cada um sob nTRN -> nSHP,
+// todos num nGRP sob o nTRN raiz; rotações variadas e alguns atributos extras por nó
+static bool _write_export(const char *path, int side, int dim) {
+    std::vector<uint8_t> body, chunk;
+    int models = side * side;
+    Bench_Rng rng = {31337};
+
+    for (int m = 0; m < models; m++) {
+        chunk.clear();
+        _put_i32(&chunk, dim); _put_i32(&chunk, dim); _put_i32(&chunk, dim);
+        _put_chunk(&body, "SIZE", chunk);
+
+        std::vector<uint8_t> xyzi;
+        int32_t count = 0;
+        for (int z = 0; z < dim; z++)
+        for (int y = 0; y < dim; y++)
+        for (int x = 0; x < dim; x++) {
+            int dx = 2 * x - dim + 1, dy = 2 * y - dim + 1, dz = 2 * z - dim + 1;
+            int r2 = dx * dx + dy * dy + dz * dz;
+            if (r2 > dim * dim || r2 < (dim - 6) * (dim - 6)) continue;
+            uint8_t v[4] = {(uint8_t)x, (uint8_t)y, (uint8_t)z, (uint8_t)(1 + (m + z) % 255)};
+            xyzi.insert(xyzi.end(), v, v + 4);
+            count++;
+        }
+        chunk.clear();
+        _put_i32(&chunk, count);
+        chunk.insert(chunk.end(), xyzi.begin(), xyzi.end());
+        _put_chunk(&body, "XYZI", chunk);
+    }
+
+    // Grafo: 0 = nTRN raiz, 1 = nGRP, depois (nTRN, nSHP) por modelo
+    chunk.clear();
+    _put_i32(&chunk, 0); _put_dict(&chunk, {}); _put_i32(&chunk, 1);
+    _put_i32(&chunk, -1); _put_i32(&chunk, 0); _put_i32(&chunk, 1); _put_dict(&chunk, {});
+    _put_chunk(&body, "nTRN", chunk);
+
+    chunk.clear();
+    _put_i32(&chunk, 1); _put_dict(&chunk, {}); _put_i32(&chunk, models);
+    for (int m = 0; m < models; m++) _put_i32(&chunk, 2 + 2 * m);
+    _put_chunk(&body, "nGRP", chunk);
+
+    for (int m = 0; m < models; m++) {
+        int r0 = bench_rand(&rng) % 3, r1 = (r0 + 1 + bench_rand(&rng) % 2) % 3;
+        int rot = r0 | (r1 << 2) | ((bench_rand(&rng) % 8) << 4);
+        int tx = (m % side - side / 2) * (dim + 8), ty = (m / side - side / 2) * (dim + 8), tz = dim / 2;
+
+        chunk.clear();
+        _put_i32(&chunk, 2 + 2 * m);
+        _put_dict(&chunk, {{"_name", "modelo_" + std::to_string(m)}, {"_hidden", "0"}});
+        _put_i32(&chunk, 3 + 2 * m);
+        _put_i32(&chunk, -1); _put_i32(&chunk, 0); _put_i32(&chunk, 1);
+        _put_dict(&chunk, {{"_r", std::to_string(rot)},
+                           {"_t", std::to_string(tx) + " " + std::to_string(ty) + " " + std::to_string(tz)}});
+        _put_chunk(&body, "nTRN", chunk);
+
+        chunk.clear();
+        _put_i32(&chunk, 3 + 2 * m); _put_dict(&chunk, {}); _put_i32(&chunk, 1);
+        _put_i32(&chunk, m); _put_dict(&chunk, {});
+        _put_chunk(&body, "nSHP", chunk);
+    }
+
+    chunk.clear();
+    for (int i = 0; i < 256; i++) {
+        uint8_t c[4] = {(uint8_t)i, (uint8_t)(255 - i), (uint8_t)(i * 7), 255};
+        chunk.insert(chunk.end(), c, c + 4);
+    }
+    _put_chunk(&body, "RGBA", chunk);
+
+    std::vector<uint8_t> file = {'V', 'O', 'X', ' '};
+    _put_i32(&file, 150);
+    file.insert(file.end(), {'M', 'A', 'I', 'N'});
+    _put_i32(&file, 0);
+    _put_i32(&file, (int32_t)body.size());
+    file.insert(file.end(), body.begin(), body.end());
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp) return false;
+    bool ok = fwrite(file.data(), 1, file.size(), fp) == file.size();
+    fclose(fp);
+    return ok;
+}
+
+// --- Leitor de referência (stdio) ---
+
+typedef void (*Vox_Sink)(void *user, Voxel_Object voxel);
+
+typedef struct {
+    glm::ivec3 size;
+    std::vector<uint8_t> xyzi;
+} Stdio_Model;
+
+typedef struct {
+    int type;               //0 = nTRN, 1 = nGRP, 2 = nSHP
+    int child = -1;
+    glm::vec3 translation = glm::vec3(0.0f);
+    uint8_t rotation = 4;   //identidade
+    std::vector<int> children;
+    int model = -1;
+} Stdio_Node;
+
+static std::string _read_string(FILE *fp) {
+    int32_t size;
+    if (fread(&size, 4, 1, fp) != 1 || size <= 0 || size > 1024 * 1024) return "";
+    std::string s((size_t)size, '\0');
+    if (fread(&s[0], 1, (size_t)size, fp) != (size_t)size) return "";
+    return s;
+}
+
+static std::map<std::string, std::string> _read_dict(FILE *fp) {
+    std::map<std::string, std::string> dict;
+    int32_t pairs;
+    if (fread(&pairs, 4, 1, fp) != 1 || pairs < 0 || pairs > 1000) return dict;
+    for (int i = 0; i < pairs; i++) {
+        std::string key = _read_string(fp);
+        dict[key] = _read_string(fp);
+    }
+    return dict;
+}
+
+static int _round(float v) {
+    return v >= 0.0f ? (int)(v + 0.5f) : (int)(v - 0.5f);
+}
+
+// Mesma convenção do formato que o leitor da biblioteca (linhas r0, r1 e o produto vetorial)
+static glm::mat4 _rotation(uint8_t r) {
+    int r0 = r & 3, r1 = (r >> 2) & 3;
+    if (r0 > 2 || r1 > 2 || r0 == r1) return glm::mat4(1.0f);
+    glm::vec3 row0(0.0f), row1(0.0f);
+    row0[r0] = (r & 16) ? -1.0f : 1.0f;
+    row1[r1] = (r & 32) ? -1.0f : 1.0f;
+    glm::vec3 row2 = glm::cross(row0, row1);
+    if (r & 64) row2 = -row2;
+    glm::mat4 m(1.0f);
+    m[0][0] = row0.x; m[1][0] = row0.y; m[2][0] = row0.z;
+    m[0][1] = row1.x; m[1][1] = row1.y; m[2][1] = row1.z;
+    m[0][2] = row2.x; m[1][2] = row2.y; m[2][2] = row2.z;
+    return m;
+}
+
+static void _traverse(int id, glm::mat4 parent, const std::map<int, Stdio_Node> &nodes, const std::vector<Stdio_Model> &models,
+                      const std::vector<ColorRGBA> &palette, Vox_Sink sink, void *user, int depth) {
+    auto it = nodes.find(id);
+    if (it == nodes.end() || depth > 256) return;
+    const Stdio_Node &node = it->second;
+    if (node.type == 0) {
+        glm::mat4 m = parent * glm::translate(glm::mat4(1.0f), node.translation) * _rotation(node.rotation);
+        _traverse(node.child, m, nodes, models, palette, sink, user, depth + 1);
+    } else if (node.type == 1) {
+        for (int child : node.children) _traverse(child, parent, nodes, models, palette, sink, user, depth + 1);
+    } else if (node.model >= 0 && node.model < (int)models.size()) {
+        const Stdio_Model &model = models[node.model];
+        glm::vec3 center = glm::vec3(model.size) / 2.0f;
+        for (size_t i = 0; i + 4 <= model.xyzi.size(); i += 4) {
+            const uint8_t *v = &model.xyzi[i];
+            int color = v[3] > 0 ? v[3] - 1 : 0;
+            glm::vec4 p = parent * glm::vec4(v[0] - center.x, v[1] - center.y, v[2] - center.z, 1.0f);
+            sink(user, VoxelObjCreate(voxels[0], palette[color], {{_round(p.x), _round(p.z), _round(p.y)}}));
+        }
+    }
+}
+
+// O leitor antigo da biblioteca, reduzido: chunk a chunk com fseek/fread, voxels lidos um a um
+static bool _stdio_for_each(const char *path, Vox_Sink sink, void *user) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return false;
+    char header[4];
+    int32_t version;
+    if (fread(header, 1, 4, fp) != 4 || fread(&version, 4, 1, fp) != 1 || strncmp(header, "VOX ", 4) != 0) {
+        fclose(fp);
+        return false;
+    }
+    fseek(fp, 0, SEEK_END);
+    long file_size = ftell(fp);
+    fseek(fp, 8, SEEK_SET);
+
+    std::vector<Stdio_Model> models;
+    std::map<int, Stdio_Node> nodes;
+    std::vector<ColorRGBA> palette(256);
+    for (int i = 0; i < 256; i++) palette[i] = make_color_rgba(i, i, i, 255);
+    glm::ivec3 size(0);
+
+    while (ftell(fp) < file_size - 12) {
+        char id[4];
+        int32_t content, children;
+        if (fread(id, 1, 4, fp) < 4 || fread(&content, 4, 1, fp) < 1 || fread(&children, 4, 1, fp) < 1) break;
+        if (content < 0 || children < 0) break;
+        long end = ftell(fp) + content + children;
+        if (end > file_size) break;
+        if (strncmp(id, "MAIN", 4) == 0) continue;
+
+        if (strncmp(id, "SIZE", 4) == 0) {
+            fread(&size.x, 4, 1, fp); fread(&size.y, 4, 1, fp); fread(&size.z, 4, 1, fp);
+        } else if (strncmp(id, "XYZI", 4) == 0) {
+            int32_t count;
+            fread(&count, 4, 1, fp);
+            if (count >= 0 && count <= 10000000) {
+                Stdio_Model model;
+                model.size = size;
+                model.xyzi.resize((size_t)count * 4);
+                for (size_t i = 0; i < model.xyzi.size(); i++) fread(&model.xyzi[i], 1, 1, fp);
+                models.push_back(model);
+            }
+        } else if (strncmp(id, "RGBA", 4) == 0) {
+            for (int i = 0; i < 256; i++) {
+                uint8_t c[4];
+                for (int k = 0; k < 4; k++) fread(&c[k], 1, 1, fp);
+                palette[i] = make_color_rgba(c[0], c[1], c[2], c[3]);
+            }
+        } else if (strncmp(id, "nTRN", 4) == 0) {
+            Stdio_Node node;
+            int32_t node_id, reserved, layer, frames;
+            node.type = 0;
+            fread(&node_id, 4, 1, fp);
+            _read_dict(fp);
+            fread(&node.child, 4, 1, fp);
+            fread(&reserved, 4, 1, fp); fread(&layer, 4, 1, fp); fread(&frames, 4, 1, fp);
+            for (int f = 0; f < frames; f++) {
+                std::map<std::string, std::string> dict = _read_dict(fp);
+                if (f != 0) continue;
+                if (dict.count("_t")) {
+                    std::stringstream ss(dict["_t"]);
+                    ss >> node.translation.x >> node.translation.y >> node.translation.z;
+                }
+                if (dict.count("_r")) node.rotation = (uint8_t)std::stoi(dict["_r"]);
+            }
+            nodes[node_id] = node;
+        } else if (strncmp(id, "nGRP", 4) == 0) {
+            Stdio_Node node;
+            int32_t node_id, count, child;
+            node.type = 1;
+            fread(&node_id, 4, 1, fp);
+            _read_dict(fp);
+            fread(&count, 4, 1, fp);
+            for (int i = 0; i < count && fread(&child, 4, 1, fp) == 1; i++) node.children.push_back(child);
+            nodes[node_id] = node;
+        } else if (strncmp(id, "nSHP", 4) == 0) {
+            Stdio_Node node;
+            int32_t node_id, count, model;
+            node.type = 2;
+            fread(&node_id, 4, 1, fp);
+            _read_dict(fp);
+            fread(&count, 4, 1, fp);
+            for (int i = 0; i < count && fread(&model, 4, 1, fp) == 1; i++) {
+                _read_dict(fp);
+                if (i == 0) node.model = model;
+            }
+            nodes[node_id] = node;
+        }
+        fseek(fp, end, SEEK_SET);
+    }
+    fclose(fp);
+
+    if (nodes.empty()) {
+        // Sem grafo: coordenadas do arquivo, sem centralizar
+        for (const Stdio_Model &model : models)
+        for (size_t i = 0; i + 4 <= model.xyzi.size(); i += 4) {
+            const uint8_t *v = &model.xyzi[i];
+            sink(user, VoxelObjCreate(voxels[0], palette[v[3] > 0 ? v[3] - 1 : 0], {{v[0], v[2], v[1]}}));
+        }
+        return true;
+    }
+    _traverse(0, glm::mat4(1.0f), nodes, models, palette, sink, user, 0);
+    return true;
+}
+
+// Mesmos limites que o leitor da biblioteca aplica a destinos de tamanho fixo
+static void _octree_sink(void *user, Voxel_Object voxel) {
+    IVector3 c = voxel.coord;
+    if (c.x < -2048 || c.x > 2048 || c.y < -2048 || c.y > 2048 || c.z < -2048 || c.z > 2048) return;
+    octree_insert((Octree*)user, voxel);
+}
+
+typedef struct {
+    size_t count;
+    uint64_t hash;
+} Parse_Sink;
+
+// Conta e resume a sequência (ordem, coordenada e cor) para comparar os dois leitores
+static void _hash_sink(void *user, Voxel_Object voxel) {
+    Parse_Sink *s = (Parse_Sink*)user;
+    uint64_t h = s->hash;
+    h = (h ^ (uint32_t)voxel.coord.x) * 0x100000001b3ull;
+    h = (h ^ (uint32_t)voxel.coord.y) * 0x100000001b3ull;
+    h = (h ^ (uint32_t)voxel.coord.z) * 0x100000001b3ull;
+    h = (h ^ voxel.color) * 0x100000001b3ull;
+    s->hash = h;
+    s->count++;
+}
+
+static double _parse_ms(const char *path, bool mmap, Parse_Sink *out, int repeats) {
+    double best = 1e30;
+    for (int r = 0; r < repeats; r++) {
+        Parse_Sink s = {0, 0xcbf29ce484222325ull};
+        double t0 = bench_now_ms();
+        if (mmap) load_vox_for_each(path, _hash_sink, &s, 0, 0, 0);
+        else _stdio_for_each(path, _hash_sink, &s);
+        double ms = bench_now_ms() - t0;
+        if (ms < best) best = ms;
+        *out = s;
+    }
+    return best;
+}
+
+static double _octree_ms(const char *path, bool mmap, size_t *memory) {
+    double t0 = bench_now_ms();
+    Octree *tree = octree_create(NULL, BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    if (mmap) {
+        load_vox_file(path, tree, 0, 0, 0, NULL);
+    } else {
+        _stdio_for_each(path, _octree_sink, tree);
+        octree_compact(tree, 0);
+    }
+    double ms = bench_now_ms() - t0;
+    *memory = octree_memory_usage(tree);
+    octree_delete(tree);
+    return ms;
+}
+
+// Mesma forma e mesmo conteúdo em cada nó
+static bool _same_tree(Octree *a, Octree *b) {
+    if ((a->children != NULL) != (b->children != NULL)) return false;
+    if (a->children) {
+        for (int i = 0; i < 8; i++) {
+            if (!_same_tree(a->children[i], b->children[i])) return false;
+        }
+        return true;
+    }
+    if (a->has_voxel != b->has_voxel) return false;
+    if (!a->has_voxel) return true;
+    return a->is_point == b->is_point && a->voxel.color == b->voxel.color
+        && ivec3_equal_vec(a->voxel.coord, b->voxel.coord);
+}
+
+static World *_load_world(const char *path, bool manifest, const Vox_Load_Options *options) {
+    World *world = world_create(BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+    if (manifest) load_vox_manifest(path, world, options);
+    else load_vox_world(path, world, 0, 0, 0, options);
+    return world;
+}
+
+static void _run_parallel(const char *name, const char *path, bool manifest, int threads) {
+    fflush(stdout);
+    std::streambuf *old = std::cout.rdbuf(NULL);
+
+    double t0;
+    double file_ms[2] = {0, 0}, world_ms[2] = {0, 0};
+    Octree *trees[2] = {NULL, NULL};
+    World *worlds[2];
+    for (int k = 0; k < 2; k++) {
+        Vox_Load_Options options = {k ? threads : 1};
+        if (!manifest) {
+            t0 = bench_now_ms();
+            trees[k] = octree_create(NULL, BENCH_WORLD_MIN, BENCH_WORLD_MAX);
+            load_vox_file(path, trees[k], 0, 0, 0, &options);
+            file_ms[k] = bench_now_ms() - t0;
+        }
+        t0 = bench_now_ms();
+        worlds[k] = _load_world(path, manifest, &options);
+        world_ms[k] = bench_now_ms() - t0;
+    }
+    std::cout.rdbuf(old);
+
+    bool same = worlds[0]->backend == worlds[1]->backend
+             && (worlds[0]->backend != WORLD_BACKEND_OCTREE || _same_tree(worlds[0]->octree, worlds[1]->octree));
+    if (trees[0]) same = same && _same_tree(trees[0], trees[1]);
+
+    if (manifest) printf("%-14s %7d | %9s %9s | %9.1f %9.1f | %-7s %s\n", name, threads, "-", "-",
+                         world_ms[0], world_ms[1], world_backend_name(worlds[0]->backend), same ? "ok" : "DIFERE");
+    else printf("%-14s %7d | %9.1f %9.1f | %9.1f %9.1f | %-7s %s\n", name, threads, file_ms[0], file_ms[1],
+                world_ms[0], world_ms[1], world_backend_name(worlds[0]->backend), same ? "ok" : "DIFERE");
+
+    for (int k = 0; k < 2; k++) {
+        octree_delete(trees[k]);
+        world_delete(worlds[k]);
+    }
+}
+
+static void _run_file(const char *name, const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return;
+    fseek(fp, 0, SEEK_END);
+    double mb = ftell(fp) / (1024.0 * 1024.0);
+    fclose(fp);
+
+    // O std::cout dos leitores ("Carregados N voxels...") iria no meio da tabela
+    fflush(stdout);
+    std::streambuf *old = std::cout.rdbuf(NULL);
+
+    Parse_Sink legacy, mapped;
+    double legacy_ms = _parse_ms(path, false, &legacy, 3);
+    double mapped_ms = _parse_ms(path, true, &mapped, 3);
+    size_t legacy_mem, mapped_mem;
+    double legacy_oct = _octree_ms(path, false, &legacy_mem);
+    double mapped_oct = _octree_ms(path, true, &mapped_mem);
+
+    std::cout.rdbuf(old);
+
+    bool same = legacy.count == mapped.count && legacy.hash == mapped.hash && legacy_mem == mapped_mem;
+    printf("%-14s %7.1f %9zu | %9.1f %8.0f %9.1f | %9.1f %8.0f %9.1f | %6.1fx %6.2fx | %s\n",
+           name, mb, mapped.count,
+           legacy_ms, mb / (legacy_ms / 1000.0), legacy_oct,
+           mapped_ms, mb / (mapped_ms / 1000.0), mapped_oct,
+           legacy_ms / mapped_ms, legacy_oct / mapped_oct,
+           same ? "ok" : "DIFERE");
+}
+
+int main(int argc, char **argv) {
+    bench_header("leitor .vox: stdio (referência) vs mapeado em memória");
+    printf("%-14s %7s %9s | %9s %8s %9s | %9s %8s %9s | %7s %7s | %s\n",
+           "arquivo", "MB", "voxels",
+           "parse ms", "MB/s", "octree ms",
+           "parse ms", "MB/s", "octree ms",
+           "parse", "octree", "iguais");
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            const char *name = strrchr(argv[i], '/') ? strrchr(argv[i], '/') + 1 : argv[i];
+            _run_file(name, argv[i]);
+        }
+        return 0;
+    }
+
+    bool have_export = _write_export(SYNTH_PATH, 16, 48);
+    if (have_export) _run_file("export16x16", SYNTH_PATH);
+    const char *default_maps[] = {"maps/dragon.vox", "maps/nature.vox", "maps/monu9.vox"};
+    for (const char *path : default_maps) _run_file(strrchr(path, '/') + 1, path);
+
+    printf("\nà esquerda o leitor stdio de referência, à direita o mapeado; parse = só ler e entregar os voxels\n"
+           "(melhor de 3); octree = load_vox_file numa octree vazia (inclui inserir e compactar)\n");
+
+    // Pelo menos 4 threads, mesmo numa máquina com menos núcleos (confere o enxerto)
+    int threads = (int)std::thread::hardware_concurrency();
+    if (threads < 4) threads = 4;
+
+    bench_header("instanciação: 1 thread vs várias");
+    printf("%-14s %7s | %9s %9s | %9s %9s | %-7s %s\n",
+           "arquivo", "threads", "oct 1t", "oct Nt", "mundo 1t", "mundo Nt", "backend", "iguais");
+    if (have_export) {
+        _run_parallel("export16x16", SYNTH_PATH, false, threads);
+        remove(SYNTH_PATH);
+    }
+
+    // Quatro cópias deslocadas e sobrepostas de um export menor: a ordem do manifesto decide quem fica
+    FILE *fp = _write_export(SMALL_PATH, 8, 48) ? fopen(MANIFEST_PATH, "w") : NULL;
+    if (fp) {
+        fprintf(fp, "# quatro cópias do export\n%s\n%s 20 0 0\n%s 0 30 10\n%s -300 0 -300\n",
+                SMALL_PATH, SMALL_PATH, SMALL_PATH, SMALL_PATH);
+        fclose(fp);
+        _run_parallel("manifesto x4", MANIFEST_PATH, true, threads);
+        remove(MANIFEST_PATH);
+    }
+    remove(SMALL_PATH);
+    _run_parallel("nature.vox", "maps/nature.vox", false, threads);
+
+    printf("\noct = load_vox_file numa octree vazia; mundo = load_vox_world / load_vox_manifest\n"
+           "(inclui escolher o backend, inserir e compactar); tempos em ms; núcleos nesta máquina: %u\n",
+           std::thread::hardware_concurrency());
+    return 0;
+}
@@ -0,0 +1,54 @@
+#ifndef _ASYNCFILE_H
+#define _ASYNCFILE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Arquivo com leituras e escritas em fila: muitas operações em voo ao mesmo tempo, pedidas
+// em lotes (async_file_submit) e recolhidas quando terminam (async_file_complete). No Linux
+// a fila é um io_uring (leituras direto em buffers registrados de um pool); sem ele, um pool
+// de threads com pread. A fila é de uma thread só; as funções bloqueantes (async_file_pread,
+// async_file_pwrite, async_file_sync) podem vir de qualquer thread.
+typedef enum _async_file_backend {
+    ASYNC_FILE_AUTO,            //io_uring quando o sistema deixa, senão ASYNC_FILE_THREADS
+    ASYNC_FILE_URING,
+    ASYNC_FILE_THREADS,         //pool de threads com pread/pwrite
+    ASYNC_FILE_BLOCKING,        //uma operação por vez, dentro de async_file_complete
+} Async_File_Backend;
+
+// Operações em voo (e buffers no pool) por arquivo
+#define ASYNC_FILE_DEPTH 256
+// Buffer de cada leitura no pool; leituras maiores usam um buffer próprio
+#define ASYNC_FILE_BUFFER_SIZE (64u << 10)
+// Threads do ASYNC_FILE_THREADS
+#define ASYNC_FILE_WORKERS 8
+
+// Operação terminada
+typedef struct _async_file_op {
+    uint64_t tag;               //o de async_file_read/async_file_write
+    uint64_t offset;
+    uint8_t *data;              //leitura: devolver com async_file_release (ou free, se veio de quem pediu)
+    size_t size;
+    bool write;
+    bool ok;                    //leu/gravou 'size' bytes
+} Async_File_Op;
+
+typedef struct _async_file Async_File;
+
+Async_File *async_file_open(const char *path, bool create, Async_File_Backend backend);
+Async_File_Backend async_file_backend(Async_File *file);
+const char *async_file_backend_name(Async_File_Backend backend);
+uint64_t async_file_size(Async_File *file);
+bool async_file_pread(Async_File *file, uint64_t offset, void *data, size_t size);
+bool async_file_pwrite(Async_File *file, uint64_t offset, const void *data, size_t size);
+bool async_file_sync(Async_File *file);
+size_t async_file_room(Async_File *file);
+bool async_file_read(Async_File *file, uint64_t offset, uint8_t *data, size_t size, uint64_t tag);
+bool async_file_write(Async_File *file, uint64_t offset, const uint8_t *data, size_t size, uint64_t tag);
+size_t async_file_submit(Async_File *file);
+size_t async_file_complete(Async_File *file, Async_File_Op *ops, size_t capacity, bool wait);
+size_t async_file_in_flight(Async_File *file);
+void async_file_release(Async_File *file, uint8_t *data);
+void async_file_close(Async_File *file);
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef _CHUNKGRID_H
+#define _CHUNKGRID_H
+
+#include <voxel.hpp>
+#include <octree.hpp>
+#include <instances.hpp>
+#include <svoFile.hpp>
+#include <chunkStore.hpp>
+
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+    #include <vmm/ray.h>
+}
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Mundo dividido em chunks de CHUNK_SIZE³, cada um com a sua octree. Perto da câmera o
+// chunk é residente (octree editável, com uma vaga na textura); longe ele fica guardado
+// como a imagem .svo dele (svo_file_encode), consultada sem montar a árvore.
+#define CHUNK_LOG2 6
+#define CHUNK_SIZE (1 << CHUNK_LOG2)
+// Raio (em chunks, distância de Chebyshev) mantido residente em volta da câmera
+#define CHUNK_RESIDENT_RADIUS 4
+// Folga de cada vaga na textura: o chunk editado pode crescer até aqui sem mudar de lugar
+#define CHUNK_SLOT_SLACK 1.25f
+// Texels livres depois das vagas, para chunks que entram ou crescem sem reenviar a textura
+#define CHUNK_ARENA_RESERVE (1 << 20)
+// Com um chunk_store: bytes de imagens guardadas na memória fora da janela; passando
+// disso as usadas há mais tempo voltam só para o disco
+#define CHUNK_CACHE_BUDGET (256u << 20)
+// Quanto à frente da câmera (em segundos, na velocidade atual) chunk_grid_prefetch pede
+#define CHUNK_PREFETCH_SECONDS 2.0f
+// Pirâmide de LOD dos chunks além do raio residente: reduções com células de 2³, 4³ e 8³
+// (ver octree_downsample), só na GPU. Com um chunk_store, a imagem cheia de um chunk que
+// só aparece reduzido volta para o disco assim que as reduções ficam prontas
+#define CHUNK_LOD_LEVELS 3
+// Raio (em chunks) da janela na GPU com LOD ligado (ver chunk_grid_set_lod)
+#define CHUNK_LOD_RADIUS 24
+// Tamanho na tela (pixels) até onde uma célula reduzida passa: cada chunk vai no nível
+// mais grosso que fica abaixo disso
+#define CHUNK_LOD_PIXELS 6.0f
+// Com a janela maior que a textura, o tamanho aceito na tela sobe por este fator até ela
+// caber (os anéis de longe ficam mais grossos primeiro)
+#define CHUNK_LOD_SQUEEZE 1.25f
+// Edição que passa desta fração do volume do chunk refaz a pirâmide inteira em vez de só
+// as células da caixa
+#define CHUNK_LOD_REBUILD 0.125f
+
+// Tempo por quadro (ms) que chunk_grid_page gasta montando e guardando chunks entre um
+// passo e outro da câmera, para não pagar um lado inteiro de chunks num quadro só
+#define CHUNK_SETTLE_BUDGET_MS 4.0
+
+// Sem lugar na textura
+#define CHUNK_SLOT_NONE ((size_t)-1)
+
+// Uma redução do chunk: texels escritos a partir do 0 (ver octree_texture_copy)
+typedef struct _chunk_lod {
+    uint8_t *texels;        //NULL = ar
+    size_t count;
+    uint8_t root[4];        //texel-ponteiro da raiz (flags de folha e de ponto, como no .svo)
+} Chunk_Lod;
+
+typedef struct _chunk {
+    IVector3 coord;         //canto mínimo / CHUNK_SIZE
+    Octree *tree;           //residente: caixa [coord * CHUNK_SIZE, + CHUNK_SIZE) (NULL = guardado)
+    Svo_Map *packed;        //guardado (NULL = vazio, ou ainda no disco se 'stored')
+    size_t base, capacity;  //vaga na textura, texels [base, base + capacity)
+    bool dirty;             //texels da vaga desatualizados
+    bool stored;            //o chunk_store tem a versão atual (não vazia)
+    uint64_t used;          //último uso, para o LRU das imagens guardadas
+    Chunk_Lod lod[CHUNK_LOD_LEVELS]; //reduções 2³, 4³ e 8³
+    bool lod_ready;         //'lod' montado (atrasado só pelas células de edit_min..edit_max)
+    int lod_from;           //primeiro nível guardado em 'lod': os mais finos que 'level' são soltos
+    IVector3 edit_min, edit_max; //células editadas desde a última redução (min > max = nenhuma)
+    int level;              //na GPU: 0 = a octree, 1.. = lod[level - 1], -1 = fora da janela
+} Chunk;
+
+typedef struct _chunk_entry {
+    IVector3 coord;
+    Chunk *chunk;           //NULL = posição livre na tabela
+} Chunk_Entry;
+
+// Vaga livre na arena (de um chunk que saiu ou mudou de lugar)
+typedef struct _chunk_hole {
+    size_t base, capacity;
+} Chunk_Hole;
+
+typedef struct _chunk_grid {
+    Chunk_Entry *table;     //endereçamento aberto, capacidade potência de 2
+    size_t table_capacity, count;
+    IVector3 left_bot_back, right_top_front; //limites do mundo: nada é gravado fora deles
+    IVector3 chunk_min, chunk_max;           //chunks existentes (inclusivos)
+    IVector3 center;        //chunk da câmera na última chunk_grid_page
+    int radius;             //-1 = sem paginação: todos residentes e na GPU
+    bool loose;             //edições montaram chunks longe; guardados de novo na próxima chunk_grid_page
+    Chunk_Hole *holes;
+    size_t hole_count, hole_capacity;
+    Chunk **leaving;        //residentes além da faixa, ainda não guardados
+    size_t leaving_count, leaving_capacity;
+    size_t arena_end, arena_limit; //primeiro texel livre depois das vagas e fim da arena (0 = sem textura)
+    bool gpu_dirty;         //diretório da GPU desatualizado
+    Chunk_Store *store;     //chunks que não cabem na memória (NULL = tudo na memória)
+    size_t budget;          //limite de packed_bytes (ver CHUNK_CACHE_BUDGET)
+    size_t packed_bytes;    //imagens guardadas na memória
+    uint64_t tick;
+    IVector3 prefetch_from, prefetch_to; //chunks da câmera e do fim do caminho no último pedido
+    bool prefetch_stale;    //a fila do chunk_store foi trocada desde o último pedido
+    int lod_radius;         //janela na GPU com reduções (<= radius = LOD desligado)
+    float lod_scale;        //pixels por radiano da projeção (altura da tela / (2 tan(fov / 2)))
+    float lod_pixels;       //tamanho aceito na tela: CHUNK_LOD_PIXELS, mais se a janela não couber na textura
+    Chunk **lod_queue;      //chunks esperando reduções (o último é montado primeiro)
+    size_t lod_count, lod_capacity;
+} Chunk_Grid;
+
+Chunk_Grid *chunk_grid_create(IVector3 left_bot_back, IVector3 right_top_front);
+Chunk *chunk_grid_get(Chunk_Grid *grid, IVector3 chunk_coord);
+int chunk_grid_insert(Chunk_Grid *grid, Voxel_Object voxel);
+Voxel_Object chunk_grid_find(Chunk_Grid *grid, IVector3 coord);
+void chunk_grid_remove(Chunk_Grid *grid, IVector3 coord);
+void chunk_grid_fill(Chunk_Grid *grid, IVector3 vox_min, IVector3 vox_max, Voxel_Object voxel);
+void chunk_grid_clear(Chunk_Grid *grid, IVector3 vox_min, IVector3 vox_max);
+Octree *chunk_grid_extract(Chunk_Grid *grid, IVector3 vox_min, IVector3 vox_max);
+bool chunk_grid_paste(Chunk_Grid *grid, Octree *src, const Voxel_Transform *transform, IVector3 src_min, IVector3 src_max);
+bool chunk_grid_ray_cast(Chunk_Grid *grid, Ray ray, Voxel_Object *hit);
+bool chunk_grid_page(Chunk_Grid *grid, IVector3 center, int radius);
+void chunk_grid_set_lod(Chunk_Grid *grid, int radius, float pixels_per_radian);
+bool chunk_grid_attach_store(Chunk_Grid *grid, Chunk_Store *store, size_t budget, bool load_index);
+void chunk_grid_prefetch(Chunk_Grid *grid, Vector3 position, Vector3 velocity);
+bool chunk_grid_save(Chunk_Grid *grid);
+uint8_t *chunk_grid_texture(Chunk_Grid *grid, size_t *arr_size);
+bool chunk_grid_write_texture(Chunk_Grid *grid, uint8_t *texture, size_t texel_capacity,
+                              void (*fn)(void *user, size_t first, size_t count), void *user);
+int32_t *chunk_grid_gpu_buffer(Chunk_Grid *grid, size_t *arr_size);
+Octree *chunk_grid_to_octree(Chunk_Grid *grid, IVector3 left_bot_back, IVector3 right_top_front);
+void chunk_grid_for_each(Chunk_Grid *grid, void (*fn)(void *user, Voxel_Object voxel), void *user);
+bool chunk_grid_compact(Chunk_Grid *grid, double budget_ms);
+bool chunk_grid_is_empty(Chunk_Grid *grid);
+size_t chunk_grid_memory_usage(Chunk_Grid *grid);
+void chunk_grid_delete(Chunk_Grid *grid);
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef _CHUNKSTORE_H
+#define _CHUNKSTORE_H
+
+#include <svoFile.hpp>
+#include <asyncFile.hpp>
+
+extern "C" {
+    #include <vmm/ivec3.h>
+}
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Chunks de um mundo maior que a memória num arquivo só: as imagens .svo de cada chunk
+// (svo_file_encode) anexadas uma depois da outra e, no fim, o índice coordenada -> faixa
+// do arquivo. O cabeçalho só aponta para um índice novo depois de ele estar no disco;
+// uma imagem regravada vai para o fim e a antiga vira espaço morto. Leituras e gravações
+// passam pela fila de um Async_File, com centenas em voo.
+#define CHUNK_STORE_MAGIC "VXCHK\r\n"
+#define CHUNK_STORE_VERSION 1
+// Bytes de imagens esperando gravação; passando disso chunk_store_write espera a fila andar
+#define CHUNK_STORE_WRITE_BYTES (32u << 20)
+// Leituras em voo no máximo (ver Chunk_Store_Options::depth)
+#define CHUNK_STORE_DEPTH ASYNC_FILE_DEPTH
+
+// Cabeçalho no início do arquivo (little-endian)
+typedef struct _chunk_store_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;       //sizeof(Chunk_Store_Header)
+    int32_t bounds_min[3];      //limites do mundo, [min, max)
+    int32_t bounds_max[3];
+    uint32_t chunk_log2;        //lado dos chunks em potência de 2
+    uint32_t entry_count;
+    uint64_t index_offset;
+    uint64_t checksum;          //do índice (ver svo_file_checksum)
+} Chunk_Store_Header;
+
+// Entrada do índice (coordenadas de chunk)
+typedef struct _chunk_store_entry {
+    int32_t coord[3];
+    uint32_t size;
+    uint64_t offset;
+} Chunk_Store_Entry;
+
+// Leitura pedida com chunk_store_request que terminou. 'offset' identifica a versão lida:
+// se o chunk foi regravado enquanto isso, ela não vale mais.
+typedef struct _chunk_store_load {
+    IVector3 coord;
+    uint64_t offset;
+    Svo_Map *map;               //NULL = leitura falhou
+    double ms;                  //do pedido até a imagem estar pronta
+} Chunk_Store_Load;
+
+typedef struct _chunk_store_stats {
+    size_t reads, read_bytes;   //leituras pedidas e as bloqueantes
+    size_t writes, write_bytes;
+    size_t failed;              //imagens ilegíveis
+    size_t dropped;             //pedidos substituídos antes de serem lidos
+    double read_ms, read_ms_max; //soma e pior leitura (do pedido até a imagem pronta)
+    size_t in_flight_max;       //mais operações em voo ao mesmo tempo
+} Chunk_Store_Stats;
+
+// NULL = os padrões (zeros)
+typedef struct _chunk_store_options {
+    Async_File_Backend io;      //ASYNC_FILE_AUTO: io_uring quando o sistema deixa, senão o pool de threads
+    int depth;                  //leituras em voo no máximo (até ASYNC_FILE_DEPTH); 0 = CHUNK_STORE_DEPTH
+} Chunk_Store_Options;
+
+typedef struct _chunk_store Chunk_Store;
+
+Chunk_Store *chunk_store_create(const char *path, IVector3 left_bot_back, IVector3 right_top_front, int chunk_log2,
+                                const Chunk_Store_Options *options);
+Chunk_Store *chunk_store_open(const char *path, const Chunk_Store_Options *options);
+void chunk_store_layout(Chunk_Store *store, IVector3 *left_bot_back, IVector3 *right_top_front, int *chunk_log2);
+bool chunk_store_find(Chunk_Store *store, IVector3 coord, Chunk_Store_Entry *entry);
+void chunk_store_for_each(Chunk_Store *store, void (*fn)(void *user, const Chunk_Store_Entry *entry), void *user);
+bool chunk_store_write(Chunk_Store *store, IVector3 coord, const uint8_t *image, size_t size);
+Svo_Map *chunk_store_read(Chunk_Store *store, IVector3 coord);
+void chunk_store_request(Chunk_Store *store, const Chunk_Store_Entry *entries, size_t count);
+size_t chunk_store_poll(Chunk_Store *store, Chunk_Store_Load *loads, size_t capacity);
+bool chunk_store_flush(Chunk_Store *store);
+Async_File_Backend chunk_store_io(Chunk_Store *store);
+Chunk_Store_Stats chunk_store_stats(Chunk_Store *store);
+void chunk_store_close(Chunk_Store *store);
+
+#endif
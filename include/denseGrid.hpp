@@ -0,0 +1,41 @@
+#ifndef _DENSEGRID_H
+#define _DENSEGRID_H
+
+#include <voxel.hpp>
+#include <palette.hpp>
+
+extern "C" {
+    #include <color.h>
+    #include <vmm/ivec3.h>
+    #include <vmm/ray.h>
+}
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Cada palavra de ocupação cobre um brick de 4x4x4 voxels (64 bits)
+#define DENSE_BRICK_SIZE 4
+#define DENSE_PALETTE_SIZE 256
+
+typedef struct _dense_grid {
+    IVector3 left_bot_back, right_top_front; //limites alinhados a DENSE_BRICK_SIZE
+    IVector3 bricks;                         //dimensão da grade em bricks
+    uint64_t *occupancy;                     //1 bit por voxel, uma palavra por brick
+    uint8_t *materials;                      //índice da paleta por voxel (mesma ordem dos bits)
+    Dense_Material palette[DENSE_PALETTE_SIZE];
+    int palette_count;
+    size_t voxel_count;
+} Dense_Grid;
+
+Dense_Grid *dense_grid_create(IVector3 left_bot_back, IVector3 right_top_front);
+bool dense_grid_contains(Dense_Grid *grid, IVector3 coord);
+int dense_grid_insert(Dense_Grid *grid, Voxel_Object voxel);
+Voxel_Object dense_grid_find(Dense_Grid *grid, IVector3 coord);
+void dense_grid_remove(Dense_Grid *grid, IVector3 coord);
+bool dense_grid_ray_cast(Dense_Grid *grid, Ray ray, Voxel_Object *hit, int *steps);
+uint8_t *dense_grid_texture(Dense_Grid *grid, IVector3 world_min, IVector3 world_max, size_t *arr_size, size_t tex_dim);
+void dense_grid_for_each(Dense_Grid *grid, void (*fn)(void *user, Voxel_Object voxel), void *user);
+size_t dense_grid_memory_usage(Dense_Grid *grid);
+void dense_grid_delete(Dense_Grid *grid);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef _DISTANCEFIELD_H
+#define _DISTANCEFIELD_H
+
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+    #include <vmm/ray.h>
+}
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Campo de distância para pular espaço vazio: a caixa em volta dos voxels é dividida em
+// células de 2^cell_log2 voxels (o menor lado com até DISTANCE_MAX_CELLS células) e cada
+// uma guarda a distância de Chebyshev (em células) até a célula ocupada mais próxima. Com
+// distância d, as células a menos de d dela estão vazias, então a marcha pode atravessar
+// a caixa de (2d - 1)³ células de uma vez. Fora da caixa do campo não há atalho (lá a
+// octree já tem nós vazios grandes).
+// Teto da distância (em células): limita o custo das passadas, a região refeita a cada
+// edição e a folga do campo em volta dos voxels
+#define DISTANCE_MAX 16
+#define DISTANCE_MAX_CELLS (1 << 21)
+// Células de pelo menos 2³ (no shader, log2 = 0 quer dizer sem campo)
+#define DISTANCE_MIN_CELL_LOG2 1
+// Abaixo disto (células da região refeita) o cálculo fica numa thread só
+#define DISTANCE_MIN_CELLS_PER_THREAD 65536
+
+typedef struct _distance_field {
+    IVector3 left_bot_back;        //a célula 0 começa aqui
+    IVector3 right_top_front;      //left_bot_back + cells << cell_log2
+    IVector3 cells;                //células por eixo
+    int cell_log2;
+    uint8_t *occupied;             //0 vazia, 1 pode ter voxel (sobrar nunca faz errar), 2 pendente
+    uint8_t *distance;             //0 = ocupada, senão até DISTANCE_MAX
+    IVector3 dirty_min, dirty_max; //células com ocupação mudada desde o último update (min > max = nenhuma)
+} Distance_Field;
+
+Distance_Field *distance_field_create(IVector3 vox_min, IVector3 vox_max, IVector3 left_bot_back, IVector3 right_top_front);
+bool distance_field_contains(const Distance_Field *field, IVector3 vox_min, IVector3 vox_max);
+void distance_field_mark(Distance_Field *field, IVector3 vox_min, IVector3 vox_max);
+void distance_field_clear(Distance_Field *field, IVector3 vox_min, IVector3 vox_max);
+bool distance_field_is_dirty(const Distance_Field *field);
+bool distance_field_update(Distance_Field *field, bool (*occupied)(void *user, IVector3 vox_min, IVector3 vox_max), void *user,
+                           int threads);
+int distance_field_at(const Distance_Field *field, IVector3 coord);
+float distance_field_skip(const Distance_Field *field, Vector3 pos, Vector3 dir, float footprint, float spread, int *axis);
+int32_t *distance_field_gpu_buffer(const Distance_Field *field, size_t *arr_size);
+size_t distance_field_memory_usage(const Distance_Field *field);
+void distance_field_delete(Distance_Field *field);
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef _FACEBAKE_H
+#define _FACEBAKE_H
+
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+}
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Luz indireta assada por face de voxel: a radiância média que chega na face (a média de
+// muitos caminhos em cosseno, o mesmo que o rebote do shader estima com um raio por
+// quadro), fora o sol direto. Só as faces à mostra existem: cada bloco de 8³ tem uma
+// máscara de faces (bit = célula * 6 + face, faces na ordem de getFaceIndex) e um array
+// com uma cor RGB9E5 por bit ligado, na ordem dos bits.
+#define BAKE_BRICK_LOG2 3
+#define BAKE_BRICK_DIM (1 << BAKE_BRICK_LOG2)
+#define BAKE_BRICK_CELLS (1 << (3 * BAKE_BRICK_LOG2))
+#define BAKE_MASK_WORDS (BAKE_BRICK_CELLS * 6 / 64)
+#define BAKE_UNKNOWN 0xFFFFFFFFu //face ainda não assada (o shader estima ao vivo)
+// Faces assadas por lote (o orçamento de tempo é conferido entre lotes)
+#define BAKE_BATCH_FACES 256
+
+typedef struct _bake_brick {
+    IVector3 origin;                       //canto mínimo (múltiplo de BAKE_BRICK_DIM)
+    uint64_t exposed[BAKE_MASK_WORDS];     //faces guardadas
+    uint64_t dirty[BAKE_MASK_WORDS];       //faces esperando o assador
+    uint16_t before[BAKE_MASK_WORDS];      //faces guardadas nas palavras anteriores
+    uint32_t *faces;                       //RGB9E5 na ordem dos bits de 'exposed'
+    uint32_t count;
+    bool queued;                           //está em Face_Bake::queue
+} Bake_Brick;
+
+typedef struct _face_bake {
+    Bake_Brick **table;  //endereçamento aberto por origem, capacidade potência de 2 (NULL = livre)
+    size_t capacity, count;
+    Bake_Brick **queue;  //blocos com faces sujas, na ordem em que sujaram
+    size_t queue_first, queue_count, queue_capacity;
+    Vector3 sun;         //direção do sol com que foi assado (a luz dele rebatida entra na face)
+    int samples;         //caminhos por face
+    // A face deve ser guardada? Chamada só da thread do mundo.
+    bool (*exposed)(void *user, IVector3 coord, int face);
+    // Radiância média de 'samples' caminhos saindo da face. Chamada de várias threads ao
+    // mesmo tempo: só pode ler o mundo.
+    Vector3 (*trace)(void *user, IVector3 coord, int face, Vector3 sun, int samples, uint64_t seed);
+    void *user;
+    size_t faces;        //faces guardadas
+    size_t dirty;        //faces esperando o assador
+    size_t baked;        //faces assadas no último update
+    bool changed;        //o buffer da GPU mudou desde o último update
+} Face_Bake;
+
+uint32_t face_bake_pack(Vector3 rgb);
+Vector3 face_bake_unpack(uint32_t packed);
+Face_Bake *face_bake_create(Vector3 sun, int samples, bool (*exposed)(void *user, IVector3 coord, int face),
+                            Vector3 (*trace)(void *user, IVector3 coord, int face, Vector3 sun, int samples, uint64_t seed),
+                            void *user);
+void face_bake_touch(Face_Bake *bake, IVector3 vox_min, IVector3 vox_max);
+void face_bake_invalidate(Face_Bake *bake, IVector3 vox_min, IVector3 vox_max, int radius);
+bool face_bake_update(Face_Bake *bake, double budget_ms, int threads);
+bool face_bake_lookup(const Face_Bake *bake, IVector3 coord, int face, Vector3 *rgb);
+int32_t *face_bake_gpu_buffer(const Face_Bake *bake, size_t *arr_size);
+uint8_t *face_bake_encode(const Face_Bake *bake, size_t *size);
+Face_Bake *face_bake_decode(const uint8_t *image, size_t size, bool (*exposed)(void *user, IVector3 coord, int face),
+                            Vector3 (*trace)(void *user, IVector3 coord, int face, Vector3 sun, int samples, uint64_t seed),
+                            void *user);
+size_t face_bake_memory_usage(const Face_Bake *bake);
+void face_bake_delete(Face_Bake *bake);
+
+#endif
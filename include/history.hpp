@@ -0,0 +1,56 @@
+#ifndef _HISTORY_H
+#define _HISTORY_H
+
+#include <voxel.hpp>
+#include <octree.hpp>
+#include <instances.hpp>
+#include <world.hpp>
+#include <journal.hpp>
+
+extern "C" {
+    #include <vmm/ivec3.h>
+}
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Desfazer/refazer. Cada ação guarda só o que mudou: a célula antes e depois numa edição
+// de voxel, e as subárvores da caixa afetada numa operação de região (ver world_copy_region),
+// então desfazer ou refazer custa o mesmo que a operação. As ações mais antigas saem
+// quando a memória passa do limite.
+#define HISTORY_MAX_BYTES (64u << 20)
+
+enum History_Kind {
+    HISTORY_VOXEL,   //uma célula
+    HISTORY_FILL,    //caixa preenchida com um material
+    HISTORY_REGION   //caixa com conteúdo qualquer (colagem)
+};
+
+typedef struct _history_action {
+    History_Kind kind;
+    IVector3 min, max;          //caixa afetada (inclusiva); na edição de voxel, a célula
+    Voxel_Object before, after; //HISTORY_VOXEL: célula (coord.y == MIN_HEIGHT: ar); HISTORY_FILL: after = material
+    Octree *region_before;      //HISTORY_FILL/HISTORY_REGION: caixa antes, com a origem em min
+    Octree *region_after;       //HISTORY_REGION: caixa depois
+    size_t bytes;
+} History_Action;
+
+typedef struct _history {
+    History_Action *actions;    //anel, da mais antiga (actions[first]) para a mais nova
+    size_t first, count, capacity;
+    size_t applied;             //[0, applied) podem ser desfeitas, [applied, count) refeitas
+    size_t bytes, max_bytes;
+    Journal *journal;           //desfazer e refazer também vão para o diário (NULL = nenhum)
+} History;
+
+History *history_create(size_t max_bytes, Journal *journal);
+void history_insert(History *history, World *world, Voxel_Object voxel);
+void history_remove(History *history, World *world, IVector3 coord);
+bool history_fill(History *history, World *world, IVector3 vox_min, IVector3 vox_max, Voxel_Object voxel);
+bool history_paste(History *history, World *world, Octree *clip, Voxel_Transform transform);
+bool history_undo(History *history, World *world);
+bool history_redo(History *history, World *world);
+size_t history_memory_usage(History *history);
+void history_delete(History *history);
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef _INSTANCES_H
+#define _INSTANCES_H
+
+#include <voxel.hpp>
+#include <octree.hpp>
+
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/ray.h>
+}
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Folhas da BVH com até este número de instâncias
+#define INSTANCE_BVH_LEAF 2
+// Refit deixa a BVH pior a cada movimento; acima deste custo (em relação ao da última
+// construção) ela é reconstruída
+#define INSTANCE_BVH_REBUILD_RATIO 1.5f
+// Rotações do cubo sem espelho (ver voxel_transform_rotation)
+#define VOXEL_ROTATIONS 24
+
+// Transformação afim de voxels: rotação inteira (uma das 24 do cubo, ou espelhada) e
+// translação. Um ponto local p vai para rot * p + translation; a célula local c vai para
+// a célula cuja caixa é a imagem de [c, c + 1) (ver voxel_transform_cell).
+typedef struct _voxel_transform {
+    int rot[3][3];
+    IVector3 translation;
+} Voxel_Transform;
+
+// Referência a um modelo compartilhado: a octree do modelo é montada uma vez e cada
+// instância guarda só a transformação
+typedef struct _voxel_instance {
+    Octree *model;
+    Voxel_Transform transform;
+    IVector3 local_min, local_max; //voxels ocupados do modelo (inclusivos)
+    int32_t gpu_root;              //texel da raiz do modelo na última textura (-1 = fora dela)
+} Voxel_Instance;
+
+// Nó da BVH, no mesmo formato do buffer lido pelo shader (dois ivec4 no std430).
+// Caixa em células do mundo, [min, max). Folha: 'count' instâncias a partir de
+// order[first]; nó interno: count = 0 e os filhos são first e first + 1.
+typedef struct _instance_bvh_node {
+    int32_t min[3];
+    int32_t first;
+    int32_t max[3];
+    int32_t count;
+} Instance_BVH_Node;
+
+// Nível de cima: instâncias que não caem alinhadas num nó da octree do mundo (ou que
+// se movem) sob uma BVH. Onde duas se sobrepõem, a adicionada por último vence.
+typedef struct _instance_set {
+    Voxel_Instance *items;
+    size_t count, capacity;
+    Instance_BVH_Node *nodes;
+    uint32_t *order;     //índices de 'items' na ordem das folhas
+    size_t node_count;
+    bool needs_build;    //instâncias entraram ou saíram
+    bool needs_refit;    //só transformações mudaram
+    float built_cost;    //custo (soma das áreas) da BVH logo depois de construída
+    bool gpu_dirty;      //BVH ou raízes mudaram depois do último instance_set_gpu_buffer
+} Instance_Set;
+
+Voxel_Transform voxel_transform_identity(void);
+Voxel_Transform voxel_transform_translation(IVector3 offset);
+IVector3 voxel_transform_cell(const Voxel_Transform *transform, IVector3 local);
+IVector3 voxel_transform_local_cell(const Voxel_Transform *transform, IVector3 cell);
+Voxel_Transform voxel_transform_rotation(int index);
+Voxel_Transform voxel_transform_place(int rotation, IVector3 size, IVector3 offset);
+Ray voxel_transform_local_ray(const Voxel_Transform *transform, Ray ray);
+
+Instance_Set *instance_set_create(void);
+long instance_set_add(Instance_Set *set, Octree *model, Voxel_Transform transform);
+bool instance_set_move(Instance_Set *set, size_t index, Voxel_Transform transform);
+bool instance_set_replace(Instance_Set *set, size_t index, Octree *model);
+bool instance_set_remove(Instance_Set *set, size_t index);
+bool instance_set_update(Instance_Set *set);
+Voxel_Object instance_set_find(Instance_Set *set, IVector3 coord);
+bool instance_set_ray_cast(Instance_Set *set, Ray ray, Voxel_Object *hit, float *distance);
+bool instance_set_detach(Instance_Set *set, IVector3 coord, void (*fn)(void *user, Voxel_Object voxel), void *user);
+void instance_set_for_each(Instance_Set *set, void (*fn)(void *user, Voxel_Object voxel), void *user);
+bool instance_set_append_texture(Instance_Set *set, uint8_t **texture, size_t *arr_size);
+int32_t *instance_set_gpu_buffer(Instance_Set *set, size_t *arr_size);
+size_t instance_set_memory_usage(Instance_Set *set);
+void instance_set_delete(Instance_Set *set);
+
+#endif
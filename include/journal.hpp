@@ -0,0 +1,69 @@
+#ifndef _JOURNAL_H
+#define _JOURNAL_H
+
+#include <voxel.hpp>
+#include <octree.hpp>
+#include <instances.hpp>
+#include <world.hpp>
+
+extern "C" {
+    #include <vmm/ivec3.h>
+}
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Diário de edições: cada edição do jogador vira um registro de 48 bytes, anexado ao
+// arquivo por uma thread própria em grupos (um write + um fsync por grupo). De tempos em
+// tempos a thread de checkpoint aplica o diário fechado sobre o último snapshot (.svo) e
+// grava um snapshot novo, então a recuperação nunca relê mais que ~2 checkpoints de edições.
+// Operações de região guardam o conteúdo da caixa como um .svo em <diário>.regions/.
+#define JOURNAL_MAGIC 0x4c4e524a  //"JRNL"
+#define JOURNAL_INSERT 1
+#define JOURNAL_REMOVE 2
+#define JOURNAL_FILL 3            //caixa inteira com um material (ver world_fill)
+#define JOURNAL_REGION 4          //caixa inteira passa a ser o conteúdo de um .svo (0 = ar)
+// Padrões de journal_open
+#define JOURNAL_SYNC_MS 100.0
+#define JOURNAL_SYNC_BYTES (256u << 10)
+#define JOURNAL_CHECKPOINT_BYTES (8u << 20)
+
+// Registro como gravado no arquivo (little-endian). Material exato, como em world_insert.
+typedef struct _journal_record {
+    int32_t coord[3];       //célula, ou canto mínimo da caixa
+    uint32_t op;
+    int32_t max[3];         //JOURNAL_FILL/JOURNAL_REGION: canto máximo (inclusivo)
+    uint32_t region;        //JOURNAL_REGION: arquivo <diário>.regions/<region>.svo
+    ColorRGBA color;        //JOURNAL_INSERT/JOURNAL_FILL
+    float refraction, illumination, k;
+} Journal_Record;
+
+// Cabeçalho de cada grupo; um grupo com checksum errado (escrita cortada por uma queda)
+// encerra a leitura
+typedef struct _journal_group {
+    uint32_t magic;
+    uint32_t count;
+    uint64_t checksum;      //dos registros do grupo (ver svo_file_checksum)
+} Journal_Group;
+
+typedef struct _journal_stats {
+    size_t records, groups, syncs, checkpoints;
+    size_t errors;          //escritas de grupo (ou das regiões dele) que falharam
+    size_t journal_bytes;   //no arquivo aberto, desde o último checkpoint
+    double checkpoint_ms;   //último checkpoint
+} Journal_Stats;
+
+typedef struct _journal Journal;
+
+size_t journal_replay(World *world, const char *path);
+Journal *journal_open(World *world, const char *path, const char *snapshot_path,
+                      double sync_ms, size_t sync_bytes, size_t checkpoint_bytes);
+void journal_insert(Journal *journal, Voxel_Object voxel);
+void journal_remove(Journal *journal, IVector3 coord);
+void journal_fill(Journal *journal, IVector3 vox_min, IVector3 vox_max, Voxel_Object voxel);
+void journal_region(Journal *journal, IVector3 vox_min, IVector3 vox_max, Octree *content);
+bool journal_flush(Journal *journal);
+Journal_Stats journal_stats(Journal *journal);
+void journal_close(Journal *journal);
+
+#endif
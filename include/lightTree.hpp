@@ -0,0 +1,71 @@
+#ifndef _LIGHTTREE_H
+#define _LIGHTTREE_H
+
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+}
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Árvore de luzes (Conty & Kulla, "Importance Sampling of Many Lights with Adaptive Tree
+// Splitting"): os voxels emissivos numa BVH em que cada nó guarda caixa, potência e um
+// cone com as normais das faces que emitem. O sorteio desce da raiz escolhendo cada filho
+// pela importância dele para o ponto (potência / distância², cortada pelos cones), então
+// fontes perto e de frente ganham mais amostras que as longe ou de costas.
+#define LIGHT_TREE_BUCKETS 12 //divisões testadas por eixo na construção
+
+// Estratégia da estimativa de próximo evento das fontes no traçador da CPU (ver world_trace_face)
+enum Light_Sampling {
+    LIGHT_SAMPLING_TREE,    //pela árvore, combinada com os raios que batem nas fontes (MIS)
+    LIGHT_SAMPLING_UNIFORM, //qualquer fonte com a mesma chance, também com MIS
+    LIGHT_SAMPLING_NONE     //só os raios que batem nas fontes
+};
+
+typedef struct _tree_light {
+    IVector3 coord;
+    Vector3 radiance;  //de cada face (cor * iluminação * 10 / PI, como o shader)
+    uint8_t faces;     //faces que emitem (bit = ordem de getFaceIndex)
+    uint64_t trail;    //caminho da raiz até a folha (bit d: segundo filho na profundidade d)
+} Tree_Light;
+
+typedef struct _light_bounds {
+    Vector3 min, max;   //caixa em unidades de voxel
+    float phi;          //potência (luminância * área * PI; 0 = nada)
+    Vector3 w;          //eixo do cone das normais
+    float cos_theta_o;  //abertura do cone das normais (-1 = todas as direções)
+    float cos_theta_e;  //além das normais, até onde emite (0 = faces lambertianas)
+} Light_Bounds;
+
+// Pré-ordem: o primeiro filho é o nó seguinte
+typedef struct _light_tree_node {
+    Light_Bounds bounds;
+    int32_t second;  //nó interno: índice do segundo filho
+    int32_t light;   //folha: índice em lights (-1 = nó interno)
+} Light_Tree_Node;
+
+typedef struct _light_tree {
+    Tree_Light *lights;
+    size_t count, capacity;
+    int32_t *slots;          //coordenada -> índice em lights, endereçamento aberto (-1 = livre)
+    size_t slot_capacity;
+    Light_Tree_Node *nodes;
+    size_t node_count, node_capacity;
+    bool needs_build;        //fontes entraram ou saíram
+    bool needs_refit;        //só cor ou faces mudaram
+} Light_Tree;
+
+Light_Tree *light_tree_create(void);
+bool light_tree_set(Light_Tree *tree, IVector3 coord, Vector3 radiance, uint8_t faces);
+bool light_tree_remove(Light_Tree *tree, IVector3 coord);
+const Tree_Light *light_tree_find(const Light_Tree *tree, IVector3 coord);
+bool light_tree_update(Light_Tree *tree);
+float light_bounds_importance(const Light_Bounds *bounds, Vector3 p, Vector3 n);
+const Tree_Light *light_tree_sample(const Light_Tree *tree, Vector3 p, Vector3 n, float u, float *pmf);
+float light_tree_pmf(const Light_Tree *tree, Vector3 p, Vector3 n, IVector3 coord);
+const Tree_Light *light_tree_sample_uniform(const Light_Tree *tree, float u, float *pmf);
+size_t light_tree_memory_usage(const Light_Tree *tree);
+void light_tree_delete(Light_Tree *tree);
+
+#endif
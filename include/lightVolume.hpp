@@ -0,0 +1,61 @@
+#ifndef _LIGHTVOLUME_H
+#define _LIGHTVOLUME_H
+
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <color.h>
+}
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Luz dos voxels emissivos espalhada pelo espaço vazio, no estilo da luz de bloco do
+// Minecraft com cor: cada célula guarda um nível de 0 a LIGHT_MAX por canal, que cai
+// 1 por passo (vizinhos de face) e não atravessa voxels opacos (alfa 255). O nível de
+// uma fonte é LIGHT_MAX * illumination * cor. Só as células com luz existem, em blocos
+// de 8³ numa tabela hash; cada edição refaz só o que a luz que passava por ela alcançava.
+#define LIGHT_MAX 31               //5 bits por canal (R | G << 5 | B << 10)
+#define LIGHT_BRICK_LOG2 3
+#define LIGHT_BRICK_DIM (1 << LIGHT_BRICK_LOG2)
+#define LIGHT_BRICK_CELLS (1 << (3 * LIGHT_BRICK_LOG2))
+#define LIGHT_BRICK_WORDS (LIGHT_BRICK_CELLS / 2) //ints por bloco no buffer da GPU
+
+typedef struct _light_brick {
+    IVector3 origin;                           //canto mínimo (múltiplo de LIGHT_BRICK_DIM)
+    uint16_t light[LIGHT_BRICK_CELLS];         //x mais rápido
+    uint16_t *emission;                        //nível próprio das fontes (NULL = nenhuma no bloco)
+    uint64_t opaque[LIGHT_BRICK_CELLS / 64];
+    int lit;                                   //células com luz
+} Light_Brick;
+
+typedef struct _light_node {
+    IVector3 coord;
+    uint16_t light; //na fila de remoção: os canais que saíram
+} Light_Node;
+
+typedef struct _light_queue {
+    Light_Node *items;
+    size_t first, count, capacity;
+} Light_Queue;
+
+typedef struct _light_volume {
+    Light_Brick **table;   //endereçamento aberto por origem, capacidade potência de 2 (NULL = livre)
+    size_t capacity, count;
+    bool (*opaque)(void *user, IVector3 coord); //estado atual do mundo, para blocos novos
+    void *user;
+    Light_Queue removals, additions;            //edições ainda não espalhadas (ver light_volume_update)
+    size_t visited;                             //células tiradas das filas no último update
+} Light_Volume;
+
+Light_Volume *light_volume_create(bool (*opaque)(void *user, IVector3 coord), void *user);
+uint16_t light_volume_emission(ColorRGBA color, float illumination);
+void light_volume_set(Light_Volume *volume, IVector3 coord, bool opaque, uint16_t emission);
+bool light_volume_is_dirty(const Light_Volume *volume);
+bool light_volume_update(Light_Volume *volume);
+uint16_t light_volume_at(const Light_Volume *volume, IVector3 coord);
+void light_volume_prune(Light_Volume *volume);
+int32_t *light_volume_gpu_buffer(const Light_Volume *volume, size_t *arr_size);
+size_t light_volume_memory_usage(const Light_Volume *volume);
+void light_volume_delete(Light_Volume *volume);
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef _OBJECTS_H
+#define _OBJECTS_H
+
+#include <voxel.hpp>
+#include <octree.hpp>
+#include <instances.hpp>
+
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/ray.h>
+}
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Folga de cada vaga na textura: o modelo editado pode crescer até aqui sem mudar de lugar
+#define OBJECT_SLOT_SLACK 1.25f
+// Texels livres reservados depois das vagas, para modelos novos (quadros de animação)
+// entrarem sem reenviar a textura inteira
+#define OBJECT_ARENA_RESERVE 65536
+
+// Sem lugar na textura ainda
+#define OBJECT_SLOT_NONE ((size_t)-1)
+
+// Vaga de um modelo na textura: texels [base, base + capacity). Com users = 0 é um
+// buraco que pode ser reaproveitado por outro modelo que caiba nele.
+typedef struct _object_slot {
+    Octree *model;
+    size_t base, capacity;
+    int users;  //objetos usando o modelo
+    bool dirty; //texels ainda não gravados
+} Object_Slot;
+
+typedef struct _dynamic_object {
+    long instance; //índice em Object_Layer::set (-1 = id livre)
+    long slot;     //vaga do modelo em Object_Layer::slots
+} Dynamic_Object;
+
+// Objetos dinâmicos: modelos rígidos com octree própria e transformação trocada a cada
+// quadro, por cima do mundo estático. Os ids não mudam quando outros objetos saem.
+// Mover custa O(objetos) (refit da BVH e o buffer dela); trocar ou editar o modelo
+// regrava só a vaga dele na textura.
+typedef struct _object_layer {
+    Instance_Set *set;
+    Dynamic_Object *objects;
+    size_t object_count, object_capacity;
+    Object_Slot *slots;
+    size_t slot_count, slot_capacity;
+    size_t arena_end; //primeiro texel livre depois das vagas (0 = sem textura)
+} Object_Layer;
+
+Object_Layer *object_layer_create(void);
+long object_layer_add(Object_Layer *layer, Octree *model, Voxel_Transform transform);
+bool object_layer_move(Object_Layer *layer, long id, Voxel_Transform transform);
+bool object_layer_set_model(Object_Layer *layer, long id, Octree *model);
+bool object_layer_remove(Object_Layer *layer, long id);
+Voxel_Object object_layer_find(Object_Layer *layer, IVector3 coord);
+bool object_layer_ray_cast(Object_Layer *layer, Ray ray, Voxel_Object *hit, float *distance);
+bool object_layer_append_texture(Object_Layer *layer, uint8_t **texture, size_t *arr_size);
+bool object_layer_write_texture(Object_Layer *layer, uint8_t *texture, size_t texel_capacity,
+                                void (*fn)(void *user, size_t first, size_t count), void *user);
+int32_t *object_layer_gpu_buffer(Object_Layer *layer, size_t *arr_size);
+size_t object_layer_memory_usage(Object_Layer *layer);
+void object_layer_delete(Object_Layer *layer);
+
+#endif
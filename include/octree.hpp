@@ -15,18 +15,56 @@ extern "C" {
 typedef struct _octree {
     Voxel_Object voxel;
     bool has_voxel;
+    bool is_point; //folha com um único voxel em voxel.coord (o resto da caixa é ar)
+    bool dirty;    //subárvore editada desde a última octree_compact
     struct _octree **children, *parent; //always either NULL or with 8 member/
+    struct _octree *instance; //subárvore compartilhada no lugar dos filhos (caixa [0, tamanho do nó))
+    int shares;               //só na raiz compartilhada: donos além do primeiro
     IVector3 left_bot_back, right_top_front; //bounding box min and max;
 } Octree;
 
+// Contadores opcionais das travessias de raio (usados pelos benchmarks)
+typedef struct _ray_stats {
+    int steps;   // avanços do raio (células vazias atravessadas + o acerto)
+    int fetches; // nós visitados (equivale às leituras de textura no shader)
+} Ray_Stats;
+
+struct _voxel_transform; //instances.hpp
+
+Voxel_Object _invalid_voxel(void);
+
 Octree *octree_new(void);
 Octree *octree_create(Octree *parent, IVector3 left_bot_back, IVector3 right_top_front);
 void octree_insert(Octree *tree, Voxel_Object voxel);
 Voxel_Object octree_find(Octree *tree, IVector3 coord);
 Octree *octree_ray_cast(Octree *root, Ray ray, Vector3 box_min, Vector3 box_max);
+Octree *octree_ray_cast_stats(Octree *root, Ray ray, Vector3 box_min, Vector3 box_max, Ray_Stats *stats);
+bool octree_ray_cast_voxel(Octree *root, Ray ray, Vector3 box_min, Vector3 box_max, Voxel_Object *hit);
 uint8_t *octree_texture(Octree *tree, size_t *arr_size, size_t tex_dim);
+size_t octree_texture_write(Octree *tree, uint8_t *texture, size_t base);
+size_t octree_texture_copy(const uint8_t *texels, size_t texel_count, const uint8_t *root, uint8_t *texture, size_t base);
 size_t _octree_texel_size(Octree *tree);
+void octree_leaf_texels(Voxel_Object voxel, uint8_t *out);
+Voxel_Object octree_leaf_voxel(const uint8_t *texels);
+Octree *octree_from_texture(const uint8_t *texture, size_t texel_count, const uint8_t *root,
+                            IVector3 left_bot_back, IVector3 right_top_front,
+                            Voxel_Object (*material)(void *user, const uint8_t *leaf), void *user);
 void octree_remove(Octree *tree, IVector3 coord);
+bool octree_compact(Octree *tree, double budget_ms);
+void octree_merge(Octree *dst, Octree *src);
+Octree *octree_clone(Octree *tree);
+bool octree_paste(Octree *dst, Octree *src, const struct _voxel_transform *transform, IVector3 src_min, IVector3 src_max);
+Octree *octree_extract(Octree *tree, IVector3 vox_min, IVector3 vox_max);
+void octree_fill(Octree *tree, IVector3 vox_min, IVector3 vox_max, Voxel_Object voxel);
+void octree_clear(Octree *tree, IVector3 vox_min, IVector3 vox_max);
+Octree *octree_downsample(Octree *tree, int cell);
+void octree_downsample_region(Octree *dst, Octree *src, int cell, IVector3 vox_min, IVector3 vox_max);
+bool octree_node_box(Octree *tree, IVector3 vox_min, IVector3 vox_max, IVector3 *box_min, IVector3 *box_max);
+bool octree_set_instance(Octree *tree, IVector3 left_bot_back, Octree *shared);
+bool octree_bounds(Octree *tree, IVector3 *vox_min, IVector3 *vox_max);
+size_t octree_memory_usage(Octree *tree);
+void octree_for_each(Octree *tree, void (*fn)(void *user, Voxel_Object voxel), void *user);
+void octree_for_each_box(Octree *tree, void (*fn)(void *user, IVector3 vox_min, IVector3 vox_max), void *user);
 void octree_delete(Octree *tree);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,30 @@
+#ifndef _PALETTE_H
+#define _PALETTE_H
+
+#include <voxel.hpp>
+
+extern "C" {
+    #include <color.h>
+}
+
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef struct _dense_material {
+    ColorRGBA color;
+    Voxel voxel;
+} Dense_Material;
+
+// Paleta de materiais que cresce sob demanda (índices de 16 bits nas estruturas esparsas)
+typedef struct _voxel_palette {
+    Dense_Material *entries;
+    int count, capacity, max_count;
+    int last; //último índice devolvido (voxels vizinhos quase sempre repetem o material)
+} Voxel_Palette;
+
+void palette_init(Voxel_Palette *palette, int max_count);
+int palette_index(Voxel_Palette *palette, ColorRGBA color, Voxel voxel);
+size_t palette_memory_usage(Voxel_Palette *palette);
+void palette_free(Voxel_Palette *palette);
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef _SPARSEGRID_H
+#define _SPARSEGRID_H
+
+#include <voxel.hpp>
+#include <octree.hpp>
+#include <palette.hpp>
+
+extern "C" {
+    #include <color.h>
+    #include <vmm/ivec3.h>
+    #include <vmm/ray.h>
+}
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Hierarquia no estilo OpenVDB (5-4-3): raiz com tabela hash de nós superiores de 32³
+// nós inferiores, cada um com 16³ folhas densas de 8³ voxels. Cada nó superior cobre 4096³.
+#define SPARSE_LEAF_LOG2 3
+#define SPARSE_LOWER_LOG2 4
+#define SPARSE_UPPER_LOG2 5
+
+#define SPARSE_LEAF_DIM (1 << SPARSE_LEAF_LOG2)
+#define SPARSE_LEAF_VOXELS (1 << (3 * SPARSE_LEAF_LOG2))
+#define SPARSE_LOWER_CHILDREN (1 << (3 * SPARSE_LOWER_LOG2))
+#define SPARSE_UPPER_CHILDREN (1 << (3 * SPARSE_UPPER_LOG2))
+
+// Lado (em voxels) coberto por cada tipo de nó
+#define SPARSE_LOWER_DIM (SPARSE_LEAF_DIM << SPARSE_LOWER_LOG2)
+#define SPARSE_UPPER_DIM (SPARSE_LOWER_DIM << SPARSE_UPPER_LOG2)
+
+#define SPARSE_PALETTE_MAX 65536
+
+typedef struct _sparse_leaf {
+    uint64_t mask[SPARSE_LEAF_VOXELS / 64];
+    uint16_t materials[SPARSE_LEAF_VOXELS]; //índice da paleta (mesma ordem dos bits)
+    int count;
+} Sparse_Leaf;
+
+typedef struct _sparse_lower {
+    uint64_t mask[SPARSE_LOWER_CHILDREN / 64];
+    Sparse_Leaf *children[SPARSE_LOWER_CHILDREN];
+} Sparse_Lower;
+
+typedef struct _sparse_upper {
+    uint64_t mask[SPARSE_UPPER_CHILDREN / 64];
+    Sparse_Lower *children[SPARSE_UPPER_CHILDREN];
+} Sparse_Upper;
+
+typedef struct _sparse_root_entry {
+    IVector3 origin;    //canto mínimo do nó superior (múltiplo de SPARSE_UPPER_DIM)
+    Sparse_Upper *node; //NULL = posição livre na tabela
+} Sparse_Root_Entry;
+
+typedef struct _sparse_grid {
+    Sparse_Root_Entry *root; //endereçamento aberto, capacidade potência de 2
+    size_t root_capacity, root_count;
+    Voxel_Palette palette;
+    IVector3 bbox_min, bbox_max; //limites (inclusivos) de tudo que já foi inserido
+    size_t voxel_count, leaf_count, lower_count;
+    size_t emptied;     //folhas que ficaram vazias desde o último sparse_grid_prune
+} Sparse_Grid;
+
+// Cache do último caminho raiz->folha. Acessos coerentes (varreduras, vizinhos)
+// resolvem a folha sem passar pela tabela hash.
+typedef struct _sparse_accessor {
+    Sparse_Grid *grid;
+    IVector3 upper_origin, lower_origin, leaf_origin;
+    Sparse_Upper *upper;
+    Sparse_Lower *lower;
+    Sparse_Leaf *leaf;
+} Sparse_Accessor;
+
+Sparse_Grid *sparse_grid_create(void);
+int sparse_grid_insert(Sparse_Grid *grid, Voxel_Object voxel);
+Voxel_Object sparse_grid_find(Sparse_Grid *grid, IVector3 coord);
+void sparse_grid_remove(Sparse_Grid *grid, IVector3 coord);
+bool sparse_grid_ray_cast(Sparse_Grid *grid, Ray ray, Voxel_Object *hit, Ray_Stats *stats);
+void sparse_grid_prune(Sparse_Grid *grid);
+size_t sparse_grid_count_outside(Sparse_Grid *grid, IVector3 min, IVector3 max);
+uint8_t *sparse_grid_texture(Sparse_Grid *grid, IVector3 world_min, IVector3 world_max, size_t *arr_size, size_t tex_dim);
+void sparse_grid_for_each(Sparse_Grid *grid, void (*fn)(void *user, Voxel_Object voxel), void *user);
+size_t sparse_grid_memory_usage(Sparse_Grid *grid);
+void sparse_grid_delete(Sparse_Grid *grid);
+
+// Válido até o próximo sparse_grid_prune/sparse_grid_delete (remover voxels não libera nós)
+Sparse_Accessor sparse_grid_accessor(Sparse_Grid *grid);
+int sparse_accessor_insert(Sparse_Accessor *acc, Voxel_Object voxel);
+Voxel_Object sparse_accessor_find(Sparse_Accessor *acc, IVector3 coord);
+
+#endif
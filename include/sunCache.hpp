@@ -0,0 +1,59 @@
+#ifndef _SUNCACHE_H
+#define _SUNCACHE_H
+
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+}
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Visibilidade do sol por face de voxel, calculada na CPU e lida pelo shader no lugar do
+// raio de sombra. As faces seguem a ordem de getFaceIndex no shader (+X, -X, +Y, -Y, +Z,
+// -Z). Cada voxel tem 6 bits de "calculada" e 6 de "vê o sol"; uma face não calculada
+// (edição ainda não refeita, sol mudando, voxel de instância) volta para o raio de sombra.
+// Os voxels ficam em blocos de 8³ numa tabela hash, só onde há voxels.
+#define SUN_BRICK_LOG2 3
+#define SUN_BRICK_DIM (1 << SUN_BRICK_LOG2)
+#define SUN_BRICK_CELLS (1 << (3 * SUN_BRICK_LOG2))
+#define SUN_BRICK_WORDS (SUN_BRICK_CELLS / 2) //ints por bloco no buffer da GPU
+#define SUN_FACE_COMPUTED(face) (1u << (face))
+#define SUN_FACE_LIT(face) (1u << (6 + (face)))
+// Voxels calculados por lote (o orçamento de tempo é conferido entre lotes)
+#define SUN_BATCH_CELLS 1024
+// Sóis mais próximos que isto (1 - cosseno) usam o mesmo cache, aqui e no shader
+#define SUN_SAME_DIRECTION 1e-6f
+
+typedef struct _sun_brick {
+    IVector3 origin;                  //canto mínimo (múltiplo de SUN_BRICK_DIM)
+    uint16_t faces[SUN_BRICK_CELLS];  //x mais rápido
+    uint64_t dirty[SUN_BRICK_CELLS / 64];
+    bool queued;                      //está em Sun_Cache::queue
+} Sun_Brick;
+
+typedef struct _sun_cache {
+    Sun_Brick **table;   //endereçamento aberto por origem, capacidade potência de 2 (NULL = livre)
+    size_t capacity, count;
+    Sun_Brick **queue;   //blocos com voxels sujos, na ordem em que sujaram
+    size_t queue_first, queue_count, queue_capacity;
+    Vector3 direction;   //para o sol, normalizada
+    // Bits de um voxel (SUN_FACE_COMPUTED/SUN_FACE_LIT; 0 = sem voxel). Chamada de várias
+    // threads ao mesmo tempo: só pode ler o mundo.
+    uint16_t (*faces)(void *user, IVector3 coord, Vector3 sun);
+    void *user;
+    size_t dirty;        //voxels esperando cálculo
+    size_t computed;     //voxels calculados no último update
+} Sun_Cache;
+
+Sun_Cache *sun_cache_create(Vector3 direction, uint16_t (*faces)(void *user, IVector3 coord, Vector3 sun), void *user);
+bool sun_cache_set_direction(Sun_Cache *cache, Vector3 direction);
+void sun_cache_touch(Sun_Cache *cache, IVector3 vox_min, IVector3 vox_max);
+void sun_cache_invalidate(Sun_Cache *cache, IVector3 vox_min, IVector3 vox_max);
+bool sun_cache_update(Sun_Cache *cache, double budget_ms, int threads);
+int sun_cache_lookup(const Sun_Cache *cache, IVector3 coord, int face);
+int32_t *sun_cache_gpu_buffer(const Sun_Cache *cache, size_t *arr_size);
+size_t sun_cache_memory_usage(const Sun_Cache *cache);
+void sun_cache_delete(Sun_Cache *cache);
+
+#endif
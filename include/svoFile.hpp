@@ -0,0 +1,81 @@
+#ifndef _SVO_FILE_H
+#define _SVO_FILE_H
+
+#include <voxel.hpp>
+#include <octree.hpp>
+#include <distanceField.hpp>
+
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/ray.h>
+}
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Mundo nativo: a textura da octree exatamente como o shader lê (ver octree_texture_write),
+// mais a tabela de materiais e os limites. Carregar é só mapear o arquivo.
+#define SVO_FILE_MAGIC "VXSVO\r\n"
+// Versão 2: nós internos com a média da subárvore (ver octree_texture_write)
+#define SVO_FILE_VERSION 2
+// Os texels começam alinhados à página (o mapeamento pode ir direto para o upload)
+#define SVO_FILE_ALIGN 4096
+
+// Cabeçalho no início do arquivo (little-endian, como a textura)
+typedef struct _svo_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;       //sizeof(Svo_File_Header)
+    int32_t bounds_min[3];      //caixa da raiz, [min, max)
+    int32_t bounds_max[3];
+    uint8_t root[4];            //texel-ponteiro da raiz (ver octree_from_texture)
+    uint32_t material_count;
+    uint64_t material_offset;
+    uint64_t texel_offset;
+    uint64_t texel_count;
+    uint64_t checksum;          //dos materiais e dos texels (ver svo_file_checksum)
+} Svo_File_Header;
+
+// Material exato de uma folha, indexado pelos 2 texels dela. A tabela é gravada ordenada
+// por 'texels' (como uint64_t), então a busca é binária direto no arquivo mapeado.
+typedef struct _svo_material {
+    uint8_t texels[8];
+    ColorRGBA color;
+    Voxel voxel;
+} Svo_Material;
+
+// Arquivo aberto (somente leitura). As consultas percorrem os texels mapeados, sem
+// montar a octree; svo_map_to_octree monta quando for preciso editar.
+typedef struct _svo_map {
+    const uint8_t *data;
+    size_t size;
+    void *mapped;               //NULL = lido para 'data' com malloc
+#ifdef _WIN32
+    void *file, *mapping;
+#endif
+    const Svo_File_Header *header;
+    const uint8_t *texels;
+    size_t texel_count;
+    const Svo_Material *materials;
+    uint32_t material_count;
+    IVector3 left_bot_back, right_top_front;
+    const Distance_Field *distance; //atalhos de svo_map_ray_cast_cone (NULL = nenhum; ver world_update_distance)
+} Svo_Map;
+
+uint64_t svo_file_checksum(uint64_t hash, const uint8_t *data, size_t size);
+bool svo_file_write(const char *path, Octree *tree);
+uint8_t *svo_file_encode(Octree *tree, size_t *size);
+bool svo_file_write_image(const char *path, const uint8_t *image, size_t size);
+
+Svo_Map *svo_map_open(const char *path, bool verify);
+Svo_Map *svo_map_from_memory(uint8_t *image, size_t size, bool verify);
+Voxel_Object svo_map_find(Svo_Map *map, IVector3 coord);
+bool svo_map_ray_cast(Svo_Map *map, Ray ray, Voxel_Object *hit);
+bool svo_map_ray_cast_cone(Svo_Map *map, Ray ray, float width, float spread, Voxel_Object *hit, Ray_Stats *stats);
+void svo_map_for_each_box(Svo_Map *map, void (*fn)(void *user, IVector3 vox_min, IVector3 vox_max), void *user);
+Octree *svo_map_to_octree(Svo_Map *map);
+bool svo_map_is_empty(Svo_Map *map);
+size_t svo_map_memory_usage(Svo_Map *map);
+void svo_map_delete(Svo_Map *map);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef _TREE64_H
+#define _TREE64_H
+
+#include <voxel.hpp>
+#include <octree.hpp>
+#include <palette.hpp>
+
+extern "C" {
+    #include <color.h>
+    #include <vmm/ivec3.h>
+    #include <vmm/ray.h>
+}
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Cada nó cobre 4x4x4 filhos: metade da profundidade da octree (6 níveis cobrem 4096³)
+#define TREE64_BRANCH 4
+#define TREE64_MAX_LEVELS 15
+#define TREE64_PALETTE_MAX 65536
+
+// Texels por registro serializado: nó = [máscara baixa][máscara alta][início dos filhos],
+// folha = os mesmos 2 texels da octree (cor + propriedades)
+#define TREE64_NODE_TEXELS 3
+#define TREE64_LEAF_TEXELS 2
+
+// Nó com máscara de 64 bits e filhos compactados (índice = popcount dos bits anteriores).
+// No último nível 'children' aponta para índices da paleta (uint16_t) em vez de nós.
+typedef struct _tree64_node {
+    uint64_t child_mask;
+    void *children;
+} Tree64_Node;
+
+typedef struct _tree64 {
+    IVector3 left_bot_back;   //canto mínimo da raiz
+    int levels;               //lado da raiz = 4^levels
+    Tree64_Node root;
+    Voxel_Palette palette;
+    size_t voxel_count, node_count;
+} Tree64;
+
+Tree64 *tree64_create(IVector3 left_bot_back, IVector3 right_top_front);
+int tree64_side(Tree64 *tree);
+bool tree64_contains(Tree64 *tree, IVector3 coord);
+int tree64_insert(Tree64 *tree, Voxel_Object voxel);
+Voxel_Object tree64_find(Tree64 *tree, IVector3 coord);
+void tree64_remove(Tree64 *tree, IVector3 coord);
+bool tree64_ray_cast(Tree64 *tree, Ray ray, Voxel_Object *hit, Ray_Stats *stats);
+uint8_t *tree64_serialize(Tree64 *tree, size_t *arr_size);
+Voxel_Object tree64_stream_find(const uint8_t *stream, size_t arr_size, IVector3 left_bot_back, int levels, IVector3 coord);
+uint8_t *tree64_texture(Tree64 *tree, IVector3 world_min, IVector3 world_max, size_t *arr_size, size_t tex_dim);
+void tree64_for_each(Tree64 *tree, void (*fn)(void *user, Voxel_Object voxel), void *user);
+size_t tree64_memory_usage(Tree64 *tree);
+void tree64_delete(Tree64 *tree);
+
+#endif
@@ -7,10 +7,21 @@ extern "C" {
 #include <vector>
 #include <voxel.hpp>
 #include <octree.hpp>
+#include <world.hpp>
+#include <sparseGrid.hpp>
 
-extern Voxel voxels[];
-extern ColorRGBA voxelColors[];
+// Opções de uma carga; NULL = padrão (todos os campos zerados)
+typedef struct {
+    int threads;            //threads da instanciação; 0 = automático (núcleos, limitado pelo tamanho da cena)
+    bool no_instancing;     //load_vox_world: modelos repetidos viram voxels comuns em vez de referências
+    const char* cache_dir;  //montagens guardadas como .svo (ver load_vox_file); NULL = sem cache
+    size_t cache_max_bytes; //acima disto as entradas usadas há mais tempo são apagadas; 0 = sem limite
+} Vox_Load_Options;
 
-bool load_vox_file(const char* filename, Octree* tree, int offsetX, int offsetY, int offsetZ);
+bool load_vox_file(const char* filename, Octree* tree, int offsetX, int offsetY, int offsetZ, const Vox_Load_Options* options);
+bool load_vox_file(const char* filename, Sparse_Grid* grid, int offsetX, int offsetY, int offsetZ);
+bool load_vox_world(const char* filename, World* world, int offsetX, int offsetY, int offsetZ, const Vox_Load_Options* options);
+bool load_vox_for_each(const char* filename, void (*fn)(void* user, Voxel_Object voxel), void* user, int offsetX, int offsetY, int offsetZ);
+bool load_vox_manifest(const char* manifest, World* world, const Vox_Load_Options* options);
 
 #endif
@@ -18,6 +18,13 @@ struct Voxel_Object {
 };
 
 
+// Tabela de materiais (definida em voxel.cpp)
+extern Voxel voxels[];
+extern ColorRGBA voxelColors[];
+
+extern Voxel_Type VOX_GRASS, VOX_DIRT, VOX_WOOD, VOX_LEAVES, VOX_WATER, VOX_STONE,
+                  VOX_GLASS, VOX_DIAMOND, VOX_JELLY, VOX_MIRROR, VOX_LIGHT;
+
 Voxel_Object VoxelObjCreate(Voxel voxel, ColorRGBA color, IVector3 coord);
 
 bool voxel_compare(Voxel a, Voxel b);
@@ -0,0 +1,136 @@
+#ifndef _WORLD_H
+#define _WORLD_H
+
+#include <voxel.hpp>
+#include <octree.hpp>
+#include <denseGrid.hpp>
+#include <tree64.hpp>
+#include <sparseGrid.hpp>
+#include <instances.hpp>
+#include <objects.hpp>
+#include <svoFile.hpp>
+#include <chunkGrid.hpp>
+#include <distanceField.hpp>
+#include <lightVolume.hpp>
+#include <sunCache.hpp>
+#include <faceBake.hpp>
+#include <lightTree.hpp>
+
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+    #include <vmm/ray.h>
+}
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Grade densa só vale a pena até este volume (320³ ≈ 37 MB com a paleta)
+#define DENSE_MAX_CELLS (320ull * 320ull * 320ull)
+// Abaixo deste volume (128³ ≈ 2.3 MB) a grade densa é sempre usada: a memória é
+// irrelevante e o DDA é de 2x a 10x mais rápido que a octree (ver bench_dense)
+#define DENSE_ALWAYS_CELLS (128ull * 128ull * 128ull)
+// Folga em volta dos voxels carregados para o jogador poder construir sem promover para octree
+#define DENSE_MARGIN 16
+
+enum World_Backend {
+    WORLD_BACKEND_OCTREE,
+    WORLD_BACKEND_DENSE,
+    WORLD_BACKEND_TREE64,
+    WORLD_BACKEND_SPARSE,  //sem limites: left_bot_back/right_top_front só delimitam o que vai para a GPU
+    WORLD_BACKEND_SVO,     //arquivo .svo mapeado, somente leitura: a primeira edição monta a octree
+    WORLD_BACKEND_CHUNKED  //uma octree por chunk, guardados longe da câmera (ver world_page_chunks)
+};
+
+// Mundo com backend selecionável. A interface é a mesma da octree;
+// os limites são os da raiz da octree (e os mesmos enviados ao shader).
+typedef struct _world {
+    World_Backend backend;
+    IVector3 left_bot_back, right_top_front;
+    Octree *octree;
+    Dense_Grid *dense;
+    Tree64 *tree64;
+    Sparse_Grid *sparse;
+    Svo_Map *svo;
+    Chunk_Grid *chunks;
+    Instance_Set *instances; //modelos repetidos por referência, sobre qualquer backend (NULL = nenhum)
+    Object_Layer *objects;   //objetos dinâmicos, fora da octree do mundo (NULL = nenhum)
+    int chunk_lod_radius;    //janela com reduções dos chunks (ver world_set_chunk_lod)
+    float chunk_lod_scale;
+    Distance_Field *distance; //distância ao voxel mais próximo, só do backend (ver world_update_distance)
+    bool distance_stale;      //a ocupação do campo tem que ser refeita a partir do backend
+    Light_Volume *light;      //luz das fontes do backend espalhada pelo vazio (ver world_update_light)
+    bool light_stale;         //a luz tem que ser refeita a partir do backend
+    Sun_Cache *sun;           //sol por face de voxel do backend (ver world_update_sun)
+    bool sun_stale;           //o cache tem que ser refeito a partir do backend
+    Vector3 sun_direction;    //para o sol (ver world_set_sun)
+    Face_Bake *bake;          //luz indireta assada por face do backend (ver world_bake)
+    bool bake_stale;          //o assado tem que ser refeito a partir do backend
+    int bake_samples;         //caminhos por face (0 = sem assado)
+    Light_Tree *emitters;     //voxels emissivos do backend (ver world_update_emitters)
+    bool emitters_stale;      //a árvore tem que ser refeita a partir do backend
+    Light_Sampling light_sampling; //fontes no traçador da CPU (ver world_trace_face)
+    int threads;              //do campo de distância, do sol e do assado; 0 = uma por núcleo
+} World;
+
+World *world_create(IVector3 left_bot_back, IVector3 right_top_front);
+World_Backend world_pick_backend(IVector3 vox_min, IVector3 vox_max, size_t voxel_count);
+bool world_set_backend(World *world, World_Backend backend, IVector3 vox_min, IVector3 vox_max);
+const char *world_backend_name(World_Backend backend);
+
+bool world_is_empty(World *world);
+bool world_is_unbounded(World *world);
+bool world_contains_box(World *world, IVector3 vox_min, IVector3 vox_max);
+void world_insert(World *world, Voxel_Object voxel);
+Voxel_Object world_find(World *world, IVector3 coord);
+Voxel_Object world_find_static(World *world, IVector3 coord);
+void world_remove(World *world, IVector3 coord);
+void world_fill(World *world, IVector3 vox_min, IVector3 vox_max, Voxel_Object voxel);
+void world_clear_region(World *world, IVector3 vox_min, IVector3 vox_max);
+Octree *world_copy_region(World *world, IVector3 vox_min, IVector3 vox_max);
+bool world_paste(World *world, Octree *clip, Voxel_Transform transform);
+long world_add_instance(World *world, Octree *model, Voxel_Transform transform);
+bool world_update_instances(World *world);
+int32_t *world_instance_buffer(World *world, size_t *arr_size);
+long world_add_object(World *world, Octree *model, Voxel_Transform transform);
+bool world_move_object(World *world, long id, Voxel_Transform transform);
+bool world_set_object_model(World *world, long id, Octree *model);
+bool world_remove_object(World *world, long id);
+bool world_sync_objects(World *world, uint8_t *texture, size_t texel_capacity,
+                        void (*fn)(void *user, size_t first, size_t count), void *user);
+bool world_page_chunks(World *world, IVector3 center, int radius);
+void world_set_chunk_lod(World *world, int radius, float pixels_per_radian);
+bool world_sync_chunks(World *world, uint8_t *texture, size_t texel_capacity,
+                       void (*fn)(void *user, size_t first, size_t count), void *user);
+bool world_update_chunks(World *world);
+int32_t *world_chunk_buffer(World *world, size_t *arr_size);
+bool world_open_chunks(World *world, const char *path, size_t budget);
+bool world_swap_chunks(World *world, const char *path, size_t budget);
+bool world_stream_chunks(World *world, Vector3 position, Vector3 velocity);
+bool world_save_chunks(World *world);
+bool world_update_distance(World *world);
+int32_t *world_distance_buffer(World *world, size_t *arr_size);
+bool world_update_light(World *world);
+int32_t *world_light_buffer(World *world, size_t *arr_size);
+bool world_set_sun(World *world, Vector3 direction);
+bool world_update_sun(World *world, double budget_ms);
+int32_t *world_sun_buffer(World *world, size_t *arr_size);
+void world_bake(World *world, int samples);
+bool world_update_bake(World *world, double budget_ms);
+int32_t *world_bake_buffer(World *world, size_t *arr_size);
+bool world_save_bake(World *world, const char *path);
+bool world_load_bake(World *world, const char *path);
+bool world_update_emitters(World *world);
+void world_set_light_sampling(World *world, Light_Sampling sampling);
+Vector3 world_trace_face(World *world, IVector3 coord, int face, int samples, uint64_t seed);
+bool world_ray_cast(World *world, Ray ray, Voxel_Object *hit);
+uint8_t *world_texture(World *world, size_t *arr_size, size_t tex_dim);
+bool world_fits_texture(World *world);
+const uint8_t *world_texture_view(World *world, size_t *arr_size);
+bool world_load_svo(World *world, const char *path);
+bool world_save_svo(World *world, const char *path);
+bool world_compact(World *world, double budget_ms);
+size_t world_memory_usage(World *world);
+void world_delete(World *world);
+
+#endif
@@ -0,0 +1,552 @@
+#include <asyncFile.hpp>
+#include <errno.h>
+#include <string.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+#if defined(__linux__) && defined(__has_include)
+    #if __has_include(<linux/io_uring.h>)
+        #include <linux/io_uring.h>
+        #include <sys/mman.h>
+        #include <sys/syscall.h>
+        #include <sys/uio.h>
+        #ifdef __NR_io_uring_setup
+            #define ASYNC_FILE_HAS_URING
+        #endif
+    #endif
+#endif
+
+#ifdef _WIN32
+    typedef HANDLE File_Handle;
+#else
+    typedef int File_Handle;
+#endif
+
+enum { SLOT_FREE, SLOT_QUEUED, SLOT_FLIGHT, SLOT_DONE };
+
+// Uma operação; a vaga i lê no buffer i do pool
+typedef struct _slot {
+    uint64_t tag, offset;
+    uint8_t *data;
+    size_t size, done;          //bytes já feitos: leitura curta continua de onde parou
+    bool write, own, ok;        //own: buffer fora do pool (de quem pediu ou maior que o do pool)
+    int state;
+} Slot;
+
+#ifdef ASYNC_FILE_HAS_URING
+// Anéis do io_uring mapeados do kernel (sem liburing: só as três syscalls)
+typedef struct _uring {
+    int fd;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring, *cq_ring;
+    size_t sq_ring_size, cq_ring_size, sqes_size;
+    unsigned unsubmitted;       //entradas no anel que o kernel ainda não pegou
+    bool fixed;                 //pool registrado: leituras com IORING_OP_READ_FIXED
+} Uring;
+#endif
+
+struct _async_file {
+    File_Handle handle;
+    Async_File_Backend backend;
+    size_t depth;
+    uint8_t *pool;              //depth * ASYNC_FILE_BUFFER_SIZE
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free_slots;
+    std::vector<uint32_t> pending; //pedidas, ainda não enviadas
+    size_t active;              //em voo ou na fila
+#ifdef ASYNC_FILE_HAS_URING
+    Uring ring;
+#endif
+    // ASYNC_FILE_THREADS
+    std::mutex mutex;
+    std::condition_variable work_ready, done_ready;
+    std::deque<uint32_t> work, finished;
+    std::vector<std::thread> workers;
+    bool stop;
+};
+
+// --- E/S BLOQUEANTE ---
+
+static bool _pread_all(File_Handle handle, uint64_t offset, uint8_t *data, size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        OVERLAPPED at = {};
+        at.Offset = (DWORD)offset;
+        at.OffsetHigh = (DWORD)(offset >> 32);
+        DWORD got = 0;
+        DWORD want = (DWORD)std::min(size, (size_t)1 << 30);
+        if (!ReadFile(handle, data, want, &got, &at) || got == 0) return false;
+#else
+        ssize_t got = pread(handle, data, size, (off_t)offset);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+#endif
+        offset += (uint64_t)got;
+        data += got;
+        size -= (size_t)got;
+    }
+    return true;
+}
+
+static bool _pwrite_all(File_Handle handle, uint64_t offset, const uint8_t *data, size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        OVERLAPPED at = {};
+        at.Offset = (DWORD)offset;
+        at.OffsetHigh = (DWORD)(offset >> 32);
+        DWORD put = 0;
+        DWORD want = (DWORD)std::min(size, (size_t)1 << 30);
+        if (!WriteFile(handle, data, want, &put, &at) || put == 0) return false;
+#else
+        ssize_t put = pwrite(handle, data, size, (off_t)offset);
+        if (put < 0 && errno == EINTR) continue;
+        if (put <= 0) return false;
+#endif
+        offset += (uint64_t)put;
+        data += put;
+        size -= (size_t)put;
+    }
+    return true;
+}
+
+// Faz a operação inteira na thread atual (ASYNC_FILE_THREADS e ASYNC_FILE_BLOCKING)
+static void _run(Async_File *file, Slot *slot) {
+    slot->ok = slot->write ? _pwrite_all(file->handle, slot->offset, slot->data, slot->size)
+                           : _pread_all(file->handle, slot->offset, slot->data, slot->size);
+    slot->done = slot->ok ? slot->size : 0;
+}
+
+// --- IO_URING ---
+
+#ifdef ASYNC_FILE_HAS_URING
+static int _uring_enter(int fd, unsigned submit, unsigned wait) {
+    return (int)syscall(__NR_io_uring_enter, fd, submit, wait, wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+}
+
+static bool _uring_setup(Async_File *file) {
+    Uring *ring = &file->ring;
+    memset(ring, 0, sizeof(Uring));
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->fd = (int)syscall(__NR_io_uring_setup, (unsigned)file->depth, &params);
+    if (ring->fd < 0) return false;
+    // IORING_OP_READ/WRITE são do mesmo kernel que IORING_FEAT_RW_CUR_POS (5.6)
+    if (!(params.features & IORING_FEAT_RW_CUR_POS) || params.sq_entries < file->depth) {
+        close(ring->fd);
+        return false;
+    }
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single) ring->sq_ring_size = ring->cq_ring_size = std::max(ring->sq_ring_size, ring->cq_ring_size);
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         ring->fd, IORING_OFF_SQ_RING);
+    ring->cq_ring = single ? ring->sq_ring
+                           : mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                  ring->fd, IORING_OFF_CQ_RING);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = (struct io_uring_sqe*)mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                            ring->fd, IORING_OFF_SQES);
+    if (ring->sq_ring == MAP_FAILED || ring->cq_ring == MAP_FAILED || ring->sqes == MAP_FAILED) {
+        if (ring->sq_ring != MAP_FAILED) munmap(ring->sq_ring, ring->sq_ring_size);
+        if (!single && ring->cq_ring != MAP_FAILED) munmap(ring->cq_ring, ring->cq_ring_size);
+        if (ring->sqes != MAP_FAILED) munmap(ring->sqes, ring->sqes_size);
+        close(ring->fd);
+        return false;
+    }
+
+    uint8_t *sq = (uint8_t*)ring->sq_ring, *cq = (uint8_t*)ring->cq_ring;
+    ring->sq_head = (unsigned*)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned*)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    // Buffers registrados: o kernel não precisa prender as páginas a cada leitura. Sem
+    // permissão (RLIMIT_MEMLOCK) as leituras continuam nos mesmos buffers, sem registro.
+    std::vector<struct iovec> iovecs(file->depth);
+    for (size_t i = 0; i < file->depth; i++) {
+        iovecs[i].iov_base = file->pool + i * ASYNC_FILE_BUFFER_SIZE;
+        iovecs[i].iov_len = ASYNC_FILE_BUFFER_SIZE;
+    }
+    ring->fixed = syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_BUFFERS,
+                          iovecs.data(), (unsigned)iovecs.size()) == 0;
+    return true;
+}
+
+static void _uring_close(Uring *ring) {
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ring != ring->sq_ring) munmap(ring->cq_ring, ring->cq_ring_size);
+    munmap(ring->sq_ring, ring->sq_ring_size);
+    close(ring->fd);
+}
+
+// Põe a vaga no anel (cada vaga tem no máximo uma entrada, e o anel tem 'depth' delas)
+static void _uring_queue(Async_File *file, uint32_t index) {
+    Uring *ring = &file->ring;
+    Slot *slot = &file->slots[index];
+    unsigned tail = *ring->sq_tail;
+    unsigned at = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[at];
+    memset(sqe, 0, sizeof(*sqe));
+    bool fixed = ring->fixed && !slot->write && !slot->own;
+    sqe->opcode = slot->write ? IORING_OP_WRITE : fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = file->handle;
+    sqe->off = slot->offset + slot->done;
+    sqe->addr = (uint64_t)(uintptr_t)(slot->data + slot->done);
+    sqe->len = (uint32_t)(slot->size - slot->done);
+    if (fixed) sqe->buf_index = (uint16_t)index;
+    sqe->user_data = index;
+    ring->sq_array[at] = at;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->unsubmitted++;
+    slot->state = SLOT_FLIGHT;
+}
+
+static void _uring_flush(Uring *ring) {
+    while (ring->unsubmitted > 0) {
+        int submitted = _uring_enter(ring->fd, ring->unsubmitted, 0);
+        if (submitted < 0) {
+            if (errno == EINTR) continue;
+            return; //EAGAIN/EBUSY: as entradas ficam no anel para a próxima vez
+        }
+        ring->unsubmitted -= std::min((unsigned)submitted, ring->unsubmitted);
+    }
+}
+
+// Recolhe o que terminou; leituras curtas voltam para o anel com o resto
+static size_t _uring_reap(Async_File *file, uint32_t *indices, size_t capacity) {
+    Uring *ring = &file->ring;
+    unsigned head = *ring->cq_head;
+    unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    size_t count = 0;
+    bool requeued = false;
+    while (head != tail && count < capacity) {
+        struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+        uint32_t index = (uint32_t)cqe->user_data;
+        int result = cqe->res;
+        head++;
+
+        Slot *slot = &file->slots[index];
+        if (result == -EINTR || result == -EAGAIN || (result > 0 && slot->done + (size_t)result < slot->size)) {
+            if (result > 0) slot->done += (size_t)result;
+            _uring_queue(file, index);
+            requeued = true;
+            continue;
+        }
+        if (result > 0) slot->done += (size_t)result;
+        slot->ok = slot->done == slot->size;
+        indices[count++] = index;
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    if (requeued) _uring_flush(ring);
+    return count;
+}
+#endif
+
+// --- POOL DE THREADS ---
+
+static void _worker_thread(Async_File *file) {
+    std::unique_lock<std::mutex> lock(file->mutex);
+    while (true) {
+        file->work_ready.wait(lock, [file] { return file->stop || !file->work.empty(); });
+        if (file->work.empty()) break;
+        uint32_t index = file->work.front();
+        file->work.pop_front();
+        lock.unlock();
+        _run(file, &file->slots[index]);
+        lock.lock();
+        file->finished.push_back(index);
+        file->done_ready.notify_one();
+    }
+}
+
+// --- ABERTURA ---
+
+static bool _open_handle(const char *path, bool create, File_Handle *handle) {
+#ifdef _WIN32
+    *handle = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                          create ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    return *handle != INVALID_HANDLE_VALUE;
+#else
+    *handle = open(path, O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_TRUNC : 0), 0644);
+    return *handle >= 0;
+#endif
+}
+
+static void _close_handle(File_Handle handle) {
+#ifdef _WIN32
+    CloseHandle(handle);
+#else
+    close(handle);
+#endif
+}
+
+// Abre 'path' para ler e gravar (create: cria ou esvazia). ASYNC_FILE_URING sem io_uring
+// no sistema vira ASYNC_FILE_THREADS; async_file_backend diz qual ficou.
+Async_File *async_file_open(const char *path, bool create, Async_File_Backend backend) {
+    if (!path) return NULL;
+    File_Handle handle;
+    if (!_open_handle(path, create, &handle)) return NULL;
+
+    Async_File *file = new Async_File();
+    file->handle = handle;
+    file->depth = backend == ASYNC_FILE_BLOCKING ? 1 : ASYNC_FILE_DEPTH;
+    file->pool = (uint8_t*)malloc(file->depth * ASYNC_FILE_BUFFER_SIZE);
+    if (!file->pool) {
+        _close_handle(handle);
+        delete file;
+        return NULL;
+    }
+    file->slots.assign(file->depth, Slot());
+    for (size_t i = file->depth; i-- > 0;) file->free_slots.push_back((uint32_t)i);
+    file->active = 0;
+    file->stop = false;
+
+    if (backend == ASYNC_FILE_AUTO || backend == ASYNC_FILE_URING) {
+        backend = ASYNC_FILE_THREADS;
+#ifdef ASYNC_FILE_HAS_URING
+        if (_uring_setup(file)) backend = ASYNC_FILE_URING;
+#endif
+    }
+    file->backend = backend;
+    if (backend == ASYNC_FILE_THREADS) {
+        for (int i = 0; i < ASYNC_FILE_WORKERS; i++) file->workers.emplace_back(_worker_thread, file);
+    }
+    return file;
+}
+
+Async_File_Backend async_file_backend(Async_File *file) {
+    return file ? file->backend : ASYNC_FILE_AUTO;
+}
+
+const char *async_file_backend_name(Async_File_Backend backend) {
+    switch (backend) {
+        case ASYNC_FILE_URING: return "io_uring";
+        case ASYNC_FILE_THREADS: return "pread pool";
+        case ASYNC_FILE_BLOCKING: return "blocking";
+        default: return "auto";
+    }
+}
+
+uint64_t async_file_size(Async_File *file) {
+    if (!file) return 0;
+#ifdef _WIN32
+    LARGE_INTEGER size;
+    return GetFileSizeEx(file->handle, &size) ? (uint64_t)size.QuadPart : 0;
+#else
+    struct stat st;
+    return fstat(file->handle, &st) == 0 ? (uint64_t)st.st_size : 0;
+#endif
+}
+
+// --- E/S BLOQUEANTE (qualquer thread) ---
+
+bool async_file_pread(Async_File *file, uint64_t offset, void *data, size_t size) {
+    return file && (size == 0 || (data && _pread_all(file->handle, offset, (uint8_t*)data, size)));
+}
+
+bool async_file_pwrite(Async_File *file, uint64_t offset, const void *data, size_t size) {
+    return file && (size == 0 || (data && _pwrite_all(file->handle, offset, (const uint8_t*)data, size)));
+}
+
+bool async_file_sync(Async_File *file) {
+    if (!file) return false;
+#ifdef _WIN32
+    return FlushFileBuffers(file->handle) != 0;
+#else
+    return fsync(file->handle) == 0;
+#endif
+}
+
+// --- FILA ---
+
+// Quantas operações ainda cabem antes de async_file_complete devolver alguma vaga
+size_t async_file_room(Async_File *file) {
+    return file ? file->free_slots.size() : 0;
+}
+
+static Slot *_take(Async_File *file, uint32_t *index) {
+    if (file->free_slots.empty()) return NULL;
+    *index = file->free_slots.back();
+    file->free_slots.pop_back();
+    return &file->slots[*index];
+}
+
+// Pede a leitura de [offset, offset + size); os bytes chegam em async_file_complete em 'data'
+// ou, com 'data' NULL, num buffer do pool (ou próprio, se não couber). 'data' tem que vir de
+// malloc: passa a ser do arquivo até voltar em ops.data, e então é de quem recolheu (solto
+// com free ou async_file_release). Falso se não houver vaga ('data' continua de quem pediu).
+bool async_file_read(Async_File *file, uint64_t offset, uint8_t *data, size_t size, uint64_t tag) {
+    uint32_t index;
+    Slot *slot = file && size <= UINT32_MAX ? _take(file, &index) : NULL;
+    if (!slot) return false;
+    bool own = data || size > ASYNC_FILE_BUFFER_SIZE;
+    if (!data) data = own ? (uint8_t*)malloc(size) : file->pool + (size_t)index * ASYNC_FILE_BUFFER_SIZE;
+    if (!data) {
+        file->free_slots.push_back(index);
+        return false;
+    }
+    *slot = {tag, offset, data, size, 0, false, own, false, SLOT_QUEUED};
+    file->pending.push_back(index);
+    file->active++;
+    return true;
+}
+
+// Pede a gravação de 'data' em 'offset'; 'data' tem que continuar válido até a operação
+// voltar de async_file_complete
+bool async_file_write(Async_File *file, uint64_t offset, const uint8_t *data, size_t size, uint64_t tag) {
+    if (!data || size > UINT32_MAX) return false;
+    uint32_t index;
+    Slot *slot = file ? _take(file, &index) : NULL;
+    if (!slot) return false;
+    *slot = {tag, offset, (uint8_t*)data, size, 0, true, false, false, SLOT_QUEUED};
+    file->pending.push_back(index);
+    file->active++;
+    return true;
+}
+
+// Envia de uma vez tudo o que foi pedido desde a última chamada
+size_t async_file_submit(Async_File *file) {
+    if (!file || file->pending.empty()) return 0;
+    size_t count = file->pending.size();
+    switch (file->backend) {
+#ifdef ASYNC_FILE_HAS_URING
+        case ASYNC_FILE_URING:
+            for (uint32_t index : file->pending) _uring_queue(file, index);
+            _uring_flush(&file->ring);
+            break;
+#endif
+        case ASYNC_FILE_THREADS: {
+            std::lock_guard<std::mutex> lock(file->mutex);
+            for (uint32_t index : file->pending) {
+                file->slots[index].state = SLOT_FLIGHT;
+                file->work.push_back(index);
+            }
+            if (count == 1) file->work_ready.notify_one();
+            else file->work_ready.notify_all();
+            break;
+        }
+        default:
+            return 0; //ASYNC_FILE_BLOCKING: roda em async_file_complete
+    }
+    file->pending.clear();
+    return count;
+}
+
+// Operações terminadas (até 'capacity'). Com 'wait', espera pela primeira se houver
+// alguma em voo.
+size_t async_file_complete(Async_File *file, Async_File_Op *ops, size_t capacity, bool wait) {
+    if (!file || !ops || capacity == 0 || file->active == 0) return 0;
+    // Só espera se houver algo já enviado (o que está em 'pending' não termina sozinho)
+    wait = wait && file->active > file->pending.size();
+    std::vector<uint32_t> indices;
+    switch (file->backend) {
+#ifdef ASYNC_FILE_HAS_URING
+        case ASYNC_FILE_URING: {
+            indices.resize(std::min(capacity, file->depth));
+            size_t count = _uring_reap(file, indices.data(), indices.size());
+            while (count == 0 && wait) {
+                _uring_flush(&file->ring);
+                if (_uring_enter(file->ring.fd, 0, 1) < 0 && errno != EINTR) break;
+                count = _uring_reap(file, indices.data(), indices.size());
+            }
+            indices.resize(count);
+            break;
+        }
+#endif
+        case ASYNC_FILE_THREADS: {
+            std::unique_lock<std::mutex> lock(file->mutex);
+            if (wait) file->done_ready.wait(lock, [file] { return !file->finished.empty(); });
+            while (!file->finished.empty() && indices.size() < capacity) {
+                indices.push_back(file->finished.front());
+                file->finished.pop_front();
+            }
+            break;
+        }
+        default: {
+            size_t count = std::min(capacity, file->pending.size());
+            indices.assign(file->pending.begin(), file->pending.begin() + count);
+            file->pending.erase(file->pending.begin(), file->pending.begin() + count);
+            for (uint32_t index : indices) _run(file, &file->slots[index]);
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < indices.size(); i++) {
+        Slot *slot = &file->slots[indices[i]];
+        ops[i] = {slot->tag, slot->offset, slot->write ? NULL : slot->data, slot->size, slot->write, slot->ok};
+        file->active--;
+        // Só a leitura num buffer do pool segura a vaga até async_file_release
+        if (slot->write || slot->own) {
+            slot->state = SLOT_FREE;
+            file->free_slots.push_back(indices[i]);
+        } else {
+            slot->state = SLOT_DONE;
+        }
+    }
+    return indices.size();
+}
+
+size_t async_file_in_flight(Async_File *file) {
+    return file ? file->active : 0;
+}
+
+// Devolve o buffer de uma leitura terminada
+void async_file_release(Async_File *file, uint8_t *data) {
+    if (!file || !data) return;
+    size_t bytes = file->depth * ASYNC_FILE_BUFFER_SIZE;
+    if (data < file->pool || data >= file->pool + bytes) {
+        free(data);
+        return;
+    }
+    uint32_t index = (uint32_t)((size_t)(data - file->pool) / ASYNC_FILE_BUFFER_SIZE);
+    if (file->slots[index].state != SLOT_DONE) return;
+    file->slots[index].state = SLOT_FREE;
+    file->free_slots.push_back(index);
+}
+
+// Espera o que está em voo (os resultados se perdem) e fecha
+void async_file_close(Async_File *file) {
+    if (!file) return;
+    Async_File_Op ops[64];
+    while (file->active > 0) {
+        if (file->backend == ASYNC_FILE_URING || file->backend == ASYNC_FILE_THREADS) async_file_submit(file);
+        size_t count = async_file_complete(file, ops, 64, true);
+        if (count == 0 && file->backend == ASYNC_FILE_URING) break;
+        for (size_t i = 0; i < count; i++) async_file_release(file, ops[i].data);
+    }
+    if (!file->workers.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(file->mutex);
+            file->stop = true;
+        }
+        file->work_ready.notify_all();
+        for (std::thread &worker : file->workers) worker.join();
+    }
+#ifdef ASYNC_FILE_HAS_URING
+    if (file->backend == ASYNC_FILE_URING) _uring_close(&file->ring);
+#endif
+    _close_handle(file->handle);
+    free(file->pool);
+    delete file;
+}
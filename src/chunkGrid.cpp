@@ -0,0 +1,1416 @@
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+    #include <vmm/ray.h>
+}
+#include <chunkGrid.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <unordered_set>
+#include <vector>
+
+// Ponteiros da textura têm 23 bits (ver _encode_pointer na octree)
+#define TEXTURE_MAX_TEXELS 0x800000
+// Flags da raiz no diretório (as mesmas das instâncias no shader)
+#define GPU_ROOT_LEAF 1
+#define GPU_ROOT_POINT 2
+// Texel-ponteiro da raiz de uma redução (os mesmos formatos da textura, ver svoFile.cpp)
+#define POINTER_LEAF_FLAG 0x800000
+#define POINTER_POINT_FLAG 1
+
+Chunk_Grid *chunk_grid_create(IVector3 left_bot_back, IVector3 right_top_front) {
+    Chunk_Grid *grid = (Chunk_Grid*)calloc(1, sizeof(Chunk_Grid));
+    if (!grid) return NULL;
+    grid->table_capacity = 64;
+    grid->table = (Chunk_Entry*)calloc(grid->table_capacity, sizeof(Chunk_Entry));
+    if (!grid->table) {
+        free(grid);
+        return NULL;
+    }
+    grid->left_bot_back = left_bot_back;
+    grid->right_top_front = right_top_front;
+    grid->radius = -1;
+    grid->gpu_dirty = true;
+    return grid;
+}
+
+static IVector3 _chunk_of(IVector3 coord) {
+    return {{coord.x >> CHUNK_LOG2, coord.y >> CHUNK_LOG2, coord.z >> CHUNK_LOG2}};
+}
+
+static IVector3 _chunk_min(const Chunk *chunk) {
+    return ivec3_scalar_mul(chunk->coord, CHUNK_SIZE);
+}
+
+static bool _box_is_empty(IVector3 min, IVector3 max) {
+    return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+static bool _is_empty_tree(Octree *tree) {
+    return !tree || (!tree->children && !tree->has_voxel && !tree->instance);
+}
+
+static bool _has_content(Chunk *chunk) {
+    if (chunk->tree) return !_is_empty_tree(chunk->tree);
+    return chunk->packed ? !svo_map_is_empty(chunk->packed) : chunk->stored;
+}
+
+// Ainda só no disco: nem árvore nem imagem na memória
+static bool _on_disk(const Chunk *chunk) {
+    return chunk->stored && !chunk->tree && !chunk->packed;
+}
+
+// Chunk editado em [min, max] (células, inclusivas): a vaga na textura e a cópia no disco
+// ficam velhas, e as reduções só nessa caixa (refeitas quando o chunk é guardado)
+static void _touch(Chunk *chunk, IVector3 min, IVector3 max) {
+    chunk->dirty = true;
+    chunk->stored = false;
+    bool none = _box_is_empty(chunk->edit_min, chunk->edit_max);
+    chunk->edit_min = none ? min : ivec3_min(chunk->edit_min, min);
+    chunk->edit_max = none ? max : ivec3_max(chunk->edit_max, max);
+}
+
+// --- DIRETÓRIO (tabela hash) ---
+
+// Os bits baixos (os que a máscara usa) precisam misturar os três eixos: com milhares de
+// chunks vizinhos no diretório, um hash só com xor forma longas sequências ocupadas e
+// procurar um chunk que não existe (o ar em volta do terreno) percorre todas elas
+static size_t _hash(IVector3 coord) {
+    uint64_t h = ((uint64_t)((uint32_t)coord.x & 0x1fffff) << 42) | ((uint64_t)((uint32_t)coord.y & 0x1fffff) << 21)
+               | (uint64_t)((uint32_t)coord.z & 0x1fffff);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return (size_t)h;
+}
+
+static Chunk_Entry *_slot(Chunk_Entry *table, size_t capacity, IVector3 coord) {
+    size_t i = _hash(coord) & (capacity - 1);
+    while (table[i].chunk && !ivec3_equal_vec(table[i].coord, coord)) i = (i + 1) & (capacity - 1);
+    return &table[i];
+}
+
+static bool _rehash(Chunk_Grid *grid, size_t capacity) {
+    Chunk_Entry *table = (Chunk_Entry*)calloc(capacity, sizeof(Chunk_Entry));
+    if (!table) return false;
+
+    for (size_t i = 0; i < grid->table_capacity; i++) {
+        if (!grid->table[i].chunk) continue;
+        *_slot(table, capacity, grid->table[i].coord) = grid->table[i];
+    }
+    free(grid->table);
+    grid->table = table;
+    grid->table_capacity = capacity;
+    return true;
+}
+
+static int _distance(Chunk_Grid *grid, IVector3 coord) {
+    IVector3 d = ivec3_abs(ivec3_sub(coord, grid->center));
+    return std::max(d.x, std::max(d.y, d.z));
+}
+
+// Além da faixa radius + 1, onde chunk_grid_page guarda os residentes (só conta com a
+// paginação ligada)
+static bool _is_far(Chunk_Grid *grid, IVector3 coord) {
+    return grid->radius >= 0 && _distance(grid, coord) > grid->radius + 1;
+}
+
+static bool _lod_enabled(Chunk_Grid *grid) {
+    return grid->radius >= 0 && grid->lod_radius > grid->radius;
+}
+
+// Raio da janela na GPU com a paginação ligada: o residente, ou o das reduções
+static int _gpu_radius(Chunk_Grid *grid) {
+    return _lod_enabled(grid) ? grid->lod_radius : grid->radius;
+}
+
+// Nível na GPU de um chunk a 'distance' chunks da câmera (ver Chunk::level). Dentro do
+// raio residente vai a octree; além dele, a redução mais grossa cuja célula ainda fica
+// abaixo de lod_pixels na tela: uma célula de 2^n a d células da câmera ocupa uns
+// 2^n * lod_scale / d pixels. A distância é a da borda mais perto do chunk (a câmera no
+// meio do dela). Nunca a octree além do raio: é o que limita a memória e os passos por
+// raio lá longe.
+static int _level_at(Chunk_Grid *grid, int distance) {
+    if (grid->radius < 0) return 0;
+    if (distance <= grid->radius) return 0;
+    if (!_lod_enabled(grid) || distance > grid->lod_radius) return -1;
+    float cells = ((float)distance - 0.5f) * CHUNK_SIZE;
+    int level = (int)floorf(log2f(grid->lod_pixels * cells / grid->lod_scale));
+    return std::min(std::max(level, 1), CHUNK_LOD_LEVELS);
+}
+
+static int _level(Chunk_Grid *grid, IVector3 coord) {
+    return _level_at(grid, grid->radius < 0 ? 0 : _distance(grid, coord));
+}
+
+// Janela de chunks que vai para a GPU (inclusiva): o raio residente (ou o das reduções),
+// ou todos os chunks sem paginação; nunca além dos limites do mundo. A faixa entre
+// radius e radius + 1 fica residente só na CPU.
+static bool _window(Chunk_Grid *grid, IVector3 *min, IVector3 *max) {
+    if (grid->radius >= 0) {
+        *min = ivec3_scalar_sub(grid->center, _gpu_radius(grid));
+        *max = ivec3_scalar_add(grid->center, _gpu_radius(grid));
+    } else {
+        if (grid->count == 0) return false;
+        *min = grid->chunk_min;
+        *max = grid->chunk_max;
+    }
+    *min = ivec3_max(*min, _chunk_of(grid->left_bot_back));
+    *max = ivec3_min(*max, _chunk_of(ivec3_scalar_sub(grid->right_top_front, 1)));
+    return !_box_is_empty(*min, *max);
+}
+
+static bool _in_window(Chunk_Grid *grid, IVector3 coord) {
+    IVector3 min, max;
+    if (!_window(grid, &min, &max)) return false;
+    return coord.x >= min.x && coord.y >= min.y && coord.z >= min.z
+        && coord.x <= max.x && coord.y <= max.y && coord.z <= max.z;
+}
+
+// Chama fn para cada chunk da caixa [min, max] (coordenadas de chunk, inclusivas). Com um
+// diretório grande (mundo no disco) a janela é bem menor que a tabela: aí os chunks são
+// procurados um a um em vez de percorrer a tabela inteira a cada quadro.
+template <typename Fn>
+static void _for_box(Chunk_Grid *grid, IVector3 min, IVector3 max, Fn fn) {
+    if (_box_is_empty(min, max)) return;
+    IVector3 dims = ivec3_scalar_add(ivec3_sub(max, min), 1);
+    if ((double)dims.x * dims.y * dims.z <= (double)grid->table_capacity) {
+        for (int z = min.z; z <= max.z; z++)
+        for (int y = min.y; y <= max.y; y++)
+        for (int x = min.x; x <= max.x; x++) {
+            Chunk *chunk = chunk_grid_get(grid, {{x, y, z}});
+            if (chunk) fn(chunk);
+        }
+        return;
+    }
+    for (size_t i = 0; i < grid->table_capacity; i++) {
+        Chunk *chunk = grid->table[i].chunk;
+        if (!chunk) continue;
+        IVector3 c = chunk->coord;
+        if (c.x >= min.x && c.y >= min.y && c.z >= min.z && c.x <= max.x && c.y <= max.y && c.z <= max.z) fn(chunk);
+    }
+}
+
+// Chunk em 'chunk_coord' (coordenadas de chunk), ou NULL se nada foi gravado nele
+Chunk *chunk_grid_get(Chunk_Grid *grid, IVector3 chunk_coord) {
+    if (!grid) return NULL;
+    return _slot(grid->table, grid->table_capacity, chunk_coord)->chunk;
+}
+
+static Octree *_chunk_tree(IVector3 chunk_coord) {
+    IVector3 min = ivec3_scalar_mul(chunk_coord, CHUNK_SIZE);
+    return octree_create(NULL, min, ivec3_scalar_add(min, CHUNK_SIZE));
+}
+
+// Entra no diretório um chunk residente com 'tree' (a caixa do chunk); NULL se faltar memória
+static Chunk *_add(Chunk_Grid *grid, IVector3 chunk_coord, Octree *tree) {
+    if ((grid->count + 1) * 4 > grid->table_capacity * 3 && !_rehash(grid, grid->table_capacity * 2)) return NULL;
+    Chunk_Entry *entry = _slot(grid->table, grid->table_capacity, chunk_coord);
+    Chunk *chunk = (Chunk*)calloc(1, sizeof(Chunk));
+    if (!chunk) return NULL;
+    chunk->coord = chunk_coord;
+    chunk->tree = tree;
+    chunk->base = CHUNK_SLOT_NONE;
+    chunk->dirty = true;
+    chunk->edit_min = {{1, 1, 1}};
+    chunk->edit_max = {{0, 0, 0}};
+    chunk->level = _level(grid, chunk_coord);
+    entry->coord = chunk_coord;
+    entry->chunk = chunk;
+
+    grid->chunk_min = grid->count ? ivec3_min(grid->chunk_min, chunk_coord) : chunk_coord;
+    grid->chunk_max = grid->count ? ivec3_max(grid->chunk_max, chunk_coord) : chunk_coord;
+    grid->count++;
+    if (_is_far(grid, chunk_coord)) grid->loose = true;
+    grid->gpu_dirty = true;
+    return chunk;
+}
+
+// Um chunk novo já nasce residente (vazio)
+static Chunk *_get_or_create(Chunk_Grid *grid, IVector3 chunk_coord) {
+    Chunk *chunk = chunk_grid_get(grid, chunk_coord);
+    if (chunk) return chunk;
+    Octree *tree = _chunk_tree(chunk_coord);
+    chunk = tree ? _add(grid, chunk_coord, tree) : NULL;
+    if (!chunk) octree_delete(tree);
+    return chunk;
+}
+
+// --- VAGAS NA TEXTURA ---
+
+static size_t _slot_capacity(size_t texels) {
+    return (size_t)((float)texels * CHUNK_SLOT_SLACK) + 1;
+}
+
+// Buracos vizinhos viram um só e o que encosta no fim da arena volta para ela: com os
+// chunks entrando e saindo a toda hora, sem isso a arena se esfarela até a textura ser refeita
+static void _hole_push(Chunk_Grid *grid, size_t base, size_t capacity) {
+    if (base == CHUNK_SLOT_NONE || capacity == 0) return;
+    for (size_t i = 0; i < grid->hole_count;) {
+        Chunk_Hole hole = grid->holes[i];
+        if (hole.base + hole.capacity != base && base + capacity != hole.base) {
+            i++;
+            continue;
+        }
+        base = std::min(base, hole.base);
+        capacity += hole.capacity;
+        grid->holes[i] = grid->holes[--grid->hole_count];
+    }
+    if (base + capacity == grid->arena_end) {
+        grid->arena_end = base;
+        return;
+    }
+    if (grid->hole_count == grid->hole_capacity) {
+        size_t hole_capacity = grid->hole_capacity ? grid->hole_capacity * 2 : 64;
+        Chunk_Hole *holes = (Chunk_Hole*)realloc(grid->holes, hole_capacity * sizeof(Chunk_Hole));
+        if (!holes) return; // o buraco só se perde até a próxima textura inteira
+        grid->holes = holes;
+        grid->hole_capacity = hole_capacity;
+    }
+    grid->holes[grid->hole_count++] = {base, capacity};
+}
+
+// O chunk sai da textura; a vaga vira buraco
+static void _slot_free(Chunk_Grid *grid, Chunk *chunk) {
+    if (chunk->base == CHUNK_SLOT_NONE) return;
+    _hole_push(grid, chunk->base, chunk->capacity);
+    chunk->base = CHUNK_SLOT_NONE;
+    chunk->capacity = 0;
+    grid->gpu_dirty = true;
+}
+
+// Lugar para 'texels': o começo de um buraco grande o bastante (o resto continua buraco)
+// ou o fim da arena. A vaga antiga (pequena demais) vira buraco.
+static bool _slot_place(Chunk_Grid *grid, Chunk *chunk, size_t texels, size_t limit) {
+    size_t capacity = _slot_capacity(texels);
+    for (size_t i = 0; i < grid->hole_count; i++) {
+        Chunk_Hole hole = grid->holes[i];
+        if (hole.capacity < texels) continue;
+        grid->holes[i] = grid->holes[--grid->hole_count];
+        _slot_free(grid, chunk);
+        chunk->base = hole.base;
+        chunk->capacity = std::min(hole.capacity, capacity);
+        _hole_push(grid, hole.base + chunk->capacity, hole.capacity - chunk->capacity);
+        grid->gpu_dirty = true;
+        return true;
+    }
+
+    if (grid->arena_end == 0 || grid->arena_end + capacity > limit) return false;
+    _slot_free(grid, chunk);
+    chunk->base = grid->arena_end;
+    chunk->capacity = capacity;
+    grid->arena_end += capacity;
+    grid->gpu_dirty = true;
+    return true;
+}
+
+// Vaga que ficou grande demais (o chunk passou para uma redução mais grossa): a sobra
+// volta para a arena em vez de ficar presa até a textura ser refeita
+static void _slot_trim(Chunk_Grid *grid, Chunk *chunk, size_t texels) {
+    size_t capacity = _slot_capacity(texels);
+    if (chunk->base == CHUNK_SLOT_NONE || chunk->capacity <= capacity * 2) return;
+    _hole_push(grid, chunk->base + capacity, chunk->capacity - capacity);
+    chunk->capacity = capacity;
+}
+
+// --- RESIDÊNCIA ---
+
+static void _set_packed(Chunk_Grid *grid, Chunk *chunk, Svo_Map *packed) {
+    grid->packed_bytes -= svo_map_memory_usage(chunk->packed);
+    svo_map_delete(chunk->packed);
+    chunk->packed = packed;
+    grid->packed_bytes += svo_map_memory_usage(packed);
+}
+
+static void _evict(Chunk_Grid *grid);
+
+// Imagem guardada do chunk, lida do disco agora se ele ainda estiver lá. Bloqueia: é para
+// edições e consultas, que precisam do conteúdo certo; a paginação pede as leituras com
+// chunk_store_request. Uma imagem ilegível deixa o chunk vazio.
+static Svo_Map *_packed(Chunk_Grid *grid, Chunk *chunk) {
+    chunk->used = ++grid->tick;
+    if (!_on_disk(chunk)) return chunk->packed;
+    Svo_Map *map = chunk_store_read(grid->store, chunk->coord);
+    if (!map) {
+        fprintf(stderr, "Chunks: chunk (%d, %d, %d) ilegível no disco\n", chunk->coord.x, chunk->coord.y, chunk->coord.z);
+        chunk->stored = false;
+        return NULL;
+    }
+    _set_packed(grid, chunk, map);
+    _evict(grid);
+    return map;
+}
+
+// Monta a octree de um chunk guardado (para editar)
+static Octree *_unpack(Chunk_Grid *grid, Chunk *chunk) {
+    if (chunk->tree) return chunk->tree;
+    Svo_Map *packed = _packed(grid, chunk);
+    Octree *tree = packed ? svo_map_to_octree(packed) : NULL;
+    if (!tree) tree = _chunk_tree(chunk->coord);
+    if (!tree) return NULL;
+    _set_packed(grid, chunk, NULL);
+    chunk->tree = tree;
+    chunk->dirty = true;
+    if (_is_far(grid, chunk->coord)) grid->loose = true;
+    return tree;
+}
+
+// --- REDUÇÕES (LOD) ---
+
+static void _lod_free(Chunk *chunk) {
+    for (int i = 0; i < CHUNK_LOD_LEVELS; i++) {
+        free(chunk->lod[i].texels);
+        memset(&chunk->lod[i], 0, sizeof(Chunk_Lod));
+    }
+    chunk->lod_ready = false;
+    chunk->lod_from = 0;
+}
+
+// Solta as reduções mais finas que 'first' (o chunk passou para uma mais grossa): longe
+// elas não voltam a ser desenhadas tão cedo, e são refeitas da imagem cheia se voltarem
+static void _lod_trim(Chunk *chunk, int first) {
+    if (!chunk->lod_ready || first <= chunk->lod_from) return;
+    for (int level = chunk->lod_from; level < first; level++) {
+        free(chunk->lod[level - 1].texels);
+        memset(&chunk->lod[level - 1], 0, sizeof(Chunk_Lod));
+    }
+    chunk->lod_from = first;
+}
+
+// Redução desenhada: a do nível do chunk, ou a mais fina guardada enquanto a dele é refeita
+static Chunk_Lod *_lod_drawn(Chunk *chunk) {
+    return &chunk->lod[std::max(std::max(chunk->level, chunk->lod_from), 1) - 1];
+}
+
+// Ainda faltam reduções (ou as edições da caixa) para o nível que o chunk tem na GPU
+static bool _lod_wanted(const Chunk *chunk) {
+    return chunk->level >= 1 && (!chunk->lod_ready || chunk->level < chunk->lod_from
+                                 || !_box_is_empty(chunk->edit_min, chunk->edit_max));
+}
+
+// Redução 'level' de volta a uma árvore, para refazer só a caixa editada
+static Octree *_lod_tree(Chunk *chunk, int level) {
+    Chunk_Lod *lod = &chunk->lod[level];
+    IVector3 min = _chunk_min(chunk);
+    return octree_from_texture(lod->texels, lod->count, lod->root, min, ivec3_scalar_add(min, CHUNK_SIZE), NULL, NULL);
+}
+
+static bool _lod_store(Chunk_Lod *lod, Octree *tree) {
+    size_t count = _octree_texel_size(tree);
+    uint8_t *texels = count ? (uint8_t*)malloc(count * 4) : NULL;
+    if (count && !texels) return false;
+    if (texels) octree_texture_write(tree, texels, 0);
+    free(lod->texels);
+    lod->texels = texels;
+    lod->count = count;
+    memset(lod->root, 0, sizeof(lod->root));
+    // A raiz fica no texel 0; só é folha se a redução inteira for um volume ou um ponto
+    if (!tree->children && tree->has_voxel) {
+        lod->root[2] = (uint8_t)(POINTER_LEAF_FLAG >> 16);
+        lod->root[3] = tree->is_point ? POINTER_POINT_FLAG : 0;
+    }
+    return true;
+}
+
+// Monta as reduções a partir de 'tree' (a octree atual do chunk), cada nível do anterior;
+// só as do nível do chunk em diante ficam (ver _lod_trim). Com todas as reduções guardadas
+// e uma edição pequena, só as células da caixa editada são refeitas (ver
+// octree_downsample_region). Sem memória o chunk fica sem reduções.
+static bool _lod_build(Chunk *chunk, Octree *tree) {
+    bool edited = !_box_is_empty(chunk->edit_min, chunk->edit_max);
+    int first = std::max(chunk->level, 1);
+    if (chunk->lod_ready && !edited && chunk->lod_from <= first) return true;
+    IVector3 extent = ivec3_scalar_add(ivec3_sub(chunk->edit_max, chunk->edit_min), 1);
+    bool partial = chunk->lod_ready && chunk->lod_from == 1
+                && (float)extent.x * extent.y * extent.z <= CHUNK_LOD_REBUILD * CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+    Octree *finer = tree;
+    bool ok = true;
+    for (int level = 0; level < CHUNK_LOD_LEVELS && ok; level++) {
+        int cell = 2 << level;
+        Octree *coarse = partial ? _lod_tree(chunk, level) : NULL;
+        if (coarse) octree_downsample_region(coarse, finer, cell, chunk->edit_min, chunk->edit_max);
+        else coarse = octree_downsample(finer, cell);
+        ok = coarse && (level + 1 < first || _lod_store(&chunk->lod[level], coarse));
+        if (finer != tree) octree_delete(finer);
+        finer = coarse;
+    }
+    if (finer != tree) octree_delete(finer);
+    chunk->edit_min = {{1, 1, 1}};
+    chunk->edit_max = {{0, 0, 0}};
+    if (!ok) {
+        _lod_free(chunk);
+        return false;
+    }
+    chunk->lod_ready = true;
+    // As mais finas que sobraram de antes estão velhas
+    chunk->lod_from = chunk->lod_from ? std::min(chunk->lod_from, first) : first;
+    _lod_trim(chunk, first);
+    if (chunk->level >= 1) chunk->dirty = true;
+    return true;
+}
+
+// Chunk que precisa de reduções: montadas aos poucos por _settle
+static void _lod_push(Chunk_Grid *grid, Chunk *chunk) {
+    if (grid->lod_count == grid->lod_capacity) {
+        size_t capacity = grid->lod_capacity ? grid->lod_capacity * 2 : 64;
+        Chunk **queue = (Chunk**)realloc(grid->lod_queue, capacity * sizeof(Chunk*));
+        if (!queue) return; // volta à fila na próxima passada de chunk_grid_page
+        grid->lod_queue = queue;
+        grid->lod_capacity = capacity;
+    }
+    grid->lod_queue[grid->lod_count++] = chunk;
+}
+
+// Perto do caminho do último chunk_grid_prefetch (a até radius + 1 de um dos chunks dele):
+// a imagem foi pedida para ser montada logo
+static bool _near_path(Chunk_Grid *grid, IVector3 coord) {
+    IVector3 from = grid->prefetch_from, to = grid->prefetch_to;
+    IVector3 span = ivec3_abs(ivec3_sub(to, from));
+    int steps = std::max(span.x, std::max(span.y, span.z));
+    for (int i = 0; i <= steps; i++) {
+        float f = steps > 0 ? (float)i / (float)steps : 0.0f;
+        IVector3 center = {{from.x + (int)lroundf((to.x - from.x) * f), from.y + (int)lroundf((to.y - from.y) * f),
+                            from.z + (int)lroundf((to.z - from.z) * f)}};
+        IVector3 d = ivec3_abs(ivec3_sub(coord, center));
+        if (std::max(d.x, std::max(d.y, d.z)) <= grid->radius + 1) return true;
+    }
+    return false;
+}
+
+// Chunk que a GPU só vê reduzido e já tem as reduções não precisa da imagem cheia: com um
+// chunk_store ela volta para o disco na hora (gravada antes, se ele ainda não a tiver),
+// sem esperar o orçamento, e só é lida de novo quando a câmera chega perto ou uma edição
+// pede. Ficam os da faixa radius + 1 e os do caminho da leitura adiantada. Sem
+// chunk_store a imagem é a única cópia do chunk e fica.
+static void _lod_release(Chunk_Grid *grid, Chunk *chunk) {
+    if (!grid->store || !chunk->packed || chunk->tree || chunk->level < 1 || _lod_wanted(chunk)) return;
+    if (_distance(grid, chunk->coord) <= grid->radius + 1 || _near_path(grid, chunk->coord)) return;
+    if (!chunk->stored) {
+        if (!chunk_store_write(grid->store, chunk->coord, chunk->packed->data, chunk->packed->size)) return;
+        chunk->stored = true;
+    }
+    _set_packed(grid, chunk, NULL);
+}
+
+// Guarda o chunk como a imagem .svo da octree compactada. Se não der (memória), ele
+// continua residente. Um chunk que o chunk_store já tem igual só volta para o disco.
+// Antes de soltar a octree, as reduções de um chunk que a janela com LOD ainda vê são
+// postas em dia (e a imagem vai direto para o disco, ver _lod_release); as dos outros
+// são soltas.
+static bool _pack(Chunk_Grid *grid, Chunk *chunk) {
+    if (!chunk->tree) return true;
+    Svo_Map *packed = NULL;
+    if (!chunk->stored && !_is_empty_tree(chunk->tree)) {
+        octree_compact(chunk->tree, 0);
+        size_t size = 0;
+        uint8_t *image = svo_file_encode(chunk->tree, &size);
+        packed = image ? svo_map_from_memory(image, size, false) : NULL;
+        if (!packed) return false;
+    }
+    if (_lod_enabled(grid) && _distance(grid, chunk->coord) <= grid->lod_radius + 1) _lod_build(chunk, chunk->tree);
+    else _lod_free(chunk);
+    _slot_free(grid, chunk);
+    octree_delete(chunk->tree);
+    chunk->tree = NULL;
+    _set_packed(grid, chunk, packed);
+    chunk->used = ++grid->tick;
+    chunk->dirty = chunk->level >= 0 && chunk->lod_ready;
+    _lod_release(grid, chunk);
+    return true;
+}
+
+// --- DISCO ---
+
+// Com um chunk_store, passando do orçamento devolve ao disco as imagens usadas há mais
+// tempo até packed_bytes cair para 3/4 dele (para não varrer a tabela a cada chunk lido).
+// Os chunks a até radius + 1 da câmera ficam presos na memória, e o último usado também
+// (quem acabou de pedir a imagem ainda vai lê-la); uma imagem que o disco ainda não tem é
+// gravada antes de sair.
+static void _evict(Chunk_Grid *grid) {
+    if (!grid->store || grid->packed_bytes <= grid->budget) return;
+    size_t target = grid->budget / 4 * 3;
+    std::vector<Chunk*> candidates;
+    for (size_t i = 0; i < grid->table_capacity; i++) {
+        Chunk *chunk = grid->table[i].chunk;
+        if (!chunk || !chunk->packed || chunk->used == grid->tick) continue;
+        if (grid->radius >= 0 && _distance(grid, chunk->coord) <= grid->radius + 1) continue;
+        candidates.push_back(chunk);
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Chunk *a, const Chunk *b) { return a->used < b->used; });
+    for (Chunk *chunk : candidates) {
+        if (grid->packed_bytes <= target) break;
+        if (!chunk->stored) {
+            if (!chunk_store_write(grid->store, chunk->coord, chunk->packed->data, chunk->packed->size)) continue;
+            chunk->stored = true;
+        }
+        _set_packed(grid, chunk, NULL);
+    }
+}
+
+// Troca a fila de leitura do chunk_store por 'chunks' (o primeiro é lido primeiro)
+static void _request(Chunk_Grid *grid, const std::vector<Chunk*> &chunks) {
+    std::vector<Chunk_Store_Entry> entries;
+    entries.reserve(chunks.size());
+    for (Chunk *chunk : chunks) {
+        Chunk_Store_Entry entry;
+        if (chunk_store_find(grid->store, chunk->coord, &entry)) entries.push_back(entry);
+    }
+    chunk_store_request(grid->store, entries.data(), entries.size());
+    grid->prefetch_stale = true;
+}
+
+// Instala as leituras que chegaram. Uma leitura só vale se o chunk continuar só no disco
+// com a mesma versão; as octrees são montadas depois, aos poucos (ver _settle).
+static void _poll(Chunk_Grid *grid) {
+    if (!grid->store) return;
+    Chunk_Store_Load loads[64];
+    size_t count;
+    while ((count = chunk_store_poll(grid->store, loads, 64)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            Chunk *chunk = chunk_grid_get(grid, loads[i].coord);
+            Chunk_Store_Entry entry;
+            bool current = chunk && _on_disk(chunk) && chunk_store_find(grid->store, chunk->coord, &entry)
+                        && entry.offset == loads[i].offset;
+            if (!current || !loads[i].map) {
+                if (current) {
+                    fprintf(stderr, "Chunks: chunk (%d, %d, %d) ilegível no disco\n", chunk->coord.x, chunk->coord.y, chunk->coord.z);
+                    chunk->stored = false;
+                }
+                svo_map_delete(loads[i].map);
+                continue;
+            }
+            _set_packed(grid, chunk, loads[i].map);
+            chunk->used = ++grid->tick;
+            if (grid->radius < 0) _unpack(grid, chunk);
+            else if (_lod_wanted(chunk)) _lod_push(grid, chunk);
+        }
+    }
+}
+
+static void _register(void *user, const Chunk_Store_Entry *entry) {
+    Chunk_Grid *grid = (Chunk_Grid*)user;
+    IVector3 coord = {{entry->coord[0], entry->coord[1], entry->coord[2]}};
+    if (chunk_grid_get(grid, coord)) return;
+    Chunk *chunk = _add(grid, coord, NULL);
+    if (!chunk) return;
+    chunk->stored = true;
+    chunk->dirty = false;
+}
+
+// Passa a guardar em 'store' (a grade fica dona dele) o que não couber em 'budget' bytes
+// de imagens (0 = CHUNK_CACHE_BUDGET). Com load_index os chunks do arquivo entram no
+// diretório ainda no disco e são lidos quando a câmera chega perto; um chunk que a grade
+// já tem fica com a versão da memória. false se o arquivo for de outro mundo ou a grade
+// já tiver um.
+bool chunk_grid_attach_store(Chunk_Grid *grid, Chunk_Store *store, size_t budget, bool load_index) {
+    if (!grid || !store || grid->store) return false;
+    IVector3 left_bot_back, right_top_front;
+    int chunk_log2 = 0;
+    chunk_store_layout(store, &left_bot_back, &right_top_front, &chunk_log2);
+    if (chunk_log2 != CHUNK_LOG2 || !ivec3_equal_vec(left_bot_back, grid->left_bot_back)
+        || !ivec3_equal_vec(right_top_front, grid->right_top_front)) return false;
+
+    grid->store = store;
+    grid->budget = budget ? budget : CHUNK_CACHE_BUDGET;
+    grid->prefetch_stale = true;
+    if (load_index) chunk_store_for_each(store, _register, grid);
+    return true;
+}
+
+// Chunks da janela com LOD ainda só no disco e sem reduções, do mais perto para o mais
+// longe, até somarem 'budget' bytes
+static void _lod_requests(Chunk_Grid *grid, std::vector<Chunk*> *chunks, size_t budget) {
+    if (!_lod_enabled(grid)) return;
+    std::vector<Chunk*> wanted;
+    IVector3 min, max;
+    if (_window(grid, &min, &max)) {
+        _for_box(grid, ivec3_max(min, grid->chunk_min), ivec3_min(max, grid->chunk_max), [&wanted](Chunk *chunk) {
+            if (_on_disk(chunk) && _lod_wanted(chunk)) wanted.push_back(chunk);
+        });
+    }
+    std::sort(wanted.begin(), wanted.end(), [grid](const Chunk *a, const Chunk *b) {
+        return _distance(grid, a->coord) < _distance(grid, b->coord);
+    });
+    size_t bytes = 0;
+    for (Chunk *chunk : wanted) {
+        Chunk_Store_Entry entry;
+        if (bytes >= budget || !chunk_store_find(grid->store, chunk->coord, &entry)) continue;
+        bytes += entry.size;
+        chunks->push_back(chunk);
+    }
+}
+
+static IVector3 _cell_of(Vector3 position) {
+    return {{(int)floorf(position.x), (int)floorf(position.y), (int)floorf(position.z)}};
+}
+
+// Pede ao chunk_store, em ordem, os chunks ainda no disco que a câmera vai precisar: os da
+// janela dela agora e os que entram na janela ao longo de position + velocity * t, até
+// CHUNK_PREFETCH_SECONDS (posição em células, velocidade em células por segundo), e no fim
+// os que faltam para as reduções da janela com LOD. Os pedidos param em metade do
+// orçamento, para a leitura adiantada não expulsar a si mesma. Só refaz a fila quando a
+// câmera ou o fim do caminho mudam de chunk.
+void chunk_grid_prefetch(Chunk_Grid *grid, Vector3 position, Vector3 velocity) {
+    if (!grid || !grid->store || grid->radius < 0) return;
+    Vector3 end = vec3_add(position, vec3_scalar_mul(velocity, CHUNK_PREFETCH_SECONDS));
+    IVector3 from = _chunk_of(_cell_of(position)), to = _chunk_of(_cell_of(end));
+    if (!grid->prefetch_stale && ivec3_equal_vec(from, grid->prefetch_from) && ivec3_equal_vec(to, grid->prefetch_to)) return;
+
+    IVector3 world_min = _chunk_of(grid->left_bot_back);
+    IVector3 world_max = _chunk_of(ivec3_scalar_sub(grid->right_top_front, 1));
+    IVector3 span = ivec3_abs(ivec3_sub(to, from));
+    int steps = std::max(span.x, std::max(span.y, span.z));
+    std::vector<Chunk*> chunks;
+    std::unordered_set<Chunk*> seen;
+    size_t bytes = 0;
+    IVector3 last_min = {{1, 1, 1}}, last_max = {{0, 0, 0}};
+    for (int i = 0; i <= steps && bytes < grid->budget / 2; i++) {
+        float f = steps > 0 ? (float)i / (float)steps : 0.0f;
+        IVector3 center = _chunk_of(_cell_of(vec3_add(position, vec3_scalar_mul(vec3_sub(end, position), f))));
+        IVector3 lo = ivec3_max(ivec3_scalar_sub(center, grid->radius), world_min);
+        IVector3 hi = ivec3_min(ivec3_scalar_add(center, grid->radius), world_max);
+        size_t first = chunks.size();
+        for (int z = lo.z; z <= hi.z; z++)
+        for (int y = lo.y; y <= hi.y; y++)
+        for (int x = lo.x; x <= hi.x; x++) {
+            // A janela da amostra anterior já foi vista
+            if (x >= last_min.x && y >= last_min.y && z >= last_min.z && x <= last_max.x && y <= last_max.y && z <= last_max.z) continue;
+            Chunk *chunk = chunk_grid_get(grid, {{x, y, z}});
+            if (chunk && _on_disk(chunk) && seen.insert(chunk).second) chunks.push_back(chunk);
+        }
+        last_min = lo;
+        last_max = hi;
+        // Os mais perto do centro da amostra primeiro
+        std::sort(chunks.begin() + first, chunks.end(), [center](const Chunk *a, const Chunk *b) {
+            IVector3 da = ivec3_abs(ivec3_sub(a->coord, center)), db = ivec3_abs(ivec3_sub(b->coord, center));
+            return std::max(da.x, std::max(da.y, da.z)) < std::max(db.x, std::max(db.y, db.z));
+        });
+        for (size_t j = first; j < chunks.size(); j++) {
+            Chunk_Store_Entry entry;
+            if (chunk_store_find(grid->store, chunks[j]->coord, &entry)) bytes += entry.size;
+        }
+    }
+    std::vector<Chunk*> distant;
+    if (bytes < grid->budget / 2) _lod_requests(grid, &distant, grid->budget / 2 - bytes);
+    for (Chunk *chunk : distant) {
+        if (seen.insert(chunk).second) chunks.push_back(chunk);
+    }
+    _request(grid, chunks);
+    grid->prefetch_from = from;
+    grid->prefetch_to = to;
+    grid->prefetch_stale = false;
+}
+
+// Grava no chunk_store o que ele ainda não tem (chunks editados, residentes ou guardados)
+// e depois o índice; os chunks continuam onde estão. Os que ficaram vazios saem do índice.
+bool chunk_grid_save(Chunk_Grid *grid) {
+    if (!grid || !grid->store) return false;
+    bool ok = true;
+    for (size_t i = 0; i < grid->table_capacity; i++) {
+        Chunk *chunk = grid->table[i].chunk;
+        if (!chunk || chunk->stored) continue;
+        if (chunk->tree && !_is_empty_tree(chunk->tree)) {
+            octree_compact(chunk->tree, 0);
+            size_t size = 0;
+            uint8_t *image = svo_file_encode(chunk->tree, &size);
+            chunk->stored = image && chunk_store_write(grid->store, chunk->coord, image, size);
+            free(image);
+            ok = ok && chunk->stored;
+        } else if (chunk->packed && !svo_map_is_empty(chunk->packed)) {
+            chunk->stored = chunk_store_write(grid->store, chunk->coord, chunk->packed->data, chunk->packed->size);
+            ok = ok && chunk->stored;
+        } else {
+            ok = chunk_store_write(grid->store, chunk->coord, NULL, 0) && ok;
+        }
+    }
+    return chunk_store_flush(grid->store) && ok;
+}
+
+// Chunks a até 'radius' (em chunks) de 'center' (coordenadas de chunk, ver
+// CHUNK_LOG2) ficam residentes; os que passam de radius + 1 são guardados (a faixa entre
+// os dois evita guardar e montar de novo a cada passo na borda). radius < 0 desliga a
+// paginação: tudo fica residente. Chamada a cada quadro, mesmo parada a câmera: é quando
+// as leituras do disco entram e o resto do trabalho é feito aos poucos (ver _settle).
+// Retorna true se o diretório da GPU mudou.
+// Residente que passou da faixa: guardado aos poucos por _settle (soltar as octrees de
+// um lado inteiro de chunks num quadro só também pesa)
+static void _leave(Chunk_Grid *grid, Chunk *chunk) {
+    if (grid->leaving_count == grid->leaving_capacity) {
+        size_t capacity = grid->leaving_capacity ? grid->leaving_capacity * 2 : 64;
+        Chunk **leaving = (Chunk**)realloc(grid->leaving, capacity * sizeof(Chunk*));
+        if (!leaving) {
+            _pack(grid, chunk);
+            return;
+        }
+        grid->leaving = leaving;
+        grid->leaving_capacity = capacity;
+    }
+    grid->leaving[grid->leaving_count++] = chunk;
+}
+
+// Trabalho da paginação espalhado pelos quadros, até 'budget_ms': monta as octrees dos
+// chunks guardados dentro do raio (os que chegaram do disco), guarda os que saíram da
+// faixa e monta os da faixa radius + 1, que entram no raio no próximo passo da câmera.
+// Os mais perto do centro primeiro. Com o tempo que sobrar, as reduções da janela com LOD,
+// soltando as imagens que só serviram para elas.
+static void _settle(Chunk_Grid *grid, double budget_ms) {
+    if (grid->radius < 0) return;
+    auto start = std::chrono::steady_clock::now();
+    auto spent = [start, budget_ms]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= budget_ms;
+    };
+    int ring = grid->radius + 1;
+    std::vector<Chunk*> ready;
+    _for_box(grid, ivec3_scalar_sub(grid->center, ring), ivec3_scalar_add(grid->center, ring), [&ready](Chunk *chunk) {
+        if (!chunk->tree && chunk->packed) ready.push_back(chunk);
+    });
+    IVector3 center = grid->center;
+    std::sort(ready.begin(), ready.end(), [grid, center](const Chunk *a, const Chunk *b) {
+        int ca = _distance(grid, a->coord), cb = _distance(grid, b->coord);
+        if (ca != cb) return ca < cb;
+        IVector3 da = ivec3_sub(a->coord, center), db = ivec3_sub(b->coord, center);
+        return ivec3_dot(da, da) < ivec3_dot(db, db);
+    });
+
+    // Os de dentro do raio e os que saíram se alternam, para nenhum dos dois se acumular
+    size_t next = 0;
+    while (!spent()) {
+        bool inside = next < ready.size() && _distance(grid, ready[next]->coord) <= grid->radius;
+        if (!inside && grid->leaving_count == 0) break;
+        if (inside) _unpack(grid, ready[next++]);
+        if (grid->leaving_count > 0) {
+            Chunk *chunk = grid->leaving[--grid->leaving_count];
+            if (_distance(grid, chunk->coord) > ring) _pack(grid, chunk);
+        }
+    }
+    for (; next < ready.size() && !spent(); next++) _unpack(grid, ready[next]);
+
+    bool queued = grid->lod_count > 0;
+    while (grid->lod_count > 0 && !spent()) {
+        Chunk *chunk = grid->lod_queue[--grid->lod_count];
+        if (!_lod_wanted(chunk)) continue;
+        if (chunk->tree) {
+            _lod_build(chunk, chunk->tree);
+        } else if (chunk->packed) {
+            // A octree só existe enquanto as reduções são feitas
+            Octree *tree = svo_map_to_octree(chunk->packed);
+            if (tree) _lod_build(chunk, tree);
+            octree_delete(tree);
+            _lod_release(grid, chunk);
+        }
+    }
+    // O lote de leituras para as reduções acabou: a leitura adiantada pede o próximo
+    if (queued && grid->lod_count == 0 && grid->store && _lod_enabled(grid)) grid->prefetch_stale = true;
+}
+
+// Alcance (em chunks) do que a paginação mantém: a faixa residente, ou a janela com LOD
+// mais uma faixa (as reduções saem só além dela, como as octrees)
+static int _reach(Chunk_Grid *grid) {
+    return _gpu_radius(grid) + 1;
+}
+
+bool chunk_grid_page(Chunk_Grid *grid, IVector3 center, int radius) {
+    if (!grid) return false;
+    _poll(grid);
+    bool moved = radius != grid->radius || (radius >= 0 && !ivec3_equal_vec(center, grid->center));
+    if (!moved && !grid->loose) {
+        _settle(grid, CHUNK_SETTLE_BUDGET_MS);
+        return grid->gpu_dirty;
+    }
+    // Sem edições longe, só os chunks da janela antiga (com a faixa) e da nova podem mudar.
+    // Andando, o lado que acabou de sair da faixa é guardado aos poucos; num salto ou numa
+    // troca de raio tudo de uma vez.
+    IVector3 lo = grid->chunk_min, hi = grid->chunk_max;
+    bool step = radius >= 0 && radius == grid->radius;
+    if (!grid->loose && grid->radius >= 0 && radius >= 0) {
+        IVector3 old_center = grid->center;
+        int old_reach = _reach(grid);
+        grid->radius = radius;
+        lo = ivec3_max(ivec3_min(ivec3_scalar_sub(old_center, old_reach), ivec3_scalar_sub(center, _reach(grid))), lo);
+        hi = ivec3_min(ivec3_max(ivec3_scalar_add(old_center, old_reach), ivec3_scalar_add(center, _reach(grid))), hi);
+    }
+    grid->center = center;
+    grid->radius = radius;
+    grid->loose = false;
+    grid->lod_count = 0;
+
+    // Os que ainda estão no disco são pedidos, do mais perto para o mais longe, e aparecem
+    // vazios até chegarem (ver _poll)
+    std::vector<Chunk*> missing;
+    _for_box(grid, lo, hi, [grid, radius, step, &missing](Chunk *chunk) {
+        int distance = radius >= 0 ? _distance(grid, chunk->coord) : 0;
+        int level = _level(grid, chunk->coord);
+        if (level != chunk->level) {
+            chunk->level = level;
+            chunk->dirty = true;
+        }
+        if (distance <= radius || radius < 0) {
+            if (_on_disk(chunk)) missing.push_back(chunk);
+            else if (!chunk->tree && _has_content(chunk)) _unpack(grid, chunk);
+        } else if (distance > radius + 1) {
+            if (step && distance == radius + 2 && chunk->tree) _leave(grid, chunk);
+            else _pack(grid, chunk);
+        }
+        _lod_trim(chunk, chunk->level);
+        if (!_lod_enabled(grid) || distance > grid->lod_radius + 1) _lod_free(chunk);
+        else if (_lod_wanted(chunk) && !_on_disk(chunk)) _lod_push(grid, chunk);
+        else _lod_release(grid, chunk);
+        if (!_in_window(grid, chunk->coord)) _slot_free(grid, chunk);
+        else if ((chunk->tree || chunk->lod_ready) && chunk->base == CHUNK_SLOT_NONE) chunk->dirty = true;
+    });
+    // As reduções mais perto primeiro (saem do fim da fila)
+    std::sort(grid->lod_queue, grid->lod_queue + grid->lod_count, [grid](const Chunk *a, const Chunk *b) {
+        return _distance(grid, a->coord) > _distance(grid, b->coord);
+    });
+    if (grid->store) {
+        std::sort(missing.begin(), missing.end(), [grid](const Chunk *a, const Chunk *b) {
+            return _distance(grid, a->coord) < _distance(grid, b->coord);
+        });
+        _lod_requests(grid, &missing, grid->budget / 2);
+        _request(grid, missing);
+        _evict(grid);
+    }
+    if (moved) grid->gpu_dirty = true;
+    return grid->gpu_dirty;
+}
+
+// Liga as reduções além do raio residente: a janela na GPU vai até 'radius' chunks, cada
+// um no nível que o tamanho dele na tela pede (ver _level), com 'pixels_per_radian' =
+// altura da tela / (2 tan(fov vertical / 2)). radius <= o raio residente ou
+// pixels_per_radian <= 0 desliga. Vale a partir da próxima chunk_grid_page.
+void chunk_grid_set_lod(Chunk_Grid *grid, int radius, float pixels_per_radian) {
+    if (!grid) return;
+    if (pixels_per_radian <= 0.0f) radius = 0;
+    if (radius == grid->lod_radius && pixels_per_radian == grid->lod_scale) return;
+    grid->lod_radius = radius;
+    grid->lod_scale = pixels_per_radian;
+    grid->lod_pixels = CHUNK_LOD_PIXELS;
+    // Níveis e reduções de todos os chunks podem mudar: a próxima página passa por todos
+    grid->loose = true;
+}
+
+// --- EDIÇÃO ---
+
+int chunk_grid_insert(Chunk_Grid *grid, Voxel_Object voxel) {
+    if (!grid) return -1;
+    IVector3 c = voxel.coord;
+    if (c.x < grid->left_bot_back.x || c.y < grid->left_bot_back.y || c.z < grid->left_bot_back.z
+        || c.x >= grid->right_top_front.x || c.y >= grid->right_top_front.y || c.z >= grid->right_top_front.z) return 0;
+
+    Chunk *chunk = _get_or_create(grid, _chunk_of(c));
+    Octree *tree = chunk ? _unpack(grid, chunk) : NULL;
+    if (!tree) return -1;
+    octree_insert(tree, voxel);
+    _touch(chunk, c, c);
+    return 0;
+}
+
+Voxel_Object chunk_grid_find(Chunk_Grid *grid, IVector3 coord) {
+    Chunk *chunk = chunk_grid_get(grid, _chunk_of(coord));
+    if (!chunk) return _invalid_voxel();
+    if (chunk->tree) return octree_find(chunk->tree, coord);
+    return svo_map_find(_packed(grid, chunk), coord);
+}
+
+// Só monta a octree de um chunk guardado se houver algo para apagar
+void chunk_grid_remove(Chunk_Grid *grid, IVector3 coord) {
+    if (chunk_grid_find(grid, coord).coord.y == _invalid_voxel().coord.y) return;
+    Chunk *chunk = chunk_grid_get(grid, _chunk_of(coord));
+    Octree *tree = _unpack(grid, chunk);
+    if (!tree) return;
+    octree_remove(tree, coord);
+    _touch(chunk, coord, coord);
+}
+
+// Parte de [min, max] (inclusivos) dentro do chunk e do mundo
+static bool _clip_to_chunk(Chunk_Grid *grid, IVector3 chunk_coord, IVector3 *min, IVector3 *max) {
+    IVector3 lo = ivec3_scalar_mul(chunk_coord, CHUNK_SIZE);
+    IVector3 hi = ivec3_scalar_add(lo, CHUNK_SIZE - 1);
+    *min = ivec3_max(ivec3_max(*min, lo), grid->left_bot_back);
+    *max = ivec3_min(ivec3_min(*max, hi), ivec3_scalar_sub(grid->right_top_front, 1));
+    return !_box_is_empty(*min, *max);
+}
+
+// Preenche [vox_min, vox_max] (inclusivos) com o material de 'voxel', chunk por chunk
+// (ver octree_fill)
+void chunk_grid_fill(Chunk_Grid *grid, IVector3 vox_min, IVector3 vox_max, Voxel_Object voxel) {
+    if (!grid) return;
+    IVector3 min = ivec3_min(vox_min, vox_max), max = ivec3_max(vox_min, vox_max);
+    IVector3 c0 = _chunk_of(min), c1 = _chunk_of(max);
+    for (int z = c0.z; z <= c1.z; z++)
+    for (int y = c0.y; y <= c1.y; y++)
+    for (int x = c0.x; x <= c1.x; x++) {
+        IVector3 lo = min, hi = max;
+        if (!_clip_to_chunk(grid, {{x, y, z}}, &lo, &hi)) continue;
+        Chunk *chunk = _get_or_create(grid, {{x, y, z}});
+        Octree *tree = chunk ? _unpack(grid, chunk) : NULL;
+        if (!tree) return;
+        octree_fill(tree, lo, hi, voxel);
+        _touch(chunk, lo, hi);
+    }
+}
+
+void chunk_grid_clear(Chunk_Grid *grid, IVector3 vox_min, IVector3 vox_max) {
+    if (!grid) return;
+    IVector3 min = ivec3_min(vox_min, vox_max), max = ivec3_max(vox_min, vox_max);
+    IVector3 c0 = _chunk_of(min), c1 = _chunk_of(max);
+    for (int z = c0.z; z <= c1.z; z++)
+    for (int y = c0.y; y <= c1.y; y++)
+    for (int x = c0.x; x <= c1.x; x++) {
+        Chunk *chunk = chunk_grid_get(grid, {{x, y, z}});
+        IVector3 lo = min, hi = max;
+        if (!chunk || !_has_content(chunk) || !_clip_to_chunk(grid, {{x, y, z}}, &lo, &hi)) continue;
+        Octree *tree = _unpack(grid, chunk);
+        if (!tree) continue;
+        octree_clear(tree, lo, hi);
+        _touch(chunk, lo, hi);
+    }
+}
+
+// Como octree_extract, juntando os pedaços de cada chunk (os guardados são montados só
+// para a cópia)
+Octree *chunk_grid_extract(Chunk_Grid *grid, IVector3 vox_min, IVector3 vox_max) {
+    if (!grid) return NULL;
+    IVector3 min = ivec3_min(vox_min, vox_max), max = ivec3_max(vox_min, vox_max);
+    IVector3 extent = ivec3_scalar_add(ivec3_sub(max, min), 1);
+    int size = 1;
+    while (size < extent.x || size < extent.y || size < extent.z) size *= 2;
+    Octree *clip = octree_create(NULL, {{0, 0, 0}}, {{size, size, size}});
+    if (!clip) return NULL;
+
+    Voxel_Transform transform = voxel_transform_translation(ivec3_negate(min));
+    IVector3 c0 = _chunk_of(min), c1 = _chunk_of(max);
+    for (int z = c0.z; z <= c1.z; z++)
+    for (int y = c0.y; y <= c1.y; y++)
+    for (int x = c0.x; x <= c1.x; x++) {
+        Chunk *chunk = chunk_grid_get(grid, {{x, y, z}});
+        IVector3 lo = min, hi = max;
+        if (!chunk || !_has_content(chunk) || !_clip_to_chunk(grid, {{x, y, z}}, &lo, &hi)) continue;
+        Octree *tree = chunk->tree ? chunk->tree : svo_map_to_octree(_packed(grid, chunk));
+        octree_paste(clip, tree, &transform, lo, hi);
+        if (tree != chunk->tree) octree_delete(tree);
+    }
+    return clip;
+}
+
+// Como octree_paste: as células de 'src' em [src_min, src_max] (inclusivos) levadas por
+// 'transform'. Cada chunk recebe só a parte de 'src' que cai nele; chunks novos só entram
+// no diretório se receberem algum voxel (colar o mundo inteiro não cria os de ar).
+bool chunk_grid_paste(Chunk_Grid *grid, Octree *src, const Voxel_Transform *transform, IVector3 src_min, IVector3 src_max) {
+    if (!grid || !src || !transform) return false;
+    IVector3 region_min = ivec3_min(src_min, src_max), region_max = ivec3_max(src_min, src_max);
+    src_min = ivec3_max(region_min, src->left_bot_back);
+    src_max = ivec3_min(region_max, ivec3_scalar_sub(src->right_top_front, 1));
+    if (_box_is_empty(src_min, src_max)) return false;
+    IVector3 a = voxel_transform_cell(transform, src_min), b = voxel_transform_cell(transform, src_max);
+    IVector3 min = ivec3_min(a, b), max = ivec3_max(a, b);
+
+    bool pasted = false;
+    IVector3 c0 = _chunk_of(min), c1 = _chunk_of(max);
+    for (int z = c0.z; z <= c1.z; z++)
+    for (int y = c0.y; y <= c1.y; y++)
+    for (int x = c0.x; x <= c1.x; x++) {
+        IVector3 lo = min, hi = max;
+        if (!_clip_to_chunk(grid, {{x, y, z}}, &lo, &hi)) continue;
+        IVector3 la = voxel_transform_local_cell(transform, lo), lb = voxel_transform_local_cell(transform, hi);
+        IVector3 local_min = ivec3_max(ivec3_min(la, lb), src_min), local_max = ivec3_min(ivec3_max(la, lb), src_max);
+        if (_box_is_empty(local_min, local_max)) continue;
+
+        Chunk *chunk = chunk_grid_get(grid, {{x, y, z}});
+        if (!chunk) {
+            Octree *tree = _chunk_tree({{x, y, z}});
+            if (!tree) return pasted;
+            if (!octree_paste(tree, src, transform, local_min, local_max)) {
+                octree_delete(tree);
+                continue;
+            }
+            if (!_add(grid, {{x, y, z}}, tree)) {
+                octree_delete(tree);
+                return pasted;
+            }
+            pasted = true;
+            continue;
+        }
+        Octree *tree = _unpack(grid, chunk);
+        if (!tree) return pasted;
+        if (octree_paste(tree, src, transform, local_min, local_max)) {
+            _touch(chunk, lo, hi);
+            pasted = true;
+        }
+    }
+    return pasted;
+}
+
+// --- RAIOS ---
+
+// DDA sobre a grade de chunks; em cada chunk com conteúdo o raio começa no ponto de
+// entrada (as marchas da octree e do .svo param ao sair da caixa da raiz). O primeiro
+// acerto é o mais próximo, porque os chunks são visitados em ordem.
+bool chunk_grid_ray_cast(Chunk_Grid *grid, Ray ray, Voxel_Object *hit) {
+    if (!grid || grid->count == 0) return false;
+
+    float o[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+    float d[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+    float lo[3] = {(float)grid->left_bot_back.x, (float)grid->left_bot_back.y, (float)grid->left_bot_back.z};
+    float hi[3] = {(float)grid->right_top_front.x, (float)grid->right_top_front.y, (float)grid->right_top_front.z};
+    float inv[3];
+    float t_enter = 0.0f, t_exit = 1e30f;
+    for (int a = 0; a < 3; a++) {
+        inv[a] = fabsf(d[a]) < 1e-8f ? 1e20f : 1.0f / d[a];
+        if (fabsf(d[a]) < 1e-8f) {
+            if (o[a] < lo[a] || o[a] >= hi[a]) return false;
+            continue;
+        }
+        float t0 = (lo[a] - o[a]) * inv[a], t1 = (hi[a] - o[a]) * inv[a];
+        if (t0 > t1) std::swap(t0, t1);
+        t_enter = std::max(t_enter, t0);
+        t_exit = std::min(t_exit, t1);
+    }
+    if (t_enter > t_exit) return false;
+
+    int cell[3], step[3];
+    float t_max[3];
+    for (int a = 0; a < 3; a++) {
+        float p = std::min(std::max(o[a] + d[a] * t_enter, lo[a]), hi[a] - 1e-3f);
+        cell[a] = (int)floorf(p) >> CHUNK_LOG2;
+        step[a] = d[a] > 0.0f ? 1 : -1;
+        if (fabsf(d[a]) < 1e-8f) {
+            t_max[a] = 1e30f;
+            continue;
+        }
+        float boundary = (float)((cell[a] + (d[a] > 0.0f ? 1 : 0)) * CHUNK_SIZE);
+        t_max[a] = (boundary - o[a]) * inv[a];
+    }
+
+    float t = t_enter;
+    while (t <= t_exit) {
+        IVector3 coord = {{cell[0], cell[1], cell[2]}};
+        Chunk *chunk = chunk_grid_get(grid, coord);
+        if (chunk && _has_content(chunk)) {
+            IVector3 box_min = ivec3_scalar_mul(coord, CHUNK_SIZE);
+            float c_lo[3] = {(float)box_min.x, (float)box_min.y, (float)box_min.z};
+            // Entra um pouco ao longo do raio (prender só a coordenada o desviaria da reta);
+            // a trava só corrige o arredondamento
+            float entry[3];
+            for (int a = 0; a < 3; a++) {
+                float low = std::max(c_lo[a], lo[a]), high = std::min(c_lo[a] + CHUNK_SIZE, hi[a]);
+                entry[a] = std::min(std::max(o[a] + d[a] * (t + 1e-4f), low), high - 1e-4f);
+            }
+            Ray local = ray;
+            local.origin = vec3_float(entry[0], entry[1], entry[2]);
+            Vector3 min = vec3_ivec3(box_min), max = vec3_ivec3(ivec3_scalar_add(box_min, CHUNK_SIZE));
+            if (chunk->tree ? octree_ray_cast_voxel(chunk->tree, local, min, max, hit)
+                            : svo_map_ray_cast(_packed(grid, chunk), local, hit)) return true;
+        }
+
+        // t_max sempre recalculado da parede (somar passos acumularia erro com a distância)
+        int axis = (t_max[0] < t_max[1]) ? ((t_max[0] < t_max[2]) ? 0 : 2) : ((t_max[1] < t_max[2]) ? 1 : 2);
+        t = t_max[axis];
+        cell[axis] += step[axis];
+        t_max[axis] = ((float)((cell[axis] + (step[axis] > 0 ? 1 : 0)) * CHUNK_SIZE) - o[axis]) * inv[axis];
+    }
+    return false;
+}
+
+// --- TEXTURA ---
+
+static Octree *_texture_root(Chunk *chunk) {
+    return chunk->tree && !_is_empty_tree(chunk->tree) ? chunk->tree : NULL;
+}
+
+// O que vai para a vaga do chunk no nível dele: a octree residente ou uma redução. Longe,
+// um chunk ainda sem reduções vai com a octree se tiver uma; perto, um que ainda não foi
+// montado fica com a redução mais fina até a octree chegar. false = nada (ar ou fora da
+// janela).
+static bool _gpu_source(Chunk *chunk, Octree **tree, Chunk_Lod **lod) {
+    *tree = NULL;
+    *lod = NULL;
+    if (chunk->level < 0) return false;
+    if (chunk->tree && (chunk->level < chunk->lod_from || !chunk->lod_ready)) {
+        *tree = _texture_root(chunk);
+        return *tree != NULL;
+    }
+    if (!chunk->lod_ready) return false;
+    *lod = _lod_drawn(chunk);
+    return (*lod)->texels != NULL;
+}
+
+static size_t _gpu_texels(Octree *tree, Chunk_Lod *lod) {
+    return tree ? _octree_texel_size(tree) : lod->count;
+}
+
+static void _gpu_write(Octree *tree, Chunk_Lod *lod, uint8_t *texture, size_t base) {
+    if (tree) octree_texture_write(tree, texture, base);
+    else octree_texture_copy(lod->texels, lod->count, lod->root, texture, base);
+}
+
+// Com a janela maior que a textura, sobe lod_pixels (a célula aceita na tela) até ela caber
+// com a reserva da arena: os anéis de longe passam antes para a redução seguinte, e só se
+// todos já estiverem na mais grossa os de longe ficam de fora. Fica assim até a próxima
+// chunk_grid_set_lod (voltar atrás a cada textura pediria as reduções finas de novo).
+static void _lod_fit(Chunk_Grid *grid) {
+    IVector3 min, max;
+    if (!_lod_enabled(grid) || !_window(grid, &min, &max)) return;
+    std::vector<Chunk*> reduced;
+    size_t fixed = 1;
+    _for_box(grid, min, max, [&reduced, &fixed](Chunk *chunk) {
+        Octree *tree;
+        Chunk_Lod *lod;
+        if (!_gpu_source(chunk, &tree, &lod)) return;
+        if (lod && chunk->level >= 1) reduced.push_back(chunk);
+        else fixed += _slot_capacity(_gpu_texels(tree, lod));
+    });
+    while (_level_at(grid, grid->radius + 1) < CHUNK_LOD_LEVELS) {
+        size_t total = fixed + CHUNK_ARENA_RESERVE;
+        for (Chunk *chunk : reduced) {
+            const Chunk_Lod *lod = _lod_drawn(chunk);
+            if (lod->texels) total += _slot_capacity(lod->count);
+        }
+        if (total <= TEXTURE_MAX_TEXELS) return;
+        grid->lod_pixels *= CHUNK_LOD_SQUEEZE;
+        for (Chunk *chunk : reduced) {
+            chunk->level = _level(grid, chunk->coord);
+            _lod_trim(chunk, chunk->level);
+        }
+    }
+}
+
+// Textura dos chunks da janela (no nível de cada um): cada um numa vaga com folga, depois
+// CHUNK_ARENA_RESERVE texels livres para chunk_grid_write_texture. O texel 0 fica vazio
+// (a raiz de um mundo sem chunks); as instâncias e os objetos vêm depois da arena.
+uint8_t *chunk_grid_texture(Chunk_Grid *grid, size_t *arr_size) {
+    if (!grid || !arr_size) return NULL;
+    grid->hole_count = 0;
+    _lod_fit(grid);
+    std::vector<Chunk*> placed;
+    for (size_t i = 0; i < grid->table_capacity; i++) {
+        Chunk *chunk = grid->table[i].chunk;
+        if (!chunk) continue;
+        chunk->base = CHUNK_SLOT_NONE;
+        chunk->capacity = 0;
+        chunk->dirty = chunk->tree != NULL || chunk->lod_ready;
+        Octree *tree;
+        Chunk_Lod *lod;
+        if (_gpu_source(chunk, &tree, &lod) && _in_window(grid, chunk->coord)) placed.push_back(chunk);
+    }
+    // Com a janela maior que a textura, os de longe é que ficam de fora
+    if (grid->radius >= 0) {
+        std::sort(placed.begin(), placed.end(), [grid](const Chunk *a, const Chunk *b) {
+            return _distance(grid, a->coord) < _distance(grid, b->coord);
+        });
+    }
+    size_t total = 1, left_out = 0;
+    for (Chunk *chunk : placed) {
+        Octree *tree;
+        Chunk_Lod *lod;
+        _gpu_source(chunk, &tree, &lod);
+        size_t capacity = _slot_capacity(_gpu_texels(tree, lod));
+        if (total + capacity > TEXTURE_MAX_TEXELS) {
+            left_out++;
+            continue;
+        }
+        chunk->base = total;
+        chunk->capacity = capacity;
+        total += capacity;
+    }
+    if (left_out) fprintf(stderr, "Chunks: textura cheia, %zu chunks ficam fora da GPU\n", left_out);
+    grid->arena_end = total;
+    total += std::min((size_t)CHUNK_ARENA_RESERVE, TEXTURE_MAX_TEXELS - total);
+    grid->arena_limit = total;
+
+    uint8_t *texture = (uint8_t*)calloc(total, 4);
+    if (!texture) {
+        grid->arena_end = grid->arena_limit = 0;
+        *arr_size = 0;
+        return NULL;
+    }
+    for (size_t i = 0; i < grid->table_capacity; i++) {
+        Chunk *chunk = grid->table[i].chunk;
+        Octree *tree;
+        Chunk_Lod *lod;
+        if (!chunk || chunk->base == CHUNK_SLOT_NONE || !_gpu_source(chunk, &tree, &lod)) continue;
+        _gpu_write(tree, lod, texture, chunk->base);
+        chunk->dirty = false;
+    }
+    grid->gpu_dirty = true;
+    *arr_size = total * 4;
+    return texture;
+}
+
+// Regrava em 'texture' (a cópia na CPU da última textura, com 'texel_capacity' texels)
+// só os chunks da janela que mudaram, trocaram de nível ou acabaram de entrar; cada faixa
+// regravada vai para 'fn'. false: não coube na arena, refaça a textura inteira.
+bool chunk_grid_write_texture(Chunk_Grid *grid, uint8_t *texture, size_t texel_capacity,
+                              void (*fn)(void *user, size_t first, size_t count), void *user) {
+    if (!grid) return true;
+
+    size_t limit = std::min(std::min(texel_capacity, grid->arena_limit), (size_t)TEXTURE_MAX_TEXELS);
+    IVector3 min, max;
+    if (!_window(grid, &min, &max)) return true;
+    bool fits = true;
+    _for_box(grid, min, max, [&](Chunk *chunk) {
+        if (!fits || !chunk->dirty) return;
+
+        Octree *tree;
+        Chunk_Lod *lod;
+        if (!_gpu_source(chunk, &tree, &lod)) {
+            _slot_free(grid, chunk);
+            chunk->dirty = false;
+            return;
+        }
+        size_t texels = _gpu_texels(tree, lod);
+        fits = texture && grid->arena_end != 0
+            && ((chunk->base != CHUNK_SLOT_NONE && texels <= chunk->capacity) || _slot_place(grid, chunk, texels, limit));
+        if (!fits) return;
+        _slot_trim(grid, chunk, texels);
+        // A raiz pode ter trocado entre folha e nó interno
+        grid->gpu_dirty = true;
+        _gpu_write(tree, lod, texture, chunk->base);
+        chunk->dirty = false;
+        if (fn) fn(user, chunk->base, texels);
+    });
+    return fits;
+}
+
+// Diretório para o shader (SSBO de int, std430): [0..2] chunk mínimo da janela,
+// [3] CHUNK_LOG2, [4..6] chunks da janela em cada eixo, [7] 0; depois 2 ints por chunk
+// da janela (x mais rápido): texel da raiz (-1 = vazio ou fora da GPU) e flags da raiz.
+// Com grid = NULL só o cabeçalho zerado (mundo sem chunks).
+int32_t *chunk_grid_gpu_buffer(Chunk_Grid *grid, size_t *arr_size) {
+    if (!arr_size) return NULL;
+    IVector3 min = {{0, 0, 0}}, max = {{-1, -1, -1}};
+    if (grid && !_window(grid, &min, &max)) max = ivec3_scalar_sub(min, 1);
+    IVector3 dims = grid ? ivec3_scalar_add(ivec3_sub(max, min), 1) : ivec3_zero();
+    size_t entries = (size_t)dims.x * (size_t)dims.y * (size_t)dims.z;
+
+    int32_t *buffer = (int32_t*)malloc((8 + 2 * entries) * sizeof(int32_t));
+    if (!buffer) return NULL;
+    *arr_size = (8 + 2 * entries) * sizeof(int32_t);
+    memset(buffer, 0, 8 * sizeof(int32_t));
+    for (size_t i = 0; i < entries; i++) {
+        buffer[8 + 2 * i] = -1;
+        buffer[9 + 2 * i] = 0;
+    }
+    if (!grid) return buffer;
+
+    buffer[0] = min.x;
+    buffer[1] = min.y;
+    buffer[2] = min.z;
+    buffer[3] = CHUNK_LOG2;
+    buffer[4] = dims.x;
+    buffer[5] = dims.y;
+    buffer[6] = dims.z;
+    _for_box(grid, min, max, [&](Chunk *chunk) {
+        Octree *tree;
+        Chunk_Lod *lod;
+        if (chunk->base == CHUNK_SLOT_NONE || !_gpu_source(chunk, &tree, &lod)) return;
+        IVector3 local = ivec3_sub(chunk->coord, min);
+        size_t index = 8 + 2 * ((size_t)local.x + (size_t)dims.x * ((size_t)local.y + (size_t)dims.y * (size_t)local.z));
+        bool leaf = tree ? !tree->children : (lod->root[2] & (POINTER_LEAF_FLAG >> 16)) != 0;
+        bool point = tree ? tree->is_point : lod->root[3] == POINTER_POINT_FLAG;
+        buffer[index] = (int32_t)chunk->base;
+        buffer[index + 1] = (leaf ? GPU_ROOT_LEAF : 0) | (leaf && point ? GPU_ROOT_POINT : 0);
+    });
+    grid->gpu_dirty = false;
+    return buffer;
+}
+
+// --- CONVERSÕES ---
+
+// Uma octree só com a caixa dada, os chunks enxertados nela (ver octree_paste)
+Octree *chunk_grid_to_octree(Chunk_Grid *grid, IVector3 left_bot_back, IVector3 right_top_front) {
+    if (!grid) return NULL;
+    Octree *tree = octree_create(NULL, left_bot_back, right_top_front);
+    if (!tree) return NULL;
+    Voxel_Transform identity = voxel_transform_identity();
+    for (size_t i = 0; i < grid->table_capacity; i++) {
+        Chunk *chunk = grid->table[i].chunk;
+        if (!chunk || !_has_content(chunk)) continue;
+        Octree *part = chunk->tree ? chunk->tree : svo_map_to_octree(_packed(grid, chunk));
+        IVector3 min = _chunk_min(chunk);
+        octree_paste(tree, part, &identity, min, ivec3_scalar_add(min, CHUNK_SIZE - 1));
+        if (part != chunk->tree) octree_delete(part);
+    }
+    return tree;
+}
+
+void chunk_grid_for_each(Chunk_Grid *grid, void (*fn)(void *user, Voxel_Object voxel), void *user) {
+    if (!grid || !fn) return;
+    for (size_t i = 0; i < grid->table_capacity; i++) {
+        Chunk *chunk = grid->table[i].chunk;
+        if (!chunk || !_has_content(chunk)) continue;
+        if (chunk->tree) {
+            octree_for_each(chunk->tree, fn, user);
+            continue;
+        }
+        Octree *tree = svo_map_to_octree(_packed(grid, chunk));
+        octree_for_each(tree, fn, user);
+        octree_delete(tree);
+    }
+}
+
+// Compacta os chunks residentes editados (ver octree_compact). A forma não muda o que o
+// shader vê, então as vagas não são regravadas.
+bool chunk_grid_compact(Chunk_Grid *grid, double budget_ms) {
+    if (!grid) return true;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < grid->table_capacity; i++) {
+        Chunk *chunk = grid->table[i].chunk;
+        if (!chunk || !chunk->tree || !chunk->tree->dirty) continue;
+        double left = 0.0;
+        if (budget_ms > 0.0) {
+            left = budget_ms - std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (left <= 0.0) return false;
+        }
+        if (!octree_compact(chunk->tree, left)) return false;
+    }
+    return true;
+}
+
+bool chunk_grid_is_empty(Chunk_Grid *grid) {
+    if (!grid) return true;
+    for (size_t i = 0; i < grid->table_capacity; i++) {
+        if (grid->table[i].chunk && _has_content(grid->table[i].chunk)) return false;
+    }
+    return true;
+}
+
+// Octrees residentes mais as imagens guardadas e as reduções
+size_t chunk_grid_memory_usage(Chunk_Grid *grid) {
+    if (!grid) return 0;
+    size_t total = sizeof(Chunk_Grid) + grid->table_capacity * sizeof(Chunk_Entry)
+                 + grid->hole_capacity * sizeof(Chunk_Hole) + grid->count * sizeof(Chunk)
+                 + grid->lod_capacity * sizeof(Chunk*);
+    for (size_t i = 0; i < grid->table_capacity; i++) {
+        Chunk *chunk = grid->table[i].chunk;
+        if (!chunk) continue;
+        total += octree_memory_usage(chunk->tree) + svo_map_memory_usage(chunk->packed);
+        for (int level = 0; level < CHUNK_LOD_LEVELS; level++) total += chunk->lod[level].count * 4;
+    }
+    return total;
+}
+
+void chunk_grid_delete(Chunk_Grid *grid) {
+    if (!grid) return;
+    for (size_t i = 0; i < grid->table_capacity; i++) {
+        Chunk *chunk = grid->table[i].chunk;
+        if (!chunk) continue;
+        octree_delete(chunk->tree);
+        svo_map_delete(chunk->packed);
+        _lod_free(chunk);
+        free(chunk);
+    }
+    chunk_store_close(grid->store);
+    free(grid->table);
+    free(grid->holes);
+    free(grid->leaving);
+    free(grid->lod_queue);
+    free(grid);
+}
@@ -0,0 +1,475 @@
+extern "C" {
+    #include <vmm/ivec3.h>
+}
+#include <chunkStore.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifdef _WIN32
+    #define NOMINMAX
+    #include <windows.h>
+#endif
+#ifdef __linux__
+    #include <unistd.h>
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+#endif
+
+#define CHECKSUM_SEED 0xcbf29ce484222325ull
+// Operações recolhidas por volta da thread de carga: as imagens conferidas são entregues
+// aos poucos, sem esperar o lote inteiro que voltou do arquivo
+#define LOADER_BATCH 16
+// O que já foi pedido ao arquivo não volta para a fila quando a câmera anda: um chunk
+// pedido agora espera tudo que está em voo. A cada LOADER_WINDOW_MS (um quadro) o teto de
+// leituras em voo vira o que o arquivo entregou na janela (entre LOADER_MIN_DEPTH e a
+// profundidade do store), então essa espera fica em torno de um quadro e um disco rápido
+// ainda tem centenas em voo.
+#define LOADER_MIN_DEPTH 16
+#define LOADER_WINDOW_MS (1000.0 / 60.0)
+
+// Leitura esperando a thread de carga
+typedef struct _store_request {
+    Chunk_Store_Entry entry;
+    double queued_ms;
+} Store_Request;
+
+// Cópia de uma imagem a gravar, até a gravação voltar
+typedef struct _store_write {
+    uint8_t *image;
+    size_t size;
+} Store_Write;
+
+struct _chunk_store {
+    std::string path;
+    Async_File *file;
+    Chunk_Store_Header header;
+    std::unordered_map<uint64_t, Chunk_Store_Entry> index; //só a thread do jogo mexe
+    uint64_t data_end;          //onde vai a próxima imagem
+    bool index_dirty;
+
+    std::mutex mutex;
+    std::condition_variable wake, idle;
+    std::deque<Store_Request> requests; //em ordem de prioridade
+    std::vector<Chunk_Store_Load> done;
+    std::unordered_set<uint64_t> reading; //chaves dos chunks sendo lidos
+    std::unordered_map<uint64_t, Store_Write> writing; //offset -> imagem ainda não gravada
+    std::deque<uint64_t> write_queue;   //offsets de 'writing' ainda não enviados
+    size_t writing_bytes;
+    bool write_failed;          //alguma gravação voltou com erro: o arquivo não vale mais
+    bool stop;
+    size_t depth;               //Chunk_Store_Options::depth
+    std::thread loader;
+    Chunk_Store_Stats stats;
+};
+
+static double _now_ms(void) {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+// 21 bits por eixo: sobra para mundos de 2^26 células com chunks de 64
+static uint64_t _key(IVector3 coord) {
+    return ((uint64_t)((uint32_t)coord.x & 0x1fffff) << 42) | ((uint64_t)((uint32_t)coord.y & 0x1fffff) << 21)
+         | (uint64_t)((uint32_t)coord.z & 0x1fffff);
+}
+
+static IVector3 _entry_coord(const Chunk_Store_Entry *entry) {
+    return {{entry->coord[0], entry->coord[1], entry->coord[2]}};
+}
+
+// Cópia da imagem de 'entry' se ela ainda não foi gravada (com o mutex preso por quem chama)
+static uint8_t *_unwritten_image(Chunk_Store *store, const Chunk_Store_Entry *entry) {
+    auto it = store->writing.find(entry->offset);
+    if (it == store->writing.end() || it->second.size != entry->size) return NULL;
+    uint8_t *image = (uint8_t*)malloc(entry->size);
+    if (image) memcpy(image, it->second.image, entry->size);
+    return image;
+}
+
+// --- THREAD DE CARGA ---
+
+// A thread de carga só usa o tempo que sobra nos quadros: com poucos núcleos, na
+// prioridade normal ela tira a CPU da thread do jogo no meio do quadro
+static void _lower_priority(void) {
+#if defined(_WIN32)
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#elif defined(__linux__)
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 10);
+#endif
+}
+
+// Mantém a fila do arquivo cheia: a cada volta envia num lote só as gravações pendentes e
+// os próximos pedidos (até o teto da janela em voo) e recolhe o que terminou. O checksum
+// de cada imagem é conferido aqui, fora da thread do jogo.
+static void _loader_thread(Chunk_Store *store) {
+    _lower_priority();
+    std::vector<Async_File_Op> ops(LOADER_BATCH);
+    std::unordered_map<uint64_t, Store_Request> tags; //leituras em voo
+    std::vector<std::pair<Store_Request, uint8_t*> > images; //lidas (ou copiadas de uma gravação pendente)
+    uint64_t next_tag = 0;
+    size_t limit = std::min(store->depth, (size_t)LOADER_MIN_DEPTH);
+    size_t window_reads = 0;
+    double window_start = _now_ms();
+
+    std::unique_lock<std::mutex> lock(store->mutex);
+    while (true) {
+        if (async_file_in_flight(store->file) == 0) {
+            store->wake.wait(lock, [store] {
+                return store->stop || !store->requests.empty() || !store->write_queue.empty();
+            });
+            if (store->stop && store->write_queue.empty()) break;
+            // Parado não mede o disco: a janela recomeça e o teto fica
+            window_reads = 0;
+            window_start = _now_ms();
+        }
+
+        images.clear();
+        while (!store->write_queue.empty() && async_file_room(store->file) > 0) {
+            const Store_Write &write = store->writing[store->write_queue.front()];
+            if (!async_file_write(store->file, store->write_queue.front(), write.image, write.size, 0)) break;
+            store->write_queue.pop_front();
+        }
+        while (!store->stop && !store->requests.empty() && async_file_in_flight(store->file) < limit &&
+               async_file_room(store->file) > 0) {
+            Store_Request request = store->requests.front();
+            store->reading.insert(_key(_entry_coord(&request.entry)));
+            uint8_t *image = _unwritten_image(store, &request.entry);
+            if (image) images.push_back({request, image});
+            else {
+                // Lida direto na imagem que vai para svo_map_from_memory (sem cópia do pool)
+                image = (uint8_t*)malloc(request.entry.size);
+                if (!image || !async_file_read(store->file, request.entry.offset, image, request.entry.size, next_tag)) {
+                    free(image);
+                    break;
+                }
+                tags[next_tag++] = request;
+            }
+            store->requests.pop_front();
+        }
+        size_t in_flight = async_file_in_flight(store->file);
+        if (in_flight > store->stats.in_flight_max) store->stats.in_flight_max = in_flight;
+        lock.unlock();
+
+        async_file_submit(store->file);
+        size_t count = async_file_complete(store->file, ops.data(), ops.size(), images.empty());
+        std::vector<uint64_t> written;
+        bool failed = false;
+        for (size_t i = 0; i < count; i++) {
+            if (ops[i].write) {
+                written.push_back(ops[i].offset);
+                failed |= !ops[i].ok;
+                continue;
+            }
+            auto it = tags.find(ops[i].tag);
+            if (!ops[i].ok) {
+                free(ops[i].data);
+                ops[i].data = NULL;
+            }
+            images.push_back({it->second, ops[i].data});
+            tags.erase(it);
+            window_reads++;
+        }
+        double now = _now_ms();
+        if (now - window_start >= LOADER_WINDOW_MS) {
+            limit = std::max((size_t)LOADER_MIN_DEPTH, std::min(store->depth, window_reads));
+            window_reads = 0;
+            window_start = now;
+        }
+        std::vector<Chunk_Store_Load> loads;
+        for (auto &it : images) {
+            const Chunk_Store_Entry *entry = &it.first.entry;
+            Svo_Map *map = it.second ? svo_map_from_memory(it.second, entry->size, true) : NULL;
+            loads.push_back({_entry_coord(entry), entry->offset, map, _now_ms() - it.first.queued_ms});
+        }
+
+        lock.lock();
+        for (size_t i = 0; i < loads.size(); i++) {
+            const Chunk_Store_Load &load = loads[i];
+            store->reading.erase(_key(load.coord));
+            store->done.push_back(load);
+            store->stats.reads++;
+            store->stats.read_bytes += images[i].first.entry.size;
+            store->stats.failed += load.map == NULL;
+            store->stats.read_ms += load.ms;
+            if (load.ms > store->stats.read_ms_max) store->stats.read_ms_max = load.ms;
+        }
+        for (uint64_t offset : written) {
+            auto it = store->writing.find(offset);
+            store->writing_bytes -= it->second.size;
+            free(it->second.image);
+            store->writing.erase(it);
+        }
+        store->write_failed |= failed;
+        if (!written.empty()) store->idle.notify_all();
+    }
+}
+
+static Chunk_Store *_start(std::string path, Async_File *file, Chunk_Store_Header header, uint64_t data_end,
+                           const Chunk_Store_Options *options) {
+    Chunk_Store *store = new Chunk_Store();
+    int depth = options && options->depth > 0 ? options->depth : CHUNK_STORE_DEPTH;
+    store->path = path;
+    store->depth = (size_t)std::min(depth, ASYNC_FILE_DEPTH);
+    store->file = file;
+    store->header = header;
+    store->data_end = data_end;
+    store->index_dirty = false;
+    store->writing_bytes = 0;
+    store->write_failed = false;
+    store->stop = false;
+    store->stats = {};
+    store->loader = std::thread(_loader_thread, store);
+    return store;
+}
+
+// --- ABERTURA ---
+
+// Arquivo novo (substitui um que exista; cria o diretório se preciso) para um mundo com os
+// limites dados, em chunks de 2^chunk_log2 células. 'options' diz como a E/S é feita.
+Chunk_Store *chunk_store_create(const char *path, IVector3 left_bot_back, IVector3 right_top_front, int chunk_log2,
+                                const Chunk_Store_Options *options) {
+    if (!path || chunk_log2 <= 0) return NULL;
+    std::error_code ec;
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+    Async_File *file = async_file_open(path, true, options ? options->io : ASYNC_FILE_AUTO);
+    if (!file) return NULL;
+
+    Chunk_Store_Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHUNK_STORE_MAGIC, sizeof(header.magic));
+    header.version = CHUNK_STORE_VERSION;
+    header.header_size = sizeof(Chunk_Store_Header);
+    header.bounds_min[0] = left_bot_back.x; header.bounds_min[1] = left_bot_back.y; header.bounds_min[2] = left_bot_back.z;
+    header.bounds_max[0] = right_top_front.x; header.bounds_max[1] = right_top_front.y; header.bounds_max[2] = right_top_front.z;
+    header.chunk_log2 = (uint32_t)chunk_log2;
+    header.index_offset = sizeof(Chunk_Store_Header);
+    header.checksum = svo_file_checksum(CHECKSUM_SEED, NULL, 0);
+    if (!async_file_pwrite(file, 0, &header, sizeof(header)) || !async_file_sync(file)) {
+        async_file_close(file);
+        remove(path);
+        return NULL;
+    }
+    return _start(path, file, header, sizeof(Chunk_Store_Header), options);
+}
+
+// Abre um arquivo de chunk_store_create para ler e continuar gravando. NULL se não
+// existir, for de outra versão ou o índice estiver corrompido.
+Chunk_Store *chunk_store_open(const char *path, const Chunk_Store_Options *options) {
+    if (!path) return NULL;
+    Async_File *file = async_file_open(path, false, options ? options->io : ASYNC_FILE_AUTO);
+    if (!file) return NULL;
+
+    Chunk_Store_Header header;
+    uint64_t size = async_file_size(file);
+    bool ok = size >= sizeof(header) && async_file_pread(file, 0, &header, sizeof(header))
+           && memcmp(header.magic, CHUNK_STORE_MAGIC, sizeof(header.magic)) == 0
+           && header.version == CHUNK_STORE_VERSION && header.header_size == sizeof(Chunk_Store_Header)
+           && header.index_offset <= size
+           && header.entry_count <= (size - header.index_offset) / sizeof(Chunk_Store_Entry);
+    std::vector<Chunk_Store_Entry> entries(ok ? header.entry_count : 0);
+    ok = ok && async_file_pread(file, header.index_offset, entries.data(), entries.size() * sizeof(Chunk_Store_Entry));
+    ok = ok && svo_file_checksum(CHECKSUM_SEED, (const uint8_t*)entries.data(),
+                                 entries.size() * sizeof(Chunk_Store_Entry)) == header.checksum;
+    if (!ok) {
+        async_file_close(file);
+        return NULL;
+    }
+
+    // O que foi anexado depois do último índice (sem chunk_store_flush) fica para trás
+    Chunk_Store *store = _start(path, file, header, size, options);
+    for (const Chunk_Store_Entry &entry : entries) {
+        if (entry.offset + entry.size > header.index_offset) continue;
+        store->index[_key(_entry_coord(&entry))] = entry;
+    }
+    return store;
+}
+
+void chunk_store_layout(Chunk_Store *store, IVector3 *left_bot_back, IVector3 *right_top_front, int *chunk_log2) {
+    if (!store) return;
+    const Chunk_Store_Header *h = &store->header;
+    if (left_bot_back) *left_bot_back = {{h->bounds_min[0], h->bounds_min[1], h->bounds_min[2]}};
+    if (right_top_front) *right_top_front = {{h->bounds_max[0], h->bounds_max[1], h->bounds_max[2]}};
+    if (chunk_log2) *chunk_log2 = (int)h->chunk_log2;
+}
+
+bool chunk_store_find(Chunk_Store *store, IVector3 coord, Chunk_Store_Entry *entry) {
+    if (!store) return false;
+    auto it = store->index.find(_key(coord));
+    if (it == store->index.end()) return false;
+    if (entry) *entry = it->second;
+    return true;
+}
+
+void chunk_store_for_each(Chunk_Store *store, void (*fn)(void *user, const Chunk_Store_Entry *entry), void *user) {
+    if (!store || !fn) return;
+    for (const auto &it : store->index) fn(user, &it.second);
+}
+
+// --- GRAVAÇÃO ---
+
+// Anexa a imagem de 'coord' (svo_file_encode); size = 0 tira o chunk do índice. A imagem
+// é copiada e gravada pela thread de carga; ler o chunk antes disso devolve a cópia. Só
+// vale depois de reaberto se chunk_store_flush vier em seguida.
+bool chunk_store_write(Chunk_Store *store, IVector3 coord, const uint8_t *image, size_t size) {
+    if (!store) return false;
+    uint64_t key = _key(coord);
+    if (size == 0 || !image) {
+        store->index_dirty |= store->index.erase(key) > 0;
+        return true;
+    }
+    if (size > UINT32_MAX) return false;
+    uint8_t *copy = (uint8_t*)malloc(size);
+    if (!copy) return false;
+    memcpy(copy, image, size);
+
+    Chunk_Store_Entry entry = {{coord.x, coord.y, coord.z}, (uint32_t)size, store->data_end};
+    store->data_end += size;
+    store->index[key] = entry;
+    store->index_dirty = true;
+
+    std::unique_lock<std::mutex> lock(store->mutex);
+    store->idle.wait(lock, [store] { return store->writing_bytes < CHUNK_STORE_WRITE_BYTES; });
+    store->writing[entry.offset] = {copy, size};
+    store->write_queue.push_back(entry.offset);
+    store->writing_bytes += size;
+    store->stats.writes++;
+    store->stats.write_bytes += size;
+    store->wake.notify_one();
+    return true;
+}
+
+// Espera as gravações pendentes, grava o índice depois das imagens e só então aponta o
+// cabeçalho para ele. Imagens novas vão depois desse índice, então uma queda no meio deixa
+// o anterior válido. Falso se alguma gravação falhou.
+bool chunk_store_flush(Chunk_Store *store) {
+    if (!store) return false;
+    {
+        std::unique_lock<std::mutex> lock(store->mutex);
+        store->idle.wait(lock, [store] { return store->writing.empty(); });
+        if (store->write_failed) return false;
+    }
+    if (!store->index_dirty) return true;
+    std::vector<Chunk_Store_Entry> entries;
+    entries.reserve(store->index.size());
+    for (const auto &it : store->index) entries.push_back(it.second);
+    size_t bytes = entries.size() * sizeof(Chunk_Store_Entry);
+
+    Chunk_Store_Header header = store->header;
+    header.index_offset = store->data_end;
+    header.entry_count = (uint32_t)entries.size();
+    header.checksum = svo_file_checksum(CHECKSUM_SEED, (const uint8_t*)entries.data(), bytes);
+
+    // Índice e cabeçalho são duas escritas separadas por um fsync: direto, sem a fila
+    bool ok = async_file_pwrite(store->file, header.index_offset, entries.data(), bytes)
+           && async_file_sync(store->file) && async_file_pwrite(store->file, 0, &header, sizeof(header))
+           && async_file_sync(store->file);
+    if (!ok) return false;
+    store->header = header;
+    store->data_end += bytes;
+    store->index_dirty = false;
+    return true;
+}
+
+// --- LEITURA ---
+
+// Leitura bloqueante, para quem precisa do chunk agora (edições, consultas). NULL se o
+// chunk não estiver no arquivo ou a imagem estiver corrompida.
+Svo_Map *chunk_store_read(Chunk_Store *store, IVector3 coord) {
+    Chunk_Store_Entry entry;
+    if (!chunk_store_find(store, coord, &entry)) return NULL;
+    double t0 = _now_ms();
+    uint8_t *image;
+    {
+        std::lock_guard<std::mutex> lock(store->mutex);
+        image = _unwritten_image(store, &entry);
+    }
+    if (!image) {
+        image = (uint8_t*)malloc(entry.size);
+        if (image && !async_file_pread(store->file, entry.offset, image, entry.size)) {
+            free(image);
+            image = NULL;
+        }
+    }
+    Svo_Map *map = image ? svo_map_from_memory(image, entry.size, true) : NULL;
+    double ms = _now_ms() - t0;
+
+    std::lock_guard<std::mutex> lock(store->mutex);
+    store->stats.reads++;
+    store->stats.read_bytes += entry.size;
+    store->stats.failed += map == NULL;
+    store->stats.read_ms += ms;
+    if (ms > store->stats.read_ms_max) store->stats.read_ms_max = ms;
+    return map;
+}
+
+// Troca a fila de leitura por 'entries' (a primeira é lida primeiro). Pedidos que
+// continuam na fila mantêm a hora em que foram feitos; os chunks sendo lidos agora não
+// entram de novo.
+void chunk_store_request(Chunk_Store *store, const Chunk_Store_Entry *entries, size_t count) {
+    if (!store) return;
+    std::lock_guard<std::mutex> lock(store->mutex);
+    std::unordered_map<uint64_t, double> queued;
+    for (const Store_Request &request : store->requests) queued[_key(_entry_coord(&request.entry))] = request.queued_ms;
+
+    double now = _now_ms();
+    size_t kept = 0;
+    store->requests.clear();
+    for (size_t i = 0; i < count; i++) {
+        uint64_t key = _key(_entry_coord(&entries[i]));
+        if (store->reading.count(key)) continue;
+        auto it = queued.find(key);
+        kept += it != queued.end();
+        store->requests.push_back({entries[i], it != queued.end() ? it->second : now});
+    }
+    store->stats.dropped += queued.size() - kept;
+    if (!store->requests.empty()) store->wake.notify_one();
+}
+
+// Leituras terminadas desde a última chamada (até 'capacity'); quem recebe fica dono dos
+// mapas
+size_t chunk_store_poll(Chunk_Store *store, Chunk_Store_Load *loads, size_t capacity) {
+    if (!store || !loads) return 0;
+    std::lock_guard<std::mutex> lock(store->mutex);
+    size_t count = std::min(capacity, store->done.size());
+    if (count == 0) return 0;
+    memcpy(loads, store->done.data(), count * sizeof(Chunk_Store_Load));
+    store->done.erase(store->done.begin(), store->done.begin() + count);
+    return count;
+}
+
+Async_File_Backend chunk_store_io(Chunk_Store *store) {
+    return store ? async_file_backend(store->file) : ASYNC_FILE_AUTO;
+}
+
+Chunk_Store_Stats chunk_store_stats(Chunk_Store *store) {
+    if (!store) return {};
+    std::lock_guard<std::mutex> lock(store->mutex);
+    return store->stats;
+}
+
+// Termina as gravações pendentes, para a thread de carga e fecha o arquivo. O índice não é
+// gravado: chame chunk_store_flush antes se as imagens novas devem valer na próxima abertura.
+void chunk_store_close(Chunk_Store *store) {
+    if (!store) return;
+    {
+        std::lock_guard<std::mutex> lock(store->mutex);
+        store->stop = true;
+    }
+    store->wake.notify_all();
+    if (store->loader.joinable()) store->loader.join();
+    for (Chunk_Store_Load &load : store->done) svo_map_delete(load.map);
+    async_file_close(store->file);
+    delete store;
+}
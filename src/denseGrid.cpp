@@ -0,0 +1,284 @@
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+    #include <vmm/ray.h>
+}
+#include <denseGrid.hpp>
+#include <octree.hpp>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define BRICK_VOXELS (DENSE_BRICK_SIZE * DENSE_BRICK_SIZE * DENSE_BRICK_SIZE)
+
+// Arredonda para baixo/cima no múltiplo de DENSE_BRICK_SIZE (funciona com negativos)
+static int _align_down(int v) {
+    return (int)floor((double)v / DENSE_BRICK_SIZE) * DENSE_BRICK_SIZE;
+}
+
+static int _align_up(int v) {
+    return (int)ceil((double)v / DENSE_BRICK_SIZE) * DENSE_BRICK_SIZE;
+}
+
+static size_t _brick_count(Dense_Grid *grid) {
+    return (size_t)grid->bricks.x * grid->bricks.y * grid->bricks.z;
+}
+
+// Índice da palavra de ocupação e bit dentro dela para uma coordenada (já validada)
+static size_t _brick_index(Dense_Grid *grid, int lx, int ly, int lz) {
+    int bx = lx / DENSE_BRICK_SIZE, by = ly / DENSE_BRICK_SIZE, bz = lz / DENSE_BRICK_SIZE;
+    return (size_t)bx + (size_t)grid->bricks.x * ((size_t)by + (size_t)grid->bricks.y * bz);
+}
+
+static int _bit_index(int lx, int ly, int lz) {
+    return (lx % DENSE_BRICK_SIZE)
+         + DENSE_BRICK_SIZE * ((ly % DENSE_BRICK_SIZE) + DENSE_BRICK_SIZE * (lz % DENSE_BRICK_SIZE));
+}
+
+Dense_Grid *dense_grid_create(IVector3 left_bot_back, IVector3 right_top_front) {
+    Dense_Grid *grid = (Dense_Grid*)calloc(1, sizeof(Dense_Grid));
+    if (!grid) return NULL;
+
+    grid->left_bot_back = {{_align_down(left_bot_back.x), _align_down(left_bot_back.y), _align_down(left_bot_back.z)}};
+    grid->right_top_front = {{_align_up(right_top_front.x), _align_up(right_top_front.y), _align_up(right_top_front.z)}};
+
+    IVector3 size = ivec3_sub(grid->right_top_front, grid->left_bot_back);
+    grid->bricks = ivec3_scalar_div(size, DENSE_BRICK_SIZE);
+
+    size_t bricks = _brick_count(grid);
+    grid->occupancy = (uint64_t*)calloc(bricks ? bricks : 1, sizeof(uint64_t));
+    grid->materials = (uint8_t*)calloc(bricks ? bricks * BRICK_VOXELS : 1, sizeof(uint8_t));
+    if (!grid->occupancy || !grid->materials) {
+        dense_grid_delete(grid);
+        return NULL;
+    }
+    return grid;
+}
+
+bool dense_grid_contains(Dense_Grid *grid, IVector3 coord) {
+    return coord.x >= grid->left_bot_back.x && coord.x < grid->right_top_front.x
+        && coord.y >= grid->left_bot_back.y && coord.y < grid->right_top_front.y
+        && coord.z >= grid->left_bot_back.z && coord.z < grid->right_top_front.z;
+}
+
+// Procura (ou adiciona) o material na paleta. Retorna -1 se a paleta estiver cheia.
+static int _palette_index(Dense_Grid *grid, ColorRGBA color, Voxel voxel) {
+    for (int i = 0; i < grid->palette_count; i++) {
+        Dense_Material *m = &grid->palette[i];
+        if (m->color == color && voxel_compare(m->voxel, voxel) && m->voxel.k == voxel.k) return i;
+    }
+    if (grid->palette_count >= DENSE_PALETTE_SIZE) return -1;
+
+    grid->palette[grid->palette_count].color = color;
+    grid->palette[grid->palette_count].voxel = voxel;
+    return grid->palette_count++;
+}
+
+// Retorna 0 em sucesso e -1 se o voxel não cabe na grade (fora dos limites ou paleta cheia)
+int dense_grid_insert(Dense_Grid *grid, Voxel_Object voxel) {
+    if (!grid || !dense_grid_contains(grid, voxel.coord)) return -1;
+
+    int material = _palette_index(grid, voxel.color, voxel.voxel);
+    if (material < 0) return -1;
+
+    IVector3 l = ivec3_sub(voxel.coord, grid->left_bot_back);
+    size_t brick = _brick_index(grid, l.x, l.y, l.z);
+    int bit = _bit_index(l.x, l.y, l.z);
+
+    if (!((grid->occupancy[brick] >> bit) & 1ull)) grid->voxel_count++;
+    grid->occupancy[brick] |= (1ull << bit);
+    grid->materials[brick * BRICK_VOXELS + bit] = (uint8_t)material;
+    return 0;
+}
+
+Voxel_Object dense_grid_find(Dense_Grid *grid, IVector3 coord) {
+    if (!grid || !dense_grid_contains(grid, coord)) return _invalid_voxel();
+
+    IVector3 l = ivec3_sub(coord, grid->left_bot_back);
+    size_t brick = _brick_index(grid, l.x, l.y, l.z);
+    int bit = _bit_index(l.x, l.y, l.z);
+    if (!((grid->occupancy[brick] >> bit) & 1ull)) return _invalid_voxel();
+
+    Dense_Material *m = &grid->palette[grid->materials[brick * BRICK_VOXELS + bit]];
+    return VoxelObjCreate(m->voxel, m->color, coord);
+}
+
+void dense_grid_remove(Dense_Grid *grid, IVector3 coord) {
+    if (!grid || !dense_grid_contains(grid, coord)) return;
+
+    IVector3 l = ivec3_sub(coord, grid->left_bot_back);
+    size_t brick = _brick_index(grid, l.x, l.y, l.z);
+    int bit = _bit_index(l.x, l.y, l.z);
+
+    if ((grid->occupancy[brick] >> bit) & 1ull) grid->voxel_count--;
+    grid->occupancy[brick] &= ~(1ull << bit);
+}
+
+// --- DDA 3D ---
+// Estado do DDA de Amanatides & Woo reiniciado a partir de um 't' qualquer do raio.
+typedef struct {
+    int cell[3], step[3];
+    float t_max[3], t_delta[3];
+} Dense_DDA;
+
+static void _dda_reset(Dense_DDA *dda, const float o[3], const float d[3], const float inv[3],
+                       const int lo[3], const int hi[3], float t, int forced_axis, int forced_cell) {
+    for (int a = 0; a < 3; a++) {
+        int c = (int)floorf(o[a] + d[a] * t);
+        if (a == forced_axis) c = forced_cell; // evita erro de arredondamento na face de saída
+        if (c < lo[a]) c = lo[a];
+        if (c >= hi[a]) c = hi[a] - 1;
+        dda->cell[a] = c;
+
+        if (d[a] > 0.0f) {
+            dda->step[a] = 1;
+            dda->t_max[a] = ((float)(c + 1) - o[a]) * inv[a];
+            dda->t_delta[a] = inv[a];
+        } else if (d[a] < 0.0f) {
+            dda->step[a] = -1;
+            dda->t_max[a] = ((float)c - o[a]) * inv[a];
+            dda->t_delta[a] = -inv[a];
+        } else {
+            dda->step[a] = 0;
+            dda->t_max[a] = 1e30f;
+            dda->t_delta[a] = 1e30f;
+        }
+    }
+}
+
+bool dense_grid_ray_cast(Dense_Grid *grid, Ray ray, Voxel_Object *hit, int *steps) {
+    if (steps) *steps = 0;
+    if (!grid) return false;
+
+    float o[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+    float d[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+    int lo[3] = {grid->left_bot_back.x, grid->left_bot_back.y, grid->left_bot_back.z};
+    int hi[3] = {grid->right_top_front.x, grid->right_top_front.y, grid->right_top_front.z};
+
+    // Evita divisão por zero (igual à octree)
+    float inv[3];
+    for (int a = 0; a < 3; a++) inv[a] = (fabsf(d[a]) < 1e-8f) ? 1e20f : 1.0f / d[a];
+
+    // Recorta o raio contra a caixa da grade (slabs)
+    float t_enter = -1e30f, t_exit = 1e30f;
+    for (int a = 0; a < 3; a++) {
+        if (d[a] == 0.0f) {
+            if (o[a] < lo[a] || o[a] >= hi[a]) return false;
+            continue;
+        }
+        float t0 = ((float)lo[a] - o[a]) * inv[a];
+        float t1 = ((float)hi[a] - o[a]) * inv[a];
+        if (t0 > t1) { float tmp = t0; t0 = t1; t1 = tmp; }
+        if (t0 > t_enter) t_enter = t0;
+        if (t1 < t_exit) t_exit = t1;
+    }
+    if (t_enter < 0.0f) t_enter = 0.0f;
+    if (t_exit < t_enter) return false;
+
+    Dense_DDA dda;
+    _dda_reset(&dda, o, d, inv, lo, hi, t_enter, -1, 0);
+
+    int max_steps = (grid->bricks.x + grid->bricks.y + grid->bricks.z) * DENSE_BRICK_SIZE * 2 + 8;
+    for (int i = 0; i < max_steps; i++) {
+        if (steps) (*steps)++;
+
+        int l[3] = {dda.cell[0] - lo[0], dda.cell[1] - lo[1], dda.cell[2] - lo[2]};
+        size_t brick = _brick_index(grid, l[0], l[1], l[2]);
+        uint64_t word = grid->occupancy[brick];
+
+        if (word == 0) {
+            // Brick inteiro vazio: uma única palavra de 64 bits resolve 4x4x4 voxels,
+            // então pulamos direto para a face de saída do brick.
+            float t_leave = 1e30f;
+            int axis = 0;
+            for (int a = 0; a < 3; a++) {
+                if (dda.step[a] == 0) continue;
+                int bmin = lo[a] + (l[a] / DENSE_BRICK_SIZE) * DENSE_BRICK_SIZE;
+                int face = dda.step[a] > 0 ? bmin + DENSE_BRICK_SIZE : bmin;
+                float tf = ((float)face - o[a]) * inv[a];
+                if (tf < t_leave) { t_leave = tf; axis = a; }
+            }
+            if (t_leave >= t_exit) return false;
+
+            int bmin = lo[axis] + (l[axis] / DENSE_BRICK_SIZE) * DENSE_BRICK_SIZE;
+            int next_cell = dda.step[axis] > 0 ? bmin + DENSE_BRICK_SIZE : bmin - 1;
+            if (next_cell < lo[axis] || next_cell >= hi[axis]) return false;
+            _dda_reset(&dda, o, d, inv, lo, hi, t_leave, axis, next_cell);
+            continue;
+        }
+
+        int bit = _bit_index(l[0], l[1], l[2]);
+        if ((word >> bit) & 1ull) {
+            if (hit) {
+                Dense_Material *m = &grid->palette[grid->materials[brick * BRICK_VOXELS + bit]];
+                *hit = VoxelObjCreate(m->voxel, m->color, {{dda.cell[0], dda.cell[1], dda.cell[2]}});
+            }
+            return true;
+        }
+
+        // Passo normal do DDA dentro do brick
+        int axis = (dda.t_max[0] < dda.t_max[1])
+                 ? ((dda.t_max[0] < dda.t_max[2]) ? 0 : 2)
+                 : ((dda.t_max[1] < dda.t_max[2]) ? 1 : 2);
+        if (dda.t_max[axis] >= t_exit) return false;
+        dda.cell[axis] += dda.step[axis];
+        dda.t_max[axis] += dda.t_delta[axis];
+        if (dda.cell[axis] < lo[axis] || dda.cell[axis] >= hi[axis]) return false;
+    }
+    return false;
+}
+
+void dense_grid_for_each(Dense_Grid *grid, void (*fn)(void *user, Voxel_Object voxel), void *user) {
+    if (!grid || !fn) return;
+
+    for (int bz = 0; bz < grid->bricks.z; bz++)
+    for (int by = 0; by < grid->bricks.y; by++)
+    for (int bx = 0; bx < grid->bricks.x; bx++) {
+        size_t brick = (size_t)bx + (size_t)grid->bricks.x * ((size_t)by + (size_t)grid->bricks.y * bz);
+        uint64_t word = grid->occupancy[brick];
+        while (word) {
+            int bit = __builtin_ctzll(word);
+            word &= word - 1;
+
+            IVector3 coord = {{
+                grid->left_bot_back.x + bx * DENSE_BRICK_SIZE + bit % DENSE_BRICK_SIZE,
+                grid->left_bot_back.y + by * DENSE_BRICK_SIZE + (bit / DENSE_BRICK_SIZE) % DENSE_BRICK_SIZE,
+                grid->left_bot_back.z + bz * DENSE_BRICK_SIZE + bit / (DENSE_BRICK_SIZE * DENSE_BRICK_SIZE)
+            }};
+            Dense_Material *m = &grid->palette[grid->materials[brick * BRICK_VOXELS + bit]];
+            fn(user, VoxelObjCreate(m->voxel, m->color, coord));
+        }
+    }
+}
+
+static void _insert_into_octree(void *user, Voxel_Object voxel) {
+    octree_insert((Octree*)user, voxel);
+}
+
+// O renderer só entende o fluxo SVO, então a textura é gerada passando pela octree
+// com os mesmos limites do mundo (a subdivisão precisa bater com a do shader).
+uint8_t *dense_grid_texture(Dense_Grid *grid, IVector3 world_min, IVector3 world_max, size_t *arr_size, size_t tex_dim) {
+    if (!grid || !arr_size) return NULL;
+
+    Octree *tmp = octree_create(NULL, world_min, world_max);
+    if (!tmp) return NULL;
+    dense_grid_for_each(grid, _insert_into_octree, tmp);
+    octree_compact(tmp, 0);
+
+    uint8_t *texture = octree_texture(tmp, arr_size, tex_dim);
+    octree_delete(tmp);
+    return texture;
+}
+
+size_t dense_grid_memory_usage(Dense_Grid *grid) {
+    if (!grid) return 0;
+    size_t bricks = _brick_count(grid);
+    return sizeof(Dense_Grid) + bricks * sizeof(uint64_t) + bricks * BRICK_VOXELS * sizeof(uint8_t);
+}
+
+void dense_grid_delete(Dense_Grid *grid) {
+    if (!grid) return;
+    free(grid->occupancy);
+    free(grid->materials);
+    free(grid);
+}
@@ -0,0 +1,373 @@
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+}
+#include <distanceField.hpp>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <string.h>
+#include <math.h>
+
+// Valores de 'occupied'
+#define CELL_EMPTY 0
+#define CELL_OCCUPIED 1
+#define CELL_PENDING 2 //apagada em parte: o update pergunta se ainda sobrou algum voxel
+
+static size_t _cell_index(const Distance_Field *field, int x, int y, int z) {
+    return (size_t)x + (size_t)field->cells.x * ((size_t)y + (size_t)field->cells.y * (size_t)z);
+}
+
+static void _clear_dirty(Distance_Field *field) {
+    field->dirty_min = field->cells;
+    field->dirty_max = {{-1, -1, -1}};
+}
+
+static void _touch(Distance_Field *field, IVector3 cell) {
+    field->dirty_min = ivec3_min(field->dirty_min, cell);
+    field->dirty_max = ivec3_max(field->dirty_max, cell);
+}
+
+// Campo vazio cobrindo os voxels [vox_min, vox_max] (inclusivos) mais DISTANCE_MAX células
+// de folga, recortado a [left_bot_back, right_top_front). O lado da célula é o menor que
+// cabe em DISTANCE_MAX_CELLS.
+Distance_Field *distance_field_create(IVector3 vox_min, IVector3 vox_max, IVector3 left_bot_back, IVector3 right_top_front) {
+    IVector3 lo = ivec3_min(vox_min, vox_max), hi = ivec3_scalar_add(ivec3_max(vox_min, vox_max), 1);
+    IVector3 min, cells;
+    int log2 = DISTANCE_MIN_CELL_LOG2;
+    for (;; log2++) {
+        if (log2 > 24) return NULL;
+        int margin = DISTANCE_MAX << log2;
+        min = ivec3_max(ivec3_scalar_add(lo, -margin), left_bot_back);
+        IVector3 max = ivec3_min(ivec3_scalar_add(hi, margin), right_top_front);
+        IVector3 size = ivec3_sub(max, min);
+        if (size.x <= 0 || size.y <= 0 || size.z <= 0) return NULL;
+        int round = (1 << log2) - 1;
+        cells = {{(size.x + round) >> log2, (size.y + round) >> log2, (size.z + round) >> log2}};
+        if ((size_t)cells.x * (size_t)cells.y * (size_t)cells.z <= DISTANCE_MAX_CELLS) break;
+    }
+
+    Distance_Field *field = (Distance_Field*)calloc(1, sizeof(Distance_Field));
+    if (!field) return NULL;
+    field->left_bot_back = min;
+    field->cells = cells;
+    field->cell_log2 = log2;
+    field->right_top_front = ivec3_add(min, {{cells.x << log2, cells.y << log2, cells.z << log2}});
+    size_t count = (size_t)field->cells.x * (size_t)field->cells.y * (size_t)field->cells.z;
+    field->occupied = (uint8_t*)calloc(count, 1);
+    field->distance = (uint8_t*)malloc(count);
+    if (!field->occupied || !field->distance) {
+        distance_field_delete(field);
+        return NULL;
+    }
+    memset(field->distance, DISTANCE_MAX, count);
+    _clear_dirty(field);
+    return field;
+}
+
+// [vox_min, vox_max] (inclusivos) inteira dentro do campo
+bool distance_field_contains(const Distance_Field *field, IVector3 vox_min, IVector3 vox_max) {
+    if (!field) return false;
+    IVector3 min = ivec3_min(vox_min, vox_max), max = ivec3_max(vox_min, vox_max);
+    return min.x >= field->left_bot_back.x && min.y >= field->left_bot_back.y && min.z >= field->left_bot_back.z
+        && max.x < field->right_top_front.x && max.y < field->right_top_front.y && max.z < field->right_top_front.z;
+}
+
+// Células que cobrem [vox_min, vox_max] (inclusivos, recortados ao campo); false se nenhuma
+static bool _cell_range(const Distance_Field *field, IVector3 vox_min, IVector3 vox_max, IVector3 *lo, IVector3 *hi) {
+    IVector3 min = ivec3_sub(ivec3_min(vox_min, vox_max), field->left_bot_back);
+    IVector3 max = ivec3_sub(ivec3_max(vox_min, vox_max), field->left_bot_back);
+    IVector3 last = ivec3_scalar_add(field->cells, -1);
+    if (max.x < 0 || max.y < 0 || max.z < 0) return false;
+    *lo = ivec3_max({{min.x >> field->cell_log2, min.y >> field->cell_log2, min.z >> field->cell_log2}}, ivec3_zero());
+    *hi = ivec3_min({{max.x >> field->cell_log2, max.y >> field->cell_log2, max.z >> field->cell_log2}}, last);
+    return lo->x <= hi->x && lo->y <= hi->y && lo->z <= hi->z;
+}
+
+// Marca como ocupadas as células que cobrem [vox_min, vox_max] (inclusivos)
+void distance_field_mark(Distance_Field *field, IVector3 vox_min, IVector3 vox_max) {
+    IVector3 lo, hi;
+    if (!field || !_cell_range(field, vox_min, vox_max, &lo, &hi)) return;
+    for (int z = lo.z; z <= hi.z; z++)
+    for (int y = lo.y; y <= hi.y; y++)
+    for (int x = lo.x; x <= hi.x; x++) {
+        uint8_t *cell = &field->occupied[_cell_index(field, x, y, z)];
+        if (*cell == CELL_OCCUPIED) continue;
+        *cell = CELL_OCCUPIED;
+        _touch(field, {{x, y, z}});
+    }
+}
+
+// Depois de apagar [vox_min, vox_max] (inclusivos): as células inteiras dentro da caixa
+// ficam vazias; as das bordas ficam pendentes até o próximo update, que pergunta por
+// elas uma vez só (várias remoções na mesma célula custam uma varredura)
+void distance_field_clear(Distance_Field *field, IVector3 vox_min, IVector3 vox_max) {
+    IVector3 lo, hi;
+    if (!field || !_cell_range(field, vox_min, vox_max, &lo, &hi)) return;
+    IVector3 min = ivec3_min(vox_min, vox_max), max = ivec3_max(vox_min, vox_max);
+    for (int z = lo.z; z <= hi.z; z++)
+    for (int y = lo.y; y <= hi.y; y++)
+    for (int x = lo.x; x <= hi.x; x++) {
+        uint8_t *cell = &field->occupied[_cell_index(field, x, y, z)];
+        if (*cell == CELL_EMPTY) continue;
+
+        IVector3 cell_min = ivec3_add(field->left_bot_back, {{x << field->cell_log2, y << field->cell_log2, z << field->cell_log2}});
+        IVector3 cell_max = ivec3_scalar_add(cell_min, (1 << field->cell_log2) - 1);
+        bool inside = cell_min.x >= min.x && cell_min.y >= min.y && cell_min.z >= min.z
+                   && cell_max.x <= max.x && cell_max.y <= max.y && cell_max.z <= max.z;
+        *cell = inside ? CELL_EMPTY : CELL_PENDING;
+        _touch(field, {{x, y, z}});
+    }
+}
+
+// true se há ocupação mudada ainda fora das distâncias (ver distance_field_update)
+bool distance_field_is_dirty(const Distance_Field *field) {
+    return field && field->dirty_min.x <= field->dirty_max.x;
+}
+
+// --- TRANSFORMADA ---
+// A distância de Chebyshev é separável: d(c) = min sobre as células ocupadas o de
+// max(|dx|, |dy|, |dz|), então três passadas 1D (x, y, z), cada uma lendo o resultado
+// da anterior, dão o valor exato. Com o teto DISTANCE_MAX cada passada só olha uma
+// janela de DISTANCE_MAX - 1 células para cada lado.
+
+typedef struct {
+    const uint8_t *src;
+    int src_min[3], src_dim[3];
+    bool src_occupancy;         //src é a ocupação (ocupada vira 0, vazia vira DISTANCE_MAX)
+    uint8_t *dst;
+    int dst_min[3], dst_dim[3];
+    int out_min[3], out_max[3]; //células escritas (inclusivos)
+    int axis;
+    int threads;                //0 = uma por núcleo
+} Distance_Pass;
+
+static size_t _box_index(const int min[3], const int dim[3], const int c[3]) {
+    return (size_t)(c[0] - min[0]) + (size_t)dim[0] * ((size_t)(c[1] - min[1]) + (size_t)dim[1] * (size_t)(c[2] - min[2]));
+}
+
+static void _pass_rows(const Distance_Pass *pass, size_t first, size_t last) {
+    int a = pass->axis, u = (a + 1) % 3, v = (a + 2) % 3;
+    int rows_u = pass->out_max[u] - pass->out_min[u] + 1;
+    int lo = pass->src_min[a], hi = pass->src_min[a] + pass->src_dim[a] - 1;
+    size_t stride = 1;
+    for (int i = 0; i < a; i++) stride *= (size_t)pass->src_dim[i];
+
+    for (size_t row = first; row < last; row++) {
+        int c[3];
+        c[u] = pass->out_min[u] + (int)(row % (size_t)rows_u);
+        c[v] = pass->out_min[v] + (int)(row / (size_t)rows_u);
+        c[a] = lo;
+        const uint8_t *line = pass->src + _box_index(pass->src_min, pass->src_dim, c);
+
+        for (c[a] = pass->out_min[a]; c[a] <= pass->out_max[a]; c[a]++) {
+            int best = DISTANCE_MAX;
+            for (int k = 0; k < best; k++) {
+                int at[2] = {c[a] - k, c[a] + k};
+                for (int s = 0; s < 2; s++) {
+                    if (at[s] < lo || at[s] > hi) continue;
+                    int value = line[(size_t)(at[s] - lo) * stride];
+                    if (pass->src_occupancy) value = value ? 0 : DISTANCE_MAX;
+                    best = std::min(best, std::max(k, value));
+                }
+            }
+            pass->dst[_box_index(pass->dst_min, pass->dst_dim, c)] = (uint8_t)best;
+        }
+    }
+}
+
+static int _worker_count(int threads, size_t cells) {
+    int workers = threads > 0 ? threads : (int)std::thread::hardware_concurrency();
+    if (workers < 1) workers = 1;
+    if (threads <= 0) workers = (int)std::min<size_t>((size_t)workers, cells / DISTANCE_MIN_CELLS_PER_THREAD + 1);
+    return workers;
+}
+
+// Linhas contíguas, uma faixa por thread
+static void _run_pass(const Distance_Pass *pass) {
+    int u = (pass->axis + 1) % 3, v = (pass->axis + 2) % 3;
+    size_t rows = (size_t)(pass->out_max[u] - pass->out_min[u] + 1) * (size_t)(pass->out_max[v] - pass->out_min[v] + 1);
+    size_t cells = rows * (size_t)(pass->out_max[pass->axis] - pass->out_min[pass->axis] + 1);
+    int workers = (int)std::min<size_t>((size_t)_worker_count(pass->threads, cells), rows);
+    if (workers <= 1) {
+        _pass_rows(pass, 0, rows);
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (int w = 0; w < workers; w++) {
+        threads.emplace_back(_pass_rows, pass, rows * w / workers, rows * (w + 1) / workers);
+    }
+    for (std::thread &t : threads) t.join();
+}
+
+static void _set_box(int dst[3], IVector3 value) {
+    dst[0] = value.x;
+    dst[1] = value.y;
+    dst[2] = value.z;
+}
+
+// Refaz as distâncias em volta das células mudadas: só as que estão a menos de
+// DISTANCE_MAX delas podem mudar. As pendentes de distance_field_clear perguntam antes a
+// 'occupied' se a caixa delas (inclusiva) ainda tem voxel (NULL = contam como ocupadas,
+// o que só deixa o campo conservador). 'threads': 0 = uma por núcleo, limitado pelo
+// tamanho da região (como Vox_Load_Options::threads). true se havia algo a refazer.
+bool distance_field_update(Distance_Field *field, bool (*occupied)(void *user, IVector3 vox_min, IVector3 vox_max), void *user,
+                           int threads) {
+    if (!distance_field_is_dirty(field)) return false;
+
+    for (int z = field->dirty_min.z; z <= field->dirty_max.z; z++)
+    for (int y = field->dirty_min.y; y <= field->dirty_max.y; y++)
+    for (int x = field->dirty_min.x; x <= field->dirty_max.x; x++) {
+        uint8_t *cell = &field->occupied[_cell_index(field, x, y, z)];
+        if (*cell != CELL_PENDING) continue;
+        IVector3 cell_min = ivec3_add(field->left_bot_back, {{x << field->cell_log2, y << field->cell_log2, z << field->cell_log2}});
+        bool still = !occupied || occupied(user, cell_min, ivec3_scalar_add(cell_min, (1 << field->cell_log2) - 1));
+        *cell = still ? CELL_OCCUPIED : CELL_EMPTY;
+    }
+
+    const int reach = DISTANCE_MAX - 1;
+    IVector3 last = ivec3_scalar_add(field->cells, -1);
+    IVector3 out_min = ivec3_max(ivec3_scalar_add(field->dirty_min, -reach), ivec3_zero());
+    IVector3 out_max = ivec3_min(ivec3_scalar_add(field->dirty_max, reach), last);
+
+    // A passada em z lê 'reach' células além da região em z; a em y, além em y e z
+    IVector3 y_min = ivec3_max({{out_min.x, out_min.y, out_min.z - reach}}, ivec3_zero());
+    IVector3 y_max = ivec3_min({{out_max.x, out_max.y, out_max.z + reach}}, last);
+    IVector3 x_min = ivec3_max({{out_min.x, out_min.y - reach, out_min.z - reach}}, ivec3_zero());
+    IVector3 x_max = ivec3_min({{out_max.x, out_max.y + reach, out_max.z + reach}}, last);
+    IVector3 x_dim = ivec3_scalar_add(ivec3_sub(x_max, x_min), 1);
+    IVector3 y_dim = ivec3_scalar_add(ivec3_sub(y_max, y_min), 1);
+
+    uint8_t *along_x = (uint8_t*)malloc((size_t)x_dim.x * (size_t)x_dim.y * (size_t)x_dim.z);
+    uint8_t *along_y = (uint8_t*)malloc((size_t)y_dim.x * (size_t)y_dim.y * (size_t)y_dim.z);
+    if (!along_x || !along_y) {
+        free(along_x);
+        free(along_y);
+        return false; // fica sujo: o próximo update tenta de novo
+    }
+
+    Distance_Pass pass;
+    pass.threads = threads;
+    pass.src = field->occupied;
+    pass.src_occupancy = true;
+    _set_box(pass.src_min, ivec3_zero());
+    _set_box(pass.src_dim, field->cells);
+    pass.dst = along_x;
+    _set_box(pass.dst_min, x_min);
+    _set_box(pass.dst_dim, x_dim);
+    _set_box(pass.out_min, x_min);
+    _set_box(pass.out_max, x_max);
+    pass.axis = 0;
+    _run_pass(&pass);
+
+    pass.src = along_x;
+    pass.src_occupancy = false;
+    _set_box(pass.src_min, x_min);
+    _set_box(pass.src_dim, x_dim);
+    pass.dst = along_y;
+    _set_box(pass.dst_min, y_min);
+    _set_box(pass.dst_dim, y_dim);
+    _set_box(pass.out_min, y_min);
+    _set_box(pass.out_max, y_max);
+    pass.axis = 1;
+    _run_pass(&pass);
+
+    pass.src = along_y;
+    _set_box(pass.src_min, y_min);
+    _set_box(pass.src_dim, y_dim);
+    pass.dst = field->distance;
+    _set_box(pass.dst_min, ivec3_zero());
+    _set_box(pass.dst_dim, field->cells);
+    _set_box(pass.out_min, out_min);
+    _set_box(pass.out_max, out_max);
+    pass.axis = 2;
+    _run_pass(&pass);
+
+    free(along_x);
+    free(along_y);
+    _clear_dirty(field);
+    return true;
+}
+
+// --- CONSULTAS ---
+
+// Distância (em células) da célula de 'coord'; 0 fora do campo
+int distance_field_at(const Distance_Field *field, IVector3 coord) {
+    if (!field) return 0;
+    IVector3 l = ivec3_sub(coord, field->left_bot_back);
+    if (l.x < 0 || l.y < 0 || l.z < 0) return 0;
+    IVector3 cell = {{l.x >> field->cell_log2, l.y >> field->cell_log2, l.z >> field->cell_log2}};
+    if (cell.x >= field->cells.x || cell.y >= field->cells.y || cell.z >= field->cells.z) return 0;
+    return field->distance[_cell_index(field, cell.x, cell.y, cell.z)];
+}
+
+// Quanto o raio pode andar (em unidades de 'dir') a partir de 'pos' sem chegar perto de
+// um voxel: até sair da caixa vazia em volta da célula, encolhida pela largura do cone
+// (um nó com média cortado pelo cone tem lado até 'footprint' e contém um voxel, então ele
+// nunca entra na caixa encolhida). A largura cresce 'spread' por unidade de distância
+// também durante o pulo. A caixa não passa da borda do campo (fora dele não se sabe nada).
+// 0 = sem atalho (ou o campo está sujo); 'axis' = face de saída.
+float distance_field_skip(const Distance_Field *field, Vector3 pos, Vector3 dir, float footprint, float spread, int *axis) {
+    if (!field || distance_field_is_dirty(field)) return 0.0f;
+    IVector3 coord = {{(int)floorf(pos.x), (int)floorf(pos.y), (int)floorf(pos.z)}};
+    int d = distance_field_at(field, coord);
+    if (d == 0) return 0.0f;
+
+    IVector3 cell = {{(coord.x - field->left_bot_back.x) >> field->cell_log2,
+                      (coord.y - field->left_bot_back.y) >> field->cell_log2,
+                      (coord.z - field->left_bot_back.z) >> field->cell_log2}};
+    float len = vec3_len(dir);
+    float p[3] = {pos.x, pos.y, pos.z};
+    float v[3] = {dir.x, dir.y, dir.z};
+    int c[3] = {cell.x, cell.y, cell.z};
+    int cells[3] = {field->cells.x, field->cells.y, field->cells.z};
+    int origin[3] = {field->left_bot_back.x, field->left_bot_back.y, field->left_bot_back.z};
+
+    float t = 1e30f;
+    for (int a = 0; a < 3; a++) {
+        if (fabsf(v[a]) < 1e-8f) continue;
+        int face = v[a] > 0.0f ? std::min(c[a] + d, cells[a]) : std::max(c[a] - (d - 1), 0);
+        float room = fabsf((float)(origin[a] + (face << field->cell_log2)) - p[a]) - footprint;
+        float ta = room / (fabsf(v[a]) + spread * len);
+        if (ta < t) {
+            t = ta;
+            if (axis) *axis = a;
+        }
+    }
+    return t > 0.0f && t < 1e30f ? t : 0.0f;
+}
+
+// Campo para o shader: buffer[0..2] = mínimo do campo, buffer[3] = log2 do lado da
+// célula (0 = sem campo), buffer[4..6] = células por eixo; depois as distâncias, 4 por
+// int (x mais rápido, a primeira no byte baixo)
+int32_t *distance_field_gpu_buffer(const Distance_Field *field, size_t *arr_size) {
+    if (!arr_size) return NULL;
+    size_t count = field ? (size_t)field->cells.x * (size_t)field->cells.y * (size_t)field->cells.z : 0;
+    size_t words = 8 + (count + 3) / 4;
+    int32_t *buffer = (int32_t*)calloc(words, sizeof(int32_t));
+    if (!buffer) return NULL;
+    *arr_size = words * sizeof(int32_t);
+    if (!field) return buffer;
+
+    buffer[0] = field->left_bot_back.x;
+    buffer[1] = field->left_bot_back.y;
+    buffer[2] = field->left_bot_back.z;
+    buffer[3] = field->cell_log2;
+    buffer[4] = field->cells.x;
+    buffer[5] = field->cells.y;
+    buffer[6] = field->cells.z;
+    memcpy(buffer + 8, field->distance, count); // little-endian: byte i vai para o int i / 4
+    return buffer;
+}
+
+size_t distance_field_memory_usage(const Distance_Field *field) {
+    if (!field) return 0;
+    return sizeof(Distance_Field) + 2 * (size_t)field->cells.x * (size_t)field->cells.y * (size_t)field->cells.z;
+}
+
+void distance_field_delete(Distance_Field *field) {
+    if (!field) return;
+    free(field->occupied);
+    free(field->distance);
+    free(field);
+}
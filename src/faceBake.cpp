@@ -0,0 +1,608 @@
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+}
+#include <faceBake.hpp>
+#include <svoFile.hpp>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string.h>
+#include <math.h>
+
+#define TABLE_INITIAL_CAPACITY 64
+#define BAKE_GPU_HEADER 8                              //ints antes da tabela no buffer da GPU
+#define BAKE_GPU_BRICK_INTS (1 + 3 * BAKE_MASK_WORDS)  //primeira face e (máscara, anteriores) por palavra
+// Abaixo disto (faces por lote) o assador fica numa thread só
+#define BAKE_MIN_FACES_PER_THREAD 16
+
+#define BAKE_FILE_MAGIC "VXBAKE\r\n"
+#define BAKE_FILE_VERSION 1
+#define BAKE_FILE_SEED 0x6261b7e5f00dull
+
+// Cabeçalho do arquivo (little-endian); depois os blocos (Bake_File_Brick) e as faces de
+// todos eles, RGB9E5 na ordem dos blocos e dos bits
+typedef struct _bake_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;       //sizeof(Bake_File_Header)
+    float sun[3];
+    int32_t samples;
+    uint64_t brick_count;
+    uint64_t face_count;
+    uint64_t checksum;          //dos blocos e das faces (ver svo_file_checksum)
+} Bake_File_Header;
+
+typedef struct _bake_file_brick {
+    int32_t origin[3];
+    uint32_t count;
+    uint64_t exposed[BAKE_MASK_WORDS];
+} Bake_File_Brick;
+
+static double _now_ms(void) {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+// --- RGB9E5 (expoente compartilhado, como GL_RGB9_E5) ---
+
+#define RGB9E5_BIAS 15
+#define RGB9E5_MANTISSA 9
+// Abaixo do máximo do formato: 0xFFFFFFFF fica livre para BAKE_UNKNOWN
+#define RGB9E5_MAX 60000.0f
+
+uint32_t face_bake_pack(Vector3 rgb) {
+    float c[3] = {rgb.x, rgb.y, rgb.z};
+    for (int i = 0; i < 3; i++) c[i] = (c[i] > 0.0f) ? (c[i] < RGB9E5_MAX ? c[i] : RGB9E5_MAX) : 0.0f;
+    float max = std::max(c[0], std::max(c[1], c[2]));
+    if (max <= 0.0f) return 0;
+    int exponent = std::max(-RGB9E5_BIAS - 1, (int)floorf(log2f(max))) + 1 + RGB9E5_BIAS;
+    float denom = exp2f((float)(exponent - RGB9E5_BIAS - RGB9E5_MANTISSA));
+    if ((int)floorf(max / denom + 0.5f) == (1 << RGB9E5_MANTISSA)) {
+        denom *= 2.0f;
+        exponent++;
+    }
+    uint32_t m[3];
+    for (int i = 0; i < 3; i++) m[i] = (uint32_t)floorf(c[i] / denom + 0.5f);
+    return m[0] | (m[1] << 9) | (m[2] << 18) | ((uint32_t)exponent << 27);
+}
+
+Vector3 face_bake_unpack(uint32_t packed) {
+    float scale = exp2f((float)((int)(packed >> 27) - RGB9E5_BIAS - RGB9E5_MANTISSA));
+    return vec3_float((packed & 511) * scale, ((packed >> 9) & 511) * scale, ((packed >> 18) & 511) * scale);
+}
+
+// --- Blocos (tabela hash) ---
+
+static IVector3 _origin(IVector3 c) {
+    const int m = BAKE_BRICK_DIM - 1;
+    return {{c.x & ~m, c.y & ~m, c.z & ~m}};
+}
+
+static int _cell(IVector3 c) {
+    const int m = BAKE_BRICK_DIM - 1;
+    return (c.x & m) + BAKE_BRICK_DIM * ((c.y & m) + BAKE_BRICK_DIM * (c.z & m));
+}
+
+static IVector3 _cell_coord(const Bake_Brick *brick, int cell) {
+    return ivec3_add(brick->origin, {{cell % BAKE_BRICK_DIM, (cell / BAKE_BRICK_DIM) % BAKE_BRICK_DIM, cell / (BAKE_BRICK_DIM * BAKE_BRICK_DIM)}});
+}
+
+// O mesmo hash do shader (brickSlot)
+static size_t _hash(IVector3 origin) {
+    uint32_t x = (uint32_t)(origin.x >> BAKE_BRICK_LOG2), y = (uint32_t)(origin.y >> BAKE_BRICK_LOG2), z = (uint32_t)(origin.z >> BAKE_BRICK_LOG2);
+    return (size_t)((x * 73856093u) ^ (y * 19349663u) ^ (z * 83492791u));
+}
+
+static bool _same(IVector3 a, IVector3 b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+static Bake_Brick **_slot(Bake_Brick **table, size_t capacity, IVector3 origin) {
+    size_t i = _hash(origin) & (capacity - 1);
+    while (table[i] && !_same(table[i]->origin, origin)) i = (i + 1) & (capacity - 1);
+    return &table[i];
+}
+
+static bool _rehash(Face_Bake *bake, size_t capacity) {
+    Bake_Brick **table = (Bake_Brick**)calloc(capacity, sizeof(Bake_Brick*));
+    if (!table) return false;
+    for (size_t i = 0; i < bake->capacity; i++) {
+        if (bake->table[i]) *_slot(table, capacity, bake->table[i]->origin) = bake->table[i];
+    }
+    free(bake->table);
+    bake->table = table;
+    bake->capacity = capacity;
+    return true;
+}
+
+static Bake_Brick *_find(const Face_Bake *bake, IVector3 coord) {
+    return *_slot(bake->table, bake->capacity, _origin(coord));
+}
+
+static Bake_Brick *_create(Face_Bake *bake, IVector3 coord) {
+    if ((bake->count + 1) * 2 > bake->capacity && !_rehash(bake, bake->capacity * 2)) return NULL;
+    Bake_Brick *brick = (Bake_Brick*)calloc(1, sizeof(Bake_Brick));
+    if (!brick) return NULL;
+    brick->origin = _origin(coord);
+    *_slot(bake->table, bake->capacity, brick->origin) = brick;
+    bake->count++;
+    return brick;
+}
+
+// Tira da tabela de uma vez (o endereçamento aberto não aceita buracos no meio das
+// sequências) e só então libera
+static void _remove_bricks(Face_Bake *bake, std::vector<Bake_Brick*> &gone) {
+    if (gone.empty()) return;
+    std::sort(gone.begin(), gone.end());
+    gone.erase(std::unique(gone.begin(), gone.end()), gone.end());
+    for (size_t i = 0; i < bake->capacity; i++) {
+        if (bake->table[i] && std::binary_search(gone.begin(), gone.end(), bake->table[i])) bake->table[i] = NULL;
+    }
+    _rehash(bake, bake->capacity);
+    for (Bake_Brick *brick : gone) {
+        free(brick->faces);
+        free(brick);
+    }
+    bake->count -= gone.size();
+    gone.clear();
+}
+
+// Posição da face 'bit' (ligada em 'exposed') no array do bloco
+static uint32_t _index(const Bake_Brick *brick, int bit) {
+    uint64_t below = brick->exposed[bit >> 6] & ((1ull << (bit & 63)) - 1ull);
+    return brick->before[bit >> 6] + (uint32_t)__builtin_popcountll(below);
+}
+
+// Troca as faces guardadas do bloco: as que continuam mantêm a cor, as novas começam sem
+static bool _relayout(Face_Bake *bake, Bake_Brick *brick, const uint64_t *mask) {
+    uint32_t count = 0;
+    for (int w = 0; w < BAKE_MASK_WORDS; w++) count += (uint32_t)__builtin_popcountll(mask[w]);
+    uint32_t *faces = count ? (uint32_t*)malloc(count * sizeof(uint32_t)) : NULL;
+    if (count && !faces) return false;
+    uint32_t at = 0;
+    for (int w = 0; w < BAKE_MASK_WORDS; w++) {
+        for (uint64_t bits = mask[w]; bits; bits &= bits - 1) {
+            int bit = w * 64 + __builtin_ctzll(bits);
+            bool kept = (brick->exposed[w] >> (bit & 63)) & 1ull;
+            faces[at++] = kept ? brick->faces[_index(brick, bit)] : BAKE_UNKNOWN;
+        }
+    }
+    // Faces que saíram não esperam mais o assador
+    for (int w = 0; w < BAKE_MASK_WORDS; w++) {
+        bake->dirty -= (size_t)__builtin_popcountll(brick->dirty[w] & ~mask[w]);
+        brick->dirty[w] &= mask[w];
+    }
+    free(brick->faces);
+    brick->faces = faces;
+    bake->faces = bake->faces - brick->count + count;
+    brick->count = count;
+    uint16_t before = 0;
+    for (int w = 0; w < BAKE_MASK_WORDS; w++) {
+        brick->exposed[w] = mask[w];
+        brick->before[w] = before;
+        before += (uint16_t)__builtin_popcountll(mask[w]);
+    }
+    return true;
+}
+
+// --- Fila de blocos sujos ---
+
+static bool _enqueue(Face_Bake *bake, Bake_Brick *brick) {
+    if (brick->queued) return true;
+    if (bake->queue_count == bake->queue_capacity) {
+        size_t capacity = bake->queue_capacity ? bake->queue_capacity * 2 : 64;
+        Bake_Brick **queue = (Bake_Brick**)malloc(capacity * sizeof(Bake_Brick*));
+        if (!queue) return false;
+        for (size_t i = 0; i < bake->queue_count; i++) queue[i] = bake->queue[(bake->queue_first + i) % bake->queue_capacity];
+        free(bake->queue);
+        bake->queue = queue;
+        bake->queue_first = 0;
+        bake->queue_capacity = capacity;
+    }
+    bake->queue[(bake->queue_first + bake->queue_count) % bake->queue_capacity] = brick;
+    bake->queue_count++;
+    brick->queued = true;
+    return true;
+}
+
+// As faces 'bits' da palavra 'w' voltam para a estimativa ao vivo até serem assadas de novo
+static void _mark(Face_Bake *bake, Bake_Brick *brick, int w, uint64_t bits) {
+    bits &= brick->exposed[w];
+    if (!bits) return;
+    for (uint64_t b = bits; b; b &= b - 1) brick->faces[_index(brick, w * 64 + __builtin_ctzll(b))] = BAKE_UNKNOWN;
+    bake->dirty += (size_t)__builtin_popcountll(bits & ~brick->dirty[w]);
+    brick->dirty[w] |= bits;
+    bake->changed = true;
+    _enqueue(bake, brick);
+}
+
+// Bits das 6 faces de cada célula de [lo, hi] (inclusivos, dentro do bloco)
+static void _cell_bits(IVector3 lo, IVector3 hi, uint64_t *bits) {
+    memset(bits, 0, BAKE_MASK_WORDS * sizeof(uint64_t));
+    for (int z = lo.z; z <= hi.z; z++)
+    for (int y = lo.y; y <= hi.y; y++)
+    for (int x = lo.x; x <= hi.x; x++) {
+        int first = _cell({{x, y, z}}) * 6;
+        for (int face = 0; face < 6; face++) bits[(first + face) >> 6] |= 1ull << ((first + face) & 63);
+    }
+}
+
+// --- API ---
+
+Face_Bake *face_bake_create(Vector3 sun, int samples, bool (*exposed)(void *user, IVector3 coord, int face),
+                            Vector3 (*trace)(void *user, IVector3 coord, int face, Vector3 sun, int samples, uint64_t seed),
+                            void *user) {
+    if (!exposed || !trace) return NULL;
+    Face_Bake *bake = (Face_Bake*)calloc(1, sizeof(Face_Bake));
+    if (!bake) return NULL;
+    bake->sun = vec3_normalize(sun);
+    bake->samples = samples > 0 ? samples : 1;
+    bake->exposed = exposed;
+    bake->trace = trace;
+    bake->user = user;
+    bake->capacity = TABLE_INITIAL_CAPACITY;
+    bake->table = (Bake_Brick**)calloc(bake->capacity, sizeof(Bake_Brick*));
+    if (!bake->table) {
+        free(bake);
+        return NULL;
+    }
+    return bake;
+}
+
+// Relê quais faces de [vox_min, vox_max] (inclusivos) estão à mostra e manda todas elas
+// para o assador
+void face_bake_touch(Face_Bake *bake, IVector3 vox_min, IVector3 vox_max) {
+    if (!bake) return;
+    IVector3 min = ivec3_min(vox_min, vox_max), max = ivec3_max(vox_min, vox_max);
+    IVector3 first = _origin(min), last = _origin(max);
+    std::vector<Bake_Brick*> gone;
+    for (int bz = first.z; bz <= last.z; bz += BAKE_BRICK_DIM)
+    for (int by = first.y; by <= last.y; by += BAKE_BRICK_DIM)
+    for (int bx = first.x; bx <= last.x; bx += BAKE_BRICK_DIM) {
+        IVector3 origin = {{bx, by, bz}};
+        IVector3 lo = ivec3_max(min, origin), hi = ivec3_min(max, ivec3_scalar_add(origin, BAKE_BRICK_DIM - 1));
+        Bake_Brick *brick = _find(bake, origin);
+        uint64_t mask[BAKE_MASK_WORDS], touched[BAKE_MASK_WORDS];
+        if (brick) memcpy(mask, brick->exposed, sizeof(mask));
+        else memset(mask, 0, sizeof(mask));
+        _cell_bits(lo, hi, touched);
+
+        bool any = false;
+        for (int z = lo.z; z <= hi.z; z++)
+        for (int y = lo.y; y <= hi.y; y++)
+        for (int x = lo.x; x <= hi.x; x++) {
+            int bit = _cell({{x, y, z}}) * 6;
+            for (int face = 0; face < 6; face++, bit++) {
+                if (bake->exposed(bake->user, {{x, y, z}}, face)) {
+                    mask[bit >> 6] |= 1ull << (bit & 63);
+                    any = true;
+                } else {
+                    mask[bit >> 6] &= ~(1ull << (bit & 63));
+                }
+            }
+        }
+        if (!brick && !any) continue;
+        if (!brick && !(brick = _create(bake, origin))) continue;
+        if (memcmp(mask, brick->exposed, sizeof(mask)) != 0) {
+            if (!_relayout(bake, brick, mask)) continue;
+            bake->changed = true;
+        }
+        for (int w = 0; w < BAKE_MASK_WORDS; w++) _mark(bake, brick, w, touched[w]);
+        if (brick->count == 0 && !brick->queued) gone.push_back(brick);
+    }
+    _remove_bricks(bake, gone);
+}
+
+// Depois de editar [vox_min, vox_max] (inclusivos): relê as faces com um voxel de folga e
+// manda para o assador as que estão a até 'radius' voxels da caixa. Mais longe a caixa
+// cobre pouco do hemisfério das faces (um voxel a 16 de distância é ~1/800 dele) e a
+// diferença fica abaixo do ruído do próprio assado.
+void face_bake_invalidate(Face_Bake *bake, IVector3 vox_min, IVector3 vox_max, int radius) {
+    if (!bake) return;
+    IVector3 min = ivec3_min(vox_min, vox_max), max = ivec3_max(vox_min, vox_max);
+    face_bake_touch(bake, ivec3_scalar_add(min, -1), ivec3_scalar_add(max, 1));
+
+    min = ivec3_scalar_add(min, -radius);
+    max = ivec3_scalar_add(max, radius);
+    IVector3 first = _origin(min), last = _origin(max);
+    for (int bz = first.z; bz <= last.z; bz += BAKE_BRICK_DIM)
+    for (int by = first.y; by <= last.y; by += BAKE_BRICK_DIM)
+    for (int bx = first.x; bx <= last.x; bx += BAKE_BRICK_DIM) {
+        IVector3 origin = {{bx, by, bz}};
+        Bake_Brick *brick = _find(bake, origin);
+        if (!brick) continue;
+        uint64_t bits[BAKE_MASK_WORDS];
+        _cell_bits(ivec3_max(min, origin), ivec3_min(max, ivec3_scalar_add(origin, BAKE_BRICK_DIM - 1)), bits);
+        for (int w = 0; w < BAKE_MASK_WORDS; w++) _mark(bake, brick, w, bits[w]);
+    }
+}
+
+typedef struct {
+    const Face_Bake *bake;
+    const IVector3 *coords;
+    const int *faces;
+    Vector3 *results;
+} Bake_Batch;
+
+static uint64_t _seed(IVector3 coord, int face) {
+    uint64_t h = ((uint64_t)(uint32_t)coord.x * 73856093ull) ^ ((uint64_t)(uint32_t)coord.y * 19349663ull << 21)
+               ^ ((uint64_t)(uint32_t)coord.z * 83492791ull << 42) ^ (uint64_t)face;
+    // splitmix64
+    h += 0x9E3779B97F4A7C15ull;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+    return h ^ (h >> 31);
+}
+
+static void _bake_range(const Bake_Batch *batch, size_t first, size_t last) {
+    const Face_Bake *bake = batch->bake;
+    for (size_t i = first; i < last; i++) {
+        batch->results[i] = bake->trace(bake->user, batch->coords[i], batch->faces[i], bake->sun, bake->samples,
+                                        _seed(batch->coords[i], batch->faces[i]));
+    }
+}
+
+static void _bake_parallel(const Bake_Batch *batch, size_t count, int threads) {
+    int workers = threads > 0 ? threads : (int)std::thread::hardware_concurrency();
+    if (workers < 1) workers = 1;
+    if ((size_t)workers > count / BAKE_MIN_FACES_PER_THREAD) workers = (int)(count / BAKE_MIN_FACES_PER_THREAD);
+    if (workers <= 1) {
+        _bake_range(batch, 0, count);
+        return;
+    }
+    std::vector<std::thread> pool;
+    for (int w = 0; w < workers; w++) {
+        pool.emplace_back(_bake_range, batch, count * w / workers, count * (w + 1) / workers);
+    }
+    for (std::thread &t : pool) t.join();
+}
+
+// Assa faces pendentes em lotes até 'budget_ms' passar (0 = todas), os lotes divididos
+// entre 'threads' threads (0 = uma por núcleo); true se o buffer da GPU mudou desde a última chamada (faces assadas ou
+// invalidadas por edições). Com orçamento, o lote é cortado pelo ritmo do anterior.
+bool face_bake_update(Face_Bake *bake, double budget_ms, int threads) {
+    if (!bake) return false;
+    bake->baked = 0;
+    bool changed = bake->changed;
+    bake->changed = false;
+    if (!bake->queue_count) return changed;
+
+    double t0 = _now_ms(), faces_per_ms = 0.0;
+    std::vector<IVector3> coords;
+    std::vector<int> faces;
+    std::vector<Vector3> results;
+    std::vector<std::pair<Bake_Brick*, int>> bits;
+    std::vector<Bake_Brick*> gone;
+    while (bake->queue_count) {
+        size_t limit = BAKE_BATCH_FACES;
+        if (budget_ms > 0.0 && faces_per_ms > 0.0) {
+            double fit = faces_per_ms * (budget_ms - (_now_ms() - t0));
+            if (fit < (double)limit) limit = fit < 1.0 ? 1 : (size_t)fit;
+        }
+
+        // Da frente da fila; o bloco só sai dela quando não sobra face suja
+        coords.clear();
+        faces.clear();
+        bits.clear();
+        while (bake->queue_count && coords.size() < limit) {
+            Bake_Brick *brick = bake->queue[bake->queue_first];
+            for (int w = 0; w < BAKE_MASK_WORDS && coords.size() < limit; w++) {
+                while (brick->dirty[w] && coords.size() < limit) {
+                    int bit = w * 64 + __builtin_ctzll(brick->dirty[w]);
+                    brick->dirty[w] &= brick->dirty[w] - 1;
+                    coords.push_back(_cell_coord(brick, bit / 6));
+                    faces.push_back(bit % 6);
+                    bits.push_back({brick, bit});
+                }
+            }
+            bool drained = true;
+            for (int w = 0; w < BAKE_MASK_WORDS && drained; w++) drained = brick->dirty[w] == 0;
+            if (!drained) break;
+            bake->queue_first = (bake->queue_first + 1) % bake->queue_capacity;
+            bake->queue_count--;
+            brick->queued = false;
+            if (brick->count == 0) gone.push_back(brick);
+        }
+        double b0 = _now_ms();
+        results.assign(coords.size(), vec3_zero());
+        Bake_Batch batch = {bake, coords.data(), faces.data(), results.data()};
+        _bake_parallel(&batch, coords.size(), threads);
+        double batch_ms = _now_ms() - b0;
+        if (batch_ms > 0.0) faces_per_ms = (double)coords.size() / batch_ms;
+
+        for (size_t i = 0; i < bits.size(); i++) {
+            Bake_Brick *brick = bits[i].first;
+            brick->faces[_index(brick, bits[i].second)] = face_bake_pack(results[i]);
+        }
+        bake->dirty -= coords.size();
+        bake->baked += coords.size();
+        changed |= !coords.empty();
+        if (budget_ms > 0.0 && _now_ms() - t0 >= budget_ms) break;
+    }
+    _remove_bricks(bake, gone);
+    return changed;
+}
+
+// Cor assada da face (false se a face não está guardada ou ainda não foi assada)
+bool face_bake_lookup(const Face_Bake *bake, IVector3 coord, int face, Vector3 *rgb) {
+    if (!bake || face < 0 || face > 5) return false;
+    Bake_Brick *brick = _find(bake, coord);
+    if (!brick) return false;
+    int bit = _cell(coord) * 6 + face;
+    if (!((brick->exposed[bit >> 6] >> (bit & 63)) & 1ull)) return false;
+    uint32_t packed = brick->faces[_index(brick, bit)];
+    if (packed == BAKE_UNKNOWN) return false;
+    if (rgb) *rgb = face_bake_unpack(packed);
+    return true;
+}
+
+// Assado para o shader: buffer[0] = capacidade da tabela (potência de 2, 0 = vazia),
+// buffer[1] = blocos, buffer[4..6] = sol do assado (bits do float; o shader ignora o
+// assado se o sol já for outro); a partir de buffer[8] a tabela como a do lightVolume,
+// depois BAKE_GPU_BRICK_INTS por bloco (primeira face dele e, por palavra da máscara,
+// metade baixa, metade alta e faces nas palavras anteriores) e as faces, um RGB9E5 por int
+// (-1 = não assada)
+int32_t *face_bake_gpu_buffer(const Face_Bake *bake, size_t *arr_size) {
+    if (!arr_size) return NULL;
+    size_t count = bake ? bake->count : 0;
+    size_t capacity = 0;
+    if (count) for (capacity = 1; capacity < count * 2; capacity *= 2) {}
+
+    size_t face_count = bake ? bake->faces : 0;
+    size_t words = BAKE_GPU_HEADER + capacity * 4 + count * BAKE_GPU_BRICK_INTS + face_count;
+    int32_t *buffer = (int32_t*)calloc(words, sizeof(int32_t));
+    if (!buffer) return NULL;
+    *arr_size = words * sizeof(int32_t);
+    buffer[0] = (int32_t)capacity;
+    buffer[1] = (int32_t)count;
+    if (!count) return buffer;
+    memcpy(&buffer[4], &bake->sun.x, sizeof(float));
+    memcpy(&buffer[5], &bake->sun.y, sizeof(float));
+    memcpy(&buffer[6], &bake->sun.z, sizeof(float));
+
+    int32_t *table = buffer + BAKE_GPU_HEADER, *bricks = table + capacity * 4;
+    int32_t *faces = bricks + count * BAKE_GPU_BRICK_INTS;
+    for (size_t i = 0; i < capacity; i++) table[i * 4 + 3] = -1;
+    int32_t index = 0, face_base = 0;
+    for (size_t i = 0; i < bake->capacity; i++) {
+        Bake_Brick *brick = bake->table[i];
+        if (!brick) continue;
+        size_t at = _hash(brick->origin) & (capacity - 1);
+        while (table[at * 4 + 3] >= 0) at = (at + 1) & (capacity - 1);
+        table[at * 4 + 0] = brick->origin.x >> BAKE_BRICK_LOG2;
+        table[at * 4 + 1] = brick->origin.y >> BAKE_BRICK_LOG2;
+        table[at * 4 + 2] = brick->origin.z >> BAKE_BRICK_LOG2;
+        table[at * 4 + 3] = index;
+
+        int32_t *record = bricks + (size_t)index * BAKE_GPU_BRICK_INTS;
+        record[0] = face_base;
+        for (int w = 0; w < BAKE_MASK_WORDS; w++) {
+            record[1 + w * 3] = (int32_t)(uint32_t)brick->exposed[w];
+            record[2 + w * 3] = (int32_t)(uint32_t)(brick->exposed[w] >> 32);
+            record[3 + w * 3] = brick->before[w];
+        }
+        if (brick->count) memcpy(faces + face_base, brick->faces, brick->count * sizeof(uint32_t));
+        face_base += (int32_t)brick->count;
+        index++;
+    }
+    return buffer;
+}
+
+// Imagem do arquivo (grave com svo_file_write_image); faces ainda não assadas vão como
+// BAKE_UNKNOWN e voltam para o assador na leitura
+uint8_t *face_bake_encode(const Face_Bake *bake, size_t *size) {
+    if (!bake || !size) return NULL;
+    size_t bytes = sizeof(Bake_File_Header) + bake->count * sizeof(Bake_File_Brick) + bake->faces * sizeof(uint32_t);
+    uint8_t *image = (uint8_t*)calloc(1, bytes);
+    if (!image) return NULL;
+
+    Bake_File_Brick *bricks = (Bake_File_Brick*)(image + sizeof(Bake_File_Header));
+    uint32_t *faces = (uint32_t*)(bricks + bake->count);
+    size_t b = 0, f = 0;
+    for (size_t i = 0; i < bake->capacity; i++) {
+        Bake_Brick *brick = bake->table[i];
+        if (!brick) continue;
+        bricks[b].origin[0] = brick->origin.x;
+        bricks[b].origin[1] = brick->origin.y;
+        bricks[b].origin[2] = brick->origin.z;
+        bricks[b].count = brick->count;
+        memcpy(bricks[b].exposed, brick->exposed, sizeof(brick->exposed));
+        if (brick->count) memcpy(faces + f, brick->faces, brick->count * sizeof(uint32_t));
+        f += brick->count;
+        b++;
+    }
+
+    Bake_File_Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BAKE_FILE_MAGIC, sizeof(header.magic));
+    header.version = BAKE_FILE_VERSION;
+    header.header_size = sizeof(Bake_File_Header);
+    header.sun[0] = bake->sun.x; header.sun[1] = bake->sun.y; header.sun[2] = bake->sun.z;
+    header.samples = bake->samples;
+    header.brick_count = bake->count;
+    header.face_count = bake->faces;
+    header.checksum = svo_file_checksum(BAKE_FILE_SEED, image + sizeof(Bake_File_Header), bytes - sizeof(Bake_File_Header));
+    memcpy(image, &header, sizeof(header));
+    *size = bytes;
+    return image;
+}
+
+// Assado lido de uma imagem de face_bake_encode (NULL se estiver corrompida). Faces que
+// não estão mais à mostra no mundo atual ficam de fora; faces que apareceram depois do
+// assado não são procuradas (ver world_load_bake).
+Face_Bake *face_bake_decode(const uint8_t *image, size_t size, bool (*exposed)(void *user, IVector3 coord, int face),
+                            Vector3 (*trace)(void *user, IVector3 coord, int face, Vector3 sun, int samples, uint64_t seed),
+                            void *user) {
+    if (!image || size < sizeof(Bake_File_Header)) return NULL;
+    Bake_File_Header header;
+    memcpy(&header, image, sizeof(header));
+    if (memcmp(header.magic, BAKE_FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != BAKE_FILE_VERSION
+        || header.header_size != sizeof(Bake_File_Header)) return NULL;
+    if (header.brick_count > (size - sizeof(header)) / sizeof(Bake_File_Brick)) return NULL;
+    size_t bricks_end = sizeof(header) + header.brick_count * sizeof(Bake_File_Brick);
+    if (header.face_count != (size - bricks_end) / sizeof(uint32_t) || (size - bricks_end) % sizeof(uint32_t)) return NULL;
+    if (svo_file_checksum(BAKE_FILE_SEED, image + sizeof(header), size - sizeof(header)) != header.checksum) return NULL;
+
+    Face_Bake *bake = face_bake_create(vec3_float(header.sun[0], header.sun[1], header.sun[2]), header.samples, exposed, trace, user);
+    if (!bake) return NULL;
+    const Bake_File_Brick *bricks = (const Bake_File_Brick*)(image + sizeof(header));
+    const uint8_t *faces = image + bricks_end;
+    size_t f = 0;
+    std::vector<Bake_Brick*> gone;
+    for (uint64_t b = 0; b < header.brick_count; b++) {
+        Bake_File_Brick entry;
+        memcpy(&entry, &bricks[b], sizeof(entry));
+        uint32_t count = 0;
+        for (int w = 0; w < BAKE_MASK_WORDS; w++) count += (uint32_t)__builtin_popcountll(entry.exposed[w]);
+        if (count != entry.count || f + count > header.face_count) {
+            face_bake_delete(bake);
+            return NULL;
+        }
+        IVector3 origin = {{entry.origin[0], entry.origin[1], entry.origin[2]}};
+        Bake_Brick *brick = _create(bake, origin);
+        if (!brick || !_relayout(bake, brick, entry.exposed)) {
+            face_bake_delete(bake);
+            return NULL;
+        }
+        if (count) memcpy(brick->faces, faces + f * sizeof(uint32_t), count * sizeof(uint32_t));
+        f += count;
+
+        // Só o que ainda está à mostra; o que não foi assado volta para o assador
+        uint64_t mask[BAKE_MASK_WORDS], unknown[BAKE_MASK_WORDS];
+        memcpy(mask, brick->exposed, sizeof(mask));
+        for (int w = 0; w < BAKE_MASK_WORDS; w++) {
+            unknown[w] = 0;
+            for (uint64_t bits = brick->exposed[w]; bits; bits &= bits - 1) {
+                int bit = w * 64 + __builtin_ctzll(bits);
+                if (!exposed(user, _cell_coord(brick, bit / 6), bit % 6)) mask[w] &= ~(1ull << (bit & 63));
+                else if (brick->faces[_index(brick, bit)] == BAKE_UNKNOWN) unknown[w] |= 1ull << (bit & 63);
+            }
+        }
+        if (memcmp(mask, brick->exposed, sizeof(mask)) != 0) _relayout(bake, brick, mask);
+        for (int w = 0; w < BAKE_MASK_WORDS; w++) _mark(bake, brick, w, unknown[w]);
+        if (brick->count == 0 && !brick->queued) gone.push_back(brick);
+    }
+    _remove_bricks(bake, gone);
+    bake->changed = true;
+    return bake;
+}
+
+size_t face_bake_memory_usage(const Face_Bake *bake) {
+    if (!bake) return 0;
+    return sizeof(Face_Bake) + bake->capacity * sizeof(Bake_Brick*) + bake->queue_capacity * sizeof(Bake_Brick*)
+         + bake->count * sizeof(Bake_Brick) + bake->faces * sizeof(uint32_t);
+}
+
+void face_bake_delete(Face_Bake *bake) {
+    if (!bake) return;
+    for (size_t i = 0; i < bake->capacity; i++) {
+        if (!bake->table[i]) continue;
+        free(bake->table[i]->faces);
+        free(bake->table[i]);
+    }
+    free(bake->table);
+    free(bake->queue);
+    free(bake);
+}
@@ -0,0 +1,204 @@
+extern "C" {
+    #include <vmm/ivec3.h>
+}
+#include <history.hpp>
+#include <stdlib.h>
+#include <string.h>
+
+static bool _is_air(Voxel_Object voxel) {
+    return voxel.coord.y == _invalid_voxel().coord.y;
+}
+
+// As ações ficam num anel: a mais antiga sai sem mover as outras
+static History_Action *_at(History *history, size_t i) {
+    return &history->actions[(history->first + i) % history->capacity];
+}
+
+static void _free_action(History *history, History_Action *action) {
+    octree_delete(action->region_before);
+    octree_delete(action->region_after);
+    history->bytes -= action->bytes;
+}
+
+static bool _grow(History *history) {
+    size_t capacity = history->capacity ? history->capacity * 2 : 64;
+    History_Action *actions = (History_Action*)malloc(sizeof(History_Action) * capacity);
+    if (!actions) return false;
+    for (size_t i = 0; i < history->count; i++) actions[i] = *_at(history, i);
+    free(history->actions);
+    history->actions = actions;
+    history->capacity = capacity;
+    history->first = 0;
+    return true;
+}
+
+// Uma ação nova apaga o que podia ser refeito; depois as mais antigas saem até caber no
+// limite (uma ação maior que o limite inteiro também sai, e não pode ser desfeita)
+static void _push(History *history, History_Action action) {
+    while (history->count > history->applied) _free_action(history, _at(history, --history->count));
+    if (history->count == history->capacity && !_grow(history)) {
+        octree_delete(action.region_before);
+        octree_delete(action.region_after);
+        return;
+    }
+    action.bytes = sizeof(History_Action) + octree_memory_usage(action.region_before) + octree_memory_usage(action.region_after);
+    *_at(history, history->count++) = action;
+    history->applied = history->count;
+    history->bytes += action.bytes;
+
+    while (history->count > 0 && history->bytes > history->max_bytes) {
+        _free_action(history, _at(history, 0));
+        history->first = (history->first + 1) % history->capacity;
+        history->count--;
+        history->applied--;
+    }
+}
+
+History *history_create(size_t max_bytes, Journal *journal) {
+    History *history = (History*)calloc(1, sizeof(History));
+    if (!history) return NULL;
+    history->max_bytes = max_bytes ? max_bytes : HISTORY_MAX_BYTES;
+    history->journal = journal;
+    return history;
+}
+
+// --- EDIÇÕES ---
+
+static void _set_cell(History *history, World *world, IVector3 coord, Voxel_Object voxel) {
+    if (_is_air(voxel)) {
+        world_remove(world, coord);
+        journal_remove(history->journal, coord);
+    } else {
+        voxel.coord = coord;
+        world_insert(world, voxel);
+        journal_insert(history->journal, voxel);
+    }
+}
+
+// A caixa passa a ser exatamente 'content' (origem em min): o backend é apagado e o
+// conteúdo enxertado por cima, sem passar célula por célula
+static void _set_region(History *history, World *world, IVector3 min, IVector3 max, Octree *content) {
+    world_clear_region(world, min, max);
+    world_paste(world, content, voxel_transform_translation(min));
+    journal_region(history->journal, min, max, content);
+}
+
+static History_Action _voxel_action(IVector3 coord, Voxel_Object before, Voxel_Object after) {
+    History_Action action;
+    memset(&action, 0, sizeof(action));
+    action.kind = HISTORY_VOXEL;
+    action.min = action.max = coord;
+    action.before = before;
+    action.after = after;
+    return action;
+}
+
+void history_insert(History *history, World *world, Voxel_Object voxel) {
+    if (!history || !world) return;
+    Voxel_Object before = world_find_static(world, voxel.coord);
+    _set_cell(history, world, voxel.coord, voxel);
+    _push(history, _voxel_action(voxel.coord, before, voxel));
+}
+
+void history_remove(History *history, World *world, IVector3 coord) {
+    if (!history || !world) return;
+    Voxel_Object before = world_find_static(world, coord);
+    if (_is_air(before)) return;
+    _set_cell(history, world, coord, _invalid_voxel());
+    _push(history, _voxel_action(coord, before, _invalid_voxel()));
+}
+
+// Limita a caixa ao mundo (os backends sem limites aceitam qualquer uma)
+static bool _clip_box(World *world, IVector3 *min, IVector3 *max) {
+    IVector3 lo = ivec3_min(*min, *max), hi = ivec3_max(*min, *max);
+    if (!world_is_unbounded(world)) {
+        lo = ivec3_max(lo, world->left_bot_back);
+        hi = ivec3_min(hi, ivec3_scalar_add(world->right_top_front, -1));
+    }
+    *min = lo;
+    *max = hi;
+    return lo.x <= hi.x && lo.y <= hi.y && lo.z <= hi.z;
+}
+
+// Preenche [vox_min, vox_max] (inclusivos) com o material de 'voxel' (ver world_fill).
+// Guarda as subárvores que a caixa tinha; refazer só preenche de novo.
+bool history_fill(History *history, World *world, IVector3 vox_min, IVector3 vox_max, Voxel_Object voxel) {
+    if (!history || !world || !_clip_box(world, &vox_min, &vox_max)) return false;
+    History_Action action;
+    memset(&action, 0, sizeof(action));
+    action.kind = HISTORY_FILL;
+    action.min = vox_min;
+    action.max = vox_max;
+    action.after = voxel;
+    action.region_before = world_copy_region(world, vox_min, vox_max);
+    if (!action.region_before) return false;
+
+    world_fill(world, vox_min, vox_max, voxel);
+    journal_fill(history->journal, vox_min, vox_max, voxel);
+    _push(history, action);
+    return true;
+}
+
+// Cola como world_paste. Guarda a caixa que os voxels do 'clip' ocupam, antes e depois.
+bool history_paste(History *history, World *world, Octree *clip, Voxel_Transform transform) {
+    if (!history || !world || !clip) return false;
+    IVector3 min, max;
+    if (!octree_bounds(clip, &min, &max)) return false;
+    IVector3 a = voxel_transform_cell(&transform, min), b = voxel_transform_cell(&transform, max);
+    min = a;
+    max = b;
+    if (!_clip_box(world, &min, &max)) return false;
+
+    History_Action action;
+    memset(&action, 0, sizeof(action));
+    action.kind = HISTORY_REGION;
+    action.min = min;
+    action.max = max;
+    action.region_before = world_copy_region(world, min, max);
+    if (!action.region_before) return false;
+    if (!world_paste(world, clip, transform)) {
+        octree_delete(action.region_before);
+        return false;
+    }
+    action.region_after = world_copy_region(world, min, max);
+    journal_region(history->journal, min, max, action.region_after);
+    _push(history, action);
+    return true;
+}
+
+// --- DESFAZER / REFAZER ---
+
+bool history_undo(History *history, World *world) {
+    if (!history || !world || history->applied == 0) return false;
+    History_Action *action = _at(history, --history->applied);
+    if (action->kind == HISTORY_VOXEL) _set_cell(history, world, action->min, action->before);
+    else _set_region(history, world, action->min, action->max, action->region_before);
+    return true;
+}
+
+bool history_redo(History *history, World *world) {
+    if (!history || !world || history->applied == history->count) return false;
+    History_Action *action = _at(history, history->applied++);
+    if (action->kind == HISTORY_VOXEL) {
+        _set_cell(history, world, action->min, action->after);
+    } else if (action->kind == HISTORY_FILL) {
+        world_fill(world, action->min, action->max, action->after);
+        journal_fill(history->journal, action->min, action->max, action->after);
+    } else {
+        _set_region(history, world, action->min, action->max, action->region_after);
+    }
+    return true;
+}
+
+// Inclui as posições livres do anel; o limite de history_create só conta as ocupadas
+size_t history_memory_usage(History *history) {
+    if (!history) return 0;
+    return sizeof(History) + history->bytes + (history->capacity - history->count) * sizeof(History_Action);
+}
+
+void history_delete(History *history) {
+    if (!history) return;
+    for (size_t i = 0; i < history->count; i++) _free_action(history, _at(history, i));
+    free(history->actions);
+    free(history);
+}
@@ -0,0 +1,647 @@
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+    #include <vmm/ray.h>
+}
+#include <instances.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Ponteiros da textura têm 23 bits (ver _encode_pointer na octree)
+#define TEXTURE_MAX_TEXELS 0x800000
+
+// Flags da raiz do modelo no buffer da GPU (4º componente do 5º ivec4 de cada instância)
+#define GPU_ROOT_LEAF 1
+#define GPU_ROOT_POINT 2
+
+// --- TRANSFORMAÇÕES ---
+
+Voxel_Transform voxel_transform_identity(void) {
+    Voxel_Transform transform = {{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}, {{0, 0, 0}}};
+    return transform;
+}
+
+Voxel_Transform voxel_transform_translation(IVector3 offset) {
+    Voxel_Transform transform = voxel_transform_identity();
+    transform.translation = offset;
+    return transform;
+}
+
+// Cada linha da rotação tem um único ±1: o eixo espelhado perde uma célula para baixo
+// (a caixa [c, c + 1) vira [-c - 1, -c))
+static int _row_shift(const Voxel_Transform *transform, int row) {
+    const int *r = transform->rot[row];
+    return (r[0] + r[1] + r[2]) < 0 ? -1 : 0;
+}
+
+IVector3 voxel_transform_cell(const Voxel_Transform *transform, IVector3 local) {
+    const int (*r)[3] = transform->rot;
+    IVector3 cell = {{
+        r[0][0] * local.x + r[0][1] * local.y + r[0][2] * local.z + transform->translation.x + _row_shift(transform, 0),
+        r[1][0] * local.x + r[1][1] * local.y + r[1][2] * local.z + transform->translation.y + _row_shift(transform, 1),
+        r[2][0] * local.x + r[2][1] * local.y + r[2][2] * local.z + transform->translation.z + _row_shift(transform, 2)
+    }};
+    return cell;
+}
+
+// Inversa de voxel_transform_cell (a rotação é ortogonal: a inversa é a transposta)
+IVector3 voxel_transform_local_cell(const Voxel_Transform *transform, IVector3 cell) {
+    const int (*r)[3] = transform->rot;
+    int w[3] = {
+        cell.x - transform->translation.x - _row_shift(transform, 0),
+        cell.y - transform->translation.y - _row_shift(transform, 1),
+        cell.z - transform->translation.z - _row_shift(transform, 2)
+    };
+    IVector3 local = {{
+        r[0][0] * w[0] + r[1][0] * w[1] + r[2][0] * w[2],
+        r[0][1] * w[0] + r[1][1] * w[1] + r[2][1] * w[2],
+        r[0][2] * w[0] + r[1][2] * w[1] + r[2][2] * w[2]
+    }};
+    return local;
+}
+
+// Uma das 24 rotações do cubo (índice em [0, VOXEL_ROTATIONS), 0 = identidade):
+// permutações dos eixos com sinais, só as de determinante +1 (sem espelho)
+Voxel_Transform voxel_transform_rotation(int index) {
+    static const int perms[6][3] = {{0, 1, 2}, {1, 2, 0}, {2, 0, 1}, {0, 2, 1}, {2, 1, 0}, {1, 0, 2}};
+    Voxel_Transform transform = voxel_transform_identity();
+    index = ((index % VOXEL_ROTATIONS) + VOXEL_ROTATIONS) % VOXEL_ROTATIONS;
+    for (int p = 0; p < 6; p++) {
+        for (int signs = 0; signs < 8; signs++) {
+            int s[3] = {(signs & 1) ? -1 : 1, (signs & 2) ? -1 : 1, (signs & 4) ? -1 : 1};
+            // As 3 primeiras permutações são pares
+            if (s[0] * s[1] * s[2] * (p < 3 ? 1 : -1) != 1) continue;
+            if (index-- > 0) continue;
+            memset(transform.rot, 0, sizeof(transform.rot));
+            for (int row = 0; row < 3; row++) transform.rot[row][perms[p][row]] = s[row];
+            return transform;
+        }
+    }
+    return transform;
+}
+
+// Gira a caixa de células [0, size) pela rotação 'rotation' e põe o canto mínimo da
+// imagem em 'offset' (a caixa colada ocupa [offset, offset + tamanho girado))
+Voxel_Transform voxel_transform_place(int rotation, IVector3 size, IVector3 offset) {
+    Voxel_Transform transform = voxel_transform_rotation(rotation);
+    IVector3 a = voxel_transform_cell(&transform, {{0, 0, 0}});
+    IVector3 b = voxel_transform_cell(&transform, ivec3_scalar_add(size, -1));
+    transform.translation = ivec3_sub(offset, ivec3_min(a, b));
+    return transform;
+}
+
+static Vector3 _transpose_mul(const int (*r)[3], Vector3 v) {
+    return vec3_float(r[0][0] * v.x + r[1][0] * v.y + r[2][0] * v.z,
+                      r[0][1] * v.x + r[1][1] * v.y + r[2][1] * v.z,
+                      r[0][2] * v.x + r[1][2] * v.y + r[2][2] * v.z);
+}
+
+// Raio do mundo no espaço do modelo. A rotação preserva comprimentos, então o
+// parâmetro t de um ponto é o mesmo nos dois espaços.
+Ray voxel_transform_local_ray(const Voxel_Transform *transform, Ray ray) {
+    Ray local = ray;
+    local.origin = _transpose_mul(transform->rot, vec3_sub(ray.origin, vec3_ivec3(transform->translation)));
+    local.direction = _transpose_mul(transform->rot, ray.direction);
+    return local;
+}
+
+// --- LISTA ---
+
+Instance_Set *instance_set_create(void) {
+    return (Instance_Set*)calloc(1, sizeof(Instance_Set));
+}
+
+// Caixa da instância no mundo, [min, max)
+static void _instance_box(const Voxel_Instance *inst, IVector3 *min, IVector3 *max) {
+    IVector3 a = voxel_transform_cell(&inst->transform, inst->local_min);
+    IVector3 b = voxel_transform_cell(&inst->transform, inst->local_max);
+    *min = ivec3_min(a, b);
+    *max = ivec3_scalar_add(ivec3_max(a, b), 1);
+}
+
+// A lista passa a ser dona de mais uma referência ao modelo (ver Octree::shares).
+// Retorna o índice da instância, ou -1 (modelo vazio ou sem memória).
+long instance_set_add(Instance_Set *set, Octree *model, Voxel_Transform transform) {
+    if (!set || !model) return -1;
+
+    // Cópias do mesmo modelo costumam entrar em sequência: reaproveita a caixa ocupada
+    Voxel_Instance inst;
+    if (set->count > 0 && set->items[set->count - 1].model == model) {
+        inst.local_min = set->items[set->count - 1].local_min;
+        inst.local_max = set->items[set->count - 1].local_max;
+    } else if (!octree_bounds(model, &inst.local_min, &inst.local_max)) {
+        return -1;
+    }
+    inst.model = model;
+    inst.transform = transform;
+    inst.gpu_root = -1;
+
+    if (set->count == set->capacity) {
+        size_t capacity = set->capacity ? set->capacity * 2 : 16;
+        Voxel_Instance *items = (Voxel_Instance*)realloc(set->items, capacity * sizeof(Voxel_Instance));
+        if (!items) return -1;
+        set->items = items;
+        set->capacity = capacity;
+    }
+    model->shares++;
+    set->items[set->count] = inst;
+    set->needs_build = true;
+    return (long)set->count++;
+}
+
+// Mover não muda a estrutura: a BVH só é reajustada (refit) no próximo update
+bool instance_set_move(Instance_Set *set, size_t index, Voxel_Transform transform) {
+    if (!set || index >= set->count) return false;
+    set->items[index].transform = transform;
+    set->needs_refit = true;
+    return true;
+}
+
+// Troca o modelo da instância (quadros de uma animação) ou, com o mesmo modelo, relê a
+// caixa ocupada depois de editá-lo. A caixa é do modelo: as outras instâncias dele
+// também são atualizadas. A estrutura não muda, então basta o refit.
+bool instance_set_replace(Instance_Set *set, size_t index, Octree *model) {
+    if (!set || !model || index >= set->count) return false;
+
+    IVector3 local_min, local_max;
+    if (!octree_bounds(model, &local_min, &local_max)) return false;
+
+    Voxel_Instance *inst = &set->items[index];
+    if (inst->model != model) {
+        model->shares++;
+        octree_delete(inst->model);
+        inst->model = model;
+        inst->gpu_root = -1;
+    }
+    for (size_t i = 0; i < set->count; i++) {
+        if (set->items[i].model != model) continue;
+        set->items[i].local_min = local_min;
+        set->items[i].local_max = local_max;
+    }
+    set->needs_refit = true;
+    return true;
+}
+
+// Tira a instância da lista mantendo a ordem das outras (a de índice maior continua
+// vencendo); os índices depois de 'index' descem um
+bool instance_set_remove(Instance_Set *set, size_t index) {
+    if (!set || index >= set->count) return false;
+
+    Octree *model = set->items[index].model;
+    memmove(&set->items[index], &set->items[index + 1], (set->count - index - 1) * sizeof(Voxel_Instance));
+    set->count--;
+    set->needs_build = true;
+    octree_delete(model);
+    return true;
+}
+
+// --- BVH ---
+
+static float _box_area(const Instance_BVH_Node *node) {
+    float dx = (float)(node->max[0] - node->min[0]);
+    float dy = (float)(node->max[1] - node->min[1]);
+    float dz = (float)(node->max[2] - node->min[2]);
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+static void _node_set_box(Instance_BVH_Node *node, IVector3 min, IVector3 max) {
+    node->min[0] = min.x; node->min[1] = min.y; node->min[2] = min.z;
+    node->max[0] = max.x; node->max[1] = max.y; node->max[2] = max.z;
+}
+
+static void _node_union(Instance_BVH_Node *node, const Instance_BVH_Node *a, const Instance_BVH_Node *b) {
+    for (int i = 0; i < 3; i++) {
+        node->min[i] = std::min(a->min[i], b->min[i]);
+        node->max[i] = std::max(a->max[i], b->max[i]);
+    }
+}
+
+static void _leaf_box(Instance_Set *set, Instance_BVH_Node *node) {
+    IVector3 min, max;
+    _instance_box(&set->items[set->order[node->first]], &min, &max);
+    for (int k = 1; k < node->count; k++) {
+        IVector3 a, b;
+        _instance_box(&set->items[set->order[node->first + k]], &a, &b);
+        min = ivec3_min(min, a);
+        max = ivec3_max(max, b);
+    }
+    _node_set_box(node, min, max);
+}
+
+static int _axis(IVector3 v, int axis) {
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+// Divide pela mediana dos centros no eixo mais longo. É O(n log n) e barato o bastante
+// para reconstruir a cada quadro com milhares de instâncias.
+static void _build_node(Instance_Set *set, size_t index, size_t first, size_t count, const std::vector<IVector3> &centers) {
+    Instance_BVH_Node *node = &set->nodes[index];
+    node->first = (int32_t)first;
+    node->count = (int32_t)count;
+    _leaf_box(set, node);
+    if (count <= INSTANCE_BVH_LEAF) return;
+
+    IVector3 lo = centers[set->order[first]], hi = lo;
+    for (size_t i = first + 1; i < first + count; i++) {
+        lo = ivec3_min(lo, centers[set->order[i]]);
+        hi = ivec3_max(hi, centers[set->order[i]]);
+    }
+    IVector3 extent = ivec3_sub(hi, lo);
+    int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+    size_t half = count / 2;
+    std::nth_element(set->order + first, set->order + first + half, set->order + first + count,
+                     [&](uint32_t a, uint32_t b) { return _axis(centers[a], axis) < _axis(centers[b], axis); });
+
+    size_t left = set->node_count;
+    set->node_count += 2;
+    node->first = (int32_t)left;
+    node->count = 0;
+    _build_node(set, left, first, half, centers);
+    _build_node(set, left + 1, first + half, count - half, centers);
+}
+
+static float _bvh_cost(Instance_Set *set) {
+    float cost = 0.0f;
+    for (size_t i = 0; i < set->node_count; i++) cost += _box_area(&set->nodes[i]);
+    return cost;
+}
+
+static void _bvh_build(Instance_Set *set) {
+    free(set->nodes);
+    free(set->order);
+    set->nodes = NULL;
+    set->order = NULL;
+    set->node_count = 0;
+    set->built_cost = 0.0f;
+    if (set->count == 0) return;
+
+    set->nodes = (Instance_BVH_Node*)calloc(2 * set->count, sizeof(Instance_BVH_Node));
+    set->order = (uint32_t*)malloc(set->count * sizeof(uint32_t));
+    if (!set->nodes || !set->order) {
+        free(set->nodes);
+        free(set->order);
+        set->nodes = NULL;
+        set->order = NULL;
+        return;
+    }
+
+    // Centro em meias células (min + max) para ficar em inteiros
+    std::vector<IVector3> centers(set->count);
+    for (size_t i = 0; i < set->count; i++) {
+        IVector3 min, max;
+        _instance_box(&set->items[i], &min, &max);
+        centers[i] = ivec3_add(min, max);
+        set->order[i] = (uint32_t)i;
+    }
+    set->node_count = 1;
+    _build_node(set, 0, 0, set->count, centers);
+    set->built_cost = _bvh_cost(set);
+}
+
+// Os filhos sempre vêm depois do pai no array: de trás para frente, cada nó interno
+// encontra os filhos já ajustados
+static void _bvh_refit(Instance_Set *set) {
+    for (size_t i = set->node_count; i-- > 0;) {
+        Instance_BVH_Node *node = &set->nodes[i];
+        if (node->count > 0) _leaf_box(set, node);
+        else _node_union(node, &set->nodes[node->first], &set->nodes[node->first + 1]);
+    }
+}
+
+// Deixa a BVH em dia com as instâncias: reconstrói se alguma entrou ou saiu, senão só
+// reajusta as caixas das que se moveram (e reconstrói se o refit degradou demais).
+// Retorna true se o buffer da GPU está atrasado: a BVH mudou agora ou, numa consulta
+// anterior, sem instance_set_gpu_buffer depois.
+bool instance_set_update(Instance_Set *set) {
+    if (!set) return false;
+    if (!set->needs_build && !set->needs_refit) return set->gpu_dirty;
+
+    if (set->needs_build) {
+        _bvh_build(set);
+    } else {
+        _bvh_refit(set);
+        if (_bvh_cost(set) > set->built_cost * INSTANCE_BVH_REBUILD_RATIO) _bvh_build(set);
+    }
+    set->needs_build = false;
+    set->needs_refit = false;
+    set->gpu_dirty = true;
+    return true;
+}
+
+// --- CONSULTAS ---
+
+static bool _is_invalid(Voxel_Object voxel) {
+    return voxel.coord.y == _invalid_voxel().coord.y;
+}
+
+static bool _box_contains(const Instance_BVH_Node *node, IVector3 coord) {
+    return coord.x >= node->min[0] && coord.x < node->max[0]
+        && coord.y >= node->min[1] && coord.y < node->max[1]
+        && coord.z >= node->min[2] && coord.z < node->max[2];
+}
+
+// Índice da última instância com um voxel em 'coord' (a que vence), ou -1
+static long _find_instance(Instance_Set *set, IVector3 coord, Voxel_Object *found) {
+    instance_set_update(set);
+    if (set->node_count == 0) return -1;
+
+    long best = -1;
+    uint32_t stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Instance_BVH_Node *node = &set->nodes[stack[--top]];
+        if (!_box_contains(node, coord)) continue;
+        if (node->count == 0) {
+            stack[top++] = node->first;
+            stack[top++] = node->first + 1;
+            continue;
+        }
+        for (int k = 0; k < node->count; k++) {
+            uint32_t index = set->order[node->first + k];
+            if ((long)index <= best) continue;
+            Voxel_Instance *inst = &set->items[index];
+            Voxel_Object voxel = octree_find(inst->model, voxel_transform_local_cell(&inst->transform, coord));
+            if (_is_invalid(voxel)) continue;
+            best = (long)index;
+            if (found) {
+                *found = voxel;
+                found->coord = coord;
+            }
+        }
+    }
+    return best;
+}
+
+Voxel_Object instance_set_find(Instance_Set *set, IVector3 coord) {
+    Voxel_Object voxel = _invalid_voxel();
+    if (set) _find_instance(set, coord, &voxel);
+    return voxel;
+}
+
+// Recorta o raio contra a caixa [lo, hi) (slabs, como na grade densa)
+static bool _ray_box(Ray ray, const int32_t lo[3], const int32_t hi[3], float *t_enter) {
+    float o[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+    float d[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+
+    float enter = -1e30f, exit = 1e30f;
+    for (int a = 0; a < 3; a++) {
+        if (fabsf(d[a]) < 1e-8f) {
+            if (o[a] < lo[a] || o[a] >= hi[a]) return false;
+            continue;
+        }
+        float t0 = ((float)lo[a] - o[a]) / d[a];
+        float t1 = ((float)hi[a] - o[a]) / d[a];
+        if (t0 > t1) { float tmp = t0; t0 = t1; t1 = tmp; }
+        if (t0 > enter) enter = t0;
+        if (t1 < exit) exit = t1;
+    }
+    if (enter < 0.0f) enter = 0.0f;
+    if (exit < enter) return false;
+    *t_enter = enter;
+    return true;
+}
+
+static bool _ray_cell(Ray ray, IVector3 min, IVector3 max, float *t_enter) {
+    int32_t lo[3] = {min.x, min.y, min.z}, hi[3] = {max.x, max.y, max.z};
+    return _ray_box(ray, lo, hi, t_enter);
+}
+
+typedef struct {
+    Ray ray;
+    float best;
+    long best_index;
+    Voxel_Object hit;
+} Instance_Ray;
+
+// Percorre a octree do modelo com o raio em coordenadas locais
+static void _ray_instance(Instance_Set *set, uint32_t index, Instance_Ray *query) {
+    Voxel_Instance *inst = &set->items[index];
+    IVector3 min, max;
+    float t_enter;
+    _instance_box(inst, &min, &max);
+    if (!_ray_cell(query->ray, min, max, &t_enter) || t_enter > query->best) return;
+
+    // Começa logo depois da face de entrada (o mesmo empurrão do shader)
+    Ray world = query->ray;
+    if (t_enter > 0.0f) world.origin = vec3_add(world.origin, vec3_scalar_mul(world.direction, t_enter + 0.001f));
+    Ray local = voxel_transform_local_ray(&inst->transform, world);
+
+    Voxel_Object voxel;
+    if (!octree_ray_cast_voxel(inst->model, local, vec3_ivec3(inst->model->left_bot_back),
+                               vec3_ivec3(inst->model->right_top_front), &voxel)) return;
+    voxel.coord = voxel_transform_cell(&inst->transform, voxel.coord);
+
+    float t_cell;
+    if (!_ray_cell(query->ray, voxel.coord, ivec3_scalar_add(voxel.coord, 1), &t_cell)) t_cell = t_enter;
+
+    // Empate: a instância posterior vence, como em instance_set_find
+    if (t_cell > query->best || (t_cell == query->best && (long)index < query->best_index)) return;
+    query->best = t_cell;
+    query->best_index = (long)index;
+    query->hit = voxel;
+}
+
+// Acerto mais próximo entre as instâncias: desce a BVH pelo filho mais próximo primeiro
+// e descarta nós que começam depois do melhor acerto. É a referência da travessia do
+// shader, sobre os mesmos nós.
+bool instance_set_ray_cast(Instance_Set *set, Ray ray, Voxel_Object *hit, float *distance) {
+    if (!set) return false;
+    instance_set_update(set);
+    if (set->node_count == 0) return false;
+
+    Instance_Ray query = {ray, 1e30f, -1, _invalid_voxel()};
+    uint32_t stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Instance_BVH_Node *node = &set->nodes[stack[--top]];
+        float t_enter;
+        if (!_ray_box(ray, node->min, node->max, &t_enter) || t_enter > query.best) continue;
+
+        if (node->count > 0) {
+            for (int k = 0; k < node->count; k++) _ray_instance(set, set->order[node->first + k], &query);
+            continue;
+        }
+
+        uint32_t near = node->first, far = node->first + 1;
+        float t_near, t_far;
+        bool hit_near = _ray_box(ray, set->nodes[near].min, set->nodes[near].max, &t_near);
+        bool hit_far = _ray_box(ray, set->nodes[far].min, set->nodes[far].max, &t_far);
+        if (hit_near && hit_far) {
+            if (t_far < t_near) std::swap(near, far);
+            stack[top++] = far;
+            stack[top++] = near;
+        } else if (hit_near || hit_far) {
+            stack[top++] = hit_near ? near : far;
+        }
+    }
+
+    if (query.best_index < 0) return false;
+    if (hit) *hit = query.hit;
+    if (distance) *distance = query.best;
+    return true;
+}
+
+typedef struct {
+    void (*fn)(void *user, Voxel_Object voxel);
+    void *user;
+    const Voxel_Transform *transform;
+} Instance_Visit;
+
+static void _visit_transformed(void *user, Voxel_Object voxel) {
+    Instance_Visit *visit = (Instance_Visit*)user;
+    voxel.coord = voxel_transform_cell(visit->transform, voxel.coord);
+    visit->fn(visit->user, voxel);
+}
+
+static void _for_each_instance(Voxel_Instance *inst, void (*fn)(void *user, Voxel_Object voxel), void *user) {
+    Instance_Visit visit = {fn, user, &inst->transform};
+    octree_for_each(inst->model, _visit_transformed, &visit);
+}
+
+// Tira da lista a instância que vence em 'coord' e entrega os voxels dela (em coordenadas
+// do mundo) a 'fn'. É o copy-on-write do nível de cima: quem edita uma instância recebe
+// uma cópia própria dela. Retorna false se nenhuma instância tem voxel em 'coord'.
+bool instance_set_detach(Instance_Set *set, IVector3 coord, void (*fn)(void *user, Voxel_Object voxel), void *user) {
+    if (!set) return false;
+    long index = _find_instance(set, coord, NULL);
+    if (index < 0) return false;
+
+    Voxel_Instance inst = set->items[index];
+    memmove(&set->items[index], &set->items[index + 1], (set->count - index - 1) * sizeof(Voxel_Instance));
+    set->count--;
+    set->needs_build = true;
+
+    if (fn) _for_each_instance(&inst, fn, user);
+    octree_delete(inst.model);
+    return true;
+}
+
+// Na ordem em que foram adicionadas (inserir em sequência mantém "a última vence")
+void instance_set_for_each(Instance_Set *set, void (*fn)(void *user, Voxel_Object voxel), void *user) {
+    if (!set || !fn) return;
+    for (size_t i = 0; i < set->count; i++) _for_each_instance(&set->items[i], fn, user);
+}
+
+// --- GPU ---
+
+// Acrescenta a octree de cada modelo (uma vez por modelo) depois dos texels que já estão
+// em 'texture', e guarda em gpu_root onde ficou a raiz. 'texture' é realocada.
+// Uma textura vazia ganha antes um nó raiz sem filhos, para o shader não ler um modelo
+// como se fosse o mundo.
+bool instance_set_append_texture(Instance_Set *set, uint8_t **texture, size_t *arr_size) {
+    if (!set || !texture || !arr_size) return false;
+
+    std::unordered_map<Octree*, int32_t> roots;
+    std::vector<Octree*> models;
+    size_t extra = (*arr_size == 0) ? 1 : 0;
+    size_t base = *arr_size / 4 + extra;
+    size_t total = base;
+    for (size_t i = 0; i < set->count; i++) {
+        Octree *model = set->items[i].model;
+        if (roots.count(model)) continue;
+
+        size_t texels = _octree_texel_size(model);
+        if (texels == 0 || total + texels > TEXTURE_MAX_TEXELS) {
+            if (texels > 0) fprintf(stderr, "Instancias: textura cheia, modelo fica fora da GPU\n");
+            roots[model] = -1;
+            continue;
+        }
+        roots[model] = (int32_t)total;
+        models.push_back(model);
+        total += texels;
+    }
+
+    uint8_t *grown = (uint8_t*)realloc(*texture, total * 4);
+    if (!grown) return false;
+    memset(grown + *arr_size, 0, total * 4 - *arr_size);
+    for (Octree *model : models) octree_texture_write(model, grown, (size_t)roots[model]);
+
+    for (size_t i = 0; i < set->count; i++) set->items[i].gpu_root = roots[set->items[i].model];
+    set->gpu_dirty = true;
+    *texture = grown;
+    *arr_size = total * 4;
+    return true;
+}
+
+// Buffer achatado da BVH para o shader (SSBO de ivec4, std430):
+//   [0]                 nós, início das instâncias, instâncias, 0
+//   [1 + 2n], [2 + 2n]  nó n (Instance_BVH_Node)
+//   [inicio + 5k ...]   instância k na ordem das folhas: 3 linhas mundo -> local
+//                       (rotação transposta e translação em w), caixa da raiz do
+//                       modelo (mínimo + texel da raiz, máximo + flags)
+// Os texels das raízes são os da última instance_set_append_texture.
+int32_t *instance_set_gpu_buffer(Instance_Set *set, size_t *arr_size) {
+    if (!arr_size) return NULL;
+    if (set) instance_set_update(set);
+
+    size_t node_count = set ? set->node_count : 0;
+    size_t item_count = node_count ? set->count : 0;
+    size_t items_start = 1 + 2 * node_count;
+    size_t vec_count = items_start + 5 * item_count;
+
+    int32_t *buffer = (int32_t*)calloc(vec_count * 4, sizeof(int32_t));
+    if (!buffer) return NULL;
+    *arr_size = vec_count * 4 * sizeof(int32_t);
+
+    if (set) set->gpu_dirty = false;
+
+    buffer[0] = (int32_t)node_count;
+    buffer[1] = (int32_t)items_start;
+    buffer[2] = (int32_t)item_count;
+    if (node_count) memcpy(buffer + 4, set->nodes, node_count * sizeof(Instance_BVH_Node));
+
+    for (size_t k = 0; k < item_count; k++) {
+        Voxel_Instance *inst = &set->items[set->order[k]];
+        int32_t *out = buffer + (items_start + 5 * k) * 4;
+        const int (*r)[3] = inst->transform.rot;
+        IVector3 t = inst->transform.translation;
+        for (int row = 0; row < 3; row++) {
+            // local = R^T (p - T)
+            out[row * 4 + 0] = r[0][row];
+            out[row * 4 + 1] = r[1][row];
+            out[row * 4 + 2] = r[2][row];
+            out[row * 4 + 3] = -(r[0][row] * t.x + r[1][row] * t.y + r[2][row] * t.z);
+        }
+        Octree *model = inst->model;
+        bool leaf = !model->children && !model->instance;
+        out[12] = model->left_bot_back.x;
+        out[13] = model->left_bot_back.y;
+        out[14] = model->left_bot_back.z;
+        out[15] = inst->gpu_root;
+        out[16] = model->right_top_front.x;
+        out[17] = model->right_top_front.y;
+        out[18] = model->right_top_front.z;
+        out[19] = (leaf ? GPU_ROOT_LEAF : 0) | (leaf && model->is_point ? GPU_ROOT_POINT : 0);
+    }
+    return buffer;
+}
+
+// Cada modelo conta uma vez, não importa quantas instâncias o usem
+size_t instance_set_memory_usage(Instance_Set *set) {
+    if (!set) return 0;
+    size_t total = sizeof(Instance_Set) + set->capacity * sizeof(Voxel_Instance);
+    total += set->count ? 2 * set->count * sizeof(Instance_BVH_Node) + set->count * sizeof(uint32_t) : 0;
+    std::unordered_set<Octree*> models;
+    for (size_t i = 0; i < set->count; i++) {
+        if (models.insert(set->items[i].model).second) total += octree_memory_usage(set->items[i].model);
+    }
+    return total;
+}
+
+void instance_set_delete(Instance_Set *set) {
+    if (!set) return;
+    for (size_t i = 0; i < set->count; i++) octree_delete(set->items[i].model);
+    free(set->items);
+    free(set->nodes);
+    free(set->order);
+    free(set);
+}
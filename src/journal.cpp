@@ -0,0 +1,505 @@
+extern "C" {
+    #include <vmm/ivec3.h>
+}
+#include <iostream>
+#include <journal.hpp>
+#include <svoFile.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <algorithm>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+#define CHECKSUM_SEED 0xcbf29ce484222325ull
+// Um grupo maior que isso só pode ser lixo de uma escrita cortada
+#define GROUP_MAX_RECORDS (1u << 24)
+
+// Conteúdo de um JOURNAL_REGION esperando a thread de escrita
+typedef struct _region_image {
+    uint32_t id;
+    uint8_t *image;             //svo_file_encode
+    size_t size;
+} Region_Image;
+
+struct _journal {
+    std::string path, sealed_path, snapshot_path, region_dir;
+    FILE *fp;
+    double sync_ms;
+    size_t sync_bytes, checkpoint_bytes;
+    size_t next_checkpoint;     //tamanho do diário que dispara o próximo checkpoint
+
+    std::mutex mutex;
+    std::condition_variable wake, synced;
+    std::vector<Journal_Record> pending;
+    std::vector<Region_Image> pending_regions;
+    uint32_t next_region;       //0 fica para "caixa vazia"
+    uint64_t queued, durable;   //registros enfileirados / já no disco
+    bool flush, stop, checkpointing;
+    std::thread writer, checkpointer;
+    Journal_Stats stats;
+};
+
+static double _now_ms(void) {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+static bool _sync(FILE *fp) {
+    if (fflush(fp) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(fp)) == 0;
+#else
+    return fsync(fileno(fp)) == 0;
+#endif
+}
+
+// --- LEITURA ---
+
+typedef void (*Record_Fn)(void *user, const Journal_Record *record);
+
+// Aplica os grupos íntegros de 'path' em ordem. 'valid_end' recebe onde termina o último
+// grupo íntegro (o resto é uma escrita cortada). Retorna o número de registros aplicados.
+static size_t _read_journal(const char *path, Record_Fn fn, void *user, long *valid_end) {
+    if (valid_end) *valid_end = 0;
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return 0;
+
+    size_t applied = 0;
+    std::vector<Journal_Record> records;
+    Journal_Group group;
+    while (fread(&group, sizeof(group), 1, fp) == 1) {
+        if (group.magic != JOURNAL_MAGIC || group.count == 0 || group.count > GROUP_MAX_RECORDS) break;
+        records.resize(group.count);
+        if (fread(records.data(), sizeof(Journal_Record), group.count, fp) != group.count) break;
+        size_t bytes = group.count * sizeof(Journal_Record);
+        if (svo_file_checksum(CHECKSUM_SEED, (const uint8_t*)records.data(), bytes) != group.checksum) break;
+
+        for (const Journal_Record &record : records) fn(user, &record);
+        applied += group.count;
+        if (valid_end) *valid_end = ftell(fp);
+    }
+    fclose(fp);
+    return applied;
+}
+
+static Voxel_Object _record_voxel(const Journal_Record *record) {
+    Voxel voxel = {record->refraction, record->illumination, record->k};
+    return VoxelObjCreate(voxel, record->color, {{record->coord[0], record->coord[1], record->coord[2]}});
+}
+
+static std::string _region_path(const std::string &region_dir, uint32_t id) {
+    return region_dir + "/" + std::to_string(id) + ".svo";
+}
+
+static Octree *_load_region(const std::string &region_dir, uint32_t id) {
+    Svo_Map *map = svo_map_open(_region_path(region_dir, id).c_str(), true);
+    Octree *content = svo_map_to_octree(map);
+    svo_map_delete(map);
+    return content;
+}
+
+// Onde os registros são reaplicados: o mundo (recuperação) ou a octree do snapshot
+// (checkpoint). 'regions' junta os arquivos de região lidos.
+typedef struct _replay_target {
+    World *world;
+    Octree *tree;
+    std::string region_dir;
+    std::vector<uint32_t> regions;
+} Replay_Target;
+
+static void _apply(void *user, const Journal_Record *record) {
+    Replay_Target *target = (Replay_Target*)user;
+    IVector3 coord = {{record->coord[0], record->coord[1], record->coord[2]}};
+    IVector3 max = {{record->max[0], record->max[1], record->max[2]}};
+    if (record->op == JOURNAL_INSERT) {
+        if (target->world) world_insert(target->world, _record_voxel(record));
+        else octree_insert(target->tree, _record_voxel(record));
+    } else if (record->op == JOURNAL_REMOVE) {
+        if (target->world) world_remove(target->world, coord);
+        else octree_remove(target->tree, coord);
+    } else if (record->op == JOURNAL_FILL) {
+        if (target->world) world_fill(target->world, coord, max, _record_voxel(record));
+        else octree_fill(target->tree, coord, max, _record_voxel(record));
+    } else if (record->op == JOURNAL_REGION) {
+        Octree *content = NULL;
+        if (record->region) {
+            target->regions.push_back(record->region);
+            content = _load_region(target->region_dir, record->region);
+            if (!content) {
+                std::cerr << "Diário: região " << _region_path(target->region_dir, record->region) << " ilegível" << std::endl;
+                return;
+            }
+        }
+        Voxel_Transform transform = voxel_transform_translation(coord);
+        if (target->world) {
+            world_clear_region(target->world, coord, max);
+            if (content) world_paste(target->world, content, transform);
+        } else {
+            octree_clear(target->tree, coord, max);
+            if (content) octree_paste(target->tree, content, &transform, content->left_bot_back,
+                                      ivec3_scalar_add(content->right_top_front, -1));
+        }
+        octree_delete(content);
+    }
+}
+
+static void _collect_region(void *user, const Journal_Record *record) {
+    if (record->op == JOURNAL_REGION && record->region) ((std::vector<uint32_t>*)user)->push_back(record->region);
+}
+
+// Reaplica no mundo (já com o snapshot carregado, ver world_load_svo) o diário fechado
+// que não chegou a entrar num checkpoint e depois o aberto. Reaplicar um registro que o
+// snapshot já tem não muda nada: cada registro define a célula inteira.
+size_t journal_replay(World *world, const char *path) {
+    if (!world || !path) return 0;
+    double t0 = _now_ms();
+    std::string sealed = std::string(path) + ".1";
+    Replay_Target target;
+    target.world = world;
+    target.tree = NULL;
+    target.region_dir = std::string(path) + ".regions";
+    size_t applied = _read_journal(sealed.c_str(), _apply, &target, NULL);
+    applied += _read_journal(path, _apply, &target, NULL);
+    world_compact(world, 0);
+    if (applied > 0) {
+        std::cout << "Diário: " << applied << " edições reaplicadas em " << (_now_ms() - t0) << " ms" << std::endl;
+    }
+    return applied;
+}
+
+// --- CHECKPOINT ---
+
+// Snapshot novo = snapshot atual + diário fechado. Só depois de o snapshot estar no disco
+// o diário fechado e as regiões dele são apagados.
+static bool _checkpoint(const Journal *journal) {
+    Svo_Map *map = svo_map_open(journal->snapshot_path.c_str(), true);
+    Octree *tree = svo_map_to_octree(map);
+    svo_map_delete(map);
+    if (!tree) return false;
+
+    Replay_Target target;
+    target.world = NULL;
+    target.tree = tree;
+    target.region_dir = journal->region_dir;
+    _read_journal(journal->sealed_path.c_str(), _apply, &target, NULL);
+    octree_compact(tree, 0);
+    bool ok = svo_file_write(journal->snapshot_path.c_str(), tree);
+    octree_delete(tree);
+    if (!ok) return false;
+    remove(journal->sealed_path.c_str());
+    for (uint32_t id : target.regions) remove(_region_path(journal->region_dir, id).c_str());
+    return true;
+}
+
+static void _checkpoint_thread(Journal *journal) {
+    double t0 = _now_ms();
+    bool ok = _checkpoint(journal);
+    double ms = _now_ms() - t0;
+
+    std::lock_guard<std::mutex> lock(journal->mutex);
+    journal->checkpointing = false;
+    if (ok) {
+        journal->stats.checkpoints++;
+        journal->stats.checkpoint_ms = ms;
+    } else {
+        std::cerr << "Diário: checkpoint em " << journal->snapshot_path << " falhou" << std::endl;
+    }
+}
+
+// Fecha o diário atual como '.1' e começa um novo; o checkpoint roda na sua thread.
+// Chamado pela thread de escrita com o mutex preso.
+static void _rotate(Journal *journal) {
+    std::error_code ec;
+    bool sealed_exists = std::filesystem::exists(journal->sealed_path, ec);
+    if (!sealed_exists) {
+        fclose(journal->fp);
+        journal->fp = NULL;
+        if (rename(journal->path.c_str(), journal->sealed_path.c_str()) == 0) {
+            journal->stats.journal_bytes = 0;
+            sealed_exists = true;
+        }
+        journal->fp = fopen(journal->path.c_str(), "ab");
+    }
+    // Com um '.1' antigo (checkpoint que falhou), tenta de novo antes de fechar outro
+    journal->next_checkpoint = journal->stats.journal_bytes + journal->checkpoint_bytes;
+    if (!sealed_exists) return;
+    if (journal->checkpointer.joinable()) journal->checkpointer.join();
+    journal->checkpointing = true;
+    journal->checkpointer = std::thread(_checkpoint_thread, journal);
+}
+
+// --- ESCRITA ---
+
+// Descarta o que uma escrita que falhou deixou depois do último grupo íntegro ('good_end')
+static void _truncate(Journal *journal, size_t good_end) {
+    if (journal->fp) fclose(journal->fp);
+    std::error_code ec;
+    std::filesystem::resize_file(journal->path, (uintmax_t)good_end, ec);
+    journal->fp = fopen(journal->path.c_str(), "ab");
+}
+
+// Commit em grupo: tudo que chegou desde a última passada vai num write e num fsync, a cada
+// sync_ms ou assim que passar de sync_bytes. A thread do jogo só empilha registros.
+// Se uma região ou o grupo não chega ao disco, o arquivo volta ao fim do último grupo
+// íntegro, 'durable' não anda e o grupo volta para a frente da fila (nova tentativa depois
+// de sync_ms); quem espera em journal_flush é avisado do erro.
+static void _writer_thread(Journal *journal) {
+    std::unique_lock<std::mutex> lock(journal->mutex);
+    std::vector<Journal_Record> group;
+    std::vector<Region_Image> regions;
+    bool failed = false;
+    while (true) {
+        journal->wake.wait_for(lock, std::chrono::duration<double, std::milli>(journal->sync_ms), [journal, failed] {
+            return journal->stop || (!failed && (journal->flush
+                || journal->pending.size() * sizeof(Journal_Record) >= journal->sync_bytes));
+        });
+        journal->flush = false;
+        if (journal->pending.empty()) {
+            if (journal->stop) break;
+            continue;
+        }
+        group.clear();
+        group.swap(journal->pending);
+        regions.clear();
+        regions.swap(journal->pending_regions);
+        uint64_t target = journal->queued;
+        size_t good_end = journal->stats.journal_bytes;
+        lock.unlock();
+
+        // As regiões vão para o disco antes do grupo que as usa; sem elas o grupo não entra
+        bool ok = true;
+        for (const Region_Image &region : regions) {
+            if (!svo_file_write_image(_region_path(journal->region_dir, region.id).c_str(), region.image, region.size)) {
+                std::cerr << "Diário: falha ao gravar a região " << region.id << std::endl;
+                ok = false;
+                break;
+            }
+        }
+
+        size_t bytes = group.size() * sizeof(Journal_Record);
+        Journal_Group header = {JOURNAL_MAGIC, (uint32_t)group.size(),
+                                svo_file_checksum(CHECKSUM_SEED, (const uint8_t*)group.data(), bytes)};
+        if (ok) {
+            ok = journal->fp && fwrite(&header, sizeof(header), 1, journal->fp) == 1
+              && fwrite(group.data(), bytes, 1, journal->fp) == 1 && _sync(journal->fp);
+            if (!ok) std::cerr << "Diário: falha ao gravar " << journal->path << std::endl;
+        }
+        if (!ok) _truncate(journal, good_end);
+
+        lock.lock();
+        failed = !ok;
+        if (ok) {
+            for (const Region_Image &region : regions) free(region.image);
+            journal->durable = target;
+            journal->stats.records += group.size();
+            journal->stats.groups++;
+            journal->stats.syncs++;
+            journal->stats.journal_bytes += sizeof(header) + bytes;
+        } else {
+            journal->stats.errors++;
+            // Na frente do que chegou enquanto isso, para a ordem das edições não mudar
+            group.insert(group.end(), journal->pending.begin(), journal->pending.end());
+            journal->pending.swap(group);
+            regions.insert(regions.end(), journal->pending_regions.begin(), journal->pending_regions.end());
+            journal->pending_regions.swap(regions);
+        }
+        journal->synced.notify_all();
+        if (failed && journal->stop) {
+            std::cerr << "Diário: " << journal->pending.size() << " edições não foram gravadas" << std::endl;
+            break;
+        }
+        if (ok && !journal->checkpointing && journal->stats.journal_bytes >= journal->next_checkpoint) _rotate(journal);
+    }
+}
+
+// Começa a gravar as edições de 'world' (já recuperado com journal_replay). Sem snapshot,
+// grava um agora: é a base dos checkpoints. sync_ms/sync_bytes: limite de edições que uma
+// queda pode perder; checkpoint_bytes: tamanho do diário que dispara um checkpoint (e
+// limita o tempo de recuperação).
+Journal *journal_open(World *world, const char *path, const char *snapshot_path,
+                      double sync_ms, size_t sync_bytes, size_t checkpoint_bytes) {
+    if (!world || !path || !snapshot_path) return NULL;
+    std::error_code ec;
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+    parent = std::filesystem::path(snapshot_path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+
+    if (!std::filesystem::exists(snapshot_path, ec) && !world_save_svo(world, snapshot_path)) {
+        std::cerr << "Diário: não foi possível gravar o snapshot " << snapshot_path << std::endl;
+        return NULL;
+    }
+
+    // Corta a cauda de uma escrita interrompida para os grupos novos virem logo depois
+    // dos íntegros
+    long valid_end = 0;
+    std::vector<uint32_t> used;
+    std::string sealed_path = std::string(path) + ".1";
+    _read_journal(sealed_path.c_str(), _collect_region, &used, NULL);
+    if (std::filesystem::exists(path, ec)) {
+        _read_journal(path, _collect_region, &used, &valid_end);
+        std::filesystem::resize_file(path, (uintmax_t)valid_end, ec);
+    }
+
+    // Regiões que nenhum diário usa (checkpoint interrompido, grupo cortado) saem
+    std::string region_dir = std::string(path) + ".regions";
+    std::filesystem::create_directories(region_dir, ec);
+    uint32_t next_region = 1;
+    for (uint32_t id : used) next_region = id >= next_region ? id + 1 : next_region;
+    for (const auto &entry : std::filesystem::directory_iterator(region_dir, ec)) {
+        unsigned long id = strtoul(entry.path().stem().string().c_str(), NULL, 10);
+        bool referenced = entry.path().extension() == ".svo" && std::find(used.begin(), used.end(), id) != used.end();
+        if (!referenced) std::filesystem::remove(entry.path(), ec);
+    }
+    FILE *fp = fopen(path, "ab");
+    if (!fp) return NULL;
+
+    Journal *journal = new Journal();
+    journal->path = path;
+    journal->sealed_path = sealed_path;
+    journal->snapshot_path = snapshot_path;
+    journal->region_dir = region_dir;
+    journal->next_region = next_region;
+    journal->fp = fp;
+    journal->sync_ms = sync_ms > 0.0 ? sync_ms : JOURNAL_SYNC_MS;
+    journal->sync_bytes = sync_bytes ? sync_bytes : JOURNAL_SYNC_BYTES;
+    journal->checkpoint_bytes = checkpoint_bytes ? checkpoint_bytes : JOURNAL_CHECKPOINT_BYTES;
+    journal->queued = journal->durable = 0;
+    journal->flush = journal->stop = journal->checkpointing = false;
+    journal->stats = {};
+    journal->stats.journal_bytes = (size_t)valid_end;
+    journal->next_checkpoint = journal->checkpoint_bytes;
+
+    // Um '.1' que sobrou de uma queda entra no snapshot agora, em segundo plano
+    if (std::filesystem::exists(journal->sealed_path, ec)) {
+        std::lock_guard<std::mutex> lock(journal->mutex);
+        _rotate(journal);
+    }
+    journal->writer = std::thread(_writer_thread, journal);
+    return journal;
+}
+
+// Com o mutex preso
+static void _push_locked(Journal *journal, const Journal_Record *records, size_t count) {
+    journal->pending.insert(journal->pending.end(), records, records + count);
+    journal->queued += count;
+    if (journal->pending.size() * sizeof(Journal_Record) >= journal->sync_bytes) journal->wake.notify_one();
+}
+
+static void _push(Journal *journal, const Journal_Record *records, size_t count) {
+    std::lock_guard<std::mutex> lock(journal->mutex);
+    _push_locked(journal, records, count);
+}
+
+static Journal_Record _voxel_record(uint32_t op, IVector3 min, IVector3 max, Voxel_Object voxel) {
+    Journal_Record record = {{min.x, min.y, min.z}, op, {max.x, max.y, max.z}, 0, voxel.color,
+                             voxel.voxel.refraction, voxel.voxel.illumination, voxel.voxel.k};
+    return record;
+}
+
+static Journal_Record _insert_record(Voxel_Object voxel) {
+    return _voxel_record(JOURNAL_INSERT, voxel.coord, voxel.coord, voxel);
+}
+
+void journal_insert(Journal *journal, Voxel_Object voxel) {
+    if (!journal) return;
+    Journal_Record record = _insert_record(voxel);
+    _push(journal, &record, 1);
+}
+
+void journal_remove(Journal *journal, IVector3 coord) {
+    if (!journal) return;
+    Journal_Record record = _voxel_record(JOURNAL_REMOVE, coord, coord, _invalid_voxel());
+    _push(journal, &record, 1);
+}
+
+typedef struct _paste_records {
+    std::vector<Journal_Record> records;
+    Voxel_Transform transform;
+} Paste_Records;
+
+static void _paste_record(void *user, Voxel_Object voxel) {
+    Paste_Records *paste = (Paste_Records*)user;
+    voxel.coord = voxel_transform_cell(&paste->transform, voxel.coord);
+    paste->records.push_back(_insert_record(voxel));
+}
+
+// Um registro para a caixa inteira (ver world_fill)
+void journal_fill(Journal *journal, IVector3 vox_min, IVector3 vox_max, Voxel_Object voxel) {
+    if (!journal) return;
+    Journal_Record record = _voxel_record(JOURNAL_FILL, ivec3_min(vox_min, vox_max), ivec3_max(vox_min, vox_max), voxel);
+    _push(journal, &record, 1);
+}
+
+// A caixa [vox_min, vox_max] (inclusivos) passa a ser exatamente 'content' (octree com a
+// origem em vox_min, como a de world_copy_region), ar incluído. O conteúdo é serializado
+// aqui (svo_file_encode) e gravado pela thread de escrita antes do grupo do registro. Se
+// não couber num .svo, vai como a caixa vazia mais um registro por voxel.
+void journal_region(Journal *journal, IVector3 vox_min, IVector3 vox_max, Octree *content) {
+    if (!journal) return;
+    IVector3 min = ivec3_min(vox_min, vox_max), max = ivec3_max(vox_min, vox_max);
+    Paste_Records paste;
+    paste.records.push_back(_voxel_record(JOURNAL_REGION, min, max, _invalid_voxel()));
+    paste.transform = voxel_transform_translation(min);
+
+    uint8_t *image = NULL;
+    size_t size = 0;
+    if (content && (content->children || content->has_voxel || content->instance)) {
+        image = svo_file_encode(content, &size);
+        if (!image) octree_for_each(content, _paste_record, &paste);
+    }
+
+    std::lock_guard<std::mutex> lock(journal->mutex);
+    if (image) {
+        paste.records[0].region = journal->next_region++;
+        journal->pending_regions.push_back({paste.records[0].region, image, size});
+    }
+    _push_locked(journal, paste.records.data(), paste.records.size());
+}
+
+// Bloqueia até tudo que foi enfileirado estar no disco. Retorna false se uma escrita falhou
+// antes disso (as edições continuam na fila e a thread de escrita tenta de novo).
+bool journal_flush(Journal *journal) {
+    if (!journal) return false;
+    std::unique_lock<std::mutex> lock(journal->mutex);
+    uint64_t target = journal->queued;
+    size_t errors = journal->stats.errors;
+    journal->flush = true;
+    journal->wake.notify_one();
+    journal->synced.wait(lock, [journal, target, errors] {
+        return journal->durable >= target || journal->stats.errors != errors;
+    });
+    return journal->durable >= target;
+}
+
+Journal_Stats journal_stats(Journal *journal) {
+    if (!journal) return Journal_Stats{};
+    std::lock_guard<std::mutex> lock(journal->mutex);
+    return journal->stats;
+}
+
+// Grava o que falta e espera um checkpoint em andamento
+void journal_close(Journal *journal) {
+    if (!journal) return;
+    {
+        std::lock_guard<std::mutex> lock(journal->mutex);
+        journal->stop = true;
+        journal->wake.notify_one();
+    }
+    journal->writer.join();
+    if (journal->checkpointer.joinable()) journal->checkpointer.join();
+    for (const Region_Image &region : journal->pending_regions) free(region.image);
+    if (journal->fp) fclose(journal->fp);
+    delete journal;
+}
@@ -0,0 +1,484 @@
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+}
+#include <lightTree.hpp>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+#define SLOTS_INITIAL_CAPACITY 64
+// Depois desta profundidade a divisão é sempre no meio (o caminho de cada folha cabe em 64 bits)
+#define LIGHT_TREE_MEDIAN_DEPTH 48
+
+static const IVector3 FACE_NORMALS[6] = {
+    {{1, 0, 0}}, {{-1, 0, 0}}, {{0, 1, 0}}, {{0, -1, 0}}, {{0, 0, 1}}, {{0, 0, -1}}
+};
+
+static float _luminance(Vector3 c) {
+    return 0.2126f * c.x + 0.7152f * c.y + 0.0722f * c.z;
+}
+
+static float _safe_sqrt(float x) {
+    return sqrtf(std::max(0.0f, x));
+}
+
+// --- Tabela coordenada -> fonte ---
+
+static size_t _hash(IVector3 c) {
+    return (size_t)(((uint32_t)c.x * 73856093u) ^ ((uint32_t)c.y * 19349663u) ^ ((uint32_t)c.z * 83492791u));
+}
+
+static bool _same(IVector3 a, IVector3 b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+// Slot da coordenada ou o slot livre onde ela entraria
+static size_t _slot(const Light_Tree *tree, IVector3 coord) {
+    size_t mask = tree->slot_capacity - 1, i = _hash(coord) & mask;
+    while (tree->slots[i] >= 0 && !_same(tree->lights[tree->slots[i]].coord, coord)) i = (i + 1) & mask;
+    return i;
+}
+
+static bool _rehash(Light_Tree *tree, size_t capacity) {
+    int32_t *slots = (int32_t*)malloc(capacity * sizeof(int32_t));
+    if (!slots) return false;
+    for (size_t i = 0; i < capacity; i++) slots[i] = -1;
+    free(tree->slots);
+    tree->slots = slots;
+    tree->slot_capacity = capacity;
+    for (size_t l = 0; l < tree->count; l++) tree->slots[_slot(tree, tree->lights[l].coord)] = (int32_t)l;
+    return true;
+}
+
+// Tira o slot sem deixar buraco: puxa para trás quem estava depois dele na sequência
+static void _erase_slot(Light_Tree *tree, size_t i) {
+    size_t mask = tree->slot_capacity - 1;
+    tree->slots[i] = -1;
+    for (size_t j = (i + 1) & mask; tree->slots[j] >= 0; j = (j + 1) & mask) {
+        size_t home = _hash(tree->lights[tree->slots[j]].coord) & mask;
+        // j pode ir para i se o lugar dele (home) não estiver em (i, j]
+        bool movable = i <= j ? (home <= i || home > j) : (home <= i && home > j);
+        if (!movable) continue;
+        tree->slots[i] = tree->slots[j];
+        tree->slots[j] = -1;
+        i = j;
+    }
+}
+
+// --- Caixas com cone ---
+
+static float _angle_between(Vector3 a, Vector3 b) {
+    if (vec3_dot(a, b) < 0.0f) return (float)M_PI - 2.0f * asinf(std::min(1.0f, vec3_len(vec3_add(a, b)) / 2.0f));
+    return 2.0f * asinf(std::min(1.0f, vec3_len(vec3_sub(b, a)) / 2.0f));
+}
+
+// 'v' girado de 'angle' em volta do eixo unitário 'axis' (Rodrigues)
+static Vector3 _rotate(Vector3 v, Vector3 axis, float angle) {
+    float c = cosf(angle), s = sinf(angle);
+    Vector3 r = vec3_add(vec3_scalar_mul(v, c), vec3_scalar_mul(vec3_cross(axis, v), s));
+    return vec3_add(r, vec3_scalar_mul(axis, vec3_dot(axis, v) * (1.0f - c)));
+}
+
+// Menor cone com os dois (Pharr et al., PBRT 4ª ed., DirectionCone::Union)
+static void _cone_union(Vector3 wa, float cos_a, Vector3 wb, float cos_b, Vector3 *w, float *cos_o) {
+    float theta_a = acosf(std::max(-1.0f, std::min(1.0f, cos_a)));
+    float theta_b = acosf(std::max(-1.0f, std::min(1.0f, cos_b)));
+    float theta_d = _angle_between(wa, wb);
+    if (std::min(theta_d + theta_b, (float)M_PI) <= theta_a) {
+        *w = wa;
+        *cos_o = cos_a;
+        return;
+    }
+    if (std::min(theta_d + theta_a, (float)M_PI) <= theta_b) {
+        *w = wb;
+        *cos_o = cos_b;
+        return;
+    }
+    float theta_o = (theta_a + theta_d + theta_b) / 2.0f;
+    Vector3 axis = vec3_cross(wa, wb);
+    if (theta_o >= (float)M_PI || vec3_dot(axis, axis) < 1e-12f) {
+        *w = wa;
+        *cos_o = -1.0f;
+        return;
+    }
+    *w = vec3_normalize(_rotate(wa, vec3_normalize(axis), theta_o - theta_a));
+    *cos_o = cosf(theta_o);
+}
+
+static Light_Bounds _bounds_union(const Light_Bounds &a, const Light_Bounds &b) {
+    if (a.phi <= 0.0f) return b;
+    if (b.phi <= 0.0f) return a;
+    Light_Bounds u;
+    u.min = vec3_min(a.min, b.min);
+    u.max = vec3_max(a.max, b.max);
+    u.phi = a.phi + b.phi;
+    _cone_union(a.w, a.cos_theta_o, b.w, b.cos_theta_o, &u.w, &u.cos_theta_o);
+    u.cos_theta_e = std::min(a.cos_theta_e, b.cos_theta_e);
+    return u;
+}
+
+// Uma fonte: a célula, a área das faces que emitem e o cone das normais delas
+static Light_Bounds _light_bounds(const Tree_Light *light) {
+    Light_Bounds b;
+    b.min = vec3_float((float)light->coord.x, (float)light->coord.y, (float)light->coord.z);
+    b.max = vec3_add(b.min, vec3_float(1.0f, 1.0f, 1.0f));
+    Vector3 sum = vec3_zero();
+    int faces = 0;
+    for (int face = 0; face < 6; face++) {
+        if (!(light->faces & (1 << face))) continue;
+        IVector3 n = FACE_NORMALS[face];
+        sum = vec3_add(sum, vec3_float((float)n.x, (float)n.y, (float)n.z));
+        faces++;
+    }
+    b.phi = _luminance(light->radiance) * (float)faces * (float)M_PI;
+    b.cos_theta_e = 0.0f;
+    if (vec3_len(sum) < 1e-4f) {
+        b.w = vec3_float(0.0f, 1.0f, 0.0f);
+        b.cos_theta_o = -1.0f;
+        return b;
+    }
+    b.w = vec3_normalize(sum);
+    b.cos_theta_o = 1.0f;
+    for (int face = 0; face < 6; face++) {
+        if (!(light->faces & (1 << face))) continue;
+        IVector3 n = FACE_NORMALS[face];
+        b.cos_theta_o = std::min(b.cos_theta_o, vec3_dot(b.w, vec3_float((float)n.x, (float)n.y, (float)n.z)));
+    }
+    return b;
+}
+
+// cos(max(0, a - b)) e sin(max(0, a - b)) a partir dos senos e cossenos
+static float _cos_sub_clamped(float sin_a, float cos_a, float sin_b, float cos_b) {
+    if (cos_a > cos_b) return 1.0f;
+    return cos_a * cos_b + sin_a * sin_b;
+}
+
+static float _sin_sub_clamped(float sin_a, float cos_a, float sin_b, float cos_b) {
+    if (cos_a > cos_b) return 0.0f;
+    return sin_a * cos_b - cos_a * sin_b;
+}
+
+// Quanto o nó pode iluminar o ponto 'p' de normal 'n' (n = 0: qualquer lado): a potência
+// sobre a distância² ao centro, vezes o cosseno do menor ângulo possível entre as normais
+// das fontes e a direção até 'p' e entre 'n' e a direção até as fontes (PBRT 4ª ed.,
+// CompactLightBounds::Importance, com o lado de 'n' respeitado: faces difusas não recebem
+// por trás)
+float light_bounds_importance(const Light_Bounds *b, Vector3 p, Vector3 n) {
+    if (!b || b->phi <= 0.0f) return 0.0f;
+    Vector3 center = vec3_scalar_mul(vec3_add(b->min, b->max), 0.5f);
+    Vector3 diagonal = vec3_sub(b->max, b->min);
+    Vector3 to_p = vec3_sub(p, center);
+    float d2 = std::max(vec3_dot(to_p, to_p), vec3_len(diagonal) / 2.0f);
+
+    // Direções que a caixa cobre vista de 'p'
+    float cos_b = -1.0f;
+    bool inside = p.x >= b->min.x && p.y >= b->min.y && p.z >= b->min.z && p.x <= b->max.x && p.y <= b->max.y && p.z <= b->max.z;
+    float radius2 = vec3_dot(diagonal, diagonal) / 4.0f, center2 = vec3_dot(to_p, to_p);
+    if (!inside && center2 > radius2) cos_b = _safe_sqrt(1.0f - radius2 / center2);
+    float sin_b = _safe_sqrt(1.0f - cos_b * cos_b);
+
+    Vector3 wi = center2 > 0.0f ? vec3_scalar_mul(to_p, 1.0f / sqrtf(center2)) : vec3_float(0.0f, 1.0f, 0.0f);
+    float cos_w = vec3_dot(b->w, wi), sin_w = _safe_sqrt(1.0f - cos_w * cos_w);
+    float sin_o = _safe_sqrt(1.0f - b->cos_theta_o * b->cos_theta_o);
+    float cos_x = _cos_sub_clamped(sin_w, cos_w, sin_o, b->cos_theta_o);
+    float sin_x = _sin_sub_clamped(sin_w, cos_w, sin_o, b->cos_theta_o);
+    float cos_p = _cos_sub_clamped(sin_x, cos_x, sin_b, cos_b);
+    if (cos_p <= b->cos_theta_e) return 0.0f;
+    float importance = b->phi * cos_p / d2;
+
+    if (n.x != 0.0f || n.y != 0.0f || n.z != 0.0f) {
+        float cos_i = -vec3_dot(wi, n), sin_i = _safe_sqrt(1.0f - cos_i * cos_i);
+        importance *= std::max(0.0f, _cos_sub_clamped(sin_i, cos_i, sin_b, cos_b));
+    }
+    return std::max(importance, 0.0f);
+}
+
+// --- Construção ---
+
+// Custo de superfície e orientação de um nó (PBRT 4ª ed., EvaluateCost)
+static float _cost(const Light_Bounds &b, int axis) {
+    float theta_o = acosf(std::max(-1.0f, std::min(1.0f, b.cos_theta_o)));
+    float theta_e = acosf(std::max(-1.0f, std::min(1.0f, b.cos_theta_e)));
+    float theta_w = std::min(theta_o + theta_e, (float)M_PI);
+    float sin_o = _safe_sqrt(1.0f - b.cos_theta_o * b.cos_theta_o);
+    float m_omega = 2.0f * (float)M_PI * (1.0f - b.cos_theta_o)
+                  + (float)M_PI / 2.0f * (2.0f * theta_w * sin_o - cosf(theta_o - 2.0f * theta_w) - 2.0f * theta_o * sin_o + b.cos_theta_o);
+    Vector3 d = vec3_sub(b.max, b.min);
+    float extent[3] = {d.x, d.y, d.z};
+    float kr = std::max(extent[0], std::max(extent[1], extent[2])) / std::max(extent[axis], 1e-6f);
+    float area = 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    return b.phi * m_omega * kr * area;
+}
+
+typedef struct _build_item {
+    Light_Bounds bounds;
+    Vector3 centroid;
+    int32_t light;
+} Build_Item;
+
+static float _axis(Vector3 v, int axis) {
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+static int32_t _push_node(Light_Tree *tree) {
+    if (tree->node_count == tree->node_capacity) {
+        size_t capacity = tree->node_capacity ? tree->node_capacity * 2 : 64;
+        Light_Tree_Node *nodes = (Light_Tree_Node*)realloc(tree->nodes, capacity * sizeof(Light_Tree_Node));
+        if (!nodes) return -1;
+        tree->nodes = nodes;
+        tree->node_capacity = capacity;
+    }
+    return (int32_t)tree->node_count++;
+}
+
+// Nó para items[first, last) em pré-ordem; false sem memória
+static bool _build(Light_Tree *tree, Build_Item *items, size_t first, size_t last, uint64_t trail, int depth) {
+    int32_t node = _push_node(tree);
+    if (node < 0) return false;
+    if (last - first == 1) {
+        tree->nodes[node].bounds = items[first].bounds;
+        tree->nodes[node].second = -1;
+        tree->nodes[node].light = items[first].light;
+        tree->lights[items[first].light].trail = trail;
+        return true;
+    }
+
+    Light_Bounds all = items[first].bounds;
+    Vector3 cmin = items[first].centroid, cmax = items[first].centroid;
+    for (size_t i = first + 1; i < last; i++) {
+        all = _bounds_union(all, items[i].bounds);
+        cmin = vec3_min(cmin, items[i].centroid);
+        cmax = vec3_max(cmax, items[i].centroid);
+    }
+
+    // Melhor divisão entre os baldes dos três eixos
+    float best_cost = INFINITY;
+    int best_axis = -1, best_bucket = 0;
+    for (int axis = 0; axis < 3 && depth < LIGHT_TREE_MEDIAN_DEPTH; axis++) {
+        float lo = _axis(cmin, axis), hi = _axis(cmax, axis);
+        if (hi <= lo) continue;
+        Light_Bounds buckets[LIGHT_TREE_BUCKETS];
+        for (int k = 0; k < LIGHT_TREE_BUCKETS; k++) buckets[k].phi = 0.0f;
+        for (size_t i = first; i < last; i++) {
+            int k = std::min(LIGHT_TREE_BUCKETS - 1, (int)(LIGHT_TREE_BUCKETS * (_axis(items[i].centroid, axis) - lo) / (hi - lo)));
+            buckets[k] = _bounds_union(buckets[k], items[i].bounds);
+        }
+        // Uniões de cima para baixo uma vez só; as de baixo vão crescendo no laço
+        Light_Bounds above[LIGHT_TREE_BUCKETS];
+        above[LIGHT_TREE_BUCKETS - 1] = buckets[LIGHT_TREE_BUCKETS - 1];
+        for (int k = LIGHT_TREE_BUCKETS - 2; k > 0; k--) above[k] = _bounds_union(buckets[k], above[k + 1]);
+        Light_Bounds below = buckets[0];
+        for (int split = 0; split < LIGHT_TREE_BUCKETS - 1; split++) {
+            if (split > 0) below = _bounds_union(below, buckets[split]);
+            if (below.phi <= 0.0f || above[split + 1].phi <= 0.0f) continue;
+            float cost = _cost(below, axis) + _cost(above[split + 1], axis);
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_bucket = split;
+            }
+        }
+    }
+
+    size_t middle;
+    if (best_axis >= 0) {
+        float lo = _axis(cmin, best_axis), hi = _axis(cmax, best_axis);
+        Build_Item *split = std::partition(items + first, items + last, [&](const Build_Item &item) {
+            int k = std::min(LIGHT_TREE_BUCKETS - 1, (int)(LIGHT_TREE_BUCKETS * (_axis(item.centroid, best_axis) - lo) / (hi - lo)));
+            return k <= best_bucket;
+        });
+        middle = (size_t)(split - items);
+    } else {
+        // Centros iguais (ou fundo demais): metade para cada lado pelo eixo mais longo
+        Vector3 extent = vec3_sub(cmax, cmin);
+        int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+        middle = (first + last) / 2;
+        std::nth_element(items + first, items + middle, items + last, [&](const Build_Item &a, const Build_Item &b) {
+            return _axis(a.centroid, axis) < _axis(b.centroid, axis);
+        });
+    }
+    if (middle == first || middle == last) middle = (first + last) / 2;
+
+    if (!_build(tree, items, first, middle, trail, depth + 1)) return false;
+    int32_t second = (int32_t)tree->node_count;
+    if (!_build(tree, items, middle, last, trail | (1ull << depth), depth + 1)) return false;
+    tree->nodes[node].bounds = all;
+    tree->nodes[node].second = second;
+    tree->nodes[node].light = -1;
+    return true;
+}
+
+static Light_Bounds _refit(Light_Tree *tree, int32_t node) {
+    Light_Tree_Node *n = &tree->nodes[node];
+    if (n->light >= 0) n->bounds = _light_bounds(&tree->lights[n->light]);
+    else n->bounds = _bounds_union(_refit(tree, node + 1), _refit(tree, n->second));
+    return tree->nodes[node].bounds;
+}
+
+// --- API ---
+
+Light_Tree *light_tree_create(void) {
+    Light_Tree *tree = (Light_Tree*)calloc(1, sizeof(Light_Tree));
+    if (!tree) return NULL;
+    if (!_rehash(tree, SLOTS_INITIAL_CAPACITY)) {
+        free(tree);
+        return NULL;
+    }
+    return tree;
+}
+
+// Fonte em 'coord' com a radiância de cada face e as faces que emitem; sem faces ou sem
+// radiância ela sai. true se mudou.
+bool light_tree_set(Light_Tree *tree, IVector3 coord, Vector3 radiance, uint8_t faces) {
+    if (!tree) return false;
+    faces &= 0x3F;
+    if (!faces || _luminance(radiance) <= 0.0f) return light_tree_remove(tree, coord);
+    size_t slot = _slot(tree, coord);
+    if (tree->slots[slot] >= 0) {
+        Tree_Light *light = &tree->lights[tree->slots[slot]];
+        if (light->faces == faces && light->radiance.x == radiance.x && light->radiance.y == radiance.y
+            && light->radiance.z == radiance.z) return false;
+        light->radiance = radiance;
+        light->faces = faces;
+        tree->needs_refit = true;
+        return true;
+    }
+
+    if (tree->count == tree->capacity) {
+        size_t capacity = tree->capacity ? tree->capacity * 2 : 64;
+        Tree_Light *lights = (Tree_Light*)realloc(tree->lights, capacity * sizeof(Tree_Light));
+        if (!lights) return false;
+        tree->lights = lights;
+        tree->capacity = capacity;
+    }
+    tree->lights[tree->count] = {coord, radiance, faces, 0};
+    tree->slots[slot] = (int32_t)tree->count++;
+    if (tree->count * 2 > tree->slot_capacity) _rehash(tree, tree->slot_capacity * 2);
+    tree->needs_build = true;
+    return true;
+}
+
+bool light_tree_remove(Light_Tree *tree, IVector3 coord) {
+    if (!tree) return false;
+    size_t slot = _slot(tree, coord);
+    int32_t index = tree->slots[slot];
+    if (index < 0) return false;
+    _erase_slot(tree, slot);
+
+    // A última fonte ocupa o lugar da que saiu
+    size_t last = tree->count - 1;
+    if ((size_t)index != last) {
+        tree->slots[_slot(tree, tree->lights[last].coord)] = index;
+        tree->lights[index] = tree->lights[last];
+    }
+    tree->count--;
+    tree->needs_build = true;
+    return true;
+}
+
+const Tree_Light *light_tree_find(const Light_Tree *tree, IVector3 coord) {
+    if (!tree) return NULL;
+    int32_t index = tree->slots[_slot(tree, coord)];
+    return index >= 0 ? &tree->lights[index] : NULL;
+}
+
+// Reconstrói a árvore se fontes entraram ou saíram, ou só reajusta caixas e potências se
+// mudaram de cor ou de faces; true se algo mudou
+bool light_tree_update(Light_Tree *tree) {
+    if (!tree) return false;
+    if (tree->needs_build) {
+        tree->node_count = 0;
+        tree->needs_build = tree->needs_refit = false;
+        if (!tree->count) return true;
+        std::vector<Build_Item> items(tree->count);
+        for (size_t i = 0; i < tree->count; i++) {
+            items[i].bounds = _light_bounds(&tree->lights[i]);
+            items[i].centroid = vec3_scalar_mul(vec3_add(items[i].bounds.min, items[i].bounds.max), 0.5f);
+            items[i].light = (int32_t)i;
+        }
+        if (!_build(tree, items.data(), 0, items.size(), 0, 0)) {
+            tree->node_count = 0;
+            tree->needs_build = true;
+        }
+        return true;
+    }
+    if (tree->needs_refit) {
+        tree->needs_refit = false;
+        if (tree->node_count) _refit(tree, 0);
+        return true;
+    }
+    return false;
+}
+
+static float _next_u(float u, float p) {
+    return std::min(u / p, 0.99999994f);
+}
+
+// Sorteia uma fonte para o ponto 'p' de normal 'n' descendo pela importância ('u' em
+// [0, 1)); 'pmf' = chance de ter saído esta. NULL se nenhuma pode iluminar o ponto ou a
+// árvore está por reconstruir (light_tree_update).
+const Tree_Light *light_tree_sample(const Light_Tree *tree, Vector3 p, Vector3 n, float u, float *pmf) {
+    if (!tree || tree->needs_build || !tree->node_count) return NULL;
+    if (light_bounds_importance(&tree->nodes[0].bounds, p, n) <= 0.0f) return NULL;
+    int32_t node = 0;
+    float prob = 1.0f;
+    while (tree->nodes[node].light < 0) {
+        float i0 = light_bounds_importance(&tree->nodes[node + 1].bounds, p, n);
+        float i1 = light_bounds_importance(&tree->nodes[tree->nodes[node].second].bounds, p, n);
+        if (i0 <= 0.0f && i1 <= 0.0f) return NULL;
+        float p0 = i0 / (i0 + i1);
+        if (u < p0) {
+            u = _next_u(u, p0);
+            prob *= p0;
+            node = node + 1;
+        } else {
+            u = _next_u(u - p0, 1.0f - p0);
+            prob *= 1.0f - p0;
+            node = tree->nodes[node].second;
+        }
+    }
+    if (pmf) *pmf = prob;
+    return &tree->lights[tree->nodes[node].light];
+}
+
+// Chance de light_tree_sample escolher a fonte em 'coord' para 'p' e 'n' (0 se não há fonte lá)
+float light_tree_pmf(const Light_Tree *tree, Vector3 p, Vector3 n, IVector3 coord) {
+    const Tree_Light *light = light_tree_find(tree, coord);
+    if (!light || tree->needs_build || !tree->node_count) return 0.0f;
+    if (light_bounds_importance(&tree->nodes[0].bounds, p, n) <= 0.0f) return 0.0f;
+    int32_t node = 0;
+    float prob = 1.0f;
+    for (int depth = 0; tree->nodes[node].light < 0; depth++) {
+        float i0 = light_bounds_importance(&tree->nodes[node + 1].bounds, p, n);
+        float i1 = light_bounds_importance(&tree->nodes[tree->nodes[node].second].bounds, p, n);
+        if (i0 <= 0.0f && i1 <= 0.0f) return 0.0f;
+        bool second = (light->trail >> depth) & 1ull;
+        prob *= (second ? i1 : i0) / (i0 + i1);
+        node = second ? tree->nodes[node].second : node + 1;
+    }
+    return prob;
+}
+
+// Qualquer fonte com a mesma chance (a base de comparação da árvore)
+const Tree_Light *light_tree_sample_uniform(const Light_Tree *tree, float u, float *pmf) {
+    if (!tree || !tree->count) return NULL;
+    size_t index = std::min((size_t)(u * (float)tree->count), tree->count - 1);
+    if (pmf) *pmf = 1.0f / (float)tree->count;
+    return &tree->lights[index];
+}
+
+size_t light_tree_memory_usage(const Light_Tree *tree) {
+    if (!tree) return 0;
+    return sizeof(Light_Tree) + tree->capacity * sizeof(Tree_Light) + tree->slot_capacity * sizeof(int32_t)
+         + tree->node_capacity * sizeof(Light_Tree_Node);
+}
+
+void light_tree_delete(Light_Tree *tree) {
+    if (!tree) return;
+    free(tree->lights);
+    free(tree->slots);
+    free(tree->nodes);
+    free(tree);
+}
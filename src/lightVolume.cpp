@@ -0,0 +1,377 @@
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <color.h>
+}
+#include <lightVolume.hpp>
+#include <string.h>
+#include <math.h>
+
+#define TABLE_INITIAL_CAPACITY 64
+#define QUEUE_INITIAL_CAPACITY 256
+
+static const IVector3 NEIGHBORS[6] = {
+    {{1, 0, 0}}, {{-1, 0, 0}}, {{0, 1, 0}}, {{0, -1, 0}}, {{0, 0, 1}}, {{0, 0, -1}}
+};
+
+// --- Níveis (três canais de 5 bits) ---
+
+static int _channel(uint16_t light, int c) {
+    return (light >> (5 * c)) & LIGHT_MAX;
+}
+
+static uint16_t _pack(int r, int g, int b) {
+    return (uint16_t)(r | (g << 5) | (b << 10));
+}
+
+// Um passo a mais de distância: cada canal aceso perde 1
+static uint16_t _fade(uint16_t light) {
+    int r = _channel(light, 0), g = _channel(light, 1), b = _channel(light, 2);
+    return _pack(r ? r - 1 : 0, g ? g - 1 : 0, b ? b - 1 : 0);
+}
+
+static uint16_t _max(uint16_t a, uint16_t b) {
+    int r = _channel(a, 0) > _channel(b, 0) ? _channel(a, 0) : _channel(b, 0);
+    int g = _channel(a, 1) > _channel(b, 1) ? _channel(a, 1) : _channel(b, 1);
+    int bl = _channel(a, 2) > _channel(b, 2) ? _channel(a, 2) : _channel(b, 2);
+    return _pack(r, g, bl);
+}
+
+// Nível de uma fonte com esta cor e intensidade (0 = não emite)
+uint16_t light_volume_emission(ColorRGBA color, float illumination) {
+    if (illumination <= 0.0f) return 0;
+    float scale = (illumination > 1.0f ? 1.0f : illumination) * LIGHT_MAX / 255.0f;
+    return _pack((int)lroundf(get_red_rgba(color) * scale), (int)lroundf(get_green_rgba(color) * scale),
+                 (int)lroundf(get_blue_rgba(color) * scale));
+}
+
+// --- Blocos (tabela hash) ---
+
+static IVector3 _origin(IVector3 c) {
+    const int m = LIGHT_BRICK_DIM - 1;
+    return {{c.x & ~m, c.y & ~m, c.z & ~m}};
+}
+
+static int _cell(IVector3 c) {
+    const int m = LIGHT_BRICK_DIM - 1;
+    return (c.x & m) + LIGHT_BRICK_DIM * ((c.y & m) + LIGHT_BRICK_DIM * (c.z & m));
+}
+
+// O mesmo hash do shader (blockLight)
+static size_t _hash(IVector3 origin) {
+    uint32_t x = (uint32_t)(origin.x >> LIGHT_BRICK_LOG2), y = (uint32_t)(origin.y >> LIGHT_BRICK_LOG2), z = (uint32_t)(origin.z >> LIGHT_BRICK_LOG2);
+    return (size_t)((x * 73856093u) ^ (y * 19349663u) ^ (z * 83492791u));
+}
+
+static bool _same(IVector3 a, IVector3 b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+static Light_Brick **_slot(Light_Brick **table, size_t capacity, IVector3 origin) {
+    size_t i = _hash(origin) & (capacity - 1);
+    while (table[i] && !_same(table[i]->origin, origin)) i = (i + 1) & (capacity - 1);
+    return &table[i];
+}
+
+static bool _rehash(Light_Volume *volume, size_t capacity) {
+    Light_Brick **table = (Light_Brick**)calloc(capacity, sizeof(Light_Brick*));
+    if (!table) return false;
+    for (size_t i = 0; i < volume->capacity; i++) {
+        if (volume->table[i]) *_slot(table, capacity, volume->table[i]->origin) = volume->table[i];
+    }
+    free(volume->table);
+    volume->table = table;
+    volume->capacity = capacity;
+    return true;
+}
+
+static Light_Brick *_find(const Light_Volume *volume, IVector3 coord) {
+    return *_slot(volume->table, volume->capacity, _origin(coord));
+}
+
+static bool _test(const uint64_t *mask, int bit) {
+    return (mask[bit >> 6] >> (bit & 63)) & 1ull;
+}
+
+static void _assign(uint64_t *mask, int bit, bool value) {
+    if (value) mask[bit >> 6] |= 1ull << (bit & 63);
+    else mask[bit >> 6] &= ~(1ull << (bit & 63));
+}
+
+// Bloco novo, escuro, com a opacidade atual do mundo
+static Light_Brick *_create_brick(Light_Volume *volume, IVector3 coord) {
+    if ((volume->count + 1) * 2 > volume->capacity && !_rehash(volume, volume->capacity * 2)) return NULL;
+    Light_Brick *brick = (Light_Brick*)calloc(1, sizeof(Light_Brick));
+    if (!brick) return NULL;
+    brick->origin = _origin(coord);
+    for (int z = 0; z < LIGHT_BRICK_DIM; z++)
+    for (int y = 0; y < LIGHT_BRICK_DIM; y++)
+    for (int x = 0; x < LIGHT_BRICK_DIM; x++) {
+        IVector3 c = ivec3_add(brick->origin, {{x, y, z}});
+        if (volume->opaque(volume->user, c)) _assign(brick->opaque, _cell(c), true);
+    }
+    *_slot(volume->table, volume->capacity, brick->origin) = brick;
+    volume->count++;
+    return brick;
+}
+
+static void _set_light(Light_Brick *brick, int cell, uint16_t light) {
+    brick->lit += (light != 0) - (brick->light[cell] != 0);
+    brick->light[cell] = light;
+}
+
+// --- Filas ---
+
+static bool _push(Light_Queue *queue, IVector3 coord, uint16_t light) {
+    if (queue->count == queue->capacity) {
+        size_t capacity = queue->capacity ? queue->capacity * 2 : QUEUE_INITIAL_CAPACITY;
+        Light_Node *items = (Light_Node*)malloc(capacity * sizeof(Light_Node));
+        if (!items) return false;
+        // Desenrola o anel no começo do array novo
+        for (size_t i = 0; i < queue->count; i++) items[i] = queue->items[(queue->first + i) % queue->capacity];
+        free(queue->items);
+        queue->items = items;
+        queue->first = 0;
+        queue->capacity = capacity;
+    }
+    queue->items[(queue->first + queue->count) % queue->capacity] = {coord, light};
+    queue->count++;
+    return true;
+}
+
+static Light_Node _pop(Light_Queue *queue) {
+    Light_Node node = queue->items[queue->first];
+    queue->first = (queue->first + 1) % queue->capacity;
+    queue->count--;
+    return node;
+}
+
+// --- API ---
+
+// 'opaque' diz se uma célula do mundo bloqueia a luz; é chamada para as células de cada
+// bloco criado (a luz só cria blocos onde chega), então tem que refletir o mundo já editado
+Light_Volume *light_volume_create(bool (*opaque)(void *user, IVector3 coord), void *user) {
+    if (!opaque) return NULL;
+    Light_Volume *volume = (Light_Volume*)calloc(1, sizeof(Light_Volume));
+    if (!volume) return NULL;
+    volume->opaque = opaque;
+    volume->user = user;
+    volume->capacity = TABLE_INITIAL_CAPACITY;
+    volume->table = (Light_Brick**)calloc(volume->capacity, sizeof(Light_Brick*));
+    if (!volume->table) {
+        free(volume);
+        return NULL;
+    }
+    return volume;
+}
+
+// A célula passou a ser opaca ou não e a emitir 'emission' (light_volume_emission). Só
+// anota: a luz que passava por ela sai e a de volta entra no próximo light_volume_update.
+void light_volume_set(Light_Volume *volume, IVector3 coord, bool opaque, uint16_t emission) {
+    if (!volume) return;
+    Light_Brick *brick = _find(volume, coord);
+    int cell = _cell(coord);
+
+    if (brick) {
+        uint16_t old_emission = brick->emission ? brick->emission[cell] : 0;
+        if (_test(brick->opaque, cell) == opaque && old_emission == emission) return;
+    } else if (emission) {
+        brick = _create_brick(volume, coord);
+        if (!brick) return;
+    }
+
+    if (brick) {
+        _assign(brick->opaque, cell, opaque);
+        if (emission && !brick->emission) brick->emission = (uint16_t*)calloc(LIGHT_BRICK_CELLS, sizeof(uint16_t));
+        if (brick->emission) brick->emission[cell] = emission;
+
+        uint16_t old = brick->light[cell];
+        if (old) {
+            _set_light(brick, cell, 0);
+            _push(&volume->removals, coord, old);
+        }
+        if (emission) {
+            _set_light(brick, cell, emission);
+            _push(&volume->additions, coord, 0);
+        }
+    }
+
+    // Aberta: a luz dos vizinhos volta a entrar
+    if (opaque) return;
+    for (int i = 0; i < 6; i++) {
+        IVector3 n = ivec3_add(coord, NEIGHBORS[i]);
+        if (light_volume_at(volume, n)) _push(&volume->additions, n, 0);
+    }
+}
+
+// true se há edições ainda não espalhadas
+bool light_volume_is_dirty(const Light_Volume *volume) {
+    return volume && (volume->removals.count || volume->additions.count);
+}
+
+// Apagar primeiro: a partir de cada célula que perdeu luz, os vizinhos com nível menor
+// naquele canal só podiam estar acesos por ela e apagam também; os com nível maior ou
+// igual têm outra fonte e voltam a espalhar (como as fontes alcançadas). Cada canal é
+// independente, então cada nó da fila carrega só os canais que saíram.
+static void _remove(Light_Volume *volume) {
+    while (volume->removals.count) {
+        Light_Node node = _pop(&volume->removals);
+        volume->visited++;
+        for (int i = 0; i < 6; i++) {
+            IVector3 n = ivec3_add(node.coord, NEIGHBORS[i]);
+            Light_Brick *brick = _find(volume, n);
+            if (!brick) continue;
+            int cell = _cell(n);
+            uint16_t light = brick->light[cell];
+            if (!light) continue;
+
+            int kept[3], removed[3];
+            bool refill = false;
+            for (int c = 0; c < 3; c++) {
+                int level = _channel(light, c), gone = _channel(node.light, c);
+                kept[c] = level;
+                removed[c] = 0;
+                if (!level || !gone) continue;
+                if (level < gone) {
+                    kept[c] = 0;
+                    removed[c] = level;
+                } else {
+                    refill = true;
+                }
+            }
+            uint16_t lost = _pack(removed[0], removed[1], removed[2]);
+            if (lost) {
+                uint16_t emission = brick->emission ? brick->emission[cell] : 0;
+                uint16_t left = _pack(kept[0], kept[1], kept[2]);
+                _set_light(brick, cell, _max(left, emission));
+                _push(&volume->removals, n, lost);
+                if (emission) refill = true;
+            }
+            if (refill) _push(&volume->additions, n, 0);
+        }
+    }
+}
+
+// Espalhar: cada célula tirada da fila passa o próprio nível menos 1 aos vizinhos não
+// opacos que estiverem abaixo disso em algum canal. Blocos são criados só quando a luz
+// chega neles (a opacidade de quem ainda não tem bloco vem do mundo).
+static void _spread(Light_Volume *volume) {
+    while (volume->additions.count) {
+        Light_Node node = _pop(&volume->additions);
+        volume->visited++;
+        uint16_t light = _fade(light_volume_at(volume, node.coord));
+        if (!light) continue;
+        for (int i = 0; i < 6; i++) {
+            IVector3 n = ivec3_add(node.coord, NEIGHBORS[i]);
+            Light_Brick *brick = _find(volume, n);
+            int cell = _cell(n);
+            if (!brick) {
+                if (volume->opaque(volume->user, n)) continue;
+                brick = _create_brick(volume, n);
+                if (!brick) continue;
+            }
+            if (_test(brick->opaque, cell)) continue;
+            uint16_t next = _max(brick->light[cell], light);
+            if (next == brick->light[cell]) continue;
+            _set_light(brick, cell, next);
+            _push(&volume->additions, n, 0);
+        }
+    }
+}
+
+// Espalha as edições anotadas desde a última chamada; true se alguma luz pode ter mudado
+// (o buffer da GPU precisa ser reenviado)
+bool light_volume_update(Light_Volume *volume) {
+    if (!volume) return false;
+    volume->visited = 0;
+    if (!light_volume_is_dirty(volume)) return false;
+    _remove(volume);
+    _spread(volume);
+    return true;
+}
+
+uint16_t light_volume_at(const Light_Volume *volume, IVector3 coord) {
+    if (!volume) return 0;
+    Light_Brick *brick = _find(volume, coord);
+    return brick ? brick->light[_cell(coord)] : 0;
+}
+
+// Libera os blocos que ficaram escuros (a opacidade deles é relida se a luz voltar)
+void light_volume_prune(Light_Volume *volume) {
+    if (!volume) return;
+    bool freed = false;
+    for (size_t i = 0; i < volume->capacity; i++) {
+        Light_Brick *brick = volume->table[i];
+        if (!brick || brick->lit) continue;
+        free(brick->emission);
+        free(brick);
+        volume->table[i] = NULL;
+        volume->count--;
+        freed = true;
+    }
+    // O endereçamento aberto não aceita buracos no meio das sequências: reinsere tudo
+    if (freed) _rehash(volume, volume->capacity);
+}
+
+// Luz para o shader: buffer[0] = capacidade da tabela (potência de 2, 0 = sem luz),
+// buffer[1] = blocos, buffer[2] = LIGHT_MAX; depois a tabela (4 ints por posição: origem
+// do bloco / LIGHT_BRICK_DIM e o índice dele, -1 = livre) com o mesmo hash daqui, e os
+// blocos acesos com LIGHT_BRICK_WORDS ints cada (duas células por int, a primeira na
+// metade baixa)
+int32_t *light_volume_gpu_buffer(const Light_Volume *volume, size_t *arr_size) {
+    if (!arr_size) return NULL;
+    size_t lit = 0;
+    for (size_t i = 0; volume && i < volume->capacity; i++) lit += volume->table[i] && volume->table[i]->lit;
+    size_t capacity = 0;
+    if (lit) for (capacity = 1; capacity < lit * 2; capacity *= 2) {}
+
+    size_t words = 4 + capacity * 4 + lit * LIGHT_BRICK_WORDS;
+    int32_t *buffer = (int32_t*)calloc(words, sizeof(int32_t));
+    if (!buffer) return NULL;
+    *arr_size = words * sizeof(int32_t);
+    buffer[0] = (int32_t)capacity;
+    buffer[1] = (int32_t)lit;
+    buffer[2] = LIGHT_MAX;
+    if (!lit) return buffer;
+
+    int32_t *table = buffer + 4, *bricks = table + capacity * 4;
+    for (size_t i = 0; i < capacity; i++) table[i * 4 + 3] = -1;
+    int32_t index = 0;
+    for (size_t i = 0; i < volume->capacity; i++) {
+        Light_Brick *brick = volume->table[i];
+        if (!brick || !brick->lit) continue;
+        size_t at = _hash(brick->origin) & (capacity - 1);
+        while (table[at * 4 + 3] >= 0) at = (at + 1) & (capacity - 1);
+        table[at * 4 + 0] = brick->origin.x >> LIGHT_BRICK_LOG2;
+        table[at * 4 + 1] = brick->origin.y >> LIGHT_BRICK_LOG2;
+        table[at * 4 + 2] = brick->origin.z >> LIGHT_BRICK_LOG2;
+        table[at * 4 + 3] = index;
+        memcpy(bricks + (size_t)index * LIGHT_BRICK_WORDS, brick->light, sizeof(brick->light)); // little-endian
+        index++;
+    }
+    return buffer;
+}
+
+size_t light_volume_memory_usage(const Light_Volume *volume) {
+    if (!volume) return 0;
+    size_t bytes = sizeof(Light_Volume) + volume->capacity * sizeof(Light_Brick*);
+    bytes += (volume->removals.capacity + volume->additions.capacity) * sizeof(Light_Node);
+    for (size_t i = 0; i < volume->capacity; i++) {
+        Light_Brick *brick = volume->table[i];
+        if (!brick) continue;
+        bytes += sizeof(Light_Brick) + (brick->emission ? LIGHT_BRICK_CELLS * sizeof(uint16_t) : 0);
+    }
+    return bytes;
+}
+
+void light_volume_delete(Light_Volume *volume) {
+    if (!volume) return;
+    for (size_t i = 0; i < volume->capacity; i++) {
+        if (!volume->table[i]) continue;
+        free(volume->table[i]->emission);
+        free(volume->table[i]);
+    }
+    free(volume->table);
+    free(volume->removals.items);
+    free(volume->additions.items);
+    free(volume);
+}
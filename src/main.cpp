@@ -1,9 +1,11 @@
 #include <vector>
 #include <iostream>
+#include <chrono>
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/stat.h>
 
 #define FNL_IMPL
 #include <FastNoiseLite.h>
@@ -19,6 +21,9 @@
 #include <voxel.hpp>
 #include <octree.hpp>
 #include <voxReader.hpp>
+#include <world.hpp>
+#include <journal.hpp>
+#include <history.hpp>
 
 extern "C" {
     #include <color.h>
@@ -48,11 +53,24 @@ bool isGrounded = false;
 // --- BUILD STATE ---
 int selectedMaterialIndex = 2; // Default to Light - 10
 bool worldDirty = false;       // Flag to tell us if we need to update GPU
+const double COMPACT_BUDGET_MS = 1.0; // Time per frame for merging what edits left behind
+const double SUN_BUDGET_MS = 2.0;     // Time per frame for recomputing per-face sun visibility
+const float SUN_UPLOAD_INTERVAL = 0.25f; // Seconds between uploads while the sun cache is still filling in
+const float SUN_TURN_SPEED = 0.5f;    // Radians per second while Q/E turn the sun
+const glm::vec3 SUN_START(0.3481553f, 0.870388f, 0.3481553f); // Sun direction at startup (the bake is made for it)
+const double BAKE_BUDGET_MS = 2.0;    // Time per frame for re-baking faces near edits (backends that bake in place)
+const int BAKE_SAMPLES = 256;         // Paths per face for --bake without a count
 
 // --- GL GLOBALS ---
 // We make these global (or struct members) so the update function can access them
 GLuint textureID, voxelTexID; 
 GLuint pboID;
+GLuint instanceBufferID; // SSBO with the flattened instance BVH (binding 4)
+GLuint chunkBufferID;    // SSBO with the chunk directory (binding 5)
+GLuint distanceBufferID; // SSBO with the empty-space distance field (binding 6)
+GLuint lightBufferID; // SSBO with the light spread from emissive voxels (binding 7)
+GLuint sunBufferID;   // SSBO with the cached sun visibility of each voxel face (binding 8)
+GLuint bakeBufferID;  // SSBO with the baked indirect light of each voxel face (binding 9)
 size_t currentTexDim = 0; // Track texture size to know if we need to resize
 size_t tex_dim = 0;       // ADD THIS - Current texture dimension for shader uniform
 
@@ -96,16 +114,16 @@ unsigned int quadIndices[] = {
     1, 2, 3    // second triangle
 };
 
-// Returns true if a voxel exists at (x,y,z) using your octree_find
-bool isVoxelSolid(Octree* tree, int x, int y, int z) {
+// Returns true if a voxel exists at (x,y,z) using world_find
+bool isVoxelSolid(World* world, int x, int y, int z) {
     IVector3 coord = {x, y, z};
-    Voxel_Object v = octree_find(tree, coord);
+    Voxel_Object v = world_find(world, coord);
 
     return (v.coord.y > MIN_HEIGHT);
 }
 
 // AABB Collision Detection
-bool checkCollision(Octree* tree, glm::vec3 pos) {
+bool checkCollision(World* world, glm::vec3 pos) {
     // Determine the integer bounds of the player's bounding box
     int minX = floor(pos.x - PLAYER_WIDTH / 2.0f);
     int maxX = floor(pos.x + PLAYER_WIDTH / 2.0f);
@@ -119,7 +137,7 @@ bool checkCollision(Octree* tree, glm::vec3 pos) {
     for (int x = minX; x <= maxX; x++) {
         for (int y = minY; y <= maxY; y++) {
             for (int z = minZ; z <= maxZ; z++) {
-                if (isVoxelSolid(tree, x, y, z)) {
+                if (isVoxelSolid(world, x, y, z)) {
                     return true;
                 }
             }
@@ -215,61 +233,135 @@ void checkProgramLinking(GLuint program) {
     }
 }
 
-// Lista de todos os tipos de voxels possívels
-// IOF, Illumination, Metallicity
-Voxel voxels[] = {
-    {3.0f, 0.0f, 0.0f}, // VOX_GRASS
-    {3.0f, 0.0f, 0.0f}, // VOX_DIRT
-    {3.0f, 0.0f, 0.0f}, // VOX_WOOD
-    {3.0f, 0.0f, 0.0f}, // VOX_LEAVES
-    {1.33f, 0.0f, 0.0f}, // VOX_WATER
-    {3.0f, 0.0f, 0.0f},  // VOX_STONE
-    {1.5f, 0.0f, 0.0f},  // VOX_GLASS
-    {2.42f, 0.0f, 0.0f},  // VOX_DIAMOND
-    {1.38f, 0.0f, 0.0f},  // VOX_JELLY
-    {3.0f, 0.0f, 1.0f},  // VOX_MIRROR
-    {3.0f, 1.0f, 0.0f}, // LIGHT
-};
-
-Voxel_Type VOX_GRASS = 0;
-Voxel_Type VOX_DIRT = 1;
-Voxel_Type VOX_WOOD = 2;
-Voxel_Type VOX_LEAVES = 3;
-Voxel_Type VOX_WATER = 4;
-Voxel_Type VOX_STONE = 5;
-Voxel_Type VOX_GLASS = 6;
-Voxel_Type VOX_DIAMOND = 7;
-Voxel_Type VOX_JELLY = 8;
-Voxel_Type VOX_MIRROR = 9;
-Voxel_Type VOX_LIGHT = 10;
-
-// Colors for the materials above (Simplification)
-ColorRGBA voxelColors[] = {
-    make_color_rgba(80, 180, 60, 255),   // Grass
-    make_color_rgba(100, 70, 40, 255),   // Dirt
-    make_color_rgba(120, 70, 30, 255),   // Wood
-    make_color_rgba(30, 160, 30, 255),   // Leaves
-    make_color_rgba(60, 100, 220, 150),  // Water
-    make_color_rgba(160, 160, 160, 255), // Stone
-    make_color_rgba(200, 220, 255, 80),  // Glass
-    make_color_rgba(0, 255, 255, 255),   // Diamond
-    make_color_rgba(255, 100, 100, 180), // Jelly
-    make_color_rgba(255, 255, 255, 255), // Mirror
-    make_color_rgba(255, 210, 210, 255), // Light
-};
-
 uint8_t* render_buffer = NULL;
 size_t render_buffer_size = 0;
 
-void updateGPUTexture(Octree* tree) {
-    size_t total_texels = _octree_texel_size(tree);
+// Uploads only the instance BVH (nodes + transforms): moving instances costs O(instances),
+// the octree texture stays untouched
+void updateGPUInstances(World* world) {
+    size_t buffer_size = 0;
+    int32_t* buffer = world_instance_buffer(world, &buffer_size);
+    if (!buffer) return;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceBufferID);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)buffer_size, buffer, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, instanceBufferID);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    free(buffer);
+}
+
+// Uploads the chunk directory: where each resident chunk's root sits in the texture
+void updateGPUChunks(World* world) {
+    size_t buffer_size = 0;
+    int32_t* buffer = world_chunk_buffer(world, &buffer_size);
+    if (!buffer) return;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, chunkBufferID);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)buffer_size, buffer, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, chunkBufferID);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    free(buffer);
+}
+
+// Uploads the distance field the marcher uses to jump over empty space
+void updateGPUDistance(World* world) {
+    size_t buffer_size = 0;
+    int32_t* buffer = world_distance_buffer(world, &buffer_size);
+    if (!buffer) return;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, distanceBufferID);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)buffer_size, buffer, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, distanceBufferID);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    free(buffer);
+}
+
+// Uploads the light levels the shader reads next to each diffuse hit
+void updateGPULight(World* world) {
+    size_t buffer_size = 0;
+    int32_t* buffer = world_light_buffer(world, &buffer_size);
+    if (!buffer) return;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightBufferID);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)buffer_size, buffer, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, lightBufferID);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    free(buffer);
+}
+
+// Uploads the cached sun visibility that replaces most primary shadow rays
+void updateGPUSun(World* world) {
+    size_t buffer_size = 0;
+    int32_t* buffer = world_sun_buffer(world, &buffer_size);
+    if (!buffer) return;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, sunBufferID);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)buffer_size, buffer, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, sunBufferID);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    free(buffer);
+}
+
+// Uploads the baked indirect light that replaces the bounce rays of baked faces
+void updateGPUBake(World* world) {
+    size_t buffer_size = 0;
+    int32_t* buffer = world_bake_buffer(world, &buffer_size);
+    if (!buffer) return;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, bakeBufferID);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)buffer_size, buffer, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, bakeBufferID);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    free(buffer);
+}
+
+// Re-uploads texels [first, first + count) of render_buffer: whole rows of the 3D
+// texture, one glTexSubImage3D per slice touched
+void updateGPUTexels(size_t first, size_t count) {
+    if (count == 0 || currentTexDim == 0) return;
+    size_t dim = currentTexDim;
+    size_t firstRow = first / dim;
+    size_t lastRow = (first + count - 1) / dim;
+
+    glActiveTexture(GL_TEXTURE0 + 2);
+    glBindTexture(GL_TEXTURE_3D, textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t z = firstRow / dim; z <= lastRow / dim; z++) {
+        size_t y0 = (z == firstRow / dim) ? firstRow % dim : 0;
+        size_t y1 = (z == lastRow / dim) ? lastRow % dim : dim - 1;
+        glTexSubImage3D(GL_TEXTURE_3D, 0, 0, (GLint)y0, (GLint)z,
+                        (GLsizei)dim, (GLsizei)(y1 - y0 + 1), 1,
+                        GL_RGBA_INTEGER, GL_UNSIGNED_BYTE, render_buffer + ((z * dim + y0) * dim) * 4);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+// world_sync_objects/world_sync_chunks callback: one rewritten object model or chunk
+void uploadObjectTexels(void* user, size_t first, size_t count) {
+    (void)user;
+    updateGPUTexels(first, count);
+}
+
+void updateGPUTexture(World* world) {
+    size_t arr_size_used = 0;
+    // A mapped .svo world is uploaded straight from the file, without serializing
+    uint8_t* texture_data = NULL;
+    const uint8_t* texture_view = world_texture_view(world, &arr_size_used);
+    if (!texture_view) {
+        texture_data = world_texture(world, &arr_size_used, 0);
+        texture_view = texture_data;
+    }
+    size_t total_texels = arr_size_used / 4;
     
     tex_dim = (size_t)ceil(cbrt((double)total_texels));
     if (tex_dim == 0) tex_dim = 1;
 
-    size_t arr_size_used;
-    uint8_t* texture_data = octree_texture(tree, &arr_size_used, tex_dim);
-
     size_t needed_size = tex_dim * tex_dim * tex_dim * 4;
     
     // Only reallocate if we need more space
@@ -288,7 +380,7 @@ void updateGPUTexture(Octree* tree) {
     
     // Force reallocation by uploading with glTexImage3D (not glTexSubImage3D)
     
-    memcpy(render_buffer, texture_data, arr_size_used);
+    memcpy(render_buffer, texture_view, arr_size_used);
     
     // Upload texture data
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
@@ -308,6 +400,30 @@ void updateGPUTexture(Octree* tree) {
     currentTexDim = tex_dim;
     
     free(texture_data);
+
+    // Model and chunk roots may have moved inside the texture
+    updateGPUInstances(world);
+    updateGPUChunks(world);
+    // The first upload after a load builds the whole field (in parallel). There is no field
+    // for a chunked world (it only covers whole worlds): the marcher steps cell by cell there
+    if (world->backend != WORLD_BACKEND_CHUNKED) {
+        world_update_distance(world);
+        updateGPUDistance(world);
+    }
+    // Same for the light: after a load every source is spread again (whole worlds only; a
+    // chunked world keeps lighting emitters with the shader's rays)
+    if (world->backend != WORLD_BACKEND_CHUNKED) {
+        world_update_light(world);
+        updateGPULight(world);
+    }
+}
+
+// True if 'path' exists and is not older than 'source'
+bool isUpToDate(const char* path, const char* source) {
+    struct stat cached, original;
+    if (stat(path, &cached) != 0) return false;
+    if (stat(source, &original) != 0) return true;
+    return cached.st_mtime >= original.st_mtime;
 }
 
 // --- HELPER: MATH FOR CONSTRUCTION ---
@@ -361,11 +477,14 @@ glm::ivec3 get_placement_coord(glm::vec3 origin, glm::vec3 dir, glm::ivec3 targe
 }
 
 // Bad Apple
-void ReadBadAppleFrame(Octree* tree, int frame) {
+// Builds one frame as its own model octree (640x1x480 inside a 1024 box), to be shown as a
+// dynamic object: swapping frames rewrites only this model, never the world.
+// Returns NULL if the frame could not be read. The caller owns the octree.
+Octree* ReadBadAppleFrame(int frame) {
     FILE *f = fopen("bad_apple.txt", "rb");
     if (!f) {
         printf("Error: Could not open bad_apple.txt\n");
-        return;
+        return NULL;
     }
 
     // 1. SEEK: Calculate where this frame starts in the file
@@ -378,6 +497,7 @@ void ReadBadAppleFrame(Octree* tree, int frame) {
 
     uint8_t buffer[640];
     Voxel stone = voxels[VOX_STONE];
+    Octree* model = octree_create(NULL, {0, 0, 0}, {1024, 1024, 1024});
 
     // 2. LOOP: Iterate exactly through the height
     for (int y = 0; y < 480; y++) {
@@ -386,27 +506,81 @@ void ReadBadAppleFrame(Octree* tree, int frame) {
         size_t read_count = fread(buffer, 1, 640, f);
         
         // Safety check: if file ended unexpectedly
-        if (read_count < 640) break; 
+        if (read_count < 640) {
+            octree_delete(model);
+            fclose(f);
+            return NULL;
+        }
 
         for (int x = 0; x < 640; x++) {
             // 3. LOGIC: Check for the CHARACTER '1' (ASCII 49)
             // Note: Inverted Y usually matches image coordinates better in Octrees
             if (buffer[x] == '1') {
-                octree_insert(tree, VoxelObjCreate(stone, COLOR_WHITEA, {x, 0, y}));
+                octree_insert(model, VoxelObjCreate(stone, COLOR_WHITEA, {x, 0, y}));
             } else {
                 // Optional: Insert black, or just skip to keep it sparse/transparent
-                octree_insert(tree, VoxelObjCreate(stone, COLOR_BLACKA, {x, 0, y}));
+                octree_insert(model, VoxelObjCreate(stone, COLOR_BLACKA, {x, 0, y}));
             }
         }
     }
 
     fclose(f);
+    octree_compact(model, 0);
+    return model;
 }
 
-int main(void)
+// Saved game: the last checkpoint snapshot plus the edit journal written after it.
+// Without a save, the native .svo map is mapped as is (no parse, no tree build); it is
+// rebuilt from the .vox when missing or stale. Otherwise the loader picks the backend
+// (octree or dense grid) from bounds and density.
+void loadWorld(World* world) {
+    if (!world_load_svo(world, "saves/world.svo")
+        && (!isUpToDate("maps/dragon.svo", "maps/dragon.vox") || !world_load_svo(world, "maps/dragon.svo"))) {
+        // Built maps are kept in cache/, keyed by the .vox content (least recently used go first)
+        Vox_Load_Options options = {};
+        options.cache_dir = "cache";
+        options.cache_max_bytes = 256ull << 20;
+        load_vox_world("maps/dragon.vox", world, 0, 0, 0, &options);
+        if (!world_save_svo(world, "maps/dragon.svo")) std::cerr << "Could not write maps/dragon.svo" << std::endl;
+    }
+    journal_replay(world, "saves/world.journal");
+}
+
+// --bake [samples]: path traces the indirect light of every exposed face of the saved world
+// on all cores and writes saves/world.bake, then exits. A bake with the same sample count
+// is resumed (only faces it is missing, e.g. near edits made in the game, are traced).
+int bakeWorld(int samples) {
+    World* world = world_create({-WORLD_SIZE_X + 1, -WORLD_SIZE_Y + 1, -WORLD_SIZE_Z + 1}, {WORLD_SIZE_X, WORLD_SIZE_Y, WORLD_SIZE_Z});
+    if (!world) return EXIT_FAILURE;
+    loadWorld(world);
+    world_set_sun(world, vec3_float(SUN_START.x, SUN_START.y, SUN_START.z));
+    if (!world_load_bake(world, "saves/world.bake") || world->bake_samples != samples) world_bake(world, samples);
+
+    auto start = std::chrono::steady_clock::now();
+    size_t baked = 0;
+    do {
+        world_update_bake(world, 1000.0);
+        baked += world->bake ? world->bake->baked : 0;
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%zu faces baked, %zu left (%.0f faces/s)\n", baked, world->bake ? world->bake->dirty : 0,
+               elapsed > 0.0 ? baked / elapsed : 0.0);
+    } while (world->bake && world->bake->dirty > 0);
+
+    bool ok = world_save_bake(world, "saves/world.bake");
+    if (!ok) std::cerr << "Could not write saves/world.bake" << std::endl;
+    world_delete(world);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char** argv)
 {
     glfwSetErrorCallback(error_callback);
 
+    if (argc > 1 && strcmp(argv[1], "--bake") == 0) {
+        int samples = argc > 2 ? atoi(argv[2]) : BAKE_SAMPLES;
+        return bakeWorld(samples > 0 ? samples : BAKE_SAMPLES);
+    }
+
     if (!glfwInit())
         exit(EXIT_FAILURE);
 
@@ -474,15 +648,48 @@ int main(void)
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
     glGenBuffers(1, &pboID);
+    glGenBuffers(1, &instanceBufferID);
+    glGenBuffers(1, &chunkBufferID);
+    glGenBuffers(1, &distanceBufferID);
+    glGenBuffers(1, &lightBufferID);
+    glGenBuffers(1, &sunBufferID);
+    glGenBuffers(1, &bakeBufferID);
 
     glm::ivec3 min_bounds(-WORLD_SIZE_X + 1, -WORLD_SIZE_Y + 1, -WORLD_SIZE_Z + 1);
     glm::ivec3 max_bounds(WORLD_SIZE_X, WORLD_SIZE_Y, WORLD_SIZE_Z);
-    Octree* chunk0 = octree_create(NULL, {-WORLD_SIZE_X + 1, -WORLD_SIZE_Y + 1, -WORLD_SIZE_Z + 1}, {WORLD_SIZE_X, WORLD_SIZE_Y, WORLD_SIZE_Z});
+    World* world = world_create({-WORLD_SIZE_X + 1, -WORLD_SIZE_Y + 1, -WORLD_SIZE_Z + 1}, {WORLD_SIZE_X, WORLD_SIZE_Y, WORLD_SIZE_Z});
 
     glm::vec4 global_light(1.0f, 1.0f, 1.0f, 1.0f);
-    glm::vec3 light_dir = glm::normalize(glm::vec3(0.3481553f, 0.870388f, 0.3481553f));
-
-    load_vox_file("maps/dragon.vox", chunk0, 0, 0, 0);
+    glm::vec3 light_dir = glm::normalize(SUN_START);
+
+    loadWorld(world);
+    // Indirect light baked offline (--bake); faces without it keep the live bounce rays
+    world_set_sun(world, vec3_float(light_dir.x, light_dir.y, light_dir.z));
+    world_load_bake(world, "saves/world.bake");
+    // A world too big for one texture goes in chunks: one octree per chunk, only the chunks
+    // around the camera stay as octrees and go to the GPU, and an edit rewrites just the
+    // chunk it touched. Smaller worlds keep their backend (and the distance field, light,
+    // sun cache and bake, which are built for the whole world).
+    if (!world_fits_texture(world)) {
+        world_set_backend(world, WORLD_BACKEND_CHUNKED, world->left_bot_back, world->left_bot_back);
+        // Packed chunks past the cache budget are swapped out to disk and streamed back in
+        // ahead of the camera; the swap file is rebuilt every run
+        if (!world_swap_chunks(world, "saves/world.chunks", CHUNK_CACHE_BUDGET)) {
+            std::cerr << "Could not create saves/world.chunks, keeping every chunk in memory" << std::endl;
+        }
+        // Past the resident radius chunks still reach the GPU, as 2x/4x/8x downsampled copies
+        // picked by their size on screen (same 45 degree vertical fov as the projection)
+        world_set_chunk_lod(world, CHUNK_LOD_RADIUS, screenHeight / (2.0f * std::tan(glm::radians(45.0f) / 2.0f)));
+    }
+    Journal* journal = journal_open(world, "saves/world.journal", "saves/world.svo",
+                                    JOURNAL_SYNC_MS, JOURNAL_SYNC_BYTES, JOURNAL_CHECKPOINT_BYTES);
+    // The save is a single .svo snapshot plus the journal; a chunked world past the texture
+    // limit can't be written as one .svo, so there is no snapshot and nothing is journaled
+    if (!journal) {
+        std::cerr << "Could not open saves/world.journal: edits made this session will not be saved" << std::endl;
+    }
+    // Undo/redo for this session; undoing and redoing are journaled like any other edit
+    History* history = history_create(HISTORY_MAX_BYTES, journal);
 
     // FastNoiseLite noise;
     // noise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
@@ -497,7 +704,7 @@ int main(void)
     //                 voxel = VoxelObjCreate(voxels[VOX_DIRT], voxelColors[VOX_DIRT], {j, h, i});
     //             else
     //                 voxel = VoxelObjCreate(voxels[VOX_GRASS], voxelColors[VOX_GRASS], {j, h, i});
-    //             octree_insert(chunk0, voxel);
+    //             world_insert(world, voxel);
     //         }
     //     }
     // }
@@ -515,7 +722,7 @@ int main(void)
     //    for (int z = roomMinZ; z <= roomMaxZ; ++z) {
     //        int index = x + floorY * WORLD_SIZE_X + z * WORLD_SIZE_X * WORLD_SIZE_Y;
     //        Voxel_Object voxel = VoxelObjCreate(voxels[VOX_GRASS], make_color_rgba(100, 200, 80, 255), {x, floorY, z});
-    //        octree_insert(chunk0, voxel);
+    //        world_insert(world, voxel);
     //    }
     // }
 
@@ -525,28 +732,28 @@ int main(void)
     //    for (int x = roomMinX; x <= roomMaxX; ++x) {
     //        //int index = x + y * WORLD_SIZE_X + roomMinZ * WORLD_SIZE_X * WORLD_SIZE_Y;
     //        Voxel_Object voxel = VoxelObjCreate(voxels[VOX_WOOD], make_color_rgba(140, 90, 50, 255), {x, y, roomMinZ});
-    //        octree_insert(chunk0, voxel);
+    //        world_insert(world, voxel);
     //    }
 
     //    // South wall (z = roomMaxZ) - WOOD
     //    for (int x = roomMinX; x <= roomMaxX; ++x) {
     //        //int index = x + y * WORLD_SIZE_X + roomMaxZ * WORLD_SIZE_X * WORLD_SIZE_Y;
     //        Voxel_Object voxel = VoxelObjCreate(voxels[VOX_WOOD], make_color_rgba(140, 90, 50, 255), {x, y, roomMaxZ});
-    //        octree_insert(chunk0, voxel);
+    //        world_insert(world, voxel);
     //    }
 
     //    // West wall (x = roomMinX) - WOOD
     //    for (int z = roomMinZ; z <= roomMaxZ; ++z) {
     //        //int index = roomMinX + y * WORLD_SIZE_X + z * WORLD_SIZE_X * WORLD_SIZE_Y;
     //        Voxel_Object voxel = VoxelObjCreate(voxels[VOX_WOOD], make_color_rgba(140, 90, 50, 255), {roomMinX, y, z});
-    //        octree_insert(chunk0, voxel);
+    //        world_insert(world, voxel);
     //    }
 
     //    // East wall (x = roomMaxX) - GLASS
     //    for (int z = roomMinZ; z <= roomMaxZ; ++z) {
     //        //int index = roomMaxX + y * WORLD_SIZE_X + z * WORLD_SIZE_X * WORLD_SIZE_Y;
     //        Voxel_Object voxel = VoxelObjCreate(voxels[VOX_GLASS], make_color_rgba(100, 100, 230, 40), {roomMaxX, y, z});
-    //        octree_insert(chunk0, voxel);
+    //        world_insert(world, voxel);
     //    }
     // }
 
@@ -577,7 +784,7 @@ int main(void)
     //            if (dist <= (float)radius + voxelMargin) {
     //                Voxel_Object voxel = VoxelObjCreate(voxels[VOX_JELLY], 
     //                    make_color_rgba(240, 100, 100, 100), {x, y, z});
-    //                octree_insert(chunk0, voxel);
+    //                world_insert(world, voxel);
     //            }
     //        }
     //    }
@@ -626,10 +833,10 @@ int main(void)
 
     //            if (whitePatch) {
     //                Voxel_Object voxel = VoxelObjCreate(voxels[VOX_STONE], make_color_rgba(240, 240, 240, 255), {x, y, z}); // white
-    //                octree_insert(chunk0, voxel);
+    //                world_insert(world, voxel);
     //            } else {
     //                Voxel_Object voxel = VoxelObjCreate(voxels[VOX_WOOD], make_color_rgba(20, 20, 20, 255), {x, y, z}); // black
-    //                octree_insert(chunk0, voxel);
+    //                world_insert(world, voxel);
     //            }
     //        }
     //    }
@@ -638,7 +845,7 @@ int main(void)
     float voxelScale = 1.0; // A escala do voxel no mundo, ex: 2.0 significa 1 voxel a cada 0.5 unidades de espaço
 
     // Initial GPU Upload
-    updateGPUTexture(chunk0);
+    updateGPUTexture(world);
 
     // UBO para a câmera
     struct CameraData {
@@ -693,6 +900,7 @@ int main(void)
     GLint globalLightLoc = glGetUniformLocation(computeProgram, "globalLight");
     GLint lightDirLoc = glGetUniformLocation(computeProgram, "lightDir");
     GLint highlightedVoxLoc = glGetUniformLocation(computeProgram, "u_highlightedVoxel");
+    GLint pixelAngleLoc = glGetUniformLocation(computeProgram, "u_pixelAngle");
 
     // Configurar os shaders do Quad
     const GLuint quad_vertex_shader = glCreateShader(GL_VERTEX_SHADER);
@@ -717,10 +925,7 @@ int main(void)
     int frameCount = 0;
     glm::vec3 lastCameraPos = camera.Position;
     glm::vec3 lastCameraDir = camera.Front;
-
-    int badAppleCounter = 0;
-    float videoTimer = 0.0f; 
-    float videoInterval = 1.0f / 30.0f;
+    Octree *clipboard = NULL; // Region copied with X
 
     // Dentro do seu game loop
     while (!glfwWindowShouldClose(window)) {
@@ -745,30 +950,6 @@ int main(void)
         feetPos.z += playerVelocity.z * deltaTime;
         feetPos.y += playerVelocity.y * deltaTime;
 
-        // BAD APPLE
-        // videoTimer += deltaTime;
-        // if (videoTimer >= videoInterval) {
-        //     videoTimer = 0.0f;
-
-        //     // 1. Delete old tree
-        //     if (chunk0) octree_delete(chunk0);
-
-        //     // 2. Create new tree
-        //     chunk0 = octree_create(NULL, 
-        //         {-WORLD_SIZE_X + 1, -WORLD_SIZE_Y + 1, -WORLD_SIZE_Z + 1}, 
-        //         {WORLD_SIZE_X, WORLD_SIZE_Y, WORLD_SIZE_Z}
-        //     );
-
-        //     // 3. Load Frame
-        //     ReadBadAppleFrame(chunk0, badAppleCounter);
-        //     badAppleCounter++;
-
-        //     // 4. Update GPU
-        //     // Note: This is heavy! Expect low FPS with RGBA32UI upload every frame.
-        //     // Ensure you unbound the texture before calling this in updateGPUTexture
-        //     updateGPUTexture(chunk0);
-        // }
-
         if(!CREATIVE){
             // Apply friction
             float damping = isGrounded ? FRICTION : AIR_RESISTANCE;
@@ -779,20 +960,20 @@ int main(void)
             playerVelocity.y -= GRAVITY * deltaTime;
 
             // Move & Collide X
-            if (checkCollision(chunk0, feetPos)) {
+            if (checkCollision(world, feetPos)) {
                 feetPos.x -= playerVelocity.x * deltaTime;
                 playerVelocity.x = 0;
             }
 
             // Move & Collide Z
-            if (checkCollision(chunk0, feetPos)) {
+            if (checkCollision(world, feetPos)) {
                 feetPos.z -= playerVelocity.z * deltaTime;
                 playerVelocity.z = 0;
             }
 
             // Move & Collide Y
             isGrounded = false;
-            if (checkCollision(chunk0, feetPos)) {
+            if (checkCollision(world, feetPos)) {
                 if (playerVelocity.y < 0) isGrounded = true;
                 feetPos.y -= playerVelocity.y * deltaTime;
                 playerVelocity.y = 0;
@@ -824,20 +1005,15 @@ int main(void)
         Ray ray;
         ray.origin = vec3_scalar_mul({camera.Position.x, camera.Position.y, camera.Position.z}, voxelScale);
         ray.direction = {camera.Front.x, camera.Front.y, camera.Front.z};
-        Octree* hitNode = octree_ray_cast(chunk0, ray, {0,0,0}, {(float)WORLD_SIZE_X, (float)WORLD_SIZE_Y, (float)WORLD_SIZE_Z});
+        Voxel_Object hitVoxel;
+        bool hit = world_ray_cast(world, ray, &hitVoxel);
 
-        if (hitNode && hitNode->has_voxel) {
-            highlightedVoxel = {hitNode->voxel.coord.x, hitNode->voxel.coord.y, hitNode->voxel.coord.z};
+        if (hit) {
+            highlightedVoxel = {hitVoxel.coord.x, hitVoxel.coord.y, hitVoxel.coord.z};
         } else {
             highlightedVoxel = glm::ivec3(-1);
         }
 
-        if (hitNode && hitNode->has_voxel) {
-            IVector3 voxCoord = hitNode->voxel.coord;
-            IVector3 nodeMin = hitNode->left_bot_back;
-            IVector3 nodeMax = hitNode->right_top_front;
-        }
-
         // 2. Handle Clicks
         // LEFT CLICK: DESTROY
         if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS && !leftWasDown) {
@@ -845,12 +1021,12 @@ int main(void)
                 IVector3 target = {highlightedVoxel.x, highlightedVoxel.y, highlightedVoxel.z};
                 
                 // Check if voxel exists BEFORE removal
-                Voxel_Object before = octree_find(chunk0, target);
+                Voxel_Object before = world_find(world, target);
                 
-                octree_remove(chunk0, target);
+                history_remove(history, world, target);
                 
                 // Check if voxel exists AFTER removal
-                Voxel_Object after = octree_find(chunk0, target);
+                Voxel_Object after = world_find(world, target);
                 
                 worldDirty = true;
             }
@@ -872,7 +1048,7 @@ int main(void)
                 if (!insidePlayer) {
                     Voxel_Object newVoxel = VoxelObjCreate(voxels[selectedMaterialIndex], voxelColors[selectedMaterialIndex], 
                         {placeCoord.x, placeCoord.y, placeCoord.z});
-                    octree_insert(chunk0, newVoxel);
+                    history_insert(history, world, newVoxel);
                     worldDirty = true;
                 }
             }
@@ -899,19 +1075,122 @@ int main(void)
         }
         cWasDown = (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS);
 
+        // CLIPBOARD: Z marks a corner, X copies the box up to the targeted voxel,
+        // R rotates the clipboard and V pastes it at the placement cell.
+        // F fills the box up to the targeted voxel with the selected material.
+        static glm::ivec3 clipCorner(-1);
+        static IVector3 clipSize = {{0, 0, 0}};
+        static int clipRotation = 0;
+        static bool zWasDown = false, xWasDown = false, rWasDown = false, vWasDown = false, fWasDown = false, yWasDown = false;
+        bool ctrlDown = glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_RIGHT_CONTROL) == GLFW_PRESS;
+        if (glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS && !zWasDown && !ctrlDown && highlightedVoxel.x != -1) {
+            clipCorner = highlightedVoxel;
+        }
+        if (glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS && !xWasDown && highlightedVoxel.x != -1 && clipCorner.x != -1) {
+            IVector3 a = {{clipCorner.x, clipCorner.y, clipCorner.z}};
+            IVector3 b = {{highlightedVoxel.x, highlightedVoxel.y, highlightedVoxel.z}};
+            octree_delete(clipboard);
+            clipboard = world_copy_region(world, a, b);
+            clipSize = ivec3_scalar_add(ivec3_sub(ivec3_max(a, b), ivec3_min(a, b)), 1);
+            clipRotation = 0;
+        }
+        if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS && !rWasDown) {
+            clipRotation = (clipRotation + 1) % VOXEL_ROTATIONS;
+        }
+        if (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS && !vWasDown && highlightedVoxel.x != -1 && clipboard) {
+            glm::ivec3 placeCoord = get_placement_coord(camera.Position, camera.Front, highlightedVoxel);
+            Voxel_Transform transform = voxel_transform_place(clipRotation, clipSize, {{placeCoord.x, placeCoord.y, placeCoord.z}});
+            if (history_paste(history, world, clipboard, transform)) worldDirty = true;
+        }
+        if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS && !fWasDown && highlightedVoxel.x != -1 && clipCorner.x != -1) {
+            IVector3 a = {{clipCorner.x, clipCorner.y, clipCorner.z}};
+            IVector3 b = {{highlightedVoxel.x, highlightedVoxel.y, highlightedVoxel.z}};
+            Voxel_Object material = VoxelObjCreate(voxels[selectedMaterialIndex], voxelColors[selectedMaterialIndex], a);
+            if (history_fill(history, world, a, b, material)) worldDirty = true;
+        }
+
+        // UNDO / REDO: Ctrl+Z and Ctrl+Y
+        if (ctrlDown && glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS && !zWasDown) {
+            if (history_undo(history, world)) worldDirty = true;
+        }
+        if (ctrlDown && glfwGetKey(window, GLFW_KEY_Y) == GLFW_PRESS && !yWasDown) {
+            if (history_redo(history, world)) worldDirty = true;
+        }
+        zWasDown = (glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS);
+        xWasDown = (glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS);
+        rWasDown = (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS);
+        vWasDown = (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS);
+        fWasDown = (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS);
+        yWasDown = (glfwGetKey(window, GLFW_KEY_Y) == GLFW_PRESS);
+
+        // Q / E turn the sun around the vertical axis
+        float sunTurn = 0.0f;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) sunTurn -= SUN_TURN_SPEED * deltaTime;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS) sunTurn += SUN_TURN_SPEED * deltaTime;
+        if (sunTurn != 0.0f) light_dir = glm::normalize(glm::vec3(glm::rotate(glm::mat4(1.0f), sunTurn, glm::vec3(0.0f, 1.0f, 0.0f)) * glm::vec4(light_dir, 0.0f)));
+
+        // Merge identical siblings left by edits (resumes next frame if over budget)
+        world_compact(world, COMPACT_BUDGET_MS);
+
+        // Chunks near the camera are paged in (octree + texture slot), far ones packed away
+        glm::vec3 cameraCell = glm::floor(camera.Position * voxelScale);
+        world_page_chunks(world, {(int)cameraCell.x, (int)cameraCell.y, (int)cameraCell.z}, CHUNK_RESIDENT_RADIUS);
+        // Chunks still on disk are read ahead along the camera's path (cells per second)
+        glm::vec3 cameraVelocity = deltaTime > 0.0f ? (camera.Position - lastCameraPos) * voxelScale / deltaTime : glm::vec3(0.0f);
+        lastCameraPos = camera.Position;
+        world_stream_chunks(world, vec3_float(cameraCell.x, cameraCell.y, cameraCell.z),
+                            vec3_float(cameraVelocity.x, cameraVelocity.y, cameraVelocity.z));
+
         // 3. Update GPU if dirty
+        // Chunks that were edited or paged in are rewritten in their own slots, so edits on a
+        // chunked world skip the full upload. Dynamic objects whose model changed are
+        // rewritten in place too. No room = full upload.
+        size_t texelCapacity = currentTexDim * currentTexDim * currentTexDim;
+        if (world->backend == WORLD_BACKEND_CHUNKED || !worldDirty) {
+            worldDirty = !world_sync_chunks(world, render_buffer, texelCapacity, uploadObjectTexels, NULL);
+        }
+        if (!worldDirty && !world_sync_objects(world, render_buffer, texelCapacity, uploadObjectTexels, NULL)) {
+            worldDirty = true;
+        }
+
         if (worldDirty) {
             // CRITICAL: Unbind texture BEFORE updating
             glActiveTexture(GL_TEXTURE0 + 2);
             glBindTexture(GL_TEXTURE_3D, 0);
             
-            updateGPUTexture(chunk0);
+            updateGPUTexture(world);
             
             // Force rebind after update
             glBindTexture(GL_TEXTURE_3D, textureID);
             
             worldDirty = false;
+        } else {
+            // Instances or objects moved (or got a new model): refit the BVHs and re-upload just those
+            if (world_update_instances(world)) updateGPUInstances(world);
+            // Chunks paged in or out, or a chunk moved to another slot
+            if (world_update_chunks(world)) updateGPUChunks(world);
+            // Edits that skipped the full upload: only cells near them are recomputed
+            if (world->backend != WORLD_BACKEND_CHUNKED && world_update_distance(world)) updateGPUDistance(world);
+            // Relight only what the edited cells reached
+            if (world->backend != WORLD_BACKEND_CHUNKED && world_update_light(world)) updateGPULight(world);
+        }
+
+        // Sun visibility per voxel face: faces in the shadow of an edit, or all of them after
+        // the sun moved, are recomputed a few ms per frame. Until then the shader ignores
+        // them and marches shadow rays, so partial uploads only need to happen now and then.
+        // The cache covers whole worlds; a chunked world always marches the shadow rays.
+        static bool sunPending = false;
+        static float lastSunUpload = 0.0f;
+        world_set_sun(world, vec3_float(light_dir.x, light_dir.y, light_dir.z));
+        if (world->backend != WORLD_BACKEND_CHUNKED && world_update_sun(world, SUN_BUDGET_MS)) sunPending = true;
+        bool sunSettled = !world->sun || world->sun->dirty == 0;
+        if (sunPending && (sunSettled || currentFrame - lastSunUpload >= SUN_UPLOAD_INTERVAL)) {
+            updateGPUSun(world);
+            sunPending = false;
+            lastSunUpload = currentFrame;
         }
+        // Edits send the faces around them back to the live bounce until they are re-baked
+        if (world_update_bake(world, BAKE_BUDGET_MS)) updateGPUBake(world);
 
         glBindBuffer(GL_UNIFORM_BUFFER, uboCamera);
         glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraData), &cameraData);
@@ -927,6 +1206,12 @@ int main(void)
 
         glActiveTexture(GL_TEXTURE0 + 2);
         glBindTexture(GL_TEXTURE_3D, textureID);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, instanceBufferID);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, chunkBufferID);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, distanceBufferID);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, lightBufferID);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, sunBufferID);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, bakeBufferID);
 
 
         glUniform1i(texDimLoc, (GLint)tex_dim);
@@ -936,9 +1221,11 @@ int main(void)
         glUniform4fv(globalLightLoc, 1, (const GLfloat*)&global_light);
         glUniform3fv(lightDirLoc, 1, (const GLfloat*)&light_dir);
         glUniform3iv(highlightedVoxLoc, 1, (const GLint*)&highlightedVoxel);
+        // Angle covered by one pixel: rays stop at prefiltered nodes that fit inside their cone
+        glUniform1f(pixelAngleLoc, 2.0f * std::tan(glm::radians(45.0f) / 2.0f) / (float)screenHeight);
 
         // GARANTE QUE A ATUALIZAÇÃO DA TEXTURA (glTexSubImage3D) TERMINOU
-        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
 
         // Dispara os threads do compute shader.
         // Dividimos o tamanho da tela pelo tamanho do grupo de trabalho definido no shader.
@@ -973,6 +1260,12 @@ int main(void)
     glDeleteVertexArrays(1, &quadVAO);
     glDeleteBuffers(1, &quadEBO);
     glDeleteBuffers(1, &pboID);
+    glDeleteBuffers(1, &instanceBufferID);
+    glDeleteBuffers(1, &chunkBufferID);
+    glDeleteBuffers(1, &distanceBufferID);
+    glDeleteBuffers(1, &lightBufferID);
+    glDeleteBuffers(1, &sunBufferID);
+    glDeleteBuffers(1, &bakeBufferID);
     glDeleteTextures(1, &textureID);
     glDeleteTextures(1, &voxelTexID);
     glDeleteTextures(1, &outputTexture);
@@ -982,6 +1275,17 @@ int main(void)
     glDeleteShader(quad_fragment_shader);
     glDeleteProgram(quadProgram);
 
+    // Faces edited this session go back pending, for the next --bake to finish; a bake
+    // dropped by a large edit no longer matches the world
+    if (world->bake && !world_save_bake(world, "saves/world.bake")) std::cerr << "Could not write saves/world.bake" << std::endl;
+    if (!world->bake && world->bake_samples > 0) remove("saves/world.bake");
+
+    // Writes the edits still queued and waits for a running checkpoint
+    history_delete(history);
+    journal_close(journal);
+    octree_delete(clipboard);
+    world_delete(world);
+
     glfwDestroyWindow(window);
     glfwTerminate();
     return 0;
@@ -0,0 +1,328 @@
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/ray.h>
+}
+#include <objects.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+// Ponteiros da textura têm 23 bits (ver _encode_pointer na octree)
+#define TEXTURE_MAX_TEXELS 0x800000
+
+Object_Layer *object_layer_create(void) {
+    Object_Layer *layer = (Object_Layer*)calloc(1, sizeof(Object_Layer));
+    if (!layer) return NULL;
+    layer->set = instance_set_create();
+    if (!layer->set) {
+        free(layer);
+        return NULL;
+    }
+    return layer;
+}
+
+static bool _is_alive(Object_Layer *layer, long id) {
+    return layer && id >= 0 && (size_t)id < layer->object_count && layer->objects[id].instance >= 0;
+}
+
+// --- VAGAS ---
+
+static size_t _slot_capacity(size_t texels) {
+    return (size_t)((float)texels * OBJECT_SLOT_SLACK) + 1;
+}
+
+static long _slot_new(Object_Layer *layer) {
+    if (layer->slot_count == layer->slot_capacity) {
+        size_t capacity = layer->slot_capacity ? layer->slot_capacity * 2 : 16;
+        Object_Slot *slots = (Object_Slot*)realloc(layer->slots, capacity * sizeof(Object_Slot));
+        if (!slots) return -1;
+        layer->slots = slots;
+        layer->slot_capacity = capacity;
+    }
+    Object_Slot *slot = &layer->slots[layer->slot_count];
+    slot->model = NULL;
+    slot->base = OBJECT_SLOT_NONE;
+    slot->capacity = 0;
+    slot->users = 0;
+    slot->dirty = false;
+    return (long)layer->slot_count++;
+}
+
+// Vaga do modelo: a mesma de outro objeto que já o usa, senão uma entrada livre (o lugar
+// na textura só é resolvido ao gravar, quando o tamanho é conhecido)
+static long _slot_acquire(Object_Layer *layer, Octree *model) {
+    long free_slot = -1;
+    for (size_t i = 0; i < layer->slot_count; i++) {
+        Object_Slot *slot = &layer->slots[i];
+        if (slot->users > 0 && slot->model == model) {
+            slot->users++;
+            return (long)i;
+        }
+        if (slot->users == 0 && free_slot < 0) free_slot = (long)i;
+    }
+    if (free_slot < 0) free_slot = _slot_new(layer);
+    if (free_slot < 0) return -1;
+
+    Object_Slot *slot = &layer->slots[free_slot];
+    slot->model = model;
+    slot->users = 1;
+    slot->dirty = true;
+    return free_slot;
+}
+
+// O último objeto a sair deixa um buraco na textura (base e capacity continuam valendo)
+static void _slot_release(Object_Layer *layer, long index) {
+    Object_Slot *slot = &layer->slots[index];
+    if (--slot->users > 0) return;
+    slot->model = NULL;
+    slot->dirty = false;
+}
+
+// Acha lugar para 'texels' na vaga 'index': um buraco grande o bastante ou o fim da arena.
+// O lugar antigo (pequeno demais) vira buraco.
+static bool _slot_place(Object_Layer *layer, long index, size_t texels, size_t limit) {
+    for (size_t i = 0; i < layer->slot_count; i++) {
+        Object_Slot *hole = &layer->slots[i];
+        if (hole->users > 0 || hole->base == OBJECT_SLOT_NONE || hole->capacity < texels) continue;
+        Object_Slot *slot = &layer->slots[index];
+        size_t base = slot->base, capacity = slot->capacity;
+        slot->base = hole->base;
+        slot->capacity = hole->capacity;
+        hole->base = base;
+        hole->capacity = capacity;
+        return true;
+    }
+
+    size_t capacity = _slot_capacity(texels);
+    if (layer->arena_end == 0 || layer->arena_end + capacity > limit) return false;
+
+    if (layer->slots[index].base != OBJECT_SLOT_NONE) {
+        long hole = -1;
+        for (size_t i = 0; i < layer->slot_count && hole < 0; i++) {
+            if (layer->slots[i].users == 0 && layer->slots[i].base == OBJECT_SLOT_NONE) hole = (long)i;
+        }
+        if (hole < 0) hole = _slot_new(layer);
+        if (hole < 0) return false;
+        layer->slots[hole].base = layer->slots[index].base;
+        layer->slots[hole].capacity = layer->slots[index].capacity;
+    }
+    layer->slots[index].base = layer->arena_end;
+    layer->slots[index].capacity = capacity;
+    layer->arena_end += capacity;
+    return true;
+}
+
+// Raiz de cada instância = vaga do modelo do objeto (-1 enquanto não gravada)
+static void _sync_roots(Object_Layer *layer) {
+    for (size_t id = 0; id < layer->object_count; id++) {
+        Dynamic_Object *object = &layer->objects[id];
+        if (object->instance < 0) continue;
+        Object_Slot *slot = &layer->slots[object->slot];
+        bool written = !slot->dirty && slot->base != OBJECT_SLOT_NONE;
+        layer->set->items[object->instance].gpu_root = written ? (int32_t)slot->base : -1;
+    }
+    layer->set->gpu_dirty = true;
+}
+
+// --- OBJETOS ---
+
+// A camada passa a ser dona de uma referência ao modelo (ver Octree::shares); quem
+// chamou continua dono da sua. Retorna o id do objeto, ou -1 (modelo vazio ou sem memória).
+long object_layer_add(Object_Layer *layer, Octree *model, Voxel_Transform transform) {
+    if (!layer || !model) return -1;
+
+    long id = -1;
+    for (size_t i = 0; i < layer->object_count; i++) {
+        if (layer->objects[i].instance < 0) {
+            id = (long)i;
+            break;
+        }
+    }
+    if (id < 0) {
+        if (layer->object_count == layer->object_capacity) {
+            size_t capacity = layer->object_capacity ? layer->object_capacity * 2 : 16;
+            Dynamic_Object *objects = (Dynamic_Object*)realloc(layer->objects, capacity * sizeof(Dynamic_Object));
+            if (!objects) return -1;
+            layer->objects = objects;
+            layer->object_capacity = capacity;
+        }
+        id = (long)layer->object_count++;
+        layer->objects[id].instance = -1;
+    }
+
+    long slot = _slot_acquire(layer, model);
+    if (slot < 0) return -1;
+    long instance = instance_set_add(layer->set, model, transform);
+    if (instance < 0) {
+        _slot_release(layer, slot);
+        return -1;
+    }
+    layer->objects[id].instance = instance;
+    layer->objects[id].slot = slot;
+    return id;
+}
+
+bool object_layer_move(Object_Layer *layer, long id, Voxel_Transform transform) {
+    if (!_is_alive(layer, id)) return false;
+    return instance_set_move(layer->set, (size_t)layer->objects[id].instance, transform);
+}
+
+// Troca o modelo do objeto (o próximo quadro de uma animação). Passar o modelo atual
+// depois de editá-lo avisa a camada: a caixa é relida e a vaga regravada no próximo
+// object_layer_write_texture. Um modelo vazio é recusado.
+bool object_layer_set_model(Object_Layer *layer, long id, Octree *model) {
+    if (!_is_alive(layer, id) || !model) return false;
+    Dynamic_Object *object = &layer->objects[id];
+
+    if (layer->slots[object->slot].model == model) {
+        if (!instance_set_replace(layer->set, (size_t)object->instance, model)) return false;
+        layer->slots[object->slot].dirty = true;
+        return true;
+    }
+
+    long slot = _slot_acquire(layer, model);
+    if (slot < 0) return false;
+    if (!instance_set_replace(layer->set, (size_t)object->instance, model)) {
+        _slot_release(layer, slot);
+        return false;
+    }
+    _slot_release(layer, object->slot);
+    object->slot = slot;
+    return true;
+}
+
+// O id fica livre para o próximo object_layer_add; os outros não mudam
+bool object_layer_remove(Object_Layer *layer, long id) {
+    if (!_is_alive(layer, id)) return false;
+    Dynamic_Object *object = &layer->objects[id];
+
+    long instance = object->instance;
+    instance_set_remove(layer->set, (size_t)instance);
+    for (size_t i = 0; i < layer->object_count; i++) {
+        if (layer->objects[i].instance > instance) layer->objects[i].instance--;
+    }
+    _slot_release(layer, object->slot);
+    object->instance = -1;
+    return true;
+}
+
+// --- CONSULTAS ---
+
+Voxel_Object object_layer_find(Object_Layer *layer, IVector3 coord) {
+    if (!layer) return _invalid_voxel();
+    return instance_set_find(layer->set, coord);
+}
+
+bool object_layer_ray_cast(Object_Layer *layer, Ray ray, Voxel_Object *hit, float *distance) {
+    return layer && instance_set_ray_cast(layer->set, ray, hit, distance);
+}
+
+// --- GPU ---
+
+// Monta a arena dos objetos depois dos texels que já estão em 'texture': cada modelo numa
+// vaga com folga, e OBJECT_ARENA_RESERVE texels livres no fim. 'texture' é realocada.
+// Sem objetos a textura não muda (o primeiro objeto pede uma textura nova).
+bool object_layer_append_texture(Object_Layer *layer, uint8_t **texture, size_t *arr_size) {
+    if (!layer || !texture || !arr_size) return false;
+
+    // Os buracos somem: tudo é refeito em sequência
+    bool any = false;
+    for (size_t i = 0; i < layer->slot_count; i++) {
+        Object_Slot *slot = &layer->slots[i];
+        slot->base = OBJECT_SLOT_NONE;
+        slot->capacity = 0;
+        if (slot->users > 0) {
+            slot->dirty = true;
+            any = true;
+        }
+    }
+    layer->arena_end = 0;
+    if (!any) {
+        _sync_roots(layer);
+        return true;
+    }
+
+    size_t extra = (*arr_size == 0) ? 1 : 0;
+    size_t total = *arr_size / 4 + extra;
+    for (size_t i = 0; i < layer->slot_count; i++) {
+        Object_Slot *slot = &layer->slots[i];
+        if (slot->users == 0) continue;
+
+        size_t capacity = _slot_capacity(_octree_texel_size(slot->model));
+        if (total + capacity > TEXTURE_MAX_TEXELS) {
+            fprintf(stderr, "Objetos: textura cheia, modelo fica fora da GPU\n");
+            continue;
+        }
+        slot->base = total;
+        slot->capacity = capacity;
+        total += capacity;
+    }
+    layer->arena_end = total;
+    total += std::min((size_t)OBJECT_ARENA_RESERVE, TEXTURE_MAX_TEXELS - total);
+
+    uint8_t *grown = (uint8_t*)realloc(*texture, total * 4);
+    if (!grown) {
+        layer->arena_end = 0;
+        return false;
+    }
+    memset(grown + *arr_size, 0, total * 4 - *arr_size);
+    for (size_t i = 0; i < layer->slot_count; i++) {
+        Object_Slot *slot = &layer->slots[i];
+        if (slot->users == 0 || slot->base == OBJECT_SLOT_NONE) continue;
+        octree_texture_write(slot->model, grown, slot->base);
+        slot->dirty = false;
+    }
+    _sync_roots(layer);
+    *texture = grown;
+    *arr_size = total * 4;
+    return true;
+}
+
+// Grava na textura (a cópia na CPU, com 'texel_capacity' texels) os modelos novos ou
+// editados desde a última chamada, cada um na sua vaga, e entrega a 'fn' cada faixa de
+// texels regravada (o que precisa subir para a GPU). Retorna false se algum modelo não
+// coube: a textura inteira precisa ser refeita (world_texture), o que também reorganiza
+// a arena.
+bool object_layer_write_texture(Object_Layer *layer, uint8_t *texture, size_t texel_capacity,
+                                void (*fn)(void *user, size_t first, size_t count), void *user) {
+    if (!layer) return true;
+
+    size_t limit = std::min(texel_capacity, (size_t)TEXTURE_MAX_TEXELS);
+    bool written = false;
+    for (size_t i = 0; i < layer->slot_count; i++) {
+        if (layer->slots[i].users == 0 || !layer->slots[i].dirty) continue;
+        if (!texture) return false;
+
+        size_t texels = _octree_texel_size(layer->slots[i].model);
+        if (layer->slots[i].base == OBJECT_SLOT_NONE || texels > layer->slots[i].capacity) {
+            if (!_slot_place(layer, (long)i, texels, limit)) return false;
+        }
+        Object_Slot *slot = &layer->slots[i];
+        octree_texture_write(slot->model, texture, slot->base);
+        slot->dirty = false;
+        written = true;
+        if (fn) fn(user, slot->base, texels);
+    }
+    if (written) _sync_roots(layer);
+    return true;
+}
+
+// Mesmo formato de instance_set_gpu_buffer
+int32_t *object_layer_gpu_buffer(Object_Layer *layer, size_t *arr_size) {
+    return instance_set_gpu_buffer(layer ? layer->set : NULL, arr_size);
+}
+
+size_t object_layer_memory_usage(Object_Layer *layer) {
+    if (!layer) return 0;
+    return sizeof(Object_Layer) + layer->object_capacity * sizeof(Dynamic_Object)
+         + layer->slot_capacity * sizeof(Object_Slot) + instance_set_memory_usage(layer->set);
+}
+
+void object_layer_delete(Object_Layer *layer) {
+    if (!layer) return;
+    instance_set_delete(layer->set);
+    free(layer->objects);
+    free(layer->slots);
+    free(layer);
+}
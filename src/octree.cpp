@@ -5,10 +5,16 @@ extern "C" {
 }
 #include <iostream>
 #include <octree.hpp>
+#include <instances.hpp>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <math.h>
+#include <string.h>
 #include <stdio.h> // Certifique-se de que stdio.h está incluído
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #ifndef MIN_HEIGHT
 #define MIN_HEIGHT -1024
 #endif
@@ -21,6 +27,14 @@ extern "C" {
 #define CHILDREN_COUNT 8
 
 #define LEAF_SIZE 2
+// Folha-ponto: os 2 texels da folha + 2 com o deslocamento do voxel a partir do mínimo do nó
+#define POINT_LEAF_SIZE 4
+// Alpha do ponteiro de uma folha-ponto (folhas comuns deixam 0)
+#define POINTER_POINT_FLAG 1
+// Bit 23 no header de um nó interno: depois da lista de ponteiros vêm os 2 texels da média
+// da subárvore (como os de uma folha, mas com a cobertura no alpha do primeiro)
+#define HEADER_FILTER_FLAG 0x800000
+#define FILTER_SIZE LEAF_SIZE
 
 enum pos_in_octree {
     LEFTBOTBACK,
@@ -99,34 +113,35 @@ Octree *octree_create(Octree *parent, IVector3 left_bot_back, IVector3 right_top
     return ot;
 }
 
-Voxel_Object octree_find(Octree *tree, IVector3 coord) {
-    // CORRIGIDO: Lógica invertida
-    if(_coord_is_outside(coord, tree->left_bot_back, tree->right_top_front)) return _invalid_voxel();
-    
-    // (Assumindo que has_voxel existe, esta lógica está incompleta se não existir)
-    if(tree->has_voxel && ivec3_equal_vec(tree->voxel.coord, coord)) return tree->voxel;
-    
-    if(!tree->children) return _invalid_voxel();
-    
-    IVector3 mid_points = ivec3_scalar_div(ivec3_add(tree->left_bot_back, tree->right_top_front), 2);
-    int pos = _get_pos_in_octree(coord, mid_points);
-    Octree *ref = tree->children[pos];
-    
-    while(true) {
-        if(!ref) return _invalid_voxel(); // Checa se o filho é nulo
+static IVector3 _node_mid(Octree *node) {
+    IVector3 min = node->left_bot_back, max = node->right_top_front;
+    return {{min.x + (max.x - min.x) / 2, min.y + (max.y - min.y) / 2, min.z + (max.z - min.z) / 2}};
+}
 
-        // CORRIGIDO: Lógica invertida
-        if(_coord_is_outside(coord, ref->left_bot_back, ref->right_top_front)) return _invalid_voxel();
-        
-        if(ref->has_voxel && ivec3_equal_vec(ref->voxel.coord, coord)) return ref->voxel;
-        
-        if(!ref->children) return _invalid_voxel();
-        
-        mid_points = ivec3_scalar_div(ivec3_add(ref->left_bot_back, ref->right_top_front), 2);
-        pos = _get_pos_in_octree(coord, mid_points);
-        ref = ref->children[pos];
+Voxel_Object octree_find(Octree *tree, IVector3 coord) {
+    if(!tree || _coord_is_outside(coord, tree->left_bot_back, tree->right_top_front)) return _invalid_voxel();
+
+    // Dentro de uma subárvore compartilhada a busca continua em coordenadas locais
+    Octree *ref = tree;
+    IVector3 local = coord;
+    while(ref->children || ref->instance) {
+        if(ref->instance) {
+            local = ivec3_sub(local, ref->left_bot_back);
+            ref = ref->instance;
+            continue;
+        }
+        ref = ref->children[_get_pos_in_octree(local, _node_mid(ref))];
+        if(!ref) return _invalid_voxel();
     }
-    return _invalid_voxel();
+    if(!ref->has_voxel) return _invalid_voxel();
+
+    // Ponto: só a coordenada guardada é sólida
+    if(ref->is_point && !ivec3_equal_vec(ref->voxel.coord, local)) return _invalid_voxel();
+
+    // Volume fundido: a caixa inteira é do mesmo material (a coordenada guardada é a base)
+    Voxel_Object voxel = ref->voxel;
+    voxel.coord = coord;
+    return voxel;
 }
 
 int _create_children(Octree *tree, IVector3 mid_points_ignoradas) {
@@ -171,19 +186,17 @@ int _create_children(Octree *tree, IVector3 mid_points_ignoradas) {
         tree->children[i]->voxel = _invalid_voxel(); 
     }
     
-    int pos = _get_pos_in_octree(tree->voxel.coord, mid); 
-    
-    tree->children[pos]->voxel = tree->voxel;
-    tree->children[pos]->has_voxel = true; 
+    // O conteúdo antigo do nó (volume ou ponto) é redistribuído por _split_node
     tree->voxel = _invalid_voxel();
     tree->has_voxel = false; 
+    tree->is_point = false;
     
     return 0;
 }
 
-// Verifica se um nó é uma folha (tem voxel e não tem filhos)
+// Verifica se um nó é uma folha sólida (tem voxel, não tem filhos e não é um ponto)
 bool _is_leaf(Octree *node) {
-    return node && node->has_voxel && !node->children;
+    return node && node->has_voxel && !node->children && !node->is_point;
 }
 
 // Verifica se dois nós são visivelmente idênticos
@@ -199,6 +212,48 @@ bool _nodes_are_identical(Octree *a, Octree *b) {
            || (a->voxel.coord.y <= MIN_HEIGHT && b->voxel.coord.y <= MIN_HEIGHT);
 }
 
+// Mesmo material (a coordenada não importa)
+static bool _same_material(Voxel_Object a, Voxel_Object b) {
+    return a.color == b.color
+        && a.voxel.refraction == b.voxel.refraction
+        && a.voxel.illumination == b.voxel.illumination;
+}
+
+// Ar: sem voxel, sem filhos e sem subárvore compartilhada
+static bool _is_empty(Octree *node) {
+    return !node->children && !node->has_voxel && !node->instance;
+}
+
+// Copia 'src' para 'dst' (sem filhos) deslocando limites e coordenadas por 'offset'.
+// Instâncias aninhadas continuam compartilhadas (só ganham mais um dono).
+static void _copy_shifted(Octree *dst, Octree *src, IVector3 offset) {
+    dst->voxel = src->voxel;
+    if (src->has_voxel) dst->voxel.coord = ivec3_add(src->voxel.coord, offset);
+    dst->has_voxel = src->has_voxel;
+    dst->is_point = src->is_point;
+    dst->dirty = src->dirty;
+    dst->instance = src->instance;
+    if (dst->instance) dst->instance->shares++;
+    if (!src->children) return;
+
+    dst->children = (Octree**)malloc(sizeof(Octree*) * CHILDREN_COUNT);
+    for(int i = 0; i < CHILDREN_COUNT; i++) {
+        Octree *child = src->children[i];
+        dst->children[i] = octree_create(dst, ivec3_add(child->left_bot_back, offset), ivec3_add(child->right_top_front, offset));
+        _copy_shifted(dst->children[i], child, offset);
+    }
+}
+
+// Copy-on-write: antes de editar dentro de uma instância o nó ganha a própria cópia
+// da subárvore (em coordenadas do mundo) e solta a compartilhada
+static void _expand_instance(Octree *node) {
+    Octree *shared = node->instance;
+    node->instance = NULL;
+    _copy_shifted(node, shared, node->left_bot_back);
+    node->dirty = true;
+    octree_delete(shared);
+}
+
 // Divide um nó sólido em 8 filhos sólidos idênticos
 int _split_node(Octree *tree) {
     if (tree->children) return 0; 
@@ -206,6 +261,7 @@ int _split_node(Octree *tree) {
     // Backup dos dados
     Voxel_Object originalData = tree->voxel;
     bool wasSolid = tree->has_voxel;
+    bool wasPoint = tree->is_point;
 
     IVector3 min = tree->left_bot_back;
     IVector3 max = tree->right_top_front;
@@ -219,12 +275,8 @@ int _split_node(Octree *tree) {
     if (_create_children(tree, mid) != 0) return -1;
 
     if (wasSolid) {
-        // --- HEURÍSTICA DE DIFERENCIAÇÃO ---
-        
-        // Verifica se a coordenada do voxel coincide com a base do nó.
-        // Em um nó Merged (sólido total), normalizamos a coord para a base.
-        // Em um nó Lazy (ponto flutuante), a coord é a posição original do bloco.
-        bool isVolume = ivec3_equal_vec(originalData.coord, tree->left_bot_back);
+        // Volume fundido (sólido total) ou ponto (lazy insert, coord = posição original)
+        bool isVolume = !wasPoint;
 
         if (isVolume) {
             // CASO A: O nó era um VOLUME SÓLIDO (ex: parede mergeada).
@@ -239,11 +291,15 @@ int _split_node(Octree *tree) {
         } else {
             // CASO B: O nó era um PONTO ISOLADO (Lazy Insert).
             // Apenas movemos o voxel para o sub-nó correto, os outros 7 ficam vazios (Ar).
+            // O filho continua sendo um ponto, a não ser que já seja 1³.
             
             int pos = _get_pos_in_octree(originalData.coord, mid);
+            Octree *child = tree->children[pos];
+            IVector3 childSize = _get_node_size(child);
             
-            tree->children[pos]->voxel = originalData;
-            tree->children[pos]->has_voxel = true;
+            child->voxel = originalData;
+            child->has_voxel = true;
+            child->is_point = childSize.x > 1 || childSize.y > 1 || childSize.z > 1;
             // Mantemos a coordenada original exata!
         }
         
@@ -288,6 +344,18 @@ void octree_insert(Octree *tree, Voxel_Object voxel) {
     if (!tree) return;
     if (_coord_is_outside(voxel.coord, tree->left_bot_back, tree->right_top_front)) return;
 
+    if (tree->instance) {
+        Voxel_Object current = octree_find(tree, voxel.coord);
+        if (current.coord.y != MIN_HEIGHT && _same_material(current, voxel)) return;
+        _expand_instance(tree);
+    }
+
+    // Volume fundido do mesmo material: o voxel já está lá, nada muda
+    if (_is_leaf(tree) && _same_material(tree->voxel, voxel)) return;
+
+    // Fusões ficam para octree_compact, que só visita os caminhos marcados aqui
+    tree->dirty = true;
+
     IVector3 size = ivec3_sub(tree->right_top_front, tree->left_bot_back);
 
     // --- CASO BASE: Tamanho 1x1x1 ---
@@ -295,9 +363,22 @@ void octree_insert(Octree *tree, Voxel_Object voxel) {
     if (size.x <= 1 && size.y <= 1 && size.z <= 1) {
         tree->voxel = voxel;
         tree->has_voxel = true;
+        tree->is_point = false;
         return;
     }
 
+    // --- LAZY INSERT (compressão de caminho) ---
+    // Nó vazio: guarda o voxel aqui mesmo como ponto, sem descer até 1³.
+    // A raiz nunca vira ponto (o shader sempre começa a busca num nó interno).
+    if (!tree->children && tree->parent) {
+        if (!tree->has_voxel || (tree->is_point && ivec3_equal_vec(tree->voxel.coord, voxel.coord))) {
+            tree->voxel = voxel;
+            tree->has_voxel = true;
+            tree->is_point = true;
+            return;
+        }
+    }
+
     // --- SPLIT DOWN (A CORREÇÃO) ---
     // Se este nó não tem filhos, mas precisamos descer mais (porque size > 1),
     // precisamos criar os filhos.
@@ -315,11 +396,6 @@ void octree_insert(Octree *tree, Voxel_Object voxel) {
     
     int pos = _get_pos_in_octree(voxel.coord, mid);
     octree_insert(tree->children[pos], voxel);
-
-    // --- MERGE UP (OTIMIZAÇÃO) ---
-    // Na volta, tentamos juntar de novo, caso tenhamos preenchido um buraco
-    // com o mesmo material que já existia ao redor.
-    _try_merge_children(tree);
 }
 
 // NOTA: Esta função e octree_traverse são complexas, 
@@ -358,10 +434,28 @@ Octree *_get_neighbour(Octree *node, IVector3 dir) {
 float fmax_fl(float a, float b) { return a > b ? a : b; }
 float fmin_fl(float a, float b) { return a < b ? a : b; }
 
+// Dentro da caixa [min, max) de um nó-ponto, encolhe a caixa até o maior sub-nó
+// (na mesma subdivisão da árvore) que contém 'pos' mas não o voxel 'point'
+static void _point_empty_box(IVector3 pos, IVector3 point, IVector3 *min, IVector3 *max) {
+    while (true) {
+        IVector3 mid;
+        mid.x = min->x + (max->x - min->x) / 2;
+        mid.y = min->y + (max->y - min->y) / 2;
+        mid.z = min->z + (max->z - min->z) / 2;
+
+        int childIdx = _get_pos_in_octree(pos, mid);
+        if (childIdx & 4) min->x = mid.x; else max->x = mid.x;
+        if (childIdx & 2) min->y = mid.y; else max->y = mid.y;
+        if (childIdx & 1) min->z = mid.z; else max->z = mid.z;
+
+        if (childIdx != _get_pos_in_octree(point, mid)) return;
+    }
+}
+
 // --- Core Recursive Traversal ---
 // Busca um nó folha contendo a coordenada global 'pos'
 // Atualiza nodeMin e nodeMax com os limites desse nó
-Octree* _octree_find_leaf(Octree *root, IVector3 pos, IVector3 *nodeMin, IVector3 *nodeMax) {
+Octree* _octree_find_leaf(Octree *root, IVector3 pos, IVector3 *nodeMin, IVector3 *nodeMax, int *fetches) {
     Octree *curr = root;
     IVector3 min = root->left_bot_back;
     IVector3 max = root->right_top_front;
@@ -369,7 +463,19 @@ Octree* _octree_find_leaf(Octree *root, IVector3 pos, IVector3 *nodeMin, IVector
     // Se estiver fora do mundo, retorna NULL
     if (_coord_is_outside(pos, min, max)) return NULL;
 
-    while (curr->children != NULL) {
+    // Deslocamento das subárvores compartilhadas atravessadas. A subdivisão delas é a mesma
+    // do nó que as referencia, então min/max continuam valendo em coordenadas do mundo.
+    IVector3 origin = {{0, 0, 0}};
+
+    while (curr->children != NULL || curr->instance) {
+        // Na textura o ponteiro já leva direto à subárvore: não custa uma leitura a mais
+        if (curr->instance) {
+            origin = ivec3_add(origin, curr->left_bot_back);
+            curr = curr->instance;
+            continue;
+        }
+        if (fetches) (*fetches)++;
+
         // Calcula ponto médio
         IVector3 mid;
         mid.x = min.x + (max.x - min.x) / 2;
@@ -396,13 +502,52 @@ Octree* _octree_find_leaf(Octree *root, IVector3 pos, IVector3 *nodeMin, IVector
         }
     }
 
+    // Ponto: a cadeia comprimida é percorrida só com aritmética (sem visitar nós),
+    // descendo até o nível em que 'pos' e o voxel caem em filhos diferentes.
+    // Esse filho é um vazio virtual que o raio atravessa de uma vez.
+    if (curr->has_voxel && curr->is_point) {
+        IVector3 point = ivec3_add(curr->voxel.coord, origin);
+        if (ivec3_equal_vec(point, pos)) {
+            *nodeMin = point;
+            *nodeMax = ivec3_scalar_add(point, 1);
+            return curr;
+        }
+        _point_empty_box(pos, point, &min, &max);
+        *nodeMin = min;
+        *nodeMax = max;
+        return NULL;
+    }
+
     // Chegamos numa folha
     *nodeMin = min;
     *nodeMax = max;
     return curr;
 }
 
+static Octree* _ray_march(Octree *root, Ray ray, Vector3 worldMin, Vector3 worldMax, Ray_Stats *stats, IVector3 *hitCell);
+
 Octree* octree_ray_cast(Octree *root, Ray ray, Vector3 worldMin, Vector3 worldMax) {
+    return _ray_march(root, ray, worldMin, worldMax, NULL, NULL);
+}
+
+Octree* octree_ray_cast_stats(Octree *root, Ray ray, Vector3 worldMin, Vector3 worldMax, Ray_Stats *stats) {
+    return _ray_march(root, ray, worldMin, worldMax, stats, NULL);
+}
+
+// Como octree_ray_cast, mas devolve o voxel com a célula atingida: o nó de um volume
+// fundido guarda só a base do bloco, e o de uma instância guarda coordenadas locais
+bool octree_ray_cast_voxel(Octree *root, Ray ray, Vector3 worldMin, Vector3 worldMax, Voxel_Object *hit) {
+    IVector3 cell;
+    Octree *node = _ray_march(root, ray, worldMin, worldMax, NULL, &cell);
+    if (!node || !node->has_voxel) return false;
+    if (hit) {
+        *hit = node->voxel;
+        hit->coord = cell;
+    }
+    return true;
+}
+
+static Octree* _ray_march(Octree *root, Ray ray, Vector3 worldMin, Vector3 worldMax, Ray_Stats *stats, IVector3 *hitCell) {
     // 1. Setup inicial
     Vector3 rayPos = ray.origin;
     Vector3 rayDir = ray.direction;
@@ -427,11 +572,14 @@ Octree* octree_ray_cast(Octree *root, Ray ray, Vector3 worldMin, Vector3 worldMa
     int maxSteps = 512; 
 
     for (int i = 0; i < maxSteps; i++) {
+        if (stats) stats->steps++;
+
         // Busca o nó atual na árvore e seus limites
-        currNode = _octree_find_leaf(root, mapPos, &nodeMin, &nodeMax);
+        currNode = _octree_find_leaf(root, mapPos, &nodeMin, &nodeMax, stats ? &stats->fetches : NULL);
 
         // Se encontrou um nó válido COM voxel e Y válido, é um HIT!
         if (currNode && currNode->has_voxel && currNode->voxel.coord.y > MIN_HEIGHT) {
+            if (hitCell) *hitCell = mapPos;
             return currNode;
         }
 
@@ -490,7 +638,7 @@ uint8_t _get_child_mask(Octree *node) {
     uint8_t mask = 0;
     for (int i = 0; i < 8; i++) {
         // Um filho existe se não for NULL e (tiver voxel OU tiver netos)
-        if (node->children[i] && (node->children[i]->has_voxel || node->children[i]->children)) {
+        if (node->children[i] && !_is_empty(node->children[i])) {
             mask |= (1 << i);
         }
     }
@@ -521,20 +669,27 @@ int _count_set_bits(uint8_t n) {
 // --- FIXED: Octree Texel Size ---
 // Calculates exact size: 
 // 1 texel (Header) + N texels (Pointers) + Recursive Children
-size_t _octree_texel_size(Octree *tree) {
+// Subárvores compartilhadas entram uma vez só ('seen'): a textura vira um DAG.
+static size_t _texel_size(Octree *tree, std::unordered_set<Octree*> *seen) {
     if(!tree) return 0;
+
+    if(tree->instance) {
+        if(!seen->insert(tree->instance).second) return 0;
+        return _texel_size(tree->instance, seen);
+    }
     
-    // CASO BASE: Folha com dados (2 texels)
+    // CASO BASE: Folha com dados (2 texels, 4 se for ponto)
     if(!tree->children) {
-        return tree->has_voxel ? LEAF_SIZE : 0;
+        if (!tree->has_voxel) return 0;
+        return tree->is_point ? POINT_LEAF_SIZE : LEAF_SIZE;
     }
     
     // CASO NÓ INTERNO:
     uint8_t mask = _get_child_mask(tree);
     if (mask == 0) return 0; // Se não tem filhos válidos, tamanho é 0
     
-    // 1. Header do próprio nó
-    size_t total = 1; 
+    // 1. Header do próprio nó (e a média da subárvore logo depois dos ponteiros)
+    size_t total = 1 + FILTER_SIZE;
     
     // 2. Ponteiros para os filhos (Packed/Espremidos)
     // Se a máscara for 00000101, temos 2 filhos, logo 2 texels de ponteiro.
@@ -544,13 +699,18 @@ size_t _octree_texel_size(Octree *tree) {
     for(int i = 0; i < CHILDREN_COUNT; i++) {
         // Verifica se o bit 'i' está setado
         if ((mask >> i) & 1) {
-            total += _octree_texel_size(tree->children[i]);
+            total += _texel_size(tree->children[i], seen);
         }
     }
     
     return total;
 }
 
+size_t _octree_texel_size(Octree *tree) {
+    std::unordered_set<Octree*> seen;
+    return _texel_size(tree, &seen);
+}
+
 // Codifica um índice linear de até 16 Milhões (24 bits) nos canais R, G, B
 // Usa o bit mais significativo (Bit 23 do Blue) como flag "IS_LEAF_BLOCK"
 void _encode_pointer(size_t linear_index, bool is_leaf_block, uint8_t *out_voxel) {
@@ -569,39 +729,174 @@ void _encode_pointer(size_t linear_index, bool is_leaf_block, uint8_t *out_voxel
     // O Alpha (out_voxel[3]) é controlado pela função principal (Máscara ou Flag)
 }
 
+// Os 2 texels de dados de uma folha (8 bytes em 'out')
+void octree_leaf_texels(Voxel_Object voxel, uint8_t *out) {
+    // Texel 1: Cor + Marker
+    out[0] = get_red_rgba(voxel.color);
+    out[1] = get_green_rgba(voxel.color);
+    out[2] = get_blue_rgba(voxel.color);
+    out[3] = 255; // Marcador: Sou dados de folha
+
+    // Texel 2: Propriedades Físicas
+    out[4] = (uint8_t)(voxel.voxel.refraction * 85.0f); // Scale correction
+    out[5] = (uint8_t)(voxel.voxel.illumination * 255.0f);
+    out[6] = (uint8_t)(voxel.voxel.k * 255.0f);
+    out[7] = get_alpha_rgba(voxel.color);
+}
+
+// Inversa aproximada de octree_leaf_texels (as propriedades voltam quantizadas)
+Voxel_Object octree_leaf_voxel(const uint8_t *texels) {
+    Voxel_Object voxel = {0};
+    voxel.color = make_color_rgba(texels[0], texels[1], texels[2], texels[7]);
+    voxel.voxel.refraction = texels[4] / 85.0f;
+    voxel.voxel.illumination = texels[5] / 255.0f;
+    voxel.voxel.k = texels[6] / 255.0f;
+    return voxel;
+}
+
+// Soma de uma subárvore para a média dos nós internos: volume sólido (em voxels) para a
+// cobertura, cores ponderadas pela área das faces expostas ao ar (o interior de um morro
+// não aparece de longe; sem faces expostas vale o volume) e o material de mais volume
+typedef struct _texel_filter {
+    double volume, red, green, blue, alpha;
+    double surface, surface_red, surface_green, surface_blue, surface_alpha;
+    Voxel_Object material;
+    double material_volume;
+} Texel_Filter;
+
+// Onde uma subárvore compartilhada já foi escrita, e a soma dela
+typedef struct _texel_shared {
+    size_t addr;
+    Texel_Filter filter;
+} Texel_Shared;
+
+// Área das faces da folha com ar do outro lado, sondando o vizinho no centro de cada face.
+// Fora de 'root' conta como coberto: na borda de um chunk o vizinho é desconhecido.
+static double _exposed_area(Octree *root, Octree *leaf) {
+    IVector3 min = leaf->is_point ? leaf->voxel.coord : leaf->left_bot_back;
+    IVector3 size = leaf->is_point ? IVector3{{1, 1, 1}} : _get_node_size(leaf);
+    int lo[3] = {min.x, min.y, min.z}, side[3] = {size.x, size.y, size.z};
+    double area = 0;
+    for (int axis = 0; axis < 3; axis++)
+    for (int high = 0; high < 2; high++) {
+        int probe[3] = {lo[0] + side[0] / 2, lo[1] + side[1] / 2, lo[2] + side[2] / 2};
+        probe[axis] = high ? lo[axis] + side[axis] : lo[axis] - 1;
+        IVector3 coord = {{probe[0], probe[1], probe[2]}};
+        if (_coord_is_outside(coord, root->left_bot_back, root->right_top_front)) continue;
+        // O vizinho quase sempre está sob um ancestral próximo: sobe até ele e desce dali
+        Octree *from = leaf;
+        while (from != root && from->parent && _coord_is_outside(coord, from->left_bot_back, from->right_top_front)) from = from->parent;
+        if (_coord_is_outside(coord, from->left_bot_back, from->right_top_front)) from = root;
+        if (octree_find(from, coord).coord.y != MIN_HEIGHT) continue;
+        area += (double)side[(axis + 1) % 3] * side[(axis + 2) % 3];
+    }
+    return area;
+}
+
+static Texel_Filter _leaf_filter(Octree *root, Octree *leaf) {
+    Texel_Filter filter = {0};
+    IVector3 size = _get_node_size(leaf);
+    ColorRGBA color = leaf->voxel.color;
+    filter.volume = leaf->is_point ? 1.0 : (double)size.x * size.y * size.z;
+    filter.red = get_red_rgba(color) * filter.volume;
+    filter.green = get_green_rgba(color) * filter.volume;
+    filter.blue = get_blue_rgba(color) * filter.volume;
+    filter.alpha = get_alpha_rgba(color) * filter.volume;
+    filter.surface = _exposed_area(root, leaf);
+    filter.surface_red = get_red_rgba(color) * filter.surface;
+    filter.surface_green = get_green_rgba(color) * filter.surface;
+    filter.surface_blue = get_blue_rgba(color) * filter.surface;
+    filter.surface_alpha = get_alpha_rgba(color) * filter.surface;
+    filter.material = leaf->voxel;
+    filter.material_volume = filter.volume;
+    return filter;
+}
+
+// Junta as somas dos filhos; o material é o de mais volume entre os dominantes deles
+static Texel_Filter _merge_filters(const Texel_Filter *children, int count) {
+    Texel_Filter filter = {0};
+    filter.material = _invalid_voxel();
+    for (int i = 0; i < count; i++) {
+        filter.volume += children[i].volume;
+        filter.red += children[i].red;
+        filter.green += children[i].green;
+        filter.blue += children[i].blue;
+        filter.alpha += children[i].alpha;
+        filter.surface += children[i].surface;
+        filter.surface_red += children[i].surface_red;
+        filter.surface_green += children[i].surface_green;
+        filter.surface_blue += children[i].surface_blue;
+        filter.surface_alpha += children[i].surface_alpha;
+        double volume = 0;
+        for (int j = 0; j < count; j++) {
+            if (voxel_compare(children[j].material.voxel, children[i].material.voxel)) volume += children[j].material_volume;
+        }
+        if (volume > filter.material_volume) {
+            filter.material = children[i].material;
+            filter.material_volume = volume;
+        }
+    }
+    return filter;
+}
+
+// Os 2 texels da média: cor e propriedades como numa folha, cobertura (0-255) no alpha
+// do primeiro no lugar do marcador
+static void _write_filter(const Texel_Filter *filter, IVector3 size, uint8_t *out) {
+    Voxel_Object voxel = filter->material;
+    if (filter->surface > 0) {
+        double surface = filter->surface;
+        voxel.color = make_color_rgba((uint8_t)(filter->surface_red / surface + 0.5), (uint8_t)(filter->surface_green / surface + 0.5),
+                                      (uint8_t)(filter->surface_blue / surface + 0.5), (uint8_t)(filter->surface_alpha / surface + 0.5));
+    } else {
+        double volume = filter->volume > 0 ? filter->volume : 1.0;
+        voxel.color = make_color_rgba((uint8_t)(filter->red / volume + 0.5), (uint8_t)(filter->green / volume + 0.5),
+                                      (uint8_t)(filter->blue / volume + 0.5), (uint8_t)(filter->alpha / volume + 0.5));
+    }
+    octree_leaf_texels(voxel, out);
+    double coverage = filter->volume / ((double)size.x * size.y * size.z);
+    out[3] = (uint8_t)(fmin(coverage, 1.0) * 255.0 + 0.5);
+}
+
 // Esta função usa a lógica SVO correta (nó pai -> bloco de 8 ponteiros -> filhos)
-void _transform_node_to_texture(Octree *node, 
-                                uint8_t *texture, 
-                                size_t *next_free_block, 
-                                size_t tex_dim) 
+// 'shared' guarda onde cada subárvore compartilhada já foi escrita: os ponteiros são
+// absolutos, então as outras referências apontam para a mesma cópia.
+// Retorna a soma da subárvore, que vira a média do nó pai. 'root' é a raiz onde as faces
+// das folhas sondam os vizinhos (a da árvore, ou a da subárvore compartilhada).
+static Texel_Filter _transform_node_to_texture(Octree *node, 
+                                               Octree *root,
+                                               uint8_t *texture, 
+                                               size_t *next_free_block, 
+                                               size_t tex_dim,
+                                               std::unordered_map<Octree*, Texel_Shared> *shared) 
 {
-    if (!node) return;
+    Texel_Filter filter = {0};
+    if (!node) return filter;
 
     // --- A. SOU FOLHA? (Escreve Dados) ---
     if (node->children == NULL) {
-        if (!node->has_voxel) return;
+        if (!node->has_voxel) return filter;
 
         size_t base_byte = (*next_free_block) * 4;
-        
-        // Texel 1: Cor + Marker
-        texture[base_byte + 0] = get_red_rgba(node->voxel.color);
-        texture[base_byte + 1] = get_green_rgba(node->voxel.color);
-        texture[base_byte + 2] = get_blue_rgba(node->voxel.color);
-        texture[base_byte + 3] = 255; // Marcador: Sou dados de folha
-        
-        // Texel 2: Propriedades Físicas
-        texture[base_byte + 4] = (uint8_t)(node->voxel.voxel.refraction * 85.0f); // Scale correction
-        texture[base_byte + 5] = (uint8_t)(node->voxel.voxel.illumination * 255.0f);
-        texture[base_byte + 6] = (uint8_t)(node->voxel.voxel.k * 255.0f);
-        texture[base_byte + 7] = get_alpha_rgba(node->voxel.color);
-        
+        octree_leaf_texels(node->voxel, &texture[base_byte]);
         (*next_free_block) += LEAF_SIZE; // Incrementa 2
-        return;
+
+        // Texels 3 e 4 (só pontos): deslocamento do voxel a partir do mínimo do nó, 16 bits por eixo
+        if (node->is_point) {
+            IVector3 offset = ivec3_sub(node->voxel.coord, node->left_bot_back);
+            texture[base_byte + 8]  = (uint8_t)(offset.x & 0xFF);
+            texture[base_byte + 9]  = (uint8_t)((offset.x >> 8) & 0xFF);
+            texture[base_byte + 10] = (uint8_t)(offset.y & 0xFF);
+            texture[base_byte + 11] = (uint8_t)((offset.y >> 8) & 0xFF);
+            texture[base_byte + 12] = (uint8_t)(offset.z & 0xFF);
+            texture[base_byte + 13] = (uint8_t)((offset.z >> 8) & 0xFF);
+            (*next_free_block) += POINT_LEAF_SIZE - LEAF_SIZE;
+        }
+        return _leaf_filter(root, node);
     }
 
     // --- B. SOU NÓ INTERNO (Escreve Ponteiros) ---
     uint8_t mask = _get_child_mask(node);
-    if (mask == 0) return;
+    if (mask == 0) return filter;
 
     // 1. Escreve MEU Header
     size_t header_pos = *next_free_block;
@@ -610,48 +905,82 @@ void _transform_node_to_texture(Octree *node,
     // Incrementa valor apontado (CORREÇÃO DE PRECEDÊNCIA)
     (*next_free_block)++; 
 
-    // 2. Reserva espaço CONTÍGUO para os ponteiros dos filhos
+    // 2. Reserva espaço CONTÍGUO para os ponteiros dos filhos (e para a média, depois deles)
     int active_children_count = _count_set_bits(mask);
     size_t pointers_start_idx = *next_free_block;
+    size_t filter_byte = (pointers_start_idx + active_children_count) * 4;
     
     // Já avança o "cursor" global para depois dos meus ponteiros
     // para que os filhos sejam escritos depois desta lista.
-    (*next_free_block) += active_children_count;
+    (*next_free_block) += active_children_count + FILTER_SIZE;
 
     // Preenche o Header
     // Codifica ponteiro para o INÍCIO da lista de filhos
-    // Nota: is_leaf_block no header geralmente não é útil se misturado, 
-    // deixamos false aqui e setamos nos ponteiros individuais.
-    _encode_pointer(pointers_start_idx, false, &texture[header_byte]);
+    // O bit 23 (a flag de folha nos ponteiros) marca aqui que o nó tem a média
+    _encode_pointer(pointers_start_idx, true, &texture[header_byte]);
     texture[header_byte + 3] = mask; // Alpha = Máscara de filhos
 
     // 3. Processa e Escreve Filhos Recursivamente
     int current_ptr_offset = 0; // Indice LOCAL na lista de ponteiros (0 a 7 mas compactado)
+    Texel_Filter children[CHILDREN_COUNT];
 
     for (int i = 0; i < 8; ++i) {
         if ((mask >> i) & 1) {
+            // Instância: o ponteiro vai para a raiz da subárvore compartilhada
+            Octree *child = node->children[i]->instance ? node->children[i]->instance : node->children[i];
+
             // Onde este filho VAI ser escrito na textura (futuro)
             size_t child_future_addr = *next_free_block;
+            bool already_written = false;
+            if (node->children[i]->instance) {
+                auto it = shared->find(child);
+                if (it != shared->end()) {
+                    child_future_addr = it->second.addr;
+                    children[current_ptr_offset] = it->second.filter;
+                    already_written = true;
+                } else {
+                    (*shared)[child].addr = child_future_addr;
+                }
+            }
             
             // Onde eu devo escrever o ponteiro AGORA
             size_t ptr_slot_byte = (pointers_start_idx + current_ptr_offset) * 4;
 
             // Verifica se ESSE filho específico é folha
-            bool child_is_leaf = (node->children[i]->children == NULL && 
-                      node->children[i]->has_voxel);
+            bool child_is_leaf = (child->children == NULL && child->has_voxel);
 
             // Escreve o ponteiro na lista reservada
             _encode_pointer(child_future_addr, child_is_leaf, &texture[ptr_slot_byte]);
             
-            // Texture[ptr_slot_byte + 3] (Alpha do ponteiro) pode ser usado 
-            // para info extra se necessário, ou deixado 0.
+            // Alpha do ponteiro: marca folhas-ponto (o shader lê o deslocamento nos texels extras)
+            texture[ptr_slot_byte + 3] = (child_is_leaf && child->is_point) ? POINTER_POINT_FLAG : 0;
 
             // Recurso: Vai lá no final e escreve os dados do filho
-            _transform_node_to_texture(node->children[i], texture, next_free_block, tex_dim);
+            if (!already_written) {
+                Octree *child_root = node->children[i]->instance ? child : root;
+                children[current_ptr_offset] = _transform_node_to_texture(child, child_root, texture, next_free_block, tex_dim, shared);
+                if (node->children[i]->instance) (*shared)[child].filter = children[current_ptr_offset];
+            }
             
             current_ptr_offset++;
         }
     }
+
+    filter = _merge_filters(children, active_children_count);
+    _write_filter(&filter, _get_node_size(node), &texture[filter_byte]);
+    return filter;
+}
+
+// Escreve a árvore em 'texture' a partir do texel 'base'. Os ponteiros são absolutos,
+// então várias árvores podem dividir a mesma textura (ver instance_set_append_texture).
+// 'texture' precisa de _octree_texel_size(tree) texels livres a partir de 'base'.
+size_t octree_texture_write(Octree *tree, uint8_t *texture, size_t base) {
+    if (!tree || !texture) return 0;
+
+    size_t next_free_block = base;
+    std::unordered_map<Octree*, Texel_Shared> shared;
+    _transform_node_to_texture(tree, tree, texture, &next_free_block, 0, &shared);
+    return next_free_block - base;
 }
 
 uint8_t *octree_texture(Octree *tree, size_t *arr_size, size_t tex_dim) {
@@ -668,25 +997,189 @@ uint8_t *octree_texture(Octree *tree, size_t *arr_size, size_t tex_dim) {
     uint8_t *texture = (uint8_t*)calloc(voxel_count * 4, sizeof(uint8_t));
     if(!texture) return NULL;
     
-    size_t next_free_block = 0;
-    
-    _transform_node_to_texture(tree, texture, &next_free_block, tex_dim);
+    size_t used = octree_texture_write(tree, texture, 0);
     
     // DEBUG: Verifica se usamos exatamente o espaço calculado
-    if (next_free_block != voxel_count) {
+    if (used != voxel_count) {
         fprintf(stderr, "WARNING: Size mismatch! Calculated: %zu, Used: %zu\n", 
-                voxel_count, next_free_block);
+                voxel_count, used);
     }
 
     return texture;
 }
 
+static uint32_t _texel_pointer(const uint8_t *texel) {
+    return (uint32_t)texel[0] | ((uint32_t)texel[1] << 8) | ((uint32_t)texel[2] << 16);
+}
+
+// Copia 'texel_count' texels escritos a partir do texel 0 (octree_texture_write com base 0,
+// ou os de um .svo) para 'texture' a partir de 'base', somando 'base' aos ponteiros. 'root'
+// é o texel-ponteiro da raiz (ver octree_from_texture); ela fica em 'base'. Retorna os
+// texels copiados (0 se estiverem malformados ou passarem dos 23 bits dos ponteiros).
+size_t octree_texture_copy(const uint8_t *texels, size_t texel_count, const uint8_t *root, uint8_t *texture, size_t base) {
+    if (!texels || !root || !texture || texel_count == 0 || base + texel_count > 0x800000) return 0;
+    uint8_t *out = texture + base * 4;
+    memcpy(out, texels, texel_count * 4);
+    if (_texel_pointer(root) & 0x800000) return texel_count;
+
+    // Só os nós internos têm ponteiros; os compartilhados (DAG) são corrigidos uma vez só
+    std::vector<bool> seen(texel_count, false);
+    std::vector<uint32_t> stack(1, 0);
+    seen[0] = true;
+    while (!stack.empty()) {
+        uint8_t *header = out + (size_t)stack.back() * 4;
+        stack.pop_back();
+        uint32_t start = _texel_pointer(header) & 0x7FFFFF;
+        bool filtered = (_texel_pointer(header) & HEADER_FILTER_FLAG) != 0;
+        int count = _count_set_bits(header[3]);
+        if ((size_t)start + count + (filtered ? FILTER_SIZE : 0) > texel_count) return 0;
+        _encode_pointer(start + base, filtered, header);
+        for (int i = 0; i < count; i++) {
+            uint8_t *pointer = out + ((size_t)start + i) * 4;
+            uint32_t value = _texel_pointer(pointer), child = value & 0x7FFFFF;
+            bool is_leaf = (value & 0x800000) != 0;
+            if (child >= texel_count) return 0;
+            _encode_pointer(child + base, is_leaf, pointer);
+            if (is_leaf || seen[child]) continue;
+            seen[child] = true;
+            stack.push_back(child);
+        }
+    }
+    return texel_count;
+}
+
+// --- TEXTURA -> ÁRVORE ---
+
+typedef struct _texture_reader {
+    const uint8_t *texture;
+    size_t texel_count;
+    Voxel_Object (*material)(void *user, const uint8_t *leaf);
+    void *user;
+    std::unordered_map<size_t, int> refs;          //referências a cada nó interno
+    std::unordered_map<size_t, Octree*> shared;    //nós com mais de uma referência, já lidos
+} Texture_Reader;
+
+static size_t _decode_pointer(const uint8_t *texel, bool *is_leaf) {
+    uint32_t val = (uint32_t)texel[0] | ((uint32_t)texel[1] << 8) | ((uint32_t)texel[2] << 16);
+    *is_leaf = (val & 0x800000) != 0;
+    return val & 0x7FFFFF;
+}
+
+// Conta as referências a cada nó interno (cada um é visitado uma vez): os que têm mais
+// de uma voltam a ser subárvores compartilhadas
+static bool _count_refs(Texture_Reader *reader, const uint8_t *pointer, int depth) {
+    bool is_leaf;
+    size_t addr = _decode_pointer(pointer, &is_leaf);
+    if (is_leaf) return addr + LEAF_SIZE <= reader->texel_count;
+    if (depth > 64 || addr >= reader->texel_count) return false;
+    if (reader->refs[addr]++ > 0) return true;
+
+    // No header a flag do bit 23 marca a média depois dos ponteiros
+    const uint8_t *header = &reader->texture[addr * 4];
+    uint8_t mask = header[3];
+    bool filtered;
+    size_t start = _decode_pointer(header, &filtered);
+    if (mask == 0 || start + _count_set_bits(mask) + (filtered ? FILTER_SIZE : 0) > reader->texel_count) return false;
+    for (int i = 0; i < _count_set_bits(mask); i++) {
+        if (!_count_refs(reader, &reader->texture[(start + i) * 4], depth + 1)) return false;
+    }
+    return true;
+}
+
+static bool _read_header(Texture_Reader *reader, Octree *node, size_t addr);
+
+static bool _read_node(Texture_Reader *reader, Octree *node, const uint8_t *pointer) {
+    bool is_leaf;
+    size_t addr = _decode_pointer(pointer, &is_leaf);
+    IVector3 size = _get_node_size(node);
+    if (size.x <= 0 || size.y <= 0 || size.z <= 0) return false;
+
+    if (is_leaf) {
+        bool is_point = pointer[3] == POINTER_POINT_FLAG;
+        if (addr + (is_point ? POINT_LEAF_SIZE : LEAF_SIZE) > reader->texel_count) return false;
+        const uint8_t *leaf = &reader->texture[addr * 4];
+        node->voxel = reader->material ? reader->material(reader->user, leaf) : octree_leaf_voxel(leaf);
+        node->voxel.coord = node->left_bot_back;
+        node->has_voxel = true;
+        if (is_point) {
+            IVector3 offset = {{leaf[8] | (leaf[9] << 8), leaf[10] | (leaf[11] << 8), leaf[12] | (leaf[13] << 8)}};
+            node->voxel.coord = ivec3_add(node->left_bot_back, offset);
+            if (_coord_is_outside(node->voxel.coord, node->left_bot_back, node->right_top_front)) return false;
+            node->is_point = size.x > 1 || size.y > 1 || size.z > 1;
+        }
+        return true;
+    }
+    if (size.x <= 1 && size.y <= 1 && size.z <= 1) return false;
+    if (reader->refs[addr] <= 1) return _read_header(reader, node, addr);
+
+    // Subárvore referenciada por vários nós: lida uma vez, em coordenadas locais
+    auto it = reader->shared.find(addr);
+    if (it != reader->shared.end()) {
+        if (!ivec3_equal_vec(_get_node_size(it->second), size)) return false;
+        node->instance = it->second;
+        node->instance->shares++;
+        return true;
+    }
+    Octree *shared = octree_create(NULL, {{0, 0, 0}}, size);
+    if (!shared) return false;
+    reader->shared[addr] = shared;
+    node->instance = shared;
+    return _read_header(reader, shared, addr);
+}
+
+static bool _read_header(Texture_Reader *reader, Octree *node, size_t addr) {
+    const uint8_t *header = &reader->texture[addr * 4];
+    bool is_leaf;
+    size_t start = _decode_pointer(header, &is_leaf);
+    uint8_t mask = header[3];
+    if (_create_children(node, _node_mid(node)) != 0) return false;
+
+    int slot = 0;
+    for (int i = 0; i < CHILDREN_COUNT; i++) {
+        if (!((mask >> i) & 1)) continue;
+        if (!_read_node(reader, node->children[i], &reader->texture[(start + slot) * 4])) return false;
+        slot++;
+    }
+    return true;
+}
+
+// Remonta a árvore a partir da textura (o inverso de octree_texture_write). 'root' é o
+// texel-ponteiro da raiz (endereço, flag de folha e de ponto, como nos nós internos).
+// 'material' traduz os 2 texels de uma folha; com NULL as propriedades voltam quantizadas.
+// Nós com várias referências voltam a ser subárvores compartilhadas. Retorna NULL se
+// a textura estiver malformada.
+Octree *octree_from_texture(const uint8_t *texture, size_t texel_count, const uint8_t *root,
+                            IVector3 left_bot_back, IVector3 right_top_front,
+                            Voxel_Object (*material)(void *user, const uint8_t *leaf), void *user) {
+    if (!root) return NULL;
+    Octree *tree = octree_create(NULL, left_bot_back, right_top_front);
+    if (!tree || !texture || texel_count == 0) return tree;
+
+    Texture_Reader reader;
+    reader.texture = texture;
+    reader.texel_count = texel_count;
+    reader.material = material;
+    reader.user = user;
+    if (!_count_refs(&reader, root, 0) || !_read_node(&reader, tree, root)) {
+        octree_delete(tree);
+        return NULL;
+    }
+    return tree;
+}
+
 void octree_remove(Octree *tree, IVector3 coord) {
     if (!tree) return;
     
     // Se está fora, ignora
     if (_coord_is_outside(coord, tree->left_bot_back, tree->right_top_front)) return;
 
+    if (tree->instance) {
+        if (octree_find(tree, coord).coord.y == MIN_HEIGHT) return;
+        _expand_instance(tree);
+    }
+
+    tree->dirty = true;
+
     IVector3 size = ivec3_sub(tree->right_top_front, tree->left_bot_back);
 
     // --- CASO BASE: Tamanho 1x1x1 (Atomic Voxel) ---
@@ -696,6 +1189,16 @@ void octree_remove(Octree *tree, IVector3 coord) {
         return;
     }
 
+    // Ponto: o resto da caixa já é ar, só apaga se for o próprio voxel
+    if (!tree->children && tree->has_voxel && tree->is_point) {
+        if (ivec3_equal_vec(tree->voxel.coord, coord)) {
+            tree->voxel = _invalid_voxel();
+            tree->has_voxel = false;
+            tree->is_point = false;
+        }
+        return;
+    }
+
     // --- LÓGICA DE UN-MERGE (Split Down) ---
     // Se este nó não tem filhos (é uma folha na árvore), mas tem tamanho > 1 (é um blocão),
     // e tem dados (é sólido), precisamos quebrá-lo antes de remover um pedaço.
@@ -720,29 +1223,760 @@ void octree_remove(Octree *tree, IVector3 coord) {
     // --- LIMPEZA (Merge Empty) ---
     // Na volta, verificamos se todos os filhos ficaram vazios.
     // Se sim, deletamos os filhos e marcamos este nó como Ar.
-    bool all_empty = true;
-    for(int i=0; i<8; i++) {
-        // Um filho não é vazio se tiver voxel OU se tiver netos
-        if (tree->children[i]->has_voxel || tree->children[i]->children) {
-            all_empty = false;
-            break;
-        }
-    }
-
-    if (all_empty) {
+    // Isso não pode esperar a compactação: a textura não tem como representar
+    // um nó interno sem nenhum filho. Subir pontos e fundir irmãos fica para octree_compact.
+    if (_get_child_mask(tree) == 0) {
         for(int i=0; i<8; i++) free(tree->children[i]);
         free(tree->children);
         tree->children = NULL;
         tree->has_voxel = false; // Virou Ar
-    } 
-    // Opcional: Adicione _try_merge_children(tree) aqui se quiser que 
-    // remover um bloco e colocar outro igual funda novamente.
+    }
+}
+
+// Sobrou um único voxel (ponto ou folha 1³) sob o nó: sobe para ele como ponto,
+// desfazendo a cadeia que um segundo voxel tinha obrigado a criar
+static void _try_hoist_point(Octree *node) {
+    if (!node->children || !node->parent) return;
+
+    Octree *survivor = NULL;
+    for(int i = 0; i < CHILDREN_COUNT; i++) {
+        Octree *child = node->children[i];
+        if (_is_empty(child)) continue;
+        if (survivor) return;
+        survivor = child;
+    }
+    if (!survivor || survivor->children || survivor->instance) return;
+
+    IVector3 survivor_size = _get_node_size(survivor);
+    if (!survivor->is_point && (survivor_size.x > 1 || survivor_size.y > 1 || survivor_size.z > 1)) return;
+
+    Voxel_Object voxel = survivor->voxel;
+    for(int i = 0; i < CHILDREN_COUNT; i++) free(node->children[i]);
+    free(node->children);
+    node->children = NULL;
+    node->voxel = voxel;
+    node->has_voxel = true;
+    node->is_point = true;
+}
+
+typedef struct {
+    std::chrono::steady_clock::time_point deadline;
+    bool limited;
+    int visited;
+} Compact_State;
+
+// Pós-ordem só pelos nós sujos: cada nó é fechado depois dos filhos, então fusões e
+// pontos sobem em cascata. Retorna false se o orçamento acabou (o nó continua sujo).
+static bool _compact_node(Octree *node, Compact_State *state) {
+    if (!node->dirty) return true;
+
+    // Consultar o relógio custa mais que fechar um nó; olha só de vez em quando
+    if (state->limited && (++state->visited & 63) == 0
+        && std::chrono::steady_clock::now() >= state->deadline) return false;
+
+    if (node->children) {
+        for(int i = 0; i < CHILDREN_COUNT; i++) {
+            if (!_compact_node(node->children[i], state)) return false;
+        }
+        _try_hoist_point(node);
+        _try_merge_children(node);
+    }
+    node->dirty = false;
+    return true;
+}
+
+// Funde irmãos idênticos e sobe pontos nas subárvores editadas desde a última chamada.
+// budget_ms <= 0 compacta tudo; senão para no orçamento e continua de onde parou na
+// próxima chamada. Retorna true quando a árvore está na forma canônica (a mesma de
+// reconstruir do zero e compactar).
+bool octree_compact(Octree *tree, double budget_ms) {
+    if (!tree) return true;
+
+    Compact_State state;
+    state.limited = budget_ms > 0.0;
+    state.deadline = std::chrono::steady_clock::now()
+                   + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(budget_ms));
+    state.visited = 0;
+    return _compact_node(tree, &state);
+}
+
+static void _free_children(Octree *node) {
+    if (!node->children) return;
+    for(int i = 0; i < CHILDREN_COUNT; i++) octree_delete(node->children[i]);
+    free(node->children);
+    node->children = NULL;
+}
+
+// 'dst' passa a ser o nó 'src' (conteúdo e filhos, sem cópia); 'src' fica vazio
+static void _take_node(Octree *dst, Octree *src) {
+    _free_children(dst);
+    octree_delete(dst->instance);
+    dst->voxel = src->voxel;
+    dst->has_voxel = src->has_voxel;
+    dst->is_point = src->is_point;
+    dst->instance = src->instance;
+    dst->dirty = true;
+    dst->children = src->children;
+    if (dst->children) {
+        for(int i = 0; i < CHILDREN_COUNT; i++) dst->children[i]->parent = dst;
+    }
+    src->children = NULL;
+    src->instance = NULL;
+    src->has_voxel = false;
+    src->is_point = false;
+}
+
+static void _merge_node(Octree *dst, Octree *src) {
+    if (_is_empty(src)) return;
+    dst->dirty = true;
+
+    // Caixa vazia no destino: enxerta (instâncias continuam compartilhadas)
+    if (_is_empty(dst)) {
+        _take_node(dst, src);
+        return;
+    }
+    if (src->instance) _expand_instance(src);
+    if (dst->instance) _expand_instance(dst);
+
+    // 'src' é um volume que cobre a caixa inteira: enxerta
+    if (!src->children && !src->is_point) {
+        _take_node(dst, src);
+        return;
+    }
+    if (!src->children) {
+        octree_insert(dst, src->voxel);
+        return;
+    }
+
+    if (!dst->children) {
+        if (dst->is_point) {
+            // O ponto antigo só sobrevive se 'src' não tiver nada na mesma célula
+            Voxel_Object point = dst->voxel;
+            _take_node(dst, src);
+            if (octree_find(dst, point.coord).coord.y == MIN_HEIGHT) octree_insert(dst, point);
+            return;
+        }
+        if (_split_node(dst) != 0) return;
+    }
+    for(int i = 0; i < CHILDREN_COUNT; i++) _merge_node(dst->children[i], src->children[i]);
+}
+
+static void _insert_voxel(void *user, Voxel_Object voxel) {
+    octree_insert((Octree*)user, voxel);
+}
+
+// Move o conteúdo de 'src' (mesmos limites que 'dst') para 'dst' e apaga 'src'. Onde as
+// duas têm voxels, 'src' vence. Subárvores que só existem em 'src' são enxertadas sem
+// cópia, então árvores montadas em paralelo sobre regiões diferentes se juntam quase de graça.
+void octree_merge(Octree *dst, Octree *src) {
+    if (!dst || !src) return;
+    if (ivec3_equal_vec(dst->left_bot_back, src->left_bot_back) && ivec3_equal_vec(dst->right_top_front, src->right_top_front)) {
+        _merge_node(dst, src);
+    } else {
+        octree_for_each(src, _insert_voxel, dst);
+    }
+    octree_delete(src);
+}
+
+// Cópia independente da árvore; subárvores compartilhadas não são copiadas (ganham um dono)
+Octree *octree_clone(Octree *tree) {
+    if (!tree) return NULL;
+    Octree *copy = octree_create(NULL, tree->left_bot_back, tree->right_top_front);
+    _copy_shifted(copy, tree, {{0, 0, 0}});
+    return copy;
+}
+
+// --- COLAGEM ---
+
+typedef struct _paste_state {
+    const Voxel_Transform *transform; //células de 'src' -> células de 'dst'
+    bool translate_only;              //sem rotação: subárvores alinhadas são copiadas inteiras
+    IVector3 region_min, region_max;  //células de 'src' copiadas, [min, max)
+} Paste_State;
+
+static bool _box_is_empty(IVector3 min, IVector3 max) {
+    return min.x >= max.x || min.y >= max.y || min.z >= max.z;
+}
+
+static bool _box_inside(IVector3 min, IVector3 max, IVector3 outer_min, IVector3 outer_max) {
+    return min.x >= outer_min.x && min.y >= outer_min.y && min.z >= outer_min.z
+        && max.x <= outer_max.x && max.y <= outer_max.y && max.z <= outer_max.z;
+}
+
+// Nó de até 2³ no destino: lê as células direto da origem e só cria filhos se o
+// resultado não for ar, um ponto ou um volume de um material só
+static void _paste_cells(Octree *dst, const Paste_State *paste, Octree *src, IVector3 src_offset,
+                         IVector3 clip_min, IVector3 clip_max) {
+    IVector3 min = dst->left_bot_back, max = dst->right_top_front;
+    Voxel_Object cells[CHILDREN_COUNT];
+    int count = 0, volume = 0, first = -1;
+    bool uniform = true;
+    for (int x = min.x; x < max.x; x++)
+    for (int y = min.y; y < max.y; y++)
+    for (int z = min.z; z < max.z; z++) {
+        int i = ((x - min.x) << 2) | ((y - min.y) << 1) | (z - min.z);
+        volume++;
+        IVector3 local = voxel_transform_local_cell(paste->transform, {{x, y, z}});
+        cells[i] = _coord_is_outside(local, clip_min, clip_max) ? _invalid_voxel()
+                 : octree_find(src, ivec3_sub(local, src_offset));
+        if (cells[i].coord.y == MIN_HEIGHT) continue;
+        cells[i].coord = {{x, y, z}};
+        if (first < 0) first = i;
+        else uniform = uniform && _same_material(cells[i], cells[first]);
+        count++;
+    }
+    if (count == 0) return;
+
+    dst->dirty = true;
+    if (count == 1 || (count == volume && uniform)) {
+        dst->voxel = cells[first];
+        if (count > 1) dst->voxel.coord = min;
+        dst->has_voxel = true;
+        dst->is_point = count == 1;
+        return;
+    }
+    if (_create_children(dst, _node_mid(dst)) != 0) return;
+    for (int i = 0; i < CHILDREN_COUNT; i++) {
+        Octree *child = dst->children[i];
+        if (_box_is_empty(child->left_bot_back, child->right_top_front)) continue;
+        IVector3 cell = ivec3_sub(child->left_bot_back, min);
+        Voxel_Object voxel = cells[(cell.x << 2) | (cell.y << 1) | cell.z];
+        if (voxel.coord.y == MIN_HEIGHT) continue;
+        child->voxel = voxel;
+        child->has_voxel = true;
+    }
+}
+
+static void _set_box(Octree *node, IVector3 min, IVector3 max, const Voxel_Object *voxel);
+
+// Percorre 'src' dentro de [clip_min, clip_max) (coordenadas da raiz) e grava cada folha,
+// levada por 'transform', como uma caixa em 'dst': o custo segue os nós de origem, não as
+// células, mesmo quando nada fica alinhado
+static void _paste_leaves(Octree *dst, const Paste_State *paste, Octree *src, IVector3 src_offset,
+                          IVector3 clip_min, IVector3 clip_max) {
+    if (_is_empty(src)) return;
+    IVector3 node_min = ivec3_add(src->left_bot_back, src_offset);
+    IVector3 lo = ivec3_max(node_min, clip_min);
+    IVector3 hi = ivec3_min(ivec3_add(src->right_top_front, src_offset), clip_max);
+    if (_box_is_empty(lo, hi)) return;
+
+    if (src->instance) {
+        _paste_leaves(dst, paste, src->instance, node_min, clip_min, clip_max);
+        return;
+    }
+    if (src->children) {
+        for (int i = 0; i < CHILDREN_COUNT; i++) {
+            if (src->children[i]) _paste_leaves(dst, paste, src->children[i], src_offset, clip_min, clip_max);
+        }
+        return;
+    }
+    if (src->is_point) {
+        IVector3 point = ivec3_add(src->voxel.coord, src_offset);
+        if (_coord_is_outside(point, clip_min, clip_max)) return;
+        lo = point;
+        hi = ivec3_scalar_add(point, 1);
+    }
+    IVector3 a = voxel_transform_cell(paste->transform, lo);
+    IVector3 b = voxel_transform_cell(paste->transform, ivec3_scalar_add(hi, -1));
+    _set_box(dst, ivec3_min(a, b), ivec3_scalar_add(ivec3_max(a, b), 1), &src->voxel);
+}
+
+// Preenche o nó 'dst' (vazio) com as células de 'src' que caem nele. 'src' é o menor nó
+// conhecido que contém a caixa de origem de 'dst'; 'src_offset' leva as coordenadas dele
+// (locais, dentro de instâncias) para as de 'src' na raiz. Onde a caixa de origem é
+// exatamente um nó de 'src', a subárvore é copiada de uma vez; o resto sai folha a folha
+// (_paste_leaves).
+static void _paste(Octree *dst, const Paste_State *paste, Octree *src, IVector3 src_offset) {
+    if (_box_is_empty(dst->left_bot_back, dst->right_top_front)) return;
+
+    IVector3 a = voxel_transform_local_cell(paste->transform, dst->left_bot_back);
+    IVector3 b = voxel_transform_local_cell(paste->transform, ivec3_scalar_add(dst->right_top_front, -1));
+    IVector3 box_min = ivec3_min(a, b), box_max = ivec3_scalar_add(ivec3_max(a, b), 1);
+    IVector3 clip_min = ivec3_max(box_min, paste->region_min), clip_max = ivec3_min(box_max, paste->region_max);
+    if (_box_is_empty(clip_min, clip_max)) return;
+    bool whole = ivec3_equal_vec(clip_min, box_min) && ivec3_equal_vec(clip_max, box_max);
+
+    // Desce em 'src' enquanto um único nó contém tudo que vai para 'dst'
+    for (;;) {
+        IVector3 node_min = ivec3_add(src->left_bot_back, src_offset);
+        IVector3 node_max = ivec3_add(src->right_top_front, src_offset);
+        // A raiz nunca vira instância (ver octree_set_instance)
+        if (whole && paste->translate_only && (dst->parent || !src->instance)
+            && ivec3_equal_vec(node_min, box_min) && ivec3_equal_vec(node_max, box_max)) {
+            _copy_shifted(dst, src, ivec3_sub(dst->left_bot_back, src->left_bot_back));
+            dst->dirty = true;
+            return;
+        }
+        if (src->instance) {
+            src_offset = node_min;
+            src = src->instance;
+            continue;
+        }
+        if (!src->children) break;
+
+        IVector3 local_min = ivec3_sub(clip_min, src_offset), local_max = ivec3_sub(clip_max, src_offset);
+        Octree *child = src->children[_get_pos_in_octree(local_min, _node_mid(src))];
+        if (!child) return;
+        if (!_box_inside(local_min, local_max, child->left_bot_back, child->right_top_front)) break;
+        src = child;
+    }
+    if (_is_empty(src)) return;
+
+    if (!src->children) {
+        if (src->is_point) {
+            IVector3 point = ivec3_add(src->voxel.coord, src_offset);
+            if (_coord_is_outside(point, clip_min, clip_max)) return;
+            IVector3 size = _get_node_size(dst);
+            dst->voxel = src->voxel;
+            dst->voxel.coord = voxel_transform_cell(paste->transform, point);
+            dst->has_voxel = true;
+            dst->is_point = size.x > 1 || size.y > 1 || size.z > 1;
+            dst->dirty = true;
+            return;
+        }
+        if (whole) {
+            dst->voxel = src->voxel;
+            dst->voxel.coord = dst->left_bot_back;
+            dst->has_voxel = true;
+            dst->dirty = true;
+            return;
+        }
+    }
+
+    // Sem rotação e com os nós de 'src' caindo sobre os de 'dst': divide o destino e
+    // continua a partir do mesmo nó de origem (as subárvores de dentro são enxertadas).
+    // Fora disso nenhum nó de origem vira um de destino; cada folha vira uma caixa.
+    IVector3 size = _get_node_size(dst);
+    if (size.x <= 1 && size.y <= 1 && size.z <= 1) return;
+    IVector3 phase = ivec3_sub(box_min, ivec3_add(src->left_bot_back, src_offset));
+    if (!paste->translate_only || phase.x % size.x || phase.y % size.y || phase.z % size.z) {
+        _paste_leaves(dst, paste, src, src_offset, clip_min, clip_max);
+        return;
+    }
+    if (size.x <= 2 && size.y <= 2 && size.z <= 2) {
+        _paste_cells(dst, paste, src, src_offset, clip_min, clip_max);
+        return;
+    }
+    if (_create_children(dst, _node_mid(dst)) != 0) return;
+    for(int i = 0; i < CHILDREN_COUNT; i++) _paste(dst->children[i], paste, src, src_offset);
+    if (_get_child_mask(dst) == 0) {
+        _free_children(dst);
+        return;
+    }
+    dst->dirty = true;
+}
+
+// Copia para 'dst' as células de 'src' em [src_min, src_max] (inclusivos, coordenadas de
+// 'src'), levadas por 'transform'. Onde as duas têm voxels, 'src' vence; o ar de 'src' não
+// apaga nada. Retorna false se nada foi copiado.
+bool octree_paste(Octree *dst, Octree *src, const Voxel_Transform *transform, IVector3 src_min, IVector3 src_max) {
+    if (!dst || !src || !transform) return false;
+
+    Voxel_Transform identity = voxel_transform_identity();
+    Paste_State paste;
+    paste.transform = transform;
+    paste.translate_only = memcmp(transform->rot, identity.rot, sizeof(identity.rot)) == 0;
+    paste.region_min = ivec3_max(ivec3_min(src_min, src_max), src->left_bot_back);
+    paste.region_max = ivec3_min(ivec3_scalar_add(ivec3_max(src_min, src_max), 1), src->right_top_front);
+    if (_box_is_empty(paste.region_min, paste.region_max)) return false;
+
+    // Monta a camada colada à parte e junta com octree_merge (que enxerta sem copiar)
+    Octree *layer = octree_create(NULL, dst->left_bot_back, dst->right_top_front);
+    _paste(layer, &paste, src, {{0, 0, 0}});
+    if (_is_empty(layer)) {
+        octree_delete(layer);
+        return false;
+    }
+    octree_merge(dst, layer);
+    return true;
+}
+
+// Região [vox_min, vox_max] (inclusivos) como uma octree à parte com caixa [0, 2^n),
+// a célula vox_min indo para a origem (vazia se a região só tiver ar).
+Octree *octree_extract(Octree *tree, IVector3 vox_min, IVector3 vox_max) {
+    if (!tree) return NULL;
+    IVector3 min = ivec3_min(vox_min, vox_max), max = ivec3_max(vox_min, vox_max);
+    IVector3 extent = ivec3_scalar_add(ivec3_sub(max, min), 1);
+    int size = 1;
+    while (size < extent.x || size < extent.y || size < extent.z) size *= 2;
+
+    Octree *clip = octree_create(NULL, {{0, 0, 0}}, {{size, size, size}});
+    Voxel_Transform transform = voxel_transform_translation(ivec3_negate(min));
+    octree_paste(clip, tree, &transform, min, max);
+    return clip;
+}
+
+// --- PREENCHIMENTO ---
+
+// As células [min, max) do nó viram 'voxel' (NULL = ar). Nós que caem inteiros na caixa
+// mudam de uma vez (volume ou ar, os filhos são liberados); só as bordas descem.
+static void _set_box(Octree *node, IVector3 min, IVector3 max, const Voxel_Object *voxel) {
+    IVector3 lo = ivec3_max(min, node->left_bot_back), hi = ivec3_min(max, node->right_top_front);
+    if (_box_is_empty(lo, hi) || (!voxel && _is_empty(node))) return;
+    node->dirty = true;
+
+    if (ivec3_equal_vec(lo, node->left_bot_back) && ivec3_equal_vec(hi, node->right_top_front)) {
+        _free_children(node);
+        octree_delete(node->instance);
+        node->instance = NULL;
+        node->is_point = false;
+        node->has_voxel = voxel != NULL;
+        node->voxel = voxel ? *voxel : _invalid_voxel();
+        if (voxel) node->voxel.coord = node->left_bot_back;
+        return;
+    }
+
+    if (node->instance) _expand_instance(node);
+    if (!node->children) {
+        if (voxel && node->has_voxel && !node->is_point && _same_material(node->voxel, *voxel)) return;
+        if (!voxel && node->is_point) {
+            if (!_coord_is_outside(node->voxel.coord, lo, hi)) {
+                node->voxel = _invalid_voxel();
+                node->has_voxel = false;
+                node->is_point = false;
+            }
+            return;
+        }
+        if (_split_node(node) != 0) return;
+    }
+    for(int i = 0; i < CHILDREN_COUNT; i++) _set_box(node->children[i], lo, hi, voxel);
+
+    // Como em octree_remove: um nó interno sem nenhum filho não pode ir para a textura
+    if (_get_child_mask(node) == 0) {
+        _free_children(node);
+        node->has_voxel = false;
+    }
+}
+
+// Preenche [vox_min, vox_max] (inclusivos) com o material de 'voxel'; fundir os volumes
+// das bordas com os vizinhos fica para octree_compact
+void octree_fill(Octree *tree, IVector3 vox_min, IVector3 vox_max, Voxel_Object voxel) {
+    if (!tree) return;
+    _set_box(tree, ivec3_min(vox_min, vox_max), ivec3_scalar_add(ivec3_max(vox_min, vox_max), 1), &voxel);
+}
+
+// Apaga [vox_min, vox_max] (inclusivos), incluindo o que vier de subárvores compartilhadas
+void octree_clear(Octree *tree, IVector3 vox_min, IVector3 vox_max) {
+    if (!tree) return;
+    _set_box(tree, ivec3_min(vox_min, vox_max), ivec3_scalar_add(ivec3_max(vox_min, vox_max), 1), NULL);
+}
+
+// --- REDUÇÃO (LOD) ---
+
+// Um nó visto como uma célula só
+typedef struct {
+    bool solid;
+    Voxel_Object voxel;
+} Lod_Sample;
+
+// Folha de volume: ela mesma. Ponto num nó maior que 1³: ar (um voxel nunca é a maioria).
+// Nó interno: maioria dos 8 filhos (sólido com 4 ou mais, amostrados do mesmo jeito), com
+// a cor média deles e as propriedades do material mais comum.
+static Lod_Sample _lod_sample(Octree *node) {
+    Lod_Sample sample = {false, _invalid_voxel()};
+    if (node->instance) return _lod_sample(node->instance);
+    if (!node->children) {
+        IVector3 size = _get_node_size(node);
+        sample.solid = node->has_voxel && (!node->is_point || (size.x <= 1 && size.y <= 1 && size.z <= 1));
+        if (sample.solid) sample.voxel = node->voxel;
+        return sample;
+    }
+
+    Lod_Sample children[CHILDREN_COUNT];
+    int solid = 0;
+    for (int i = 0; i < CHILDREN_COUNT; i++) {
+        children[i] = _lod_sample(node->children[i]);
+        solid += children[i].solid;
+    }
+    if (solid < CHILDREN_COUNT / 2) return sample;
+
+    unsigned red = 0, green = 0, blue = 0, alpha = 0;
+    int best = -1, best_count = 0;
+    for (int i = 0; i < CHILDREN_COUNT; i++) {
+        if (!children[i].solid) continue;
+        ColorRGBA color = children[i].voxel.color;
+        red += get_red_rgba(color);
+        green += get_green_rgba(color);
+        blue += get_blue_rgba(color);
+        alpha += get_alpha_rgba(color);
+        int count = 0;
+        for (int j = 0; j < CHILDREN_COUNT; j++) {
+            count += children[j].solid && voxel_compare(children[j].voxel.voxel, children[i].voxel.voxel);
+        }
+        if (count > best_count) {
+            best = i;
+            best_count = count;
+        }
+    }
+    sample.solid = true;
+    sample.voxel = children[best].voxel;
+    sample.voxel.color = make_color_rgba(red / solid, green / solid, blue / solid, alpha / solid);
+    return sample;
+}
+
+// Escreve em 'dst' as células de 'cell'³ de 'src' (o nó de mesma caixa; numa instância, a
+// caixa local dela) que caem em [min, max). As duas árvores descem juntas: cada nó de
+// 'dst' muda de uma vez, sem voltar à raiz.
+static void _downsample(Octree *dst, Octree *src, int cell, IVector3 min, IVector3 max) {
+    IVector3 lo = ivec3_max(dst->left_bot_back, min), hi = ivec3_min(dst->right_top_front, max);
+    if (_box_is_empty(lo, hi)) return;
+    if (src->instance) {
+        _downsample(dst, src->instance, cell, min, max);
+        return;
+    }
+
+    IVector3 size = _get_node_size(dst);
+    if (!src->children || (size.x <= cell && size.y <= cell && size.z <= cell)) {
+        // Uma folha maior que a célula continua como está (volume, ou ar se for um ponto)
+        Lod_Sample sample = _lod_sample(src);
+        _set_box(dst, lo, hi, sample.solid ? &sample.voxel : NULL);
+        return;
+    }
+
+    if (dst->instance) _expand_instance(dst);
+    if (!dst->children && (dst->has_voxel ? _split_node(dst) : _create_children(dst, _node_mid(dst))) != 0) return;
+    dst->dirty = true;
+    for (int i = 0; i < CHILDREN_COUNT; i++) _downsample(dst->children[i], src->children[i], cell, min, max);
+    if (_get_child_mask(dst) == 0) {
+        _free_children(dst);
+        dst->has_voxel = false;
+    }
+}
+
+// Refaz em 'dst' (a redução de 'src', com a mesma caixa) as células de 'cell'³ que tocam
+// [vox_min, vox_max] (inclusivos), a partir de 'src': a atualização depois de uma edição
+// nessa caixa. 'cell' é potência de 2. As células se alinham à raiz, então reduzir uma
+// redução dá a próxima pirâmide (a de 4³ a partir da de 2³ é igual à de 4³ direto).
+void octree_downsample_region(Octree *dst, Octree *src, int cell, IVector3 vox_min, IVector3 vox_max) {
+    if (!dst || !src || cell < 1) return;
+    IVector3 root = src->left_bot_back;
+    IVector3 min = ivec3_max(ivec3_min(vox_min, vox_max), root);
+    IVector3 max = ivec3_min(ivec3_scalar_add(ivec3_max(vox_min, vox_max), 1), src->right_top_front);
+    if (_box_is_empty(min, max)) return;
+    // Para fora até as bordas das células (os deslocamentos a partir da raiz são >= 0)
+    IVector3 from = ivec3_sub(min, root), to = ivec3_sub(max, root);
+    from = {{from.x / cell * cell, from.y / cell * cell, from.z / cell * cell}};
+    to = {{(to.x + cell - 1) / cell * cell, (to.y + cell - 1) / cell * cell, (to.z + cell - 1) / cell * cell}};
+    min = ivec3_add(root, from);
+    max = ivec3_min(ivec3_add(root, to), src->right_top_front);
+
+    _downsample(dst, src, cell, min, max);
+    octree_compact(dst, 0);
+}
+
+// Cópia de 'tree' com células de 'cell'³ (potência de 2) em vez de 1³: cada uma vira
+// volume ou ar pela maioria das 8 metades (ver _lod_sample). Mesma caixa da raiz, então
+// o shader percorre a redução como a árvore original, só que parando mais cedo.
+Octree *octree_downsample(Octree *tree, int cell) {
+    if (!tree) return NULL;
+    Octree *dst = octree_create(NULL, tree->left_bot_back, tree->right_top_front);
+    if (!dst) return NULL;
+    octree_downsample_region(dst, tree, cell, tree->left_bot_back, ivec3_scalar_sub(tree->right_top_front, 1));
+    return dst;
+}
+
+// Menor nó da subdivisão (abaixo da raiz) cuja caixa contém [vox_min, vox_max] (inclusivos).
+// Só depende dos limites da raiz: o nó não precisa existir ainda.
+bool octree_node_box(Octree *tree, IVector3 vox_min, IVector3 vox_max, IVector3 *box_min, IVector3 *box_max) {
+    if (!tree) return false;
+    IVector3 min = tree->left_bot_back, max = tree->right_top_front;
+    if (_coord_is_outside(vox_min, min, max) || _coord_is_outside(vox_max, min, max)) return false;
+
+    int depth = 0;
+    while (max.x - min.x > 1 || max.y - min.y > 1 || max.z - min.z > 1) {
+        IVector3 mid = {{min.x + (max.x - min.x) / 2, min.y + (max.y - min.y) / 2, min.z + (max.z - min.z) / 2}};
+        int childIdx = _get_pos_in_octree(vox_min, mid);
+        if (childIdx != _get_pos_in_octree(vox_max, mid)) break;
+        if (childIdx & 4) min.x = mid.x; else max.x = mid.x;
+        if (childIdx & 2) min.y = mid.y; else max.y = mid.y;
+        if (childIdx & 1) min.z = mid.z; else max.z = mid.z;
+        depth++;
+    }
+    if (depth == 0) return false;
+    *box_min = min;
+    *box_max = max;
+    return true;
+}
+
+// Coloca 'shared' (octree com caixa [0, tamanho)) como conteúdo do nó que começa em
+// 'left_bot_back' e tem o tamanho dela, criando o caminho até ele. Só funciona se esse
+// nó existir na subdivisão e ainda for ar; senão retorna false e nada muda.
+// Cada nó que referencia 'shared' é um dono (octree_delete só libera no último).
+bool octree_set_instance(Octree *tree, IVector3 left_bot_back, Octree *shared) {
+    if (!tree || !shared || _is_empty(shared)) return false;
+    IVector3 box_max = ivec3_add(left_bot_back, _get_node_size(shared));
+    IVector3 last = ivec3_scalar_sub(box_max, 1);
+
+    // 1. Confere o caminho sem mexer em nada: a caixa tem que sair da subdivisão e
+    //    tudo acima dela tem que ser nó interno ou ar
+    Octree *node = tree;
+    IVector3 min = tree->left_bot_back, max = tree->right_top_front;
+    int depth = 0;
+    while (!ivec3_equal_vec(min, left_bot_back) || !ivec3_equal_vec(max, box_max)) {
+        if (max.x - min.x <= 1 && max.y - min.y <= 1 && max.z - min.z <= 1) return false;
+        if (node && (node->has_voxel || node->instance)) return false;
+
+        IVector3 mid = {{min.x + (max.x - min.x) / 2, min.y + (max.y - min.y) / 2, min.z + (max.z - min.z) / 2}};
+        int childIdx = _get_pos_in_octree(left_bot_back, mid);
+        if (childIdx != _get_pos_in_octree(last, mid)) return false;
+        if (childIdx & 4) min.x = mid.x; else max.x = mid.x;
+        if (childIdx & 2) min.y = mid.y; else max.y = mid.y;
+        if (childIdx & 1) min.z = mid.z; else max.z = mid.z;
+        if (node) node = node->children ? node->children[childIdx] : NULL;
+        depth++;
+    }
+    // A raiz nunca vira instância (o shader sempre começa a busca num nó interno)
+    if (depth == 0 || (node && !_is_empty(node))) return false;
+
+    // 2. Cria o que faltar do caminho
+    node = tree;
+    while (!ivec3_equal_vec(node->left_bot_back, left_bot_back) || !ivec3_equal_vec(node->right_top_front, box_max)) {
+        node->dirty = true;
+        if (!node->children && _create_children(node, node->left_bot_back) != 0) return false;
+        node = node->children[_get_pos_in_octree(left_bot_back, _node_mid(node))];
+    }
+    node->instance = shared;
+    node->dirty = true;
+    shared->shares++;
+    return true;
+}
+
+// Memória ocupada pela árvore (nós + arrays de ponteiros dos filhos).
+// Subárvores compartilhadas contam uma vez só.
+static size_t _memory_usage(Octree *tree, std::unordered_set<Octree*> *seen) {
+    if (!tree) return 0;
+
+    size_t total = sizeof(Octree);
+    if (tree->instance && seen->insert(tree->instance).second) {
+        total += _memory_usage(tree->instance, seen);
+    }
+    if (tree->children) {
+        total += sizeof(Octree*) * CHILDREN_COUNT;
+        for(int i = 0; i < CHILDREN_COUNT; i++) {
+            total += _memory_usage(tree->children[i], seen);
+        }
+    }
+    return total;
+}
+
+size_t octree_memory_usage(Octree *tree) {
+    std::unordered_set<Octree*> seen;
+    return _memory_usage(tree, &seen);
+}
+
+static void _bounds(Octree *tree, IVector3 offset, IVector3 *min, IVector3 *max, bool *found) {
+    IVector3 lo = ivec3_add(tree->left_bot_back, offset);
+    IVector3 hi = ivec3_scalar_add(ivec3_add(tree->right_top_front, offset), -1);
+
+    // Nó inteiro dentro da caixa já achada: não pode aumentá-la
+    if (*found && lo.x >= min->x && lo.y >= min->y && lo.z >= min->z
+               && hi.x <= max->x && hi.y <= max->y && hi.z <= max->z) return;
+
+    if (tree->instance) {
+        _bounds(tree->instance, lo, min, max, found);
+        return;
+    }
+    if (tree->children) {
+        for(int i = 0; i < CHILDREN_COUNT; i++) {
+            _bounds(tree->children[i], offset, min, max, found);
+        }
+        return;
+    }
+    if (!tree->has_voxel) return;
+
+    if (tree->is_point) lo = hi = ivec3_add(tree->voxel.coord, offset);
+    *min = *found ? ivec3_min(*min, lo) : lo;
+    *max = *found ? ivec3_max(*max, hi) : hi;
+    *found = true;
+}
+
+// Menor caixa com todos os voxels da árvore (vox_min/vox_max inclusivos).
+// Retorna false se a árvore está vazia.
+bool octree_bounds(Octree *tree, IVector3 *vox_min, IVector3 *vox_max) {
+    if (!tree || !vox_min || !vox_max) return false;
+    bool found = false;
+    _bounds(tree, {{0, 0, 0}}, vox_min, vox_max, &found);
+    return found;
+}
+
+static void _for_each(Octree *tree, void (*fn)(void *user, Voxel_Object voxel), void *user, IVector3 offset) {
+    if (tree->instance) {
+        _for_each(tree->instance, fn, user, ivec3_add(offset, tree->left_bot_back));
+        return;
+    }
+    if (tree->children) {
+        for(int i = 0; i < CHILDREN_COUNT; i++) {
+            _for_each(tree->children[i], fn, user, offset);
+        }
+        return;
+    }
+    if (!tree->has_voxel) return;
+
+    Voxel_Object voxel = tree->voxel;
+    IVector3 size = _get_node_size(tree);
+    if (tree->is_point || (size.x <= 1 && size.y <= 1 && size.z <= 1)) {
+        voxel.coord = ivec3_add(voxel.coord, offset);
+        fn(user, voxel);
+        return;
+    }
+
+    IVector3 min = ivec3_add(tree->left_bot_back, offset), max = ivec3_add(tree->right_top_front, offset);
+    for (int z = min.z; z < max.z; z++)
+    for (int y = min.y; y < max.y; y++)
+    for (int x = min.x; x < max.x; x++) {
+        voxel.coord = {{x, y, z}};
+        fn(user, voxel);
+    }
+}
+
+// Visita todos os voxels da árvore. Nós fundidos (volumes sólidos) são
+// expandidos em um voxel por célula, cada um com a própria coordenada;
+// nós-ponto entregam só o seu voxel. Instâncias entregam os voxels da
+// subárvore compartilhada já em coordenadas do mundo.
+void octree_for_each(Octree *tree, void (*fn)(void *user, Voxel_Object voxel), void *user) {
+    if (!tree || !fn) return;
+    _for_each(tree, fn, user, {{0, 0, 0}});
+}
+
+static void _for_each_box(Octree *tree, void (*fn)(void *user, IVector3 vox_min, IVector3 vox_max), void *user, IVector3 offset) {
+    if (tree->instance) {
+        _for_each_box(tree->instance, fn, user, ivec3_add(offset, tree->left_bot_back));
+        return;
+    }
+    if (tree->children) {
+        for (int i = 0; i < CHILDREN_COUNT; i++) {
+            _for_each_box(tree->children[i], fn, user, offset);
+        }
+        return;
+    }
+    if (!tree->has_voxel) return;
+
+    if (tree->is_point) {
+        IVector3 coord = ivec3_add(tree->voxel.coord, offset);
+        fn(user, coord, coord);
+        return;
+    }
+    fn(user, ivec3_add(tree->left_bot_back, offset), ivec3_add(ivec3_scalar_add(tree->right_top_front, -1), offset));
+}
+
+// Como octree_for_each, mas cada folha sólida chega uma vez como caixa [vox_min, vox_max]
+// (inclusivos), sem expandir os volumes
+void octree_for_each_box(Octree *tree, void (*fn)(void *user, IVector3 vox_min, IVector3 vox_max), void *user) {
+    if (!tree || !fn) return;
+    _for_each_box(tree, fn, user, {{0, 0, 0}});
 }
 
 // CORRIGIDO: Esta é a correção CRÍTICA para evitar o stack overflow.
 void octree_delete(Octree *tree) {
     if (!tree) return; // Guarda de nó nulo
 
+    // Subárvore compartilhada: cada dono solta a sua parte, o último libera
+    if (tree->shares > 0) {
+        tree->shares--;
+        return;
+    }
+    octree_delete(tree->instance);
+
     if (tree->children) { // Verifica se há filhos
         for(int i = 0; i < CHILDREN_COUNT; i++) {
             octree_delete(tree->children[i]); // Chama recursivamente nos *filhos*
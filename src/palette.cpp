@@ -0,0 +1,44 @@
+#include <palette.hpp>
+#include <stdlib.h>
+
+void palette_init(Voxel_Palette *palette, int max_count) {
+    palette->entries = NULL;
+    palette->count = 0;
+    palette->capacity = 0;
+    palette->max_count = max_count;
+    palette->last = -1;
+}
+
+static bool _same_material(Dense_Material *m, ColorRGBA color, Voxel voxel) {
+    return m->color == color && voxel_compare(m->voxel, voxel) && m->voxel.k == voxel.k;
+}
+
+// Procura (ou adiciona) o material na paleta. Retorna -1 se a paleta estiver cheia.
+int palette_index(Voxel_Palette *palette, ColorRGBA color, Voxel voxel) {
+    if (palette->last >= 0 && _same_material(&palette->entries[palette->last], color, voxel)) return palette->last;
+
+    for (int i = 0; i < palette->count; i++) {
+        if (_same_material(&palette->entries[i], color, voxel)) return palette->last = i;
+    }
+    if (palette->count >= palette->max_count) return -1;
+
+    if (palette->count == palette->capacity) {
+        int capacity = palette->capacity ? palette->capacity * 2 : 64;
+        Dense_Material *entries = (Dense_Material*)realloc(palette->entries, capacity * sizeof(Dense_Material));
+        if (!entries) return -1;
+        palette->entries = entries;
+        palette->capacity = capacity;
+    }
+    palette->entries[palette->count].color = color;
+    palette->entries[palette->count].voxel = voxel;
+    return palette->last = palette->count++;
+}
+
+size_t palette_memory_usage(Voxel_Palette *palette) {
+    return (size_t)palette->capacity * sizeof(Dense_Material);
+}
+
+void palette_free(Voxel_Palette *palette) {
+    free(palette->entries);
+    palette_init(palette, palette->max_count);
+}
@@ -0,0 +1,525 @@
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+    #include <vmm/ray.h>
+}
+#include <sparseGrid.hpp>
+#include <octree.hpp>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#define ROOT_INITIAL_CAPACITY 16
+
+// Nível em que a busca parou (o que falta para chegar ao voxel)
+#define MISSING_UPPER 0
+#define MISSING_LOWER 1
+#define MISSING_LEAF 2
+#define LEAF_FOUND 3
+
+// Canto mínimo do nó de lado 'dim' (potência de 2) que contém a coordenada; funciona com negativos
+static IVector3 _origin(IVector3 c, int dim) {
+    return {{c.x & ~(dim - 1), c.y & ~(dim - 1), c.z & ~(dim - 1)}};
+}
+
+static bool _same(IVector3 a, IVector3 b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+static int _leaf_bit(IVector3 c) {
+    const int m = SPARSE_LEAF_DIM - 1;
+    return (c.x & m) + SPARSE_LEAF_DIM * ((c.y & m) + SPARSE_LEAF_DIM * (c.z & m));
+}
+
+static int _lower_slot(IVector3 c) {
+    const int m = (1 << SPARSE_LOWER_LOG2) - 1, s = SPARSE_LEAF_LOG2;
+    return ((c.x >> s) & m) + (1 << SPARSE_LOWER_LOG2) * (((c.y >> s) & m) + (1 << SPARSE_LOWER_LOG2) * ((c.z >> s) & m));
+}
+
+static int _upper_slot(IVector3 c) {
+    const int m = (1 << SPARSE_UPPER_LOG2) - 1, s = SPARSE_LEAF_LOG2 + SPARSE_LOWER_LOG2;
+    return ((c.x >> s) & m) + (1 << SPARSE_UPPER_LOG2) * (((c.y >> s) & m) + (1 << SPARSE_UPPER_LOG2) * ((c.z >> s) & m));
+}
+
+static bool _test(const uint64_t *mask, int bit) {
+    return (mask[bit >> 6] >> (bit & 63)) & 1ull;
+}
+
+static void _set(uint64_t *mask, int bit) {
+    mask[bit >> 6] |= 1ull << (bit & 63);
+}
+
+static void _clear(uint64_t *mask, int bit) {
+    mask[bit >> 6] &= ~(1ull << (bit & 63));
+}
+
+// --- Raiz (tabela hash) ---
+
+static size_t _hash(IVector3 origin) {
+    const int s = SPARSE_LEAF_LOG2 + SPARSE_LOWER_LOG2 + SPARSE_UPPER_LOG2;
+    uint32_t x = (uint32_t)(origin.x >> s), y = (uint32_t)(origin.y >> s), z = (uint32_t)(origin.z >> s);
+    return (size_t)((x * 73856093u) ^ (y * 19349663u) ^ (z * 83492791u));
+}
+
+static Sparse_Root_Entry *_root_slot(Sparse_Root_Entry *table, size_t capacity, IVector3 origin) {
+    size_t i = _hash(origin) & (capacity - 1);
+    while (table[i].node && !_same(table[i].origin, origin)) i = (i + 1) & (capacity - 1);
+    return &table[i];
+}
+
+static bool _root_rehash(Sparse_Grid *grid, size_t capacity) {
+    Sparse_Root_Entry *table = (Sparse_Root_Entry*)calloc(capacity, sizeof(Sparse_Root_Entry));
+    if (!table) return false;
+
+    for (size_t i = 0; i < grid->root_capacity; i++) {
+        if (!grid->root[i].node) continue;
+        *_root_slot(table, capacity, grid->root[i].origin) = grid->root[i];
+    }
+    free(grid->root);
+    grid->root = table;
+    grid->root_capacity = capacity;
+    return true;
+}
+
+static Sparse_Upper *_root_get(Sparse_Grid *grid, IVector3 origin, bool create) {
+    Sparse_Root_Entry *entry = _root_slot(grid->root, grid->root_capacity, origin);
+    if (entry->node || !create) return entry->node;
+
+    // Mantém a carga abaixo de 50% para as sondagens continuarem curtas
+    if ((grid->root_count + 1) * 2 > grid->root_capacity) {
+        if (!_root_rehash(grid, grid->root_capacity * 2)) return NULL;
+        entry = _root_slot(grid->root, grid->root_capacity, origin);
+    }
+
+    Sparse_Upper *node = (Sparse_Upper*)calloc(1, sizeof(Sparse_Upper));
+    if (!node) return NULL;
+    entry->origin = origin;
+    entry->node = node;
+    grid->root_count++;
+    return node;
+}
+
+Sparse_Grid *sparse_grid_create(void) {
+    Sparse_Grid *grid = (Sparse_Grid*)calloc(1, sizeof(Sparse_Grid));
+    if (!grid) return NULL;
+
+    grid->root = (Sparse_Root_Entry*)calloc(ROOT_INITIAL_CAPACITY, sizeof(Sparse_Root_Entry));
+    if (!grid->root) {
+        free(grid);
+        return NULL;
+    }
+    grid->root_capacity = ROOT_INITIAL_CAPACITY;
+    palette_init(&grid->palette, SPARSE_PALETTE_MAX);
+    return grid;
+}
+
+Sparse_Accessor sparse_grid_accessor(Sparse_Grid *grid) {
+    Sparse_Accessor acc;
+    memset(&acc, 0, sizeof(acc));
+    acc.grid = grid;
+    return acc;
+}
+
+// Desce até a folha que contém 'c', começando do nível mais baixo que está no cache.
+// 'missing' recebe o nível que não existe (ou LEAF_FOUND) e 'fetches' os nós visitados.
+static Sparse_Leaf *_probe(Sparse_Accessor *acc, IVector3 c, bool create, int *missing, int *fetches) {
+    Sparse_Grid *grid = acc->grid;
+    IVector3 leaf_origin = _origin(c, SPARSE_LEAF_DIM);
+    IVector3 lower_origin = _origin(c, SPARSE_LOWER_DIM);
+    IVector3 upper_origin = _origin(c, SPARSE_UPPER_DIM);
+    int visited = 0;
+
+    Sparse_Leaf *leaf = NULL;
+    if (acc->leaf && _same(acc->leaf_origin, leaf_origin)) {
+        leaf = acc->leaf;
+        visited = 1;
+    } else {
+        Sparse_Lower *lower = NULL;
+        if (acc->lower && _same(acc->lower_origin, lower_origin)) {
+            lower = acc->lower;
+        } else {
+            Sparse_Upper *upper = NULL;
+            if (acc->upper && _same(acc->upper_origin, upper_origin)) {
+                upper = acc->upper;
+            } else {
+                visited++;
+                upper = _root_get(grid, upper_origin, create);
+                if (!upper) {
+                    if (missing) *missing = MISSING_UPPER;
+                    if (fetches) *fetches += visited;
+                    return NULL;
+                }
+                acc->upper = upper;
+                acc->upper_origin = upper_origin;
+            }
+
+            visited++;
+            int slot = _upper_slot(c);
+            lower = upper->children[slot];
+            if (!lower && create) {
+                lower = (Sparse_Lower*)calloc(1, sizeof(Sparse_Lower));
+                if (lower) {
+                    upper->children[slot] = lower;
+                    _set(upper->mask, slot);
+                    grid->lower_count++;
+                }
+            }
+            if (!lower) {
+                if (missing) *missing = MISSING_LOWER;
+                if (fetches) *fetches += visited;
+                return NULL;
+            }
+            acc->lower = lower;
+            acc->lower_origin = lower_origin;
+        }
+
+        visited++;
+        int slot = _lower_slot(c);
+        leaf = lower->children[slot];
+        if (!leaf && create) {
+            leaf = (Sparse_Leaf*)calloc(1, sizeof(Sparse_Leaf));
+            if (leaf) {
+                lower->children[slot] = leaf;
+                _set(lower->mask, slot);
+                grid->leaf_count++;
+            }
+        }
+        if (!leaf) {
+            if (missing) *missing = MISSING_LEAF;
+            if (fetches) *fetches += visited;
+            return NULL;
+        }
+        acc->leaf = leaf;
+        acc->leaf_origin = leaf_origin;
+    }
+
+    if (missing) *missing = LEAF_FOUND;
+    if (fetches) *fetches += visited;
+    return leaf;
+}
+
+// Retorna 0 em sucesso e -1 se a paleta estiver cheia ou faltar memória
+int sparse_accessor_insert(Sparse_Accessor *acc, Voxel_Object voxel) {
+    Sparse_Grid *grid = acc->grid;
+    if (!grid) return -1;
+
+    int material = palette_index(&grid->palette, voxel.color, voxel.voxel);
+    if (material < 0) return -1;
+
+    Sparse_Leaf *leaf = _probe(acc, voxel.coord, true, NULL, NULL);
+    if (!leaf) return -1;
+
+    int bit = _leaf_bit(voxel.coord);
+    if (!_test(leaf->mask, bit)) {
+        _set(leaf->mask, bit);
+        leaf->count++;
+        if (grid->voxel_count++ == 0) {
+            grid->bbox_min = grid->bbox_max = voxel.coord;
+        } else {
+            grid->bbox_min = ivec3_min(grid->bbox_min, voxel.coord);
+            grid->bbox_max = ivec3_max(grid->bbox_max, voxel.coord);
+        }
+    }
+    leaf->materials[bit] = (uint16_t)material;
+    return 0;
+}
+
+Voxel_Object sparse_accessor_find(Sparse_Accessor *acc, IVector3 coord) {
+    if (!acc->grid) return _invalid_voxel();
+
+    Sparse_Leaf *leaf = _probe(acc, coord, false, NULL, NULL);
+    if (!leaf) return _invalid_voxel();
+
+    int bit = _leaf_bit(coord);
+    if (!_test(leaf->mask, bit)) return _invalid_voxel();
+
+    Dense_Material *m = &acc->grid->palette.entries[leaf->materials[bit]];
+    return VoxelObjCreate(m->voxel, m->color, coord);
+}
+
+int sparse_grid_insert(Sparse_Grid *grid, Voxel_Object voxel) {
+    Sparse_Accessor acc = sparse_grid_accessor(grid);
+    return sparse_accessor_insert(&acc, voxel);
+}
+
+Voxel_Object sparse_grid_find(Sparse_Grid *grid, IVector3 coord) {
+    Sparse_Accessor acc = sparse_grid_accessor(grid);
+    return sparse_accessor_find(&acc, coord);
+}
+
+// Só apaga o bit: os nós ficam alocados (e os accessors válidos) até o próximo prune
+void sparse_grid_remove(Sparse_Grid *grid, IVector3 coord) {
+    if (!grid) return;
+
+    Sparse_Accessor acc = sparse_grid_accessor(grid);
+    Sparse_Leaf *leaf = _probe(&acc, coord, false, NULL, NULL);
+    if (!leaf) return;
+
+    int bit = _leaf_bit(coord);
+    if (!_test(leaf->mask, bit)) return;
+    _clear(leaf->mask, bit);
+    leaf->count--;
+    grid->voxel_count--;
+    if (leaf->count == 0) grid->emptied++;
+}
+
+// --- Travessia ---
+// Mesmo esquema da tree64: em cada passo a busca diz qual nível falta e o raio pula
+// o cubo inteiro desse nível (4096³, 128³, 8³ ou um voxel).
+bool sparse_grid_ray_cast(Sparse_Grid *grid, Ray ray, Voxel_Object *hit, Ray_Stats *stats) {
+    if (!grid || grid->voxel_count == 0) return false;
+
+    float o[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+    float d[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+    int lo[3] = {grid->bbox_min.x, grid->bbox_min.y, grid->bbox_min.z};
+    int hi[3] = {grid->bbox_max.x + 1, grid->bbox_max.y + 1, grid->bbox_max.z + 1};
+
+    // Evita divisão por zero (igual à octree)
+    float inv[3];
+    for (int a = 0; a < 3; a++) inv[a] = (fabsf(d[a]) < 1e-8f) ? 1e20f : 1.0f / d[a];
+
+    // Recorta o raio contra a caixa de tudo que foi inserido (o grid não tem limites fixos)
+    float t_enter = -1e30f, t_exit = 1e30f;
+    for (int a = 0; a < 3; a++) {
+        if (d[a] == 0.0f) {
+            if (o[a] < lo[a] || o[a] >= hi[a]) return false;
+            continue;
+        }
+        float t0 = ((float)lo[a] - o[a]) * inv[a];
+        float t1 = ((float)hi[a] - o[a]) * inv[a];
+        if (t0 > t1) { float tmp = t0; t0 = t1; t1 = tmp; }
+        if (t0 > t_enter) t_enter = t0;
+        if (t1 < t_exit) t_exit = t1;
+    }
+    if (t_enter < 0.0f) t_enter = 0.0f;
+    if (t_exit < t_enter) return false;
+
+    int cell[3];
+    for (int a = 0; a < 3; a++) {
+        int c = (int)floorf(o[a] + d[a] * t_enter);
+        if (c < lo[a]) c = lo[a];
+        if (c >= hi[a]) c = hi[a] - 1;
+        cell[a] = c;
+    }
+
+    Sparse_Accessor acc = sparse_grid_accessor(grid);
+    long long max_steps = (long long)(hi[0] - lo[0]) + (hi[1] - lo[1]) + (hi[2] - lo[2]) + 8;
+    for (long long i = 0; i < max_steps; i++) {
+        if (stats) stats->steps++;
+
+        IVector3 c = {{cell[0], cell[1], cell[2]}};
+        int missing;
+        Sparse_Leaf *leaf = _probe(&acc, c, false, &missing, stats ? &stats->fetches : NULL);
+
+        int box_side;
+        if (missing == MISSING_UPPER) box_side = SPARSE_UPPER_DIM;
+        else if (missing == MISSING_LOWER) box_side = SPARSE_LOWER_DIM;
+        else if (missing == MISSING_LEAF || leaf->count == 0) box_side = SPARSE_LEAF_DIM;
+        else {
+            int bit = _leaf_bit(c);
+            if (_test(leaf->mask, bit)) {
+                if (hit) {
+                    Dense_Material *m = &grid->palette.entries[leaf->materials[bit]];
+                    *hit = VoxelObjCreate(m->voxel, m->color, c);
+                }
+                return true;
+            }
+            box_side = 1;
+        }
+
+        IVector3 box_origin = _origin(c, box_side);
+        int box_min[3] = {box_origin.x, box_origin.y, box_origin.z};
+
+        // Avança até a face de saída do cubo vazio
+        float t_leave = 1e30f;
+        int axis = -1;
+        for (int a = 0; a < 3; a++) {
+            if (d[a] == 0.0f) continue;
+            int face = d[a] > 0.0f ? box_min[a] + box_side : box_min[a];
+            float tf = ((float)face - o[a]) * inv[a];
+            if (tf < t_leave) { t_leave = tf; axis = a; }
+        }
+        if (axis < 0 || t_leave >= t_exit) return false;
+
+        int next = d[axis] > 0.0f ? box_min[axis] + box_side : box_min[axis] - 1;
+        if (next < lo[axis] || next >= hi[axis]) return false;
+
+        // Nos outros eixos o raio ainda está dentro do cubo; limitar a ele evita que o
+        // arredondamento faça o raio voltar para uma célula já visitada
+        for (int a = 0; a < 3; a++) {
+            if (a == axis) continue;
+            int v = (int)floorf(o[a] + d[a] * t_leave);
+            if (v < box_min[a]) v = box_min[a];
+            if (v >= box_min[a] + box_side) v = box_min[a] + box_side - 1;
+            cell[a] = v;
+        }
+        cell[axis] = next;
+    }
+    return false;
+}
+
+// Percorre os filhos marcados de uma máscara (bit a bit, palavra por palavra)
+#define FOR_EACH_BIT(mask, words, bit) \
+    for (int _w = 0; _w < (words); _w++) \
+        for (uint64_t _m = (mask)[_w]; _m; _m &= _m - 1) \
+            for (int bit = _w * 64 + __builtin_ctzll(_m), _once = 1; _once; _once = 0)
+
+static IVector3 _child_origin(IVector3 parent, int slot, int log2_branch, int child_dim) {
+    int n = 1 << log2_branch;
+    return {{parent.x + (slot % n) * child_dim,
+             parent.y + ((slot / n) % n) * child_dim,
+             parent.z + (slot / (n * n)) * child_dim}};
+}
+
+void sparse_grid_for_each(Sparse_Grid *grid, void (*fn)(void *user, Voxel_Object voxel), void *user) {
+    if (!grid || !fn) return;
+
+    for (size_t r = 0; r < grid->root_capacity; r++) {
+        Sparse_Upper *upper = grid->root[r].node;
+        if (!upper) continue;
+
+        FOR_EACH_BIT(upper->mask, SPARSE_UPPER_CHILDREN / 64, us) {
+            Sparse_Lower *lower = upper->children[us];
+            IVector3 lower_origin = _child_origin(grid->root[r].origin, us, SPARSE_UPPER_LOG2, SPARSE_LOWER_DIM);
+
+            FOR_EACH_BIT(lower->mask, SPARSE_LOWER_CHILDREN / 64, ls) {
+                Sparse_Leaf *leaf = lower->children[ls];
+                IVector3 leaf_origin = _child_origin(lower_origin, ls, SPARSE_LOWER_LOG2, SPARSE_LEAF_DIM);
+
+                FOR_EACH_BIT(leaf->mask, SPARSE_LEAF_VOXELS / 64, bit) {
+                    Dense_Material *m = &grid->palette.entries[leaf->materials[bit]];
+                    fn(user, VoxelObjCreate(m->voxel, m->color, _child_origin(leaf_origin, bit, SPARSE_LEAF_LOG2, 1)));
+                }
+            }
+        }
+    }
+}
+
+static void _grow_bbox(void *user, Voxel_Object voxel) {
+    Sparse_Grid *grid = (Sparse_Grid*)user;
+    if (grid->voxel_count++ == 0) {
+        grid->bbox_min = grid->bbox_max = voxel.coord;
+    } else {
+        grid->bbox_min = ivec3_min(grid->bbox_min, voxel.coord);
+        grid->bbox_max = ivec3_max(grid->bbox_max, voxel.coord);
+    }
+}
+
+// Libera folhas e nós que ficaram vazios depois de remoções e recalcula a caixa.
+// Invalida todos os accessors.
+void sparse_grid_prune(Sparse_Grid *grid) {
+    if (!grid) return;
+
+    for (size_t r = 0; r < grid->root_capacity; r++) {
+        Sparse_Upper *upper = grid->root[r].node;
+        if (!upper) continue;
+
+        FOR_EACH_BIT(upper->mask, SPARSE_UPPER_CHILDREN / 64, us) {
+            Sparse_Lower *lower = upper->children[us];
+
+            FOR_EACH_BIT(lower->mask, SPARSE_LOWER_CHILDREN / 64, ls) {
+                if (lower->children[ls]->count > 0) continue;
+                free(lower->children[ls]);
+                lower->children[ls] = NULL;
+                _clear(lower->mask, ls);
+                grid->leaf_count--;
+            }
+
+            bool empty = true;
+            for (int w = 0; w < SPARSE_LOWER_CHILDREN / 64 && empty; w++) empty = lower->mask[w] == 0;
+            if (!empty) continue;
+            free(lower);
+            upper->children[us] = NULL;
+            _clear(upper->mask, us);
+            grid->lower_count--;
+        }
+
+        bool empty = true;
+        for (int w = 0; w < SPARSE_UPPER_CHILDREN / 64 && empty; w++) empty = upper->mask[w] == 0;
+        if (!empty) continue;
+        free(upper);
+        grid->root[r].node = NULL;
+        grid->root_count--;
+    }
+
+    // Entradas removidas quebram as sequências de sondagem: reconstrói a tabela
+    _root_rehash(grid, grid->root_capacity);
+
+    grid->voxel_count = 0;
+    grid->emptied = 0;
+    sparse_grid_for_each(grid, _grow_bbox, grid);
+}
+
+typedef struct {
+    IVector3 min, max;  //[min, max)
+    size_t count;
+} Outside_Count;
+
+static void _count_outside(void *user, Voxel_Object voxel) {
+    Outside_Count *outside = (Outside_Count*)user;
+    IVector3 c = voxel.coord;
+    outside->count += c.x < outside->min.x || c.y < outside->min.y || c.z < outside->min.z
+                   || c.x >= outside->max.x || c.y >= outside->max.y || c.z >= outside->max.z;
+}
+
+// Voxels fora de [min, max): sem varrer o grid se a caixa de tudo já couber
+size_t sparse_grid_count_outside(Sparse_Grid *grid, IVector3 min, IVector3 max) {
+    if (!grid || grid->voxel_count == 0) return 0;
+    IVector3 lo = grid->bbox_min, hi = grid->bbox_max;
+    if (lo.x >= min.x && lo.y >= min.y && lo.z >= min.z && hi.x < max.x && hi.y < max.y && hi.z < max.z) return 0;
+    Outside_Count outside = {min, max, 0};
+    sparse_grid_for_each(grid, _count_outside, &outside);
+    return outside.count;
+}
+
+static void _insert_into_octree(void *user, Voxel_Object voxel) {
+    octree_insert((Octree*)user, voxel);
+}
+
+// O renderer só entende o fluxo SVO de limites fixos: a textura leva apenas o que
+// estiver dentro de world_min/world_max (o resto continua no grid para a CPU, e o que
+// ficou de fora é avisado).
+uint8_t *sparse_grid_texture(Sparse_Grid *grid, IVector3 world_min, IVector3 world_max, size_t *arr_size, size_t tex_dim) {
+    if (!grid || !arr_size) return NULL;
+
+    size_t outside = sparse_grid_count_outside(grid, world_min, world_max);
+    if (outside) fprintf(stderr, "Esparso: %zu voxels fora dos limites do mundo ficam fora da textura\n", outside);
+    Octree *tmp = octree_create(NULL, world_min, world_max);
+    if (!tmp) return NULL;
+    sparse_grid_for_each(grid, _insert_into_octree, tmp);
+    octree_compact(tmp, 0);
+
+    uint8_t *texture = octree_texture(tmp, arr_size, tex_dim);
+    octree_delete(tmp);
+    return texture;
+}
+
+size_t sparse_grid_memory_usage(Sparse_Grid *grid) {
+    if (!grid) return 0;
+    return sizeof(Sparse_Grid)
+         + grid->root_capacity * sizeof(Sparse_Root_Entry)
+         + grid->root_count * sizeof(Sparse_Upper)
+         + grid->lower_count * sizeof(Sparse_Lower)
+         + grid->leaf_count * sizeof(Sparse_Leaf)
+         + palette_memory_usage(&grid->palette);
+}
+
+void sparse_grid_delete(Sparse_Grid *grid) {
+    if (!grid) return;
+
+    for (size_t r = 0; r < grid->root_capacity; r++) {
+        Sparse_Upper *upper = grid->root[r].node;
+        if (!upper) continue;
+
+        FOR_EACH_BIT(upper->mask, SPARSE_UPPER_CHILDREN / 64, us) {
+            Sparse_Lower *lower = upper->children[us];
+            FOR_EACH_BIT(lower->mask, SPARSE_LOWER_CHILDREN / 64, ls) free(lower->children[ls]);
+            free(lower);
+        }
+        free(upper);
+    }
+    free(grid->root);
+    palette_free(&grid->palette);
+    free(grid);
+}
@@ -0,0 +1,373 @@
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+}
+#include <sunCache.hpp>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string.h>
+#include <math.h>
+
+#define TABLE_INITIAL_CAPACITY 64
+#define SUN_GPU_HEADER 8 //ints antes da tabela no buffer da GPU
+// Abaixo disto (voxels por lote) o cálculo fica numa thread só
+#define SUN_MIN_CELLS_PER_THREAD 512
+
+static double _now_ms(void) {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+// --- Blocos (tabela hash) ---
+
+static IVector3 _origin(IVector3 c) {
+    const int m = SUN_BRICK_DIM - 1;
+    return {{c.x & ~m, c.y & ~m, c.z & ~m}};
+}
+
+static int _cell(IVector3 c) {
+    const int m = SUN_BRICK_DIM - 1;
+    return (c.x & m) + SUN_BRICK_DIM * ((c.y & m) + SUN_BRICK_DIM * (c.z & m));
+}
+
+static IVector3 _cell_coord(const Sun_Brick *brick, int cell) {
+    return ivec3_add(brick->origin, {{cell % SUN_BRICK_DIM, (cell / SUN_BRICK_DIM) % SUN_BRICK_DIM, cell / (SUN_BRICK_DIM * SUN_BRICK_DIM)}});
+}
+
+// O mesmo hash do shader (brickSlot)
+static size_t _hash(IVector3 origin) {
+    uint32_t x = (uint32_t)(origin.x >> SUN_BRICK_LOG2), y = (uint32_t)(origin.y >> SUN_BRICK_LOG2), z = (uint32_t)(origin.z >> SUN_BRICK_LOG2);
+    return (size_t)((x * 73856093u) ^ (y * 19349663u) ^ (z * 83492791u));
+}
+
+static bool _same(IVector3 a, IVector3 b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+static Sun_Brick **_slot(Sun_Brick **table, size_t capacity, IVector3 origin) {
+    size_t i = _hash(origin) & (capacity - 1);
+    while (table[i] && !_same(table[i]->origin, origin)) i = (i + 1) & (capacity - 1);
+    return &table[i];
+}
+
+static bool _rehash(Sun_Cache *cache, size_t capacity) {
+    Sun_Brick **table = (Sun_Brick**)calloc(capacity, sizeof(Sun_Brick*));
+    if (!table) return false;
+    for (size_t i = 0; i < cache->capacity; i++) {
+        if (cache->table[i]) *_slot(table, capacity, cache->table[i]->origin) = cache->table[i];
+    }
+    free(cache->table);
+    cache->table = table;
+    cache->capacity = capacity;
+    return true;
+}
+
+static Sun_Brick *_find(const Sun_Cache *cache, IVector3 coord) {
+    return *_slot(cache->table, cache->capacity, _origin(coord));
+}
+
+static Sun_Brick *_find_or_create(Sun_Cache *cache, IVector3 coord) {
+    Sun_Brick *brick = _find(cache, coord);
+    if (brick) return brick;
+    if ((cache->count + 1) * 2 > cache->capacity && !_rehash(cache, cache->capacity * 2)) return NULL;
+    brick = (Sun_Brick*)calloc(1, sizeof(Sun_Brick));
+    if (!brick) return NULL;
+    brick->origin = _origin(coord);
+    *_slot(cache->table, cache->capacity, brick->origin) = brick;
+    cache->count++;
+    return brick;
+}
+
+static bool _test(const uint64_t *mask, int bit) {
+    return (mask[bit >> 6] >> (bit & 63)) & 1ull;
+}
+
+// --- Fila de blocos sujos ---
+
+static bool _enqueue(Sun_Cache *cache, Sun_Brick *brick) {
+    if (brick->queued) return true;
+    if (cache->queue_count == cache->queue_capacity) {
+        size_t capacity = cache->queue_capacity ? cache->queue_capacity * 2 : 64;
+        Sun_Brick **queue = (Sun_Brick**)malloc(capacity * sizeof(Sun_Brick*));
+        if (!queue) return false;
+        for (size_t i = 0; i < cache->queue_count; i++) queue[i] = cache->queue[(cache->queue_first + i) % cache->queue_capacity];
+        free(cache->queue);
+        cache->queue = queue;
+        cache->queue_first = 0;
+        cache->queue_capacity = capacity;
+    }
+    cache->queue[(cache->queue_first + cache->queue_count) % cache->queue_capacity] = brick;
+    cache->queue_count++;
+    brick->queued = true;
+    return true;
+}
+
+// A face volta para o raio de sombra até o voxel ser recalculado
+static void _mark(Sun_Cache *cache, Sun_Brick *brick, int cell) {
+    brick->faces[cell] = 0;
+    if (_test(brick->dirty, cell)) return;
+    brick->dirty[cell >> 6] |= 1ull << (cell & 63);
+    cache->dirty++;
+    _enqueue(cache, brick);
+}
+
+// --- API ---
+
+// 'faces' calcula um voxel com o mundo atual (ver Sun_Cache::faces)
+Sun_Cache *sun_cache_create(Vector3 direction, uint16_t (*faces)(void *user, IVector3 coord, Vector3 sun), void *user) {
+    if (!faces) return NULL;
+    Sun_Cache *cache = (Sun_Cache*)calloc(1, sizeof(Sun_Cache));
+    if (!cache) return NULL;
+    cache->direction = vec3_normalize(direction);
+    cache->faces = faces;
+    cache->user = user;
+    cache->capacity = TABLE_INITIAL_CAPACITY;
+    cache->table = (Sun_Brick**)calloc(cache->capacity, sizeof(Sun_Brick*));
+    if (!cache->table) {
+        free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+// Sol em outra direção: todas as faces voltam para o raio de sombra e são recalculadas
+// aos poucos pelos próximos sun_cache_update. false se a direção não mudou.
+bool sun_cache_set_direction(Sun_Cache *cache, Vector3 direction) {
+    if (!cache) return false;
+    direction = vec3_normalize(direction);
+    if (vec3_dot(direction, cache->direction) > 1.0f - SUN_SAME_DIRECTION) return false;
+    cache->direction = direction;
+    for (size_t i = 0; i < cache->capacity; i++) {
+        Sun_Brick *brick = cache->table[i];
+        if (!brick) continue;
+        for (int cell = 0; cell < SUN_BRICK_CELLS; cell++) {
+            if (brick->faces[cell]) _mark(cache, brick, cell);
+        }
+    }
+    return true;
+}
+
+// Os voxels de [vox_min, vox_max] (inclusivos) serão (re)calculados
+void sun_cache_touch(Sun_Cache *cache, IVector3 vox_min, IVector3 vox_max) {
+    if (!cache) return;
+    IVector3 min = ivec3_min(vox_min, vox_max), max = ivec3_max(vox_min, vox_max);
+    for (int z = min.z; z <= max.z; z++)
+    for (int y = min.y; y <= max.y; y++)
+    for (int x = min.x; x <= max.x; x++) {
+        Sun_Brick *brick = _find_or_create(cache, {{x, y, z}});
+        if (brick) _mark(cache, brick, _cell({{x, y, z}}));
+    }
+}
+
+// Raio de 'from' na direção do sol passa pela caixa [lo, hi]? (slab test)
+static bool _toward_box(Vector3 from, Vector3 sun, const float lo[3], const float hi[3]) {
+    float p[3] = {from.x, from.y, from.z}, d[3] = {sun.x, sun.y, sun.z};
+    float t_min = 0.0f, t_max = 1e30f;
+    for (int a = 0; a < 3; a++) {
+        if (fabsf(d[a]) < 1e-8f) {
+            if (p[a] < lo[a] || p[a] > hi[a]) return false;
+            continue;
+        }
+        float t0 = (lo[a] - p[a]) / d[a], t1 = (hi[a] - p[a]) / d[a];
+        if (t0 > t1) { float t = t0; t0 = t1; t1 = t; }
+        if (t0 > t_min) t_min = t0;
+        if (t1 < t_max) t_max = t1;
+        if (t_min > t_max) return false;
+    }
+    return true;
+}
+
+// Depois de editar [vox_min, vox_max] (inclusivos): recalcula a caixa com um voxel de
+// folga (faces que apareceram ou sumiram) e os voxels na sombra dela, os que olham para o
+// sol através da caixa. Blocos inteiros fora da sombra são descartados por um teste só
+// (a caixa crescida por meio bloco contra o raio do centro do bloco).
+void sun_cache_invalidate(Sun_Cache *cache, IVector3 vox_min, IVector3 vox_max) {
+    if (!cache) return;
+    IVector3 min = ivec3_min(vox_min, vox_max), max = ivec3_max(vox_min, vox_max);
+    sun_cache_touch(cache, ivec3_scalar_add(min, -1), ivec3_scalar_add(max, 1));
+
+    const float half_brick = SUN_BRICK_DIM * 0.5f, eps = 1e-3f;
+    float brick_lo[3] = {min.x - half_brick - eps, min.y - half_brick - eps, min.z - half_brick - eps};
+    float brick_hi[3] = {max.x + 1 + half_brick + eps, max.y + 1 + half_brick + eps, max.z + 1 + half_brick + eps};
+    float cell_lo[3] = {min.x - 0.5f - eps, min.y - 0.5f - eps, min.z - 0.5f - eps};
+    float cell_hi[3] = {max.x + 1.5f + eps, max.y + 1.5f + eps, max.z + 1.5f + eps};
+    for (size_t i = 0; i < cache->capacity; i++) {
+        Sun_Brick *brick = cache->table[i];
+        if (!brick) continue;
+        Vector3 center = vec3_float(brick->origin.x + half_brick, brick->origin.y + half_brick, brick->origin.z + half_brick);
+        if (!_toward_box(center, cache->direction, brick_lo, brick_hi)) continue;
+        for (int cell = 0; cell < SUN_BRICK_CELLS; cell++) {
+            if (!brick->faces[cell]) continue; //sem voxel ou já sujo
+            IVector3 c = _cell_coord(brick, cell);
+            if (_toward_box(vec3_float(c.x + 0.5f, c.y + 0.5f, c.z + 0.5f), cache->direction, cell_lo, cell_hi)) {
+                _mark(cache, brick, cell);
+            }
+        }
+    }
+}
+
+typedef struct {
+    const Sun_Cache *cache;
+    const IVector3 *coords;
+    uint16_t *results;
+} Sun_Batch;
+
+static void _compute(const Sun_Batch *batch, size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) {
+        batch->results[i] = batch->cache->faces(batch->cache->user, batch->coords[i], batch->cache->direction);
+    }
+}
+
+static void _compute_parallel(const Sun_Batch *batch, size_t count, int threads) {
+    int workers = threads > 0 ? threads : (int)std::thread::hardware_concurrency();
+    if (workers < 1) workers = 1;
+    if ((size_t)workers > count / SUN_MIN_CELLS_PER_THREAD) workers = (int)(count / SUN_MIN_CELLS_PER_THREAD);
+    if (workers <= 1) {
+        _compute(batch, 0, count);
+        return;
+    }
+    std::vector<std::thread> pool;
+    for (int w = 0; w < workers; w++) {
+        pool.emplace_back(_compute, batch, count * w / workers, count * (w + 1) / workers);
+    }
+    for (std::thread &t : pool) t.join();
+}
+
+// Calcula voxels sujos em lotes até 'budget_ms' passar (0 = todos), os lotes divididos
+// entre 'threads' threads (0 = uma por núcleo); true se alguma face mudou (o buffer da GPU precisa ser reenviado).
+// Com orçamento, o lote é cortado pelo ritmo medido no anterior para não estourar o
+// quadro. Blocos que ficaram sem voxel saem da tabela.
+bool sun_cache_update(Sun_Cache *cache, double budget_ms, int threads) {
+    if (!cache) return false;
+    cache->computed = 0;
+    if (!cache->queue_count) return false;
+
+    double t0 = _now_ms(), cells_per_ms = 0.0;
+    std::vector<IVector3> coords;
+    std::vector<uint16_t> results;
+    std::vector<std::pair<Sun_Brick*, int>> cells;
+    std::vector<Sun_Brick*> emptied;
+    while (cache->queue_count) {
+        size_t limit = SUN_BATCH_CELLS;
+        if (budget_ms > 0.0 && cells_per_ms > 0.0) {
+            double fit = cells_per_ms * (budget_ms - (_now_ms() - t0));
+            if (fit < (double)limit) limit = fit < 64.0 ? 64 : (size_t)fit;
+        }
+
+        // Da frente da fila; o bloco só sai dela quando não sobra voxel sujo
+        coords.clear();
+        cells.clear();
+        while (cache->queue_count && coords.size() < limit) {
+            Sun_Brick *brick = cache->queue[cache->queue_first];
+            for (int cell = 0; cell < SUN_BRICK_CELLS && coords.size() < limit; cell++) {
+                if (!_test(brick->dirty, cell)) continue;
+                brick->dirty[cell >> 6] &= ~(1ull << (cell & 63));
+                coords.push_back(_cell_coord(brick, cell));
+                cells.push_back({brick, cell});
+            }
+            bool drained = true;
+            for (int w = 0; w < SUN_BRICK_CELLS / 64 && drained; w++) drained = brick->dirty[w] == 0;
+            if (!drained) break;
+            cache->queue_first = (cache->queue_first + 1) % cache->queue_capacity;
+            cache->queue_count--;
+            brick->queued = false;
+        }
+        double b0 = _now_ms();
+        results.assign(coords.size(), 0);
+        Sun_Batch batch = {cache, coords.data(), results.data()};
+        _compute_parallel(&batch, coords.size(), threads);
+        double batch_ms = _now_ms() - b0;
+        if (batch_ms > 0.0) cells_per_ms = (double)coords.size() / batch_ms;
+
+        emptied.clear();
+        for (size_t i = 0; i < cells.size(); i++) {
+            Sun_Brick *brick = cells[i].first;
+            brick->faces[cells[i].second] = results[i];
+            if (brick->queued || (i + 1 < cells.size() && cells[i + 1].first == brick)) continue;
+            bool empty = true;
+            for (int cell = 0; cell < SUN_BRICK_CELLS && empty; cell++) empty = brick->faces[cell] == 0;
+            if (empty) emptied.push_back(brick);
+        }
+        if (!emptied.empty()) {
+            // Sai da tabela de uma vez (o endereçamento aberto não aceita buracos no meio das
+            // sequências) e só então libera
+            std::sort(emptied.begin(), emptied.end());
+            for (size_t i = 0; i < cache->capacity; i++) {
+                if (cache->table[i] && std::binary_search(emptied.begin(), emptied.end(), cache->table[i])) cache->table[i] = NULL;
+            }
+            _rehash(cache, cache->capacity);
+            for (Sun_Brick *brick : emptied) free(brick);
+            cache->count -= emptied.size();
+        }
+        cache->dirty -= coords.size();
+        cache->computed += coords.size();
+        if (budget_ms > 0.0 && _now_ms() - t0 >= budget_ms) break;
+    }
+    return true;
+}
+
+// 1 = a face vê o sol, 0 = na sombra, -1 = não calculada (use um raio de sombra)
+int sun_cache_lookup(const Sun_Cache *cache, IVector3 coord, int face) {
+    if (!cache || face < 0 || face > 5) return -1;
+    Sun_Brick *brick = _find(cache, coord);
+    if (!brick) return -1;
+    uint16_t bits = brick->faces[_cell(coord)];
+    if (!(bits & SUN_FACE_COMPUTED(face))) return -1;
+    return (bits & SUN_FACE_LIT(face)) ? 1 : 0;
+}
+
+// Cache para o shader, quase no formato do lightVolume: buffer[0] = capacidade da tabela
+// (potência de 2, 0 = vazia), buffer[1] = blocos, buffer[4..6] = direção do sol do cache
+// (bits do float; o shader ignora o cache se o sol já for outro); a partir de buffer[8] a
+// tabela (4 ints por posição: origem do bloco / SUN_BRICK_DIM e o índice dele, -1 = livre)
+// e os blocos com SUN_BRICK_WORDS ints cada (dois voxels por int, o primeiro na metade baixa)
+int32_t *sun_cache_gpu_buffer(const Sun_Cache *cache, size_t *arr_size) {
+    if (!arr_size) return NULL;
+    size_t count = cache ? cache->count : 0;
+    size_t capacity = 0;
+    if (count) for (capacity = 1; capacity < count * 2; capacity *= 2) {}
+
+    size_t words = SUN_GPU_HEADER + capacity * 4 + count * SUN_BRICK_WORDS;
+    int32_t *buffer = (int32_t*)calloc(words, sizeof(int32_t));
+    if (!buffer) return NULL;
+    *arr_size = words * sizeof(int32_t);
+    buffer[0] = (int32_t)capacity;
+    buffer[1] = (int32_t)count;
+    if (!count) return buffer;
+    memcpy(&buffer[4], &cache->direction.x, sizeof(float));
+    memcpy(&buffer[5], &cache->direction.y, sizeof(float));
+    memcpy(&buffer[6], &cache->direction.z, sizeof(float));
+
+    int32_t *table = buffer + SUN_GPU_HEADER, *bricks = table + capacity * 4;
+    for (size_t i = 0; i < capacity; i++) table[i * 4 + 3] = -1;
+    int32_t index = 0;
+    for (size_t i = 0; i < cache->capacity; i++) {
+        Sun_Brick *brick = cache->table[i];
+        if (!brick) continue;
+        size_t at = _hash(brick->origin) & (capacity - 1);
+        while (table[at * 4 + 3] >= 0) at = (at + 1) & (capacity - 1);
+        table[at * 4 + 0] = brick->origin.x >> SUN_BRICK_LOG2;
+        table[at * 4 + 1] = brick->origin.y >> SUN_BRICK_LOG2;
+        table[at * 4 + 2] = brick->origin.z >> SUN_BRICK_LOG2;
+        table[at * 4 + 3] = index;
+        memcpy(bricks + (size_t)index * SUN_BRICK_WORDS, brick->faces, sizeof(brick->faces)); // little-endian
+        index++;
+    }
+    return buffer;
+}
+
+size_t sun_cache_memory_usage(const Sun_Cache *cache) {
+    if (!cache) return 0;
+    return sizeof(Sun_Cache) + cache->capacity * sizeof(Sun_Brick*) + cache->queue_capacity * sizeof(Sun_Brick*)
+         + cache->count * sizeof(Sun_Brick);
+}
+
+void sun_cache_delete(Sun_Cache *cache) {
+    if (!cache) return;
+    for (size_t i = 0; i < cache->capacity; i++) free(cache->table[i]);
+    free(cache->table);
+    free(cache->queue);
+    free(cache);
+}
@@ -0,0 +1,555 @@
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+    #include <vmm/ray.h>
+}
+#include <svoFile.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#ifndef MIN_HEIGHT
+#define MIN_HEIGHT -1024
+#endif
+
+// Mesmos formatos da textura (ver _encode_pointer e _transform_node_to_texture na octree)
+#define POINTER_LEAF_FLAG 0x800000
+#define POINTER_POINT_FLAG 1
+// No header de um nó interno o bit 23 marca os 2 texels da média depois dos ponteiros
+#define HEADER_FILTER_FLAG 0x800000
+// Cobertura mínima (0-255) para a média de um nó contar como sólida (a metade, como no LOD)
+#define FILTER_COVERAGE 128
+#define TEXTURE_MAX_TEXELS 0x800000
+
+#define CHECKSUM_SEED 0xcbf29ce484222325ull
+#define CHECKSUM_PRIME 0x100000001b3ull
+
+// --- GRAVAÇÃO ---
+
+// FNV-1a em palavras de 8 bytes, com uma dobra para os bits altos também mexerem nos baixos
+// (byte a byte seria lento demais para centenas de MB)
+uint64_t svo_file_checksum(uint64_t hash, const uint8_t *data, size_t size) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * CHECKSUM_PRIME;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; i++) hash = (hash ^ data[i]) * CHECKSUM_PRIME;
+    return hash;
+}
+
+static uint64_t _material_key(const uint8_t *texels) {
+    uint64_t key;
+    memcpy(&key, texels, sizeof(key));
+    return key;
+}
+
+static void _collect_materials(Octree *tree, std::map<uint64_t, Svo_Material> *materials, std::unordered_set<Octree*> *seen) {
+    if (tree->instance) {
+        if (seen->insert(tree->instance).second) _collect_materials(tree->instance, materials, seen);
+        return;
+    }
+    if (tree->children) {
+        for (int i = 0; i < 8; i++) _collect_materials(tree->children[i], materials, seen);
+        return;
+    }
+    if (!tree->has_voxel) return;
+
+    Svo_Material material;
+    octree_leaf_texels(tree->voxel, material.texels);
+    material.color = tree->voxel.color;
+    material.voxel = tree->voxel.voxel;
+    materials->emplace(_material_key(material.texels), material);
+}
+
+static bool _write_all(FILE *fp, const void *data, size_t size) {
+    return size == 0 || fwrite(data, 1, size, fp) == size;
+}
+
+// Grava a árvore (limites da raiz inclusos) em 'path'. Escreve num arquivo temporário e
+// renomeia, então um arquivo pela metade nunca substitui um válido.
+// Dados no disco antes do rename: senão uma queda de energia pode deixar o arquivo
+// novo vazio no lugar do antigo
+static bool _sync(FILE *fp) {
+    if (fflush(fp) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(fp)) == 0;
+#else
+    return fsync(fileno(fp)) == 0;
+#endif
+}
+
+// Imagem do arquivo inteiro em memória (cabeçalho, materiais e texels), para gravar com
+// svo_file_write_image (por exemplo em outra thread, sem a árvore). NULL se a árvore não
+// couber na textura.
+uint8_t *svo_file_encode(Octree *tree, size_t *size) {
+    if (!tree || !size) return NULL;
+    size_t texel_count = _octree_texel_size(tree);
+    if (texel_count > TEXTURE_MAX_TEXELS) return NULL;
+
+    std::map<uint64_t, Svo_Material> table;
+    std::unordered_set<Octree*> seen;
+    _collect_materials(tree, &table, &seen);
+    std::vector<Svo_Material> materials;
+    materials.reserve(table.size());
+    for (const auto &entry : table) materials.push_back(entry.second);
+
+    Svo_File_Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SVO_FILE_MAGIC, sizeof(header.magic));
+    header.version = SVO_FILE_VERSION;
+    header.header_size = sizeof(Svo_File_Header);
+    IVector3 min = tree->left_bot_back, max = tree->right_top_front;
+    header.bounds_min[0] = min.x; header.bounds_min[1] = min.y; header.bounds_min[2] = min.z;
+    header.bounds_max[0] = max.x; header.bounds_max[1] = max.y; header.bounds_max[2] = max.z;
+    // A raiz fica no texel 0; só é folha se a árvore inteira for um volume ou um ponto
+    if (!tree->children && tree->has_voxel) {
+        header.root[2] = (uint8_t)(POINTER_LEAF_FLAG >> 16);
+        header.root[3] = tree->is_point ? POINTER_POINT_FLAG : 0;
+    }
+    header.material_count = (uint32_t)materials.size();
+    header.material_offset = sizeof(Svo_File_Header);
+    size_t tables_end = header.material_offset + materials.size() * sizeof(Svo_Material);
+    header.texel_offset = (tables_end + SVO_FILE_ALIGN - 1) / SVO_FILE_ALIGN * SVO_FILE_ALIGN;
+    header.texel_count = texel_count;
+
+    // calloc: o enchimento entre a tabela e os texels fica zerado
+    uint8_t *image = (uint8_t*)calloc(header.texel_offset + texel_count * 4, 1);
+    if (!image) return NULL;
+    uint8_t *texels = image + header.texel_offset;
+    if (texel_count) octree_texture_write(tree, texels, 0);
+    memcpy(image + header.material_offset, materials.data(), materials.size() * sizeof(Svo_Material));
+    header.checksum = svo_file_checksum(CHECKSUM_SEED, (const uint8_t*)materials.data(), materials.size() * sizeof(Svo_Material));
+    header.checksum = svo_file_checksum(header.checksum, texels, texel_count * 4);
+    memcpy(image, &header, sizeof(header));
+    *size = header.texel_offset + texel_count * 4;
+    return image;
+}
+
+// Grava uma imagem de svo_file_encode: arquivo temporário, fsync e rename, então uma queda
+// nunca deixa um arquivo pela metade em 'path'
+bool svo_file_write_image(const char *path, const uint8_t *image, size_t size) {
+    if (!path || !image) return false;
+    std::string tmp = std::string(path) + ".tmp";
+    FILE *fp = fopen(tmp.c_str(), "wb");
+    if (!fp) return false;
+    bool ok = _write_all(fp, image, size) && _sync(fp);
+    ok = fclose(fp) == 0 && ok;
+
+#ifdef _WIN32
+    // rename não sobrescreve no Windows; apagar antes abriria uma janela sem arquivo nenhum
+    ok = ok && MoveFileExA(tmp.c_str(), path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    ok = ok && rename(tmp.c_str(), path) == 0;
+#endif
+    if (!ok) remove(tmp.c_str());
+    return ok;
+}
+
+bool svo_file_write(const char *path, Octree *tree) {
+    if (!path || !tree) return false;
+    size_t size = 0;
+    uint8_t *image = svo_file_encode(tree, &size);
+    if (!image) return false;
+    bool ok = svo_file_write_image(path, image, size);
+    free(image);
+    return ok;
+}
+
+// --- ABERTURA ---
+
+static bool _map_file(Svo_Map *map, const char *path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        if (view) {
+            map->file = file;
+            map->mapping = mapping;
+            map->mapped = view;
+            map->data = (const uint8_t*)view;
+            map->size = (size_t)file_size.QuadPart;
+            return true;
+        }
+        if (mapping) CloseHandle(mapping);
+    }
+    CloseHandle(file);
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void *view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd); // o mapeamento continua válido sem o descritor
+        if (view != MAP_FAILED) {
+            map->mapped = view;
+            map->data = (const uint8_t*)view;
+            map->size = (size_t)st.st_size;
+            return true;
+        }
+    } else {
+        close(fd);
+    }
+#endif
+
+    // Sem mapeamento: lê o arquivo inteiro
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return false;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    uint8_t *data = size > 0 ? (uint8_t*)malloc((size_t)size) : NULL;
+    bool ok = data && fread(data, 1, (size_t)size, fp) == (size_t)size;
+    fclose(fp);
+    if (!ok) {
+        free(data);
+        return false;
+    }
+    map->data = data;
+    map->size = (size_t)size;
+    return true;
+}
+
+// Cabeçalho coerente com o tamanho do arquivo (as contas não podem estourar)
+static bool _valid_header(const Svo_Map *map) {
+    if (map->size < sizeof(Svo_File_Header)) return false;
+    const Svo_File_Header *h = (const Svo_File_Header*)map->data;
+    if (memcmp(h->magic, SVO_FILE_MAGIC, sizeof(h->magic)) != 0) return false;
+    // A versão 1 é o mesmo formato sem as médias nos nós internos
+    if (h->version < 1 || h->version > SVO_FILE_VERSION || h->header_size != sizeof(Svo_File_Header)) return false;
+    for (int i = 0; i < 3; i++) {
+        if (h->bounds_min[i] >= h->bounds_max[i]) return false;
+    }
+    if (h->material_offset > map->size || h->material_count > (map->size - h->material_offset) / sizeof(Svo_Material)) return false;
+    if (h->material_offset % alignof(Svo_Material) != 0) return false;
+    if (h->texel_count > TEXTURE_MAX_TEXELS || h->texel_offset > map->size) return false;
+    return h->texel_count <= (map->size - h->texel_offset) / 4;
+}
+
+// Aponta os campos do mapa para o cabeçalho, a tabela e os texels de map->data. Em caso
+// de erro o mapa é liberado.
+static Svo_Map *_open_map(Svo_Map *map, bool verify) {
+    if (!_valid_header(map)) {
+        svo_map_delete(map);
+        return NULL;
+    }
+
+    const Svo_File_Header *h = (const Svo_File_Header*)map->data;
+    map->header = h;
+    map->materials = (const Svo_Material*)(map->data + h->material_offset);
+    map->material_count = h->material_count;
+    map->texels = map->data + h->texel_offset;
+    map->texel_count = (size_t)h->texel_count;
+    map->left_bot_back = {{h->bounds_min[0], h->bounds_min[1], h->bounds_min[2]}};
+    map->right_top_front = {{h->bounds_max[0], h->bounds_max[1], h->bounds_max[2]}};
+
+    if (verify) {
+        uint64_t checksum = svo_file_checksum(CHECKSUM_SEED, (const uint8_t*)map->materials, map->material_count * sizeof(Svo_Material));
+        checksum = svo_file_checksum(checksum, map->texels, map->texel_count * 4);
+        if (checksum != h->checksum) {
+            svo_map_delete(map);
+            return NULL;
+        }
+    }
+    return map;
+}
+
+// Abre um mundo gravado por svo_file_write. Com 'verify' o checksum é conferido (lê o
+// arquivo inteiro uma vez, o que o upload faria de qualquer jeito). NULL se o arquivo
+// não existir, for de outra versão ou estiver corrompido.
+Svo_Map *svo_map_open(const char *path, bool verify) {
+    if (!path) return NULL;
+    Svo_Map *map = (Svo_Map*)calloc(1, sizeof(Svo_Map));
+    if (!map) return NULL;
+    if (!_map_file(map, path)) {
+        free(map);
+        return NULL;
+    }
+    return _open_map(map, verify);
+}
+
+// Mesmas consultas sobre uma imagem de svo_file_encode que já está na memória. O mapa
+// passa a ser dono de 'image' (liberada por svo_map_delete, inclusive quando falha).
+Svo_Map *svo_map_from_memory(uint8_t *image, size_t size, bool verify) {
+    if (!image) return NULL;
+    Svo_Map *map = (Svo_Map*)calloc(1, sizeof(Svo_Map));
+    if (!map) {
+        free(image);
+        return NULL;
+    }
+    map->data = image;
+    map->size = size;
+    return _open_map(map, verify);
+}
+
+// --- CONSULTAS ---
+
+static Voxel_Object _material(void *user, const uint8_t *leaf) {
+    Svo_Map *map = (Svo_Map*)user;
+    uint64_t key = _material_key(leaf);
+    size_t lo = 0, hi = map->material_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        uint64_t mid_key = _material_key(map->materials[mid].texels);
+        if (mid_key == key) {
+            Voxel_Object voxel = {0};
+            voxel.color = map->materials[mid].color;
+            voxel.voxel = map->materials[mid].voxel;
+            return voxel;
+        }
+        if (mid_key < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return octree_leaf_voxel(leaf);
+}
+
+static uint32_t _pointer(const uint8_t *texel) {
+    return (uint32_t)texel[0] | ((uint32_t)texel[1] << 8) | ((uint32_t)texel[2] << 16);
+}
+
+static int _child_index(IVector3 pos, IVector3 min, IVector3 max) {
+    int index = 0;
+    if (pos.x >= min.x + (max.x - min.x) / 2) index |= 4;
+    if (pos.y >= min.y + (max.y - min.y) / 2) index |= 2;
+    if (pos.z >= min.z + (max.z - min.z) / 2) index |= 1;
+    return index;
+}
+
+static void _child_box(int index, IVector3 *min, IVector3 *max) {
+    IVector3 mid = {{min->x + (max->x - min->x) / 2, min->y + (max->y - min->y) / 2, min->z + (max->z - min->z) / 2}};
+    if (index & 4) min->x = mid.x; else max->x = mid.x;
+    if (index & 2) min->y = mid.y; else max->y = mid.y;
+    if (index & 1) min->z = mid.z; else max->z = mid.z;
+}
+
+static bool _outside(IVector3 pos, IVector3 min, IVector3 max) {
+    return pos.x < min.x || pos.y < min.y || pos.z < min.z
+        || pos.x >= max.x || pos.y >= max.y || pos.z >= max.z;
+}
+
+// Folha que contém 'pos', como o shader: devolve os texels de dados (NULL = ar) e a
+// caixa do nó. Num nó-ponto que não é a célula do voxel, a caixa encolhe até o maior
+// vazio que contém 'pos' (ver _point_empty_box na octree). Um nó interno com média e
+// lado até 'footprint' para a descida: a média é o acerto se cobrir a metade do nó,
+// senão o nó inteiro conta como ar.
+static const uint8_t *_find_leaf(Svo_Map *map, IVector3 pos, float footprint, IVector3 *node_min, IVector3 *node_max, Ray_Stats *stats) {
+    IVector3 min = map->left_bot_back, max = map->right_top_front;
+    *node_min = min;
+    *node_max = max;
+    if (map->texel_count == 0 || _outside(pos, min, max)) return NULL;
+
+    const uint8_t *pointer = map->header->root;
+    for (int depth = 0; depth < 64; depth++) {
+        if (stats) stats->fetches++;
+        uint32_t addr = _pointer(pointer) & ~POINTER_LEAF_FLAG;
+        if (_pointer(pointer) & POINTER_LEAF_FLAG) {
+            bool is_point = pointer[3] == POINTER_POINT_FLAG;
+            if (addr + (is_point ? 4 : 2) > map->texel_count) return NULL;
+            const uint8_t *leaf = map->texels + (size_t)addr * 4;
+            if (is_point) {
+                IVector3 point = {{min.x + (leaf[8] | (leaf[9] << 8)), min.y + (leaf[10] | (leaf[11] << 8)), min.z + (leaf[12] | (leaf[13] << 8))}};
+                if (!ivec3_equal_vec(point, pos)) {
+                    while (true) {
+                        int index = _child_index(pos, min, max);
+                        bool same = index == _child_index(point, min, max);
+                        _child_box(index, &min, &max);
+                        if (!same) break;
+                    }
+                    *node_min = min;
+                    *node_max = max;
+                    return NULL;
+                }
+                min = point;
+                max = ivec3_scalar_add(point, 1);
+            }
+            *node_min = min;
+            *node_max = max;
+            return leaf;
+        }
+        if (addr >= map->texel_count) return NULL;
+
+        const uint8_t *header = map->texels + (size_t)addr * 4;
+        uint8_t mask = header[3];
+        size_t start = _pointer(header) & ~HEADER_FILTER_FLAG;
+        int side = std::max(max.x - min.x, std::max(max.y - min.y, max.z - min.z));
+        if ((_pointer(header) & HEADER_FILTER_FLAG) && (float)side <= footprint) {
+            size_t filter = start + __builtin_popcount(mask);
+            if (filter + 2 > map->texel_count) return NULL;
+            const uint8_t *texels = map->texels + filter * 4;
+            return texels[3] >= FILTER_COVERAGE ? texels : NULL;
+        }
+        int index = _child_index(pos, min, max);
+        _child_box(index, &min, &max);
+        *node_min = min;
+        *node_max = max;
+        if (!((mask >> index) & 1)) return NULL;
+
+        size_t slot = start + __builtin_popcount(mask & ((1u << index) - 1));
+        if (slot >= map->texel_count) return NULL;
+        pointer = map->texels + slot * 4;
+    }
+    return NULL;
+}
+
+Voxel_Object svo_map_find(Svo_Map *map, IVector3 coord) {
+    Voxel_Object voxel = {0};
+    voxel.coord.y = MIN_HEIGHT;
+    if (!map) return voxel;
+
+    IVector3 min, max;
+    const uint8_t *leaf = _find_leaf(map, coord, 0.0f, &min, &max, NULL);
+    if (!leaf) return voxel;
+    voxel = _material(map, leaf);
+    voxel.coord = coord;
+    return voxel;
+}
+
+// Mesma marcha da octree (ver _ray_march): pula de uma vez cada nó vazio
+bool svo_map_ray_cast(Svo_Map *map, Ray ray, Voxel_Object *hit) {
+    return svo_map_ray_cast_cone(map, ray, 0.0f, 0.0f, hit, NULL);
+}
+
+// Como svo_map_ray_cast, mas o raio é um cone: a largura dele a uma distância t da origem
+// é width + spread * t (em voxels; spread = ângulo de um pixel para os raios da câmera).
+// A descida para nos nós com média que cabem nessa largura, como no shader. O voxel de
+// um acerto numa média tem a cor média e as propriedades do material dominante.
+bool svo_map_ray_cast_cone(Svo_Map *map, Ray ray, float width, float spread, Voxel_Object *hit, Ray_Stats *stats) {
+    if (!map || map->texel_count == 0) return false;
+
+    Vector3 pos = ray.origin, dir = ray.direction;
+    Vector3 inv = vec3_float(fabsf(dir.x) < 1e-8f ? 1e20f : 1.0f / dir.x,
+                             fabsf(dir.y) < 1e-8f ? 1e20f : 1.0f / dir.y,
+                             fabsf(dir.z) < 1e-8f ? 1e20f : 1.0f / dir.z);
+    IVector3 cell = {{(int)floorf(pos.x), (int)floorf(pos.y), (int)floorf(pos.z)}};
+
+    for (int step = 0; step < 512; step++) {
+        IVector3 min, max;
+        Vector3 travel = vec3_sub(pos, ray.origin);
+        float footprint = width + spread * vec3_len(travel);
+        if (stats) stats->steps++;
+        const uint8_t *leaf = _find_leaf(map, cell, footprint, &min, &max, stats);
+        if (leaf) {
+            if (hit) {
+                *hit = _material(map, leaf);
+                hit->coord = cell;
+            }
+            return true;
+        }
+
+        float tx = ((dir.x > 0.0f ? (float)max.x : (float)min.x) - pos.x) * inv.x;
+        float ty = ((dir.y > 0.0f ? (float)max.y : (float)min.y) - pos.y) * inv.y;
+        float tz = ((dir.z > 0.0f ? (float)max.z : (float)min.z) - pos.z) * inv.z;
+        float t = fminf(tx, fminf(ty, tz));
+        int axis = (tx < ty) ? ((tx < tz) ? 0 : 2) : ((ty < tz) ? 1 : 2);
+
+        // Campo de distância: a caixa vazia em volta pode ir bem além do nó
+        int skip_axis = axis;
+        float skip = distance_field_skip(map->distance, pos, dir, footprint, spread, &skip_axis);
+        if (skip > t) {
+            t = skip;
+            axis = skip_axis;
+        }
+        if (t < 0.0001f) t = 0.0001f;
+        pos = vec3_add(pos, vec3_scalar_mul(dir, t));
+
+        // Empurra levemente para dentro do vizinho (igual ao shader)
+        Vector3 test = pos;
+        if (axis == 0) test.x += dir.x * 0.001f;
+        else if (axis == 1) test.y += dir.y * 0.001f;
+        else test.z += dir.z * 0.001f;
+        cell = {{(int)floorf(test.x), (int)floorf(test.y), (int)floorf(test.z)}};
+        if (_outside(cell, map->left_bot_back, map->right_top_front)) return false;
+    }
+    return false;
+}
+
+static void _for_each_box(Svo_Map *map, const uint8_t *pointer, IVector3 min, IVector3 max, int depth,
+                          void (*fn)(void *user, IVector3 vox_min, IVector3 vox_max), void *user) {
+    uint32_t addr = _pointer(pointer) & ~POINTER_LEAF_FLAG;
+    if (_pointer(pointer) & POINTER_LEAF_FLAG) {
+        if (pointer[3] != POINTER_POINT_FLAG) {
+            fn(user, min, ivec3_scalar_add(max, -1));
+            return;
+        }
+        if (addr + 4 > map->texel_count) return;
+        const uint8_t *leaf = map->texels + (size_t)addr * 4;
+        IVector3 point = {{min.x + (leaf[8] | (leaf[9] << 8)), min.y + (leaf[10] | (leaf[11] << 8)), min.z + (leaf[12] | (leaf[13] << 8))}};
+        fn(user, point, point);
+        return;
+    }
+    if (addr >= map->texel_count || depth >= 64) return;
+
+    const uint8_t *header = map->texels + (size_t)addr * 4;
+    uint8_t mask = header[3];
+    size_t slot = _pointer(header) & ~HEADER_FILTER_FLAG;
+    for (int index = 0; index < 8; index++) {
+        if (!((mask >> index) & 1)) continue;
+        if (slot >= map->texel_count) return;
+        IVector3 child_min = min, child_max = max;
+        _child_box(index, &child_min, &child_max);
+        _for_each_box(map, map->texels + slot * 4, child_min, child_max, depth + 1, fn, user);
+        slot++;
+    }
+}
+
+// Cada folha sólida uma vez, como caixa [vox_min, vox_max] (inclusivos), direto dos
+// texels (ver octree_for_each_box)
+void svo_map_for_each_box(Svo_Map *map, void (*fn)(void *user, IVector3 vox_min, IVector3 vox_max), void *user) {
+    if (!map || !fn || map->texel_count == 0) return;
+    _for_each_box(map, map->header->root, map->left_bot_back, map->right_top_front, 0, fn, user);
+}
+
+// Monta a octree editável (materiais exatos pela tabela)
+Octree *svo_map_to_octree(Svo_Map *map) {
+    if (!map) return NULL;
+    return octree_from_texture(map->texels, map->texel_count, map->header->root,
+                               map->left_bot_back, map->right_top_front, _material, map);
+}
+
+bool svo_map_is_empty(Svo_Map *map) {
+    return !map || map->texel_count == 0;
+}
+
+// O arquivo inteiro conta: depois do upload as páginas dele estão residentes
+size_t svo_map_memory_usage(Svo_Map *map) {
+    if (!map) return 0;
+    return sizeof(Svo_Map) + map->size;
+}
+
+void svo_map_delete(Svo_Map *map) {
+    if (!map) return;
+#ifdef _WIN32
+    if (map->mapped) {
+        UnmapViewOfFile(map->mapped);
+        CloseHandle((HANDLE)map->mapping);
+        CloseHandle((HANDLE)map->file);
+    }
+#else
+    if (map->mapped) munmap(map->mapped, map->size);
+#endif
+    if (!map->mapped) free((void*)map->data);
+    free(map);
+}
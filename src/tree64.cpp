@@ -0,0 +1,460 @@
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+    #include <vmm/ray.h>
+}
+#include <tree64.hpp>
+#include <octree.hpp>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Bit do filho que contém a coordenada local 'l' num nó cujos filhos têm lado 1 << shift
+static int _child_bit(int lx, int ly, int lz, int shift) {
+    return ((lx >> shift) & 3) + TREE64_BRANCH * (((ly >> shift) & 3) + TREE64_BRANCH * ((lz >> shift) & 3));
+}
+
+// Posição do filho no array compactado: quantos filhos existem antes dele
+static int _child_rank(uint64_t mask, int bit) {
+    return __builtin_popcountll(mask & ((1ull << bit) - 1ull));
+}
+
+static int _root_shift(Tree64 *tree) {
+    return 2 * (tree->levels - 1);
+}
+
+Tree64 *tree64_create(IVector3 left_bot_back, IVector3 right_top_front) {
+    Tree64 *tree = (Tree64*)calloc(1, sizeof(Tree64));
+    if (!tree) return NULL;
+
+    // Menor potência de 4 que cobre o maior eixo (a raiz é sempre cúbica)
+    IVector3 ext = ivec3_sub(right_top_front, left_bot_back);
+    int extent = ext.x > ext.y ? (ext.x > ext.z ? ext.x : ext.z) : (ext.y > ext.z ? ext.y : ext.z);
+    tree->levels = 1;
+    while (tree->levels < TREE64_MAX_LEVELS && (1 << (2 * tree->levels)) < extent) tree->levels++;
+
+    tree->left_bot_back = left_bot_back;
+    palette_init(&tree->palette, TREE64_PALETTE_MAX);
+    return tree;
+}
+
+int tree64_side(Tree64 *tree) {
+    return 1 << (2 * tree->levels);
+}
+
+bool tree64_contains(Tree64 *tree, IVector3 coord) {
+    int side = tree64_side(tree);
+    return coord.x >= tree->left_bot_back.x && coord.x < tree->left_bot_back.x + side
+        && coord.y >= tree->left_bot_back.y && coord.y < tree->left_bot_back.y + side
+        && coord.z >= tree->left_bot_back.z && coord.z < tree->left_bot_back.z + side;
+}
+
+// Abre espaço na posição 'rank' de um array compactado com 'count' elementos
+static void *_array_insert(void *array, int count, int rank, size_t elem_size) {
+    uint8_t *grown = (uint8_t*)realloc(array, (count + 1) * elem_size);
+    if (!grown) return NULL;
+    memmove(grown + (rank + 1) * elem_size, grown + rank * elem_size, (count - rank) * elem_size);
+    memset(grown + rank * elem_size, 0, elem_size);
+    return grown;
+}
+
+// Remove a posição 'rank' e encolhe o array (libera quando fica vazio)
+static void *_array_remove(void *array, int count, int rank, size_t elem_size) {
+    uint8_t *bytes = (uint8_t*)array;
+    memmove(bytes + rank * elem_size, bytes + (rank + 1) * elem_size, (count - rank - 1) * elem_size);
+    if (count == 1) {
+        free(array);
+        return NULL;
+    }
+    void *shrunk = realloc(array, (count - 1) * elem_size);
+    return shrunk ? shrunk : array;
+}
+
+// Retorna 0 em sucesso e -1 se o voxel não cabe na árvore (fora da raiz, paleta cheia ou sem memória)
+int tree64_insert(Tree64 *tree, Voxel_Object voxel) {
+    if (!tree || !tree64_contains(tree, voxel.coord)) return -1;
+
+    int material = palette_index(&tree->palette, voxel.color, voxel.voxel);
+    if (material < 0) return -1;
+
+    IVector3 l = ivec3_sub(voxel.coord, tree->left_bot_back);
+    Tree64_Node *node = &tree->root;
+
+    for (int shift = _root_shift(tree); ; shift -= 2) {
+        int bit = _child_bit(l.x, l.y, l.z, shift);
+        int rank = _child_rank(node->child_mask, bit);
+        bool present = (node->child_mask >> bit) & 1ull;
+
+        if (shift == 0) {
+            // Último nível: os filhos são os próprios voxels
+            if (!present) {
+                int count = __builtin_popcountll(node->child_mask);
+                void *materials = _array_insert(node->children, count, rank, sizeof(uint16_t));
+                if (!materials) return -1;
+                node->children = materials;
+                node->child_mask |= (1ull << bit);
+                tree->voxel_count++;
+            }
+            ((uint16_t*)node->children)[rank] = (uint16_t)material;
+            return 0;
+        }
+
+        if (!present) {
+            int count = __builtin_popcountll(node->child_mask);
+            void *children = _array_insert(node->children, count, rank, sizeof(Tree64_Node));
+            if (!children) return -1;
+            node->children = children;
+            node->child_mask |= (1ull << bit);
+            tree->node_count++;
+        }
+        node = &((Tree64_Node*)node->children)[rank];
+    }
+}
+
+Voxel_Object tree64_find(Tree64 *tree, IVector3 coord) {
+    if (!tree || !tree64_contains(tree, coord)) return _invalid_voxel();
+
+    IVector3 l = ivec3_sub(coord, tree->left_bot_back);
+    Tree64_Node *node = &tree->root;
+
+    for (int shift = _root_shift(tree); ; shift -= 2) {
+        int bit = _child_bit(l.x, l.y, l.z, shift);
+        if (!((node->child_mask >> bit) & 1ull)) return _invalid_voxel();
+
+        int rank = _child_rank(node->child_mask, bit);
+        if (shift == 0) {
+            Dense_Material *m = &tree->palette.entries[((uint16_t*)node->children)[rank]];
+            return VoxelObjCreate(m->voxel, m->color, coord);
+        }
+        node = &((Tree64_Node*)node->children)[rank];
+    }
+}
+
+// Remove recursivamente; retorna true se o nó ficou vazio (o pai então apaga o bit dele)
+static bool _remove(Tree64 *tree, Tree64_Node *node, IVector3 l, int shift) {
+    int bit = _child_bit(l.x, l.y, l.z, shift);
+    if (!((node->child_mask >> bit) & 1ull)) return false;
+
+    int rank = _child_rank(node->child_mask, bit);
+    int count = __builtin_popcountll(node->child_mask);
+
+    if (shift == 0) {
+        node->children = _array_remove(node->children, count, rank, sizeof(uint16_t));
+        tree->voxel_count--;
+    } else {
+        Tree64_Node *child = &((Tree64_Node*)node->children)[rank];
+        if (!_remove(tree, child, l, shift - 2)) return false;
+        node->children = _array_remove(node->children, count, rank, sizeof(Tree64_Node));
+        tree->node_count--;
+    }
+    node->child_mask &= ~(1ull << bit);
+    return node->child_mask == 0;
+}
+
+void tree64_remove(Tree64 *tree, IVector3 coord) {
+    if (!tree || !tree64_contains(tree, coord)) return;
+    _remove(tree, &tree->root, ivec3_sub(coord, tree->left_bot_back), _root_shift(tree));
+}
+
+// --- Travessia ---
+// Pilha de nós do caminho atual: depois de atravessar um filho vazio o raio só sobe
+// até o ancestral que ainda contém a nova célula, em vez de recomeçar da raiz.
+typedef struct {
+    Tree64_Node *node;
+    int min[3];
+    int shift; // log2 do lado dos filhos deste nó
+} Tree64_Frame;
+
+static bool _frame_contains(const Tree64_Frame *frame, const int cell[3]) {
+    unsigned side = 1u << (frame->shift + 2);
+    for (int a = 0; a < 3; a++) {
+        if ((unsigned)(cell[a] - frame->min[a]) >= side) return false;
+    }
+    return true;
+}
+
+bool tree64_ray_cast(Tree64 *tree, Ray ray, Voxel_Object *hit, Ray_Stats *stats) {
+    if (!tree || tree->root.child_mask == 0) return false;
+
+    float o[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+    float d[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+    int side = tree64_side(tree);
+    int lo[3] = {tree->left_bot_back.x, tree->left_bot_back.y, tree->left_bot_back.z};
+    int hi[3] = {lo[0] + side, lo[1] + side, lo[2] + side};
+
+    // Evita divisão por zero (igual à octree)
+    float inv[3];
+    for (int a = 0; a < 3; a++) inv[a] = (fabsf(d[a]) < 1e-8f) ? 1e20f : 1.0f / d[a];
+
+    // Recorta o raio contra a caixa da raiz (slabs)
+    float t_enter = -1e30f, t_exit = 1e30f;
+    for (int a = 0; a < 3; a++) {
+        if (d[a] == 0.0f) {
+            if (o[a] < lo[a] || o[a] >= hi[a]) return false;
+            continue;
+        }
+        float t0 = ((float)lo[a] - o[a]) * inv[a];
+        float t1 = ((float)hi[a] - o[a]) * inv[a];
+        if (t0 > t1) { float tmp = t0; t0 = t1; t1 = tmp; }
+        if (t0 > t_enter) t_enter = t0;
+        if (t1 < t_exit) t_exit = t1;
+    }
+    if (t_enter < 0.0f) t_enter = 0.0f;
+    if (t_exit < t_enter) return false;
+
+    int cell[3];
+    for (int a = 0; a < 3; a++) {
+        int c = (int)floorf(o[a] + d[a] * t_enter);
+        if (c < lo[a]) c = lo[a];
+        if (c >= hi[a]) c = hi[a] - 1;
+        cell[a] = c;
+    }
+
+    Tree64_Frame stack[TREE64_MAX_LEVELS];
+    int top = 0;
+    stack[0].node = &tree->root;
+    stack[0].min[0] = lo[0]; stack[0].min[1] = lo[1]; stack[0].min[2] = lo[2];
+    stack[0].shift = _root_shift(tree);
+
+    // Cada iteração sai de pelo menos uma célula vazia
+    int max_steps = side * 3 + 8;
+    for (int i = 0; i < max_steps; i++) {
+        if (stats) stats->steps++;
+
+        while (top > 0 && !_frame_contains(&stack[top], cell)) top--;
+
+        // Desce enquanto a máscara disser que o filho existe
+        int box_min[3], box_side;
+        for (;;) {
+            Tree64_Frame *f = &stack[top];
+            if (stats) stats->fetches++;
+
+            int s = f->shift;
+            int l[3] = {(cell[0] - f->min[0]) >> s, (cell[1] - f->min[1]) >> s, (cell[2] - f->min[2]) >> s};
+            int bit = l[0] + TREE64_BRANCH * (l[1] + TREE64_BRANCH * l[2]);
+            uint64_t mask = f->node->child_mask;
+
+            if (!((mask >> bit) & 1ull)) {
+                // Filho vazio: o bit da máscara já basta para pular o cubo inteiro
+                box_side = 1 << s;
+                for (int a = 0; a < 3; a++) box_min[a] = f->min[a] + (l[a] << s);
+                break;
+            }
+
+            int rank = _child_rank(mask, bit);
+            if (s == 0) {
+                if (hit) {
+                    Dense_Material *m = &tree->palette.entries[((uint16_t*)f->node->children)[rank]];
+                    *hit = VoxelObjCreate(m->voxel, m->color, {{cell[0], cell[1], cell[2]}});
+                }
+                return true;
+            }
+
+            Tree64_Frame *child = &stack[++top];
+            child->node = &((Tree64_Node*)f->node->children)[rank];
+            for (int a = 0; a < 3; a++) child->min[a] = f->min[a] + (l[a] << s);
+            child->shift = s - 2;
+        }
+
+        // Avança até a face de saída do cubo vazio
+        float t_leave = 1e30f;
+        int axis = -1;
+        for (int a = 0; a < 3; a++) {
+            if (d[a] == 0.0f) continue;
+            int face = d[a] > 0.0f ? box_min[a] + box_side : box_min[a];
+            float tf = ((float)face - o[a]) * inv[a];
+            if (tf < t_leave) { t_leave = tf; axis = a; }
+        }
+        if (axis < 0 || t_leave >= t_exit) return false;
+
+        int next = d[axis] > 0.0f ? box_min[axis] + box_side : box_min[axis] - 1;
+        if (next < lo[axis] || next >= hi[axis]) return false;
+
+        // Nos outros eixos o raio ainda está dentro do cubo; limitar a ele evita que o
+        // arredondamento faça o raio voltar para uma célula já visitada
+        for (int a = 0; a < 3; a++) {
+            if (a == axis) continue;
+            int c = (int)floorf(o[a] + d[a] * t_leave);
+            if (c < box_min[a]) c = box_min[a];
+            if (c >= box_min[a] + box_side) c = box_min[a] + box_side - 1;
+            cell[a] = c;
+        }
+        cell[axis] = next;
+    }
+    return false;
+}
+
+// --- Serialização ---
+// Fluxo de texels RGBA8 no mesmo espírito do octree_texture: a raiz fica no texel 0,
+// cada nó ocupa TREE64_NODE_TEXELS (máscara em 2 texels + índice do bloco de filhos)
+// e os filhos de um nó ficam contíguos, na ordem dos bits. No último nível o bloco
+// de filhos é uma lista de folhas de TREE64_LEAF_TEXELS (cor + propriedades).
+static void _write_u32(uint8_t *texture, size_t texel, uint32_t value) {
+    uint8_t *p = &texture[texel * 4];
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    p[2] = (value >> 16) & 0xFF;
+    p[3] = (value >> 24) & 0xFF;
+}
+
+static uint32_t _read_u32(const uint8_t *texture, size_t texel) {
+    const uint8_t *p = &texture[texel * 4];
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void _write_leaf(uint8_t *texture, size_t texel, Dense_Material *m) {
+    uint8_t *p = &texture[texel * 4];
+    p[0] = get_red_rgba(m->color);
+    p[1] = get_green_rgba(m->color);
+    p[2] = get_blue_rgba(m->color);
+    p[3] = 255;
+    p[4] = (uint8_t)(m->voxel.refraction * 85.0f);
+    p[5] = (uint8_t)(m->voxel.illumination * 255.0f);
+    p[6] = (uint8_t)(m->voxel.k * 255.0f);
+    p[7] = get_alpha_rgba(m->color);
+}
+
+static size_t _serialized_texels(Tree64_Node *node, int shift) {
+    int count = __builtin_popcountll(node->child_mask);
+    if (shift == 0) return TREE64_NODE_TEXELS + (size_t)count * TREE64_LEAF_TEXELS;
+
+    size_t total = TREE64_NODE_TEXELS;
+    for (int i = 0; i < count; i++) total += _serialized_texels(&((Tree64_Node*)node->children)[i], shift - 2);
+    return total;
+}
+
+static void _serialize_node(Tree64 *tree, Tree64_Node *node, int shift, size_t at, uint8_t *texture, size_t *next_free) {
+    int count = __builtin_popcountll(node->child_mask);
+    size_t base = *next_free;
+
+    _write_u32(texture, at, (uint32_t)(node->child_mask & 0xFFFFFFFFull));
+    _write_u32(texture, at + 1, (uint32_t)(node->child_mask >> 32));
+    _write_u32(texture, at + 2, (uint32_t)base);
+
+    if (shift == 0) {
+        uint16_t *materials = (uint16_t*)node->children;
+        for (int i = 0; i < count; i++) _write_leaf(texture, base + i * TREE64_LEAF_TEXELS, &tree->palette.entries[materials[i]]);
+        *next_free += (size_t)count * TREE64_LEAF_TEXELS;
+        return;
+    }
+
+    // Reserva o bloco de irmãos antes de descer, para que fiquem contíguos
+    *next_free += (size_t)count * TREE64_NODE_TEXELS;
+    Tree64_Node *children = (Tree64_Node*)node->children;
+    for (int i = 0; i < count; i++) {
+        _serialize_node(tree, &children[i], shift - 2, base + i * TREE64_NODE_TEXELS, texture, next_free);
+    }
+}
+
+uint8_t *tree64_serialize(Tree64 *tree, size_t *arr_size) {
+    if (!tree || !arr_size) return NULL;
+    *arr_size = 0;
+    if (tree->root.child_mask == 0) return NULL;
+
+    size_t texels = _serialized_texels(&tree->root, _root_shift(tree));
+    uint8_t *texture = (uint8_t*)calloc(texels * 4, sizeof(uint8_t));
+    if (!texture) return NULL;
+
+    size_t next_free = TREE64_NODE_TEXELS;
+    _serialize_node(tree, &tree->root, _root_shift(tree), 0, texture, &next_free);
+
+    *arr_size = texels * 4;
+    return texture;
+}
+
+// Busca direto no fluxo serializado (mesmo caminho que um shader faria)
+Voxel_Object tree64_stream_find(const uint8_t *stream, size_t arr_size, IVector3 left_bot_back, int levels, IVector3 coord) {
+    if (!stream || arr_size < TREE64_NODE_TEXELS * 4) return _invalid_voxel();
+
+    int side = 1 << (2 * levels);
+    IVector3 l = ivec3_sub(coord, left_bot_back);
+    if (l.x < 0 || l.y < 0 || l.z < 0 || l.x >= side || l.y >= side || l.z >= side) return _invalid_voxel();
+
+    size_t texels = arr_size / 4;
+    size_t at = 0;
+    for (int shift = 2 * (levels - 1); ; shift -= 2) {
+        uint64_t mask = (uint64_t)_read_u32(stream, at) | ((uint64_t)_read_u32(stream, at + 1) << 32);
+        int bit = _child_bit(l.x, l.y, l.z, shift);
+        if (!((mask >> bit) & 1ull)) return _invalid_voxel();
+
+        size_t child = _read_u32(stream, at + 2) + (size_t)_child_rank(mask, bit) * (shift == 0 ? TREE64_LEAF_TEXELS : TREE64_NODE_TEXELS);
+        if (child + (shift == 0 ? TREE64_LEAF_TEXELS : TREE64_NODE_TEXELS) > texels) return _invalid_voxel();
+
+        if (shift == 0) {
+            const uint8_t *p = &stream[child * 4];
+            Voxel voxel = {p[4] / 85.0f, p[5] / 255.0f, p[6] / 255.0f};
+            return VoxelObjCreate(voxel, make_color_rgba(p[0], p[1], p[2], p[7]), coord);
+        }
+        at = child;
+    }
+}
+
+static void _insert_into_octree(void *user, Voxel_Object voxel) {
+    octree_insert((Octree*)user, voxel);
+}
+
+// O renderer atual só entende o fluxo SVO; como na grade densa, passamos pela octree
+// com os limites do mundo. tree64_serialize é o formato nativo desta árvore.
+uint8_t *tree64_texture(Tree64 *tree, IVector3 world_min, IVector3 world_max, size_t *arr_size, size_t tex_dim) {
+    if (!tree || !arr_size) return NULL;
+
+    Octree *tmp = octree_create(NULL, world_min, world_max);
+    if (!tmp) return NULL;
+    tree64_for_each(tree, _insert_into_octree, tmp);
+    octree_compact(tmp, 0);
+
+    uint8_t *texture = octree_texture(tmp, arr_size, tex_dim);
+    octree_delete(tmp);
+    return texture;
+}
+
+static void _for_each(Tree64 *tree, Tree64_Node *node, IVector3 min, int shift,
+                      void (*fn)(void *user, Voxel_Object voxel), void *user) {
+    uint64_t mask = node->child_mask;
+    int rank = 0;
+    while (mask) {
+        int bit = __builtin_ctzll(mask);
+        mask &= mask - 1;
+
+        IVector3 child_min = {{
+            min.x + ((bit % TREE64_BRANCH) << shift),
+            min.y + (((bit / TREE64_BRANCH) % TREE64_BRANCH) << shift),
+            min.z + ((bit / (TREE64_BRANCH * TREE64_BRANCH)) << shift)
+        }};
+        if (shift == 0) {
+            Dense_Material *m = &tree->palette.entries[((uint16_t*)node->children)[rank]];
+            fn(user, VoxelObjCreate(m->voxel, m->color, child_min));
+        } else {
+            _for_each(tree, &((Tree64_Node*)node->children)[rank], child_min, shift - 2, fn, user);
+        }
+        rank++;
+    }
+}
+
+void tree64_for_each(Tree64 *tree, void (*fn)(void *user, Voxel_Object voxel), void *user) {
+    if (!tree || !fn) return;
+    _for_each(tree, &tree->root, tree->left_bot_back, _root_shift(tree), fn, user);
+}
+
+size_t tree64_memory_usage(Tree64 *tree) {
+    if (!tree) return 0;
+    return sizeof(Tree64)
+         + tree->node_count * sizeof(Tree64_Node)
+         + tree->voxel_count * sizeof(uint16_t)
+         + palette_memory_usage(&tree->palette);
+}
+
+static void _delete_node(Tree64_Node *node, int shift) {
+    if (shift > 0) {
+        int count = __builtin_popcountll(node->child_mask);
+        for (int i = 0; i < count; i++) _delete_node(&((Tree64_Node*)node->children)[i], shift - 2);
+    }
+    free(node->children);
+}
+
+void tree64_delete(Tree64 *tree) {
+    if (!tree) return;
+    _delete_node(&tree->root, _root_shift(tree));
+    palette_free(&tree->palette);
+    free(tree);
+}
@@ -1,4 +1,7 @@
 #include "voxReader.hpp"
+extern "C" {
+    #include <vmm/ivec3.h>
+}
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -7,6 +10,22 @@
 #include <cstring>
 #include <vector>
 #include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include <svoFile.hpp>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
 
 // GLM é usado para matemática matricial (essencial para o grafo de cena)
 #include <glm/glm.hpp>
@@ -14,7 +33,8 @@
 #include <glm/gtc/type_ptr.hpp>
 
 // --- CONFIGURAÇÃO DE SEGURANÇA ---
-// Limites rígidos para impedir que voxels "explodam" para fora da memória da Octree
+// Limites rígidos para impedir que voxels "explodam" para fora da memória da Octree.
+// Só valem para destinos de limites fixos; o grid esparso recebe tudo.
 const int SAFE_MIN_BOUND = -2048; 
 const int SAFE_MAX_BOUND = 2048;
 
@@ -22,55 +42,10 @@ Voxel defaultVoxelType = voxels[0];
 
 // --- ESTRUTURAS INTERNAS ---
 
-struct VoxModel {
-    glm::ivec3 size;
-    struct VoxelData { uint8_t x, y, z, colorIndex; };
-    std::vector<VoxelData> voxels;
-};
+typedef void (*Vox_Voxel_Sink)(void* user, Voxel_Object voxel);
 
 enum NodeType { NODE_TRN, NODE_GRP, NODE_SHP };
 
-struct SceneNode {
-    int id;
-    NodeType type;
-    
-    // TRN
-    int child_node_id = -1;
-    glm::vec3 translation = {0.0f, 0.0f, 0.0f};
-    uint8_t rotationByte = 4; // 4 = Identidade no padrão VOX
-    
-    // GRP
-    std::vector<int> children_ids;
-    
-    // SHP
-    int model_id = -1;
-};
-
-// --- HELPERS DE LEITURA ---
-
-std::string ReadVoxString(FILE* fp) {
-    int size;
-    if (fread(&size, 4, 1, fp) != 1) return "";
-    if (size <= 0 || size > 1024*1024) return ""; // Limite de segurança
-    std::vector<char> buffer(size + 1);
-    if (fread(buffer.data(), 1, size, fp) != (size_t)size) return "";
-    buffer[size] = '\0';
-    return std::string(buffer.data());
-}
-
-std::map<std::string, std::string> ReadVoxDict(FILE* fp) {
-    std::map<std::string, std::string> dict;
-    int numPairs;
-    if (fread(&numPairs, 4, 1, fp) != 1) return dict;
-    if (numPairs < 0 || numPairs > 1000) return dict; // Limite de segurança
-    for (int i = 0; i < numPairs; i++) {
-        std::string key = ReadVoxString(fp);
-        std::string val = ReadVoxString(fp);
-        dict[key] = val;
-    }
-    return dict;
-}
-
 // Função auxiliar para conversão segura float->int
 inline int SafeRoundToInt(float value) {
     if (value >= 0.0f) {
@@ -90,6 +65,9 @@ glm::mat4 GetRotationMatrix(uint8_t rotByte) {
     int r1 = (rotByte >> 2) & 3;
     int r2 = 3 - r0 - r1; // A linha que sobra
 
+    // Byte inválido (arquivo corrompido): linhas repetidas ou índice 3 não formam rotação
+    if (r0 > 2 || r1 > 2 || r0 == r1) return glm::mat4(1.0f);
+
     int s0 = (rotByte & 16) ? -1 : 1;
     int s1 = (rotByte & 32) ? -1 : 1;
     int s2 = (rotByte & 64) ? -1 : 1;
@@ -116,303 +94,1101 @@ glm::mat4 GetRotationMatrix(uint8_t rotByte) {
     return mat;
 }
 
-// --- TRAVESSIA DO GRAFO ---
+// --- LEITOR MAPEADO (ZERO CÓPIA) ---
 
-void TraverseVoxGraph(
-    int nodeId, 
-    glm::mat4 parentTransform,
-    const std::map<int, SceneNode>& nodes, 
-    const std::vector<VoxModel>& models,
-    const std::vector<ColorRGBA>& palette,
-    Octree* tree,
-    glm::ivec3 worldOrigin
-) {
-    auto it = nodes.find(nodeId);
-    if (it == nodes.end()) return;
+// Arquivo inteiro mapeado somente-leitura. Se o mapeamento falhar (arquivo vazio,
+// sistema sem suporte), o conteúdo é lido de uma vez para 'fallback'.
+struct MappedFile {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    std::vector<uint8_t> fallback;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE, mapping = NULL;
+#else
+    void* mapped = nullptr;
+#endif
+};
 
-    const SceneNode& node = it->second;
-    glm::mat4 currentTransform = parentTransform;
+static bool ReadWholeFile(const char* filename, MappedFile* mf) {
+    FILE* fp = fopen(filename, "rb");
+    if (!fp) return false;
+    fseek(fp, 0, SEEK_END);
+    long fileSize = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (fileSize < 0) { fclose(fp); return false; }
+    mf->fallback.resize((size_t)fileSize);
+    size_t got = fileSize > 0 ? fread(mf->fallback.data(), 1, (size_t)fileSize, fp) : 0;
+    fclose(fp);
+    mf->data = mf->fallback.data();
+    mf->size = got;
+    return true;
+}
 
-    // Aplica transformação se for um nó TRN
-    if (node.type == NODE_TRN) {
-        glm::mat4 translation = glm::translate(glm::mat4(1.0f), node.translation);
-        glm::mat4 rotation = GetRotationMatrix(node.rotationByte);
-        
-        // Combina transformações
-        currentTransform = parentTransform * translation * rotation;
-        
-        // Continua para o filho
-        TraverseVoxGraph(node.child_node_id, currentTransform, nodes, models, palette, tree, worldOrigin);
-    }
-    else if (node.type == NODE_GRP) {
-        // Grupo apenas repassa a matriz para os filhos
-        for (int childId : node.children_ids) {
-            TraverseVoxGraph(childId, currentTransform, nodes, models, palette, tree, worldOrigin);
+static bool MapFile(const char* filename, MappedFile* mf) {
+#ifdef _WIN32
+    mf->file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (mf->file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(mf->file, &fileSize) && fileSize.QuadPart > 0) {
+        mf->mapping = CreateFileMappingA(mf->file, NULL, PAGE_READONLY, 0, 0, NULL);
+        const void* view = mf->mapping ? MapViewOfFile(mf->mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        if (view) {
+            mf->data = (const uint8_t*)view;
+            mf->size = (size_t)fileSize.QuadPart;
+            return true;
         }
     }
-    else if (node.type == NODE_SHP) {
-        // Nó de Geometria (Shape)
-        if (node.model_id < 0 || node.model_id >= (int)models.size()) {
-            return; // Modelo inválido
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED) {
+            posix_madvise(view, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+            close(fd); // o mapeamento continua válido sem o descritor
+            mf->mapped = view;
+            mf->data = (const uint8_t*)view;
+            mf->size = (size_t)st.st_size;
+            return true;
         }
-        
-        const VoxModel& model = models[node.model_id];
-        
-        // Offset de centralização
-        glm::vec3 centerOffset = glm::vec3(
-            model.size.x / 2.0f, 
-            model.size.y / 2.0f, 
-            model.size.z / 2.0f
-        );
-
-        for (const auto& v : model.voxels) {
-            // Validação do índice de cor
-            int colorIdx = (int)v.colorIndex - 1;
-            if (colorIdx < 0 || colorIdx >= 256) {
-                colorIdx = 0; // Cor padrão
-            }
+    }
+    close(fd);
+#endif
+    return ReadWholeFile(filename, mf);
+}
 
-            // Posição local do voxel
-            glm::vec4 localPos(
-                (float)v.x - centerOffset.x, 
-                (float)v.y - centerOffset.y, 
-                (float)v.z - centerOffset.z, 
-                1.0f
-            );
-
-            // Aplica a transformação acumulada do grafo
-            glm::vec4 finalPos = currentTransform * localPos;
-
-            // Conversão segura float->int + offset do mundo
-            // TROCA DE EIXOS: MagicaVoxel (X, Y, Z) -> Engine (X, Z, Y)
-            // MV: X=Right, Y=Forward, Z=Up
-            // Engine (assumindo): X=Right, Y=Up, Z=Forward
-            
-            int fx = worldOrigin.x + SafeRoundToInt(finalPos.x);
-            int fy = worldOrigin.y + SafeRoundToInt(finalPos.z); // Z do VOX -> Y da Engine
-            int fz = worldOrigin.z + SafeRoundToInt(finalPos.y); // Y do VOX -> Z da Engine
-
-            // Proteção de Limites
-            if (fx < SAFE_MIN_BOUND || fx > SAFE_MAX_BOUND ||
-                fy < SAFE_MIN_BOUND || fy > SAFE_MAX_BOUND ||
-                fz < SAFE_MIN_BOUND || fz > SAFE_MAX_BOUND) {
-                continue;
-            }
+static void UnmapFile(MappedFile* mf) {
+#ifdef _WIN32
+    if (mf->mapping) {
+        UnmapViewOfFile(mf->data);
+        CloseHandle(mf->mapping);
+    }
+    if (mf->file != INVALID_HANDLE_VALUE) CloseHandle(mf->file);
+#else
+    if (mf->mapped) munmap(mf->mapped, mf->size);
+#endif
+}
 
-            // Criação e inserção do voxel
-            Voxel_Object voxel = VoxelObjCreate(
-                defaultVoxelType,  // CORRIGIDO: usa o tipo passado como parâmetro
-                palette[colorIdx], 
-                {fx, fy, fz}
-            );
-            octree_insert(tree, voxel);
+// Janela somente-leitura sobre o arquivo mapeado. Toda leitura confere o tamanho:
+// passar do fim marca a view como inválida e devolve zeros, nunca lê fora dela.
+struct VoxView {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    bool ok;
+
+    size_t Remaining() const { return ok ? size - pos : 0; }
+    bool Has(size_t n) const { return n <= Remaining(); }
+
+    int32_t I32() {
+        if (!Has(4)) { ok = false; return 0; }
+        int32_t v;
+        memcpy(&v, data + pos, 4);
+        pos += 4;
+        return v;
+    }
+
+    // Sub-view com os próximos n bytes (e avança sobre eles)
+    VoxView Take(size_t n) {
+        if (!Has(n)) { ok = false; return {data, 0, 0, false}; }
+        VoxView v = {data + pos, n, 0, true};
+        pos += n;
+        return v;
+    }
+
+    VoxView String() {
+        int32_t n = I32();
+        if (n < 0) { ok = false; return {data, 0, 0, false}; }
+        return Take((size_t)n);
+    }
+
+    bool Equals(const char* s) const {
+        size_t n = strlen(s);
+        return ok && size == n && memcmp(data, s, n) == 0;
+    }
+};
+
+static VoxView MakeView(const uint8_t* data, size_t size) {
+    return {data, size, 0, true};
+}
+
+// Pula um DICT e devolve a view com os bytes dele; as chaves só são lidas se alguém pedir
+static VoxView SkipDict(VoxView& v) {
+    size_t start = v.pos;
+    int32_t numPairs = v.I32();
+    for (int32_t i = 0; i < numPairs && v.ok; i++) {
+        v.String();
+        v.String();
+    }
+    if (!v.ok || numPairs < 0) return {v.data, 0, 0, false};
+    return MakeView(v.data + start, v.pos - start);
+}
+
+static bool DictFind(VoxView dict, const char* key, VoxView* value) {
+    if (!dict.ok) return false;
+    int32_t numPairs = dict.I32();
+    for (int32_t i = 0; i < numPairs && dict.ok; i++) {
+        VoxView k = dict.String();
+        VoxView val = dict.String();
+        if (dict.ok && k.Equals(key)) {
+            *value = val;
+            return true;
         }
     }
+    return false;
 }
 
-// --- FUNÇÃO PRINCIPAL ---
+// Copia um valor curto do dicionário para um buffer terminado em zero (para strtol/strtof)
+static bool ViewToCString(VoxView v, char* out, size_t outSize) {
+    if (!v.ok || v.size >= outSize) return false;
+    memcpy(out, v.data, v.size);
+    out[v.size] = '\0';
+    return true;
+}
 
-bool load_vox_file(const char* filename, Octree* tree, int offsetX, int offsetY, int offsetZ) {
-    if (!tree) {
-        std::cerr << "Erro: Octree é NULL!" << std::endl;
-        return false;
+struct VoxModelSpan {
+    glm::ivec3 size;
+    const uint8_t* xyzi; //registros de 4 bytes direto do arquivo mapeado
+    size_t count;
+};
+
+// Nó do grafo apontando para o arquivo: atributos e listas ficam como views
+struct VoxNodeView {
+    NodeType type;
+    int child_node_id = -1; // TRN
+    VoxView frame0;         // TRN: DICT do primeiro frame (_t, _r), lido só ao achatar o grafo
+    VoxView children;       // GRP: int32 ids dos filhos
+    int model_id = -1;      // SHP
+};
+
+// Um modelo posicionado no mundo. A rotação do VOX é uma permutação com sinais, então
+// vira uma tabela inteira; a translação fica em meias unidades porque o centro de um
+// modelo de lado ímpar cai em .5. Resultado idêntico ao caminho com glm::mat4.
+struct VoxInstance {
+    int model;
+    int rot[3][3];
+    glm::ivec3 translation2;
+};
+
+// Arquivo já percorrido: modelos (spans no mapeamento), paleta e o grafo achatado
+struct VoxScene {
+    MappedFile file;
+    std::vector<VoxModelSpan> models;
+    std::vector<ColorRGBA> palette;
+    std::vector<VoxInstance> instances;
+    glm::ivec3 origin;
+    size_t voxel_count = 0;
+};
+
+static void IntRotation(uint8_t rotByte, int out[3][3]) {
+    glm::mat4 m = GetRotationMatrix(rotByte);
+    for (int row = 0; row < 3; row++)
+        for (int col = 0; col < 3; col++)
+            out[row][col] = (int)m[col][row];
+}
+
+static void FlattenGraph(
+    int nodeId,
+    const int rot[3][3],
+    glm::ivec3 translation2,
+    const std::map<int, VoxNodeView>& nodes,
+    VoxScene* scene,
+    int depth
+) {
+    // Um arquivo malformado pode ter ciclos no grafo
+    if (depth > 256) return;
+
+    auto it = nodes.find(nodeId);
+    if (it == nodes.end()) return;
+    const VoxNodeView& node = it->second;
+
+    if (node.type == NODE_TRN) {
+        // Translações do formato são inteiras ("x y z")
+        glm::ivec3 t(0);
+        uint8_t rotationByte = 4; // 4 = Identidade no padrão VOX
+        char buf[64];
+        VoxView value;
+        if (DictFind(node.frame0, "_t", &value) && ViewToCString(value, buf, sizeof(buf))) {
+            char* end = buf;
+            t.x = SafeRoundToInt(strtof(end, &end));
+            t.y = SafeRoundToInt(strtof(end, &end));
+            t.z = SafeRoundToInt(strtof(end, &end));
+        }
+        if (DictFind(node.frame0, "_r", &value) && ViewToCString(value, buf, sizeof(buf))) {
+            rotationByte = (uint8_t)strtol(buf, NULL, 10);
+        }
+
+        // pai * translação * rotação, como no caminho com matrizes
+        int local[3][3], combined[3][3];
+        IntRotation(rotationByte, local);
+        glm::ivec3 child2 = translation2;
+        for (int row = 0; row < 3; row++) {
+            child2[row] += 2 * (rot[row][0] * t.x + rot[row][1] * t.y + rot[row][2] * t.z);
+            for (int col = 0; col < 3; col++) {
+                combined[row][col] = rot[row][0] * local[0][col] + rot[row][1] * local[1][col] + rot[row][2] * local[2][col];
+            }
+        }
+        FlattenGraph(node.child_node_id, combined, child2, nodes, scene, depth + 1);
+    }
+    else if (node.type == NODE_GRP) {
+        VoxView ids = node.children;
+        while (ids.Has(4)) {
+            FlattenGraph(ids.I32(), rot, translation2, nodes, scene, depth + 1);
+        }
     }
+    else if (node.type == NODE_SHP) {
+        if (node.model_id < 0 || node.model_id >= (int)scene->models.size()) return; // Modelo inválido
+        VoxInstance inst;
+        inst.model = node.model_id;
+        memcpy(inst.rot, rot, sizeof(inst.rot));
+        inst.translation2 = translation2;
+        scene->instances.push_back(inst);
+        scene->voxel_count += scene->models[node.model_id].count;
+    }
+}
 
-    FILE* fp = fopen(filename, "rb");
-    if (!fp) {
+// Percorre os chunks direto no arquivo mapeado e achata o grafo em instâncias.
+// Nada é copiado além do grafo (views) e da paleta; os voxels ficam no mapeamento.
+static bool ParseVoxScene(const char* filename, glm::ivec3 origin, VoxScene* scene) {
+    if (!MapFile(filename, &scene->file)) {
         std::cerr << "Erro ao abrir arquivo: " << filename << std::endl;
         return false;
     }
+    scene->origin = origin;
 
-    // Cabeçalho
-    char header[4];
-    int version;
-    if (fread(header, 1, 4, fp) != 4) { fclose(fp); return false; }
-    if (fread(&version, 4, 1, fp) != 1) { fclose(fp); return false; }
-
-    if (strncmp(header, "VOX ", 4) != 0) {
+    VoxView file = MakeView(scene->file.data, scene->file.size);
+    VoxView header = file.Take(4);
+    file.I32(); // versão
+    if (!file.ok || !header.Equals("VOX ")) {
         std::cerr << "Arquivo invalido (Header != VOX)." << std::endl;
-        fclose(fp);
         return false;
     }
 
-    std::vector<VoxModel> models;
-    std::map<int, SceneNode> sceneNodes;
-    std::vector<ColorRGBA> palette(256);
+    std::map<int, VoxNodeView> sceneNodes;
+    scene->palette.resize(256);
     
     // Inicializa paleta padrão (grayscale)
     for(int i=0; i<256; i++) {
-        palette[i] = make_color_rgba(i, i, i, 255);
+        scene->palette[i] = make_color_rgba(i, i, i, 255);
     }
 
     glm::ivec3 lastSize = {0,0,0};
-    
-    // Tamanho do arquivo
-    fseek(fp, 0, SEEK_END);
-    long fileSize = ftell(fp);
-    fseek(fp, 8, SEEK_SET);
 
-    // Parser de Chunks
-    while (ftell(fp) < fileSize - 12) { // -12 para garantir espaço para header do chunk
-        char chunkId[4];
-        int contentSize, childrenSize;
+    // Parser de Chunks: cada chunk vira uma view do próprio conteúdo
+    while (file.Has(12)) {
+        VoxView chunkId = file.Take(4);
+        int32_t contentSize = file.I32();
+        int32_t childrenSize = file.I32();
 
-        if (fread(chunkId, 1, 4, fp) < 4) break;
-        if (fread(&contentSize, 4, 1, fp) < 1) break;
-        if (fread(&childrenSize, 4, 1, fp) < 1) break;
-        
         // Validação de tamanhos
         if (contentSize < 0 || childrenSize < 0) {
             std::cerr << "Tamanhos de chunk inválidos" << std::endl;
             break;
         }
-        
-        long nextChunkPos = ftell(fp) + contentSize;
-        long endOfChunkPos = nextChunkPos + childrenSize;
-        
-        // Verifica se não excede o arquivo
-        if (endOfChunkPos > fileSize) {
+
+        // MAIN não tem conteúdo próprio: os filhos são os chunks seguintes
+        if (chunkId.Equals("MAIN")) continue;
+
+        if (!file.Has((size_t)contentSize + (size_t)childrenSize)) {
             std::cerr << "Chunk excede tamanho do arquivo" << std::endl;
             break;
         }
+        VoxView content = file.Take((size_t)contentSize);
+        file.Take((size_t)childrenSize);
 
-        if (strncmp(chunkId, "MAIN", 4) == 0) {
-            continue; 
-        }
-        else if (strncmp(chunkId, "PACK", 4) == 0) {
-            fseek(fp, contentSize, SEEK_CUR); 
-        }
-        else if (strncmp(chunkId, "SIZE", 4) == 0) {
-            fread(&lastSize.x, 4, 1, fp);
-            fread(&lastSize.y, 4, 1, fp);
-            fread(&lastSize.z, 4, 1, fp);
+        if (chunkId.Equals("SIZE")) {
+            lastSize.x = content.I32();
+            lastSize.y = content.I32();
+            lastSize.z = content.I32();
         }
-        else if (strncmp(chunkId, "XYZI", 4) == 0) {
-            int numVoxels;
-            fread(&numVoxels, 4, 1, fp);
-            
-            if (numVoxels < 0 || numVoxels > 10000000) { // Limite de segurança
+        else if (chunkId.Equals("XYZI")) {
+            int32_t numVoxels = content.I32();
+            if (numVoxels < 0 || !content.Has((size_t)numVoxels * 4)) {
                 std::cerr << "Número de voxels suspeito: " << numVoxels << std::endl;
-                fseek(fp, endOfChunkPos, SEEK_SET);
                 continue;
             }
-            
-            VoxModel model;
-            model.size = lastSize;
-            if (numVoxels > 0) {
-                model.voxels.resize(numVoxels);
-                for(int i=0; i<numVoxels; i++) {
-                    fread(&model.voxels[i].x, 1, 1, fp);
-                    fread(&model.voxels[i].y, 1, 1, fp);
-                    fread(&model.voxels[i].z, 1, 1, fp);
-                    fread(&model.voxels[i].colorIndex, 1, 1, fp);
-                }
-            }
-            models.push_back(model);
+            scene->models.push_back({lastSize, content.data + content.pos, (size_t)numVoxels});
         }
-        else if (strncmp(chunkId, "RGBA", 4) == 0) {
-            for (int i = 0; i < 256; ++i) {
-                unsigned char r, g, b, a;
-                fread(&r, 1, 1, fp); fread(&g, 1, 1, fp);
-                fread(&b, 1, 1, fp); fread(&a, 1, 1, fp);
-                palette[i] = make_color_rgba(r, g, b, a);
+        else if (chunkId.Equals("RGBA")) {
+            for (int i = 0; i < 256 && content.Has(4); ++i) {
+                const uint8_t* c = content.data + content.pos;
+                scene->palette[i] = make_color_rgba(c[0], c[1], c[2], c[3]);
+                content.pos += 4;
             }
         }
-        else if (strncmp(chunkId, "nTRN", 4) == 0) {
-            SceneNode node;
+        else if (chunkId.Equals("nTRN")) {
+            VoxNodeView node;
             node.type = NODE_TRN;
-            fread(&node.id, 4, 1, fp);
-            ReadVoxDict(fp); 
-            fread(&node.child_node_id, 4, 1, fp);
-            int reserved, layerId, numFrames;
-            fread(&reserved, 4, 1, fp);
-            fread(&layerId, 4, 1, fp);
-            fread(&numFrames, 4, 1, fp);
-
-            for(int i=0; i<numFrames; i++) {
-                std::map<std::string, std::string> dict = ReadVoxDict(fp);
-                if (i == 0) { // Frame 0
-                    if (dict.count("_t")) {
-                        std::stringstream ss(dict["_t"]);
-                        ss >> node.translation.x >> node.translation.y >> node.translation.z;
-                    }
-                    if (dict.count("_r")) {
-                        node.rotationByte = (uint8_t)std::stoi(dict["_r"]);
-                    }
-                }
-            }
-            sceneNodes[node.id] = node;
+            int id = content.I32();
+            SkipDict(content);
+            node.child_node_id = content.I32();
+            content.I32(); // reservado
+            content.I32(); // camada
+            int32_t numFrames = content.I32();
+            node.frame0 = numFrames > 0 ? SkipDict(content) : MakeView(content.data, 0);
+            if (content.ok) sceneNodes[id] = node;
         }
-        else if (strncmp(chunkId, "nGRP", 4) == 0) {
-            SceneNode node;
+        else if (chunkId.Equals("nGRP")) {
+            VoxNodeView node;
             node.type = NODE_GRP;
-            fread(&node.id, 4, 1, fp);
-            ReadVoxDict(fp); 
-            int numChildren;
-            fread(&numChildren, 4, 1, fp);
-            for(int i=0; i<numChildren; i++) {
-                int childId;
-                fread(&childId, 4, 1, fp);
-                node.children_ids.push_back(childId);
-            }
-            sceneNodes[node.id] = node;
+            int id = content.I32();
+            SkipDict(content);
+            int32_t numChildren = content.I32();
+            node.children = numChildren >= 0 ? content.Take((size_t)numChildren * 4) : VoxView{content.data, 0, 0, false};
+            if (content.ok) sceneNodes[id] = node;
         }
-        else if (strncmp(chunkId, "nSHP", 4) == 0) {
-            SceneNode node;
+        else if (chunkId.Equals("nSHP")) {
+            VoxNodeView node;
             node.type = NODE_SHP;
-            fread(&node.id, 4, 1, fp);
-            ReadVoxDict(fp); 
-            int numModels;
-            fread(&numModels, 4, 1, fp);
-            for(int i=0; i<numModels; i++) {
-                int modelId;
-                fread(&modelId, 4, 1, fp);
-                ReadVoxDict(fp); 
-                if (i == 0) node.model_id = modelId;
-            }
-            sceneNodes[node.id] = node;
+            int id = content.I32();
+            SkipDict(content);
+            int32_t numModels = content.I32();
+            if (numModels > 0) node.model_id = content.I32();
+            if (content.ok) sceneNodes[id] = node;
         }
-        
-        fseek(fp, endOfChunkPos, SEEK_SET);
     }
-    fclose(fp);
-
-    // --- CONSTRUÇÃO DO MUNDO ---
 
     if (sceneNodes.empty()) {
-        // Modo RAW (Fallback para arquivos sem nTRN)
-        if (!models.empty()) {
+        // Modo RAW (Fallback para arquivos sem nTRN): coordenadas do arquivo, sem centralizar.
+        // Com translação = tamanho (em meias unidades) a fórmula das instâncias devolve x, y, z.
+        if (!scene->models.empty()) {
             std::cout << "Grafo nTRN ausente. Carregando modo RAW." << std::endl;
         }
-        int count = 0;
-        for(const auto& model : models) {
-            for(const auto& v : model.voxels) {
-                int colorIdx = (int)v.colorIndex - 1;
-                if(colorIdx < 0 || colorIdx >= 256) colorIdx = 0;
-                
-                int fx = offsetX + v.x;
-                int fy = offsetY + v.z; // Swap Z->Y
-                int fz = offsetZ + v.y; // Swap Y->Z
-                
-                if (fx < SAFE_MIN_BOUND || fx > SAFE_MAX_BOUND ||
-                    fy < SAFE_MIN_BOUND || fy > SAFE_MAX_BOUND ||
-                    fz < SAFE_MIN_BOUND || fz > SAFE_MAX_BOUND) continue;
-
-                Voxel_Object voxel = VoxelObjCreate(defaultVoxelType, palette[colorIdx], {fx, fy, fz});
-                octree_insert(tree, voxel);
-                count++;
-            }
+        const int identity[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+        for (size_t m = 0; m < scene->models.size(); m++) {
+            VoxInstance inst;
+            inst.model = (int)m;
+            memcpy(inst.rot, identity, sizeof(inst.rot));
+            inst.translation2 = scene->models[m].size;
+            scene->instances.push_back(inst);
+            scene->voxel_count += scene->models[m].count;
         }
-        std::cout << "Carregados " << count << " voxels (modo RAW)." << std::endl;
-        return count > 0;
+        std::cout << "Carregados " << scene->voxel_count << " voxels (modo RAW)." << std::endl;
+        return scene->voxel_count > 0;
     }
 
-    // Modo Grafo de Cena
     if (sceneNodes.count(0)) {
         std::cout << "Processando Grafo de Cena (" << sceneNodes.size() << " nos)..." << std::endl;
-        TraverseVoxGraph(0, glm::mat4(1.0f), sceneNodes, models, palette, tree, 
-                        {offsetX, offsetY, offsetZ});
+        const int identity[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+        FlattenGraph(0, identity, glm::ivec3(0), sceneNodes, scene, 0);
+    }
+    return true;
+}
+
+// Meias unidades -> inteiro, arredondando .5 para longe do zero (igual a SafeRoundToInt)
+static inline int HalfToInt(int v) {
+    return v >= 0 ? (v + 1) >> 1 : -((1 - v) >> 1);
+}
+
+// Cada linha da rotação tem um único ±1: eixo de origem e sinal por eixo de saída
+static void InstanceAxes(const VoxInstance& inst, int axis[3], int sign[3]) {
+    for (int row = 0; row < 3; row++) {
+        axis[row] = 0;
+        sign[row] = 0;
+        for (int col = 0; col < 3; col++) {
+            if (inst.rot[row][col]) { axis[row] = col; sign[row] = inst.rot[row][col]; }
+        }
+    }
+}
+
+// Entrega os voxels [first, last) de uma instância: só somas e trocas de sinal por voxel
+static void EmitInstance(const VoxScene& scene, const VoxInstance& inst, size_t first, size_t last,
+                         Vox_Voxel_Sink sink, void* user) {
+    const VoxModelSpan& model = scene.models[inst.model];
+
+    int axis[3], sign[3];
+    InstanceAxes(inst, axis, sign);
+
+    for (size_t i = first; i < last; i++) {
+        const uint8_t* v = model.xyzi + i * 4;
+        int local2[3] = {2 * v[0] - model.size.x, 2 * v[1] - model.size.y, 2 * v[2] - model.size.z};
+        int px = HalfToInt(inst.translation2.x + sign[0] * local2[axis[0]]);
+        int py = HalfToInt(inst.translation2.y + sign[1] * local2[axis[1]]);
+        int pz = HalfToInt(inst.translation2.z + sign[2] * local2[axis[2]]);
+
+        int colorIdx = (int)v[3] - 1;
+        if (colorIdx < 0 || colorIdx >= 256) colorIdx = 0; // Cor padrão
+
+        // TROCA DE EIXOS: MagicaVoxel (X, Y, Z) -> Engine (X, Z, Y)
+        IVector3 coord = {{scene.origin.x + px, scene.origin.y + pz, scene.origin.z + py}};
+        sink(user, VoxelObjCreate(defaultVoxelType, scene.palette[colorIdx], coord));
     }
+}
+
+// --- INSTANCIAÇÃO PARALELA ---
+
+// Pedaço contíguo dos voxels de uma instância. A lista de jobs segue a ordem do arquivo
+// (e do manifesto), então quem vem depois continua sobrescrevendo quem veio antes.
+struct VoxJob {
+    const VoxScene* scene;
+    const VoxInstance* instance;
+    size_t first, last;
+};
+
+// Abaixo disso por thread, criar a thread custa mais que transformar os voxels
+const size_t MIN_VOXELS_PER_THREAD = 65536;
+const size_t JOB_MAX_VOXELS = 262144;
+
+static std::vector<VoxJob> BuildJobs(const std::vector<VoxScene*>& scenes, size_t* total) {
+    std::vector<VoxJob> jobs;
+    *total = 0;
+    for (const VoxScene* scene : scenes) {
+        for (const VoxInstance& inst : scene->instances) {
+            size_t count = scene->models[inst.model].count;
+            for (size_t first = 0; first < count; first += JOB_MAX_VOXELS) {
+                jobs.push_back({scene, &inst, first, std::min(count, first + JOB_MAX_VOXELS)});
+            }
+            *total += count;
+        }
+    }
+    return jobs;
+}
+
+static int WorkerCount(size_t voxels, const Vox_Load_Options* options) {
+    int requested = options ? options->threads : 0;
+    int workers = requested > 0 ? requested : (int)std::thread::hardware_concurrency();
+    if (workers < 1) workers = 1;
+    if (requested <= 0) workers = (int)std::min<size_t>((size_t)workers, voxels / MIN_VOXELS_PER_THREAD + 1);
+    return workers;
+}
+
+// Divide os jobs em faixas contíguas com quase o mesmo número de voxels (a faixa k vem
+// inteira depois da k-1) e roda cada faixa numa thread. ranges[k] = primeiro job da faixa k.
+typedef void (*Vox_Worker)(void* user, int worker, const VoxJob* begin, const VoxJob* end);
+
+static void RunJobs(const std::vector<VoxJob>& jobs, size_t total, int workers, Vox_Worker fn, void* user) {
+    std::vector<size_t> ranges(workers + 1, jobs.size());
+    ranges[0] = 0;
+    size_t acc = 0;
+    int next = 1;
+    for (size_t j = 0; j < jobs.size() && next < workers; j++) {
+        if (acc >= total * next / workers) ranges[next++] = j;
+        acc += jobs[j].last - jobs[j].first;
+    }
+    for (; next < workers; next++) ranges[next] = jobs.size();
+
+    if (workers == 1) {
+        fn(user, 0, jobs.data(), jobs.data() + jobs.size());
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (int w = 0; w < workers; w++) {
+        threads.emplace_back(fn, user, w, jobs.data() + ranges[w], jobs.data() + ranges[w + 1]);
+    }
+    for (std::thread& t : threads) t.join();
+}
+
+// Lê o arquivo e entrega cada voxel (já transformado para o mundo) ao sink, em ordem
+static bool EmitVoxFile(const char* filename, int offsetX, int offsetY, int offsetZ, Vox_Voxel_Sink sink, void* user) {
+    VoxScene scene;
+    bool ok = ParseVoxScene(filename, {offsetX, offsetY, offsetZ}, &scene);
+    for (const VoxInstance& inst : scene.instances) {
+        EmitInstance(scene, inst, 0, scene.models[inst.model].count, sink, user);
+    }
+    UnmapFile(&scene.file);
+    return ok;
+}
+
+// Proteção de Limites: repassa ao sink só o que está dentro de SAFE_*_BOUND e conta o resto
+struct BoundedSink {
+    Vox_Voxel_Sink sink;
+    void* user;
+    size_t dropped;
+};
+
+static bool InSafeBounds(IVector3 c) {
+    return c.x >= SAFE_MIN_BOUND && c.x <= SAFE_MAX_BOUND &&
+           c.y >= SAFE_MIN_BOUND && c.y <= SAFE_MAX_BOUND &&
+           c.z >= SAFE_MIN_BOUND && c.z <= SAFE_MAX_BOUND;
+}
+
+static void SafeBoundsSink(void* user, Voxel_Object voxel) {
+    BoundedSink* bounded = (BoundedSink*)user;
+    if (!InSafeBounds(voxel.coord)) {
+        bounded->dropped++;
+        return;
+    }
+    bounded->sink(bounded->user, voxel);
+}
+
+static void ReportDropped(const char* filename, size_t dropped) {
+    if (dropped == 0) return;
+    std::cerr << "Aviso: " << dropped << " voxels de " << filename
+              << " fora dos limites do mundo foram descartados." << std::endl;
+}
 
+static void OctreeSink(void* user, Voxel_Object voxel) {
+    octree_insert((Octree*)user, voxel);
+}
+
+// Cada thread monta a própria octree (mesmos limites do destino) e compacta;
+// depois as árvores são enxertadas no destino na ordem das faixas
+struct OctreeBuild {
+    IVector3 min, max;
+    std::vector<Octree*> trees;
+    std::vector<size_t> dropped;
+};
+
+static void OctreeWorker(void* user, int worker, const VoxJob* begin, const VoxJob* end) {
+    OctreeBuild* build = (OctreeBuild*)user;
+    Octree* tree = octree_create(NULL, build->min, build->max);
+    BoundedSink bounded = {OctreeSink, tree, 0};
+    for (const VoxJob* job = begin; job != end; job++) {
+        EmitInstance(*job->scene, *job->instance, job->first, job->last, SafeBoundsSink, &bounded);
+    }
+    octree_compact(tree, 0);
+    build->trees[worker] = tree;
+    build->dropped[worker] = bounded.dropped;
+}
+
+static size_t BuildOctreeParallel(const std::vector<VoxScene*>& scenes, Octree* tree, const Vox_Load_Options* options) {
+    size_t total;
+    std::vector<VoxJob> jobs = BuildJobs(scenes, &total);
+    int workers = WorkerCount(total, options);
+
+    OctreeBuild build = {tree->left_bot_back, tree->right_top_front,
+                         std::vector<Octree*>(workers, nullptr), std::vector<size_t>(workers, 0)};
+    RunJobs(jobs, total, workers, OctreeWorker, &build);
+
+    size_t dropped = 0;
+    for (int w = 0; w < workers; w++) {
+        octree_merge(tree, build.trees[w]);
+        dropped += build.dropped[w];
+    }
+    octree_compact(tree, 0);
+    return dropped;
+}
+
+static bool LoadVoxOctree(const char* filename, Octree* tree, int offsetX, int offsetY, int offsetZ,
+                          const Vox_Load_Options* options) {
+    VoxScene scene;
+    bool ok = ParseVoxScene(filename, {offsetX, offsetY, offsetZ}, &scene);
+    ReportDropped(filename, BuildOctreeParallel({&scene}, tree, options));
+    UnmapFile(&scene.file);
+    return ok;
+}
+
+static void SparseSink(void* user, Voxel_Object voxel) {
+    sparse_accessor_insert((Sparse_Accessor*)user, voxel);
+}
+
+// Sem limites: o grid esparso aceita qualquer coordenada. O accessor aproveita a
+// ordem dos voxels (modelo a modelo) para quase nunca passar pela tabela hash.
+bool load_vox_file(const char* filename, Sparse_Grid* grid, int offsetX, int offsetY, int offsetZ) {
+    if (!grid) {
+        std::cerr << "Erro: Sparse_Grid é NULL!" << std::endl;
+        return false;
+    }
+    Sparse_Accessor acc = sparse_grid_accessor(grid);
+    return EmitVoxFile(filename, offsetX, offsetY, offsetZ, SparseSink, &acc);
+}
+
+// Sem destino fixo nem corte de limites: cada voxel vai direto para 'fn'
+bool load_vox_for_each(const char* filename, void (*fn)(void* user, Voxel_Object voxel), void* user, int offsetX, int offsetY, int offsetZ) {
+    if (!fn) return false;
+    return EmitVoxFile(filename, offsetX, offsetY, offsetZ, fn, user);
+}
+
+static void VectorSink(void* user, Voxel_Object voxel) {
+    ((std::vector<Voxel_Object>*)user)->push_back(voxel);
+}
+
+// Cada thread transforma a própria faixa para um vetor; os vetores são juntados em ordem
+static void VectorWorker(void* user, int worker, const VoxJob* begin, const VoxJob* end) {
+    std::vector<Voxel_Object>* out = &((std::vector<std::vector<Voxel_Object>>*)user)->at(worker);
+    size_t count = 0;
+    for (const VoxJob* job = begin; job != end; job++) count += job->last - job->first;
+    out->reserve(count);
+    for (const VoxJob* job = begin; job != end; job++) {
+        EmitInstance(*job->scene, *job->instance, job->first, job->last, VectorSink, out);
+    }
+}
+
+static void CollectParallel(const std::vector<VoxScene*>& scenes, std::vector<Voxel_Object>* loaded,
+                            const Vox_Load_Options* options) {
+    size_t total;
+    std::vector<VoxJob> jobs = BuildJobs(scenes, &total);
+    int workers = WorkerCount(total, options);
+
+    std::vector<std::vector<Voxel_Object>> parts(workers);
+    RunJobs(jobs, total, workers, VectorWorker, &parts);
+
+    loaded->reserve(loaded->size() + total);
+    for (const std::vector<Voxel_Object>& part : parts) loaded->insert(loaded->end(), part.begin(), part.end());
+}
+
+struct SliceBuild {
+    const Voxel_Object* voxels;
+    std::vector<size_t> ranges;
+    IVector3 min, max;
+    std::vector<Octree*> trees;
+};
+
+static void SliceWorker(SliceBuild* build, int worker) {
+    Octree* tree = octree_create(NULL, build->min, build->max);
+    for (size_t i = build->ranges[worker]; i < build->ranges[worker + 1]; i++) {
+        octree_insert(tree, build->voxels[i]);
+    }
+    octree_compact(tree, 0);
+    build->trees[worker] = tree;
+}
+
+// Octree: fatias contíguas montadas em paralelo e enxertadas em ordem; os outros backends
+// inserem em sequência (já são rápidos por voxel e podem promover o mundo no meio)
+static void InsertIntoWorld(World* world, const std::vector<Voxel_Object>& voxels, const Vox_Load_Options* options) {
+    int workers = WorkerCount(voxels.size(), options);
+    if (world->backend != WORLD_BACKEND_OCTREE || workers == 1) {
+        for (const Voxel_Object& v : voxels) world_insert(world, v);
+        return;
+    }
+
+    SliceBuild build = {voxels.data(), std::vector<size_t>(workers + 1), world->octree->left_bot_back,
+                        world->octree->right_top_front, std::vector<Octree*>(workers, nullptr)};
+    for (int w = 0; w <= workers; w++) build.ranges[w] = voxels.size() * w / workers;
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < workers; w++) threads.emplace_back(SliceWorker, &build, w);
+    for (std::thread& t : threads) t.join();
+    for (int w = 0; w < workers; w++) octree_merge(world->octree, build.trees[w]);
+    // As fatias não passam por world_insert: o campo de distância, a luz e o sol são refeitos inteiros
+    world->distance_stale = true;
+    world->light_stale = true;
+    world->sun_stale = true;
+    world->bake_stale = true;
+    world->emitters_stale = true;
+}
+
+// Coloca no mundo os voxels carregados. Se o mundo ainda está vazio, o backend é escolhido
+// pelos limites e pela densidade (grade densa para cenas pequenas, grid esparso quando
+// os voxels passam dos limites do mundo).
+static void PlaceLoaded(const char* label, World* world, const std::vector<Voxel_Object>& loaded,
+                        const Vox_Load_Options* options) {
+    if (loaded.empty()) return;
+
+    IVector3 vmin = loaded[0].coord, vmax = loaded[0].coord;
+    for (const Voxel_Object& v : loaded) {
+        vmin = ivec3_min(vmin, v.coord);
+        vmax = ivec3_max(vmax, v.coord);
+    }
+
+    if (world_is_empty(world)) {
+        World_Backend backend = world_pick_backend(vmin, vmax, loaded.size());
+        if (!world_contains_box(world, vmin, vmax)) backend = WORLD_BACKEND_SPARSE;
+        world_set_backend(world, backend, vmin, vmax);
+        std::cout << "Backend do mundo: " << world_backend_name(world->backend)
+                  << " (" << loaded.size() << " voxels)" << std::endl;
+    }
+
+    if (world_is_unbounded(world) || world_contains_box(world, vmin, vmax)) {
+        InsertIntoWorld(world, loaded, options);
+    } else {
+        std::vector<Voxel_Object> kept;
+        kept.reserve(loaded.size());
+        for (const Voxel_Object& v : loaded) {
+            if (world_contains_box(world, v.coord, v.coord)) kept.push_back(v);
+        }
+        ReportDropped(label, loaded.size() - kept.size());
+        InsertIntoWorld(world, kept, options);
+    }
+    world_compact(world, 0);
+}
+
+// --- INSTANCIAMENTO ---
+
+// Modelos repetidos (mesmo modelo e rotação em vários nSHP) viram referências a uma octree
+// montada uma vez só (desligável por carga com Vox_Load_Options::no_instancing).
+
+// Caixa de uma instância no mundo (eixos da engine, max exclusivo)
+struct InstanceBox {
+    IVector3 min, max;
+    bool exact; // os voxels são o modelo rotacionado transladado até 'min'
+};
+
+static InstanceBox GetInstanceBox(const VoxScene& scene, const VoxInstance& inst) {
+    const VoxModelSpan& model = scene.models[inst.model];
+    int axis[3], sign[3];
+    InstanceAxes(inst, axis, sign);
+
+    int lo[3], hi[3];
+    bool exact = true;
+    for (int row = 0; row < 3; row++) {
+        int size = model.size[axis[row]];
+        int v0 = inst.translation2[row] + (sign[row] > 0 ? -size : 2 - size);
+        int v1 = v0 + 2 * (size - 1);
+        lo[row] = HalfToInt(v0);
+        hi[row] = HalfToInt(v1);
+        // Com .5 dos dois lados do zero, arredondar para longe do zero abre um buraco
+        // no meio do modelo: essa instância não é uma simples translação
+        if ((v0 & 1) && v0 < 0 && v1 > 0) exact = false;
+        if (size <= 0) exact = false;
+    }
+    InstanceBox box;
+    box.min = {{scene.origin.x + lo[0], scene.origin.y + lo[2], scene.origin.z + lo[1]}};
+    box.max = {{scene.origin.x + hi[0] + 1, scene.origin.y + hi[2] + 1, scene.origin.z + hi[1] + 1}};
+    box.exact = exact;
+    return box;
+}
+
+// Voxels do modelo já rotacionado, com o canto mínimo em 'offset' (igual a EmitInstance
+// para uma instância exata com offset = caixa.min)
+static void EmitModelLocal(const VoxScene& scene, const VoxInstance& inst, IVector3 offset, Vox_Voxel_Sink sink, void* user) {
+    const VoxModelSpan& model = scene.models[inst.model];
+    int axis[3], sign[3], low[3];
+    InstanceAxes(inst, axis, sign);
+    for (int row = 0; row < 3; row++) low[row] = sign[row] > 0 ? -model.size[axis[row]] : 2 - model.size[axis[row]];
+
+    for (size_t i = 0; i < model.count; i++) {
+        const uint8_t* v = model.xyzi + i * 4;
+        int local2[3] = {2 * v[0] - model.size.x, 2 * v[1] - model.size.y, 2 * v[2] - model.size.z};
+        int q[3];
+        for (int row = 0; row < 3; row++) q[row] = (sign[row] * local2[axis[row]] - low[row]) / 2;
+
+        int colorIdx = (int)v[3] - 1;
+        if (colorIdx < 0 || colorIdx >= 256) colorIdx = 0;
+
+        IVector3 coord = {{offset.x + q[0], offset.y + q[2], offset.z + q[1]}};
+        sink(user, VoxelObjCreate(defaultVoxelType, scene.palette[colorIdx], coord));
+    }
+}
+
+// Rotação como índice (eixo e sinal de cada linha): junto com o modelo, identifica a octree local
+static int RotationKey(const VoxInstance& inst) {
+    int axis[3], sign[3];
+    InstanceAxes(inst, axis, sign);
+    int key = 0;
+    for (int row = 0; row < 3; row++) key = key * 6 + axis[row] * 2 + (sign[row] > 0);
+    return key;
+}
+
+static Octree* BuildModelTree(const VoxScene& scene, const VoxInstance& inst, IVector3 size, IVector3 offset) {
+    Octree* tree = octree_create(NULL, {{0, 0, 0}}, size);
+    EmitModelLocal(scene, inst, offset, OctreeSink, tree);
+    octree_compact(tree, 0);
+    return tree;
+}
+
+// Separa as instâncias que se repetem (mesmo modelo e rotação) e cabem no mundo. As outras
+// ficam em scene->instances para virar voxels, na mesma ordem.
+static void SplitRepeated(VoxScene* scene, World* world, std::vector<VoxInstance>* repeated) {
+    std::map<std::pair<int, int>, int> uses;
+    for (const VoxInstance& inst : scene->instances) uses[{inst.model, RotationKey(inst)}]++;
+
+    std::vector<VoxInstance> kept;
+    for (const VoxInstance& inst : scene->instances) {
+        InstanceBox box = GetInstanceBox(*scene, inst);
+        bool shared = uses[{inst.model, RotationKey(inst)}] > 1 && box.exact
+                   && world_contains_box(world, box.min, ivec3_scalar_sub(box.max, 1));
+        (shared ? repeated : &kept)->push_back(inst);
+    }
+    scene->instances.swap(kept);
+}
+
+// Cada (modelo, rotação) é montado uma vez. Instâncias que caem na mesma posição relativa
+// dentro de nós de mesmo tamanho (o caso comum: cópias em grade) apontam para uma subárvore
+// compartilhada dentro da octree do mundo, que a GPU enxerga como DAG. As outras vão para o
+// nível de cima do mundo (BVH de instâncias) como referência à octree do modelo mais uma
+// translação.
+static void PlaceInstances(const VoxScene& scene, World* world, const std::vector<VoxInstance>& repeated,
+                           size_t* aligned_count, size_t* reference_count) {
+    *aligned_count = *reference_count = 0;
+    std::vector<bool> aligned(repeated.size(), false);
+
+    // Alinhadas: chave = modelo, rotação, tamanho do nó e posição dentro dele
+    std::map<std::vector<int>, std::vector<size_t>> groups;
+    std::vector<IVector3> node_min(repeated.size());
+    for (size_t i = 0; i < repeated.size(); i++) {
+        InstanceBox box = GetInstanceBox(scene, repeated[i]);
+        IVector3 lo, hi;
+        if (!octree_node_box(world->octree, box.min, ivec3_scalar_sub(box.max, 1), &lo, &hi)) continue;
+        node_min[i] = lo;
+        IVector3 size = ivec3_sub(hi, lo), at = ivec3_sub(box.min, lo);
+        groups[{repeated[i].model, RotationKey(repeated[i]), size.x, size.y, size.z, at.x, at.y, at.z}].push_back(i);
+    }
+    for (const auto& group : groups) {
+        if (group.second.size() < 2) continue;
+        const std::vector<int>& key = group.first;
+        Octree* shared = BuildModelTree(scene, repeated[group.second[0]], {{key[2], key[3], key[4]}}, {{key[5], key[6], key[7]}});
+        for (size_t i : group.second) {
+            aligned[i] = octree_set_instance(world->octree, node_min[i], shared);
+            *aligned_count += aligned[i];
+        }
+        octree_delete(shared); // as referências na octree do mundo continuam donas
+        world->distance_stale = true;
+        world->light_stale = true;
+        world->sun_stale = true;
+        world->bake_stale = true;
+        world->emitters_stale = true;
+    }
+
+    // O resto: uma octree por (modelo, rotação), na ordem do arquivo
+    std::map<std::pair<int, int>, Octree*> models;
+    for (size_t i = 0; i < repeated.size(); i++) {
+        if (aligned[i]) continue;
+        InstanceBox box = GetInstanceBox(scene, repeated[i]);
+        Octree*& model = models[{repeated[i].model, RotationKey(repeated[i])}];
+        if (!model) model = BuildModelTree(scene, repeated[i], ivec3_sub(box.max, box.min), {{0, 0, 0}});
+        *reference_count += world_add_instance(world, model, voxel_transform_translation(box.min)) >= 0;
+    }
+    for (auto& entry : models) octree_delete(entry.second);
+}
+
+// Instanciar só compensa na octree (a grade densa e a tree64 são para cenas pequenas).
+// Com o mundo vazio o backend é escolhido já contando os voxels das instâncias.
+static bool CanInstance(const VoxScene& scene, World* world) {
+    if (!world_is_empty(world)) return world->backend == WORLD_BACKEND_OCTREE;
+
+    IVector3 vmin = {{0, 0, 0}}, vmax = {{0, 0, 0}};
+    bool first = true;
+    for (const VoxInstance& inst : scene.instances) {
+        InstanceBox box = GetInstanceBox(scene, inst);
+        IVector3 last = ivec3_scalar_sub(box.max, 1);
+        vmin = first ? box.min : ivec3_min(vmin, box.min);
+        vmax = first ? last : ivec3_max(vmax, last);
+        first = false;
+    }
+    if (first || !world_contains_box(world, vmin, vmax)) return false;
+    if (world_pick_backend(vmin, vmax, scene.voxel_count) != WORLD_BACKEND_OCTREE) return false;
+
+    world_set_backend(world, WORLD_BACKEND_OCTREE, vmin, vmax);
+    std::cout << "Backend do mundo: " << world_backend_name(world->backend)
+              << " (" << scene.voxel_count << " voxels, instanciado)" << std::endl;
     return true;
-}
\ No newline at end of file
+}
+
+// Carrega o arquivo num World (ver PlaceLoaded para a escolha do backend). Modelos repetidos
+// são instanciados (ver PlaceInstances); onde uma instância se sobrepõe a voxels comuns do
+// mesmo arquivo, os voxels comuns vencem.
+static bool LoadVoxWorld(const char* filename, World* world, int offsetX, int offsetY, int offsetZ,
+                         const Vox_Load_Options* options) {
+    VoxScene scene;
+    bool ok = ParseVoxScene(filename, {offsetX, offsetY, offsetZ}, &scene);
+
+    std::vector<VoxInstance> repeated;
+    bool instancing = !options || !options->no_instancing;
+    if (ok && instancing && CanInstance(scene, world)) SplitRepeated(&scene, world, &repeated);
+    if (!repeated.empty()) {
+        size_t aligned, references;
+        PlaceInstances(scene, world, repeated, &aligned, &references);
+        std::cout << "Instancias: " << aligned << " alinhadas na octree, " << references
+                  << " por referencia (" << repeated.size() << " repetidas)" << std::endl;
+    }
+
+    std::vector<Voxel_Object> loaded;
+    CollectParallel({&scene}, &loaded, options);
+    UnmapFile(&scene.file);
+    if (!ok) return false;
+
+    PlaceLoaded(filename, world, loaded, options);
+    return true;
+}
+
+// --- CACHE DE MONTAGEM ---
+
+// Versão do que o loader monta a partir de um .vox. Mude sempre que a mesma entrada
+// passar a gerar outro resultado (parse, materiais, transformações): invalida o cache todo.
+#define VOX_CACHE_VERSION 1
+#define VOX_CACHE_SEED 0xcbf29ce484222325ull
+
+namespace fs = std::filesystem;
+
+// Cada entrada é um .svo (ver svo_file_write) com o resultado da montagem, no diretório
+// de Vox_Load_Options::cache_dir. Desligado sem ele.
+static bool CacheEnabled(const Vox_Load_Options* options) {
+    return options && options->cache_dir && options->cache_dir[0];
+}
+
+static double CacheNowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Chave: conteúdo do .vox, versões do loader e do formato, tipo e limites do destino e
+// offsets. O nome do arquivo não entra, então cópias do mesmo mapa dividem a entrada.
+static bool CachePath(const char* dir, const char* filename, char kind, IVector3 offset, IVector3 min, IVector3 max,
+                      std::string* path) {
+    MappedFile mf;
+    if (!MapFile(filename, &mf)) return false;
+    uint64_t hash = svo_file_checksum(VOX_CACHE_SEED, mf.data, mf.size);
+    UnmapFile(&mf);
+
+    int32_t params[] = {VOX_CACHE_VERSION, SVO_FILE_VERSION, kind, offset.x, offset.y, offset.z,
+                        min.x, min.y, min.z, max.x, max.y, max.z};
+    hash = svo_file_checksum(hash, (const uint8_t*)params, sizeof(params));
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.svo", (unsigned long long)hash);
+    *path = (fs::path(dir) / name).string();
+    return true;
+}
+
+// Marca a entrada como usada agora (o LRU é pela data de modificação)
+static bool CacheTouch(const std::string& path) {
+    std::error_code ec;
+    if (!fs::is_regular_file(path, ec)) return false;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    return true;
+}
+
+// Apaga as entradas usadas há mais tempo até o diretório caber no limite
+static void CacheEvict(const char* dir, uintmax_t max_bytes) {
+    if (max_bytes == 0) return;
+    struct Entry {
+        fs::path path;
+        fs::file_time_type time;
+        uintmax_t size;
+    };
+    std::vector<Entry> entries;
+    uintmax_t total = 0;
+    std::error_code ec;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->path().extension() != ".svo") continue;
+        Entry entry = {it->path(), fs::last_write_time(it->path(), ec), fs::file_size(it->path(), ec)};
+        if (ec) continue;
+        entries.push_back(entry);
+        total += entry.size;
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+    for (const Entry& entry : entries) {
+        if (total <= max_bytes) break;
+        if (fs::remove(entry.path, ec)) total -= entry.size; // no Windows, entradas mapeadas ficam
+    }
+}
+
+static void CacheReport(const char* filename, bool hit, double load_ms, double write_ms) {
+    char line[64];
+    if (hit) snprintf(line, sizeof(line), "(%.1f ms)", load_ms);
+    else snprintf(line, sizeof(line), "(montagem %.1f ms, gravação %.1f ms)", load_ms, write_ms);
+    std::cout << "Cache: " << (hit ? "acerto " : "falta ") << filename << " " << line << std::endl;
+}
+
+// Com o cache ligado, a octree montada vem do cache quando o conteúdo do arquivo, os
+// offsets e os limites da árvore são os mesmos; senão é montada e gravada lá.
+bool load_vox_file(const char* filename, Octree* tree, int offsetX, int offsetY, int offsetZ, const Vox_Load_Options* options) {
+    if (!tree) {
+        std::cerr << "Erro: Octree é NULL!" << std::endl;
+        return false;
+    }
+    std::string path;
+    if (!CacheEnabled(options)
+        || !CachePath(options->cache_dir, filename, 'o', {offsetX, offsetY, offsetZ}, tree->left_bot_back, tree->right_top_front, &path)) {
+        return LoadVoxOctree(filename, tree, offsetX, offsetY, offsetZ, options);
+    }
+
+    double t0 = CacheNowMs();
+    if (CacheTouch(path)) {
+        Svo_Map* map = svo_map_open(path.c_str(), true);
+        Octree* cached = svo_map_to_octree(map);
+        svo_map_delete(map);
+        if (cached) {
+            octree_merge(tree, cached);
+            octree_compact(tree, 0);
+            CacheReport(filename, true, CacheNowMs() - t0, 0.0);
+            return true;
+        }
+        std::error_code ec;
+        fs::remove(path, ec); // corrompida: monta de novo
+    }
+
+    // Montada à parte para a entrada ter só o conteúdo do arquivo
+    Octree* built = octree_create(NULL, tree->left_bot_back, tree->right_top_front);
+    bool ok = LoadVoxOctree(filename, built, offsetX, offsetY, offsetZ, options);
+    double build_ms = CacheNowMs() - t0;
+    if (ok) {
+        t0 = CacheNowMs();
+        std::error_code ec;
+        fs::create_directories(options->cache_dir, ec);
+        if (svo_file_write(path.c_str(), built)) CacheEvict(options->cache_dir, options->cache_max_bytes);
+        CacheReport(filename, false, build_ms, CacheNowMs() - t0);
+    }
+    octree_merge(tree, built);
+    octree_compact(tree, 0);
+    return ok;
+}
+
+// O cache guarda o mundo achatado (ver world_save_svo), então só vale para um mundo vazio:
+// no acerto o mundo passa a ser o .svo mapeado. Mundos sem limites não são guardados.
+bool load_vox_world(const char* filename, World* world, int offsetX, int offsetY, int offsetZ, const Vox_Load_Options* options) {
+    if (!world) {
+        std::cerr << "Erro: World é NULL!" << std::endl;
+        return false;
+    }
+    std::string path;
+    if (!CacheEnabled(options) || !world_is_empty(world)
+        || !CachePath(options->cache_dir, filename, 'w', {offsetX, offsetY, offsetZ}, world->left_bot_back, world->right_top_front, &path)) {
+        return LoadVoxWorld(filename, world, offsetX, offsetY, offsetZ, options);
+    }
+
+    double t0 = CacheNowMs();
+    if (CacheTouch(path)) {
+        if (world_load_svo(world, path.c_str())) {
+            CacheReport(filename, true, CacheNowMs() - t0, 0.0);
+            return true;
+        }
+        std::error_code ec;
+        fs::remove(path, ec);
+    }
+
+    bool ok = LoadVoxWorld(filename, world, offsetX, offsetY, offsetZ, options);
+    double build_ms = CacheNowMs() - t0;
+    if (ok && !world_is_unbounded(world)) {
+        t0 = CacheNowMs();
+        std::error_code ec;
+        fs::create_directories(options->cache_dir, ec);
+        if (world_save_svo(world, path.c_str())) CacheEvict(options->cache_dir, options->cache_max_bytes);
+        CacheReport(filename, false, build_ms, CacheNowMs() - t0);
+    }
+    return ok;
+}
+
+// Manifesto: uma linha por arquivo, "caminho [x y z]" (offset opcional); '#' comenta.
+// Caminhos relativos são relativos ao diretório do manifesto. Todos os arquivos são
+// mapeados e achatados primeiro; a transformação dos voxels de todos eles é dividida entre
+// as threads. Onde arquivos se sobrepõem, o que vem depois no manifesto vence.
+bool load_vox_manifest(const char* manifest, World* world, const Vox_Load_Options* options) {
+    if (!world) {
+        std::cerr << "Erro: World é NULL!" << std::endl;
+        return false;
+    }
+    std::ifstream in(manifest);
+    if (!in) {
+        std::cerr << "Erro ao abrir manifesto: " << manifest << std::endl;
+        return false;
+    }
+
+    std::string dir(manifest);
+    size_t slash = dir.find_last_of("/\\");
+    dir = slash == std::string::npos ? "" : dir.substr(0, slash + 1);
+
+    std::vector<VoxScene*> scenes;
+    std::vector<Voxel_Object> loaded;
+    bool ok = true;
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::istringstream fields(line);
+        std::string path;
+        if (!(fields >> path)) continue;
+        glm::ivec3 offset(0);
+        fields >> offset.x >> offset.y >> offset.z;
+        if (path[0] != '/' && !dir.empty()) path = dir + path;
+
+        VoxScene* scene = new VoxScene();
+        if (ParseVoxScene(path.c_str(), offset, scene)) {
+            scenes.push_back(scene);
+        } else {
+            ok = false;
+            UnmapFile(&scene->file);
+            delete scene;
+        }
+    }
+
+    CollectParallel(scenes, &loaded, options);
+    for (VoxScene* scene : scenes) {
+        UnmapFile(&scene->file);
+        delete scene;
+    }
+
+    PlaceLoaded(manifest, world, loaded, options);
+    return ok;
+}
@@ -3,6 +3,49 @@ extern "C"{
     #include <vmm/ivec3.h>
 }
 
+// Lista de todos os tipos de voxels possívels
+// IOF, Illumination, Metallicity
+Voxel voxels[] = {
+    {3.0f, 0.0f, 0.0f}, // VOX_GRASS
+    {3.0f, 0.0f, 0.0f}, // VOX_DIRT
+    {3.0f, 0.0f, 0.0f}, // VOX_WOOD
+    {3.0f, 0.0f, 0.0f}, // VOX_LEAVES
+    {1.33f, 0.0f, 0.0f}, // VOX_WATER
+    {3.0f, 0.0f, 0.0f},  // VOX_STONE
+    {1.5f, 0.0f, 0.0f},  // VOX_GLASS
+    {2.42f, 0.0f, 0.0f},  // VOX_DIAMOND
+    {1.38f, 0.0f, 0.0f},  // VOX_JELLY
+    {3.0f, 0.0f, 1.0f},  // VOX_MIRROR
+    {3.0f, 1.0f, 0.0f}, // LIGHT
+};
+
+Voxel_Type VOX_GRASS = 0;
+Voxel_Type VOX_DIRT = 1;
+Voxel_Type VOX_WOOD = 2;
+Voxel_Type VOX_LEAVES = 3;
+Voxel_Type VOX_WATER = 4;
+Voxel_Type VOX_STONE = 5;
+Voxel_Type VOX_GLASS = 6;
+Voxel_Type VOX_DIAMOND = 7;
+Voxel_Type VOX_JELLY = 8;
+Voxel_Type VOX_MIRROR = 9;
+Voxel_Type VOX_LIGHT = 10;
+
+// Colors for the materials above (Simplification)
+ColorRGBA voxelColors[] = {
+    make_color_rgba(80, 180, 60, 255),   // Grass
+    make_color_rgba(100, 70, 40, 255),   // Dirt
+    make_color_rgba(120, 70, 30, 255),   // Wood
+    make_color_rgba(30, 160, 30, 255),   // Leaves
+    make_color_rgba(60, 100, 220, 150),  // Water
+    make_color_rgba(160, 160, 160, 255), // Stone
+    make_color_rgba(200, 220, 255, 80),  // Glass
+    make_color_rgba(0, 255, 255, 255),   // Diamond
+    make_color_rgba(255, 100, 100, 180), // Jelly
+    make_color_rgba(255, 255, 255, 255), // Mirror
+    make_color_rgba(255, 210, 210, 255), // Light
+};
+
 Voxel_Object VoxelObjCreate(Voxel voxel, ColorRGBA color, IVector3 coord) {
     Voxel_Object obj;
     obj.voxel = voxel;
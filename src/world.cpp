@@ -0,0 +1,1582 @@
+extern "C" {
+    #include <vmm/ivec3.h>
+    #include <vmm/vec3.h>
+    #include <vmm/ray.h>
+}
+#include <iostream>
+#include <world.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+// Bytes médios por voxel de superfície na octree (nó de 80 bytes + array de 8 ponteiros
+// + nós internos), medido com bench_dense (~200 B em cascas e no dragon.vox; voxels
+// isolados chegam a ~1900 B). A grade densa custa ~1.1 byte por célula, então ela
+// ganha memória a partir de ~0.6% de ocupação.
+#define OCTREE_BYTES_PER_VOXEL 200.0
+// Edições maiores que isto (células) refazem a luz inteira em vez de célula por célula
+#define LIGHT_EDIT_MAX_CELLS (64 * 64 * 64)
+// O mesmo para o cache do sol (a sombra de caixas maiores cobre boa parte do mundo)
+#define SUN_EDIT_MAX_CELLS (64 * 64 * 64)
+// Voxels que não bloqueiam o sol (vidro quase transparente, fontes) atravessados por raio
+#define SUN_MAX_SKIPS 64
+// O mesmo para o assado (ver world_bake)
+#define BAKE_EDIT_MAX_CELLS (64 * 64 * 64)
+// Faces até esta distância de uma edição são assadas de novo: mais longe a caixa editada
+// cobre pouco do hemisfério delas (ver face_bake_invalidate)
+#define BAKE_EDIT_RADIUS 16
+// Rebotes por caminho do assado (o shader faz um por quadro)
+#define BAKE_BOUNCES 4
+// O mesmo para a árvore de fontes (ver world_update_emitters)
+#define EMITTER_EDIT_MAX_CELLS (64 * 64 * 64)
+// Ponteiros de 23 bits: o que uma textura endereça
+#define TEXTURE_MAX_TEXELS 0x800000
+
+World *world_create(IVector3 left_bot_back, IVector3 right_top_front) {
+    World *world = (World*)calloc(1, sizeof(World));
+    if (!world) return NULL;
+
+    world->backend = WORLD_BACKEND_OCTREE;
+    world->left_bot_back = left_bot_back;
+    world->right_top_front = right_top_front;
+    world->octree = octree_create(NULL, left_bot_back, right_top_front);
+    world->distance_stale = true;
+    world->light_stale = true;
+    world->sun_stale = true;
+    world->sun_direction = vec3_float(0.0f, 1.0f, 0.0f);
+    world->bake_stale = true;
+    world->emitters_stale = true;
+    world->light_sampling = LIGHT_SAMPLING_TREE;
+    return world;
+}
+
+const char *world_backend_name(World_Backend backend) {
+    switch (backend) {
+    case WORLD_BACKEND_DENSE: return "dense";
+    case WORLD_BACKEND_TREE64: return "tree64";
+    case WORLD_BACKEND_SPARSE: return "sparse";
+    case WORLD_BACKEND_SVO: return "svo";
+    case WORLD_BACKEND_CHUNKED: return "chunked";
+    default: return "octree";
+    }
+}
+
+World_Backend world_pick_backend(IVector3 vox_min, IVector3 vox_max, size_t voxel_count) {
+    if (voxel_count == 0) return WORLD_BACKEND_OCTREE;
+
+    // vox_max é inclusivo; a grade densa ganha uma margem para construção
+    unsigned long long sx = (unsigned long long)(vox_max.x - vox_min.x + 1 + 2 * DENSE_MARGIN);
+    unsigned long long sy = (unsigned long long)(vox_max.y - vox_min.y + 1 + 2 * DENSE_MARGIN);
+    unsigned long long sz = (unsigned long long)(vox_max.z - vox_min.z + 1 + 2 * DENSE_MARGIN);
+    unsigned long long cells = sx * sy * sz;
+    if (cells > DENSE_MAX_CELLS) return WORLD_BACKEND_OCTREE;
+    if (cells <= DENSE_ALWAYS_CELLS) return WORLD_BACKEND_DENSE;
+
+    double dense_bytes = (double)cells * (1.0 + 1.0 / 8.0);
+    double octree_bytes = (double)voxel_count * OCTREE_BYTES_PER_VOXEL;
+    return dense_bytes <= octree_bytes ? WORLD_BACKEND_DENSE : WORLD_BACKEND_OCTREE;
+}
+
+static void _insert_into_world(void *user, Voxel_Object voxel) {
+    world_insert((World*)user, voxel);
+}
+
+// Troca o backend, migrando os voxels já existentes.
+// Para a grade densa, vox_min/vox_max (inclusivos) definem a região coberta.
+// O backend SVO só vem de world_load_svo.
+bool world_set_backend(World *world, World_Backend backend, IVector3 vox_min, IVector3 vox_max) {
+    if (!world || backend == WORLD_BACKEND_SVO) return false;
+    if (backend == world->backend) return true;
+
+    Octree *old_octree = world->octree;
+    Dense_Grid *old_dense = world->dense;
+    Tree64 *old_tree64 = world->tree64;
+    Sparse_Grid *old_sparse = world->sparse;
+    Svo_Map *old_svo = world->svo;
+    Chunk_Grid *old_chunks = world->chunks;
+    world->octree = NULL;
+    world->dense = NULL;
+    world->tree64 = NULL;
+    world->sparse = NULL;
+    world->svo = NULL;
+    world->chunks = NULL;
+
+    bool created = true;
+    if (backend == WORLD_BACKEND_DENSE) {
+        IVector3 lo = ivec3_max(ivec3_scalar_sub(vox_min, DENSE_MARGIN), world->left_bot_back);
+        IVector3 hi = ivec3_min(ivec3_scalar_add(vox_max, DENSE_MARGIN + 1), world->right_top_front);
+        world->dense = dense_grid_create(lo, hi);
+        created = world->dense != NULL;
+    } else if (backend == WORLD_BACKEND_TREE64) {
+        world->tree64 = tree64_create(world->left_bot_back, world->right_top_front);
+        created = world->tree64 != NULL;
+    } else if (backend == WORLD_BACKEND_SPARSE) {
+        world->sparse = sparse_grid_create();
+        created = world->sparse != NULL;
+    } else if (backend == WORLD_BACKEND_CHUNKED) {
+        world->chunks = chunk_grid_create(world->left_bot_back, world->right_top_front);
+        created = world->chunks != NULL;
+    } else {
+        // Os chunks são enxertados inteiros numa árvore só, e o .svo vem direto dos texels
+        // mapeados, sem reinserir voxel por voxel; se não der, a árvore nasce vazia e eles
+        // migram como os outros, mais abaixo
+        if (old_chunks) world->octree = chunk_grid_to_octree(old_chunks, world->left_bot_back, world->right_top_front);
+        else if (old_svo) world->octree = svo_map_to_octree(old_svo);
+        if (world->octree && old_chunks) {
+            chunk_grid_delete(old_chunks);
+            old_chunks = NULL;
+        } else if (world->octree && old_svo) {
+            svo_map_delete(old_svo);
+            old_svo = NULL;
+        }
+        if (!world->octree) world->octree = octree_create(NULL, world->left_bot_back, world->right_top_front);
+        created = world->octree != NULL;
+    }
+    if (!created) {
+        // Sem memória para o novo: o mundo fica com o backend antigo, intacto
+        world->octree = old_octree;
+        world->dense = old_dense;
+        world->tree64 = old_tree64;
+        world->sparse = old_sparse;
+        world->svo = old_svo;
+        world->chunks = old_chunks;
+        return false;
+    }
+    world->backend = backend;
+
+    // Migra o conteúdo antigo (se algo não couber, world_insert promove de volta para octree).
+    // Para os chunks, as subárvores alinhadas a eles são enxertadas sem passar voxel por voxel.
+    Voxel_Transform identity = voxel_transform_identity();
+    if (old_octree) {
+        if (backend == WORLD_BACKEND_CHUNKED) {
+            chunk_grid_paste(world->chunks, old_octree, &identity, old_octree->left_bot_back,
+                             ivec3_scalar_add(old_octree->right_top_front, -1));
+        } else {
+            octree_for_each(old_octree, _insert_into_world, world);
+        }
+        octree_delete(old_octree);
+    }
+    if (old_dense) {
+        dense_grid_for_each(old_dense, _insert_into_world, world);
+        dense_grid_delete(old_dense);
+    }
+    if (old_tree64) {
+        tree64_for_each(old_tree64, _insert_into_world, world);
+        tree64_delete(old_tree64);
+    }
+    if (old_sparse) {
+        sparse_grid_for_each(old_sparse, _insert_into_world, world);
+        sparse_grid_delete(old_sparse);
+    }
+    if (old_svo) {
+        Octree *tree = svo_map_to_octree(old_svo);
+        if (tree && backend == WORLD_BACKEND_CHUNKED) {
+            chunk_grid_paste(world->chunks, tree, &identity, tree->left_bot_back, ivec3_scalar_add(tree->right_top_front, -1));
+        } else if (tree) {
+            octree_for_each(tree, _insert_into_world, world);
+        }
+        octree_delete(tree);
+        svo_map_delete(old_svo);
+    }
+    if (old_chunks) {
+        chunk_grid_for_each(old_chunks, _insert_into_world, world);
+        chunk_grid_delete(old_chunks);
+    }
+    world_compact(world, 0);
+    return true;
+}
+
+bool world_is_empty(World *world) {
+    if (!world) return true;
+    if (world->instances && world->instances->count > 0) return false;
+    if (world->objects && world->objects->set->count > 0) return false;
+    if (world->backend == WORLD_BACKEND_DENSE) return world->dense->voxel_count == 0;
+    if (world->backend == WORLD_BACKEND_TREE64) return world->tree64->voxel_count == 0;
+    if (world->backend == WORLD_BACKEND_SPARSE) return world->sparse->voxel_count == 0;
+    if (world->backend == WORLD_BACKEND_SVO) return svo_map_is_empty(world->svo);
+    if (world->backend == WORLD_BACKEND_CHUNKED) return chunk_grid_is_empty(world->chunks);
+    return !world->octree->children && !world->octree->has_voxel;
+}
+
+bool world_is_unbounded(World *world) {
+    return world && world->backend == WORLD_BACKEND_SPARSE;
+}
+
+// vox_min/vox_max inclusivos, contra os limites fixos do mundo
+bool world_contains_box(World *world, IVector3 vox_min, IVector3 vox_max) {
+    if (!world) return false;
+    return vox_min.x >= world->left_bot_back.x && vox_max.x < world->right_top_front.x
+        && vox_min.y >= world->left_bot_back.y && vox_max.y < world->right_top_front.y
+        && vox_min.z >= world->left_bot_back.z && vox_max.z < world->right_top_front.z;
+}
+
+// O arquivo mapeado é somente leitura: a primeira edição monta a octree a partir dele
+static void _make_editable(World *world) {
+    if (world->backend != WORLD_BACKEND_SVO) return;
+    std::cout << "Mundo .svo editado, montando a octree." << std::endl;
+    world_set_backend(world, WORLD_BACKEND_OCTREE, world->left_bot_back, world->left_bot_back);
+}
+
+// Voxels novos em [vox_min, vox_max] (inclusivos): fora da caixa do campo de distância,
+// ele é refeito no próximo world_update_distance
+static void _distance_mark(World *world, IVector3 vox_min, IVector3 vox_max) {
+    if (world->distance_stale) return;
+    if (!distance_field_contains(world->distance, vox_min, vox_max)) world->distance_stale = true;
+    else distance_field_mark(world->distance, vox_min, vox_max);
+}
+
+static Voxel_Object _backend_find(World *world, IVector3 coord) {
+    if (world->backend == WORLD_BACKEND_DENSE) return dense_grid_find(world->dense, coord);
+    if (world->backend == WORLD_BACKEND_TREE64) return tree64_find(world->tree64, coord);
+    if (world->backend == WORLD_BACKEND_SPARSE) return sparse_grid_find(world->sparse, coord);
+    if (world->backend == WORLD_BACKEND_SVO) return svo_map_find(world->svo, coord);
+    if (world->backend == WORLD_BACKEND_CHUNKED) return chunk_grid_find(world->chunks, coord);
+    return octree_find(world->octree, coord);
+}
+
+// Voxel do backend que bloqueia a luz (os translúcidos deixam passar)
+static bool _cell_opaque(void *user, IVector3 coord) {
+    Voxel_Object voxel = _backend_find((World*)user, coord);
+    return voxel.coord.y != _invalid_voxel().coord.y && get_alpha_rgba(voxel.color) == 255;
+}
+
+// A luz acompanha as edições em [vox_min, vox_max] (inclusivos)? Caixas grandes demais
+// fazem ela ser refeita inteira no próximo world_update_light
+static bool _light_follows(World *world, IVector3 vox_min, IVector3 vox_max) {
+    if (world->light_stale) return false;
+    IVector3 size = ivec3_scalar_add(ivec3_sub(vox_max, vox_min), 1);
+    if ((double)size.x * (double)size.y * (double)size.z > LIGHT_EDIT_MAX_CELLS) {
+        world->light_stale = true;
+        return false;
+    }
+    return true;
+}
+
+// Passa o estado atual do backend em [vox_min, vox_max] (inclusivos) para a luz
+static void _light_edit(World *world, IVector3 vox_min, IVector3 vox_max) {
+    if (!_light_follows(world, vox_min, vox_max)) return;
+    for (int z = vox_min.z; z <= vox_max.z; z++)
+    for (int y = vox_min.y; y <= vox_max.y; y++)
+    for (int x = vox_min.x; x <= vox_max.x; x++) {
+        Voxel_Object voxel = _backend_find(world, {{x, y, z}});
+        bool found = voxel.coord.y != _invalid_voxel().coord.y;
+        light_volume_set(world->light, {{x, y, z}}, found && get_alpha_rgba(voxel.color) == 255,
+                         found ? light_volume_emission(voxel.color, voxel.voxel.illumination) : 0);
+    }
+}
+
+// O cache do sol refaz as faces em volta de [vox_min, vox_max] (inclusivos) e as que olham
+// para o sol através da caixa; caixas grandes demais refazem o cache inteiro
+static void _sun_edit(World *world, IVector3 vox_min, IVector3 vox_max) {
+    if (world->sun_stale) return;
+    IVector3 size = ivec3_scalar_add(ivec3_sub(vox_max, vox_min), 1);
+    if ((double)size.x * (double)size.y * (double)size.z > SUN_EDIT_MAX_CELLS) world->sun_stale = true;
+    else sun_cache_invalidate(world->sun, vox_min, vox_max);
+}
+
+// O assado volta ao assador nas faces até BAKE_EDIT_RADIUS (mais o tamanho da caixa) de
+// [vox_min, vox_max] (inclusivos); caixas grandes demais pedem o assado inteiro de novo
+static void _bake_edit(World *world, IVector3 vox_min, IVector3 vox_max) {
+    if (world->bake_stale) return;
+    IVector3 size = ivec3_scalar_add(ivec3_sub(vox_max, vox_min), 1);
+    if ((double)size.x * (double)size.y * (double)size.z > BAKE_EDIT_MAX_CELLS) {
+        world->bake_stale = true;
+        return;
+    }
+    int extent = std::max(size.x, std::max(size.y, size.z));
+    face_bake_invalidate(world->bake, vox_min, vox_max, BAKE_EDIT_RADIUS + extent);
+}
+
+static void _emitter_refresh(World *world, IVector3 coord);
+
+// Fontes em [vox_min, vox_max] (inclusivos) e em volta (as faces delas que emitem dependem
+// dos vizinhos); caixas grandes demais refazem a árvore inteira
+static void _emitters_edit(World *world, IVector3 vox_min, IVector3 vox_max) {
+    if (world->emitters_stale) return;
+    IVector3 size = ivec3_scalar_add(ivec3_sub(vox_max, vox_min), 3);
+    if ((double)size.x * (double)size.y * (double)size.z > EMITTER_EDIT_MAX_CELLS) {
+        world->emitters_stale = true;
+        return;
+    }
+    for (int z = vox_min.z - 1; z <= vox_max.z + 1; z++)
+    for (int y = vox_min.y - 1; y <= vox_max.y + 1; y++)
+    for (int x = vox_min.x - 1; x <= vox_max.x + 1; x++) _emitter_refresh(world, {{x, y, z}});
+}
+
+static void _backend_insert(World *world, Voxel_Object voxel) {
+    if (world->backend == WORLD_BACKEND_DENSE) {
+        if (dense_grid_insert(world->dense, voxel) == 0) return;
+
+        // Fora da grade ou paleta cheia: promove o mundo para octree
+        std::cout << "Grade densa excedida, promovendo o mundo para octree." << std::endl;
+        world_set_backend(world, WORLD_BACKEND_OCTREE, voxel.coord, voxel.coord);
+    } else if (world->backend == WORLD_BACKEND_TREE64) {
+        if (tree64_insert(world->tree64, voxel) == 0) return;
+
+        // Só falha com a paleta cheia (a raiz cobre o mundo inteiro)
+        std::cout << "Paleta da tree64 excedida, promovendo o mundo para octree." << std::endl;
+        world_set_backend(world, WORLD_BACKEND_OCTREE, voxel.coord, voxel.coord);
+    } else if (world->backend == WORLD_BACKEND_SPARSE) {
+        if (sparse_grid_insert(world->sparse, voxel) == 0) return;
+
+        // Só falha com a paleta cheia; a octree perde o que estiver fora dos limites
+        std::cout << "Paleta do grid esparso excedida, promovendo o mundo para octree." << std::endl;
+        world_set_backend(world, WORLD_BACKEND_OCTREE, voxel.coord, voxel.coord);
+    } else if (world->backend == WORLD_BACKEND_CHUNKED) {
+        // Só o chunk da célula muda (e só ele é regravado na textura)
+        chunk_grid_insert(world->chunks, voxel);
+        return;
+    } else if (world->backend == WORLD_BACKEND_SVO) {
+        _make_editable(world);
+    }
+    octree_insert(world->octree, voxel);
+}
+
+void world_insert(World *world, Voxel_Object voxel) {
+    if (!world) return;
+    _distance_mark(world, voxel.coord, voxel.coord);
+    _backend_insert(world, voxel);
+    _light_edit(world, voxel.coord, voxel.coord);
+    _sun_edit(world, voxel.coord, voxel.coord);
+    _bake_edit(world, voxel.coord, voxel.coord);
+    _emitters_edit(world, voxel.coord, voxel.coord);
+}
+
+// Só a parte estática: os voxels do backend vencem os das instâncias (edições do
+// jogador ficam por cima)
+Voxel_Object world_find_static(World *world, IVector3 coord) {
+    if (!world) return _invalid_voxel();
+    Voxel_Object voxel = _backend_find(world, coord);
+    if (voxel.coord.y != _invalid_voxel().coord.y || !world->instances) return voxel;
+    return instance_set_find(world->instances, coord);
+}
+
+// A parte estática vence os objetos dinâmicos
+Voxel_Object world_find(World *world, IVector3 coord) {
+    if (!world) return _invalid_voxel();
+    Voxel_Object voxel = world_find_static(world, coord);
+    if (voxel.coord.y != _invalid_voxel().coord.y) return voxel;
+    return object_layer_find(world->objects, coord);
+}
+
+// Alguma célula de [vox_min, vox_max] (inclusivos) ainda tem voxel no backend (para o
+// campo de distância depois de apagar)
+static bool _box_occupied(void *user, IVector3 vox_min, IVector3 vox_max) {
+    World *world = (World*)user;
+    for (int z = vox_min.z; z <= vox_max.z; z++)
+    for (int y = vox_min.y; y <= vox_max.y; y++)
+    for (int x = vox_min.x; x <= vox_max.x; x++) {
+        if (_backend_find(world, {{x, y, z}}).coord.y != _invalid_voxel().coord.y) return true;
+    }
+    return false;
+}
+
+static void _insert_if_free(void *user, Voxel_Object voxel) {
+    World *world = (World*)user;
+    if (_backend_find(world, voxel.coord).coord.y == _invalid_voxel().coord.y) world_insert(world, voxel);
+}
+
+void world_remove(World *world, IVector3 coord) {
+    if (!world) return;
+    _make_editable(world);
+
+    // Remover de dentro de uma instância: ela vira voxels comuns no backend e é editada lá.
+    // Todas as que têm voxel na célula saem, senão a de baixo reapareceria.
+    while (world->instances && instance_set_detach(world->instances, coord, _insert_if_free, world)) {}
+
+    if (world->backend == WORLD_BACKEND_DENSE) dense_grid_remove(world->dense, coord);
+    else if (world->backend == WORLD_BACKEND_TREE64) tree64_remove(world->tree64, coord);
+    else if (world->backend == WORLD_BACKEND_SPARSE) sparse_grid_remove(world->sparse, coord);
+    else if (world->backend == WORLD_BACKEND_CHUNKED) chunk_grid_remove(world->chunks, coord);
+    else octree_remove(world->octree, coord);
+    if (!world->distance_stale) distance_field_clear(world->distance, coord, coord);
+    _light_edit(world, coord, coord);
+    _sun_edit(world, coord, coord);
+    _bake_edit(world, coord, coord);
+    _emitters_edit(world, coord, coord);
+}
+
+// world_fill nos backends sem volumes (a caixa inteira já foi para o campo de distância e
+// vai para a luz depois)
+static void _fill_cells(World *world, IVector3 min, IVector3 max, Voxel_Object voxel) {
+    for (int z = min.z; z <= max.z; z++)
+    for (int y = min.y; y <= max.y; y++)
+    for (int x = min.x; x <= max.x; x++) {
+        voxel.coord = {{x, y, z}};
+        _backend_insert(world, voxel);
+        // Promovido para octree no meio do caminho: o resto vai de uma vez
+        if (world->backend == WORLD_BACKEND_OCTREE) {
+            octree_fill(world->octree, min, max, voxel);
+            return;
+        }
+    }
+}
+
+// Preenche [vox_min, vox_max] (inclusivos) do backend com o material de 'voxel'. Na octree
+// os nós inteiros dentro da caixa viram volumes de uma vez; os outros backends vão célula
+// por célula. Instâncias e objetos não mudam (o backend já fica por cima deles).
+void world_fill(World *world, IVector3 vox_min, IVector3 vox_max, Voxel_Object voxel) {
+    if (!world) return;
+    _make_editable(world);
+    IVector3 min = ivec3_min(vox_min, vox_max), max = ivec3_max(vox_min, vox_max);
+    if (!world_is_unbounded(world)) {
+        min = ivec3_max(min, world->left_bot_back);
+        max = ivec3_min(max, ivec3_scalar_add(world->right_top_front, -1));
+    }
+    if (min.x > max.x || min.y > max.y || min.z > max.z) return;
+    _distance_mark(world, min, max);
+    if (world->backend == WORLD_BACKEND_OCTREE) octree_fill(world->octree, min, max, voxel);
+    else if (world->backend == WORLD_BACKEND_CHUNKED) chunk_grid_fill(world->chunks, min, max, voxel);
+    else _fill_cells(world, min, max, voxel);
+    _light_edit(world, min, max);
+    _sun_edit(world, min, max);
+    _bake_edit(world, min, max);
+    _emitters_edit(world, min, max);
+}
+
+// Apaga [vox_min, vox_max] (inclusivos) do backend. Diferente de world_remove, as
+// instâncias não são desmontadas: o que elas têm na caixa continua aparecendo.
+void world_clear_region(World *world, IVector3 vox_min, IVector3 vox_max) {
+    if (!world) return;
+    _make_editable(world);
+    IVector3 min = ivec3_min(vox_min, vox_max), max = ivec3_max(vox_min, vox_max);
+    if (world->backend == WORLD_BACKEND_OCTREE) {
+        octree_clear(world->octree, min, max);
+    } else if (world->backend == WORLD_BACKEND_CHUNKED) {
+        chunk_grid_clear(world->chunks, min, max);
+    } else {
+        if (!world_is_unbounded(world)) {
+            min = ivec3_max(min, world->left_bot_back);
+            max = ivec3_min(max, ivec3_scalar_add(world->right_top_front, -1));
+        }
+        for (int z = min.z; z <= max.z; z++)
+        for (int y = min.y; y <= max.y; y++)
+        for (int x = min.x; x <= max.x; x++) {
+            if (world->backend == WORLD_BACKEND_DENSE) dense_grid_remove(world->dense, {{x, y, z}});
+            else if (world->backend == WORLD_BACKEND_TREE64) tree64_remove(world->tree64, {{x, y, z}});
+            else sparse_grid_remove(world->sparse, {{x, y, z}});
+        }
+    }
+    if (!world->distance_stale) distance_field_clear(world->distance, min, max);
+    _light_edit(world, min, max);
+    _sun_edit(world, min, max);
+    _bake_edit(world, min, max);
+    _emitters_edit(world, min, max);
+}
+
+typedef struct _paste_target {
+    World *world;
+    Voxel_Transform transform;
+    bool pasted;
+} Paste_Target;
+
+static void _paste_voxel(void *user, Voxel_Object voxel) {
+    Paste_Target *target = (Paste_Target*)user;
+    voxel.coord = voxel_transform_cell(&target->transform, voxel.coord);
+    if (!world_is_unbounded(target->world) && !world_contains_box(target->world, voxel.coord, voxel.coord)) return;
+    world_insert(target->world, voxel);
+    target->pasted = true;
+}
+
+// Copia a região [vox_min, vox_max] (inclusivos) do backend e das instâncias estáticas
+// para uma octree à parte (ver octree_extract). Objetos dinâmicos não entram.
+Octree *world_copy_region(World *world, IVector3 vox_min, IVector3 vox_max) {
+    if (!world) return NULL;
+    IVector3 min = ivec3_min(vox_min, vox_max), max = ivec3_max(vox_min, vox_max);
+    Octree *clip;
+    if (world->backend == WORLD_BACKEND_OCTREE) {
+        clip = octree_extract(world->octree, min, max);
+    } else if (world->backend == WORLD_BACKEND_CHUNKED) {
+        clip = chunk_grid_extract(world->chunks, min, max);
+    } else {
+        IVector3 extent = ivec3_scalar_add(ivec3_sub(max, min), 1);
+        int size = 1;
+        while (size < extent.x || size < extent.y || size < extent.z) size *= 2;
+        clip = octree_create(NULL, {{0, 0, 0}}, {{size, size, size}});
+
+        // Os outros backends não têm subárvores para enxertar: célula por célula
+        for (int z = min.z; clip && z <= max.z; z++)
+        for (int y = min.y; y <= max.y; y++)
+        for (int x = min.x; x <= max.x; x++) {
+            Voxel_Object voxel = _backend_find(world, {{x, y, z}});
+            if (voxel.coord.y == _invalid_voxel().coord.y) continue;
+            voxel.coord = {{x - min.x, y - min.y, z - min.z}};
+            octree_insert(clip, voxel);
+        }
+    }
+    if (!clip || !world->instances) return clip;
+
+    // Instâncias por baixo do backend (como em world_find); a última adicionada vence
+    Octree *layer = octree_create(NULL, clip->left_bot_back, clip->right_top_front);
+    for (size_t i = 0; layer && i < world->instances->count; i++) {
+        Voxel_Instance *inst = &world->instances->items[i];
+        Voxel_Transform transform = inst->transform;
+        transform.translation = ivec3_sub(transform.translation, min);
+        IVector3 a = voxel_transform_local_cell(&inst->transform, min);
+        IVector3 b = voxel_transform_local_cell(&inst->transform, max);
+        octree_paste(layer, inst->model, &transform, ivec3_min(a, b), ivec3_max(a, b));
+    }
+    if (layer) {
+        octree_merge(layer, clip);
+        clip = layer;
+    }
+    return clip;
+}
+
+// Cola 'clip' (de world_copy_region ou um modelo carregado) levado por 'transform'
+// (ver voxel_transform_place). Os voxels colados substituem os do mundo; o ar do
+// 'clip' não apaga nada.
+bool world_paste(World *world, Octree *clip, Voxel_Transform transform) {
+    if (!world || !clip) return false;
+    _make_editable(world);
+    if (world->backend != WORLD_BACKEND_OCTREE && world->backend != WORLD_BACKEND_CHUNKED) {
+        Paste_Target target = {world, transform, false};
+        octree_for_each(clip, _paste_voxel, &target);
+        return target.pasted;
+    }
+
+    // As subárvores são enxertadas sem passar por world_insert: o campo de distância
+    // marca a caixa inteira do que foi colado (sobrar é seguro) e a luz e o sol releem a caixa
+    IVector3 lo, hi, min = ivec3_zero(), max = ivec3_zero();
+    bool bounded = octree_bounds(clip, &lo, &hi);
+    if (bounded) {
+        min = max = voxel_transform_cell(&transform, lo);
+        for (int corner = 1; corner < 8; corner++) {
+            IVector3 at = voxel_transform_cell(&transform, {{(corner & 4) ? hi.x : lo.x, (corner & 2) ? hi.y : lo.y, (corner & 1) ? hi.z : lo.z}});
+            min = ivec3_min(min, at);
+            max = ivec3_max(max, at);
+        }
+        _distance_mark(world, min, max);
+    }
+    bool pasted;
+    if (world->backend == WORLD_BACKEND_OCTREE) {
+        pasted = octree_paste(world->octree, clip, &transform, clip->left_bot_back,
+                              ivec3_scalar_add(clip->right_top_front, -1));
+    } else {
+        pasted = chunk_grid_paste(world->chunks, clip, &transform, clip->left_bot_back,
+                                  ivec3_scalar_add(clip->right_top_front, -1));
+    }
+    if (bounded) {
+        _light_edit(world, min, max);
+        _sun_edit(world, min, max);
+        _bake_edit(world, min, max);
+        _emitters_edit(world, min, max);
+    }
+    return pasted;
+}
+
+typedef struct _box_visitor {
+    void (*fn)(void *user, IVector3 vox_min, IVector3 vox_max);
+    void *user;
+} Box_Visitor;
+
+static void _visit_voxel(void *user, Voxel_Object voxel) {
+    Box_Visitor *visitor = (Box_Visitor*)user;
+    visitor->fn(visitor->user, voxel.coord, voxel.coord);
+}
+
+// Cada voxel do backend como caixa (volumes da octree e do .svo de uma vez)
+static void _backend_for_each_box(World *world, void (*fn)(void *user, IVector3 vox_min, IVector3 vox_max), void *user) {
+    Box_Visitor visitor = {fn, user};
+    if (world->backend == WORLD_BACKEND_DENSE) dense_grid_for_each(world->dense, _visit_voxel, &visitor);
+    else if (world->backend == WORLD_BACKEND_TREE64) tree64_for_each(world->tree64, _visit_voxel, &visitor);
+    else if (world->backend == WORLD_BACKEND_SPARSE) sparse_grid_for_each(world->sparse, _visit_voxel, &visitor);
+    else if (world->backend == WORLD_BACKEND_SVO) svo_map_for_each_box(world->svo, fn, user);
+    else if (world->backend == WORLD_BACKEND_OCTREE) octree_for_each_box(world->octree, fn, user);
+}
+
+typedef struct _box_bounds {
+    IVector3 min, max;
+    bool found;
+} Box_Bounds;
+
+static void _grow_bounds(void *user, IVector3 vox_min, IVector3 vox_max) {
+    Box_Bounds *bounds = (Box_Bounds*)user;
+    bounds->min = bounds->found ? ivec3_min(bounds->min, vox_min) : vox_min;
+    bounds->max = bounds->found ? ivec3_max(bounds->max, vox_max) : vox_max;
+    bounds->found = true;
+}
+
+static void _mark_box(void *user, IVector3 vox_min, IVector3 vox_max) {
+    distance_field_mark((Distance_Field*)user, vox_min, vox_max);
+}
+
+// Campo novo em volta dos voxels do backend (NULL com o mundo vazio)
+static void _rebuild_distance(World *world) {
+    distance_field_delete(world->distance);
+    world->distance = NULL;
+    Box_Bounds bounds = {ivec3_zero(), ivec3_zero(), false};
+    _backend_for_each_box(world, _grow_bounds, &bounds);
+    if (bounds.found) {
+        world->distance = distance_field_create(bounds.min, bounds.max, world->left_bot_back, world->right_top_front);
+    }
+    if (world->distance) _backend_for_each_box(world, _mark_box, world->distance);
+}
+
+// Leva as edições (ou, depois de uma carga, o backend inteiro) para o campo de distância;
+// true se o buffer da GPU precisa ser reenviado (world_distance_buffer). O campo cobre os
+// voxels do backend com folga; uma edição fora dele faz o campo ser refeito do zero. Os
+// chunks entram e saem do disco sem passar pelo mundo, então lá não há campo (a marcha já
+// pula cada chunk vazio inteiro).
+bool world_update_distance(World *world) {
+    if (!world) return false;
+    if (world->backend == WORLD_BACKEND_CHUNKED) {
+        bool had_field = world->distance != NULL;
+        distance_field_delete(world->distance);
+        world->distance = NULL;
+        world->distance_stale = true;
+        return had_field;
+    }
+    bool rebuilt = world->distance_stale;
+    if (rebuilt) {
+        _rebuild_distance(world);
+        world->distance_stale = false;
+    }
+    bool changed = distance_field_update(world->distance, _box_occupied, world, world->threads) || rebuilt;
+    if (world->svo) world->svo->distance = world->distance;
+    return changed;
+}
+
+// Campo para o shader (ver distance_field_gpu_buffer); só o cabeçalho zerado quando não
+// há campo (chunks)
+int32_t *world_distance_buffer(World *world, size_t *arr_size) {
+    bool valid = world && !world->distance_stale;
+    return distance_field_gpu_buffer(valid ? world->distance : NULL, arr_size);
+}
+
+typedef struct _light_seed {
+    World *world;
+    Light_Volume *volume;
+} Light_Seed;
+
+// Cada fonte de luz do backend (volumes de material emissivo célula por célula)
+static void _seed_light(void *user, IVector3 vox_min, IVector3 vox_max) {
+    Light_Seed *seed = (Light_Seed*)user;
+    Voxel_Object voxel = _backend_find(seed->world, vox_min);
+    if (voxel.coord.y == _invalid_voxel().coord.y) return;
+    uint16_t emission = light_volume_emission(voxel.color, voxel.voxel.illumination);
+    if (!emission) return;
+    bool opaque = get_alpha_rgba(voxel.color) == 255;
+    for (int z = vox_min.z; z <= vox_max.z; z++)
+    for (int y = vox_min.y; y <= vox_max.y; y++)
+    for (int x = vox_min.x; x <= vox_max.x; x++) light_volume_set(seed->volume, {{x, y, z}}, opaque, emission);
+}
+
+// Leva as edições (ou, depois de uma carga, o backend inteiro) para a luz das fontes;
+// true se o buffer da GPU precisa ser reenviado (world_light_buffer). Como o campo de
+// distância, não existe com chunks (eles entram e saem do disco sem passar pelo mundo).
+bool world_update_light(World *world) {
+    if (!world) return false;
+    if (world->backend == WORLD_BACKEND_CHUNKED) {
+        bool had_light = world->light != NULL;
+        light_volume_delete(world->light);
+        world->light = NULL;
+        world->light_stale = true;
+        return had_light;
+    }
+    bool rebuilt = world->light_stale;
+    if (rebuilt) {
+        light_volume_delete(world->light);
+        world->light = light_volume_create(_cell_opaque, world);
+        Light_Seed seed = {world, world->light};
+        if (world->light) _backend_for_each_box(world, _seed_light, &seed);
+        world->light_stale = world->light == NULL;
+    }
+    bool changed = light_volume_update(world->light) || rebuilt;
+    if (changed) light_volume_prune(world->light);
+    return changed;
+}
+
+// Luz para o shader (ver light_volume_gpu_buffer); sem luz, a tabela vazia
+int32_t *world_light_buffer(World *world, size_t *arr_size) {
+    bool valid = world && !world->light_stale;
+    return light_volume_gpu_buffer(valid ? world->light : NULL, arr_size);
+}
+
+static bool _backend_ray_cast(World *world, Ray ray, Voxel_Object *hit) {
+    if (world->backend == WORLD_BACKEND_DENSE) {
+        return dense_grid_ray_cast(world->dense, ray, hit, NULL);
+    }
+    if (world->backend == WORLD_BACKEND_TREE64) {
+        return tree64_ray_cast(world->tree64, ray, hit, NULL);
+    }
+    if (world->backend == WORLD_BACKEND_SPARSE) {
+        return sparse_grid_ray_cast(world->sparse, ray, hit, NULL);
+    }
+    if (world->backend == WORLD_BACKEND_SVO) return svo_map_ray_cast(world->svo, ray, hit);
+    if (world->backend == WORLD_BACKEND_CHUNKED) return chunk_grid_ray_cast(world->chunks, ray, hit);
+    return octree_ray_cast_voxel(world->octree, ray, vec3_ivec3(world->left_bot_back), vec3_ivec3(world->right_top_front), hit);
+}
+
+// Distância até a entrada na célula atingida (0 se a origem já está nela)
+static float _cell_distance(Ray ray, IVector3 cell) {
+    float o[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+    float d[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+    int c[3] = {cell.x, cell.y, cell.z};
+    float t_enter = 0.0f;
+    for (int a = 0; a < 3; a++) {
+        if (fabsf(d[a]) < 1e-8f) continue;
+        float t0 = ((float)c[a] - o[a]) / d[a];
+        float t1 = ((float)(c[a] + 1) - o[a]) / d[a];
+        if (t0 > t1) t0 = t1;
+        if (t0 > t_enter) t_enter = t0;
+    }
+    return t_enter;
+}
+
+bool world_ray_cast(World *world, Ray ray, Voxel_Object *hit) {
+    if (!world) return false;
+
+    Voxel_Object backend_hit;
+    bool found = _backend_ray_cast(world, ray, &backend_hit);
+    if (world->instances) {
+        Voxel_Object instance_hit;
+        float distance;
+        if (instance_set_ray_cast(world->instances, ray, &instance_hit, &distance)
+            && (!found || distance < _cell_distance(ray, backend_hit.coord))) {
+            backend_hit = instance_hit;
+            found = true;
+        }
+    }
+    if (world->objects) {
+        Voxel_Object object_hit;
+        float distance;
+        if (object_layer_ray_cast(world->objects, ray, &object_hit, &distance)
+            && (!found || distance < _cell_distance(ray, backend_hit.coord))) {
+            backend_hit = object_hit;
+            found = true;
+        }
+    }
+    if (found && hit) *hit = backend_hit;
+    return found;
+}
+
+// Normais na ordem de getFaceIndex no shader
+static const IVector3 SUN_FACE_NORMALS[6] = {
+    {{1, 0, 0}}, {{-1, 0, 0}}, {{0, 1, 0}}, {{0, -1, 0}}, {{0, 0, 1}}, {{0, 0, -1}}
+};
+
+// Voxel que para o sol como no notInShadow do shader: nem quase transparente nem emissivo
+static bool _blocks_sun(Voxel_Object voxel) {
+    return get_alpha_rgba(voxel.color) > 25 && (uint8_t)(voxel.voxel.illumination * 255.0f) == 0;
+}
+
+// O raio de sombra bate em algum voxel do backend que para o sol?
+static bool _sun_blocked(World *world, Ray ray) {
+    for (int skip = 0; skip < SUN_MAX_SKIPS; skip++) {
+        Voxel_Object hit;
+        if (!_backend_ray_cast(world, ray, &hit)) return false;
+        if (_blocks_sun(hit)) return true;
+
+        // Continua do outro lado da célula atingida
+        float o[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+        float d[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+        int c[3] = {hit.coord.x, hit.coord.y, hit.coord.z};
+        float t_exit = 1e30f;
+        for (int a = 0; a < 3; a++) {
+            if (fabsf(d[a]) < 1e-8f) continue;
+            float t = ((float)(d[a] > 0.0f ? c[a] + 1 : c[a]) - o[a]) / d[a];
+            if (t < t_exit) t_exit = t;
+        }
+        ray.origin = vec3_add(ray.origin, vec3_scalar_mul(ray.direction, t_exit + 1e-3f));
+    }
+    return false;
+}
+
+// Bits de Sun_Cache::faces para o voxel em 'coord': faces cobertas por um vizinho opaco ou
+// de costas para o sol ficam no escuro sem raio; as outras lançam um do centro da face.
+// Só lê o backend (o cache chama de várias threads).
+static uint16_t _sun_faces(void *user, IVector3 coord, Vector3 sun) {
+    World *world = (World*)user;
+    if (_backend_find(world, coord).coord.y == _invalid_voxel().coord.y) return 0;
+    uint16_t bits = 0;
+    for (int face = 0; face < 6; face++) {
+        IVector3 n = SUN_FACE_NORMALS[face];
+        bits |= SUN_FACE_COMPUTED(face);
+        if (n.x * sun.x + n.y * sun.y + n.z * sun.z <= 0.0f) continue;
+        if (_cell_opaque(world, ivec3_add(coord, n))) continue;
+        Vector3 origin = vec3_float(coord.x + 0.5f + n.x * 0.501f, coord.y + 0.5f + n.y * 0.501f, coord.z + 0.5f + n.z * 0.501f);
+        if (!_sun_blocked(world, ray_create(origin, sun))) bits |= SUN_FACE_LIT(face);
+    }
+    return bits;
+}
+
+// Caixas do backend para um cache de faces (sol ou assado): 'touch' recebe só as partes
+// que podem ter faces à mostra
+typedef struct _shell_seed {
+    World *world;
+    void (*touch)(void *target, IVector3 vox_min, IVector3 vox_max);
+    void *target;
+} Shell_Seed;
+
+// Só a casca de cada caixa opaca tem faces à mostra (nas translúcidas, todas)
+static void _touch_shell(void *user, IVector3 vox_min, IVector3 vox_max) {
+    Shell_Seed *seed = (Shell_Seed*)user;
+    void *target = seed->target;
+    if (vox_max.x - vox_min.x < 2 || vox_max.y - vox_min.y < 2 || vox_max.z - vox_min.z < 2
+        || !_cell_opaque(seed->world, vox_min)) {
+        seed->touch(target, vox_min, vox_max);
+        return;
+    }
+    seed->touch(target, vox_min, {{vox_max.x, vox_max.y, vox_min.z}});
+    seed->touch(target, {{vox_min.x, vox_min.y, vox_max.z}}, vox_max);
+    seed->touch(target, {{vox_min.x, vox_min.y, vox_min.z + 1}}, {{vox_max.x, vox_min.y, vox_max.z - 1}});
+    seed->touch(target, {{vox_min.x, vox_max.y, vox_min.z + 1}}, {{vox_max.x, vox_max.y, vox_max.z - 1}});
+    seed->touch(target, {{vox_min.x, vox_min.y + 1, vox_min.z + 1}}, {{vox_min.x, vox_max.y - 1, vox_max.z - 1}});
+    seed->touch(target, {{vox_max.x, vox_min.y + 1, vox_min.z + 1}}, {{vox_max.x, vox_max.y - 1, vox_max.z - 1}});
+}
+
+static void _touch_sun(void *target, IVector3 vox_min, IVector3 vox_max) {
+    sun_cache_touch((Sun_Cache*)target, vox_min, vox_max);
+}
+
+// Direção para o sol (não precisa ser normalizada). Com outra direção o cache é
+// recalculado aos poucos por world_update_sun; true se mudou.
+bool world_set_sun(World *world, Vector3 direction) {
+    if (!world || vec3_len(direction) <= 0.0f) return false;
+    world->sun_direction = vec3_normalize(direction);
+    if (world->sun_stale) return true;
+    return sun_cache_set_direction(world->sun, world->sun_direction);
+}
+
+// Recalcula as faces pendentes (edições, sol novo ou, depois de uma carga, o backend
+// inteiro) por até 'budget_ms' (0 = todas), em paralelo; true se o buffer da GPU
+// mudou (world_sun_buffer). Como a luz, não existe com chunks.
+bool world_update_sun(World *world, double budget_ms) {
+    if (!world) return false;
+    if (world->backend == WORLD_BACKEND_CHUNKED) {
+        bool had_cache = world->sun != NULL;
+        sun_cache_delete(world->sun);
+        world->sun = NULL;
+        world->sun_stale = true;
+        return had_cache;
+    }
+    bool rebuilt = world->sun_stale;
+    if (rebuilt) {
+        sun_cache_delete(world->sun);
+        world->sun = sun_cache_create(world->sun_direction, _sun_faces, world);
+        Shell_Seed seed = {world, _touch_sun, world->sun};
+        if (world->sun) _backend_for_each_box(world, _touch_shell, &seed);
+        world->sun_stale = world->sun == NULL;
+    }
+    return sun_cache_update(world->sun, budget_ms, world->threads) || rebuilt;
+}
+
+// Cache do sol para o shader (ver sun_cache_gpu_buffer); sem cache, a tabela vazia
+int32_t *world_sun_buffer(World *world, size_t *arr_size) {
+    bool valid = world && !world->sun_stale;
+    return sun_cache_gpu_buffer(valid ? world->sun : NULL, arr_size);
+}
+
+// O assado guarda as faces opacas e não emissivas com um vizinho que deixa a luz entrar
+static bool _bake_exposed(void *user, IVector3 coord, int face) {
+    World *world = (World*)user;
+    Voxel_Object voxel = _backend_find(world, coord);
+    if (voxel.coord.y == _invalid_voxel().coord.y || get_alpha_rgba(voxel.color) != 255) return false;
+    if ((uint8_t)(voxel.voxel.illumination * 255.0f) != 0) return false;
+    return !_cell_opaque(world, ivec3_add(coord, SUN_FACE_NORMALS[face]));
+}
+
+static uint64_t _bake_next(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static float _bake_float(uint64_t *state) {
+    return (float)(_bake_next(state) >> 40) / 16777216.0f;
+}
+
+// Direção em cosseno em volta de uma das normais de SUN_FACE_NORMALS
+static Vector3 _bake_cosine(int face, uint64_t *state) {
+    float r = sqrtf(_bake_float(state)), phi = 2.0f * (float)M_PI * _bake_float(state);
+    float a = r * cosf(phi), b = r * sinf(phi), h = sqrtf(std::max(0.0f, 1.0f - r * r));
+    IVector3 n = SUN_FACE_NORMALS[face];
+    if (n.x) return vec3_float(h * n.x, a, b);
+    if (n.y) return vec3_float(a, h * n.y, b);
+    return vec3_float(a, b, h * n.z);
+}
+
+// Face da célula por onde o raio entra (índice de SUN_FACE_NORMALS) e a distância até ela
+static int _cell_entry(Ray ray, IVector3 cell, float *t) {
+    float o[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+    float d[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+    int c[3] = {cell.x, cell.y, cell.z};
+    float t_enter = 0.0f;
+    int face = 2;
+    for (int a = 0; a < 3; a++) {
+        if (fabsf(d[a]) < 1e-8f) continue;
+        float t0 = ((float)c[a] - o[a]) / d[a];
+        float t1 = ((float)(c[a] + 1) - o[a]) / d[a];
+        if (t0 > t1) t0 = t1;
+        if (t0 > t_enter) {
+            t_enter = t0;
+            face = a * 2 + (d[a] > 0.0f ? 1 : 0);
+        }
+    }
+    *t = t_enter;
+    return face;
+}
+
+// Primeiro voxel do backend que para a luz (os quase transparentes são atravessados,
+// como em _sun_blocked)
+static bool _bake_cast(World *world, Ray ray, Voxel_Object *hit) {
+    for (int skip = 0; skip < SUN_MAX_SKIPS; skip++) {
+        if (!_backend_ray_cast(world, ray, hit)) return false;
+        if (get_alpha_rgba(hit->color) > 25) return true;
+        float t;
+        _cell_entry(ray, hit->coord, &t);
+        float o[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+        float d[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+        int c[3] = {hit->coord.x, hit->coord.y, hit->coord.z};
+        float t_exit = 1e30f;
+        for (int a = 0; a < 3; a++) {
+            if (fabsf(d[a]) < 1e-8f) continue;
+            float e = ((float)(d[a] > 0.0f ? c[a] + 1 : c[a]) - o[a]) / d[a];
+            if (e < t_exit) t_exit = e;
+        }
+        ray.origin = vec3_add(ray.origin, vec3_scalar_mul(ray.direction, t_exit + 1e-3f));
+    }
+    return false;
+}
+
+// --- Fontes (árvore de luzes) ---
+
+// Radiância das faces de uma fonte, como no shader (cor * iluminação * 10 / PI)
+static Vector3 _emitter_radiance(Voxel_Object voxel) {
+    float strength = (uint8_t)(voxel.voxel.illumination * 255.0f) / 255.0f * 10.0f / (float)M_PI;
+    return vec3_float(get_red_rgba(voxel.color) / 255.0f * strength, get_green_rgba(voxel.color) / 255.0f * strength,
+                      get_blue_rgba(voxel.color) / 255.0f * strength);
+}
+
+// A célula entra na árvore se for uma fonte que os raios enxergam (alfa > 25, como em
+// _bake_cast), com as faces que não estão coladas num voxel opaco
+static void _emitter_refresh(World *world, IVector3 coord) {
+    Voxel_Object voxel = _backend_find(world, coord);
+    if (voxel.coord.y == _invalid_voxel().coord.y || (uint8_t)(voxel.voxel.illumination * 255.0f) == 0
+        || get_alpha_rgba(voxel.color) <= 25) {
+        light_tree_remove(world->emitters, coord);
+        return;
+    }
+    uint8_t faces = 0;
+    for (int face = 0; face < 6; face++) {
+        if (!_cell_opaque(world, ivec3_add(coord, SUN_FACE_NORMALS[face]))) faces |= (uint8_t)(1 << face);
+    }
+    light_tree_set(world->emitters, coord, _emitter_radiance(voxel), faces);
+}
+
+// Só a casca de caixas emissivas (as outras nem são abertas)
+static void _touch_emitters(void *target, IVector3 vox_min, IVector3 vox_max) {
+    World *world = (World*)target;
+    for (int z = vox_min.z; z <= vox_max.z; z++)
+    for (int y = vox_min.y; y <= vox_max.y; y++)
+    for (int x = vox_min.x; x <= vox_max.x; x++) _emitter_refresh(world, {{x, y, z}});
+}
+
+static void _seed_emitters(void *user, IVector3 vox_min, IVector3 vox_max) {
+    World *world = (World*)user;
+    Voxel_Object voxel = _backend_find(world, vox_min);
+    if (voxel.coord.y == _invalid_voxel().coord.y || (uint8_t)(voxel.voxel.illumination * 255.0f) == 0) return;
+    Shell_Seed seed = {world, _touch_emitters, world};
+    _touch_shell(&seed, vox_min, vox_max);
+}
+
+// Leva as edições (ou, depois de uma carga, o backend inteiro) para a árvore de fontes e
+// a reconstrói ou reajusta; true se mudou. Como a luz, não existe com chunks.
+bool world_update_emitters(World *world) {
+    if (!world) return false;
+    if (world->backend == WORLD_BACKEND_CHUNKED) {
+        bool had_tree = world->emitters != NULL;
+        light_tree_delete(world->emitters);
+        world->emitters = NULL;
+        world->emitters_stale = true;
+        return had_tree;
+    }
+    bool rebuilt = world->emitters_stale;
+    if (rebuilt) {
+        light_tree_delete(world->emitters);
+        world->emitters = light_tree_create();
+        if (world->emitters) _backend_for_each_box(world, _seed_emitters, world);
+        world->emitters_stale = world->emitters == NULL;
+    }
+    return light_tree_update(world->emitters) || rebuilt;
+}
+
+// Como o traçador da CPU estima a luz das fontes (ver Light_Sampling)
+void world_set_light_sampling(World *world, Light_Sampling sampling) {
+    if (world) world->light_sampling = sampling;
+}
+
+// Faces da fonte que emitem para o lado de 'p'
+static uint8_t _emitter_facing(const Tree_Light *light, Vector3 p) {
+    uint8_t facing = 0;
+    for (int face = 0; face < 6; face++) {
+        if (!(light->faces & (1 << face))) continue;
+        IVector3 n = SUN_FACE_NORMALS[face];
+        Vector3 center = vec3_float(light->coord.x + 0.5f + n.x * 0.5f, light->coord.y + 0.5f + n.y * 0.5f, light->coord.z + 0.5f + n.z * 0.5f);
+        if (vec3_dot(vec3_float((float)n.x, (float)n.y, (float)n.z), vec3_sub(p, center)) > 0.0f) facing |= (uint8_t)(1 << face);
+    }
+    return facing;
+}
+
+// Chance (por ângulo sólido) de a estimativa de próximo evento em 'p' (normal 'n') chegar
+// na face 'face' da fonte 'light' a 'distance' com cosseno 'cos_light' lá
+static float _emitter_pdf(World *world, const Tree_Light *light, Vector3 p, Vector3 n, int face, float distance, float cos_light) {
+    if (world->light_sampling == LIGHT_SAMPLING_NONE || !light || cos_light <= 0.0f) return 0.0f;
+    uint8_t facing = _emitter_facing(light, p);
+    if (!(facing & (1 << face))) return 0.0f;
+    float pmf = world->light_sampling == LIGHT_SAMPLING_TREE ? light_tree_pmf(world->emitters, p, n, light->coord)
+                                                             : 1.0f / (float)world->emitters->count;
+    return pmf / (float)__builtin_popcount(facing) * distance * distance / cos_light;
+}
+
+// Estimativa de próximo evento das fontes em 'p' (normal 'n'): uma fonte sorteada, um
+// ponto numa das faces dela viradas para 'p' e o raio de sombra até ele, pesada contra o
+// rebote em cosseno pela heurística da potência (Veach). Devolve a radiância refletida
+// por albedo (o chamador multiplica pelo caminho até aqui).
+static Vector3 _sample_emitter(World *world, Vector3 p, IVector3 normal, uint64_t *state) {
+    if (world->light_sampling == LIGHT_SAMPLING_NONE || !world->emitters || !world->emitters->count) return vec3_zero();
+    Vector3 n = vec3_float((float)normal.x, (float)normal.y, (float)normal.z);
+    float pmf = 0.0f;
+    float u = _bake_float(state);
+    const Tree_Light *light = world->light_sampling == LIGHT_SAMPLING_TREE ? light_tree_sample(world->emitters, p, n, u, &pmf)
+                                                                            : light_tree_sample_uniform(world->emitters, u, &pmf);
+    if (!light) return vec3_zero();
+    uint8_t facing = _emitter_facing(light, p);
+    if (!facing) return vec3_zero();
+    int pick = (int)(_bake_float(state) * (float)__builtin_popcount(facing)), face = 0;
+    for (face = 0; face < 6; face++) {
+        if ((facing & (1 << face)) && pick-- == 0) break;
+    }
+
+    // Um ponto qualquer da face
+    IVector3 fn = SUN_FACE_NORMALS[face];
+    float a = _bake_float(state), b = _bake_float(state);
+    Vector3 q = vec3_float(light->coord.x + (fn.x ? (fn.x > 0 ? 1.0f : 0.0f) : a),
+                          light->coord.y + (fn.y ? (fn.y > 0 ? 1.0f : 0.0f) : (fn.x ? a : b)),
+                          light->coord.z + (fn.z ? (fn.z > 0 ? 1.0f : 0.0f) : b));
+    Vector3 to = vec3_sub(q, p);
+    float distance = vec3_len(to);
+    if (distance <= 1e-4f) return vec3_zero();
+    Vector3 wi = vec3_scalar_mul(to, 1.0f / distance);
+    float cos_surface = vec3_dot(n, wi);
+    float cos_light = -vec3_dot(vec3_float((float)fn.x, (float)fn.y, (float)fn.z), wi);
+    if (cos_surface <= 0.0f || cos_light <= 0.0f) return vec3_zero();
+
+    Voxel_Object hit;
+    if (!_bake_cast(world, ray_create(p, wi), &hit) || !ivec3_equal_vec(hit.coord, light->coord)) return vec3_zero();
+
+    float light_pdf = pmf / (float)__builtin_popcount(facing) * distance * distance / cos_light;
+    float bounce_pdf = cos_surface / (float)M_PI;
+    float weight = light_pdf * light_pdf / (light_pdf * light_pdf + bounce_pdf * bounce_pdf);
+    return vec3_scalar_mul(light->radiance, bounce_pdf / light_pdf * weight);
+}
+
+// Radiância média que chega na face por 'samples' caminhos em cosseno de até BAKE_BOUNCES
+// rebotes, com os mesmos termos do shader: céu (skyColor * sunIntensity / PI) nos raios
+// perdidos, fontes (cor * iluminação * 10 / PI) e, em cada rebote difuso, o sol
+// (globalLight = 1) pelo raio de sombra. As fontes também são amostradas direto de cada
+// ponto do caminho (world->light_sampling), somadas aos raios que batem nelas por MIS.
+// Só lê o backend e a árvore de fontes já atualizada.
+static Vector3 _bake_trace(void *user, IVector3 coord, int face, Vector3 sun, int samples, uint64_t seed) {
+    World *world = (World*)user;
+    const Vector3 sky = vec3_scalar_mul(vec3_float(0.5f, 0.7f, 1.0f), 3.0f / (float)M_PI);
+    Vector3 sum = vec3_zero();
+    uint64_t state = seed;
+    for (int s = 0; s < samples; s++) {
+        // Um ponto qualquer da face, logo à frente dela
+        IVector3 n = SUN_FACE_NORMALS[face];
+        float u = _bake_float(&state) - 0.5f, v = _bake_float(&state) - 0.5f;
+        Vector3 origin = vec3_float(coord.x + 0.5f + n.x * 0.501f + (n.x ? 0.0f : u),
+                                    coord.y + 0.5f + n.y * 0.501f + (n.x ? u : (n.y ? 0.0f : v)),
+                                    coord.z + 0.5f + n.z * 0.501f + (n.z ? 0.0f : v));
+        int normal = face;
+        Vector3 throughput = vec3_float(1.0f, 1.0f, 1.0f);
+        for (int bounce = 0; bounce < BAKE_BOUNCES; bounce++) {
+            sum = vec3_add(sum, vec3_mul(throughput, _sample_emitter(world, origin, SUN_FACE_NORMALS[normal], &state)));
+
+            Ray ray = ray_create(origin, _bake_cosine(normal, &state));
+            Voxel_Object hit;
+            if (!_bake_cast(world, ray, &hit)) {
+                sum = vec3_add(sum, vec3_mul(throughput, sky));
+                break;
+            }
+            float t;
+            int entry = _cell_entry(ray, hit.coord, &t);
+            if ((uint8_t)(hit.voxel.illumination * 255.0f) != 0) {
+                // O que a estimativa de próximo evento também teria achado entra só com o peso do rebote
+                IVector3 vn = SUN_FACE_NORMALS[normal], en = SUN_FACE_NORMALS[entry];
+                float cos_surface = vn.x * ray.direction.x + vn.y * ray.direction.y + vn.z * ray.direction.z;
+                float cos_light = -(en.x * ray.direction.x + en.y * ray.direction.y + en.z * ray.direction.z);
+                float light_pdf = world->emitters ? _emitter_pdf(world, light_tree_find(world->emitters, hit.coord), origin,
+                                                                 vec3_float((float)vn.x, (float)vn.y, (float)vn.z), entry, t, cos_light)
+                                                  : 0.0f;
+                float bounce_pdf = cos_surface / (float)M_PI;
+                float weight = light_pdf > 0.0f ? bounce_pdf * bounce_pdf / (bounce_pdf * bounce_pdf + light_pdf * light_pdf) : 1.0f;
+                sum = vec3_add(sum, vec3_scalar_mul(vec3_mul(throughput, _emitter_radiance(hit)), weight));
+                break;
+            }
+
+            Vector3 albedo = vec3_float(get_red_rgba(hit.color) / 255.0f, get_green_rgba(hit.color) / 255.0f,
+                                        get_blue_rgba(hit.color) / 255.0f);
+            normal = entry;
+            IVector3 hn = SUN_FACE_NORMALS[normal];
+            Vector3 hn_f = vec3_float((float)hn.x, (float)hn.y, (float)hn.z);
+            origin = vec3_add(vec3_add(ray.origin, vec3_scalar_mul(ray.direction, t)), vec3_scalar_mul(hn_f, 1e-3f));
+            float ndotl = vec3_dot(hn_f, sun);
+            if (ndotl > 0.0f && !_sun_blocked(world, ray_create(origin, sun))) {
+                sum = vec3_add(sum, vec3_scalar_mul(vec3_mul(throughput, albedo), ndotl / (float)M_PI));
+            }
+            throughput = vec3_mul(throughput, albedo);
+        }
+    }
+    return vec3_scalar_mul(sum, 1.0f / (float)samples);
+}
+
+// O traçador de referência da CPU (o mesmo do assado) para uma face, com a direção atual
+// do sol e as fontes amostradas conforme world_set_light_sampling
+Vector3 world_trace_face(World *world, IVector3 coord, int face, int samples, uint64_t seed) {
+    if (!world || face < 0 || face > 5 || samples <= 0) return vec3_zero();
+    world_update_emitters(world);
+    return _bake_trace(world, coord, face, world->sun_direction, samples, seed);
+}
+
+static void _touch_bake(void *target, IVector3 vox_min, IVector3 vox_max) {
+    face_bake_touch((Face_Bake*)target, vox_min, vox_max);
+}
+
+// Pede um assado novo do mundo inteiro com 'samples' caminhos por face, feito aos poucos
+// por world_update_bake com a direção atual do sol (world_set_sun)
+void world_bake(World *world, int samples) {
+    if (!world || samples <= 0) return;
+    world->bake_samples = samples;
+    world->bake_stale = true;
+}
+
+// Assa as faces pendentes (edições ou, depois de world_bake ou de uma carga, o backend
+// inteiro) por até 'budget_ms' (0 = todas), em paralelo; true se o buffer da GPU mudou
+// (world_bake_buffer). Com chunks o assado que existe continua valendo, mas nada é
+// assado de novo (o raio nos chunks não aceita várias threads).
+bool world_update_bake(World *world, double budget_ms) {
+    if (!world || world->bake_samples <= 0) return false;
+    if (world->backend == WORLD_BACKEND_CHUNKED) {
+        if (!world->bake) return false;
+        if (world->bake_stale) {
+            // Edição grande: o assado inteiro deixa de valer
+            face_bake_delete(world->bake);
+            world->bake = NULL;
+            return true;
+        }
+        bool changed = world->bake->changed;
+        world->bake->changed = false;
+        return changed;
+    }
+    // As threads do assado só leem a árvore de fontes
+    world_update_emitters(world);
+    bool rebuilt = world->bake_stale;
+    if (rebuilt) {
+        face_bake_delete(world->bake);
+        world->bake = face_bake_create(world->sun_direction, world->bake_samples, _bake_exposed, _bake_trace, world);
+        Shell_Seed seed = {world, _touch_bake, world->bake};
+        if (world->bake) _backend_for_each_box(world, _touch_shell, &seed);
+        world->bake_stale = world->bake == NULL;
+    }
+    return face_bake_update(world->bake, budget_ms, world->threads) || rebuilt;
+}
+
+// Assado para o shader (ver face_bake_gpu_buffer); sem assado, a tabela vazia
+int32_t *world_bake_buffer(World *world, size_t *arr_size) {
+    bool valid = world && !world->bake_stale;
+    return face_bake_gpu_buffer(valid ? world->bake : NULL, arr_size);
+}
+
+// Grava o assado (também o que ainda falta assar, que volta pendente na leitura)
+bool world_save_bake(World *world, const char *path) {
+    if (!world || !path || world->bake_stale || !world->bake) return false;
+    size_t size;
+    uint8_t *image = face_bake_encode(world->bake, &size);
+    if (!image) return false;
+    bool ok = svo_file_write_image(path, image, size);
+    free(image);
+    return ok;
+}
+
+// Lê um assado gravado por world_save_bake para o backend atual: faces que deixaram de
+// estar à mostra saem, mas as que apareceram depois dele (edições fora do journal) ficam
+// com a estimativa ao vivo até uma edição perto delas ou um world_bake
+bool world_load_bake(World *world, const char *path) {
+    if (!world || !path) return false;
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return false;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    uint8_t *image = size > 0 ? (uint8_t*)malloc((size_t)size) : NULL;
+    bool ok = image && fread(image, 1, (size_t)size, fp) == (size_t)size;
+    fclose(fp);
+    Face_Bake *bake = ok ? face_bake_decode(image, (size_t)size, _bake_exposed, _bake_trace, world) : NULL;
+    free(image);
+    if (!bake) {
+        std::cout << "Assado inválido em " << path << "." << std::endl;
+        return false;
+    }
+    face_bake_delete(world->bake);
+    world->bake = bake;
+    world->bake_samples = bake->samples;
+    world->bake_stale = false;
+    return true;
+}
+
+// Retorna o índice da instância no nível de cima (ver instance_set_move), ou -1
+long world_add_instance(World *world, Octree *model, Voxel_Transform transform) {
+    if (!world || !model) return -1;
+    if (!world->instances) world->instances = instance_set_create();
+    return instance_set_add(world->instances, model, transform);
+}
+
+// Refit/rebuild das BVHs das instâncias e dos objetos; true se o buffer da GPU precisa
+// ser reenviado
+bool world_update_instances(World *world) {
+    if (!world) return false;
+    bool instances = instance_set_update(world->instances);
+    bool objects = world->objects && instance_set_update(world->objects->set);
+    return instances || objects;
+}
+
+// Buffer das BVHs para o shader (ver instance_set_gpu_buffer): a das instâncias e, se
+// houver objetos, a deles logo depois. O 4º componente de cada cabeçalho é o ivec4 onde
+// começa a próxima BVH (0 = última). Sem nada, só um cabeçalho zerado. Os modelos apontam
+// para a última world_texture (e para as vagas regravadas por world_sync_objects).
+int32_t *world_instance_buffer(World *world, size_t *arr_size) {
+    if (!arr_size) return NULL;
+    int32_t *buffer = instance_set_gpu_buffer(world ? world->instances : NULL, arr_size);
+    if (!buffer || !world || !world->objects || world->objects->set->count == 0) return buffer;
+
+    size_t object_size = 0;
+    int32_t *objects = object_layer_gpu_buffer(world->objects, &object_size);
+    int32_t *joined = objects ? (int32_t*)realloc(buffer, *arr_size + object_size) : NULL;
+    if (!joined) {
+        free(objects);
+        return buffer;
+    }
+    memcpy((uint8_t*)joined + *arr_size, objects, object_size);
+    joined[3] = (int32_t)(*arr_size / (4 * sizeof(int32_t)));
+    *arr_size += object_size;
+    free(objects);
+    return joined;
+}
+
+// Objetos dinâmicos: cada um tem a sua octree (o modelo) e uma transformação trocada a
+// cada quadro, sem tocar no backend nem nas instâncias. Mesmas regras de referência de
+// world_add_instance. Retorna o id do objeto (estável até world_remove_object), ou -1.
+long world_add_object(World *world, Octree *model, Voxel_Transform transform) {
+    if (!world || !model) return -1;
+    if (!world->objects) world->objects = object_layer_create();
+    return object_layer_add(world->objects, model, transform);
+}
+
+bool world_move_object(World *world, long id, Voxel_Transform transform) {
+    return world && object_layer_move(world->objects, id, transform);
+}
+
+// Próximo quadro de uma animação, ou o mesmo modelo depois de editado (ver
+// object_layer_set_model)
+bool world_set_object_model(World *world, long id, Octree *model) {
+    return world && object_layer_set_model(world->objects, id, model);
+}
+
+bool world_remove_object(World *world, long id) {
+    return world && object_layer_remove(world->objects, id);
+}
+
+// Regrava em 'texture' (a cópia na CPU da última world_texture, com 'texel_capacity'
+// texels) só os modelos de objetos que mudaram; cada faixa regravada vai para 'fn', que
+// a envia para a GPU. false: não coube, refaça a textura inteira com world_texture.
+bool world_sync_objects(World *world, uint8_t *texture, size_t texel_capacity,
+                        void (*fn)(void *user, size_t first, size_t count), void *user) {
+    return object_layer_write_texture(world ? world->objects : NULL, texture, texel_capacity, fn, user);
+}
+
+// Chunks perto de 'center' (uma célula do mundo, ex: a da câmera) ficam residentes e na
+// GPU; os que passam de 'radius' chunks são guardados (ver chunk_grid_page). Só o backend
+// em chunks pagina. Retorna true se o diretório da GPU mudou.
+bool world_page_chunks(World *world, IVector3 center, int radius) {
+    if (!world || !world->chunks) return false;
+    IVector3 chunk = {{center.x >> CHUNK_LOG2, center.y >> CHUNK_LOG2, center.z >> CHUNK_LOG2}};
+    chunk_grid_set_lod(world->chunks, world->chunk_lod_radius, world->chunk_lod_scale);
+    return chunk_grid_page(world->chunks, chunk, radius);
+}
+
+// Além do raio de world_page_chunks, os chunks vão para a GPU reduzidos até 'radius'
+// chunks, no nível que o tamanho na tela pede (ver chunk_grid_set_lod); vale também para
+// os chunks de um backend trocado depois. radius 0 desliga.
+void world_set_chunk_lod(World *world, int radius, float pixels_per_radian) {
+    if (!world) return;
+    world->chunk_lod_radius = radius;
+    world->chunk_lod_scale = pixels_per_radian;
+}
+
+// Como world_sync_objects, para os chunks editados ou que acabaram de ficar residentes:
+// só eles são regravados na textura. Nos outros backends não há nada a fazer (uma edição
+// lá pede a textura inteira).
+bool world_sync_chunks(World *world, uint8_t *texture, size_t texel_capacity,
+                       void (*fn)(void *user, size_t first, size_t count), void *user) {
+    return chunk_grid_write_texture(world ? world->chunks : NULL, texture, texel_capacity, fn, user);
+}
+
+// true se o diretório dos chunks precisa ser reenviado (world_chunk_buffer)
+bool world_update_chunks(World *world) {
+    return world && world->chunks && world->chunks->gpu_dirty;
+}
+
+// Diretório dos chunks para o shader (ver chunk_grid_gpu_buffer); fora do backend em
+// chunks, só o cabeçalho zerado (a raiz do mundo fica no texel 0)
+int32_t *world_chunk_buffer(World *world, size_t *arr_size) {
+    return chunk_grid_gpu_buffer(world ? world->chunks : NULL, arr_size);
+}
+
+// Libera o backend antes de trocar o conteúdo inteiro do mundo: nada do que foi
+// calculado a partir dele (distâncias, luz, sol, assado, fontes) vale mais
+static void _replace_content(World *world) {
+    octree_delete(world->octree);
+    dense_grid_delete(world->dense);
+    tree64_delete(world->tree64);
+    sparse_grid_delete(world->sparse);
+    svo_map_delete(world->svo);
+    chunk_grid_delete(world->chunks);
+    world->octree = NULL;
+    world->dense = NULL;
+    world->tree64 = NULL;
+    world->sparse = NULL;
+    world->svo = NULL;
+    world->chunks = NULL;
+    world->distance_stale = true;
+    world->light_stale = true;
+    world->sun_stale = true;
+    world->bake_stale = true;
+    world->emitters_stale = true;
+}
+
+// Troca o conteúdo do mundo pelos chunks de um chunk_store (ver chunkStore.hpp), que são
+// lidos do disco conforme a câmera anda (world_page_chunks / world_stream_chunks); na
+// memória ficam no máximo 'budget' bytes de imagens fora da janela (0 = CHUNK_CACHE_BUDGET).
+bool world_open_chunks(World *world, const char *path, size_t budget) {
+    if (!world || !path) return false;
+    Chunk_Store *store = chunk_store_open(path, NULL);
+    if (!store) return false;
+    Chunk_Grid *grid = chunk_grid_create(world->left_bot_back, world->right_top_front);
+    if (!grid || !chunk_grid_attach_store(grid, store, budget, true)) {
+        std::cout << "Limites de " << path << " diferentes dos do mundo." << std::endl;
+        chunk_store_close(store);
+        chunk_grid_delete(grid);
+        return false;
+    }
+    _replace_content(world);
+    world->chunks = grid;
+    world->backend = WORLD_BACKEND_CHUNKED;
+    return true;
+}
+
+// Cria em 'path' um chunk_store novo para onde vão os chunks guardados do backend em
+// chunks que passarem de 'budget' bytes (0 = CHUNK_CACHE_BUDGET); o mundo não muda.
+bool world_swap_chunks(World *world, const char *path, size_t budget) {
+    if (!world || !world->chunks || !path || world->chunks->store) return false;
+    Chunk_Store *store = chunk_store_create(path, world->left_bot_back, world->right_top_front, CHUNK_LOG2, NULL);
+    if (!store) return false;
+    if (!chunk_grid_attach_store(world->chunks, store, budget, false)) {
+        chunk_store_close(store);
+        return false;
+    }
+    return true;
+}
+
+// Pede ao disco os chunks que a câmera vai alcançar (ver chunk_grid_prefetch): posição em
+// células e velocidade em células por segundo. Chamar depois de world_page_chunks.
+bool world_stream_chunks(World *world, Vector3 position, Vector3 velocity) {
+    if (!world || !world->chunks || !world->chunks->store) return false;
+    chunk_grid_prefetch(world->chunks, position, velocity);
+    return true;
+}
+
+// Grava no chunk_store do mundo tudo o que ele ainda não tem, para world_open_chunks
+bool world_save_chunks(World *world) {
+    return world && chunk_grid_save(world->chunks);
+}
+
+static uint8_t *_backend_texture(World *world, size_t *arr_size, size_t tex_dim) {
+    if (world->backend == WORLD_BACKEND_DENSE) {
+        return dense_grid_texture(world->dense, world->left_bot_back, world->right_top_front, arr_size, tex_dim);
+    }
+    if (world->backend == WORLD_BACKEND_TREE64) {
+        return tree64_texture(world->tree64, world->left_bot_back, world->right_top_front, arr_size, tex_dim);
+    }
+    if (world->backend == WORLD_BACKEND_SPARSE) {
+        return sparse_grid_texture(world->sparse, world->left_bot_back, world->right_top_front, arr_size, tex_dim);
+    }
+    if (world->backend == WORLD_BACKEND_SVO) {
+        *arr_size = world->svo->texel_count * 4;
+        uint8_t *texture = (uint8_t*)malloc(*arr_size ? *arr_size : 4);
+        if (texture && *arr_size) memcpy(texture, world->svo->texels, *arr_size);
+        if (!texture) *arr_size = 0;
+        return texture;
+    }
+    if (world->backend == WORLD_BACKEND_CHUNKED) return chunk_grid_texture(world->chunks, arr_size);
+    return octree_texture(world->octree, arr_size, tex_dim);
+}
+
+// A octree de cada modelo instanciado vai uma vez para o fim da textura; o shader chega
+// nela pela BVH (world_instance_buffer), não pela árvore do mundo. Depois vem a arena dos
+// objetos dinâmicos, com folga para world_sync_objects regravar modelos no lugar.
+uint8_t *world_texture(World *world, size_t *arr_size, size_t tex_dim) {
+    if (!world || !arr_size) return NULL;
+    *arr_size = 0;
+    uint8_t *texture = _backend_texture(world, arr_size, tex_dim);
+    if (world->instances && world->instances->count > 0) {
+        instance_set_append_texture(world->instances, &texture, arr_size);
+    }
+    if (world->objects) object_layer_append_texture(world->objects, &texture, arr_size);
+    return texture;
+}
+
+static void _insert_into_octree(void *user, Voxel_Object voxel) {
+    octree_insert((Octree*)user, voxel);
+}
+
+// Se a árvore do backend cabe numa textura só (ver world_texture). Senão o mundo precisa
+// ir em chunks (WORLD_BACKEND_CHUNKED), que só põe na textura os chunks perto da câmera.
+bool world_fits_texture(World *world) {
+    if (!world) return false;
+    size_t texels;
+    if (world->backend == WORLD_BACKEND_SVO) {
+        texels = world->svo->texel_count;
+    } else if (world->backend == WORLD_BACKEND_OCTREE) {
+        texels = _octree_texel_size(world->octree);
+    } else if (world->backend == WORLD_BACKEND_CHUNKED) {
+        size_t arr_size = 0;
+        free(_backend_texture(world, &arr_size, 0));
+        texels = arr_size / 4;
+    } else {
+        // Os outros vão para a textura pela octree com os limites do mundo (ver
+        // dense_grid_texture): basta contar os texels dela, sem escrever a textura
+        Octree *tree = octree_create(NULL, world->left_bot_back, world->right_top_front);
+        if (!tree) return false;
+        if (world->backend == WORLD_BACKEND_DENSE) dense_grid_for_each(world->dense, _insert_into_octree, tree);
+        else if (world->backend == WORLD_BACKEND_TREE64) tree64_for_each(world->tree64, _insert_into_octree, tree);
+        else sparse_grid_for_each(world->sparse, _insert_into_octree, tree);
+        octree_compact(tree, 0);
+        texels = _octree_texel_size(tree);
+        octree_delete(tree);
+    }
+    return texels <= TEXTURE_MAX_TEXELS;
+}
+
+// Textura pronta sem cópia: os texels do arquivo mapeado, quando o mundo é só ele
+// (instâncias e objetos entram na textura depois da árvore). NULL: use world_texture.
+const uint8_t *world_texture_view(World *world, size_t *arr_size) {
+    if (!world || !arr_size || world->backend != WORLD_BACKEND_SVO) return NULL;
+    if ((world->instances && world->instances->count > 0) || world->objects) return NULL;
+    *arr_size = world->svo->texel_count * 4;
+    return world->svo->texels;
+}
+
+// Troca o conteúdo do mundo pelo arquivo 'path' (ver svo_file_write), sem montar a
+// octree. Os limites do arquivo têm que ser os do mundo: a subdivisão que o shader
+// percorre depende da caixa da raiz. Instâncias e objetos são mantidos.
+bool world_load_svo(World *world, const char *path) {
+    if (!world || !path) return false;
+    Svo_Map *map = svo_map_open(path, true);
+    if (!map) return false;
+    if (!ivec3_equal_vec(map->left_bot_back, world->left_bot_back)
+        || !ivec3_equal_vec(map->right_top_front, world->right_top_front)) {
+        std::cout << "Limites de " << path << " diferentes dos do mundo." << std::endl;
+        svo_map_delete(map);
+        return false;
+    }
+    _replace_content(world);
+    world->svo = map;
+    world->backend = WORLD_BACKEND_SVO;
+    return true;
+}
+
+// Grava o backend e as instâncias estáticas numa árvore só (com as mesmas regras de
+// world_find); os objetos dinâmicos não entram. O .svo tem os limites do mundo: com
+// voxels do backend esparso fora deles, não grava nada (o arquivo perderia esses voxels).
+bool world_save_svo(World *world, const char *path) {
+    if (!world || !path) return false;
+    if (world->backend == WORLD_BACKEND_SPARSE) {
+        size_t outside = sparse_grid_count_outside(world->sparse, world->left_bot_back, world->right_top_front);
+        if (outside) {
+            std::cout << "Não dá para gravar " << path << ": " << outside << " voxels fora dos limites do mundo." << std::endl;
+            return false;
+        }
+    }
+    bool has_instances = world->instances && world->instances->count > 0;
+    if (world->backend == WORLD_BACKEND_OCTREE && !has_instances) {
+        return svo_file_write(path, world->octree);
+    }
+
+    Octree *tree = octree_create(NULL, world->left_bot_back, world->right_top_front);
+    if (!tree) return false;
+    for (size_t i = 0; has_instances && i < world->instances->count; i++) {
+        Voxel_Instance *inst = &world->instances->items[i];
+        octree_paste(tree, inst->model, &inst->transform, inst->local_min, inst->local_max);
+    }
+    Octree *backend = NULL;
+    if (world->backend == WORLD_BACKEND_OCTREE) backend = octree_clone(world->octree);
+    else if (world->backend == WORLD_BACKEND_SVO) backend = svo_map_to_octree(world->svo);
+    else if (world->backend == WORLD_BACKEND_CHUNKED) backend = chunk_grid_to_octree(world->chunks, world->left_bot_back, world->right_top_front);
+    else if (world->backend == WORLD_BACKEND_DENSE) dense_grid_for_each(world->dense, _insert_into_octree, tree);
+    else if (world->backend == WORLD_BACKEND_TREE64) tree64_for_each(world->tree64, _insert_into_octree, tree);
+    else if (world->backend == WORLD_BACKEND_SPARSE) sparse_grid_for_each(world->sparse, _insert_into_octree, tree);
+    if (backend) octree_merge(tree, backend);
+    octree_compact(tree, 0);
+
+    bool ok = svo_file_write(path, tree);
+    octree_delete(tree);
+    return ok;
+}
+
+// Só a octree (e a de cada chunk) adia fusões; a grade esparsa solta aqui os nós que as
+// remoções esvaziaram; os outros backends já ficam compactos a cada edição
+bool world_compact(World *world, double budget_ms) {
+    if (!world) return true;
+    if (world->backend == WORLD_BACKEND_CHUNKED) return chunk_grid_compact(world->chunks, budget_ms);
+    if (world->backend == WORLD_BACKEND_SPARSE && world->sparse->emptied > 0) sparse_grid_prune(world->sparse);
+    if (world->backend != WORLD_BACKEND_OCTREE) return true;
+    return octree_compact(world->octree, budget_ms);
+}
+
+size_t world_memory_usage(World *world) {
+    if (!world) return 0;
+    size_t instances = instance_set_memory_usage(world->instances) + object_layer_memory_usage(world->objects)
+                     + distance_field_memory_usage(world->distance) + light_volume_memory_usage(world->light)
+                     + sun_cache_memory_usage(world->sun) + face_bake_memory_usage(world->bake)
+                     + light_tree_memory_usage(world->emitters);
+    if (world->backend == WORLD_BACKEND_DENSE) return instances + dense_grid_memory_usage(world->dense);
+    if (world->backend == WORLD_BACKEND_TREE64) return instances + tree64_memory_usage(world->tree64);
+    if (world->backend == WORLD_BACKEND_SPARSE) return instances + sparse_grid_memory_usage(world->sparse);
+    if (world->backend == WORLD_BACKEND_SVO) return instances + svo_map_memory_usage(world->svo);
+    if (world->backend == WORLD_BACKEND_CHUNKED) return instances + chunk_grid_memory_usage(world->chunks);
+    return instances + octree_memory_usage(world->octree);
+}
+
+void world_delete(World *world) {
+    if (!world) return;
+    octree_delete(world->octree);
+    dense_grid_delete(world->dense);
+    tree64_delete(world->tree64);
+    sparse_grid_delete(world->sparse);
+    svo_map_delete(world->svo);
+    chunk_grid_delete(world->chunks);
+    instance_set_delete(world->instances);
+    object_layer_delete(world->objects);
+    distance_field_delete(world->distance);
+    light_volume_delete(world->light);
+    sun_cache_delete(world->sun);
+    face_bake_delete(world->bake);
+    light_tree_delete(world->emitters);
+    free(world);
+}